@@ -0,0 +1,247 @@
+/**
+ *   @file  azimuth_heatmap.cpp
+ *
+ *   @brief
+ *      Range/azimuth magnitude heat map view and host reference, see
+ *      board/common/mmw_azimuth_heatmap.h for the format.
+ */
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "azimuth_heatmap.h"
+
+namespace mmw
+{
+
+/**
+ *  @b Description
+ *  @n
+ *      Validates a magnitude heat map payload.
+ *
+ *  @param[in]  payload
+ *      TLV payload, without the TLV header
+ *  @param[in]  len
+ *      TLV length
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int AzimuthHeatMap::parse(const uint8_t *payload, size_t len)
+{
+    m_values = nullptr;
+
+    if (len < sizeof(MmwDemo_azimuthHeatMapHdr))
+    {
+        return -1;
+    }
+    std::memcpy(&m_hdr, payload, sizeof(m_hdr));
+    if ((m_hdr.version != MMW_AZIMUTH_HEATMAP_VERSION) ||
+        (m_hdr.format > MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG) || (m_hdr.numAngleBins == 0U) ||
+        (len != azimuthHeatMapSize(m_hdr.numRangeBins, m_hdr.numAngleBins, m_hdr.format)))
+    {
+        return -1;
+    }
+    m_values = payload + sizeof(m_hdr);
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Raw value of a bin, as sent by the DSS.
+ */
+uint16_t AzimuthHeatMap::value(uint32_t rangeIdx, uint32_t angleIdx) const
+{
+    const size_t i = (size_t)rangeIdx * m_hdr.numAngleBins + angleIdx;
+
+    if (m_hdr.format == MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG)
+    {
+        return m_values[i];
+    }
+    uint16_t v;
+    std::memcpy(&v, m_values + i * sizeof(uint16_t), sizeof(v));
+    return v;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Linear magnitude of a bin, |X| / numVirtualAnt for both formats.
+ */
+float AzimuthHeatMap::magnitude(uint32_t rangeIdx, uint32_t angleIdx) const
+{
+    const uint16_t v = value(rangeIdx, angleIdx);
+
+    if (m_hdr.format == MMW_AZIMUTH_HEATMAP_FORMAT_U16)
+    {
+        return (float)v;
+    }
+    /* v = 4 * log2(1 + |X|^2) */
+    return std::sqrt(std::exp2((float)v * 0.25f) - 1.0f) / (float)m_hdr.numVirtualAnt;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Decodes the whole map to linear magnitude, range major.
+ *
+ *  @param[out] out
+ *      numCells() values
+ *  @param[in]  outCount
+ *      Size of out
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int AzimuthHeatMap::decode(float *out, size_t outCount) const
+{
+    if ((m_values == nullptr) || (outCount < numCells()))
+    {
+        return -1;
+    }
+
+    if (m_hdr.format == MMW_AZIMUTH_HEATMAP_FORMAT_U16)
+    {
+        for (size_t i = 0; i < numCells(); i++)
+        {
+            uint16_t v;
+            std::memcpy(&v, m_values + i * sizeof(uint16_t), sizeof(v));
+            out[i] = (float)v;
+        }
+        return 0;
+    }
+
+    float lut[256];
+    for (uint32_t v = 0; v < 256U; v++)
+    {
+        lut[v] = std::sqrt(std::exp2((float)v * 0.25f) - 1.0f) / (float)m_hdr.numVirtualAnt;
+    }
+    for (size_t i = 0; i < numCells(); i++)
+    {
+        out[i] = lut[m_values[i]];
+    }
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      TLV length of a magnitude heat map.
+ */
+size_t azimuthHeatMapSize(uint32_t numRangeBins, uint32_t numAngleBins, uint8_t format)
+{
+    return sizeof(MmwDemo_azimuthHeatMapHdr) + (size_t)numRangeBins * numAngleBins *
+        ((format == MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG) ? sizeof(uint8_t) : sizeof(uint16_t));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Computes the magnitude heat map from the raw azimuth heat map the way
+ *      MmwDemo_azimuthHeatMapMagnitude does on the DSS, including the 16
+ *      point minimum FFT size.
+ *
+ *  @param[in]  samples
+ *      Raw azimuth heat map payload, numRangeBins x numVirtualAnt cmplx16ImRe_t
+ *  @param[in]  numRangeBins
+ *      Number of range bins
+ *  @param[in]  numVirtualAnt
+ *      Number of azimuth virtual antennas
+ *  @param[in]  numAngleBins
+ *      Number of angle bins, a power of two of at least MMW_AZIMUTH_HEATMAP_MIN_BINS
+ *  @param[in]  format
+ *      MMW_AZIMUTH_HEATMAP_FORMAT_xxx
+ *  @param[out] out
+ *      TLV payload
+ *  @param[in]  outSize
+ *      Size of out
+ *
+ *  @retval
+ *      Success -   TLV length
+ *  @retval
+ *      Error   -   <0
+ */
+int computeAzimuthHeatMap(const uint8_t *samples, uint32_t numRangeBins, uint32_t numVirtualAnt,
+                          uint32_t numAngleBins, uint8_t format, uint8_t *out, size_t outSize)
+{
+    const uint32_t fftSize = (numAngleBins < 16U) ? 16U : numAngleBins;
+    const size_t   len = azimuthHeatMapSize(numRangeBins, numAngleBins, format);
+
+    if ((numAngleBins < MMW_AZIMUTH_HEATMAP_MIN_BINS) || ((numAngleBins & (numAngleBins - 1U)) != 0U) ||
+        (numVirtualAnt == 0U) || (numVirtualAnt > fftSize) ||
+        (format > MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG) || (outSize < len))
+    {
+        return -1;
+    }
+    const uint32_t decim = fftSize / numAngleBins;
+
+    /* Only the bins that are sent, in output order */
+    std::vector<float> cosTab((size_t)numAngleBins * numVirtualAnt);
+    std::vector<float> sinTab((size_t)numAngleBins * numVirtualAnt);
+    for (uint32_t k = 0; k < numAngleBins; k++)
+    {
+        const uint32_t src = ((k + numAngleBins / 2U) & (numAngleBins - 1U)) * decim;
+        for (uint32_t n = 0; n < numVirtualAnt; n++)
+        {
+            const double phi = -2.0 * M_PI * (double)((src * n) % fftSize) / (double)fftSize;
+            cosTab[(size_t)k * numVirtualAnt + n] = (float)std::cos(phi);
+            sinTab[(size_t)k * numVirtualAnt + n] = (float)std::sin(phi);
+        }
+    }
+
+    MmwDemo_azimuthHeatMapHdr hdr;
+    hdr.numRangeBins = (uint16_t)numRangeBins;
+    hdr.numAngleBins = (uint16_t)numAngleBins;
+    hdr.format = format;
+    hdr.version = MMW_AZIMUTH_HEATMAP_VERSION;
+    hdr.numVirtualAnt = (uint16_t)numVirtualAnt;
+    std::memcpy(out, &hdr, sizeof(hdr));
+
+    uint8_t *p = out + sizeof(hdr);
+    std::vector<float> re(numVirtualAnt);
+    std::vector<float> im(numVirtualAnt);
+    for (uint32_t r = 0; r < numRangeBins; r++)
+    {
+        for (uint32_t n = 0; n < numVirtualAnt; n++)
+        {
+            /* cmplx16ImRe_t, imaginary part first */
+            int16_t s[2];
+            std::memcpy(s, samples + ((size_t)r * numVirtualAnt + n) * sizeof(s), sizeof(s));
+            im[n] = s[0];
+            re[n] = s[1];
+        }
+        for (uint32_t k = 0; k < numAngleBins; k++)
+        {
+            const float *c = &cosTab[(size_t)k * numVirtualAnt];
+            const float *s = &sinTab[(size_t)k * numVirtualAnt];
+            float xr = 0.0f;
+            float xi = 0.0f;
+            for (uint32_t n = 0; n < numVirtualAnt; n++)
+            {
+                xr += re[n] * c[n] - im[n] * s[n];
+                xi += re[n] * s[n] + im[n] * c[n];
+            }
+            const float magSqr = xr * xr + xi * xi;
+            if (format == MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG)
+            {
+                const float v = 4.0f * std::log2(1.0f + magSqr) + 0.5f;
+                *p++ = (uint8_t)((v > 255.0f) ? 255.0f : v);
+            }
+            else
+            {
+                const float v = std::sqrt(magSqr) / (float)numVirtualAnt + 0.5f;
+                const uint16_t q = (uint16_t)((v > 65535.0f) ? 65535.0f : v);
+                std::memcpy(p, &q, sizeof(q));
+                p += sizeof(q);
+            }
+        }
+    }
+    return (int)len;
+}
+
+} /* namespace mmw */
@@ -0,0 +1,66 @@
+/**
+ *   @file  azimuth_heatmap.h
+ *
+ *   @brief
+ *      View of the range/azimuth magnitude heat map TLV
+ *      (MMWDEMO_OUTPUT_MSG_AZIMUTH_HEAT_MAP_MAGNITUDE) and a host reference
+ *      of the DSS computation, for checking captures against the raw
+ *      azimuth heat map (MMWDEMO_OUTPUT_MSG_AZIMUT_STATIC_HEAT_MAP).
+ */
+#ifndef AZIMUTH_HEATMAP_H
+#define AZIMUTH_HEATMAP_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mmw_azimuth_heatmap.h"
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  Range/azimuth magnitude heat map view
+ *
+ * @details
+ *  parse() only validates the payload, values are read in place. The
+ *  payload has to stay valid while the view is used.
+ */
+class AzimuthHeatMap
+{
+public:
+    int parse(const uint8_t *payload, size_t len);
+
+    uint16_t value(uint32_t rangeIdx, uint32_t angleIdx) const;
+    float magnitude(uint32_t rangeIdx, uint32_t angleIdx) const;
+    int decode(float *out, size_t outCount) const;
+
+    /**
+     *  @b Description
+     *  @n
+     *      sin(theta) of an angle bin, negative angles come first.
+     */
+    static float sinAngle(uint32_t angleIdx, uint32_t numAngleBins)
+    {
+        return 2.0f * ((float)angleIdx - (float)(numAngleBins / 2U)) / (float)numAngleBins;
+    }
+
+    uint16_t numRangeBins() const   { return m_hdr.numRangeBins; }
+    uint16_t numAngleBins() const   { return m_hdr.numAngleBins; }
+    uint16_t numVirtualAnt() const  { return m_hdr.numVirtualAnt; }
+    uint8_t  format() const         { return m_hdr.format; }
+    size_t   numCells() const       { return (size_t)m_hdr.numRangeBins * m_hdr.numAngleBins; }
+
+private:
+    const uint8_t               *m_values = nullptr;
+    MmwDemo_azimuthHeatMapHdr   m_hdr = {};
+};
+
+size_t azimuthHeatMapSize(uint32_t numRangeBins, uint32_t numAngleBins, uint8_t format);
+
+int computeAzimuthHeatMap(const uint8_t *samples, uint32_t numRangeBins, uint32_t numVirtualAnt,
+                          uint32_t numAngleBins, uint8_t format, uint8_t *out, size_t outSize);
+
+} /* namespace mmw */
+
+#endif /* AZIMUTH_HEATMAP_H */
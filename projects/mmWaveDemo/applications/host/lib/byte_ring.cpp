@@ -0,0 +1,230 @@
+/**
+ *   @file  byte_ring.cpp
+ *
+ *   @brief
+ *      Mirrored SPSC byte ring on a memfd mapped twice.
+ */
+#include <chrono>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "byte_ring.h"
+
+namespace mmw
+{
+
+ByteRing::~ByteRing()
+{
+    if (m_base != nullptr)
+    {
+        munmap(m_base, 2 * m_capacity);
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Allocates the ring.
+ *
+ *  @param[in]  capacity
+ *      Size in bytes, a power of two and a multiple of the page size
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int ByteRing::create(size_t capacity)
+{
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    if ((m_base != nullptr) || (capacity < page) || ((capacity & (capacity - 1)) != 0) ||
+        (capacity % page != 0))
+    {
+        return -1;
+    }
+
+    const int fd = memfd_create("mmw_ring", MFD_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)capacity) < 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+
+    /* Reserve twice the size, then map the file over both halves */
+    void *base = mmap(nullptr, 2 * capacity, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+    {
+        ::close(fd);
+        return -1;
+    }
+    uint8_t *p = static_cast<uint8_t *>(base);
+    if ((mmap(p, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) ||
+        (mmap(p + capacity, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED))
+    {
+        munmap(base, 2 * capacity);
+        ::close(fd);
+        return -1;
+    }
+    ::close(fd);
+
+    m_base = p;
+    m_capacity = capacity;
+    m_mask = capacity - 1;
+    m_written.store(0);
+    m_consumed.store(0);
+    m_closed.store(false);
+    return 0;
+}
+
+void ByteRing::wake()
+{
+    if (m_waiters.load(std::memory_order_seq_cst) > 0)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_cv.notify_all();
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Producer: contiguous free space at the write position.
+ */
+uint8_t *ByteRing::writePtr(size_t &space)
+{
+    const uint64_t w = m_written.load(std::memory_order_relaxed);
+    space = m_capacity - (size_t)(w - m_consumed.load(std::memory_order_acquire));
+    return m_base + (w & m_mask);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Producer: publishes n bytes written at writePtr().
+ */
+void ByteRing::commit(size_t n)
+{
+    m_written.fetch_add(n, std::memory_order_release);
+    wake();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Producer: waits until n bytes can be written.
+ *
+ *  @retval
+ *      true if there is room, false if the ring was closed
+ */
+bool ByteRing::waitWritable(size_t n)
+{
+    auto room = [&]
+    {
+        return m_capacity - (size_t)(m_written.load(std::memory_order_relaxed) -
+                                     m_consumed.load(std::memory_order_acquire)) >= n;
+    };
+    if (room())
+    {
+        return true;
+    }
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_waiters.fetch_add(1, std::memory_order_seq_cst);
+    m_cv.wait(guard, [&] { return room() || closed(); });
+    m_waiters.fetch_sub(1, std::memory_order_seq_cst);
+    return !closed();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Consumer: contiguous data at the read position.
+ */
+const uint8_t *ByteRing::readPtr(size_t &avail) const
+{
+    const uint64_t r = m_consumed.load(std::memory_order_relaxed);
+    avail = (size_t)(m_written.load(std::memory_order_acquire) - r);
+    return m_base + (r & m_mask);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Consumer: frees n bytes at the read position.
+ */
+void ByteRing::consume(size_t n)
+{
+    m_consumed.fetch_add(n, std::memory_order_release);
+    wake();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Consumer: frees everything before the absolute position pos.
+ */
+void ByteRing::consumeTo(uint64_t pos)
+{
+    if (pos > m_consumed.load(std::memory_order_relaxed))
+    {
+        m_consumed.store(pos, std::memory_order_release);
+        wake();
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Consumer: waits until the n bytes from the absolute position pos are
+ *      written.
+ *
+ *  @retval
+ *      true if the data is there, false on timeout or if the ring was closed
+ *      (data written before close() is still returned)
+ */
+bool ByteRing::waitReadable(uint64_t pos, size_t n, int timeoutMs)
+{
+    auto ready = [&] { return m_written.load(std::memory_order_acquire) >= pos + n; };
+    if (ready())
+    {
+        return true;
+    }
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_waiters.fetch_add(1, std::memory_order_seq_cst);
+    const bool ok = m_cv.wait_for(guard, std::chrono::milliseconds(timeoutMs),
+                                  [&] { return ready() || closed(); });
+    m_waiters.fetch_sub(1, std::memory_order_seq_cst);
+    return ok && ready();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Wakes up both sides for good, e.g. on shutdown.
+ */
+void ByteRing::close()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_closed.store(true, std::memory_order_release);
+    }
+    m_cv.notify_all();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Undoes close() and empties the ring.
+ */
+void ByteRing::reopen()
+{
+    m_consumed.store(m_written.load());
+    m_closed.store(false, std::memory_order_release);
+}
+
+} /* namespace mmw */
@@ -0,0 +1,79 @@
+/**
+ *   @file  byte_ring.h
+ *
+ *   @brief
+ *      Single producer, single consumer byte ring mapped twice back to back,
+ *      so any span of up to capacity() bytes is contiguous in memory and
+ *      readers can hand out pointers into the ring instead of copies.
+ */
+#ifndef BYTE_RING_H
+#define BYTE_RING_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  Mirrored SPSC byte ring
+ *
+ * @details
+ *  The producer writes at writePtr() and publishes with commit(), the
+ *  consumer reads at readPtr() and frees with consume(). Positions are
+ *  64 bit byte counts that never wrap. waitWritable()/waitReadable() block
+ *  until enough room or data is there, or until close() was called.
+ */
+class ByteRing
+{
+public:
+    ByteRing() = default;
+    ~ByteRing();
+
+    ByteRing(const ByteRing &) = delete;
+    ByteRing &operator=(const ByteRing &) = delete;
+
+    int create(size_t capacity);
+
+    uint8_t *writePtr(size_t &space);
+    void commit(size_t n);
+    bool waitWritable(size_t n);
+
+    const uint8_t *readPtr(size_t &avail) const;
+    const uint8_t *at(uint64_t pos) const { return m_base + (pos & m_mask); }
+    void consume(size_t n);
+    void consumeTo(uint64_t pos);
+    bool waitReadable(uint64_t pos, size_t n, int timeoutMs);
+
+    void close();
+    void reopen();
+    bool closed() const { return m_closed.load(std::memory_order_acquire); }
+
+    size_t capacity() const     { return m_capacity; }
+    uint64_t written() const    { return m_written.load(std::memory_order_acquire); }
+    uint64_t consumed() const   { return m_consumed.load(std::memory_order_acquire); }
+
+private:
+    uint8_t                 *m_base = nullptr;
+    size_t                  m_capacity = 0;
+    uint64_t                m_mask = 0;
+
+    alignas(64) std::atomic<uint64_t> m_written{0};
+    alignas(64) std::atomic<uint64_t> m_consumed{0};
+    std::atomic<bool>       m_closed{false};
+
+    /* Only used by a side that has to sleep */
+    std::mutex              m_lock;
+    std::condition_variable m_cv;
+    std::atomic<int>        m_waiters{0};
+
+    void wake();
+};
+
+} /* namespace mmw */
+
+#endif /* BYTE_RING_H */
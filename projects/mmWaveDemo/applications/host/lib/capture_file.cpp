@@ -0,0 +1,644 @@
+/**
+ *   @file  capture_file.cpp
+ *
+ *   @brief
+ *      Indexed capture file, see capture_file.h.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "capture_file.h"
+#include "host_clock.h"
+#include "mmw_wire.h"
+#include "tlv_parser.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+size_t alignUp(size_t n)
+{
+    return (n + CAPTURE_ALIGN - 1U) & ~(size_t)(CAPTURE_ALIGN - 1U);
+}
+
+uint8_t *allocBlocks(size_t n)
+{
+    void *p = nullptr;
+    if (posix_memalign(&p, CAPTURE_ALIGN, n) != 0)
+    {
+        return nullptr;
+    }
+    return (uint8_t *)p;
+}
+
+} /* anonymous namespace */
+
+CaptureWriter::~CaptureWriter()
+{
+    close();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Creates the file, writes the header with the .cfg text and starts
+ *      the writer thread.
+ *
+ *  @param[in]  cfg
+ *      Writer configuration
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int CaptureWriter::open(const CaptureWriterConfig &cfg)
+{
+    if ((m_fd >= 0) || (cfg.segmentSize < 2U * CAPTURE_ALIGN) || (cfg.maxPending == 0U))
+    {
+        return -1;
+    }
+    m_cfg = cfg;
+    m_segmentCapacity = alignUp(cfg.segmentSize);
+
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | (cfg.direct ? O_DIRECT : 0);
+    m_fd = ::open(cfg.path.c_str(), flags, 0644);
+    if (m_fd < 0)
+    {
+        return -1;
+    }
+
+    const size_t headerLen = alignUp(sizeof(CaptureFileHeader) + cfg.cfgText.size());
+    uint8_t *block = allocBlocks(headerLen);
+    if (block == nullptr)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+        return -1;
+    }
+    std::memset(block, 0, headerLen);
+    CaptureFileHeader hdr;
+    std::memset(&hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.magic, CAPTURE_FILE_MAGIC, sizeof(hdr.magic));
+    hdr.version = CAPTURE_VERSION;
+    hdr.headerLen = (uint32_t)headerLen;
+    hdr.createdRealtimeNs = clockNs(CLOCK_REALTIME);
+    hdr.createdMonotonicNs = clockNs(CLOCK_MONOTONIC);
+    hdr.cfgLen = (uint32_t)cfg.cfgText.size();
+    hdr.align = CAPTURE_ALIGN;
+    std::memcpy(block, &hdr, sizeof(hdr));
+    std::memcpy(block + sizeof(hdr), cfg.cfgText.data(), cfg.cfgText.size());
+    const int err = writeAll(block, headerLen);
+    std::free(block);
+    if (err < 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+        return -1;
+    }
+
+    m_fileOffset = headerLen;
+    m_closing = false;
+    m_thread = std::thread(&CaptureWriter::writerLoop, this);
+    return 0;
+}
+
+int CaptureWriter::writeAll(const uint8_t *p, size_t n)
+{
+    while (n > 0U)
+    {
+        const ssize_t done = write(m_fd, p, n);
+        if (done < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+            return -1;
+        }
+        p += done;
+        n -= (size_t)done;
+    }
+    return 0;
+}
+
+/* m_lock held. nullptr when maxPending segments wait for the disk */
+CaptureWriter::Segment *CaptureWriter::takeSegment()
+{
+    if (!m_free.empty())
+    {
+        Segment *s = m_free.back();
+        m_free.pop_back();
+        return s;
+    }
+    /* maxPending queued, one being written, one being filled */
+    if (m_numSegments >= m_cfg.maxPending + 2U)
+    {
+        return nullptr;
+    }
+    Segment *s = new Segment();
+    s->buf = allocBlocks(m_segmentCapacity);
+    if (s->buf == nullptr)
+    {
+        delete s;
+        return nullptr;
+    }
+    m_numSegments++;
+    return s;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Closes the segment being filled: places its index behind the
+ *      packets, pads it to the block size, fixes the file offsets and
+ *      queues it for the writer thread. m_lock held.
+ */
+void CaptureWriter::seal()
+{
+    Segment *s = m_fill;
+    m_fill = nullptr;
+    if ((s == nullptr) || s->entries.empty())
+    {
+        if (s != nullptr)
+        {
+            m_free.push_back(s);
+        }
+        return;
+    }
+
+    const size_t dataEnd = sizeof(CaptureSegmentHeader) + s->dataLen;
+    const size_t indexLen = s->entries.size() * sizeof(CaptureIndexEntry);
+    const size_t segmentLen = alignUp(dataEnd + indexLen);
+
+    for (CaptureIndexEntry &e : s->entries)
+    {
+        e.offset += m_fileOffset + sizeof(CaptureSegmentHeader);
+    }
+    std::memcpy(s->buf + dataEnd, s->entries.data(), indexLen);
+    std::memset(s->buf + dataEnd + indexLen, 0, segmentLen - dataEnd - indexLen);
+
+    CaptureSegmentHeader hdr;
+    std::memset(&hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.magic, CAPTURE_SEGMENT_MAGIC, sizeof(hdr.magic));
+    hdr.numFrames = (uint32_t)s->entries.size();
+    hdr.dataLen = s->dataLen;
+    hdr.segmentLen = segmentLen;
+    std::memcpy(s->buf, &hdr, sizeof(hdr));
+
+    m_fileOffset += segmentLen;
+    m_index.insert(m_index.end(), s->entries.begin(), s->entries.end());
+    m_pending.push_back(s);
+    m_cv.notify_one();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Adds a packet. Only copies; safe to call from a reader callback.
+ *
+ *  @param[in]  packet
+ *      The packet, header to padding
+ *  @param[in]  len
+ *      Its length
+ *  @param[in]  hostNs
+ *      CLOCK_MONOTONIC when it was received
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, the packet was dropped
+ */
+int CaptureWriter::append(const uint8_t *packet, uint32_t len, uint64_t hostNs)
+{
+    CaptureIndexEntry e;
+    e.offset = 0;
+    e.hostNs = hostNs;
+    e.frameNumber = 0;
+    e.timeCpuCycles = 0;
+    e.len = len;
+    e.tlvMask = 0;
+    if (len >= sizeof(MsgHeader))
+    {
+        const MsgHeader hdr = load<MsgHeader>(packet);
+        e.frameNumber = hdr.frameNumber;
+        e.timeCpuCycles = hdr.timeCpuCycles;
+
+        TlvParserConfig parserCfg;
+        parserCfg.sdkMajor = 0;
+        FrameView view;
+        if (parseFrame(packet, len, parserCfg, view) == PARSE_OK)
+        {
+            e.tlvMask = view.tlvMask;
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    const size_t room = m_segmentCapacity - sizeof(CaptureSegmentHeader);
+    if ((m_fd < 0) || m_closing || ((size_t)len + sizeof(CaptureIndexEntry) > room))
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+    if ((m_fill != nullptr) &&
+        (m_fill->dataLen + len + (m_fill->entries.size() + 1U) * sizeof(CaptureIndexEntry) > room))
+    {
+        seal();
+    }
+    if (m_fill == nullptr)
+    {
+        m_fill = takeSegment();
+        if (m_fill == nullptr)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return -1;
+        }
+        m_fill->firstNs = clockNs(CLOCK_MONOTONIC);
+    }
+
+    e.offset = m_fill->dataLen;
+    std::memcpy(m_fill->buf + sizeof(CaptureSegmentHeader) + m_fill->dataLen, packet, len);
+    m_fill->dataLen += len;
+    m_fill->entries.push_back(e);
+    m_frames.fetch_add(1, std::memory_order_relaxed);
+    m_bytes.fetch_add(len, std::memory_order_relaxed);
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Writer thread: writes the queued segments, and seals the segment
+ *      being filled once it is flushMs old.
+ */
+void CaptureWriter::writerLoop()
+{
+    const uint64_t flushNs = (uint64_t)m_cfg.flushMs * 1000000ULL;
+    std::unique_lock<std::mutex> guard(m_lock);
+
+    while (true)
+    {
+        if (m_pending.empty())
+        {
+            if (m_closing)
+            {
+                break;
+            }
+            m_cv.wait_for(guard, std::chrono::milliseconds(std::max<uint32_t>(m_cfg.flushMs / 4U, 1U)));
+            if ((m_fill != nullptr) && !m_fill->entries.empty() &&
+                (clockNs(CLOCK_MONOTONIC) - m_fill->firstNs >= flushNs))
+            {
+                seal();
+            }
+            continue;
+        }
+
+        Segment *s = m_pending.front();
+        m_pending.pop_front();
+        guard.unlock();
+
+        const CaptureSegmentHeader hdr = load<CaptureSegmentHeader>(s->buf);
+        writeAll(s->buf, (size_t)hdr.segmentLen);
+        m_segments.fetch_add(1, std::memory_order_relaxed);
+
+        guard.lock();
+        s->dataLen = 0;
+        s->entries.clear();
+        m_free.push_back(s);
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Writes what is buffered and the full index, and closes the file.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, some write failed
+ */
+int CaptureWriter::close()
+{
+    if (m_fd < 0)
+    {
+        return 0;
+    }
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        seal();
+        m_closing = true;
+        m_cv.notify_one();
+    }
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+    /* The full index, the trailer in the last bytes of its last block */
+    const size_t indexLen = m_index.size() * sizeof(CaptureIndexEntry);
+    const size_t blockLen = alignUp(indexLen + sizeof(CaptureTrailer));
+    uint8_t *block = allocBlocks(blockLen);
+    if (block != nullptr)
+    {
+        std::memset(block, 0, blockLen);
+        std::memcpy(block, m_index.data(), indexLen);
+        CaptureTrailer trailer;
+        std::memset(&trailer, 0, sizeof(trailer));
+        std::memcpy(trailer.magic, CAPTURE_TRAILER_MAGIC, sizeof(trailer.magic));
+        trailer.indexOffset = m_fileOffset;
+        trailer.numFrames = m_index.size();
+        std::memcpy(block + blockLen - sizeof(trailer), &trailer, sizeof(trailer));
+        writeAll(block, blockLen);
+        std::free(block);
+    }
+    else
+    {
+        m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (fdatasync(m_fd) < 0)
+    {
+        m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+    }
+    ::close(m_fd);
+    m_fd = -1;
+
+    for (Segment *s : m_free)
+    {
+        std::free(s->buf);
+        delete s;
+    }
+    m_free.clear();
+    m_numSegments = 0;
+    m_index.clear();
+    return (m_writeErrors.load() == 0U) ? 0 : -1;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Snapshot of the counters, safe from any thread.
+ */
+CaptureWriterStats CaptureWriter::stats() const
+{
+    CaptureWriterStats st;
+
+    st.frames = m_frames.load(std::memory_order_relaxed);
+    st.bytes = m_bytes.load(std::memory_order_relaxed);
+    st.segments = m_segments.load(std::memory_order_relaxed);
+    st.dropped = m_dropped.load(std::memory_order_relaxed);
+    st.writeErrors = m_writeErrors.load(std::memory_order_relaxed);
+    return st;
+}
+
+CaptureFile::~CaptureFile()
+{
+    close();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Maps a capture file and finds its index: the trailing one, or the
+ *      one rebuilt from the segments of a file that was not closed or
+ *      whose trailing index points outside the packet data.
+ *
+ *  @param[in]  path
+ *      Capture file
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int CaptureFile::open(const char *path)
+{
+    close();
+
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    struct stat st;
+    if ((fstat(fd, &st) < 0) || ((size_t)st.st_size < sizeof(CaptureFileHeader)))
+    {
+        ::close(fd);
+        return -1;
+    }
+    void *p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+    {
+        return -1;
+    }
+    m_base = (const uint8_t *)p;
+    m_size = (size_t)st.st_size;
+    m_header = (const CaptureFileHeader *)m_base;
+
+    if ((std::memcmp(m_header->magic, CAPTURE_FILE_MAGIC, sizeof(CAPTURE_FILE_MAGIC)) != 0) ||
+        (m_header->version != CAPTURE_VERSION) || (m_header->headerLen > m_size) ||
+        (sizeof(CaptureFileHeader) + m_header->cfgLen > m_header->headerLen))
+    {
+        close();
+        return -1;
+    }
+
+    if (m_size >= m_header->headerLen + sizeof(CaptureTrailer))
+    {
+        const CaptureTrailer *t = (const CaptureTrailer *)(m_base + m_size - sizeof(CaptureTrailer));
+        const uint64_t indexEnd = m_size - sizeof(CaptureTrailer);
+        if ((std::memcmp(t->magic, CAPTURE_TRAILER_MAGIC, sizeof(CAPTURE_TRAILER_MAGIC)) == 0) &&
+            (t->indexOffset <= indexEnd) &&
+            (t->numFrames <= (indexEnd - t->indexOffset) / sizeof(CaptureIndexEntry)) &&
+            ((t->indexOffset % alignof(CaptureIndexEntry)) == 0U))
+        {
+            /* A damaged entry would point readers outside the mapping */
+            const CaptureIndexEntry *index = (const CaptureIndexEntry *)(m_base + t->indexOffset);
+            uint64_t i = 0;
+            while ((i < t->numFrames) && (index[i].offset >= m_header->headerLen) &&
+                   (index[i].offset <= t->indexOffset) && (index[i].len <= t->indexOffset - index[i].offset))
+            {
+                i++;
+            }
+            if (i == t->numFrames)
+            {
+                m_index = index;
+                m_numFrames = (size_t)t->numFrames;
+                return 0;
+            }
+        }
+    }
+    return rebuildIndex();
+}
+
+/* Walks the segments up to the first incomplete one */
+int CaptureFile::rebuildIndex()
+{
+    uint64_t off = m_header->headerLen;
+
+    m_rebuilt.clear();
+    while (off + sizeof(CaptureSegmentHeader) <= m_size)
+    {
+        const CaptureSegmentHeader seg = load<CaptureSegmentHeader>(m_base + off);
+        if ((std::memcmp(seg.magic, CAPTURE_SEGMENT_MAGIC, sizeof(CAPTURE_SEGMENT_MAGIC)) != 0) ||
+            (seg.segmentLen > m_size - off) ||
+            (sizeof(CaptureSegmentHeader) + seg.dataLen + (uint64_t)seg.numFrames * sizeof(CaptureIndexEntry) >
+             seg.segmentLen))
+        {
+            break;
+        }
+        const uint8_t *entries = m_base + off + sizeof(CaptureSegmentHeader) + seg.dataLen;
+        for (uint32_t i = 0; i < seg.numFrames; i++)
+        {
+            const CaptureIndexEntry e = load<CaptureIndexEntry>(entries + i * sizeof(CaptureIndexEntry));
+            if ((e.offset < off) || (e.offset + e.len > off + sizeof(CaptureSegmentHeader) + seg.dataLen))
+            {
+                break;
+            }
+            m_rebuilt.push_back(e);
+        }
+        off += seg.segmentLen;
+    }
+    m_index = m_rebuilt.data();
+    m_numFrames = m_rebuilt.size();
+    m_recovered = true;
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Unmaps the file.
+ */
+void CaptureFile::close()
+{
+    if (m_base != nullptr)
+    {
+        munmap((void *)m_base, m_size);
+    }
+    m_base = nullptr;
+    m_size = 0;
+    m_header = nullptr;
+    m_index = nullptr;
+    m_numFrames = 0;
+    m_rebuilt.clear();
+    m_recovered = false;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      The .cfg text recorded with the capture.
+ */
+std::string CaptureFile::cfgText() const
+{
+    return std::string((const char *)m_base + sizeof(CaptureFileHeader), m_header->cfgLen);
+}
+
+/*
+ * First frame whose key is >= target, for keys that never decrease. The
+ * first guess is interpolated between the first and the last frame; when
+ * it is off, the search widens from there in doubling steps.
+ */
+template <typename Key>
+size_t CaptureFile::seek(uint64_t target, Key key) const
+{
+    const size_t n = m_numFrames;
+    if ((n == 0U) || (target <= key(m_index[0])))
+    {
+        return 0;
+    }
+    const uint64_t first = key(m_index[0]);
+    const uint64_t last = key(m_index[n - 1U]);
+    if (target > last)
+    {
+        return n;
+    }
+
+    size_t g = (size_t)((double)(target - first) / (double)(last - first) * (double)(n - 1U));
+    g = std::min(std::max<size_t>(g, 1U), n - 1U);
+
+    /* The answer is in (lo, hi]: key(lo) < target <= key(hi) */
+    size_t lo;
+    size_t hi;
+    if (key(m_index[g]) >= target)
+    {
+        hi = g;
+        size_t step = 1;
+        lo = (g > step) ? g - step : 0U;
+        while ((lo > 0U) && (key(m_index[lo]) >= target))
+        {
+            hi = lo;
+            step *= 2U;
+            lo = (lo > step) ? lo - step : 0U;
+        }
+    }
+    else
+    {
+        lo = g;
+        size_t step = 1;
+        hi = std::min(g + step, n - 1U);
+        while (key(m_index[hi]) < target)
+        {
+            lo = hi;
+            step *= 2U;
+            hi = std::min(hi + step, n - 1U);
+        }
+    }
+    while (hi - lo > 1U)
+    {
+        const size_t mid = lo + (hi - lo) / 2U;
+        if (key(m_index[mid]) >= target)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid;
+        }
+    }
+    return hi;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Seeks by frame number.
+ *
+ *  @retval
+ *      Index of the first frame with that frame number or a later one,
+ *      numFrames() if there is none
+ */
+size_t CaptureFile::seekFrame(uint32_t frameNumber) const
+{
+    return seek(frameNumber, [](const CaptureIndexEntry &e) { return (uint64_t)e.frameNumber; });
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Seeks by host time (CLOCK_MONOTONIC ns, as in the index).
+ *
+ *  @retval
+ *      Index of the first frame received at hostNs or later, numFrames()
+ *      if there is none
+ */
+size_t CaptureFile::seekTime(uint64_t hostNs) const
+{
+    return seek(hostNs, [](const CaptureIndexEntry &e) { return e.hostNs; });
+}
+
+} /* namespace mmw */
@@ -0,0 +1,277 @@
+/**
+ *   @file  capture_file.h
+ *
+ *   @brief
+ *      Indexed capture file of output packets.
+ *
+ *      Layout, every block a multiple of CAPTURE_ALIGN bytes:
+ *
+ *          CaptureFileHeader, the .cfg text
+ *          segment:  CaptureSegmentHeader, packets, CaptureIndexEntry[n]
+ *          segment:  ...
+ *          index:    CaptureIndexEntry[all], CaptureTrailer at the very end
+ *
+ *      Packets are stored exactly as received. Each segment carries the
+ *      index of its own packets, so a file whose writer died before writing
+ *      the trailing index is still readable by walking the segments.
+ *      All fields are little endian.
+ */
+#ifndef CAPTURE_FILE_H
+#define CAPTURE_FILE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mmw
+{
+
+/*! @brief   Block alignment of the file; writes are whole blocks */
+static const uint32_t CAPTURE_ALIGN = 4096;
+
+/*! @brief   Format version of CaptureFileHeader */
+static const uint32_t CAPTURE_VERSION = 1;
+
+static const char CAPTURE_FILE_MAGIC[8] = { 'M', 'M', 'W', 'C', 'A', 'P', '0', '1' };
+static const char CAPTURE_SEGMENT_MAGIC[8] = { 'M', 'M', 'W', 'C', 'S', 'E', 'G', 0 };
+static const char CAPTURE_TRAILER_MAGIC[8] = { 'M', 'M', 'W', 'C', 'E', 'N', 'D', 0 };
+
+/**
+ * @brief
+ *  Start of the file, followed by cfgLen bytes of .cfg text
+ */
+struct CaptureFileHeader
+{
+    char        magic[8];
+    uint32_t    version;
+
+    /*! @brief   Header, cfg text and padding: offset of the first segment */
+    uint32_t    headerLen;
+
+    /*! @brief   CLOCK_REALTIME and CLOCK_MONOTONIC at creation, in ns, to
+     *           map the monotonic packet times to wall time */
+    uint64_t    createdRealtimeNs;
+    uint64_t    createdMonotonicNs;
+
+    uint32_t    cfgLen;
+    uint32_t    align;
+    uint8_t     reserved[24];
+};
+
+/**
+ * @brief
+ *  Index entry of one packet
+ */
+struct CaptureIndexEntry
+{
+    /*! @brief   File offset of the packet */
+    uint64_t    offset;
+
+    /*! @brief   CLOCK_MONOTONIC when the packet was complete, ns */
+    uint64_t    hostNs;
+
+    uint32_t    frameNumber;
+    uint32_t    timeCpuCycles;
+    uint32_t    len;
+
+    /*! @brief   FrameView::tlvMask of the packet */
+    uint32_t    tlvMask;
+};
+
+/**
+ * @brief
+ *  Segment header
+ */
+struct CaptureSegmentHeader
+{
+    char        magic[8];
+    uint32_t    numFrames;
+    uint32_t    reserved0;
+
+    /*! @brief   Bytes of packets behind this header */
+    uint64_t    dataLen;
+
+    /*! @brief   Whole segment, padding included: offset of the next one */
+    uint64_t    segmentLen;
+
+    uint8_t     reserved[32];
+};
+
+/**
+ * @brief
+ *  Last bytes of a completely written file
+ */
+struct CaptureTrailer
+{
+    char        magic[8];
+
+    /*! @brief   File offset of the full index */
+    uint64_t    indexOffset;
+    uint64_t    numFrames;
+    uint64_t    reserved;
+};
+
+static_assert(sizeof(CaptureFileHeader) == 64, "CaptureFileHeader layout");
+static_assert(sizeof(CaptureIndexEntry) == 32, "CaptureIndexEntry layout");
+static_assert(sizeof(CaptureSegmentHeader) == 64, "CaptureSegmentHeader layout");
+static_assert(sizeof(CaptureTrailer) == 32, "CaptureTrailer layout");
+
+/**
+ * @brief
+ *  Writer configuration
+ */
+struct CaptureWriterConfig
+{
+    std::string path;
+
+    /*! @brief   Contents of the .cfg the sensor was started with */
+    std::string cfgText;
+
+    /*! @brief   Segment size; a segment goes to disk in one write */
+    size_t      segmentSize = 4U * 1024U * 1024U;
+
+    /*! @brief   A partly filled segment is written after this long */
+    uint32_t    flushMs = 1000;
+
+    /*! @brief   Segments waiting for the disk before packets are dropped */
+    uint32_t    maxPending = 16;
+
+    /*! @brief   Bypass the page cache with O_DIRECT */
+    bool        direct = false;
+};
+
+/**
+ * @brief
+ *  Writer counters
+ */
+struct CaptureWriterStats
+{
+    uint64_t    frames = 0;
+    uint64_t    bytes = 0;
+    uint64_t    segments = 0;
+    uint64_t    dropped = 0;
+    uint64_t    writeErrors = 0;
+};
+
+/**
+ * @brief
+ *  Background capture writer
+ *
+ * @details
+ *  append() copies the packet into the segment being filled and returns;
+ *  full segments are handed to a writer thread that writes each with a
+ *  single aligned write. append() never waits for the disk: when
+ *  maxPending segments are queued, packets are dropped and counted.
+ *  close() writes what is left and the full index.
+ */
+class CaptureWriter
+{
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter &) = delete;
+    CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+    int open(const CaptureWriterConfig &cfg);
+    int append(const uint8_t *packet, uint32_t len, uint64_t hostNs);
+    int close();
+
+    CaptureWriterStats stats() const;
+
+private:
+    struct Segment
+    {
+        uint8_t                         *buf = nullptr;
+        size_t                          dataLen = 0;
+        uint64_t                        firstNs = 0;
+        std::vector<CaptureIndexEntry>  entries;
+    };
+
+    Segment *takeSegment();
+    void seal();
+    void writerLoop();
+    int writeAll(const uint8_t *p, size_t n);
+
+    CaptureWriterConfig     m_cfg;
+    int                     m_fd = -1;
+    size_t                  m_segmentCapacity = 0;
+
+    std::mutex              m_lock;
+    std::condition_variable m_cv;
+    Segment                 *m_fill = nullptr;
+    std::deque<Segment *>   m_pending;
+    std::vector<Segment *>  m_free;
+    uint32_t                m_numSegments = 0;
+    uint64_t                m_fileOffset = 0;
+    std::vector<CaptureIndexEntry> m_index;
+    bool                    m_closing = false;
+    std::thread             m_thread;
+
+    std::atomic<uint64_t>   m_frames{0};
+    std::atomic<uint64_t>   m_bytes{0};
+    std::atomic<uint64_t>   m_segments{0};
+    std::atomic<uint64_t>   m_dropped{0};
+    std::atomic<uint64_t>   m_writeErrors{0};
+};
+
+/**
+ * @brief
+ *  Capture file mapped for reading
+ *
+ * @details
+ *  The file is mapped read only; packet() points into the mapping. Frames
+ *  are numbered 0..numFrames()-1 in file order. seekFrame() and seekTime()
+ *  guess the position from the first and last entry, which is exact for a
+ *  steady frame rate without drops, and only fall back to a binary search
+ *  around the guess otherwise.
+ */
+class CaptureFile
+{
+public:
+    CaptureFile() = default;
+    ~CaptureFile();
+
+    CaptureFile(const CaptureFile &) = delete;
+    CaptureFile &operator=(const CaptureFile &) = delete;
+
+    int open(const char *path);
+    void close();
+
+    const CaptureFileHeader &header() const     { return *m_header; }
+    std::string cfgText() const;
+
+    size_t numFrames() const                    { return m_numFrames; }
+    const CaptureIndexEntry &entry(size_t i) const { return m_index[i]; }
+    const uint8_t *packet(size_t i) const       { return m_base + m_index[i].offset; }
+
+    /*! @brief   True if the trailing index was missing and the index was
+     *           rebuilt from the segments */
+    bool recovered() const                      { return m_recovered; }
+
+    size_t seekFrame(uint32_t frameNumber) const;
+    size_t seekTime(uint64_t hostNs) const;
+
+private:
+    template <typename Key>
+    size_t seek(uint64_t target, Key key) const;
+    int rebuildIndex();
+
+    const uint8_t                   *m_base = nullptr;
+    size_t                          m_size = 0;
+    const CaptureFileHeader         *m_header = nullptr;
+    const CaptureIndexEntry         *m_index = nullptr;
+    size_t                          m_numFrames = 0;
+    std::vector<CaptureIndexEntry>  m_rebuilt;
+    bool                            m_recovered = false;
+};
+
+} /* namespace mmw */
+
+#endif /* CAPTURE_FILE_H */
@@ -0,0 +1,207 @@
+/**
+ *   @file  clock_sync.cpp
+ *
+ *   @brief
+ *      DSS cycle counter to host time, see clock_sync.h.
+ */
+#include <algorithm>
+#include <cmath>
+
+#include "clock_sync.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+/* Bounds the work per sample at high packet rates */
+const size_t MAX_SAMPLES = 4096;
+
+const uint32_t MAX_BUCKETS = 64;
+
+const double COUNTER_RANGE = 4294967296.0;
+
+} /* anonymous namespace */
+
+/**
+ *  @b Description
+ *  @n
+ *      Adds a sample and updates the estimate.
+ *
+ *  @param[in]  cycles
+ *      timeCpuCycles of the packet header
+ *  @param[in]  hostNs
+ *      CLOCK_MONOTONIC when the first byte of the packet came in
+ *
+ *  @retval
+ *      0 - sample added
+ *  @retval
+ *      1 - the sample was off by more than resetNs, the estimate restarted
+ *          from it
+ */
+int ClockSync::add(uint32_t cycles, uint64_t hostNs)
+{
+    int restarted = 0;
+    int64_t ext = cycles;
+    if (!m_samples.empty())
+    {
+        const Sample &last = m_samples.back();
+        int64_t d = (int64_t)(uint32_t)(cycles - (uint32_t)last.cycles);
+        if (hostNs > last.hostNs)
+        {
+            /* Whole wraps the host time says are missing */
+            const double expected = (double)(hostNs - last.hostNs) / m_nsPerCycle;
+            const double wraps = std::floor((expected - (double)d) / COUNTER_RANGE + 0.5);
+            if (wraps > 0.0)
+            {
+                d += (int64_t)wraps << 32;
+            }
+        }
+        ext = last.cycles + d;
+        if (synced() && (std::fabs((double)hostNs - predict(ext)) > (double)m_cfg.resetNs))
+        {
+            reset();
+            m_restarts++;
+            ext = cycles;
+            restarted = 1;
+        }
+    }
+
+    m_samples.push_back(Sample{ ext, hostNs });
+    m_numSamples++;
+    while ((m_samples.size() > 1U) &&
+           ((hostNs - m_samples.front().hostNs > m_cfg.windowNs) || (m_samples.size() > MAX_SAMPLES)))
+    {
+        m_samples.pop_front();
+    }
+    fit();
+    const double delay = (double)hostNs - predict(ext);
+    m_lastDelayNs = (delay > 0.0) ? (uint64_t)delay : 0U;
+    return restarted;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Forgets every sample.
+ */
+void ClockSync::reset()
+{
+    m_samples.clear();
+    m_intercept = 0.0;
+    m_slope = 0.0;
+    m_lastDelayNs = 0;
+}
+
+double ClockSync::predict(int64_t cycles) const
+{
+    const double x = (double)(cycles - m_refCycles);
+    return (double)m_refHostNs + x * m_nsPerCycle + m_intercept + m_slope * x;
+}
+
+void ClockSync::fit()
+{
+    struct Lowest
+    {
+        double  x;
+        double  y;
+        bool    set;
+    };
+    Lowest lowest[MAX_BUCKETS];
+    const uint32_t numBuckets = std::max(1U, std::min(m_cfg.numBuckets, MAX_BUCKETS));
+    std::fill(lowest, lowest + numBuckets, Lowest{ 0.0, 0.0, false });
+
+    /* y is the arrival relative to the nominal counter rate */
+    m_refCycles = m_samples.front().cycles;
+    m_refHostNs = m_samples.front().hostNs;
+    const uint64_t width = (m_samples.back().hostNs - m_refHostNs) / numBuckets + 1U;
+    for (const Sample &s : m_samples)
+    {
+        const double x = (double)(s.cycles - m_refCycles);
+        const double y = (double)(s.hostNs - m_refHostNs) - x * m_nsPerCycle;
+        Lowest &l = lowest[std::min<uint64_t>((s.hostNs - m_refHostNs) / width, numBuckets - 1U)];
+        if (!l.set || (y < l.y))
+        {
+            l = Lowest{ x, y, true };
+        }
+    }
+
+    /* Drift: least squares through the earliest arrivals */
+    double n = 0.0;
+    double mx = 0.0;
+    double my = 0.0;
+    for (uint32_t b = 0; b < numBuckets; b++)
+    {
+        if (lowest[b].set)
+        {
+            n += 1.0;
+            mx += lowest[b].x;
+            my += lowest[b].y;
+        }
+    }
+    if (n >= 2.0)
+    {
+        mx /= n;
+        my /= n;
+        double sxy = 0.0;
+        double sxx = 0.0;
+        for (uint32_t b = 0; b < numBuckets; b++)
+        {
+            if (lowest[b].set)
+            {
+                sxy += (lowest[b].x - mx) * (lowest[b].y - my);
+                sxx += (lowest[b].x - mx) * (lowest[b].x - mx);
+            }
+        }
+        if (sxx > 0.0)
+        {
+            m_slope = sxy / sxx;
+        }
+    }
+
+    /* Offset: the line through the earliest arrival of all */
+    double intercept = 0.0;
+    bool first = true;
+    for (uint32_t b = 0; b < numBuckets; b++)
+    {
+        if (lowest[b].set && (first || (lowest[b].y - m_slope * lowest[b].x < intercept)))
+        {
+            intercept = lowest[b].y - m_slope * lowest[b].x;
+            first = false;
+        }
+    }
+    m_intercept = intercept;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Host time of a counter value, e.g. the header of a packet. The
+ *      value is unwrapped against the last sample, so it has to be within
+ *      half a wrap (3.6 s) of it.
+ *
+ *  @param[in]  cycles
+ *      DSS cycle counter
+ *
+ *  @retval
+ *      CLOCK_MONOTONIC in ns, 0 without samples
+ */
+uint64_t ClockSync::toHostNs(uint32_t cycles) const
+{
+    if (m_samples.empty())
+    {
+        return 0;
+    }
+    const Sample &last = m_samples.back();
+    const int64_t ext = last.cycles + (int32_t)(cycles - (uint32_t)last.cycles);
+    const double ns = predict(ext);
+    return (ns > 0.0) ? (uint64_t)std::llround(ns) : 0U;
+}
+
+int64_t ClockSync::offsetNs() const
+{
+    return m_samples.empty() ? 0 : (int64_t)std::llround(predict(0));
+}
+
+} /* namespace mmw */
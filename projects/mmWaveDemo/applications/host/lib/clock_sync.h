@@ -0,0 +1,116 @@
+/**
+ *   @file  clock_sync.h
+ *
+ *   @brief
+ *      Maps the DSS cycle counter of the output packet header
+ *      (timeCpuCycles) to host CLOCK_MONOTONIC.
+ */
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <cstdint>
+#include <deque>
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  Clock sync configuration
+ */
+struct ClockSyncConfig
+{
+    /*! @brief   Nominal rate of timeCpuCycles: the 600 MHz C674x of the
+     *           xWR16xx */
+    double      cpuClockHz = 600e6;
+
+    /*! @brief   Samples older than this are forgotten, so the estimate
+     *           follows slow drift changes (temperature) */
+    uint64_t    windowNs = 60ULL * 1000000000ULL;
+
+    /*! @brief   The window is cut into this many pieces and the earliest
+     *           arrival of each is fitted */
+    uint32_t    numBuckets = 8;
+
+    /*! @brief   Samples before the estimate is used */
+    uint32_t    minSamples = 16;
+
+    /*! @brief   A sample this far off the estimate restarts it, e.g. after
+     *           the device was reset */
+    uint64_t    resetNs = 1000000000ULL;
+};
+
+/**
+ * @brief
+ *  DSS cycle counter to host time
+ *
+ * @details
+ *  Each sample pairs the counter in a packet with the host time its first
+ *  byte came in. The link only ever adds delay, so the samples lie on or
+ *  above the true mapping shifted by the fastest delivery. The estimate is
+ *  the lower envelope: the earliest arrival in each of numBuckets pieces
+ *  of the window gives the drift by a least squares fit, and the line is
+ *  then lowered onto the earliest sample of all. Delays of single packets
+ *  (UART queueing, USB polling, scheduling) do not pull it.
+ *
+ *  The 32-bit counter wraps every 7.2 s at 600 MHz; it is unwrapped with
+ *  the host time between samples, so packets must come at least every few
+ *  seconds.
+ *
+ *  The fastest delivery itself cannot be told apart from the offset by
+ *  one-way timestamps: delays measured against toHostNs() are above the
+ *  best packet of the window.
+ */
+class ClockSync
+{
+public:
+    explicit ClockSync(const ClockSyncConfig &cfg = ClockSyncConfig())
+        : m_cfg(cfg), m_nsPerCycle(1e9 / cfg.cpuClockHz) {}
+
+    int add(uint32_t cycles, uint64_t hostNs);
+    void reset();
+
+    bool synced() const             { return m_samples.size() >= m_cfg.minSamples; }
+    uint64_t toHostNs(uint32_t cycles) const;
+
+    /*! @brief   Counter rate error, positive when the DSS runs fast */
+    double driftPpm() const         { return -m_slope / m_nsPerCycle * 1e6; }
+
+    /*! @brief   Host time when the unwrapped counter read 0 */
+    int64_t offsetNs() const;
+
+    /*! @brief   How late the last sample came, relative to the envelope */
+    uint64_t lastDelayNs() const    { return m_lastDelayNs; }
+
+    uint64_t samples() const        { return m_numSamples; }
+    uint64_t restarts() const       { return m_restarts; }
+
+private:
+    struct Sample
+    {
+        int64_t     cycles;
+        uint64_t    hostNs;
+    };
+
+    double predict(int64_t cycles) const;
+    void fit();
+
+    ClockSyncConfig     m_cfg;
+    double              m_nsPerCycle;
+    std::deque<Sample>  m_samples;
+
+    /* host = m_refHostNs + x * m_nsPerCycle + m_intercept + m_slope * x,
+     * x = cycles - m_refCycles */
+    int64_t             m_refCycles = 0;
+    uint64_t            m_refHostNs = 0;
+    double              m_intercept = 0.0;
+    double              m_slope = 0.0;
+
+    uint64_t            m_lastDelayNs = 0;
+    uint64_t            m_numSamples = 0;
+    uint64_t            m_restarts = 0;
+};
+
+} /* namespace mmw */
+
+#endif /* CLOCK_SYNC_H */
@@ -0,0 +1,224 @@
+/**
+ *   @file  crc32c.cpp
+ *
+ *   @brief
+ *      CRC-32C, see crc32c.h.
+ */
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#endif
+
+#include "crc32c.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+/*
+ * The CRC instruction has a latency of about three cycles and a throughput
+ * of one, so a single chain runs at a third of what the unit can do. Long
+ * buffers are therefore taken in blocks of three lanes, each with its own
+ * chain from zero, and the lane CRCs are joined: moving a CRC register
+ * over LANE zero bytes is linear, so it is done with four table lookups
+ * (Shift), which the CRC instruction itself fills at load time.
+ */
+const size_t LANE = 256;
+
+const uint8_t ZEROS[LANE] = { 0 };
+
+struct Shift
+{
+    uint32_t    t[4][256];
+
+    uint32_t operator()(uint32_t c) const
+    {
+        return t[0][c & 0xFFU] ^ t[1][(c >> 8) & 0xFFU] ^ t[2][(c >> 16) & 0xFFU] ^ t[3][c >> 24];
+    }
+};
+
+Shift gShift;
+
+inline uint64_t load64(const uint8_t *p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* Fills gShift from a function running the raw register over bytes */
+template <typename RunFn>
+void initShift(RunFn run)
+{
+    for (uint32_t k = 0; k < 4U; k++)
+    {
+        for (uint32_t v = 0; v < 256U; v++)
+        {
+            gShift.t[k][v] = run(v << (8U * k), ZEROS, LANE);
+        }
+    }
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("sse4.2")))
+uint32_t runSse42(uint32_t reg, const uint8_t *p, size_t n)
+{
+    uint64_t c = reg;
+    for (; n >= 8U; n -= 8U, p += 8U)
+    {
+        c = _mm_crc32_u64(c, load64(p));
+    }
+    for (; n > 0U; n--)
+    {
+        c = _mm_crc32_u8((uint32_t)c, *p++);
+    }
+    return (uint32_t)c;
+}
+
+__attribute__((target("sse4.2")))
+uint32_t crc32cSse42(uint32_t crc, const uint8_t *p, size_t n)
+{
+    uint32_t c0 = ~crc;
+
+    for (; n >= 3U * LANE; n -= 3U * LANE, p += 3U * LANE)
+    {
+        uint64_t a = c0;
+        uint64_t b = 0;
+        uint64_t c = 0;
+        for (size_t i = 0; i < LANE; i += 8U)
+        {
+            a = _mm_crc32_u64(a, load64(p + i));
+            b = _mm_crc32_u64(b, load64(p + LANE + i));
+            c = _mm_crc32_u64(c, load64(p + 2U * LANE + i));
+        }
+        c0 = gShift(gShift((uint32_t)a) ^ (uint32_t)b) ^ (uint32_t)c;
+    }
+    return ~runSse42(c0, p, n);
+}
+
+#elif defined(__aarch64__)
+
+__attribute__((target("+crc")))
+uint32_t runArmv8(uint32_t reg, const uint8_t *p, size_t n)
+{
+    uint32_t c = reg;
+    for (; n >= 8U; n -= 8U, p += 8U)
+    {
+        c = __crc32cd(c, load64(p));
+    }
+    for (; n > 0U; n--)
+    {
+        c = __crc32cb(c, *p++);
+    }
+    return c;
+}
+
+__attribute__((target("+crc")))
+uint32_t crc32cArmv8(uint32_t crc, const uint8_t *p, size_t n)
+{
+    uint32_t c0 = ~crc;
+
+    for (; n >= 3U * LANE; n -= 3U * LANE, p += 3U * LANE)
+    {
+        uint32_t a = c0;
+        uint32_t b = 0;
+        uint32_t c = 0;
+        for (size_t i = 0; i < LANE; i += 8U)
+        {
+            a = __crc32cd(a, load64(p + i));
+            b = __crc32cd(b, load64(p + LANE + i));
+            c = __crc32cd(c, load64(p + 2U * LANE + i));
+        }
+        c0 = gShift(gShift(a) ^ b) ^ c;
+    }
+    return ~runArmv8(c0, p, n);
+}
+
+#endif
+
+using CrcFn = uint32_t (*)(uint32_t, const uint8_t *, size_t);
+
+struct CrcImpl
+{
+    CrcFn       fn;
+    const char  *name;
+};
+
+CrcImpl selectCrc()
+{
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+        initShift(runSse42);
+        return { crc32cSse42, "sse4.2" };
+    }
+#elif defined(__aarch64__) && defined(HWCAP_CRC32)
+    if ((getauxval(AT_HWCAP) & HWCAP_CRC32) != 0U)
+    {
+        initShift(runArmv8);
+        return { crc32cArmv8, "armv8" };
+    }
+#endif
+    return { crc32cTable, "table" };
+}
+
+const CrcImpl gCrc = selectCrc();
+
+} /* anonymous namespace */
+
+/**
+ *  @b Description
+ *  @n
+ *      Updates a CRC-32C with a buffer, on the CRC instructions of the CPU
+ *      when it has them (chosen once at load time). Same chaining as
+ *      MmwDemo_crc32c: start from MMW_CRC32C_INIT and pass the CRC of the
+ *      preceding data.
+ *
+ *  @retval
+ *      CRC of the preceding data and data
+ */
+uint32_t crc32c(uint32_t crc, const uint8_t *data, size_t len)
+{
+    return gCrc.fn(crc, data, len);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      The table code of the MSS, for buffers of any size; the reference
+ *      for the instruction versions.
+ *
+ *  @retval
+ *      CRC of the preceding data and data
+ */
+uint32_t crc32cTable(uint32_t crc, const uint8_t *data, size_t len)
+{
+    while (len > 0U)
+    {
+        const uint32_t n = (len > 0x80000000U) ? 0x80000000U : (uint32_t)len;
+        crc = MmwDemo_crc32c(crc, data, n);
+        data += n;
+        len -= n;
+    }
+    return crc;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Name of the version crc32c() runs: "sse4.2", "armv8" or "table".
+ */
+const char *crc32cImpl()
+{
+    return gCrc.name;
+}
+
+} /* namespace mmw */
@@ -0,0 +1,26 @@
+/**
+ *   @file  crc32c.h
+ *
+ *   @brief
+ *      CRC-32C of the output packets on the CRC instructions of the host:
+ *      SSE4.2 on x86, the CRC32 extension on ARMv8, else the table code of
+ *      the MSS (board/common/mmw_crc32c.c).
+ */
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mmw_crc32c.h"
+
+namespace mmw
+{
+
+uint32_t crc32c(uint32_t crc, const uint8_t *data, size_t len);
+uint32_t crc32cTable(uint32_t crc, const uint8_t *data, size_t len);
+const char *crc32cImpl();
+
+} /* namespace mmw */
+
+#endif /* CRC32C_H */
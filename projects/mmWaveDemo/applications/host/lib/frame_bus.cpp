@@ -0,0 +1,526 @@
+/**
+ *   @file  frame_bus.cpp
+ *
+ *   @brief
+ *      Shared memory frame bus, see frame_bus.h.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "frame_bus.h"
+#include "host_clock.h"
+#include "mmw_wire.h"
+#include "tlv_parser.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+/*! @brief   Format version of FrameBusHeader */
+const uint32_t FRAME_BUS_VERSION = 1;
+
+/* The futex word is shared between processes: no FUTEX_PRIVATE_FLAG */
+void futexWait(std::atomic<uint32_t> *word, uint32_t val, int timeoutMs)
+{
+    struct timespec ts;
+    ts.tv_sec = timeoutMs / 1000;
+    ts.tv_nsec = (long)(timeoutMs % 1000) * 1000000L;
+    syscall(SYS_futex, (uint32_t *)word, FUTEX_WAIT, val, &ts, nullptr, 0);
+}
+
+void futexWakeAll(std::atomic<uint32_t> *word)
+{
+    syscall(SYS_futex, (uint32_t *)word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+std::string shmName(const std::string &name)
+{
+    return (!name.empty() && (name[0] == '/')) ? name : "/" + name;
+}
+
+size_t slotStride(uint32_t slotSize)
+{
+    return sizeof(FrameBusSlot) + slotSize;
+}
+
+size_t mapLength(uint32_t slotCount, uint32_t slotSize)
+{
+    return sizeof(FrameBusHeader) + (size_t)slotCount * slotStride(slotSize);
+}
+
+bool pidAlive(int32_t pid)
+{
+    return (pid > 0) && ((kill(pid, 0) == 0) || (errno == EPERM));
+}
+
+uint64_t monotonicMs()
+{
+    return monotonicNs() / 1000000ULL;
+}
+
+} /* anonymous namespace */
+
+FrameBusProducer::~FrameBusProducer()
+{
+    close();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Creates the bus, or takes over the one a previous producer left if
+ *      it has the same geometry, so that its consumers carry on. A bus of
+ *      another geometry is unlinked and created anew; its consumers see the
+ *      producer gone and have to open the bus again.
+ *
+ *  @param[in]  cfg
+ *      Bus geometry
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, also when another producer is running on the bus
+ */
+int FrameBusProducer::open(const FrameBusConfig &cfg)
+{
+    if ((m_hdr != nullptr) || (cfg.slotCount == 0U) ||
+        ((cfg.slotCount & (cfg.slotCount - 1U)) != 0U) || (cfg.slotSize < sizeof(MsgHeader)))
+    {
+        return -1;
+    }
+    m_cfg = cfg;
+    m_cfg.slotSize = (cfg.slotSize + 63U) & ~63U;
+    m_mapLen = mapLength(m_cfg.slotCount, m_cfg.slotSize);
+
+    const std::string name = shmName(m_cfg.name);
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0666);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    bool reuse = false;
+    struct stat st;
+    if ((fstat(fd, &st) == 0) && ((size_t)st.st_size == m_mapLen))
+    {
+        void *p = mmap(nullptr, m_mapLen, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED)
+        {
+            FrameBusHeader *hdr = (FrameBusHeader *)p;
+            if ((memcmp(hdr->magic, FRAME_BUS_MAGIC, sizeof(hdr->magic)) == 0) &&
+                (hdr->version == FRAME_BUS_VERSION) && (hdr->slotCount == m_cfg.slotCount) &&
+                (hdr->slotSize == m_cfg.slotSize))
+            {
+                if (pidAlive(hdr->producerPid.load()) && (hdr->producerPid.load() != getpid()))
+                {
+                    munmap(p, m_mapLen);
+                    ::close(fd);
+                    return -1;
+                }
+                m_hdr = hdr;
+                reuse = true;
+            }
+            else
+            {
+                munmap(p, m_mapLen);
+            }
+        }
+    }
+
+    if (!reuse)
+    {
+        /* Never shrink a segment someone may have mapped: start a new one */
+        ::close(fd);
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+        if (fd < 0)
+        {
+            return -1;
+        }
+        if (ftruncate(fd, (off_t)m_mapLen) != 0)
+        {
+            ::close(fd);
+            shm_unlink(name.c_str());
+            return -1;
+        }
+        void *p = mmap(nullptr, m_mapLen, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            ::close(fd);
+            shm_unlink(name.c_str());
+            return -1;
+        }
+        /* Fresh memory is zero, which is every counter at its start */
+        m_hdr = (FrameBusHeader *)p;
+        m_hdr->version = FRAME_BUS_VERSION;
+        m_hdr->slotCount = m_cfg.slotCount;
+        m_hdr->slotSize = m_cfg.slotSize;
+        m_hdr->headerLen = sizeof(FrameBusHeader);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(m_hdr->magic, FRAME_BUS_MAGIC, sizeof(m_hdr->magic));
+    }
+    ::close(fd);
+
+    m_slots = (uint8_t *)m_hdr + sizeof(FrameBusHeader);
+    m_hdr->producerPid.store(getpid());
+    m_hdr->epoch.fetch_add(1);
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Publishes one complete output packet. Never waits: the oldest slot
+ *      is overwritten whatever the consumers are doing with it.
+ *
+ *  @param[in]  packet
+ *      Packet, from the magic word on
+ *  @param[in]  len
+ *      Packet length
+ *  @param[in]  hostNs
+ *      CLOCK_MONOTONIC when the packet was received
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, the packet is larger than a slot or does not parse
+ */
+int FrameBusProducer::publish(const uint8_t *packet, uint32_t len, uint64_t hostNs)
+{
+    if ((m_hdr == nullptr) || (len > m_cfg.slotSize))
+    {
+        return -1;
+    }
+    TlvParserConfig parserCfg;
+    parserCfg.sdkMajor = 0;
+    FrameView view;
+    if (parseFrame(packet, len, parserCfg, view) != PARSE_OK)
+    {
+        return -1;
+    }
+
+    const uint64_t seq = m_hdr->writeSeq.load(std::memory_order_relaxed);
+    uint8_t *base = m_slots + (size_t)(seq & (m_cfg.slotCount - 1U)) * slotStride(m_cfg.slotSize);
+    FrameBusSlot *slot = (FrameBusSlot *)base;
+
+    slot->state.store(2U * seq + 1U, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->hostNs = hostNs;
+    slot->len = len;
+    slot->frameNumber = view.header.frameNumber;
+    slot->tlvMask = view.tlvMask;
+    memcpy(base + sizeof(FrameBusSlot), packet, len);
+    slot->state.store(2U * seq + 2U, std::memory_order_release);
+
+    m_hdr->writeSeq.store(seq + 1U, std::memory_order_release);
+    m_hdr->notify.fetch_add(1);
+    if (m_hdr->waiters.load() != 0U)
+    {
+        futexWakeAll(&m_hdr->notify);
+    }
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Detaches from the bus. Waiting consumers are woken and find the
+ *      producer gone.
+ *
+ *  @param[in]  unlink
+ *      Remove the bus from /dev/shm as well
+ */
+void FrameBusProducer::close(bool unlink)
+{
+    if (m_hdr == nullptr)
+    {
+        return;
+    }
+    m_hdr->producerPid.store(0);
+    m_hdr->notify.fetch_add(1);
+    futexWakeAll(&m_hdr->notify);
+    munmap(m_hdr, m_mapLen);
+    m_hdr = nullptr;
+    m_slots = nullptr;
+    if (unlink)
+    {
+        shm_unlink(shmName(m_cfg.name).c_str());
+    }
+}
+
+FrameBusConsumer::~FrameBusConsumer()
+{
+    close();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Attaches to a bus and lists this consumer in it.
+ *
+ *  @param[in]  busName
+ *      Bus name, as given to the producer
+ *  @param[in]  name
+ *      Name of this consumer in the bus listing
+ *  @param[in]  fromOldest
+ *      Start with the oldest packet still on the bus instead of the next
+ *      one published
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, no bus or not a bus
+ */
+int FrameBusConsumer::open(const std::string &busName, const std::string &name, bool fromOldest)
+{
+    if (m_hdr != nullptr)
+    {
+        return -1;
+    }
+    const int fd = shm_open(shmName(busName).c_str(), O_RDWR, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || ((size_t)st.st_size < sizeof(FrameBusHeader)))
+    {
+        ::close(fd);
+        return -1;
+    }
+    m_mapLen = (size_t)st.st_size;
+    void *p = mmap(nullptr, m_mapLen, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+    {
+        return -1;
+    }
+    m_hdr = (FrameBusHeader *)p;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if ((memcmp(m_hdr->magic, FRAME_BUS_MAGIC, sizeof(m_hdr->magic)) != 0) ||
+        (m_hdr->version != FRAME_BUS_VERSION) || (m_hdr->slotCount == 0U) ||
+        (mapLength(m_hdr->slotCount, m_hdr->slotSize) != m_mapLen))
+    {
+        munmap(p, m_mapLen);
+        m_hdr = nullptr;
+        return -1;
+    }
+    m_slots = (const uint8_t *)m_hdr + sizeof(FrameBusHeader);
+
+    const uint64_t w = m_hdr->writeSeq.load(std::memory_order_acquire);
+    m_cursor = w;
+    if (fromOldest)
+    {
+        m_cursor = (w > m_hdr->slotCount) ? w - m_hdr->slotCount : 0U;
+    }
+    m_lost = 0;
+
+    /* Take a free entry, or one of a consumer that died without closing */
+    const int32_t self = getpid();
+    for (uint32_t i = 0; (i < FRAME_BUS_MAX_CONSUMERS) && (m_info == nullptr); i++)
+    {
+        FrameBusConsumerInfo &info = m_hdr->consumers[i];
+        int32_t pid = info.pid.load();
+        if (((pid == 0) || !pidAlive(pid)) && info.pid.compare_exchange_strong(pid, self))
+        {
+            strncpy(info.name, name.c_str(), sizeof(info.name) - 1U);
+            info.name[sizeof(info.name) - 1U] = '\0';
+            info.cursor.store(m_cursor, std::memory_order_relaxed);
+            info.lost.store(0, std::memory_order_relaxed);
+            m_info = &info;
+        }
+    }
+    return 0;
+}
+
+void FrameBusConsumer::addLost(uint64_t n)
+{
+    m_lost += n;
+    if (m_info != nullptr)
+    {
+        m_info->lost.store(m_lost, std::memory_order_relaxed);
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Hands out the next packet, in place. A consumer more than slotCount
+ *      packets behind skips to the newest packet on the bus; the packets
+ *      skipped are counted in lost().
+ *
+ *  @param[out] frame
+ *      The packet; check valid() once done with it
+ *  @param[in]  timeoutMs
+ *      Longest wait for a packet, <0 waits until one comes
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, no packet within the timeout
+ */
+int FrameBusConsumer::next(FrameBusFrame &frame, int timeoutMs)
+{
+    if (m_hdr == nullptr)
+    {
+        return -1;
+    }
+    const uint32_t slotCount = m_hdr->slotCount;
+    const uint32_t slotSize = m_hdr->slotSize;
+    const uint64_t deadline = (timeoutMs >= 0) ? monotonicMs() + (uint64_t)timeoutMs : UINT64_MAX;
+
+    for (;;)
+    {
+        const uint64_t w = m_hdr->writeSeq.load(std::memory_order_acquire);
+        if (m_cursor < w)
+        {
+            if (w - m_cursor > slotCount)
+            {
+                /* Fell off the ring: the newest packet is the one with the
+                 * longest time left before it is reused */
+                addLost(w - 1U - m_cursor);
+                m_cursor = w - 1U;
+            }
+            const uint8_t *base = m_slots + (size_t)(m_cursor & (slotCount - 1U)) * slotStride(slotSize);
+            const FrameBusSlot *slot = (const FrameBusSlot *)base;
+            const uint64_t state = slot->state.load(std::memory_order_acquire);
+            if (state != 2U * m_cursor + 2U)
+            {
+                /* Overwritten since writeSeq was read */
+                addLost(1);
+                m_cursor++;
+                continue;
+            }
+            frame.data = base + sizeof(FrameBusSlot);
+            frame.len = std::min(slot->len, slotSize);
+            frame.frameNumber = slot->frameNumber;
+            frame.tlvMask = slot->tlvMask;
+            frame.hostNs = slot->hostNs;
+            frame.seq = m_cursor;
+            frame.slot = slot;
+            frame.state = state;
+            m_cursor++;
+            if (m_info != nullptr)
+            {
+                m_info->cursor.store(m_cursor, std::memory_order_relaxed);
+            }
+            return 0;
+        }
+
+        const uint64_t now = monotonicMs();
+        if (now >= deadline)
+        {
+            return -1;
+        }
+        /* Sleep in slices, a producer that dies does not wake anyone */
+        const int sliceMs = (int)std::min<uint64_t>(deadline - now, 1000U);
+        m_hdr->waiters.fetch_add(1);
+        const uint32_t val = m_hdr->notify.load();
+        if (m_hdr->writeSeq.load() == w)
+        {
+            futexWait(&m_hdr->notify, val, sliceMs);
+        }
+        m_hdr->waiters.fetch_sub(1);
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Tells whether the packet handed out by next() is still intact. True
+ *      means whatever was read from it before the call is good.
+ *
+ *  @param[in]  frame
+ *      Packet from next()
+ *
+ *  @retval
+ *      True if the producer has not overwritten it, false otherwise; a
+ *      false is counted in lost()
+ */
+bool FrameBusConsumer::valid(const FrameBusFrame &frame)
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (frame.slot->state.load(std::memory_order_relaxed) == frame.state)
+    {
+        return true;
+    }
+    addLost(1);
+    return false;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Copies the packet handed out by next() and checks the copy is
+ *      intact.
+ *
+ *  @param[in]  frame
+ *      Packet from next()
+ *  @param[out] dst
+ *      Destination
+ *  @param[in]  dstLen
+ *      Room at dst
+ *
+ *  @retval
+ *      Success -   Packet length
+ *  @retval
+ *      Error   -   <0, too small or overwritten during the copy
+ */
+int FrameBusConsumer::copy(const FrameBusFrame &frame, uint8_t *dst, size_t dstLen)
+{
+    if (frame.len > dstLen)
+    {
+        return -1;
+    }
+    memcpy(dst, frame.data, frame.len);
+    return valid(frame) ? (int)frame.len : -1;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Tells whether a producer is attached to the bus.
+ *
+ *  @retval
+ *      True if the producer process is running
+ */
+bool FrameBusConsumer::producerAlive() const
+{
+    return (m_hdr != nullptr) && pidAlive(m_hdr->producerPid.load());
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Detaches from the bus and frees the entry in its listing.
+ */
+void FrameBusConsumer::close()
+{
+    if (m_hdr == nullptr)
+    {
+        return;
+    }
+    if (m_info != nullptr)
+    {
+        m_info->pid.store(0);
+        m_info = nullptr;
+    }
+    munmap(m_hdr, m_mapLen);
+    m_hdr = nullptr;
+    m_slots = nullptr;
+}
+
+} /* namespace mmw */
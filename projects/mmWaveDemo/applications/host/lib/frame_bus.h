@@ -0,0 +1,197 @@
+/**
+ *   @file  frame_bus.h
+ *
+ *   @brief
+ *      Shared memory frame bus: one process publishes the output packets
+ *      into a ring in /dev/shm, any number of processes read them in place,
+ *      each at its own pace.
+ */
+#ifndef FRAME_BUS_H
+#define FRAME_BUS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace mmw
+{
+
+static const char FRAME_BUS_MAGIC[8] = { 'M', 'M', 'W', 'B', 'U', 'S', '0', '1' };
+
+/*! @brief   Consumers listed in the bus for monitoring */
+static const uint32_t FRAME_BUS_MAX_CONSUMERS = 32;
+
+/**
+ * @brief
+ *  Consumer entry in the bus, written by the consumer only
+ */
+struct FrameBusConsumerInfo
+{
+    /*! @brief   0 when the entry is free */
+    std::atomic<int32_t>    pid;
+    char                    name[28];
+    std::atomic<uint64_t>   cursor;
+    std::atomic<uint64_t>   lost;
+    uint8_t                 reserved[16];
+};
+
+/**
+ * @brief
+ *  Start of the shared memory
+ *
+ * @details
+ *  writeSeq counts the packets published; packet s is in slot
+ *  s % slotCount. The producer never waits for consumers: a consumer that
+ *  falls more than slotCount packets behind loses what it missed and
+ *  resumes at the newest packet.
+ */
+struct FrameBusHeader
+{
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    slotCount;
+    uint32_t    slotSize;
+    uint32_t    headerLen;
+    std::atomic<int32_t>    producerPid;
+
+    /*! @brief   Bumped every time a producer attaches */
+    std::atomic<uint32_t>   epoch;
+
+    alignas(64) std::atomic<uint64_t> writeSeq;
+
+    /*! @brief   Futex word, bumped on every publish */
+    alignas(64) std::atomic<uint32_t> notify;
+    std::atomic<uint32_t>   waiters;
+
+    alignas(64) FrameBusConsumerInfo consumers[FRAME_BUS_MAX_CONSUMERS];
+};
+
+/**
+ * @brief
+ *  Slot header; the packet follows it
+ *
+ * @details
+ *  state is a seqlock: 2s + 1 while packet s is written, 2s + 2 once it is
+ *  complete. A reader that sees the same even value before and after using
+ *  the packet knows it was not overwritten meanwhile.
+ */
+struct FrameBusSlot
+{
+    std::atomic<uint64_t>   state;
+    uint64_t                hostNs;
+    uint32_t                len;
+    uint32_t                frameNumber;
+    uint32_t                tlvMask;
+    uint8_t                 reserved[36];
+};
+
+static_assert(sizeof(FrameBusSlot) == 64, "FrameBusSlot layout");
+static_assert(sizeof(FrameBusConsumerInfo) == 64, "FrameBusConsumerInfo layout");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must be lock free");
+
+/**
+ * @brief
+ *  Bus geometry
+ */
+struct FrameBusConfig
+{
+    /*! @brief   Shared memory name, /dev/shm/<name> */
+    std::string name = "mmw_frames";
+
+    /*! @brief   Packets kept, a power of two */
+    uint32_t    slotCount = 64;
+
+    /*! @brief   Largest packet */
+    uint32_t    slotSize = 128U * 1024U;
+};
+
+/**
+ * @brief
+ *  Publishing side, one per bus
+ */
+class FrameBusProducer
+{
+public:
+    FrameBusProducer() = default;
+    ~FrameBusProducer();
+
+    FrameBusProducer(const FrameBusProducer &) = delete;
+    FrameBusProducer &operator=(const FrameBusProducer &) = delete;
+
+    int open(const FrameBusConfig &cfg);
+    int publish(const uint8_t *packet, uint32_t len, uint64_t hostNs);
+    void close(bool unlink = false);
+
+    FrameBusHeader *header() const { return m_hdr; }
+
+private:
+    FrameBusConfig  m_cfg;
+    FrameBusHeader  *m_hdr = nullptr;
+    uint8_t         *m_slots = nullptr;
+    size_t          m_mapLen = 0;
+};
+
+/**
+ * @brief
+ *  Packet read from the bus, in place
+ */
+struct FrameBusFrame
+{
+    const uint8_t       *data;
+    uint32_t            len;
+    uint32_t            frameNumber;
+    uint32_t            tlvMask;
+    uint64_t            hostNs;
+
+    /*! @brief   Sequence number of the packet on the bus */
+    uint64_t            seq;
+
+    const FrameBusSlot  *slot;
+    uint64_t            state;
+};
+
+/**
+ * @brief
+ *  Reading side; any number per bus, in any process
+ *
+ * @details
+ *  next() hands out the packet in the shared memory. The producer may
+ *  overwrite it while it is used if this consumer is slotCount packets
+ *  behind, so whatever was derived from it only counts if valid() still
+ *  holds afterwards; copy() does both for a private copy.
+ */
+class FrameBusConsumer
+{
+public:
+    FrameBusConsumer() = default;
+    ~FrameBusConsumer();
+
+    FrameBusConsumer(const FrameBusConsumer &) = delete;
+    FrameBusConsumer &operator=(const FrameBusConsumer &) = delete;
+
+    int open(const std::string &busName, const std::string &name, bool fromOldest = false);
+    int next(FrameBusFrame &frame, int timeoutMs);
+    bool valid(const FrameBusFrame &frame);
+    int copy(const FrameBusFrame &frame, uint8_t *dst, size_t dstLen);
+    void close();
+
+    bool producerAlive() const;
+    uint64_t lost() const       { return m_lost; }
+    uint64_t cursor() const     { return m_cursor; }
+    const FrameBusHeader *header() const { return m_hdr; }
+
+private:
+    void addLost(uint64_t n);
+
+    FrameBusHeader          *m_hdr = nullptr;
+    const uint8_t           *m_slots = nullptr;
+    size_t                  m_mapLen = 0;
+    FrameBusConsumerInfo    *m_info = nullptr;
+    uint64_t                m_cursor = 0;
+    uint64_t                m_lost = 0;
+};
+
+} /* namespace mmw */
+
+#endif /* FRAME_BUS_H */
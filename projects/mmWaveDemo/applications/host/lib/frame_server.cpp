@@ -0,0 +1,529 @@
+/**
+ *   @file  frame_server.cpp
+ *
+ *   @brief
+ *      TCP fan-out server, see frame_server.h.
+ */
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "frame_server.h"
+#include "host_clock.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+/* Buffers handed to one gather write, well below IOV_MAX */
+const uint32_t MAX_IOV = 64;
+
+const uint32_t MAX_EVENTS = 256;
+
+/* Non blocking listening socket, -1 on failure */
+int listenSocket(const FrameServerConfig &cfg)
+{
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    struct addrinfo *res = nullptr;
+    if (getaddrinfo(cfg.bindAddress.empty() ? nullptr : cfg.bindAddress.c_str(),
+                    std::to_string(cfg.port).c_str(), &hints, &res) != 0)
+    {
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo *ai = res; (ai != nullptr) && (fd < 0); ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC | SOCK_NONBLOCK, ai->ai_protocol);
+        if (fd < 0)
+        {
+            continue;
+        }
+        const int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if ((bind(fd, ai->ai_addr, ai->ai_addrlen) != 0) || (listen(fd, SOMAXCONN) != 0))
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+uint16_t localPort(int fd)
+{
+    struct sockaddr_storage addr;
+    socklen_t len = sizeof(addr);
+    if (getsockname(fd, (struct sockaddr *)&addr, &len) != 0)
+    {
+        return 0;
+    }
+    if (addr.ss_family == AF_INET6)
+    {
+        return ntohs(((const struct sockaddr_in6 *)&addr)->sin6_port);
+    }
+    return ntohs(((const struct sockaddr_in *)&addr)->sin_port);
+}
+
+} /* anonymous namespace */
+
+FrameServer::~FrameServer()
+{
+    stop();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Listens and starts the server thread.
+ *
+ *  @param[in]  cfg
+ *      Server configuration
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, bad configuration, address in use or already started
+ */
+int FrameServer::start(const FrameServerConfig &cfg)
+{
+    if (m_thread.joinable() || (cfg.maxQueueFrames < 2U) || (cfg.maxClients == 0U) ||
+        (cfg.maxPacketLen == 0U))
+    {
+        return -1;
+    }
+    m_cfg = cfg;
+    m_listenFd = listenSocket(cfg);
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ((m_listenFd < 0) || (m_epollFd < 0) || (m_wakeFd < 0))
+    {
+        stop();
+        return -1;
+    }
+    for (int fd : { m_listenFd, m_wakeFd })
+    {
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        {
+            stop();
+            return -1;
+        }
+    }
+    m_port = localPort(m_listenFd);
+    m_seq = 0;
+    m_incoming.clear();
+    m_newest.reset();
+    m_stats = FrameServerStats();
+    m_io = FrameServerStats();
+    m_stop.store(false);
+    m_thread = std::thread(&FrameServer::ioLoop, this);
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Queues a packet for every client. The packet is copied once; the
+ *      clients are served from that copy. Never waits.
+ *
+ *  @param[in]  packet
+ *      Output packet, from the magic word
+ *  @param[in]  len
+ *      Its length
+ *  @param[in]  frameNumber
+ *      Frame number of the packet, passed on in the header
+ *  @param[in]  hostNs
+ *      CLOCK_MONOTONIC when the packet came in
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, not started or the packet is too long
+ */
+int FrameServer::publish(const uint8_t *packet, uint32_t len, uint32_t frameNumber, uint64_t hostNs)
+{
+    if (!m_thread.joinable() || (len == 0U) || (len > m_cfg.maxPacketLen))
+    {
+        return -1;
+    }
+    std::shared_ptr<Frame> frame = std::make_shared<Frame>();
+    frame->bytes.resize(sizeof(FrameServerMsgHeader) + len);
+    frame->pushNs = monotonicNs();
+    FrameServerMsgHeader hdr;
+    hdr.magic = FRAME_SERVER_MAGIC;
+    hdr.len = len;
+    hdr.frameNumber = frameNumber;
+    hdr.hostNs = hostNs;
+    std::memcpy(frame->bytes.data() + sizeof(hdr), packet, len);
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        hdr.seq = m_seq++;
+        std::memcpy(frame->bytes.data(), &hdr, sizeof(hdr));
+        m_stats.frames++;
+        if (m_incoming.size() >= m_cfg.maxQueueFrames)
+        {
+            m_incoming.pop_front();
+            m_stats.overruns++;
+        }
+        m_incoming.push_back(std::move(frame));
+    }
+
+    const uint64_t one = 1;
+    if (write(m_wakeFd, &one, sizeof(one)) < 0)
+    {
+        /* Already signalled */
+    }
+    return 0;
+}
+
+void FrameServer::acceptClients()
+{
+    while (true)
+    {
+        const int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            /* EAGAIN once the backlog is drained; on EMFILE and the like
+             * the next wakeup tries again */
+            return;
+        }
+        if (m_clients.size() >= m_cfg.maxClients)
+        {
+            ::close(fd);
+            m_io.refused++;
+            continue;
+        }
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (m_cfg.sendBufferBytes > 0)
+        {
+            setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &m_cfg.sendBufferBytes, sizeof(m_cfg.sendBufferBytes));
+        }
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        {
+            ::close(fd);
+            m_io.refused++;
+            continue;
+        }
+        Client &c = m_clients[fd];
+        c.fd = fd;
+        c.sinceNs = monotonicNs();
+        m_io.accepted++;
+        if (m_newest)
+        {
+            enqueue(c, m_newest);
+            if (flushClient(c, c.sinceNs) < 0)
+            {
+                closeClient(fd);
+            }
+        }
+    }
+}
+
+void FrameServer::closeClient(int fd)
+{
+    auto it = m_clients.find(fd);
+    if (it == m_clients.end())
+    {
+        return;
+    }
+    /* Closing removes it from the epoll set */
+    ::close(fd);
+    m_clients.erase(it);
+    m_io.disconnects++;
+}
+
+void FrameServer::enqueue(Client &c, const FramePtr &frame)
+{
+    /* The front packet stays once its first bytes are out, or the stream
+     * would lose its framing */
+    const size_t keep = (c.offset != 0U) ? 1U : 0U;
+    while ((c.queue.size() > keep) &&
+           ((c.queue.size() >= m_cfg.maxQueueFrames) ||
+            (c.queuedBytes + frame->bytes.size() > m_cfg.maxQueueBytes)))
+    {
+        c.queuedBytes -= c.queue[keep]->bytes.size();
+        c.queue.erase(c.queue.begin() + (ptrdiff_t)keep);
+        m_io.dropped++;
+        c.hadDrops = true;
+    }
+    c.queue.push_back(frame);
+    c.queuedBytes += frame->bytes.size();
+}
+
+void FrameServer::watchOut(Client &c, bool on)
+{
+    if (c.watchOut == on)
+    {
+        return;
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLRDHUP | (on ? EPOLLOUT : 0U);
+    ev.data.fd = c.fd;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_MOD, c.fd, &ev) == 0)
+    {
+        c.watchOut = on;
+    }
+}
+
+/* Writes as much of the queue as the socket takes; <0 when the client is gone */
+int FrameServer::flushClient(Client &c, uint64_t now)
+{
+    while (!c.queue.empty())
+    {
+        struct iovec iov[MAX_IOV];
+        uint32_t n = 0;
+        for (auto it = c.queue.begin(); (it != c.queue.end()) && (n < MAX_IOV); ++it, n++)
+        {
+            const size_t skip = (n == 0U) ? c.offset : 0U;
+            iov[n].iov_base = (void *)((*it)->bytes.data() + skip);
+            iov[n].iov_len = (*it)->bytes.size() - skip;
+        }
+
+        /* writev, as sendmsg for MSG_NOSIGNAL */
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = n;
+        const ssize_t sent = sendmsg(c.fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                watchOut(c, true);
+                return 0;
+            }
+            return -1;
+        }
+        m_io.writes++;
+        m_io.bytesSent += (uint64_t)sent;
+
+        size_t left = (size_t)sent;
+        while (left > 0U)
+        {
+            const Frame &f = *c.queue.front();
+            const size_t rest = f.bytes.size() - c.offset;
+            if (left < rest)
+            {
+                c.offset += left;
+                break;
+            }
+            left -= rest;
+            m_io.delivered++;
+            if (f.pushNs >= c.sinceNs)
+            {
+                m_io.latency.add(now - f.pushNs);
+            }
+            c.queuedBytes -= f.bytes.size();
+            c.offset = 0;
+            c.queue.pop_front();
+        }
+        if (!c.queue.empty() && (c.offset != 0U))
+        {
+            /* A short write: the socket is full */
+            watchOut(c, true);
+            return 0;
+        }
+    }
+    watchOut(c, false);
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Server thread: accepts, hands every published packet to the
+ *      queues and writes them out.
+ */
+void FrameServer::ioLoop()
+{
+    struct epoll_event events[MAX_EVENTS];
+    std::deque<FramePtr> incoming;
+    std::vector<int> gone;
+    char sink[4096];
+
+    while (!m_stop.load())
+    {
+        const int n = epoll_wait(m_epollFd, events, (int)MAX_EVENTS, 100);
+        if ((n < 0) && (errno != EINTR))
+        {
+            break;
+        }
+        const uint64_t now = monotonicNs();
+        bool published = false;
+
+        for (int i = 0; i < n; i++)
+        {
+            const int fd = events[i].data.fd;
+            if (fd == m_wakeFd)
+            {
+                uint64_t v;
+                if (read(m_wakeFd, &v, sizeof(v)) < 0)
+                {
+                    /* Drained already */
+                }
+                published = true;
+                continue;
+            }
+            if (fd == m_listenFd)
+            {
+                acceptClients();
+                continue;
+            }
+
+            auto it = m_clients.find(fd);
+            if (it == m_clients.end())
+            {
+                continue;
+            }
+            Client &c = it->second;
+            bool closed = (events[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) != 0U;
+            if (!closed && ((events[i].events & EPOLLIN) != 0U))
+            {
+                const ssize_t got = recv(fd, sink, sizeof(sink), MSG_DONTWAIT);
+                closed = (got == 0) || ((got < 0) && (errno != EAGAIN) && (errno != EINTR));
+            }
+            if (!closed && ((events[i].events & EPOLLOUT) != 0U))
+            {
+                closed = flushClient(c, now) < 0;
+            }
+            if (closed)
+            {
+                closeClient(fd);
+            }
+        }
+
+        if (published)
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                incoming.swap(m_incoming);
+            }
+            /* Queue everything first so one write per client takes it all */
+            for (const FramePtr &frame : incoming)
+            {
+                for (auto &kv : m_clients)
+                {
+                    enqueue(kv.second, frame);
+                }
+            }
+            if (!incoming.empty())
+            {
+                m_newest = incoming.back();
+            }
+            incoming.clear();
+
+            gone.clear();
+            for (auto &kv : m_clients)
+            {
+                if (!kv.second.watchOut && (flushClient(kv.second, now) < 0))
+                {
+                    gone.push_back(kv.first);
+                }
+            }
+            for (int fd : gone)
+            {
+                closeClient(fd);
+            }
+        }
+
+        m_io.clients = (uint32_t)m_clients.size();
+        m_io.maxQueued = 0;
+        m_io.clientsDropping = 0;
+        for (const auto &kv : m_clients)
+        {
+            if (kv.second.queue.size() > m_io.maxQueued)
+            {
+                m_io.maxQueued = (uint32_t)kv.second.queue.size();
+            }
+            m_io.clientsDropping += kv.second.hadDrops ? 1U : 0U;
+        }
+        m_io.ioCpuNs = clockNs(CLOCK_THREAD_CPUTIME_ID);
+
+        std::lock_guard<std::mutex> guard(m_lock);
+        const uint64_t frames = m_stats.frames;
+        const uint64_t overruns = m_stats.overruns;
+        m_stats = m_io;
+        m_stats.frames = frames;
+        m_stats.overruns = overruns;
+    }
+
+    for (auto &kv : m_clients)
+    {
+        ::close(kv.first);
+    }
+    m_clients.clear();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Stops the server thread and closes every connection. Packets still
+ *      queued are discarded.
+ */
+void FrameServer::stop()
+{
+    if (m_thread.joinable())
+    {
+        m_stop.store(true);
+        const uint64_t one = 1;
+        if (write(m_wakeFd, &one, sizeof(one)) < 0)
+        {
+            /* The counter can't overflow with a single write */
+        }
+        m_thread.join();
+    }
+    for (int *fd : { &m_listenFd, &m_epollFd, &m_wakeFd })
+    {
+        if (*fd >= 0)
+        {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_incoming.clear();
+    m_newest.reset();
+    m_stats.clients = 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Snapshot of the counters, as of the last wakeup of the server
+ *      thread.
+ */
+FrameServerStats FrameServer::stats() const
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_stats;
+}
+
+} /* namespace mmw */
@@ -0,0 +1,205 @@
+/**
+ *   @file  frame_server.h
+ *
+ *   @brief
+ *      Serves the output packets to any number of TCP clients, each
+ *      packet behind a short length prefixed header.
+ */
+#ifndef FRAME_SERVER_H
+#define FRAME_SERVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "lag_histogram.h"
+
+namespace mmw
+{
+
+/*! @brief   "MMWF" as a little endian word */
+static const uint32_t FRAME_SERVER_MAGIC = 0x46574D4DU;
+
+/**
+ * @brief
+ *  Header in front of every packet on the wire, little endian
+ */
+struct FrameServerMsgHeader
+{
+    uint32_t    magic;
+
+    /*! @brief   Packet bytes behind the header */
+    uint32_t    len;
+
+    /*! @brief   Counts the packets published; a gap is what was dropped
+     *           for this client */
+    uint32_t    seq;
+
+    uint32_t    frameNumber;
+
+    /*! @brief   CLOCK_MONOTONIC when the packet came in */
+    uint64_t    hostNs;
+};
+
+static_assert(sizeof(FrameServerMsgHeader) == 24, "FrameServerMsgHeader layout");
+
+/**
+ * @brief
+ *  Server configuration
+ */
+struct FrameServerConfig
+{
+    /*! @brief   Local address to listen on; the loopback by default */
+    std::string     bindAddress = "127.0.0.1";
+
+    /*! @brief   0 picks a free port, see FrameServer::port() */
+    uint16_t        port = 7410;
+
+    /*! @brief   Further connections are closed at once */
+    uint32_t        maxClients = 1024;
+
+    /*! @brief   Packets queued per client; beyond either bound the oldest
+     *           not yet started is dropped */
+    uint32_t        maxQueueFrames = 64;
+    size_t          maxQueueBytes = 4U << 20;
+
+    uint32_t        maxPacketLen = 1U << 20;
+
+    /*! @brief   SO_SNDBUF of the client sockets, 0 keeps the default */
+    int             sendBufferBytes = 0;
+};
+
+/**
+ * @brief
+ *  Server counters. Deliveries count packets written to one client.
+ */
+struct FrameServerStats
+{
+    /*! @brief   Packets published */
+    uint64_t        frames = 0;
+
+    /*! @brief   Published while the server thread was more than
+     *           maxQueueFrames behind, sent to nobody */
+    uint64_t        overruns = 0;
+
+    uint64_t        accepted = 0;
+    uint64_t        refused = 0;
+    uint64_t        disconnects = 0;
+    uint32_t        clients = 0;
+
+    uint64_t        delivered = 0;
+
+    /*! @brief   Deliveries dropped from the queues of slow clients */
+    uint64_t        dropped = 0;
+
+    /*! @brief   Clients which had at least one packet dropped */
+    uint32_t        clientsDropping = 0;
+
+    uint64_t        bytesSent = 0;
+
+    /*! @brief   Gather writes, deliveries / writes is the batching */
+    uint64_t        writes = 0;
+
+    /*! @brief   Packets queued for the client furthest behind */
+    uint32_t        maxQueued = 0;
+
+    /*! @brief   CPU time of the server thread */
+    uint64_t        ioCpuNs = 0;
+
+    /*! @brief   publish() to the last byte of a delivery written */
+    LagHistogram    latency;
+};
+
+/**
+ * @brief
+ *  TCP fan-out server
+ *
+ * @details
+ *  publish() copies a packet once, with its header, into a reference
+ *  counted buffer and hands it to the server thread, which queues a
+ *  reference for every client. One epoll thread serves all clients over
+ *  non-blocking sockets: a client's queue goes out with one gather write
+ *  straight from the shared buffers, so nothing is copied per client, and
+ *  EPOLLOUT is only watched while a socket is full. Each queue is bounded
+ *  by maxQueueFrames and maxQueueBytes; a slow client has its oldest
+ *  packets dropped, never the one it is in the middle of, and sees the
+ *  gap in seq. Nobody waits for a slow client, publish() never waits at
+ *  all. A new client gets the newest packet at once, then every one
+ *  after it. What clients send is read and ignored.
+ */
+class FrameServer
+{
+public:
+    FrameServer() = default;
+    ~FrameServer();
+
+    FrameServer(const FrameServer &) = delete;
+    FrameServer &operator=(const FrameServer &) = delete;
+
+    int start(const FrameServerConfig &cfg);
+    int publish(const uint8_t *packet, uint32_t len, uint32_t frameNumber, uint64_t hostNs);
+    void stop();
+
+    uint16_t port() const           { return m_port; }
+    FrameServerStats stats() const;
+
+private:
+    struct Frame
+    {
+        std::vector<uint8_t>    bytes;
+        uint64_t                pushNs;
+    };
+
+    using FramePtr = std::shared_ptr<const Frame>;
+
+    struct Client
+    {
+        int                     fd = -1;
+
+        /*! @brief   Connected; the latency counts packets published since */
+        uint64_t                sinceNs = 0;
+        std::deque<FramePtr>    queue;
+        size_t                  queuedBytes = 0;
+
+        /*! @brief   Bytes of queue.front() already written */
+        size_t                  offset = 0;
+        bool                    watchOut = false;
+        bool                    hadDrops = false;
+    };
+
+    void acceptClients();
+    void closeClient(int fd);
+    void enqueue(Client &c, const FramePtr &frame);
+    int flushClient(Client &c, uint64_t now);
+    void watchOut(Client &c, bool on);
+    void ioLoop();
+
+    FrameServerConfig       m_cfg;
+    std::thread             m_thread;
+    std::atomic<bool>       m_stop{false};
+    int                     m_listenFd = -1;
+    int                     m_epollFd = -1;
+    int                     m_wakeFd = -1;
+    uint16_t                m_port = 0;
+
+    /* Server thread side */
+    std::unordered_map<int, Client> m_clients;
+    FramePtr                m_newest;
+    FrameServerStats        m_io;
+
+    mutable std::mutex      m_lock;
+    uint32_t                m_seq = 0;
+    std::deque<FramePtr>    m_incoming;
+    FrameServerStats        m_stats;
+};
+
+} /* namespace mmw */
+
+#endif /* FRAME_SERVER_H */
@@ -0,0 +1,37 @@
+/**
+ *   @file  host_clock.cpp
+ *
+ *   @brief
+ *      Host clocks in ns, see host_clock.h.
+ */
+#include "host_clock.h"
+
+namespace mmw
+{
+
+/**
+ *  @b Description
+ *  @n
+ *      Time of a clock in ns.
+ *
+ *  @param[in]  id
+ *      Clock, e.g. CLOCK_REALTIME or CLOCK_THREAD_CPUTIME_ID
+ */
+uint64_t clockNs(clockid_t id)
+{
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      CLOCK_MONOTONIC in ns, the time base of the host timestamps.
+ */
+uint64_t monotonicNs()
+{
+    return clockNs(CLOCK_MONOTONIC);
+}
+
+} /* namespace mmw */
@@ -0,0 +1,22 @@
+/**
+ *   @file  host_clock.h
+ *
+ *   @brief
+ *      Host clocks in ns. CLOCK_MONOTONIC is the time base of every host
+ *      timestamp: frames, captures, replay, the sinks and the frame server.
+ */
+#ifndef HOST_CLOCK_H
+#define HOST_CLOCK_H
+
+#include <cstdint>
+#include <ctime>
+
+namespace mmw
+{
+
+uint64_t clockNs(clockid_t id);
+uint64_t monotonicNs();
+
+} /* namespace mmw */
+
+#endif /* HOST_CLOCK_H */
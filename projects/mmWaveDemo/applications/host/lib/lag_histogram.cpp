@@ -0,0 +1,79 @@
+/**
+ *   @file  lag_histogram.cpp
+ *
+ *   @brief
+ *      Log2 histogram of durations, see lag_histogram.h.
+ */
+#include <algorithm>
+
+#include "lag_histogram.h"
+
+namespace mmw
+{
+
+void LagHistogram::add(uint64_t ns)
+{
+    const uint32_t b = (ns == 0U) ? 0U : (uint32_t)(64 - __builtin_clzll(ns));
+    buckets[std::min(b, NUM_BUCKETS - 1U)]++;
+    count++;
+    sumNs += ns;
+    maxNs = std::max(maxNs, ns);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Percentile, interpolated linearly inside its log2 bucket.
+ *
+ *  @param[in]  p
+ *      Fraction, e.g. 0.99
+ */
+uint64_t LagHistogram::percentile(double p) const
+{
+    const uint64_t rank = (uint64_t)(p * (double)count);
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < NUM_BUCKETS; b++)
+    {
+        if (seen + buckets[b] > rank)
+        {
+            const uint64_t low = lower(b);
+            const double within = ((double)(rank - seen) + 0.5) / (double)buckets[b];
+            return std::min<uint64_t>(low + (uint64_t)(within * (double)(lower(b + 1U) - low)), maxNs);
+        }
+        seen += buckets[b];
+    }
+    return maxNs;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Lower bound of a bucket; bucket b holds [lower(b), lower(b + 1)).
+ */
+uint64_t LagHistogram::lower(uint32_t b)
+{
+    return (b == 0U) ? 0U : 1ULL << (b - 1U);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      What was added after the snapshot before, for interval reports. The
+ *      maximum stays the overall one.
+ *
+ *  @param[in]  before
+ *      Earlier copy of this histogram
+ */
+LagHistogram LagHistogram::since(const LagHistogram &before) const
+{
+    LagHistogram h = *this;
+    h.count -= before.count;
+    h.sumNs -= before.sumNs;
+    for (uint32_t b = 0; b < NUM_BUCKETS; b++)
+    {
+        h.buckets[b] -= before.buckets[b];
+    }
+    return h;
+}
+
+} /* namespace mmw */
@@ -0,0 +1,37 @@
+/**
+ *   @file  lag_histogram.h
+ *
+ *   @brief
+ *      Log2 histogram of durations, for latency and lag reports.
+ */
+#ifndef LAG_HISTOGRAM_H
+#define LAG_HISTOGRAM_H
+
+#include <cstdint>
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  Log2 histogram of durations in ns
+ */
+struct LagHistogram
+{
+    static const uint32_t NUM_BUCKETS = 40;
+
+    uint64_t    count = 0;
+    uint64_t    sumNs = 0;
+    uint64_t    maxNs = 0;
+    uint64_t    buckets[NUM_BUCKETS] = { 0 };
+
+    void add(uint64_t ns);
+    uint64_t percentile(double p) const;
+    LagHistogram since(const LagHistogram &before) const;
+
+    static uint64_t lower(uint32_t b);
+};
+
+} /* namespace mmw */
+
+#endif /* LAG_HISTOGRAM_H */
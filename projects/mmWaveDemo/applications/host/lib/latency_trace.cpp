@@ -0,0 +1,84 @@
+/**
+ *   @file  latency_trace.cpp
+ *
+ *   @brief
+ *      Per stage frame latency, see latency_trace.h.
+ */
+#include "latency_trace.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+uint64_t elapsed(uint64_t from, uint64_t to)
+{
+    return (to > from) ? to - from : 0U;
+}
+
+} /* anonymous namespace */
+
+/**
+ *  @b Description
+ *  @n
+ *      Feeds the clock sync with the packet and adds its stages. The host
+ *      stages are always counted, the ones that need the device clock once
+ *      the clock sync has enough samples.
+ *
+ *  @param[in]  frame
+ *      Parsed packet
+ *  @param[in]  times
+ *      Host times of the packet
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, clock not synchronized yet, only host stages counted
+ */
+int LatencyTracer::add(const FrameView &frame, const FrameTimes &times)
+{
+    const uint64_t arrivalNs = (times.firstByteNs != 0U) ? times.firstByteNs : times.lastByteNs;
+    m_clock.add(frame.header.timeCpuCycles, arrivalNs);
+
+    if (times.firstByteNs != 0U)
+    {
+        m_stages[LATENCY_WIRE].add(elapsed(times.firstByteNs, times.lastByteNs));
+    }
+    m_stages[LATENCY_HOST_QUEUE].add(elapsed(times.lastByteNs, times.receivedNs));
+    m_stages[LATENCY_HOST_WORK].add(elapsed(times.receivedNs, times.doneNs));
+
+    uint64_t processingNs = 0;
+    if (frame.haveStats)
+    {
+        processingNs = (uint64_t)frame.stats.interFrameProcessingTime * 1000U;
+        m_stages[LATENCY_PROCESSING].add(processingNs);
+        m_stages[LATENCY_TRANSMIT].add((uint64_t)frame.stats.transmitOutputTime * 1000U);
+    }
+
+    if (!m_clock.synced())
+    {
+        m_unsynced++;
+        return -1;
+    }
+    const uint64_t messageNs = m_clock.toHostNs(frame.header.timeCpuCycles);
+    m_stages[LATENCY_LINK].add(elapsed(messageNs, arrivalNs));
+    m_stages[LATENCY_AGE].add(elapsed(messageNs - processingNs, times.doneNs));
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Short name of a stage for reports.
+ */
+const char *LatencyTracer::stageName(LatencyStage s)
+{
+    static const char *const names[LATENCY_NUM_STAGES] =
+    {
+        "processing", "transmit", "link", "wire", "host queue", "host work", "age"
+    };
+    return (s < LATENCY_NUM_STAGES) ? names[s] : "?";
+}
+
+} /* namespace mmw */
@@ -0,0 +1,93 @@
+/**
+ *   @file  latency_trace.h
+ *
+ *   @brief
+ *      Breaks the age of each frame, from the end of its chirps to a host
+ *      consumer, into device, link and host stages.
+ */
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <cstdint>
+
+#include "clock_sync.h"
+#include "lag_histogram.h"
+#include "tlv_parser.h"
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  Stages of a frame
+ */
+enum LatencyStage : uint32_t
+{
+    LATENCY_PROCESSING  = 0,    /*!< End of chirps to the output message, interFrameProcessingTime */
+    LATENCY_TRANSMIT    = 1,    /*!< Output message to shipped by the MSS, transmitOutputTime of the
+                                     previous frame as the device reports it */
+    LATENCY_LINK        = 2,    /*!< Output message to the first byte on the host, above the fastest
+                                     packet of the clock sync window */
+    LATENCY_WIRE        = 3,    /*!< First to last byte on the host */
+    LATENCY_HOST_QUEUE  = 4,    /*!< Last byte to the consumer */
+    LATENCY_HOST_WORK   = 5,    /*!< Consumer, from the packet to done */
+    LATENCY_AGE         = 6,    /*!< End of chirps to consumer done */
+    LATENCY_NUM_STAGES  = 7
+};
+
+/**
+ * @brief
+ *  Host times of one frame, CLOCK_MONOTONIC ns
+ */
+struct FrameTimes
+{
+    /*! @brief   First byte of the packet, 0 if not known (the frame bus
+     *           only keeps the last) */
+    uint64_t    firstByteNs = 0;
+
+    uint64_t    lastByteNs = 0;
+
+    /*! @brief   The consumer has the packet */
+    uint64_t    receivedNs = 0;
+
+    /*! @brief   The consumer is done with it */
+    uint64_t    doneNs = 0;
+};
+
+/**
+ * @brief
+ *  Per stage latency histograms
+ *
+ * @details
+ *  The device stages come from the stats TLV (microseconds), the link
+ *  stages from timeCpuCycles mapped to host time by a ClockSync fed with
+ *  the same packets. timeCpuCycles is taken right after the inter-frame
+ *  processing, so the end of the chirps is that minus
+ *  interFrameProcessingTime. The link stage is measured against the
+ *  fastest packet of the window (see ClockSync); a link that is slow all
+ *  the time shows up only as offset.
+ */
+class LatencyTracer
+{
+public:
+    explicit LatencyTracer(const ClockSyncConfig &cfg = ClockSyncConfig()) : m_clock(cfg) {}
+
+    int add(const FrameView &frame, const FrameTimes &times);
+
+    const LagHistogram &stage(LatencyStage s) const { return m_stages[s]; }
+    const ClockSync &clock() const                  { return m_clock; }
+
+    /*! @brief   Frames not traced while the clock sync started */
+    uint64_t unsynced() const                       { return m_unsynced; }
+
+    static const char *stageName(LatencyStage s);
+
+private:
+    ClockSync       m_clock;
+    LagHistogram    m_stages[LATENCY_NUM_STAGES];
+    uint64_t        m_unsynced = 0;
+};
+
+} /* namespace mmw */
+
+#endif /* LATENCY_TRACE_H */
@@ -0,0 +1,451 @@
+/**
+ *   @file  link_budget.cpp
+ *
+ *   @brief
+ *      Output packet sizes and link budget, see link_budget.h.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "link_budget.h"
+#include "mmw_heatmap_codec.h"
+#include "mmw_heatmap_sparse.h"
+#include "mmw_output_sched.h"
+#include "mmw_profile_delta.h"
+#include "mmw_spi_frame.h"
+#include "mmw_wire.h"
+#include "replay.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+/*! @brief   Most objects the DSS sends, MMW_MAX_OBJ_OUT */
+const uint32_t MAX_OBJ_OUT = 100;
+
+/*! @brief   TLV slots of the DSS message, MMWDEMO_OUTPUT_MSG_MAX */
+const uint32_t MSG_MAX_TLVS = 7;
+
+/*! @brief   Chirps a frame can use, the chirp indices of chirpCfg */
+const uint32_t MAX_CHIRPS = 512;
+
+uint32_t pow2RoundUp(uint32_t x)
+{
+    uint32_t y = 1;
+    while (y < x)
+    {
+        y <<= 1;
+    }
+    return y;
+}
+
+/* Reads n numbers following the command word, false if there are fewer */
+bool readArgs(std::istringstream &words, double *args, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        if (!(words >> args[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* guiMonitor selections as one mask: 2 bits each of logMagRange,
+ * noiseProfile and rangeAzimuthHeatMap, 3 of rangeDopplerHeatMap, 2 of
+ * statsInfo */
+const uint32_t SEL_BITS = 11;
+
+GuiMonitorSel unpackSel(uint32_t mask)
+{
+    GuiMonitorSel g;
+    g.detectedObjects = 1;
+    g.logMagRange = (uint8_t)(mask & 3U);
+    g.noiseProfile = (uint8_t)((mask >> 2) & 3U);
+    g.rangeAzimuthHeatMap = (uint8_t)((mask >> 4) & 3U);
+    g.rangeDopplerHeatMap = (uint8_t)((mask >> 6) & 7U);
+    g.statsInfo = (uint8_t)((mask >> 9) & 3U);
+    return g;
+}
+
+} /* anonymous namespace */
+
+/**
+ *  @b Description
+ *  @n
+ *      Takes geometry and selection from a .cfg, as the DSS derives them:
+ *      range bins are the ADC samples rounded up to a power of two, the
+ *      azimuth Tx antennas are those of single antenna (MIMO) chirps or
+ *      one otherwise, Doppler bins are the chirps of a frame per Tx
+ *      antenna.
+ *
+ *  @param[in]  cfgText
+ *      Contents of the .cfg
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, channelCfg, profileCfg, chirpCfg or frameCfg missing
+ *                  or inconsistent
+ */
+int OutputProfile::fromCfg(const std::string &cfgText)
+{
+    std::istringstream in(cfgText);
+    std::string line;
+    std::vector<uint32_t> chirpTxEn(MAX_CHIRPS, 0U);
+    uint32_t rxEn = 0;
+    uint32_t numAdcSamples = 0;
+    uint32_t chirpStart = 0;
+    uint32_t chirpEnd = 0;
+    uint32_t numLoops = 0;
+    double   args[10];
+
+    while (std::getline(in, line))
+    {
+        std::istringstream words(line);
+        std::string cmd;
+        words >> cmd;
+        if (cmd == "channelCfg")
+        {
+            /* channelCfg <rxChannelEn> <txChannelEn> <cascading> */
+            if (readArgs(words, args, 2))
+            {
+                rxEn = (uint32_t)args[0];
+            }
+        }
+        else if (cmd == "profileCfg")
+        {
+            /* profileCfg <id> <startFreq> <idle> <adcStart> <rampEnd> <txPower> <txPhase>
+             *            <slope> <txStart> <numAdcSamples> ... */
+            if (readArgs(words, args, 10))
+            {
+                numAdcSamples = (uint32_t)args[9];
+            }
+        }
+        else if (cmd == "chirpCfg")
+        {
+            /* chirpCfg <start> <end> <profile> <freqVar> <slopeVar> <idleVar> <adcStartVar> <txEn> */
+            if (readArgs(words, args, 8))
+            {
+                for (uint32_t i = (uint32_t)args[0]; (i <= (uint32_t)args[1]) && (i < MAX_CHIRPS); i++)
+                {
+                    chirpTxEn[i] = (uint32_t)args[7];
+                }
+            }
+        }
+        else if (cmd == "frameCfg")
+        {
+            /* frameCfg <chirpStart> <chirpEnd> <numLoops> <numFrames> <periodicity ms> ... */
+            if (readArgs(words, args, 3))
+            {
+                chirpStart = (uint32_t)args[0];
+                chirpEnd = (uint32_t)args[1];
+                numLoops = (uint32_t)args[2];
+            }
+        }
+        else if (cmd == "guiMonitor")
+        {
+            if (readArgs(words, args, 6))
+            {
+                gui.detectedObjects = (uint8_t)args[0];
+                gui.logMagRange = (uint8_t)args[1];
+                gui.noiseProfile = (uint8_t)args[2];
+                gui.rangeAzimuthHeatMap = (uint8_t)args[3];
+                gui.rangeDopplerHeatMap = (uint8_t)args[4];
+                gui.statsInfo = (uint8_t)args[5];
+            }
+        }
+        else if (cmd == "azimuthHeatMapCfg")
+        {
+            if (readArgs(words, args, 2))
+            {
+                numAngleBins = (uint32_t)args[0];
+                angleFormat = (uint8_t)args[1];
+            }
+        }
+        else if (cmd == "quietModeCfg")
+        {
+            if (readArgs(words, args, 1))
+            {
+                quietMode = (args[0] == 1);
+            }
+        }
+    }
+
+    if ((chirpEnd < chirpStart) || (chirpEnd >= MAX_CHIRPS) || (numLoops == 0U) ||
+        (rxEn == 0U) || (numAdcSamples == 0U))
+    {
+        return -1;
+    }
+
+    /* Same decision as MmwDemo_dssMmwaveConfigCallbackFxn */
+    bool     mimo = true;
+    uint32_t txUsed = 0;
+    for (uint32_t i = chirpStart; i <= chirpEnd; i++)
+    {
+        if (chirpTxEn[i] == 0U)
+        {
+            return -1;
+        }
+        mimo = mimo && ((chirpTxEn[i] == 0x1U) || (chirpTxEn[i] == 0x2U));
+        txUsed |= chirpTxEn[i];
+    }
+    const uint32_t numTxAzim = mimo ? (uint32_t)__builtin_popcount(txUsed & 0x3U) : 1U;
+
+    numRangeBins = pow2RoundUp(numAdcSamples);
+    numDopplerBins = (chirpEnd - chirpStart + 1U) * numLoops / numTxAzim;
+    numVirtualAntAzim = numTxAzim * (uint32_t)__builtin_popcount(rxEn & 0xFU);
+    framePeriodUs = Replayer::cfgFramePeriodUs(cfgText);
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Link bytes per second: 8N1 on the UART, the SPI clock over 8.
+ */
+double OutputLink::bytesPerSec() const
+{
+    return uart ? baudRate / 10.0 : clockHz / 8.0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Bytes a packet takes on the link; on SPI whole frames of
+ *      MMW_SPI_FRAME_SIZE, each with its header.
+ */
+uint64_t OutputLink::wireBytes(uint32_t packetLen) const
+{
+    if (uart)
+    {
+        return packetLen;
+    }
+    const uint64_t numFrames = (packetLen + MMW_SPI_FRAME_PAYLOAD_SIZE - 1U) / MMW_SPI_FRAME_PAYLOAD_SIZE;
+    return numFrames * MMW_SPI_FRAME_SIZE;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Time a packet takes on the link, without gaps between frames.
+ */
+double OutputLink::packetSeconds(uint32_t packetLen) const
+{
+    return (double)wireBytes(packetLen) / bytesPerSec();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Lists the TLVs a frame sends and the packet length. The TLVs are
+ *      in the order of MmwDemo_dssSendProcessOutputToMSS; the MSS counters
+ *      come last, as the MSS appends them.
+ *
+ *  @param[in]  profile
+ *      Geometry and selection
+ *  @param[in]  assume
+ *      Scene dependent sizes
+ *  @param[in]  deviceStats
+ *      The frame carries the device counters (every
+ *      MMWDEMO_OUTPUT_DEVICE_STATS_PERIOD-th with statsInfo bit 1)
+ *  @param[out] out
+ *      Packet
+ */
+void packetBudget(const OutputProfile &profile, const LinkBudgetAssumptions &assume,
+                  bool deviceStats, PacketBudget &out)
+{
+    const GuiMonitorSel &g = profile.gui;
+    const uint32_t r = profile.numRangeBins;
+    const uint32_t d = profile.numDopplerBins;
+    const uint32_t numObj = std::min(assume.numObjects, MAX_OBJ_OUT);
+    const uint32_t angleBytes = (profile.angleFormat == MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG) ? 1U : 2U;
+    const double   fill = std::min(std::max(assume.heatMapFill, 0.0), 1.0);
+
+    struct Candidate
+    {
+        uint32_t    type;
+        uint32_t    length;
+        bool        selected;
+        bool        mandatory;
+        uint8_t     priority;
+        bool        estimate;
+    };
+    const Candidate candidates[] =
+    {
+        { TLV_DETECTED_POINTS, (uint32_t)(sizeof(DetObjDescr) + numObj * sizeof(DetObj)),
+          (g.detectedObjects == 1) && (numObj > 0U), true, 0, true },
+        { TLV_RANGE_PROFILE, (uint32_t)(r * sizeof(uint16_t)),
+          (g.logMagRange & MMWDEMO_GUIMON_PROFILE_PLAIN) != 0U, false, 0, false },
+        { TLV_NOISE_PROFILE, (uint32_t)(r * sizeof(uint16_t)),
+          (g.noiseProfile & MMWDEMO_GUIMON_PROFILE_PLAIN) != 0U, false, 1, false },
+        /* Sized as a keyframe; the deltas between are smaller in a still scene */
+        { TLV_RANGE_PROFILE_DELTA, (uint32_t)(sizeof(MmwDemo_profileDeltaHdr) + r * sizeof(uint16_t)),
+          (g.logMagRange & MMWDEMO_GUIMON_PROFILE_DELTA) != 0U, false, 0, true },
+        { TLV_NOISE_PROFILE_DELTA, (uint32_t)(sizeof(MmwDemo_profileDeltaHdr) + r * sizeof(uint16_t)),
+          (g.noiseProfile & MMWDEMO_GUIMON_PROFILE_DELTA) != 0U, false, 1, true },
+        { TLV_AZIMUTH_STATIC_HEAT_MAP, (uint32_t)(r * profile.numVirtualAntAzim * sizeof(Cmplx16ImRe)),
+          (g.rangeAzimuthHeatMap & MMWDEMO_GUIMON_RA_HEATMAP_SAMPLES) != 0U, false, 5, false },
+        { TLV_RANGE_DOPPLER_HEAT_MAP, (uint32_t)(r * d * sizeof(uint16_t)),
+          (g.rangeDopplerHeatMap & MMWDEMO_GUIMON_RD_HEATMAP_DENSE) != 0U, false, 6, false },
+        { TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED,
+          (uint32_t)std::ceil(fill * (double)MMW_HEATMAP_CODEC_MAX_SIZE(r, d)),
+          (g.rangeDopplerHeatMap & MMWDEMO_GUIMON_RD_HEATMAP_COMPRESSED) != 0U, false, 3, true },
+        { TLV_RANGE_DOPPLER_HEAT_MAP_SPARSE,
+          (uint32_t)std::ceil(fill * (double)MMW_HEATMAP_SPARSE_MAX_SIZE(r, d)),
+          (g.rangeDopplerHeatMap & MMWDEMO_GUIMON_RD_HEATMAP_SPARSE) != 0U, false, 2, true },
+        { TLV_AZIMUTH_HEAT_MAP_MAGNITUDE,
+          (uint32_t)(sizeof(MmwDemo_azimuthHeatMapHdr) + r * profile.numAngleBins * angleBytes),
+          (g.rangeAzimuthHeatMap & MMWDEMO_GUIMON_RA_HEATMAP_MAGNITUDE) != 0U, false, 4, false },
+        { TLV_STATS, sizeof(Stats), (g.statsInfo & MMWDEMO_GUIMON_STATS_TIMING) != 0U, true, 0, false },
+        { TLV_DSS_STATS, sizeof(DssStats), deviceStats && ((g.statsInfo & MMWDEMO_GUIMON_STATS_DEVICE) != 0U),
+          true, 0, false },
+        { TLV_QUIET, sizeof(QuietReport), profile.quietMode, true, 0, false },
+    };
+    const uint32_t numCandidates = sizeof(candidates) / sizeof(candidates[0]);
+
+    MmwDemo_outputSchedItem items[MMW_OUTPUT_SCHED_MAX_ITEMS];
+    std::memset(items, 0, sizeof(items));
+    for (uint32_t i = 0; i < numCandidates; i++)
+    {
+        items[i].type = candidates[i].type;
+        items[i].length = candidates[i].selected ? candidates[i].length : 0U;
+        items[i].isMandatory = candidates[i].mandatory ? 1U : 0U;
+        items[i].priority = candidates[i].priority;
+    }
+    bool withMss = false;
+    for (uint32_t i = 0; i < numCandidates; i++)
+    {
+        withMss = withMss || ((items[i].type == TLV_DSS_STATS) && (items[i].length > 0U));
+    }
+    /* Appended by the MSS: the counters with the DSS ones, the CRC always */
+    const uint32_t extraLen = (uint32_t)(sizeof(TlvHeader) + sizeof(PacketCrc)) +
+                              (withMss ? (uint32_t)(sizeof(TlvHeader) + sizeof(MssStats)) : 0U);
+
+    MmwDemo_outputSched sched;
+    MmwDemo_outputSchedResult result;
+    MmwDemo_outputSchedInit(&sched);
+    MmwDemo_outputSchedRun(&sched, items, numCandidates, MSG_MAX_TLVS, extraLen, &result);
+
+    out.tlvs.clear();
+    for (uint32_t i = 0; i < numCandidates; i++)
+    {
+        if (candidates[i].selected && (items[i].length > 0U))
+        {
+            out.tlvs.push_back({ candidates[i].type, candidates[i].length, candidates[i].estimate,
+                                 (result.sendMask & (1UL << i)) == 0U });
+        }
+    }
+    if (withMss)
+    {
+        out.tlvs.push_back({ TLV_MSS_STATS, sizeof(MssStats), false, false });
+    }
+    out.tlvs.push_back({ TLV_PACKET_CRC, sizeof(PacketCrc), false, false });
+    out.packetLen = result.packetLen;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Short name of a TLV type, "unknown" for others.
+ */
+const char *tlvName(uint32_t type)
+{
+    switch (type)
+    {
+    case TLV_DETECTED_POINTS:                   return "detected points";
+    case TLV_RANGE_PROFILE:                     return "range profile";
+    case TLV_NOISE_PROFILE:                     return "noise profile";
+    case TLV_AZIMUTH_STATIC_HEAT_MAP:           return "azimuth samples";
+    case TLV_RANGE_DOPPLER_HEAT_MAP:            return "range/Doppler dense";
+    case TLV_STATS:                             return "stats";
+    case TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED: return "range/Doppler compressed";
+    case TLV_RANGE_DOPPLER_HEAT_MAP_SPARSE:     return "range/Doppler sparse";
+    case TLV_AZIMUTH_HEAT_MAP_MAGNITUDE:        return "azimuth magnitude";
+    case TLV_DSS_STATS:                         return "DSS counters";
+    case TLV_MSS_STATS:                         return "MSS counters";
+    case TLV_PACKET_CRC:                        return "packet CRC";
+    case TLV_OUTPUT_SHED:                       return "output shed";
+    case TLV_QUIET:                             return "quiet report";
+    case TLV_RANGE_PROFILE_DELTA:               return "range profile delta";
+    case TLV_NOISE_PROFILE_DELTA:               return "noise profile delta";
+    default:                                    return "unknown";
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Lists the guiMonitor selections (detected objects on) whose packets
+ *      fit a frame period on the link, counting the device counters when
+ *      selected. Only the largest ones are listed: a selection is left out
+ *      when one with all its TLVs and more fits as well. Sorted by packet
+ *      length, longest first.
+ *
+ *  @param[in]  profile
+ *      Geometry; the selection is ignored
+ *  @param[in]  assume
+ *      Scene dependent sizes
+ *  @param[in]  link
+ *      Output link
+ *  @param[in]  framePeriodUs
+ *      Frame period
+ *  @param[out] out
+ *      Fitting selections
+ */
+void fittingSelections(const OutputProfile &profile, const LinkBudgetAssumptions &assume,
+                       const OutputLink &link, uint32_t framePeriodUs,
+                       std::vector<FittingSelection> &out)
+{
+    const double period = framePeriodUs * 1e-6;
+    std::vector<bool> fits(1U << SEL_BITS, false);
+    std::vector<uint32_t> lengths(1U << SEL_BITS, 0U);
+    OutputProfile p = profile;
+    PacketBudget packet;
+
+    for (uint32_t mask = 0; mask < (1U << SEL_BITS); mask++)
+    {
+        p.gui = unpackSel(mask);
+        packetBudget(p, assume, true, packet);
+
+        /* Selected TLVs without a slot are not sent: not a fitting choice */
+        bool allSent = true;
+        for (const TlvBudget &t : packet.tlvs)
+        {
+            allSent = allSent && !t.noSlot;
+        }
+        lengths[mask] = packet.packetLen;
+        fits[mask] = allSent && (link.packetSeconds(packet.packetLen) <= period);
+    }
+
+    out.clear();
+    for (uint32_t mask = 0; mask < (1U << SEL_BITS); mask++)
+    {
+        if (!fits[mask])
+        {
+            continue;
+        }
+        bool largest = true;
+        for (uint32_t bit = 0; largest && (bit < SEL_BITS); bit++)
+        {
+            const uint32_t more = mask | (1U << bit);
+            largest = (more == mask) || !fits[more];
+        }
+        if (largest)
+        {
+            out.push_back({ unpackSel(mask), lengths[mask], link.packetSeconds(lengths[mask]) / period });
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const FittingSelection &a, const FittingSelection &b)
+    {
+        return a.packetLen > b.packetLen;
+    });
+}
+
+} /* namespace mmw */
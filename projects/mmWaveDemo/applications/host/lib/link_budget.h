@@ -0,0 +1,159 @@
+/**
+ *   @file  link_budget.h
+ *
+ *   @brief
+ *      Output packet sizes of a .cfg and the frame rates a link sustains
+ *      with them.
+ *
+ *      The TLV sizes follow MmwDemo_dssSendProcessOutputToMSS: the geometry
+ *      comes from channelCfg, profileCfg, chirpCfg and frameCfg as the DSS
+ *      derives it, the selection from guiMonitor and the heat map
+ *      configuration commands. Which TLVs fit the TLV slots of the message
+ *      is settled by the output scheduler of the DSS (mmw_output_sched.h),
+ *      without a budget. The detected points and the compressed and sparse
+ *      heat maps depend on the scene; they are taken from assumptions.
+ */
+#ifndef LINK_BUDGET_H
+#define LINK_BUDGET_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mmw_azimuth_heatmap.h"
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  guiMonitor selection
+ */
+struct GuiMonitorSel
+{
+    uint8_t     detectedObjects = 1;
+
+    /*! @brief   MMWDEMO_GUIMON_PROFILE_xxx bits */
+    uint8_t     logMagRange = 0;
+
+    /*! @brief   MMWDEMO_GUIMON_PROFILE_xxx bits */
+    uint8_t     noiseProfile = 0;
+
+    /*! @brief   MMWDEMO_GUIMON_RA_HEATMAP_xxx bits */
+    uint8_t     rangeAzimuthHeatMap = 0;
+
+    /*! @brief   MMWDEMO_GUIMON_RD_HEATMAP_xxx bits */
+    uint8_t     rangeDopplerHeatMap = 0;
+
+    /*! @brief   MMWDEMO_GUIMON_STATS_xxx bits */
+    uint8_t     statsInfo = 0;
+};
+
+/**
+ * @brief
+ *  What a .cfg makes the device send
+ */
+struct OutputProfile
+{
+    uint32_t        numRangeBins = 0;
+    uint32_t        numDopplerBins = 0;
+    uint32_t        numVirtualAntAzim = 0;
+
+    /*! @brief   frameCfg periodicity */
+    uint32_t        framePeriodUs = 0;
+
+    GuiMonitorSel   gui;
+
+    /*! @brief   azimuthHeatMapCfg, defaults of the DSS */
+    uint32_t        numAngleBins = MMW_AZIMUTH_HEATMAP_DEFAULT_BINS;
+    uint8_t         angleFormat = MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG;
+
+    /*! @brief   quietModeCfg on, every packet carries the quiet report */
+    bool            quietMode = false;
+
+    int fromCfg(const std::string &cfgText);
+};
+
+/**
+ * @brief
+ *  Scene dependent sizes
+ */
+struct LinkBudgetAssumptions
+{
+    /*! @brief   Detected objects per frame, at most MMW_MAX_OBJ_OUT (100) */
+    uint32_t    numObjects = 100;
+
+    /*! @brief   Share of their worst case size the compressed and sparse
+     *           heat maps take, 1 for the bound */
+    double      heatMapFill = 1.0;
+};
+
+/**
+ * @brief
+ *  One TLV of the packet
+ */
+struct TlvBudget
+{
+    uint32_t    type;
+
+    /*! @brief   Payload length */
+    uint32_t    length;
+
+    /*! @brief   The length depends on the scene, see LinkBudgetAssumptions */
+    bool        estimate;
+
+    /*! @brief   Selected, but no TLV slot was left for it */
+    bool        noSlot;
+};
+
+/**
+ * @brief
+ *  Output packet of one frame
+ */
+struct PacketBudget
+{
+    std::vector<TlvBudget>  tlvs;
+
+    /*! @brief   Header, TLVs sent and padding to MMWDEMO_OUTPUT_MSG_SEGMENT_LEN */
+    uint32_t                packetLen = 0;
+};
+
+/**
+ * @brief
+ *  Output link
+ */
+struct OutputLink
+{
+    /*! @brief   UART data port at baudRate, else SPI at clockHz */
+    bool        uart = true;
+    uint32_t    baudRate = 921600;
+    uint32_t    clockHz = 20000000;
+
+    double bytesPerSec() const;
+    uint64_t wireBytes(uint32_t packetLen) const;
+    double packetSeconds(uint32_t packetLen) const;
+};
+
+/**
+ * @brief
+ *  A guiMonitor selection that fits a frame period
+ */
+struct FittingSelection
+{
+    GuiMonitorSel   gui;
+    uint32_t        packetLen;
+
+    /*! @brief   Share of the frame period on the link */
+    double          load;
+};
+
+void packetBudget(const OutputProfile &profile, const LinkBudgetAssumptions &assume,
+                  bool deviceStats, PacketBudget &out);
+const char *tlvName(uint32_t type);
+void fittingSelections(const OutputProfile &profile, const LinkBudgetAssumptions &assume,
+                       const OutputLink &link, uint32_t framePeriodUs,
+                       std::vector<FittingSelection> &out);
+
+} /* namespace mmw */
+
+#endif /* LINK_BUDGET_H */
@@ -0,0 +1,216 @@
+/**
+ *   @file  loss_accountant.cpp
+ *
+ *   @brief
+ *      Frame loss bookkeeping, see loss_accountant.h.
+ */
+#include <algorithm>
+
+#include "loss_accountant.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+void accumulate(LossBreakdown &to, const LossBreakdown &from)
+{
+    to.received += from.received;
+    to.missing += from.missing;
+    to.quiet += from.quiet;
+    to.heartbeats += from.heartbeats;
+    to.deviceSkipped += from.deviceSkipped;
+    to.deviceErrors += from.deviceErrors;
+    to.linkErrors += from.linkErrors;
+    to.hostBad += from.hostBad;
+    to.unexplained += from.unexplained;
+    to.duplicates += from.duplicates;
+    to.chirpsSkipped += from.chirpsSkipped;
+    to.shed += from.shed;
+    to.crcErrors += from.crcErrors;
+    to.resyncs += from.resyncs;
+    to.deviceReports += from.deviceReports;
+    to.restarts += from.restarts;
+}
+
+/* A device counter that went back: the device was reset */
+bool wentBack(const DssStats &now, const DssStats &before)
+{
+    return (now.frameStartIntCounter < before.frameStartIntCounter) ||
+           (now.detObjLoggingSkip < before.detObjLoggingSkip) ||
+           (now.detObjLoggingErr < before.detObjLoggingErr);
+}
+
+} /* anonymous namespace */
+
+/**
+ *  @b Description
+ *  @n
+ *      Accounts one received packet.
+ *
+ *  @param[in]  frame
+ *      Parsed packet
+ *  @param[in]  host
+ *      Counters of the host reader up to this packet
+ */
+void LossAccountant::add(const FrameView &frame, const HostLinkCounters &host)
+{
+    m_lastHost = host;
+    const uint32_t fn = frame.header.frameNumber;
+    if (!m_haveFrame)
+    {
+        /* What the reader saw before the first packet is start up noise */
+        m_haveFrame = true;
+        m_host = host;
+    }
+    else
+    {
+        const uint32_t ahead = fn - m_lastFrame;
+        if (ahead == 0U)
+        {
+            m_open.duplicates++;
+            return;
+        }
+        if (ahead > MAX_GAP)
+        {
+            /* Far ahead or back: the device was reset */
+            restart(host);
+        }
+        else
+        {
+            /* The quiet report counts frames after prevFrameNumber, all
+             * of them inside the gap */
+            uint64_t quiet = 0;
+            const TlvRef *quietTlv = frame.find(TLV_QUIET);
+            if ((quietTlv != nullptr) && (quietTlv->length == sizeof(QuietReport)))
+            {
+                const QuietReport report = load<QuietReport>(quietTlv->payload);
+                if ((report.flags & MMWDEMO_OUTPUT_QUIET_FLAG_PREV) != 0U)
+                {
+                    quiet = std::min<uint64_t>(report.quietFrames, ahead - 1U);
+                }
+                if ((report.flags & MMWDEMO_OUTPUT_QUIET_FLAG_HEARTBEAT) != 0U)
+                {
+                    m_open.heartbeats++;
+                }
+            }
+            m_open.quiet += quiet;
+            m_open.missing += ahead - 1U - quiet;
+        }
+    }
+    m_lastFrame = fn;
+    m_open.received++;
+    if (frame.find(TLV_OUTPUT_SHED) != nullptr)
+    {
+        m_open.shed++;
+    }
+
+    const TlvRef *dssTlv = frame.find(TLV_DSS_STATS);
+    if ((dssTlv == nullptr) || (dssTlv->length != sizeof(DssStats)))
+    {
+        return;
+    }
+    const DssStats dss = load<DssStats>(dssTlv->payload);
+    if (m_haveDevice && wentBack(dss, m_dss))
+    {
+        restart(host);
+    }
+    const TlvRef *mssTlv = frame.find(TLV_MSS_STATS);
+    MssStats mss;
+    const bool haveMss = (mssTlv != nullptr) && (mssTlv->length == sizeof(MssStats));
+    if (haveMss)
+    {
+        mss = load<MssStats>(mssTlv->payload);
+    }
+    close(&dss, haveMss ? &mss : nullptr, host);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Books the open span into the interval, with the differences of the
+ *      counters since the last close as causes.
+ *
+ *  @param[in]  dss
+ *      DSS counters closing the span, nullptr for none
+ *  @param[in]  mss
+ *      MSS counters closing the span, nullptr for none
+ *  @param[in]  host
+ *      Host counters closing the span
+ */
+void LossAccountant::close(const DssStats *dss, const MssStats *mss, const HostLinkCounters &host)
+{
+    LossBreakdown span;
+    span.received = m_open.received;
+    span.missing = m_open.missing;
+    span.quiet = m_open.quiet;
+    span.heartbeats = m_open.heartbeats;
+    span.duplicates = m_open.duplicates;
+    span.shed = m_open.shed;
+
+    if ((dss != nullptr) && m_haveDevice)
+    {
+        span.deviceSkipped = dss->detObjLoggingSkip - m_dss.detObjLoggingSkip;
+        span.deviceErrors = dss->detObjLoggingErr - m_dss.detObjLoggingErr;
+        span.chirpsSkipped = dss->chirpIntSkipCounter - m_dss.chirpIntSkipCounter;
+    }
+    if ((mss != nullptr) && m_haveMss)
+    {
+        span.linkErrors = mss->transferErrors - m_mss.transferErrors;
+    }
+    span.hostBad = host.badPackets - m_host.badPackets;
+    span.crcErrors = host.crcErrors - m_host.crcErrors;
+    span.resyncs = host.resyncs - m_host.resyncs;
+
+    const uint64_t explained = span.deviceSkipped + span.deviceErrors + span.linkErrors + span.hostBad;
+    span.unexplained = span.missing - std::min(span.missing, explained);
+    accumulate(m_interval, span);
+
+    if (dss != nullptr)
+    {
+        m_dss = *dss;
+        m_haveDevice = true;
+        m_interval.deviceReports++;
+    }
+    m_haveMss = (mss != nullptr);
+    if (m_haveMss)
+    {
+        m_mss = *mss;
+    }
+    m_host = host;
+    m_open = Span();
+}
+
+void LossAccountant::restart(const HostLinkCounters &host)
+{
+    close(nullptr, nullptr, host);
+    m_haveDevice = false;
+    m_haveMss = false;
+    m_interval.restarts++;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Hands out the interval and starts the next one. Without device
+ *      counters, or when none came during the interval (statsInfo bit 1
+ *      turned off), the open span is closed with the host counters.
+ *
+ *  @param[out] out
+ *      Loss of the interval
+ */
+void LossAccountant::roll(LossBreakdown &out)
+{
+    if (!m_haveDevice || (m_interval.deviceReports == 0U))
+    {
+        close(nullptr, nullptr, m_lastHost);
+        m_haveDevice = false;
+        m_haveMss = false;
+    }
+    out = m_interval;
+    accumulate(m_total, m_interval);
+    m_interval = LossBreakdown();
+}
+
+} /* namespace mmw */
@@ -0,0 +1,166 @@
+/**
+ *   @file  loss_accountant.h
+ *
+ *   @brief
+ *      Frame loss bookkeeping across the device and the host: frameNumber
+ *      gaps, explained by the DSS and MSS counters (MMWDEMO_OUTPUT_MSG_DSS_STATS,
+ *      MMWDEMO_OUTPUT_MSG_MSS_STATS) and the errors of the host reader.
+ */
+#ifndef LOSS_ACCOUNTANT_H
+#define LOSS_ACCOUNTANT_H
+
+#include <cstdint>
+
+#include "tlv_parser.h"
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  Counters of the host reader, running totals
+ */
+struct HostLinkCounters
+{
+    /*! @brief   Packets the host knows it lost: rejected by the parser or
+     *           dropped by the SPI deframer */
+    uint64_t    badPackets = 0;
+
+    /*! @brief   Link frames or packets failing their CRC */
+    uint64_t    crcErrors = 0;
+
+    /*! @brief   Times the reader lost the packet boundary and searched for
+     *           the next magic or sync word */
+    uint64_t    resyncs = 0;
+};
+
+/**
+ * @brief
+ *  Frame loss of one interval
+ *
+ * @details
+ *  missing is split into the causes; what the counters do
+ *  not explain is unexplained. The causes can add up to more than missing
+ *  when a counter covers a frame that got through after all (e.g. a host
+ *  resync inside the padding).
+ */
+struct LossBreakdown
+{
+    /*! @brief   Packets with a new frame number */
+    uint64_t    received = 0;
+
+    /*! @brief   Frame numbers skipped between received packets, quiet
+     *           frames aside */
+    uint64_t    missing = 0;
+
+    /*! @brief   Frames the quiet mode of the DSS suppressed
+     *           (MMWDEMO_OUTPUT_MSG_QUIET): not sent, not lost */
+    uint64_t    quiet = 0;
+
+    /*! @brief   Received packets that are quiet mode heartbeats */
+    uint64_t    heartbeats = 0;
+
+    /*! @brief   DSS: the MSS had not shipped the previous packet
+     *           (detObjLoggingSkip) */
+    uint64_t    deviceSkipped = 0;
+
+    /*! @brief   DSS: the packet did not fit or the mailbox write failed
+     *           (detObjLoggingErr) */
+    uint64_t    deviceErrors = 0;
+
+    /*! @brief   MSS: packets cut short by a transfer error */
+    uint64_t    linkErrors = 0;
+
+    /*! @brief   Host: HostLinkCounters::badPackets */
+    uint64_t    hostBad = 0;
+
+    /*! @brief   Missing frames none of the counters account for */
+    uint64_t    unexplained = 0;
+
+    /*! @brief   Packets repeating the last frame number */
+    uint64_t    duplicates = 0;
+
+    /*! @brief   DSS chirp interrupts skipped: frames sent, but degraded */
+    uint64_t    chirpsSkipped = 0;
+
+    /*! @brief   Packets the DSS output scheduler left selected TLVs out
+     *           of to fit the link budget: frames sent, but degraded */
+    uint64_t    shed = 0;
+
+    /*! @brief   Host: HostLinkCounters::crcErrors and resyncs */
+    uint64_t    crcErrors = 0;
+    uint64_t    resyncs = 0;
+
+    /*! @brief   Packets carrying the device counters */
+    uint64_t    deviceReports = 0;
+
+    /*! @brief   Device or sensor restarts, the accounting started over */
+    uint64_t    restarts = 0;
+};
+
+/**
+ * @brief
+ *  Frame loss accountant
+ *
+ * @details
+ *  Frame numbers (frameStartIntCounter of the DSS) come one per frame, so
+ *  a gap is a frame lost somewhere. The device counters arrive every few
+ *  frames and count what happened before the packet carrying them, so the
+ *  gaps are held in an open span until such a packet arrives; the span is
+ *  then closed against the counter differences and booked into the
+ *  current interval. A loss therefore lands in the interval of the next
+ *  device report, at most MMWDEMO_OUTPUT_DEVICE_STATS_PERIOD frames late,
+ *  and missing and its causes always describe the same frames. Without
+ *  device counters the span is closed by roll() against the host counters
+ *  alone. Frames the quiet mode suppressed are counted apart from the gap,
+ *  from the quiet report of the next packet; those announced by a packet
+ *  that got lost remain missing.
+ */
+class LossAccountant
+{
+public:
+    /*! @brief   A frame number further ahead than this, or going back, is
+     *           a restart rather than a gap */
+    static const uint32_t MAX_GAP = 100000;
+
+    void add(const FrameView &frame, const HostLinkCounters &host);
+    void roll(LossBreakdown &out);
+
+    /*! @brief   Everything since the start */
+    const LossBreakdown &total() const  { return m_total; }
+
+private:
+    struct Span
+    {
+        uint64_t    received = 0;
+        uint64_t    missing = 0;
+        uint64_t    quiet = 0;
+        uint64_t    heartbeats = 0;
+        uint64_t    duplicates = 0;
+        uint64_t    shed = 0;
+    };
+
+    void close(const DssStats *dss, const MssStats *mss, const HostLinkCounters &host);
+    void restart(const HostLinkCounters &host);
+
+    bool                m_haveFrame = false;
+    uint32_t            m_lastFrame = 0;
+    Span                m_open;
+
+    /* Counters at the last close */
+    bool                m_haveDevice = false;
+    DssStats            m_dss = {};
+    MssStats            m_mss = {};
+    bool                m_haveMss = false;
+    HostLinkCounters    m_host;
+
+    /* Latest host counters */
+    HostLinkCounters    m_lastHost;
+
+    LossBreakdown       m_interval;
+    LossBreakdown       m_total;
+};
+
+} /* namespace mmw */
+
+#endif /* LOSS_ACCOUNTANT_H */
@@ -0,0 +1,164 @@
+/**
+ *   @file  mmw_wire.h
+ *
+ *   @brief
+ *      Host copy of the mmw demo output format (ti/demo/io_interface/mmw_output.h
+ *      in the SDK), plus the extended TLV types of board/common.
+ *
+ *      Every multi byte field is little endian on the wire, which is also the
+ *      host byte order of every platform the tools are built for. The
+ *      layouts are described once in board/common/mmw_tlv_schema.json;
+ *      mmw_wire_layout.h, generated from it, checks the structs here.
+ */
+#ifndef MMW_WIRE_H
+#define MMW_WIRE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "mmw_output_ext.h"
+
+namespace mmw
+{
+
+/*! @brief   Output packet magic word, as sent by the MSS */
+static const uint8_t MAGIC_WORD[8] = { 0x02, 0x01, 0x04, 0x03, 0x06, 0x05, 0x08, 0x07 };
+
+/*! @brief   Output packets are padded to a multiple of this length */
+static const uint32_t MSG_SEGMENT_LEN = 32;
+
+/**
+ * @brief
+ *  TLV types of the SDK output message
+ */
+enum TlvType : uint32_t
+{
+    TLV_DETECTED_POINTS         = 1,
+    TLV_RANGE_PROFILE           = 2,
+    TLV_NOISE_PROFILE           = 3,
+    TLV_AZIMUTH_STATIC_HEAT_MAP = 4,
+    TLV_RANGE_DOPPLER_HEAT_MAP  = 5,
+    TLV_STATS                   = 6,
+
+    TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED = MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED,
+    TLV_RANGE_DOPPLER_HEAT_MAP_SPARSE     = MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_SPARSE,
+    TLV_AZIMUTH_HEAT_MAP_MAGNITUDE        = MMWDEMO_OUTPUT_MSG_AZIMUTH_HEAT_MAP_MAGNITUDE,
+    TLV_DSS_STATS                         = MMWDEMO_OUTPUT_MSG_DSS_STATS,
+    TLV_MSS_STATS                         = MMWDEMO_OUTPUT_MSG_MSS_STATS,
+    TLV_OUTPUT_SHED                       = MMWDEMO_OUTPUT_MSG_OUTPUT_SHED,
+    TLV_QUIET                             = MMWDEMO_OUTPUT_MSG_QUIET,
+    TLV_RANGE_PROFILE_DELTA               = MMWDEMO_OUTPUT_MSG_RANGE_PROFILE_DELTA,
+    TLV_NOISE_PROFILE_DELTA               = MMWDEMO_OUTPUT_MSG_NOISE_PROFILE_DELTA,
+    TLV_PACKET_CRC                        = MMWDEMO_OUTPUT_MSG_PACKET_CRC
+};
+
+/**
+ * @brief
+ *  Output packet header, MmwDemo_output_message_header
+ */
+struct MsgHeader
+{
+    uint16_t    magicWord[4];
+    uint32_t    version;
+    uint32_t    totalPacketLen;
+    uint32_t    platform;
+    uint32_t    frameNumber;
+    uint32_t    timeCpuCycles;
+    uint32_t    numDetectedObj;
+    uint32_t    numTLVs;
+};
+
+/**
+ * @brief
+ *  TLV header, MmwDemo_output_message_tl
+ */
+struct TlvHeader
+{
+    uint32_t    type;
+    uint32_t    length;
+};
+
+/**
+ * @brief
+ *  Detected objects descriptor, MmwDemo_output_message_dataObjDescr
+ */
+struct DetObjDescr
+{
+    uint16_t    numDetetedObj;
+    uint16_t    xyzQFormat;
+};
+
+/**
+ * @brief
+ *  Detected object, MmwDemo_detectedObj
+ */
+struct DetObj
+{
+    uint16_t    rangeIdx;
+    int16_t     dopplerIdx;
+    uint16_t    peakVal;
+    int16_t     x;
+    int16_t     y;
+    int16_t     z;
+};
+
+/**
+ * @brief
+ *  Complex sample of the static azimuth heat map, cmplx16ImRe_t
+ */
+struct Cmplx16ImRe
+{
+    int16_t     imag;
+    int16_t     real;
+};
+
+/**
+ * @brief
+ *  Timing statistics, MmwDemo_output_message_stats
+ */
+struct Stats
+{
+    uint32_t    interFrameProcessingTime;
+    uint32_t    transmitOutputTime;
+    uint32_t    interFrameProcessingMargin;
+    uint32_t    interChirpProcessingMargin;
+    uint32_t    activeFrameCPULoad;
+    uint32_t    interFrameCPULoad;
+};
+
+/*! @brief   DSS counters, MMWDEMO_OUTPUT_MSG_DSS_STATS */
+using DssStats = MmwDemo_output_message_dssStats;
+
+/*! @brief   MSS counters, MMWDEMO_OUTPUT_MSG_MSS_STATS */
+using MssStats = MmwDemo_output_message_mssStats;
+
+/*! @brief   TLVs the output scheduler shed, MMWDEMO_OUTPUT_MSG_OUTPUT_SHED */
+using OutputShed = MmwDemo_output_message_outputShed;
+
+/*! @brief   Quiet mode report, MMWDEMO_OUTPUT_MSG_QUIET */
+using QuietReport = MmwDemo_output_message_quiet;
+
+/*! @brief   Packet CRC, MMWDEMO_OUTPUT_MSG_PACKET_CRC */
+using PacketCrc = MmwDemo_output_message_packetCrc;
+
+/**
+ *  @b Description
+ *  @n
+ *      Copies a wire struct out of a possibly unaligned byte buffer.
+ */
+template <typename T>
+inline T load(const uint8_t *p)
+{
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+} /* namespace mmw */
+
+/* Checks of the structs above against board/common/mmw_tlv_schema.json,
+ * and the TLV decoders generated from it */
+#include "mmw_wire_layout.h"
+
+#endif /* MMW_WIRE_H */
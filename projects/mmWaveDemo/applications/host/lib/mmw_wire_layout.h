@@ -0,0 +1,457 @@
+/**
+ *   @file  mmw_wire_layout.h
+ *
+ *   @brief
+ *      Generated by board/common/mmw_tlv_gen.py from mmw_tlv_schema.json, do not edit.
+ *
+ *      Included at the end of mmw_wire.h: static asserts on the wire
+ *      structs against the schema, and TlvLayout<type>, the decoder of
+ *      each TLV type with its sizes and offsets as constants.
+ */
+#ifndef MMW_WIRE_LAYOUT_H
+#define MMW_WIRE_LAYOUT_H
+
+#include <type_traits>
+
+#include "mmw_azimuth_heatmap.h"
+#include "mmw_heatmap_codec.h"
+#include "mmw_heatmap_sparse.h"
+#include "mmw_profile_delta.h"
+
+namespace mmw
+{
+
+static_assert(sizeof(MsgHeader) == 36, "MsgHeader: schema size");
+static_assert((offsetof(MsgHeader, magicWord) == 0) && std::is_same<decltype(MsgHeader::magicWord), uint16_t[4]>::value, "MsgHeader::magicWord: schema layout");
+static_assert((offsetof(MsgHeader, version) == 8) && std::is_same<decltype(MsgHeader::version), uint32_t>::value, "MsgHeader::version: schema layout");
+static_assert((offsetof(MsgHeader, totalPacketLen) == 12) && std::is_same<decltype(MsgHeader::totalPacketLen), uint32_t>::value, "MsgHeader::totalPacketLen: schema layout");
+static_assert((offsetof(MsgHeader, platform) == 16) && std::is_same<decltype(MsgHeader::platform), uint32_t>::value, "MsgHeader::platform: schema layout");
+static_assert((offsetof(MsgHeader, frameNumber) == 20) && std::is_same<decltype(MsgHeader::frameNumber), uint32_t>::value, "MsgHeader::frameNumber: schema layout");
+static_assert((offsetof(MsgHeader, timeCpuCycles) == 24) && std::is_same<decltype(MsgHeader::timeCpuCycles), uint32_t>::value, "MsgHeader::timeCpuCycles: schema layout");
+static_assert((offsetof(MsgHeader, numDetectedObj) == 28) && std::is_same<decltype(MsgHeader::numDetectedObj), uint32_t>::value, "MsgHeader::numDetectedObj: schema layout");
+static_assert((offsetof(MsgHeader, numTLVs) == 32) && std::is_same<decltype(MsgHeader::numTLVs), uint32_t>::value, "MsgHeader::numTLVs: schema layout");
+
+static_assert(sizeof(TlvHeader) == 8, "TlvHeader: schema size");
+static_assert((offsetof(TlvHeader, type) == 0) && std::is_same<decltype(TlvHeader::type), uint32_t>::value, "TlvHeader::type: schema layout");
+static_assert((offsetof(TlvHeader, length) == 4) && std::is_same<decltype(TlvHeader::length), uint32_t>::value, "TlvHeader::length: schema layout");
+
+static_assert(sizeof(DetObjDescr) == 4, "DetObjDescr: schema size");
+static_assert((offsetof(DetObjDescr, numDetetedObj) == 0) && std::is_same<decltype(DetObjDescr::numDetetedObj), uint16_t>::value, "DetObjDescr::numDetetedObj: schema layout");
+static_assert((offsetof(DetObjDescr, xyzQFormat) == 2) && std::is_same<decltype(DetObjDescr::xyzQFormat), uint16_t>::value, "DetObjDescr::xyzQFormat: schema layout");
+
+static_assert(sizeof(DetObj) == 12, "DetObj: schema size");
+static_assert((offsetof(DetObj, rangeIdx) == 0) && std::is_same<decltype(DetObj::rangeIdx), uint16_t>::value, "DetObj::rangeIdx: schema layout");
+static_assert((offsetof(DetObj, dopplerIdx) == 2) && std::is_same<decltype(DetObj::dopplerIdx), int16_t>::value, "DetObj::dopplerIdx: schema layout");
+static_assert((offsetof(DetObj, peakVal) == 4) && std::is_same<decltype(DetObj::peakVal), uint16_t>::value, "DetObj::peakVal: schema layout");
+static_assert((offsetof(DetObj, x) == 6) && std::is_same<decltype(DetObj::x), int16_t>::value, "DetObj::x: schema layout");
+static_assert((offsetof(DetObj, y) == 8) && std::is_same<decltype(DetObj::y), int16_t>::value, "DetObj::y: schema layout");
+static_assert((offsetof(DetObj, z) == 10) && std::is_same<decltype(DetObj::z), int16_t>::value, "DetObj::z: schema layout");
+
+static_assert(sizeof(Cmplx16ImRe) == 4, "Cmplx16ImRe: schema size");
+static_assert((offsetof(Cmplx16ImRe, imag) == 0) && std::is_same<decltype(Cmplx16ImRe::imag), int16_t>::value, "Cmplx16ImRe::imag: schema layout");
+static_assert((offsetof(Cmplx16ImRe, real) == 2) && std::is_same<decltype(Cmplx16ImRe::real), int16_t>::value, "Cmplx16ImRe::real: schema layout");
+
+static_assert(sizeof(Stats) == 24, "Stats: schema size");
+static_assert((offsetof(Stats, interFrameProcessingTime) == 0) && std::is_same<decltype(Stats::interFrameProcessingTime), uint32_t>::value, "Stats::interFrameProcessingTime: schema layout");
+static_assert((offsetof(Stats, transmitOutputTime) == 4) && std::is_same<decltype(Stats::transmitOutputTime), uint32_t>::value, "Stats::transmitOutputTime: schema layout");
+static_assert((offsetof(Stats, interFrameProcessingMargin) == 8) && std::is_same<decltype(Stats::interFrameProcessingMargin), uint32_t>::value, "Stats::interFrameProcessingMargin: schema layout");
+static_assert((offsetof(Stats, interChirpProcessingMargin) == 12) && std::is_same<decltype(Stats::interChirpProcessingMargin), uint32_t>::value, "Stats::interChirpProcessingMargin: schema layout");
+static_assert((offsetof(Stats, activeFrameCPULoad) == 16) && std::is_same<decltype(Stats::activeFrameCPULoad), uint32_t>::value, "Stats::activeFrameCPULoad: schema layout");
+static_assert((offsetof(Stats, interFrameCPULoad) == 20) && std::is_same<decltype(Stats::interFrameCPULoad), uint32_t>::value, "Stats::interFrameCPULoad: schema layout");
+
+static_assert(sizeof(MmwDemo_rdHeatMapCodecHdr) == 8, "MmwDemo_rdHeatMapCodecHdr: schema size");
+static_assert((offsetof(MmwDemo_rdHeatMapCodecHdr, numRangeBins) == 0) && std::is_same<decltype(MmwDemo_rdHeatMapCodecHdr::numRangeBins), uint16_t>::value, "MmwDemo_rdHeatMapCodecHdr::numRangeBins: schema layout");
+static_assert((offsetof(MmwDemo_rdHeatMapCodecHdr, numDopplerBins) == 2) && std::is_same<decltype(MmwDemo_rdHeatMapCodecHdr::numDopplerBins), uint16_t>::value, "MmwDemo_rdHeatMapCodecHdr::numDopplerBins: schema layout");
+static_assert((offsetof(MmwDemo_rdHeatMapCodecHdr, noiseFloor) == 4) && std::is_same<decltype(MmwDemo_rdHeatMapCodecHdr::noiseFloor), uint16_t>::value, "MmwDemo_rdHeatMapCodecHdr::noiseFloor: schema layout");
+static_assert((offsetof(MmwDemo_rdHeatMapCodecHdr, version) == 6) && std::is_same<decltype(MmwDemo_rdHeatMapCodecHdr::version), uint8_t>::value, "MmwDemo_rdHeatMapCodecHdr::version: schema layout");
+static_assert((offsetof(MmwDemo_rdHeatMapCodecHdr, reserved) == 7) && std::is_same<decltype(MmwDemo_rdHeatMapCodecHdr::reserved), uint8_t>::value, "MmwDemo_rdHeatMapCodecHdr::reserved: schema layout");
+
+static_assert(sizeof(MmwDemo_rdHeatMapSparseHdr) == 12, "MmwDemo_rdHeatMapSparseHdr: schema size");
+static_assert((offsetof(MmwDemo_rdHeatMapSparseHdr, numRangeBins) == 0) && std::is_same<decltype(MmwDemo_rdHeatMapSparseHdr::numRangeBins), uint16_t>::value, "MmwDemo_rdHeatMapSparseHdr::numRangeBins: schema layout");
+static_assert((offsetof(MmwDemo_rdHeatMapSparseHdr, numDopplerBins) == 2) && std::is_same<decltype(MmwDemo_rdHeatMapSparseHdr::numDopplerBins), uint16_t>::value, "MmwDemo_rdHeatMapSparseHdr::numDopplerBins: schema layout");
+static_assert((offsetof(MmwDemo_rdHeatMapSparseHdr, numRuns) == 4) && std::is_same<decltype(MmwDemo_rdHeatMapSparseHdr::numRuns), uint16_t>::value, "MmwDemo_rdHeatMapSparseHdr::numRuns: schema layout");
+static_assert((offsetof(MmwDemo_rdHeatMapSparseHdr, margin) == 6) && std::is_same<decltype(MmwDemo_rdHeatMapSparseHdr::margin), uint16_t>::value, "MmwDemo_rdHeatMapSparseHdr::margin: schema layout");
+static_assert((offsetof(MmwDemo_rdHeatMapSparseHdr, version) == 8) && std::is_same<decltype(MmwDemo_rdHeatMapSparseHdr::version), uint8_t>::value, "MmwDemo_rdHeatMapSparseHdr::version: schema layout");
+static_assert((offsetof(MmwDemo_rdHeatMapSparseHdr, flags) == 9) && std::is_same<decltype(MmwDemo_rdHeatMapSparseHdr::flags), uint8_t>::value, "MmwDemo_rdHeatMapSparseHdr::flags: schema layout");
+static_assert((offsetof(MmwDemo_rdHeatMapSparseHdr, reserved) == 10) && std::is_same<decltype(MmwDemo_rdHeatMapSparseHdr::reserved), uint16_t>::value, "MmwDemo_rdHeatMapSparseHdr::reserved: schema layout");
+
+static_assert(sizeof(MmwDemo_azimuthHeatMapHdr) == 8, "MmwDemo_azimuthHeatMapHdr: schema size");
+static_assert((offsetof(MmwDemo_azimuthHeatMapHdr, numRangeBins) == 0) && std::is_same<decltype(MmwDemo_azimuthHeatMapHdr::numRangeBins), uint16_t>::value, "MmwDemo_azimuthHeatMapHdr::numRangeBins: schema layout");
+static_assert((offsetof(MmwDemo_azimuthHeatMapHdr, numAngleBins) == 2) && std::is_same<decltype(MmwDemo_azimuthHeatMapHdr::numAngleBins), uint16_t>::value, "MmwDemo_azimuthHeatMapHdr::numAngleBins: schema layout");
+static_assert((offsetof(MmwDemo_azimuthHeatMapHdr, format) == 4) && std::is_same<decltype(MmwDemo_azimuthHeatMapHdr::format), uint8_t>::value, "MmwDemo_azimuthHeatMapHdr::format: schema layout");
+static_assert((offsetof(MmwDemo_azimuthHeatMapHdr, version) == 5) && std::is_same<decltype(MmwDemo_azimuthHeatMapHdr::version), uint8_t>::value, "MmwDemo_azimuthHeatMapHdr::version: schema layout");
+static_assert((offsetof(MmwDemo_azimuthHeatMapHdr, numVirtualAnt) == 6) && std::is_same<decltype(MmwDemo_azimuthHeatMapHdr::numVirtualAnt), uint16_t>::value, "MmwDemo_azimuthHeatMapHdr::numVirtualAnt: schema layout");
+
+static_assert(sizeof(DssStats) == 32, "DssStats: schema size");
+static_assert((offsetof(DssStats, frameStartIntCounter) == 0) && std::is_same<decltype(DssStats::frameStartIntCounter), uint32_t>::value, "DssStats::frameStartIntCounter: schema layout");
+static_assert((offsetof(DssStats, frameIntSkipCounter) == 4) && std::is_same<decltype(DssStats::frameIntSkipCounter), uint32_t>::value, "DssStats::frameIntSkipCounter: schema layout");
+static_assert((offsetof(DssStats, chirpIntCounter) == 8) && std::is_same<decltype(DssStats::chirpIntCounter), uint32_t>::value, "DssStats::chirpIntCounter: schema layout");
+static_assert((offsetof(DssStats, chirpIntSkipCounter) == 12) && std::is_same<decltype(DssStats::chirpIntSkipCounter), uint32_t>::value, "DssStats::chirpIntSkipCounter: schema layout");
+static_assert((offsetof(DssStats, detObjLoggingSkip) == 16) && std::is_same<decltype(DssStats::detObjLoggingSkip), uint32_t>::value, "DssStats::detObjLoggingSkip: schema layout");
+static_assert((offsetof(DssStats, detObjLoggingErr) == 20) && std::is_same<decltype(DssStats::detObjLoggingErr), uint32_t>::value, "DssStats::detObjLoggingErr: schema layout");
+static_assert((offsetof(DssStats, numFailedTimingReports) == 24) && std::is_same<decltype(DssStats::numFailedTimingReports), uint32_t>::value, "DssStats::numFailedTimingReports: schema layout");
+static_assert((offsetof(DssStats, numCalibrationReports) == 28) && std::is_same<decltype(DssStats::numCalibrationReports), uint32_t>::value, "DssStats::numCalibrationReports: schema layout");
+
+static_assert(sizeof(MssStats) == 20, "MssStats: schema size");
+static_assert((offsetof(MssStats, packetsSent) == 0) && std::is_same<decltype(MssStats::packetsSent), uint32_t>::value, "MssStats::packetsSent: schema layout");
+static_assert((offsetof(MssStats, framesSent) == 4) && std::is_same<decltype(MssStats::framesSent), uint32_t>::value, "MssStats::framesSent: schema layout");
+static_assert((offsetof(MssStats, transferErrors) == 8) && std::is_same<decltype(MssStats::transferErrors), uint32_t>::value, "MssStats::transferErrors: schema layout");
+static_assert((offsetof(MssStats, numFailedTimingReports) == 12) && std::is_same<decltype(MssStats::numFailedTimingReports), uint32_t>::value, "MssStats::numFailedTimingReports: schema layout");
+static_assert((offsetof(MssStats, numCalibrationReports) == 16) && std::is_same<decltype(MssStats::numCalibrationReports), uint32_t>::value, "MssStats::numCalibrationReports: schema layout");
+
+static_assert(sizeof(OutputShed) == 12, "OutputShed: schema size");
+static_assert((offsetof(OutputShed, shedMask) == 0) && std::is_same<decltype(OutputShed::shedMask), uint32_t>::value, "OutputShed::shedMask: schema layout");
+static_assert((offsetof(OutputShed, budgetBytes) == 4) && std::is_same<decltype(OutputShed::budgetBytes), uint32_t>::value, "OutputShed::budgetBytes: schema layout");
+static_assert((offsetof(OutputShed, packetLen) == 8) && std::is_same<decltype(OutputShed::packetLen), uint32_t>::value, "OutputShed::packetLen: schema layout");
+
+static_assert(sizeof(QuietReport) == 12, "QuietReport: schema size");
+static_assert((offsetof(QuietReport, prevFrameNumber) == 0) && std::is_same<decltype(QuietReport::prevFrameNumber), uint32_t>::value, "QuietReport::prevFrameNumber: schema layout");
+static_assert((offsetof(QuietReport, quietFrames) == 4) && std::is_same<decltype(QuietReport::quietFrames), uint32_t>::value, "QuietReport::quietFrames: schema layout");
+static_assert((offsetof(QuietReport, maxRangeDelta) == 8) && std::is_same<decltype(QuietReport::maxRangeDelta), uint16_t>::value, "QuietReport::maxRangeDelta: schema layout");
+static_assert((offsetof(QuietReport, flags) == 10) && std::is_same<decltype(QuietReport::flags), uint16_t>::value, "QuietReport::flags: schema layout");
+
+static_assert(sizeof(MmwDemo_profileDeltaHdr) == 12, "MmwDemo_profileDeltaHdr: schema size");
+static_assert((offsetof(MmwDemo_profileDeltaHdr, numRangeBins) == 0) && std::is_same<decltype(MmwDemo_profileDeltaHdr::numRangeBins), uint16_t>::value, "MmwDemo_profileDeltaHdr::numRangeBins: schema layout");
+static_assert((offsetof(MmwDemo_profileDeltaHdr, seq) == 2) && std::is_same<decltype(MmwDemo_profileDeltaHdr::seq), uint16_t>::value, "MmwDemo_profileDeltaHdr::seq: schema layout");
+static_assert((offsetof(MmwDemo_profileDeltaHdr, refSeq) == 4) && std::is_same<decltype(MmwDemo_profileDeltaHdr::refSeq), uint16_t>::value, "MmwDemo_profileDeltaHdr::refSeq: schema layout");
+static_assert((offsetof(MmwDemo_profileDeltaHdr, tolerance) == 6) && std::is_same<decltype(MmwDemo_profileDeltaHdr::tolerance), uint16_t>::value, "MmwDemo_profileDeltaHdr::tolerance: schema layout");
+static_assert((offsetof(MmwDemo_profileDeltaHdr, version) == 8) && std::is_same<decltype(MmwDemo_profileDeltaHdr::version), uint8_t>::value, "MmwDemo_profileDeltaHdr::version: schema layout");
+static_assert((offsetof(MmwDemo_profileDeltaHdr, flags) == 9) && std::is_same<decltype(MmwDemo_profileDeltaHdr::flags), uint8_t>::value, "MmwDemo_profileDeltaHdr::flags: schema layout");
+static_assert((offsetof(MmwDemo_profileDeltaHdr, reserved) == 10) && std::is_same<decltype(MmwDemo_profileDeltaHdr::reserved), uint16_t>::value, "MmwDemo_profileDeltaHdr::reserved: schema layout");
+
+static_assert(sizeof(PacketCrc) == 4, "PacketCrc: schema size");
+static_assert((offsetof(PacketCrc, crc) == 0) && std::is_same<decltype(PacketCrc::crc), uint32_t>::value, "PacketCrc::crc: schema layout");
+
+static_assert(TLV_DETECTED_POINTS == 0x1, "TLV_DETECTED_POINTS: schema type");
+static_assert(TLV_RANGE_PROFILE == 0x2, "TLV_RANGE_PROFILE: schema type");
+static_assert(TLV_NOISE_PROFILE == 0x3, "TLV_NOISE_PROFILE: schema type");
+static_assert(TLV_AZIMUTH_STATIC_HEAT_MAP == 0x4, "TLV_AZIMUTH_STATIC_HEAT_MAP: schema type");
+static_assert(TLV_RANGE_DOPPLER_HEAT_MAP == 0x5, "TLV_RANGE_DOPPLER_HEAT_MAP: schema type");
+static_assert(TLV_STATS == 0x6, "TLV_STATS: schema type");
+static_assert(TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED == 0x101, "TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED: schema type");
+static_assert(TLV_RANGE_DOPPLER_HEAT_MAP_SPARSE == 0x102, "TLV_RANGE_DOPPLER_HEAT_MAP_SPARSE: schema type");
+static_assert(TLV_AZIMUTH_HEAT_MAP_MAGNITUDE == 0x103, "TLV_AZIMUTH_HEAT_MAP_MAGNITUDE: schema type");
+static_assert(TLV_DSS_STATS == 0x104, "TLV_DSS_STATS: schema type");
+static_assert(TLV_MSS_STATS == 0x105, "TLV_MSS_STATS: schema type");
+static_assert(TLV_OUTPUT_SHED == 0x106, "TLV_OUTPUT_SHED: schema type");
+static_assert(TLV_QUIET == 0x107, "TLV_QUIET: schema type");
+static_assert(TLV_RANGE_PROFILE_DELTA == 0x108, "TLV_RANGE_PROFILE_DELTA: schema type");
+static_assert(TLV_NOISE_PROFILE_DELTA == 0x109, "TLV_NOISE_PROFILE_DELTA: schema type");
+static_assert(TLV_PACKET_CRC == 0x10A, "TLV_PACKET_CRC: schema type");
+
+/**
+ * @brief
+ *  Payload layouts of the schema
+ */
+enum TlvLayoutKind : uint8_t
+{
+    TLV_LAYOUT_STRUCT   = 0,    /*!< Exactly Fixed */
+    TLV_LAYOUT_ARRAY    = 1,    /*!< Elements of Elem, no header */
+    TLV_LAYOUT_COUNTED  = 2,    /*!< Fixed, then a counted array of Elem */
+    TLV_LAYOUT_PREFIXED = 3     /*!< Fixed, then bytes its own decoder checks */
+};
+
+/**
+ * @brief
+ *  Decoder of one TLV type: Fixed is the struct at the start of the
+ *  payload (void without), Elem the array element (void without).
+ *  valid() is the length check of parseFrame, elems() the number of
+ *  elements at elemOffset.
+ */
+template <uint32_t Type>
+struct TlvLayout;
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_DETECTED_POINTS */
+template <>
+struct TlvLayout<TLV_DETECTED_POINTS>
+{
+    using Fixed = DetObjDescr;
+    using Elem = DetObj;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_COUNTED;
+    static constexpr uint32_t fixedLen = 4;
+    static constexpr uint32_t elemLen = 12;
+    static constexpr uint32_t elemOffset = 4;
+    static constexpr uint32_t countOffset = 0;
+
+    static uint32_t elems(const uint8_t *v, uint32_t)      { return load<uint16_t>(v + countOffset); }
+    static bool valid(const uint8_t *v, uint32_t length)
+    {
+        return (length >= fixedLen) && (length == fixedLen + elems(v, length) * elemLen);
+    }
+};
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_RANGE_PROFILE */
+template <>
+struct TlvLayout<TLV_RANGE_PROFILE>
+{
+    using Fixed = void;
+    using Elem = uint16_t;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_ARRAY;
+    static constexpr uint32_t fixedLen = 0;
+    static constexpr uint32_t elemLen = 2;
+    static constexpr uint32_t elemOffset = 0;
+
+    static bool valid(const uint8_t *, uint32_t length)    { return (length % elemLen) == 0U; }
+    static uint32_t elems(const uint8_t *, uint32_t length) { return length / elemLen; }
+};
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_NOISE_PROFILE */
+template <>
+struct TlvLayout<TLV_NOISE_PROFILE>
+{
+    using Fixed = void;
+    using Elem = uint16_t;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_ARRAY;
+    static constexpr uint32_t fixedLen = 0;
+    static constexpr uint32_t elemLen = 2;
+    static constexpr uint32_t elemOffset = 0;
+
+    static bool valid(const uint8_t *, uint32_t length)    { return (length % elemLen) == 0U; }
+    static uint32_t elems(const uint8_t *, uint32_t length) { return length / elemLen; }
+};
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_AZIMUT_STATIC_HEAT_MAP */
+template <>
+struct TlvLayout<TLV_AZIMUTH_STATIC_HEAT_MAP>
+{
+    using Fixed = void;
+    using Elem = Cmplx16ImRe;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_ARRAY;
+    static constexpr uint32_t fixedLen = 0;
+    static constexpr uint32_t elemLen = 4;
+    static constexpr uint32_t elemOffset = 0;
+
+    static bool valid(const uint8_t *, uint32_t length)    { return (length % elemLen) == 0U; }
+    static uint32_t elems(const uint8_t *, uint32_t length) { return length / elemLen; }
+};
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP */
+template <>
+struct TlvLayout<TLV_RANGE_DOPPLER_HEAT_MAP>
+{
+    using Fixed = void;
+    using Elem = uint16_t;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_ARRAY;
+    static constexpr uint32_t fixedLen = 0;
+    static constexpr uint32_t elemLen = 2;
+    static constexpr uint32_t elemOffset = 0;
+
+    static bool valid(const uint8_t *, uint32_t length)    { return (length % elemLen) == 0U; }
+    static uint32_t elems(const uint8_t *, uint32_t length) { return length / elemLen; }
+};
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_STATS */
+template <>
+struct TlvLayout<TLV_STATS>
+{
+    using Fixed = Stats;
+    using Elem = void;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_STRUCT;
+    static constexpr uint32_t fixedLen = 24;
+    static constexpr uint32_t elemLen = 0;
+    static constexpr uint32_t elemOffset = 24;
+
+    static bool valid(const uint8_t *, uint32_t length)    { return length == fixedLen; }
+    static uint32_t elems(const uint8_t *, uint32_t)       { return 0; }
+};
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED */
+template <>
+struct TlvLayout<TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED>
+{
+    using Fixed = MmwDemo_rdHeatMapCodecHdr;
+    using Elem = void;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_PREFIXED;
+    static constexpr uint32_t fixedLen = 8;
+    static constexpr uint32_t elemLen = 0;
+    static constexpr uint32_t elemOffset = 8;
+
+    static bool valid(const uint8_t *, uint32_t length)    { return length >= fixedLen; }
+    static uint32_t elems(const uint8_t *, uint32_t)       { return 0; }
+};
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_SPARSE */
+template <>
+struct TlvLayout<TLV_RANGE_DOPPLER_HEAT_MAP_SPARSE>
+{
+    using Fixed = MmwDemo_rdHeatMapSparseHdr;
+    using Elem = void;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_PREFIXED;
+    static constexpr uint32_t fixedLen = 12;
+    static constexpr uint32_t elemLen = 0;
+    static constexpr uint32_t elemOffset = 12;
+
+    static bool valid(const uint8_t *, uint32_t length)    { return length >= fixedLen; }
+    static uint32_t elems(const uint8_t *, uint32_t)       { return 0; }
+};
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_AZIMUTH_HEAT_MAP_MAGNITUDE */
+template <>
+struct TlvLayout<TLV_AZIMUTH_HEAT_MAP_MAGNITUDE>
+{
+    using Fixed = MmwDemo_azimuthHeatMapHdr;
+    using Elem = void;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_PREFIXED;
+    static constexpr uint32_t fixedLen = 8;
+    static constexpr uint32_t elemLen = 0;
+    static constexpr uint32_t elemOffset = 8;
+
+    static bool valid(const uint8_t *, uint32_t length)    { return length >= fixedLen; }
+    static uint32_t elems(const uint8_t *, uint32_t)       { return 0; }
+};
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_DSS_STATS */
+template <>
+struct TlvLayout<TLV_DSS_STATS>
+{
+    using Fixed = DssStats;
+    using Elem = void;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_STRUCT;
+    static constexpr uint32_t fixedLen = 32;
+    static constexpr uint32_t elemLen = 0;
+    static constexpr uint32_t elemOffset = 32;
+
+    static bool valid(const uint8_t *, uint32_t length)    { return length == fixedLen; }
+    static uint32_t elems(const uint8_t *, uint32_t)       { return 0; }
+};
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_MSS_STATS */
+template <>
+struct TlvLayout<TLV_MSS_STATS>
+{
+    using Fixed = MssStats;
+    using Elem = void;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_STRUCT;
+    static constexpr uint32_t fixedLen = 20;
+    static constexpr uint32_t elemLen = 0;
+    static constexpr uint32_t elemOffset = 20;
+
+    static bool valid(const uint8_t *, uint32_t length)    { return length == fixedLen; }
+    static uint32_t elems(const uint8_t *, uint32_t)       { return 0; }
+};
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_OUTPUT_SHED */
+template <>
+struct TlvLayout<TLV_OUTPUT_SHED>
+{
+    using Fixed = OutputShed;
+    using Elem = void;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_STRUCT;
+    static constexpr uint32_t fixedLen = 12;
+    static constexpr uint32_t elemLen = 0;
+    static constexpr uint32_t elemOffset = 12;
+
+    static bool valid(const uint8_t *, uint32_t length)    { return length == fixedLen; }
+    static uint32_t elems(const uint8_t *, uint32_t)       { return 0; }
+};
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_QUIET */
+template <>
+struct TlvLayout<TLV_QUIET>
+{
+    using Fixed = QuietReport;
+    using Elem = void;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_STRUCT;
+    static constexpr uint32_t fixedLen = 12;
+    static constexpr uint32_t elemLen = 0;
+    static constexpr uint32_t elemOffset = 12;
+
+    static bool valid(const uint8_t *, uint32_t length)    { return length == fixedLen; }
+    static uint32_t elems(const uint8_t *, uint32_t)       { return 0; }
+};
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_RANGE_PROFILE_DELTA */
+template <>
+struct TlvLayout<TLV_RANGE_PROFILE_DELTA>
+{
+    using Fixed = MmwDemo_profileDeltaHdr;
+    using Elem = void;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_PREFIXED;
+    static constexpr uint32_t fixedLen = 12;
+    static constexpr uint32_t elemLen = 0;
+    static constexpr uint32_t elemOffset = 12;
+
+    static bool valid(const uint8_t *, uint32_t length)    { return length >= fixedLen; }
+    static uint32_t elems(const uint8_t *, uint32_t)       { return 0; }
+};
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_NOISE_PROFILE_DELTA */
+template <>
+struct TlvLayout<TLV_NOISE_PROFILE_DELTA>
+{
+    using Fixed = MmwDemo_profileDeltaHdr;
+    using Elem = void;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_PREFIXED;
+    static constexpr uint32_t fixedLen = 12;
+    static constexpr uint32_t elemLen = 0;
+    static constexpr uint32_t elemOffset = 12;
+
+    static bool valid(const uint8_t *, uint32_t length)    { return length >= fixedLen; }
+    static uint32_t elems(const uint8_t *, uint32_t)       { return 0; }
+};
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_PACKET_CRC */
+template <>
+struct TlvLayout<TLV_PACKET_CRC>
+{
+    using Fixed = PacketCrc;
+    using Elem = void;
+    static constexpr TlvLayoutKind kind = TLV_LAYOUT_STRUCT;
+    static constexpr uint32_t fixedLen = 4;
+    static constexpr uint32_t elemLen = 0;
+    static constexpr uint32_t elemOffset = 4;
+
+    static bool valid(const uint8_t *, uint32_t length)    { return length == fixedLen; }
+    static uint32_t elems(const uint8_t *, uint32_t)       { return 0; }
+};
+
+/*! @brief   Fixed struct at the start of a payload */
+template <uint32_t Type>
+inline typename TlvLayout<Type>::Fixed tlvFixed(const uint8_t *v)
+{
+    return load<typename TlvLayout<Type>::Fixed>(v);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Length check of a TLV against its layout; types the schema does
+ *      not know pass.
+ *
+ *  @param[in]  type
+ *      TLV type
+ *  @param[in]  v
+ *      Payload
+ *  @param[in]  length
+ *      Payload bytes
+ *
+ *  @retval
+ *      false when the length is impossible for the type
+ */
+inline bool tlvValid(uint32_t type, const uint8_t *v, uint32_t length)
+{
+    switch (type)
+    {
+    case TLV_DETECTED_POINTS: return TlvLayout<TLV_DETECTED_POINTS>::valid(v, length);
+    case TLV_RANGE_PROFILE: return TlvLayout<TLV_RANGE_PROFILE>::valid(v, length);
+    case TLV_NOISE_PROFILE: return TlvLayout<TLV_NOISE_PROFILE>::valid(v, length);
+    case TLV_AZIMUTH_STATIC_HEAT_MAP: return TlvLayout<TLV_AZIMUTH_STATIC_HEAT_MAP>::valid(v, length);
+    case TLV_RANGE_DOPPLER_HEAT_MAP: return TlvLayout<TLV_RANGE_DOPPLER_HEAT_MAP>::valid(v, length);
+    case TLV_STATS: return TlvLayout<TLV_STATS>::valid(v, length);
+    case TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED: return TlvLayout<TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED>::valid(v, length);
+    case TLV_RANGE_DOPPLER_HEAT_MAP_SPARSE: return TlvLayout<TLV_RANGE_DOPPLER_HEAT_MAP_SPARSE>::valid(v, length);
+    case TLV_AZIMUTH_HEAT_MAP_MAGNITUDE: return TlvLayout<TLV_AZIMUTH_HEAT_MAP_MAGNITUDE>::valid(v, length);
+    case TLV_DSS_STATS: return TlvLayout<TLV_DSS_STATS>::valid(v, length);
+    case TLV_MSS_STATS: return TlvLayout<TLV_MSS_STATS>::valid(v, length);
+    case TLV_OUTPUT_SHED: return TlvLayout<TLV_OUTPUT_SHED>::valid(v, length);
+    case TLV_QUIET: return TlvLayout<TLV_QUIET>::valid(v, length);
+    case TLV_RANGE_PROFILE_DELTA: return TlvLayout<TLV_RANGE_PROFILE_DELTA>::valid(v, length);
+    case TLV_NOISE_PROFILE_DELTA: return TlvLayout<TLV_NOISE_PROFILE_DELTA>::valid(v, length);
+    case TLV_PACKET_CRC: return TlvLayout<TLV_PACKET_CRC>::valid(v, length);
+    default: return true;
+    }
+}
+
+} /* namespace mmw */
+
+#endif /* MMW_WIRE_LAYOUT_H */
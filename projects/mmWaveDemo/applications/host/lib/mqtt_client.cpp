@@ -0,0 +1,526 @@
+/**
+ *   @file  mqtt_client.cpp
+ *
+ *   @brief
+ *      Minimal MQTT 3.1.1 publisher, see mqtt_client.h.
+ */
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "host_clock.h"
+#include "mqtt_client.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+/* Control packet types, high nibble of the fixed header */
+const uint8_t MQTT_CONNECT     = 0x10;
+const uint8_t MQTT_CONNACK     = 0x20;
+const uint8_t MQTT_PUBLISH     = 0x30;
+const uint8_t MQTT_PUBACK      = 0x40;
+const uint8_t MQTT_PUBREC      = 0x50;
+const uint8_t MQTT_PUBREL      = 0x62;
+const uint8_t MQTT_PUBCOMP     = 0x70;
+const uint8_t MQTT_PINGREQ     = 0xC0;
+const uint8_t MQTT_DISCONNECT  = 0xE0;
+
+/* Largest remaining length MQTT can express */
+const size_t MQTT_MAX_REMAINING = 268435455U;
+
+void putRemainingLength(std::vector<uint8_t> &out, size_t n)
+{
+    do
+    {
+        uint8_t b = (uint8_t)(n & 0x7FU);
+        n >>= 7;
+        if (n != 0U)
+        {
+            b |= 0x80U;
+        }
+        out.push_back(b);
+    } while (n != 0U);
+}
+
+void putU16(std::vector<uint8_t> &out, uint16_t v)
+{
+    out.push_back((uint8_t)(v >> 8));
+    out.push_back((uint8_t)v);
+}
+
+void putString(std::vector<uint8_t> &out, const std::string &s)
+{
+    putU16(out, (uint16_t)s.size());
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+/* Reads exactly n bytes before the deadline */
+int recvAll(int fd, uint8_t *p, size_t n, uint64_t deadlineNs)
+{
+    while (n > 0U)
+    {
+        const uint64_t now = monotonicNs();
+        if (now >= deadlineNs)
+        {
+            return -1;
+        }
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        const int r = poll(&pfd, 1, (int)((deadlineNs - now) / 1000000ULL) + 1);
+        if ((r < 0) && (errno != EINTR))
+        {
+            return -1;
+        }
+        if (r <= 0)
+        {
+            continue;
+        }
+        const ssize_t got = recv(fd, p, n, 0);
+        if (got <= 0)
+        {
+            if ((got < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+            return -1;
+        }
+        p += got;
+        n -= (size_t)got;
+    }
+    return 0;
+}
+
+int connectSocket(const MqttClientConfig &cfg)
+{
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *res = nullptr;
+    if (getaddrinfo(cfg.host.c_str(), std::to_string(cfg.port).c_str(), &hints, &res) != 0)
+    {
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo *ai = res; (ai != nullptr) && (fd < 0); ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC | SOCK_NONBLOCK, ai->ai_protocol);
+        if (fd < 0)
+        {
+            continue;
+        }
+        int err = 0;
+        if (::connect(fd, ai->ai_addr, ai->ai_addrlen) != 0)
+        {
+            err = errno;
+            if (err == EINPROGRESS)
+            {
+                struct pollfd pfd = { fd, POLLOUT, 0 };
+                socklen_t errLen = sizeof(err);
+                if ((poll(&pfd, 1, (int)cfg.connectTimeoutMs) != 1) ||
+                    (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errLen) != 0))
+                {
+                    err = ETIMEDOUT;
+                }
+            }
+        }
+        if (err != 0)
+        {
+            ::close(fd);
+            fd = -1;
+            errno = err;
+        }
+    }
+    freeaddrinfo(res);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    const int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+} /* anonymous namespace */
+
+MqttClient::~MqttClient()
+{
+    close();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Connects to the broker with a clean session and waits for its
+ *      CONNACK.
+ *
+ *  @param[in]  cfg
+ *      Connection configuration
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, no connection or refused by the broker
+ */
+int MqttClient::connect(const MqttClientConfig &cfg)
+{
+    if ((m_fd >= 0) || (cfg.maxInflight == 0U) || (cfg.clientId.size() > 0xFFFFU))
+    {
+        return -1;
+    }
+    m_cfg = cfg;
+    m_fd = connectSocket(cfg);
+    if (m_fd < 0)
+    {
+        return -1;
+    }
+
+    std::vector<uint8_t> body;
+    putString(body, "MQTT");
+    body.push_back(4U);
+    uint8_t flags = 0x02U;
+    if (!cfg.username.empty())
+    {
+        flags |= 0x80U;
+        if (!cfg.password.empty())
+        {
+            flags |= 0x40U;
+        }
+    }
+    body.push_back(flags);
+    putU16(body, cfg.keepAliveS);
+    putString(body, cfg.clientId);
+    if ((flags & 0x80U) != 0U)
+    {
+        putString(body, cfg.username);
+    }
+    if ((flags & 0x40U) != 0U)
+    {
+        putString(body, cfg.password);
+    }
+    std::vector<uint8_t> hdr;
+    hdr.push_back(MQTT_CONNECT);
+    putRemainingLength(hdr, body.size());
+
+    uint8_t ack[4];
+    if ((sendPacket(hdr.data(), hdr.size(), body.data(), body.size()) < 0) ||
+        (recvAll(m_fd, ack, sizeof(ack), monotonicNs() + (uint64_t)cfg.connectTimeoutMs * 1000000ULL) < 0) ||
+        (ack[0] != MQTT_CONNACK) || (ack[1] != 2U) || (ack[3] != 0U))
+    {
+        ::close(m_fd);
+        m_fd = -1;
+        return -1;
+    }
+
+    m_stop.store(false);
+    m_connected.store(true);
+    m_thread = std::thread(&MqttClient::ioLoop, this);
+    return 0;
+}
+
+int MqttClient::sendPacket(const uint8_t *hdr, size_t hdrLen, const uint8_t *payload, size_t len)
+{
+    struct iovec iov[2];
+    iov[0].iov_base = (void *)hdr;
+    iov[0].iov_len = hdrLen;
+    iov[1].iov_base = (void *)payload;
+    iov[1].iov_len = len;
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = (len != 0U) ? 2 : 1;
+
+    std::lock_guard<std::mutex> guard(m_writeLock);
+    while (msg.msg_iovlen > 0)
+    {
+        const ssize_t n = sendmsg(m_fd, &msg, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            /* The I/O thread sees the connection go */
+            shutdown(m_fd, SHUT_RDWR);
+            return -1;
+        }
+        size_t sent = (size_t)n;
+        while ((msg.msg_iovlen > 0) && (sent >= msg.msg_iov[0].iov_len))
+        {
+            sent -= msg.msg_iov[0].iov_len;
+            msg.msg_iov++;
+            msg.msg_iovlen--;
+        }
+        if (msg.msg_iovlen > 0)
+        {
+            msg.msg_iov[0].iov_base = (uint8_t *)msg.msg_iov[0].iov_base + sent;
+            msg.msg_iov[0].iov_len -= sent;
+        }
+    }
+    m_lastWriteNs.store(monotonicNs(), std::memory_order_relaxed);
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Publishes a message. At QoS 1 and 2 this waits while maxInflight
+ *      messages are unacknowledged; it returns once the message is written,
+ *      the acknowledgement is counted when it comes.
+ *
+ *  @param[in]  topic
+ *      Topic
+ *  @param[in]  payload
+ *      Message, written as is
+ *  @param[in]  len
+ *      Message length
+ *  @param[in]  qos
+ *      0, 1 or 2
+ *  @param[in]  retain
+ *      Have the broker keep the message for later subscribers
+ *  @param[in]  timeoutMs
+ *      Longest wait for room in flight, <0 waits as long as connected
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, not connected, no room in time or write failed
+ */
+int MqttClient::publish(const std::string &topic, const uint8_t *payload, size_t len, uint8_t qos,
+                        bool retain, int timeoutMs)
+{
+    if (!m_connected.load() || (qos > 2U) || topic.empty() || (topic.size() > 0xFFFFU) ||
+        (2U + topic.size() + 2U + len > MQTT_MAX_REMAINING))
+    {
+        return -1;
+    }
+    const uint64_t t0 = monotonicNs();
+    uint16_t packetId = 0;
+    if (qos > 0U)
+    {
+        std::unique_lock<std::mutex> guard(m_lock);
+        auto room = [this] { return (m_inflight.size() < m_cfg.maxInflight) || !m_connected.load(); };
+        if (timeoutMs < 0)
+        {
+            m_cv.wait(guard, room);
+        }
+        else if (!m_cv.wait_for(guard, std::chrono::milliseconds(timeoutMs), room))
+        {
+            return -1;
+        }
+        if (!m_connected.load())
+        {
+            return -1;
+        }
+        do
+        {
+            packetId = m_nextId++;
+        } while ((packetId == 0U) || (m_inflight.count(packetId) != 0U));
+        m_inflight[packetId] = Inflight{ t0, qos };
+        m_stats.inflight = (uint32_t)m_inflight.size();
+    }
+
+    std::vector<uint8_t> hdr;
+    hdr.reserve(topic.size() + 9U);
+    hdr.push_back((uint8_t)(MQTT_PUBLISH | (qos << 1) | (retain ? 1U : 0U)));
+    putRemainingLength(hdr, 2U + topic.size() + ((qos > 0U) ? 2U : 0U) + len);
+    putString(hdr, topic);
+    if (qos > 0U)
+    {
+        putU16(hdr, packetId);
+    }
+    const int err = sendPacket(hdr.data(), hdr.size(), payload, len);
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    if (err < 0)
+    {
+        if ((qos > 0U) && (m_inflight.erase(packetId) != 0U))
+        {
+            m_stats.failed++;
+            m_stats.inflight = (uint32_t)m_inflight.size();
+        }
+        return -1;
+    }
+    m_stats.published++;
+    m_stats.bytes += len;
+    if (qos == 0U)
+    {
+        m_stats.completed++;
+        m_stats.latency.add(monotonicNs() - t0);
+    }
+    return 0;
+}
+
+void MqttClient::complete(uint16_t packetId, uint8_t qos)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    auto it = m_inflight.find(packetId);
+    if ((it == m_inflight.end()) || (it->second.qos != qos))
+    {
+        return;
+    }
+    m_stats.latency.add(monotonicNs() - it->second.sentNs);
+    m_stats.completed++;
+    m_inflight.erase(it);
+    m_stats.inflight = (uint32_t)m_inflight.size();
+    m_cv.notify_all();
+}
+
+void MqttClient::lost()
+{
+    m_connected.store(false);
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_stats.failed += m_inflight.size();
+    m_inflight.clear();
+    m_stats.inflight = 0;
+    m_cv.notify_all();
+}
+
+void MqttClient::ioLoop()
+{
+    std::vector<uint8_t> in;
+    uint8_t buf[4096];
+    const uint64_t pingNs = (uint64_t)m_cfg.keepAliveS * 500000000ULL;
+
+    while (!m_stop.load())
+    {
+        struct pollfd pfd = { m_fd, POLLIN, 0 };
+        const int r = poll(&pfd, 1, 100);
+        if ((r < 0) && (errno != EINTR))
+        {
+            break;
+        }
+        if ((pingNs != 0U) && (monotonicNs() - m_lastWriteNs.load(std::memory_order_relaxed) >= pingNs))
+        {
+            const uint8_t ping[2] = { MQTT_PINGREQ, 0 };
+            sendPacket(ping, sizeof(ping), nullptr, 0);
+        }
+        if (r <= 0)
+        {
+            continue;
+        }
+        const ssize_t n = recv(m_fd, buf, sizeof(buf), 0);
+        if (n <= 0)
+        {
+            if ((n < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+            break;
+        }
+        in.insert(in.end(), buf, buf + n);
+
+        /* A publisher only gets PUBACK, PUBREC, PUBCOMP and PINGRESP;
+         * anything else is skipped */
+        size_t pos = 0;
+        while (in.size() - pos >= 2U)
+        {
+            size_t remaining = 0;
+            size_t i = 1;
+            uint32_t shift = 0;
+            bool whole = false;
+            while ((pos + i < in.size()) && (i <= 4U))
+            {
+                const uint8_t b = in[pos + i++];
+                remaining |= (size_t)(b & 0x7FU) << shift;
+                shift += 7U;
+                if ((b & 0x80U) == 0U)
+                {
+                    whole = true;
+                    break;
+                }
+            }
+            if (!whole || (in.size() - pos - i < remaining))
+            {
+                break;
+            }
+            const uint8_t type = in[pos];
+            const uint16_t packetId = (remaining >= 2U) ?
+                (uint16_t)((in[pos + i] << 8) | in[pos + i + 1U]) : 0U;
+            if (type == MQTT_PUBACK)
+            {
+                complete(packetId, 1U);
+            }
+            else if (type == MQTT_PUBREC)
+            {
+                const uint8_t rel[4] = { MQTT_PUBREL, 2, (uint8_t)(packetId >> 8), (uint8_t)packetId };
+                sendPacket(rel, sizeof(rel), nullptr, 0);
+            }
+            else if (type == MQTT_PUBCOMP)
+            {
+                complete(packetId, 2U);
+            }
+            pos += i + remaining;
+        }
+        in.erase(in.begin(), in.begin() + (std::ptrdiff_t)pos);
+    }
+    lost();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Waits until every QoS 1 and 2 message is acknowledged.
+ *
+ *  @param[in]  timeoutMs
+ *      Longest wait
+ *
+ *  @retval
+ *      True if nothing is left in flight
+ */
+bool MqttClient::flush(int timeoutMs)
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+    return m_cv.wait_for(guard, std::chrono::milliseconds(timeoutMs),
+                         [this] { return m_inflight.empty() || !m_connected.load(); }) && m_inflight.empty();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Sends DISCONNECT and closes the connection. Messages still in flight
+ *      count as failed.
+ */
+void MqttClient::close()
+{
+    if (m_fd < 0)
+    {
+        return;
+    }
+    if (m_connected.load())
+    {
+        const uint8_t bye[2] = { MQTT_DISCONNECT, 0 };
+        sendPacket(bye, sizeof(bye), nullptr, 0);
+    }
+    m_stop.store(true);
+    shutdown(m_fd, SHUT_RDWR);
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    ::close(m_fd);
+    m_fd = -1;
+    lost();
+}
+
+MqttClientStats MqttClient::stats() const
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_stats;
+}
+
+} /* namespace mmw */
@@ -0,0 +1,132 @@
+/**
+ *   @file  mqtt_client.h
+ *
+ *   @brief
+ *      Minimal MQTT 3.1.1 publisher: CONNECT, PUBLISH at QoS 0, 1 or 2,
+ *      keep alive. Nothing is subscribed to.
+ */
+#ifndef MQTT_CLIENT_H
+#define MQTT_CLIENT_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "lag_histogram.h"
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  Connection configuration
+ */
+struct MqttClientConfig
+{
+    std::string host = "127.0.0.1";
+    uint16_t    port = 1883;
+    std::string clientId = "mmw";
+
+    /*! @brief   Empty for none */
+    std::string username;
+    std::string password;
+
+    /*! @brief   0 disables keep alive */
+    uint16_t    keepAliveS = 30;
+
+    /*! @brief   QoS 1 and 2 messages sent but not acknowledged before
+     *           publish() waits */
+    uint32_t    maxInflight = 32;
+
+    uint32_t    connectTimeoutMs = 3000;
+};
+
+/**
+ * @brief
+ *  Publisher counters
+ */
+struct MqttClientStats
+{
+    uint64_t        published = 0;
+    uint64_t        bytes = 0;
+
+    /*! @brief   Sent at QoS 0, or acknowledged at QoS 1 and 2 */
+    uint64_t        completed = 0;
+
+    /*! @brief   Lost with the connection before their acknowledgement */
+    uint64_t        failed = 0;
+
+    uint32_t        inflight = 0;
+
+    /*! @brief   publish() to PUBACK (QoS 1), PUBCOMP (QoS 2) or the end of
+     *           the socket write (QoS 0) */
+    LagHistogram    latency;
+};
+
+/**
+ * @brief
+ *  MQTT publisher
+ *
+ * @details
+ *  publish() writes the message straight to the socket, the payload is not
+ *  copied. Acknowledgements are read on a thread of the client, so up to
+ *  maxInflight QoS 1 or 2 messages are on their way at any time instead of
+ *  one per round trip. Messages in flight when the connection drops are
+ *  counted as failed, not sent again.
+ */
+class MqttClient
+{
+public:
+    MqttClient() = default;
+    ~MqttClient();
+
+    MqttClient(const MqttClient &) = delete;
+    MqttClient &operator=(const MqttClient &) = delete;
+
+    int connect(const MqttClientConfig &cfg);
+    int publish(const std::string &topic, const uint8_t *payload, size_t len, uint8_t qos,
+                bool retain = false, int timeoutMs = -1);
+    bool flush(int timeoutMs);
+    void close();
+
+    bool connected() const { return m_connected.load(); }
+    MqttClientStats stats() const;
+
+private:
+    struct Inflight
+    {
+        uint64_t    sentNs;
+        uint8_t     qos;
+    };
+
+    int sendPacket(const uint8_t *hdr, size_t hdrLen, const uint8_t *payload, size_t len);
+    void complete(uint16_t packetId, uint8_t qos);
+    void lost();
+    void ioLoop();
+
+    MqttClientConfig        m_cfg;
+    int                     m_fd = -1;
+    std::thread             m_thread;
+    std::atomic<bool>       m_connected{false};
+    std::atomic<bool>       m_stop{false};
+
+    /* Writers: publish() and the keep alive / PUBREL of the I/O thread */
+    std::mutex              m_writeLock;
+    std::atomic<uint64_t>   m_lastWriteNs{0};
+
+    mutable std::mutex      m_lock;
+    std::condition_variable m_cv;
+    std::unordered_map<uint16_t, Inflight> m_inflight;
+    uint16_t                m_nextId = 1;
+    MqttClientStats         m_stats;
+};
+
+} /* namespace mmw */
+
+#endif /* MQTT_CLIENT_H */
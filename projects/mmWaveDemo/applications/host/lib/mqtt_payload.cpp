@@ -0,0 +1,264 @@
+/**
+ *   @file  mqtt_payload.cpp
+ *
+ *   @brief
+ *      Binary MQTT payload of azimuth heat maps, see mqtt_payload.h.
+ */
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "azimuth_heatmap.h"
+#include "mmw_crc32.h"
+#include "mqtt_payload.h"
+#include "replay.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+uint32_t pow2RoundUp(uint32_t x)
+{
+    uint32_t y = 1;
+    while (y < x)
+    {
+        y <<= 1;
+    }
+    return y;
+}
+
+} /* anonymous namespace */
+
+/**
+ *  @b Description
+ *  @n
+ *      Takes the geometry from the .cfg the sensor was started with: the
+ *      virtual antennas from channelCfg, the range bins from the ADC
+ *      samples of profileCfg, the frame period from frameCfg. Remembers
+ *      the CRC-32 of the text.
+ *
+ *  @param[in]  cfgText
+ *      Contents of the .cfg
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, no channelCfg or profileCfg
+ */
+int MqttPayloadConfig::fromCfg(const std::string &cfgText)
+{
+    std::istringstream in(cfgText);
+    std::string line;
+    bool haveChannels = false;
+    bool haveProfile = false;
+
+    while (std::getline(in, line))
+    {
+        std::istringstream words(line);
+        std::string cmd;
+        words >> cmd;
+        if (cmd == "channelCfg")
+        {
+            /* channelCfg <rxChannelEn> <txChannelEn> <cascading>; Tx 1 and 2 are azimuth */
+            unsigned rxEn = 0;
+            unsigned txEn = 0;
+            if (words >> rxEn >> txEn)
+            {
+                numVirtualAnt = (uint32_t)__builtin_popcount(rxEn & 0xFU) *
+                                (uint32_t)__builtin_popcount(txEn & 0x3U);
+                haveChannels = (numVirtualAnt != 0U);
+            }
+        }
+        else if (cmd == "profileCfg")
+        {
+            /* profileCfg <id> <startFreq> <idle> <adcStart> <rampEnd> <txPower> <txPhase>
+             *            <slope> <txStart> <numAdcSamples> ... */
+            std::string arg;
+            for (int i = 0; (i < 10) && (words >> arg); i++)
+            {
+            }
+            if (!words.fail())
+            {
+                numRangeBins = pow2RoundUp((uint32_t)std::strtoul(arg.c_str(), nullptr, 10));
+                haveProfile = true;
+            }
+        }
+    }
+    framePeriodUs = Replayer::cfgFramePeriodUs(cfgText);
+    cfgCrc = MmwDemo_crc32(MMW_CRC32_INIT, (const uint8_t *)cfgText.data(), (uint32_t)cfgText.size());
+    return (haveChannels && haveProfile) ? 0 : -1;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Sets the encoder up and starts the first message.
+ *
+ *  @param[in]  cfg
+ *      Payload configuration
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int MqttPayloadEncoder::init(const MqttPayloadConfig &cfg)
+{
+    if ((cfg.numVirtualAnt == 0U) || (cfg.numVirtualAnt > 0xFFFFU) || (cfg.numRangeBins > 0xFFFFU) ||
+        ((cfg.kind != MQTT_PAYLOAD_AZIMUTH_IQ) && (cfg.kind != MQTT_PAYLOAD_AZIMUTH_MAGNITUDE)))
+    {
+        return -1;
+    }
+    if ((cfg.kind == MQTT_PAYLOAD_AZIMUTH_MAGNITUDE) &&
+        ((cfg.numAngleBins < MMW_AZIMUTH_HEATMAP_MIN_BINS) || (cfg.numAngleBins > 0xFFFFU) ||
+         ((cfg.numAngleBins & (cfg.numAngleBins - 1U)) != 0U) || (cfg.format > MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG)))
+    {
+        return -1;
+    }
+    m_cfg = cfg;
+    m_recordLen = 0;
+    if ((cfg.numRangeBins != 0U) && (setGeometry(cfg.numRangeBins) < 0))
+    {
+        return -1;
+    }
+    reset();
+    return 0;
+}
+
+int MqttPayloadEncoder::setGeometry(uint32_t numRangeBins)
+{
+    if ((numRangeBins == 0U) || (numRangeBins > 0xFFFFU))
+    {
+        return -1;
+    }
+    m_cfg.numRangeBins = numRangeBins;
+    if (m_cfg.kind == MQTT_PAYLOAD_AZIMUTH_IQ)
+    {
+        m_recordLen = (uint32_t)(sizeof(MqttFrameRecord) + (size_t)numRangeBins * m_cfg.numVirtualAnt * 4U);
+    }
+    else
+    {
+        const size_t tlvLen = azimuthHeatMapSize(numRangeBins, m_cfg.numAngleBins, m_cfg.format);
+        m_recordLen = (uint32_t)(sizeof(MqttFrameRecord) + tlvLen - sizeof(MmwDemo_azimuthHeatMapHdr));
+        m_magnitude.resize(tlvLen);
+    }
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Starts the next message.
+ */
+void MqttPayloadEncoder::reset()
+{
+    m_numFrames = 0;
+    m_buf.resize(sizeof(MqttPayloadHeader));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Appends a frame. The IQ map is copied as received; the magnitude map
+ *      is taken from the magnitude TLV if the device sent one of the
+ *      configured size, otherwise computed from the IQ map like the DSS
+ *      would.
+ *
+ *  @param[in]  frame
+ *      Parsed packet
+ *  @param[in]  hostNs
+ *      CLOCK_MONOTONIC when the packet came in
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, no heat map of the configured size in the packet
+ */
+int MqttPayloadEncoder::add(const FrameView &frame, uint64_t hostNs)
+{
+    const size_t iqLen = frame.azimuthStatic.sizeBytes();
+    const TlvRef *magTlv = frame.find(TLV_AZIMUTH_HEAT_MAP_MAGNITUDE);
+    AzimuthHeatMap mag;
+    const bool haveMag = (magTlv != nullptr) && (mag.parse(magTlv->payload, magTlv->length) == 0);
+
+    if (m_recordLen == 0U)
+    {
+        uint32_t numRangeBins = 0;
+        if ((iqLen != 0U) && ((iqLen % ((size_t)m_cfg.numVirtualAnt * 4U)) == 0U))
+        {
+            numRangeBins = (uint32_t)(iqLen / ((size_t)m_cfg.numVirtualAnt * 4U));
+        }
+        else if ((m_cfg.kind == MQTT_PAYLOAD_AZIMUTH_MAGNITUDE) && haveMag)
+        {
+            numRangeBins = mag.numRangeBins();
+        }
+        if (setGeometry(numRangeBins) < 0)
+        {
+            return -1;
+        }
+    }
+
+    const size_t dataLen = m_recordLen - sizeof(MqttFrameRecord);
+    const uint8_t *data = nullptr;
+    if (m_cfg.kind == MQTT_PAYLOAD_AZIMUTH_IQ)
+    {
+        if (iqLen != dataLen)
+        {
+            return -1;
+        }
+        data = frame.azimuthStatic.bytes();
+    }
+    else if (haveMag && (mag.numRangeBins() == m_cfg.numRangeBins) &&
+             (mag.numAngleBins() == m_cfg.numAngleBins) && (mag.format() == m_cfg.format))
+    {
+        data = magTlv->payload + sizeof(MmwDemo_azimuthHeatMapHdr);
+    }
+    else
+    {
+        if ((iqLen != (size_t)m_cfg.numRangeBins * m_cfg.numVirtualAnt * 4U) ||
+            (computeAzimuthHeatMap(frame.azimuthStatic.bytes(), m_cfg.numRangeBins, m_cfg.numVirtualAnt,
+                                   m_cfg.numAngleBins, m_cfg.format, m_magnitude.data(), m_magnitude.size()) < 0))
+        {
+            return -1;
+        }
+        data = m_magnitude.data() + sizeof(MmwDemo_azimuthHeatMapHdr);
+    }
+    if (m_numFrames >= 0xFFFFU)
+    {
+        return -1;
+    }
+
+    MqttFrameRecord rec;
+    rec.frameNumber = frame.header.frameNumber;
+    rec.timeCpuCycles = frame.header.timeCpuCycles;
+    rec.hostNs = hostNs;
+    rec.numDetectedObj = frame.header.numDetectedObj;
+    rec.reserved = 0;
+
+    const size_t at = m_buf.size();
+    m_buf.resize(at + m_recordLen);
+    std::memcpy(&m_buf[at], &rec, sizeof(rec));
+    std::memcpy(&m_buf[at + sizeof(rec)], data, dataLen);
+    m_numFrames++;
+
+    MqttPayloadHeader hdr;
+    std::memcpy(hdr.magic, MQTT_PAYLOAD_MAGIC, sizeof(hdr.magic));
+    hdr.version = MQTT_PAYLOAD_VERSION;
+    hdr.kind = m_cfg.kind;
+    hdr.headerLen = sizeof(MqttPayloadHeader);
+    hdr.numFrames = (uint16_t)m_numFrames;
+    hdr.numRangeBins = (uint16_t)m_cfg.numRangeBins;
+    hdr.numVirtualAnt = (uint16_t)m_cfg.numVirtualAnt;
+    hdr.numAngleBins = (m_cfg.kind == MQTT_PAYLOAD_AZIMUTH_IQ) ? 0U : (uint16_t)m_cfg.numAngleBins;
+    hdr.recordLen = m_recordLen;
+    hdr.cfgCrc = m_cfg.cfgCrc;
+    hdr.framePeriodUs = m_cfg.framePeriodUs;
+    hdr.format = (m_cfg.kind == MQTT_PAYLOAD_AZIMUTH_IQ) ? 0U : m_cfg.format;
+    std::memset(hdr.reserved, 0, sizeof(hdr.reserved));
+    std::memcpy(m_buf.data(), &hdr, sizeof(hdr));
+    return 0;
+}
+
+} /* namespace mmw */
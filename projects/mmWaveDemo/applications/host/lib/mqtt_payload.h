@@ -0,0 +1,156 @@
+/**
+ *   @file  mqtt_payload.h
+ *
+ *   @brief
+ *      Binary MQTT payload of azimuth heat maps, one or more frames per
+ *      message.
+ *
+ *      Layout, little endian:
+ *
+ *          MqttPayloadHeader
+ *          numFrames x (MqttFrameRecord, recordLen - sizeof(MqttFrameRecord) bytes of data)
+ *
+ *      MQTT_PAYLOAD_AZIMUTH_IQ data is the static azimuth heat map as the
+ *      device sends it: numRangeBins x numVirtualAnt int16 imag/real pairs.
+ *      MQTT_PAYLOAD_AZIMUTH_MAGNITUDE data is numRangeBins x numAngleBins
+ *      values of the angle spectrum, see mmw_azimuth_heatmap.h for format.
+ *      The .cfg text itself goes retained to <topic>/cfg, the header only
+ *      carries its CRC-32 and the geometry needed to read the data.
+ */
+#ifndef MQTT_PAYLOAD_H
+#define MQTT_PAYLOAD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mmw_azimuth_heatmap.h"
+#include "tlv_parser.h"
+
+namespace mmw
+{
+
+static const char MQTT_PAYLOAD_MAGIC[4] = { 'M', 'M', 'W', 'Q' };
+
+/*! @brief   Format version of MqttPayloadHeader */
+static const uint8_t MQTT_PAYLOAD_VERSION = 1;
+
+/**
+ * @brief
+ *  What the frame data is
+ */
+enum MqttPayloadKind : uint8_t
+{
+    MQTT_PAYLOAD_AZIMUTH_IQ = 1,
+    MQTT_PAYLOAD_AZIMUTH_MAGNITUDE = 2
+};
+
+/**
+ * @brief
+ *  Start of every message
+ */
+struct MqttPayloadHeader
+{
+    char        magic[4];
+    uint8_t     version;
+
+    /*! @brief   MqttPayloadKind */
+    uint8_t     kind;
+    uint16_t    headerLen;
+
+    uint16_t    numFrames;
+    uint16_t    numRangeBins;
+    uint16_t    numVirtualAnt;
+
+    /*! @brief   0 for MQTT_PAYLOAD_AZIMUTH_IQ */
+    uint16_t    numAngleBins;
+
+    /*! @brief   Bytes per frame, record and data */
+    uint32_t    recordLen;
+
+    /*! @brief   CRC-32 of the .cfg text, 0 if unknown */
+    uint32_t    cfgCrc;
+    uint32_t    framePeriodUs;
+
+    /*! @brief   MMW_AZIMUTH_HEATMAP_FORMAT_xxx of a magnitude map */
+    uint8_t     format;
+    uint8_t     reserved[3];
+};
+
+/**
+ * @brief
+ *  Frame metadata in front of its data
+ */
+struct MqttFrameRecord
+{
+    uint32_t    frameNumber;
+    uint32_t    timeCpuCycles;
+
+    /*! @brief   CLOCK_MONOTONIC of the publisher when the packet came in */
+    uint64_t    hostNs;
+    uint32_t    numDetectedObj;
+    uint32_t    reserved;
+};
+
+static_assert(sizeof(MqttPayloadHeader) == 32, "MqttPayloadHeader layout");
+static_assert(sizeof(MqttFrameRecord) == 24, "MqttFrameRecord layout");
+
+/**
+ * @brief
+ *  Payload configuration
+ */
+struct MqttPayloadConfig
+{
+    MqttPayloadKind kind = MQTT_PAYLOAD_AZIMUTH_IQ;
+
+    /*! @brief   Azimuth virtual antennas, Rx times azimuth Tx */
+    uint32_t    numVirtualAnt = 8;
+
+    /*! @brief   0 takes it from the length of the first heat map */
+    uint32_t    numRangeBins = 0;
+
+    /*! @brief   Magnitude map only */
+    uint32_t    numAngleBins = MMW_AZIMUTH_HEATMAP_DEFAULT_BINS;
+    uint8_t     format = MMW_AZIMUTH_HEATMAP_FORMAT_U16;
+
+    uint32_t    framePeriodUs = 0;
+    uint32_t    cfgCrc = 0;
+
+    int fromCfg(const std::string &cfgText);
+};
+
+/**
+ * @brief
+ *  Builds messages of one or more frames
+ *
+ * @details
+ *  add() appends a frame to the message being built; data() and size()
+ *  give the whole message, header updated. reset() starts the next one,
+ *  the buffer is reused.
+ */
+class MqttPayloadEncoder
+{
+public:
+    int init(const MqttPayloadConfig &cfg);
+    int add(const FrameView &frame, uint64_t hostNs);
+    void reset();
+
+    size_t numFrames() const        { return m_numFrames; }
+    const uint8_t *data() const     { return m_buf.data(); }
+    size_t size() const             { return m_buf.size(); }
+    uint32_t recordLen() const      { return m_recordLen; }
+
+private:
+    int setGeometry(uint32_t numRangeBins);
+
+    MqttPayloadConfig       m_cfg;
+    uint32_t                m_recordLen = 0;
+    size_t                  m_numFrames = 0;
+    std::vector<uint8_t>    m_buf;
+    std::vector<uint8_t>    m_magnitude;
+};
+
+} /* namespace mmw */
+
+#endif /* MQTT_PAYLOAD_H */
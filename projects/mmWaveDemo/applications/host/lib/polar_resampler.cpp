@@ -0,0 +1,350 @@
+/**
+ *   @file  polar_resampler.cpp
+ *
+ *   @brief
+ *      Polar to Cartesian resampler, see polar_resampler.h.
+ */
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "azimuth_heatmap.h"
+#include "polar_resampler.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+/* Below this a thread costs more to wake than it saves */
+const size_t MIN_PIXELS_PER_THREAD = 16384;
+
+const size_t MAX_PIXELS = 64U << 20;
+
+/* Columns searched either side of a pixel's angle for its nearest bin */
+const int NEAREST_SEARCH = 3;
+
+void gatherScalar(const float *in, const int32_t *idx, float *out, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = in[idx[i]];
+    }
+}
+
+void bilinearScalar(const float *in, int32_t stride, const int32_t *idx, const float *const *w, float *out,
+                    size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        const float *p = in + idx[i];
+        out[i] = w[0][i] * p[0] + w[1][i] * p[1] + w[2][i] * p[stride] + w[3][i] * p[stride + 1];
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("avx2")))
+void gatherAvx2(const float *in, const int32_t *idx, float *out, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 8U <= n; i += 8U)
+    {
+        const __m256i k = _mm256_loadu_si256((const __m256i *)(idx + i));
+        _mm256_storeu_ps(out + i, _mm256_i32gather_ps(in, k, 4));
+    }
+    gatherScalar(in, idx + i, out + i, n - i);
+}
+
+__attribute__((target("avx2,fma")))
+void bilinearAvx2(const float *in, int32_t stride, const int32_t *idx, const float *const *w, float *out,
+                  size_t n)
+{
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i up = _mm256_set1_epi32(stride);
+    size_t i = 0;
+
+    for (; i + 8U <= n; i += 8U)
+    {
+        const __m256i k = _mm256_loadu_si256((const __m256i *)(idx + i));
+        const __m256i ku = _mm256_add_epi32(k, up);
+        const __m256 v0 = _mm256_i32gather_ps(in, k, 4);
+        const __m256 v1 = _mm256_i32gather_ps(in, _mm256_add_epi32(k, one), 4);
+        const __m256 v2 = _mm256_i32gather_ps(in, ku, 4);
+        const __m256 v3 = _mm256_i32gather_ps(in, _mm256_add_epi32(ku, one), 4);
+        __m256 acc = _mm256_mul_ps(_mm256_loadu_ps(w[0] + i), v0);
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(w[1] + i), v1, acc);
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(w[2] + i), v2, acc);
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(w[3] + i), v3, acc);
+        _mm256_storeu_ps(out + i, acc);
+    }
+    const float *const tail[4] = { w[0] + i, w[1] + i, w[2] + i, w[3] + i };
+    bilinearScalar(in, stride, idx + i, tail, out + i, n - i);
+}
+
+using GatherFn = void (*)(const float *, const int32_t *, float *, size_t);
+using BilinearFn = void (*)(const float *, int32_t, const int32_t *, const float *const *, float *, size_t);
+
+bool haveAvx2()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+
+const bool gAvx2 = haveAvx2();
+const GatherFn gGather = gAvx2 ? gatherAvx2 : gatherScalar;
+const BilinearFn gBilinear = gAvx2 ? bilinearAvx2 : bilinearScalar;
+
+#else
+
+/* Without gathers the scalar loops are as good as it gets */
+void (*const gGather)(const float *, const int32_t *, float *, size_t) = gatherScalar;
+void (*const gBilinear)(const float *, int32_t, const int32_t *, const float *const *, float *, size_t) =
+    bilinearScalar;
+
+#endif
+
+/* Pixel centres as numpy.linspace() puts them */
+double linspace(float lo, float hi, uint32_t n, uint32_t i)
+{
+    return (n > 1U) ? lo + ((double)hi - lo) * i / (n - 1U) : lo;
+}
+
+} /* anonymous namespace */
+
+PolarResampler::~PolarResampler()
+{
+    stopWorkers();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Builds the mapping of a geometry and starts the worker threads.
+ *      About a millisecond for a 100 x 100 image, 150 ms for 1024 x 1024.
+ *
+ *  @param[in]  cfg
+ *      Heat map geometry and image
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, bad geometry
+ */
+int PolarResampler::configure(const PolarResamplerConfig &cfg)
+{
+    stopWorkers();
+    m_index.clear();
+    for (std::vector<float> &w : m_weight)
+    {
+        w.clear();
+    }
+
+    const size_t cells = (size_t)cfg.numRangeBins * cfg.numAngleBins;
+    const size_t pixels = (size_t)cfg.width * cfg.height;
+    if ((cfg.numRangeBins < 2U) || (cfg.numAngleBins < 4U) || (cells > (size_t)INT32_MAX) ||
+        !(cfg.rangeIdxToMeters > 0.0f) || (pixels == 0U) || (pixels > MAX_PIXELS))
+    {
+        return -1;
+    }
+    m_cfg = cfg;
+
+    const int numRange = (int)cfg.numRangeBins;
+    const int numAngle = (int)cfg.numAngleBins;
+    const double res = cfg.rangeIdxToMeters;
+    const double side = cfg.mirrorX ? -1.0 : 1.0;
+
+    /* Unit direction of every column, in the image's x */
+    std::vector<double> dirX((size_t)numAngle);
+    std::vector<double> dirY((size_t)numAngle);
+    for (int a = 0; a < numAngle; a++)
+    {
+        const double s = side * AzimuthHeatMap::sinAngle((uint32_t)a, cfg.numAngleBins);
+        dirX[(size_t)a] = s;
+        dirY[(size_t)a] = std::sqrt(std::max(0.0, 1.0 - s * s));
+    }
+
+    m_index.resize(pixels);
+    if (cfg.interp == PolarInterp::BILINEAR)
+    {
+        for (std::vector<float> &w : m_weight)
+        {
+            w.resize(pixels);
+        }
+    }
+
+    for (uint32_t row = 0; row < cfg.height; row++)
+    {
+        const double y = linspace(cfg.yMin, cfg.yMax, cfg.height, row);
+        for (uint32_t col = 0; col < cfg.width; col++)
+        {
+            const double x = linspace(cfg.xMin, cfg.xMax, cfg.width, col);
+            const size_t p = (size_t)row * cfg.width + col;
+            const double r = std::hypot(x, y);
+            const double s = (r > 0.0) ? side * x / r : 0.0;
+            const double fa = std::min(std::max(s * numAngle / 2 + numAngle / 2, 1.0), (double)(numAngle - 1));
+
+            if (cfg.interp == PolarInterp::NEAREST)
+            {
+                /*
+                 * The nearest bin of a column lies at the projection of the
+                 * pixel on its ray; the nearest column is one of those
+                 * around the pixel's angle, or the edge of the fan.
+                 */
+                const int a0 = (int)std::lround(fa);
+                const int aLast = std::min(a0 + NEAREST_SEARCH, numAngle - 1);
+                double best = INFINITY;
+                int32_t bestIdx = 0;
+                for (int a = std::max(a0 - NEAREST_SEARCH, 1); a <= aLast; a++)
+                {
+                    const double t = x * dirX[(size_t)a] + y * dirY[(size_t)a];
+                    const int ri = (int)std::min(std::max(std::lround(t / res), 0L), (long)(numRange - 1));
+                    const double dx = x - ri * res * dirX[(size_t)a];
+                    const double dy = y - ri * res * dirY[(size_t)a];
+                    const double d = dx * dx + dy * dy;
+                    if (d < best)
+                    {
+                        best = d;
+                        bestIdx = (int32_t)(ri * numAngle + a);
+                    }
+                }
+                m_index[p] = bestIdx;
+            }
+            else
+            {
+                const double fr = std::min(r / res, (double)(numRange - 1));
+                const int r0 = std::min((int)fr, numRange - 2);
+                const int a0 = std::min((int)fa, numAngle - 2);
+                const float tr = (float)(fr - r0);
+                const float ta = (float)(fa - a0);
+                m_index[p] = (int32_t)(r0 * numAngle + a0);
+                m_weight[0][p] = (1.0f - tr) * (1.0f - ta);
+                m_weight[1][p] = (1.0f - tr) * ta;
+                m_weight[2][p] = tr * (1.0f - ta);
+                m_weight[3][p] = tr * ta;
+            }
+        }
+    }
+
+    uint32_t n = (cfg.numThreads != 0U) ? cfg.numThreads : std::max(std::thread::hardware_concurrency(), 1U);
+    n = (uint32_t)std::min<size_t>({ (size_t)n, std::max<size_t>(pixels / MIN_PIXELS_PER_THREAD, 1U),
+                                     (size_t)cfg.height });
+    m_stop = false;
+    for (uint32_t part = 1; part < n; part++)
+    {
+        m_workers.emplace_back(&PolarResampler::workerLoop, this, part);
+    }
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Resamples one heat map.
+ *
+ *  @param[in]  in
+ *      Linear magnitudes, numRangeBins rows of numAngleBins, e.g. from
+ *      AzimuthHeatMap::decode()
+ *  @param[in]  inCount
+ *      Values at in, at least numCells()
+ *  @param[out] out
+ *      Image, height rows of width pixels
+ *  @param[in]  outCount
+ *      Room at out, at least numPixels()
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, not configured or buffers too small
+ */
+int PolarResampler::resample(const float *in, size_t inCount, float *out, size_t outCount)
+{
+    if (m_index.empty() || (inCount < numCells()) || (outCount < numPixels()))
+    {
+        return -1;
+    }
+    m_in = in;
+    m_out = out;
+    if (m_workers.empty())
+    {
+        run(0);
+        return 0;
+    }
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_pending = (uint32_t)m_workers.size();
+        m_generation++;
+    }
+    m_start.notify_all();
+    run(0);
+    std::unique_lock<std::mutex> lk(m_lock);
+    m_done.wait(lk, [this] { return m_pending == 0U; });
+    return 0;
+}
+
+/* One band of rows of the current frame */
+void PolarResampler::run(uint32_t part)
+{
+    const uint32_t n = numThreads();
+    const size_t first = (size_t)(m_cfg.height * (uint64_t)part / n) * m_cfg.width;
+    const size_t last = (size_t)(m_cfg.height * (uint64_t)(part + 1U) / n) * m_cfg.width;
+
+    if (m_cfg.interp == PolarInterp::NEAREST)
+    {
+        gGather(m_in, &m_index[first], m_out + first, last - first);
+    }
+    else
+    {
+        const float *const w[4] = { &m_weight[0][first], &m_weight[1][first], &m_weight[2][first],
+                                    &m_weight[3][first] };
+        gBilinear(m_in, (int32_t)m_cfg.numAngleBins, &m_index[first], w, m_out + first, last - first);
+    }
+}
+
+void PolarResampler::workerLoop(uint32_t part)
+{
+    uint64_t seen = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lk(m_lock);
+            m_start.wait(lk, [&] { return m_stop || (m_generation != seen); });
+            if (m_stop)
+            {
+                return;
+            }
+            seen = m_generation;
+        }
+        run(part);
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (--m_pending == 0U)
+            {
+                m_done.notify_one();
+            }
+        }
+    }
+}
+
+void PolarResampler::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stop = true;
+    }
+    m_start.notify_all();
+    for (std::thread &t : m_workers)
+    {
+        t.join();
+    }
+    m_workers.clear();
+    m_generation = 0;
+}
+
+} /* namespace mmw */
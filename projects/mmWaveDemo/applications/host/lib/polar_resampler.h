@@ -0,0 +1,124 @@
+/**
+ *   @file  polar_resampler.h
+ *
+ *   @brief
+ *      Resampling of range/azimuth heat maps onto a Cartesian image
+ *      through a mapping precomputed once per configuration.
+ */
+#ifndef POLAR_RESAMPLER_H
+#define POLAR_RESAMPLER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mmw
+{
+
+enum class PolarInterp
+{
+    /*! @brief   Value of the nearest bin in the plane, as griddata 'nearest' */
+    NEAREST,
+
+    /*! @brief   Bilinear in range and sin(theta) over the four bins around */
+    BILINEAR
+};
+
+/**
+ * @brief
+ *  Heat map geometry and output image
+ */
+struct PolarResamplerConfig
+{
+    /*! @brief   Heat map rows */
+    uint32_t        numRangeBins = 256;
+
+    /*! @brief   Heat map columns, FFT shifted: column k is at sin(theta)
+     *           = 2 (k - numAngleBins/2) / numAngleBins, see
+     *           AzimuthHeatMap::sinAngle(). Column 0 is +-90 degrees at once
+     *           and is left out, as the scripts always did. */
+    uint32_t        numAngleBins = 64;
+
+    float           rangeIdxToMeters = 0.047392004f;
+
+    /*! @brief   x = -r sin(theta), the way rangeAzim.py and mqttread.py
+     *           have always drawn the map */
+    bool            mirrorX = true;
+
+    /*! @brief   Image of width x height pixels, row major from yMin, pixel
+     *           centres spread over [xMin, xMax] and [yMin, yMax] as
+     *           numpy.linspace() does */
+    uint32_t        width = 100;
+    uint32_t        height = 100;
+    float           xMin = -5.0f;
+    float           xMax = 5.0f;
+    float           yMin = 0.0f;
+    float           yMax = 5.0f;
+
+    PolarInterp     interp = PolarInterp::NEAREST;
+
+    /*! @brief   Threads per image, 0 for one per core; a small image is
+     *           done by fewer */
+    uint32_t        numThreads = 0;
+};
+
+/**
+ * @brief
+ *  Polar to Cartesian resampler
+ *
+ * @details
+ *  configure() works out, for every pixel, which heat map cells it reads
+ *  and with what weights. resample() is then a gather and, for BILINEAR,
+ *  a multiply-add of four cells per pixel, eight pixels at a time with
+ *  AVX2 gathers where the CPU has them. Images large enough are split
+ *  into row bands over worker threads which wait between frames.
+ *  resample() may be called from one thread at a time.
+ */
+class PolarResampler
+{
+public:
+    PolarResampler() = default;
+    ~PolarResampler();
+
+    PolarResampler(const PolarResampler &) = delete;
+    PolarResampler &operator=(const PolarResampler &) = delete;
+
+    int configure(const PolarResamplerConfig &cfg);
+    int resample(const float *in, size_t inCount, float *out, size_t outCount);
+
+    const PolarResamplerConfig &config() const  { return m_cfg; }
+    size_t   numPixels() const          { return m_index.size(); }
+    size_t   numCells() const           { return (size_t)m_cfg.numRangeBins * m_cfg.numAngleBins; }
+    uint32_t numThreads() const         { return (uint32_t)m_workers.size() + 1U; }
+
+private:
+    void run(uint32_t part);
+    void workerLoop(uint32_t part);
+    void stopWorkers();
+
+    PolarResamplerConfig    m_cfg;
+
+    /* Per pixel: the cell read (NEAREST), or the lower left of the four
+     * with their weights (BILINEAR) */
+    std::vector<int32_t>    m_index;
+    std::vector<float>      m_weight[4];
+
+    /* Frame handed to the workers */
+    const float             *m_in = nullptr;
+    float                   *m_out = nullptr;
+
+    std::vector<std::thread> m_workers;
+    std::mutex              m_lock;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    uint64_t                m_generation = 0;
+    uint32_t                m_pending = 0;
+    bool                    m_stop = false;
+};
+
+} /* namespace mmw */
+
+#endif /* POLAR_RESAMPLER_H */
@@ -0,0 +1,158 @@
+/**
+ *   @file  profile_delta.cpp
+ *
+ *   @brief
+ *      Delta coded profile decoder, see board/common/mmw_profile_delta.h
+ *      for the format.
+ */
+#include <cstring>
+
+#include "profile_delta.h"
+
+namespace mmw
+{
+
+/**
+ *  @b Description
+ *  @n
+ *      Forgets the profile held, e.g. when the device restarted.
+ */
+void ProfileDeltaDecoder::reset()
+{
+    m_valid = false;
+    m_keyframe = false;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Applies the tokens of a delta payload to the profile held, into
+ *      m_next.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, a token is cut off, too long, leaves the uint16_t
+ *                  range or the tokens do not cover the profile exactly
+ */
+int ProfileDeltaDecoder::decodeTokens(const uint8_t *p, const uint8_t *end)
+{
+    const size_t n = m_profile.size();
+    size_t idx = 0;
+
+    while (p < end)
+    {
+        uint32_t token = 0;
+        uint32_t shift = 0;
+        uint8_t  b;
+        do
+        {
+            if ((p == end) || (shift > 21U))
+            {
+                return -1;
+            }
+            b = *p++;
+            token |= (uint32_t)(b & 0x7FU) << shift;
+            shift += 7U;
+        } while ((b & 0x80U) != 0U);
+
+        if ((token & 1U) != 0U)
+        {
+            const size_t run = (size_t)(token >> 1) + 1U;
+            if (run > n - idx)
+            {
+                return -1;
+            }
+            std::memcpy(&m_next[idx], &m_profile[idx], run * sizeof(uint16_t));
+            idx += run;
+            continue;
+        }
+
+        if (idx == n)
+        {
+            return -1;
+        }
+        const uint32_t zigzag = token >> 1;
+        const int32_t  delta = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1U);
+        const int32_t  value = (int32_t)m_profile[idx] + delta;
+        if ((value < 0) || (value > 0xFFFF))
+        {
+            return -1;
+        }
+        m_next[idx++] = (uint16_t)value;
+    }
+    return (idx == n) ? 0 : -1;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Decodes the next payload of the stream.
+ *
+ *  @param[in]  payload
+ *      TLV payload, without the TLV header
+ *  @param[in]  len
+ *      TLV length
+ *
+ *  @retval
+ *      Success -   0, profile() holds the profile of the payload
+ *  @retval
+ *      Error   -   PROFILE_DELTA_NO_REFERENCE, or -1 for a malformed
+ *                  payload
+ */
+int ProfileDeltaDecoder::decode(const uint8_t *payload, size_t len)
+{
+    MmwDemo_profileDeltaHdr hdr;
+
+    if (len < sizeof(hdr))
+    {
+        m_errors++;
+        m_valid = false;
+        return -1;
+    }
+    std::memcpy(&hdr, payload, sizeof(hdr));
+    const uint8_t *body = payload + sizeof(hdr);
+    const size_t   bodyLen = len - sizeof(hdr);
+    const bool     isKeyframe = (hdr.flags & MMW_PROFILE_DELTA_FLAG_KEYFRAME) != 0U;
+
+    if ((hdr.version != MMW_PROFILE_DELTA_VERSION) || (hdr.numRangeBins == 0U) ||
+        (isKeyframe && (bodyLen != (size_t)hdr.numRangeBins * sizeof(uint16_t))))
+    {
+        m_errors++;
+        m_valid = false;
+        return -1;
+    }
+
+    if (isKeyframe)
+    {
+        m_profile.resize(hdr.numRangeBins);
+        std::memcpy(m_profile.data(), body, bodyLen);
+        m_keyframes++;
+    }
+    else
+    {
+        if (!m_valid || (hdr.refSeq != m_seq) || (hdr.numRangeBins != m_profile.size()))
+        {
+            m_noReference++;
+            m_valid = false;
+            return PROFILE_DELTA_NO_REFERENCE;
+        }
+        m_next.resize(hdr.numRangeBins);
+        if (decodeTokens(body, body + bodyLen) < 0)
+        {
+            m_errors++;
+            m_valid = false;
+            return -1;
+        }
+        m_profile.swap(m_next);
+        m_deltas++;
+    }
+
+    m_valid = true;
+    m_keyframe = isKeyframe;
+    m_seq = hdr.seq;
+    m_tolerance = hdr.tolerance;
+    return 0;
+}
+
+} /* namespace mmw */
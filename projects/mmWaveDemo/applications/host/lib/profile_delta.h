@@ -0,0 +1,81 @@
+/**
+ *   @file  profile_delta.h
+ *
+ *   @brief
+ *      Decoder for the delta coded range and noise profile TLVs
+ *      (MMWDEMO_OUTPUT_MSG_RANGE_PROFILE_DELTA,
+ *      MMWDEMO_OUTPUT_MSG_NOISE_PROFILE_DELTA).
+ */
+#ifndef PROFILE_DELTA_H
+#define PROFILE_DELTA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mmw_profile_delta.h"
+
+namespace mmw
+{
+
+/*! @brief   decode() result: the delta refers to a profile this decoder
+ *           did not get, the profile is unknown until the next keyframe */
+static const int PROFILE_DELTA_NO_REFERENCE = -2;
+
+/**
+ * @brief
+ *  Delta coded profile stream
+ *
+ * @details
+ *  One decoder per profile TLV type. decode() takes the payloads in
+ *  arrival order and keeps the reconstructed profile, which the next delta
+ *  refers to. After a lost packet the deltas fail with
+ *  PROFILE_DELTA_NO_REFERENCE until a keyframe arrives; a malformed payload
+ *  also drops the profile. The profile buffers are reused, so a decoder
+ *  kept for a stream allocates only for its first frame.
+ */
+class ProfileDeltaDecoder
+{
+public:
+    int decode(const uint8_t *payload, size_t len);
+    void reset();
+
+    /*! @brief   The last profile decoded, valid() only */
+    const std::vector<uint16_t> &profile() const  { return m_profile; }
+
+    /*! @brief   A profile is held: decode() succeeded since the last error */
+    bool     valid() const          { return m_valid; }
+
+    /*! @brief   Sequence number of profile() */
+    uint16_t seq() const            { return m_seq; }
+
+    /*! @brief   The last payload decoded was a keyframe */
+    bool     keyframe() const       { return m_keyframe; }
+
+    /*! @brief   Tolerance of the last payload decoded, 0 when lossless */
+    uint16_t tolerance() const      { return m_tolerance; }
+
+    uint64_t keyframes() const      { return m_keyframes; }
+    uint64_t deltas() const         { return m_deltas; }
+    uint64_t noReference() const    { return m_noReference; }
+    uint64_t errors() const         { return m_errors; }
+
+private:
+    int decodeTokens(const uint8_t *p, const uint8_t *end);
+
+    std::vector<uint16_t>   m_profile;
+    std::vector<uint16_t>   m_next;
+    bool                    m_valid = false;
+    bool                    m_keyframe = false;
+    uint16_t                m_seq = 0;
+    uint16_t                m_tolerance = 0;
+
+    uint64_t                m_keyframes = 0;
+    uint64_t                m_deltas = 0;
+    uint64_t                m_noReference = 0;
+    uint64_t                m_errors = 0;
+};
+
+} /* namespace mmw */
+
+#endif /* PROFILE_DELTA_H */
@@ -0,0 +1,109 @@
+/**
+ *   @file  quiet_timeline.cpp
+ *
+ *   @brief
+ *      Continuous frame timeline, see quiet_timeline.h.
+ */
+#include "quiet_timeline.h"
+
+namespace mmw
+{
+
+void QuietTimeline::emit(uint32_t frameNumber, TimelineState state, const FrameView *frame)
+{
+    m_counts[state]++;
+    if (m_fn)
+    {
+        const TimelineFrame f = { frameNumber, state, frame };
+        m_fn(f);
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Copies a full frame to stand for the quiet frames after it. The
+ *      copy is parsed again, so the views point into it.
+ */
+void QuietTimeline::keepFull(const FrameView &frame)
+{
+    TlvParserConfig cfg;
+    cfg.sdkMajor = 0;
+    cfg.maxPacketLen = frame.len;
+
+    m_full.assign(frame.data, frame.data + frame.len);
+    m_haveFull = (parseFrame(m_full.data(), m_full.size(), cfg, m_fullView) == PARSE_OK);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Hands out the frames up to a received packet: the gap since the
+ *      previous packet, then the packet itself.
+ *
+ *  @param[in]  frame
+ *      Parsed packet
+ *
+ *  @retval
+ *      Number of frames handed out, 0 for a duplicate
+ */
+uint32_t QuietTimeline::add(const FrameView &frame)
+{
+    const uint32_t fn = frame.header.frameNumber;
+    const FrameView *ref = m_haveFull ? &m_fullView : nullptr;
+    uint32_t numFrames = 0;
+
+    QuietReport report;
+    bool haveReport = false;
+    const TlvRef *quietTlv = frame.find(TLV_QUIET);
+    if ((quietTlv != nullptr) && (quietTlv->length == sizeof(QuietReport)))
+    {
+        report = load<QuietReport>(quietTlv->payload);
+        haveReport = true;
+    }
+
+    const uint32_t ahead = fn - m_lastFrame;
+    if (m_haveFrame && (ahead == 0U))
+    {
+        m_duplicates++;
+        return 0;
+    }
+    if (m_haveFrame && (ahead <= MAX_GAP))
+    {
+        /* Frames after prevFrameNumber were not sent by the DSS, the ones
+         * up to it were sent or are unknown */
+        uint32_t sentUpTo = fn - 1U;
+        uint32_t numQuiet = 0;
+        if (haveReport && ((report.flags & MMWDEMO_OUTPUT_QUIET_FLAG_PREV) != 0U) &&
+            ((fn - report.prevFrameNumber) >= 1U) && ((fn - report.prevFrameNumber) <= ahead))
+        {
+            sentUpTo = report.prevFrameNumber;
+            numQuiet = report.quietFrames;
+        }
+        const uint32_t numUnsent = fn - sentUpTo - 1U;
+        const TimelineState unsent = (numQuiet >= numUnsent) ? TIMELINE_QUIET :
+                                     (numQuiet == 0U) ? TIMELINE_SKIPPED : TIMELINE_QUIET_OR_SKIPPED;
+
+        for (uint32_t n = m_lastFrame + 1U; n != fn; n++)
+        {
+            const bool isUnsent = (n - m_lastFrame) > (sentUpTo - m_lastFrame);
+            emit(n, isUnsent ? unsent : TIMELINE_LOST, ref);
+            numFrames++;
+        }
+    }
+    m_haveFrame = true;
+    m_lastFrame = fn;
+
+    if (haveReport && ((report.flags & MMWDEMO_OUTPUT_QUIET_FLAG_HEARTBEAT) != 0U))
+    {
+        emit(fn, TIMELINE_HEARTBEAT, ref);
+    }
+    else
+    {
+        emit(fn, TIMELINE_FULL, &frame);
+        keepFull(frame);
+    }
+    return numFrames + 1U;
+}
+
+} /* namespace mmw */
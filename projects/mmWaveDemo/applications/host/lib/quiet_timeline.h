@@ -0,0 +1,108 @@
+/**
+ *   @file  quiet_timeline.h
+ *
+ *   @brief
+ *      Continuous frame timeline over the packets of the quiet mode
+ *      (mmw_quiet_mode.h): one entry per frame number, the suppressed
+ *      frames filled in with the last full frame.
+ */
+#ifndef QUIET_TIMELINE_H
+#define QUIET_TIMELINE_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "tlv_parser.h"
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  What became of a frame
+ */
+enum TimelineState : uint32_t
+{
+    TIMELINE_FULL               = 0,    /*!< Received in full */
+    TIMELINE_HEARTBEAT          = 1,    /*!< Received as a heartbeat, nothing new */
+    TIMELINE_QUIET              = 2,    /*!< Suppressed by the DSS, nothing new */
+    TIMELINE_SKIPPED            = 3,    /*!< Not sent by the DSS, the MSS was busy */
+    TIMELINE_QUIET_OR_SKIPPED   = 4,    /*!< Not sent by the DSS; the quiet report
+                                             only counts how many of the frames
+                                             between two packets were quiet */
+    TIMELINE_LOST               = 5,    /*!< Lost after the DSS, or unknown because
+                                             the packet telling was lost */
+    TIMELINE_NUM_STATES         = 6
+};
+
+/**
+ * @brief
+ *  One frame of the timeline
+ */
+struct TimelineFrame
+{
+    uint32_t        frameNumber;
+    TimelineState   state;
+
+    /*! @brief   The packet for TIMELINE_FULL; for the others the last full
+     *           frame received (its data stands for a quiet frame, whose
+     *           range profile is within the threshold of it), nullptr
+     *           before the first. Valid during the callback only. */
+    const FrameView *frame;
+};
+
+/**
+ * @brief
+ *  Timeline reconstruction
+ *
+ * @details
+ *  add() takes the packets in arrival order and hands out the frames from
+ *  the one after the previous packet up to the packet's own, in order.
+ *  The quiet report of the packet tells which packet the DSS sent before
+ *  and how many frames since were quiet; frames up to that previous packet
+ *  which were not received are lost. Without a quiet report (quiet mode
+ *  off) every gap is lost. The last full frame is kept as a copy.
+ */
+class QuietTimeline
+{
+public:
+    using FrameFn = std::function<void(const TimelineFrame &frame)>;
+
+    /*! @brief   A frame number further ahead than this, or going back, is
+     *           a restart rather than a gap */
+    static const uint32_t MAX_GAP = 100000;
+
+    explicit QuietTimeline(FrameFn fn) : m_fn(std::move(fn)) {}
+
+    QuietTimeline(const QuietTimeline &) = delete;
+    QuietTimeline &operator=(const QuietTimeline &) = delete;
+
+    uint32_t add(const FrameView &frame);
+
+    /*! @brief   Frames handed out in a state */
+    uint64_t count(TimelineState s) const   { return m_counts[s]; }
+
+    /*! @brief   Packets repeating the last frame number, ignored */
+    uint64_t duplicates() const             { return m_duplicates; }
+
+private:
+    void emit(uint32_t frameNumber, TimelineState state, const FrameView *frame);
+    void keepFull(const FrameView &frame);
+
+    FrameFn                 m_fn;
+    bool                    m_haveFrame = false;
+    uint32_t                m_lastFrame = 0;
+
+    /* Last full frame */
+    std::vector<uint8_t>    m_full;
+    FrameView               m_fullView;
+    bool                    m_haveFull = false;
+
+    uint64_t                m_counts[TIMELINE_NUM_STATES] = {};
+    uint64_t                m_duplicates = 0;
+};
+
+} /* namespace mmw */
+
+#endif /* QUIET_TIMELINE_H */
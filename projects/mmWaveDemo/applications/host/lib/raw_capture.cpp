@@ -0,0 +1,74 @@
+/**
+ *   @file  raw_capture.cpp
+ *
+ *   @brief
+ *      Raw UART capture loader.
+ */
+#include <cstdio>
+#include <cstring>
+
+#include "mmw_wire.h"
+#include "raw_capture.h"
+#include "tlv_parser.h"
+
+namespace mmw
+{
+
+/**
+ *  @b Description
+ *  @n
+ *      Reads a capture and finds its packets by the magic word and
+ *      totalPacketLen; bytes outside packets are ignored.
+ *
+ *  @param[in]  path
+ *      Capture file
+ *
+ *  @retval
+ *      Success -   0, at least one packet found
+ *  @retval
+ *      Error   -   <0
+ */
+int RawCapture::load(const char *path)
+{
+    m_data.clear();
+    m_packets.clear();
+
+    FILE *fp = fopen(path, "rb");
+    if (fp == nullptr)
+    {
+        return -1;
+    }
+    uint8_t buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+    {
+        m_data.insert(m_data.end(), buf, buf + n);
+    }
+    fclose(fp);
+
+    size_t pos = 0;
+    while (pos + sizeof(MsgHeader) <= m_data.size())
+    {
+        const uint8_t *hit = findMagic(&m_data[pos], m_data.size() - pos);
+        if (hit == nullptr)
+        {
+            break;
+        }
+        pos = (size_t)(hit - m_data.data());
+        if (pos + sizeof(MsgHeader) > m_data.size())
+        {
+            break;
+        }
+        const uint32_t len = mmw::load<MsgHeader>(hit).totalPacketLen;
+        if ((len < sizeof(MsgHeader)) || (pos + len > m_data.size()))
+        {
+            pos++;
+            continue;
+        }
+        m_packets.push_back({ pos, len });
+        pos += len;
+    }
+    return m_packets.empty() ? -1 : 0;
+}
+
+} /* namespace mmw */
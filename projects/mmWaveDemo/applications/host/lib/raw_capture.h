@@ -0,0 +1,48 @@
+/**
+ *   @file  raw_capture.h
+ *
+ *   @brief
+ *      Recording of the UART data port: the output packets back to back,
+ *      exactly as read from the port, possibly with garbage in between.
+ */
+#ifndef RAW_CAPTURE_H
+#define RAW_CAPTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  Raw capture loaded into memory and split into output packets
+ */
+class RawCapture
+{
+public:
+    /**
+     * @brief
+     *  Packet inside data()
+     */
+    struct Packet
+    {
+        size_t      offset;
+        uint32_t    len;
+    };
+
+    int load(const char *path);
+
+    const std::vector<uint8_t> &data() const    { return m_data; }
+    const std::vector<Packet> &packets() const  { return m_packets; }
+    const uint8_t *packet(size_t i) const       { return m_data.data() + m_packets[i].offset; }
+
+private:
+    std::vector<uint8_t>    m_data;
+    std::vector<Packet>     m_packets;
+};
+
+} /* namespace mmw */
+
+#endif /* RAW_CAPTURE_H */
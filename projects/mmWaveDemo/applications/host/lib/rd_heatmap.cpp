@@ -0,0 +1,246 @@
+/**
+ *   @file  rd_heatmap.cpp
+ *
+ *   @brief
+ *      Compressed range/Doppler heat map decoder, see
+ *      board/common/mmw_heatmap_codec.h for the format.
+ */
+#include <cstring>
+
+#include "rd_heatmap.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+/**
+ * @brief
+ *  LSB first bit reader over one coded line
+ */
+class BitReader
+{
+public:
+    BitReader(const uint8_t *p, const uint8_t *end) : m_ptr(p), m_end(end) {}
+
+    /* Tops the accumulator up to at least 57 bits while input is left */
+    void refill()
+    {
+        while ((m_numBits <= 56U) && (m_ptr < m_end))
+        {
+            m_acc |= (uint64_t)*m_ptr++ << m_numBits;
+            m_numBits += 8U;
+        }
+    }
+
+    uint64_t peek() const          { return m_acc; }
+    uint32_t available() const     { return m_numBits; }
+
+    void skip(uint32_t n)
+    {
+        m_acc >>= n;
+        m_numBits -= n;
+        m_consumed += n;
+    }
+
+    /* Bytes of the line consumed so far, lines are byte aligned */
+    size_t consumedBytes() const   { return (m_consumed + 7U) >> 3; }
+
+private:
+    const uint8_t   *m_ptr;
+    const uint8_t   *m_end;
+    uint64_t        m_acc = 0;
+    uint32_t        m_numBits = 0;
+    size_t          m_consumed = 0;
+};
+
+/**
+ *  @b Description
+ *  @n
+ *      Walks the coded lines and hands every quantized value to emit(cell, q, shift).
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, the payload is truncated or corrupt
+ */
+template <typename Emit>
+int walkLines(const uint8_t *payload, size_t len, const MmwDemo_rdHeatMapCodecHdr &hdr, Emit emit)
+{
+    const uint8_t   *p = payload + sizeof(MmwDemo_rdHeatMapCodecHdr);
+    const uint8_t   *end = payload + len;
+    const uint32_t  n = hdr.numDopplerBins;
+    size_t          cell = 0;
+
+    for (uint32_t line = 0; line < hdr.numRangeBins; line++)
+    {
+        if (p >= end)
+        {
+            return -1;
+        }
+        const uint32_t k = *p & 0xFU;
+        const uint32_t shift = *p >> 4;
+        p++;
+
+        if (k == MMW_HEATMAP_CODEC_RAW_LINE)
+        {
+            if ((size_t)(end - p) < n)
+            {
+                return -1;
+            }
+            for (uint32_t i = 0; i < n; i++)
+            {
+                emit(cell++, p[i], shift);
+            }
+            p += n;
+            continue;
+        }
+        if (k > MMW_HEATMAP_CODEC_MAX_K)
+        {
+            return -1;
+        }
+
+        BitReader br(p, end);
+        const uint64_t kMask = (1ULL << k) - 1U;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            br.refill();
+            /* The escape is the longest code word, 16 bits */
+            const uint64_t inv = ~br.peek();
+            const uint32_t ones = (inv != 0U) ? (uint32_t)__builtin_ctzll(inv) : 64U;
+            uint32_t q;
+            if (ones >= MMW_HEATMAP_CODEC_ESC)
+            {
+                if (br.available() < MMW_HEATMAP_CODEC_ESC + 8U)
+                {
+                    return -1;
+                }
+                br.skip(MMW_HEATMAP_CODEC_ESC);
+                q = (uint32_t)(br.peek() & 0xFFU);
+                br.skip(8U);
+            }
+            else
+            {
+                if (br.available() < ones + 1U + k)
+                {
+                    return -1;
+                }
+                br.skip(ones + 1U);
+                q = (ones << k) | (uint32_t)(br.peek() & kMask);
+                br.skip(k);
+                if (q > 255U)
+                {
+                    return -1;
+                }
+            }
+            emit(cell++, (uint8_t)q, shift);
+        }
+        p += br.consumedBytes();
+    }
+    return 0;
+}
+
+} /* anonymous namespace */
+
+/**
+ *  @b Description
+ *  @n
+ *      Validates the codec header of a compressed heat map payload.
+ *
+ *  @param[in]  payload
+ *      TLV payload, without the TLV header
+ *  @param[in]  len
+ *      TLV length
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int RdHeatMapDecoder::parse(const uint8_t *payload, size_t len)
+{
+    m_payload = nullptr;
+    m_len = 0;
+    if (len < sizeof(MmwDemo_rdHeatMapCodecHdr))
+    {
+        return -1;
+    }
+    std::memcpy(&m_hdr, payload, sizeof(m_hdr));
+    if ((m_hdr.version != MMW_HEATMAP_CODEC_VERSION) || (m_hdr.numDopplerBins == 0U))
+    {
+        return -1;
+    }
+    m_payload = payload;
+    m_len = len;
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Decodes the heat map into reconstructed values,
+ *      noiseFloor + (q << shift), saturated to 16 bits.
+ *
+ *  @param[out] out
+ *      numCells() values
+ *  @param[in]  outCount
+ *      Number of values out can hold
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int RdHeatMapDecoder::decode(uint16_t *out, size_t outCount) const
+{
+    if ((m_payload == nullptr) || (outCount < numCells()))
+    {
+        return -1;
+    }
+    const uint32_t noiseFloor = m_hdr.noiseFloor;
+    return walkLines(m_payload, m_len, m_hdr,
+                     [out, noiseFloor](size_t cell, uint8_t q, uint32_t shift)
+                     {
+                         uint32_t v = noiseFloor + ((uint32_t)q << shift);
+                         out[cell] = (uint16_t)((v > 0xFFFFU) ? 0xFFFFU : v);
+                     });
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Decodes the heat map without reconstruction, which is all a display
+ *      needs when it maps the values to a colour scale anyway.
+ *
+ *  @param[out] q
+ *      numCells() quantized values
+ *  @param[out] shift
+ *      numRangeBins() line shifts, may be nullptr
+ *  @param[in]  outCount
+ *      Number of values q can hold
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int RdHeatMapDecoder::decodeQuantized(uint8_t *q, uint8_t *shift, size_t outCount) const
+{
+    if ((m_payload == nullptr) || (outCount < numCells()))
+    {
+        return -1;
+    }
+    const uint32_t n = m_hdr.numDopplerBins;
+    return walkLines(m_payload, m_len, m_hdr,
+                     [q, shift, n](size_t cell, uint8_t v, uint32_t s)
+                     {
+                         q[cell] = v;
+                         if (shift != nullptr)
+                         {
+                             shift[cell / n] = (uint8_t)s;
+                         }
+                     });
+}
+
+} /* namespace mmw */
@@ -0,0 +1,50 @@
+/**
+ *   @file  rd_heatmap.h
+ *
+ *   @brief
+ *      Decoder for the compressed range/Doppler heat map TLV
+ *      (MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED).
+ */
+#ifndef RD_HEATMAP_H
+#define RD_HEATMAP_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mmw_heatmap_codec.h"
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  Compressed range/Doppler heat map decoder
+ *
+ * @details
+ *  The decoder does not own the payload; it has to stay valid until the
+ *  last decode call. Output is written to caller provided buffers in the
+ *  layout of the dense heat map TLV, numRangeBins lines of numDopplerBins
+ *  values.
+ */
+class RdHeatMapDecoder
+{
+public:
+    int parse(const uint8_t *payload, size_t len);
+
+    int decode(uint16_t *out, size_t outCount) const;
+    int decodeQuantized(uint8_t *q, uint8_t *shift, size_t outCount) const;
+
+    uint16_t numRangeBins() const   { return m_hdr.numRangeBins; }
+    uint16_t numDopplerBins() const { return m_hdr.numDopplerBins; }
+    uint16_t noiseFloor() const     { return m_hdr.noiseFloor; }
+    size_t   numCells() const       { return (size_t)m_hdr.numRangeBins * m_hdr.numDopplerBins; }
+
+private:
+    const uint8_t               *m_payload = nullptr;
+    size_t                      m_len = 0;
+    MmwDemo_rdHeatMapCodecHdr   m_hdr = {};
+};
+
+} /* namespace mmw */
+
+#endif /* RD_HEATMAP_H */
@@ -0,0 +1,209 @@
+/**
+ *   @file  rd_heatmap_sparse.cpp
+ *
+ *   @brief
+ *      Sparse range/Doppler heat map decoder, see
+ *      board/common/mmw_heatmap_sparse.h for the format.
+ */
+#include <algorithm>
+#include <cstring>
+
+#include "rd_heatmap_sparse.h"
+
+namespace mmw
+{
+
+/**
+ *  @b Description
+ *  @n
+ *      Validates a sparse heat map payload and indexes its lines.
+ *
+ *  @param[in]  payload
+ *      TLV payload, without the TLV header
+ *  @param[in]  len
+ *      TLV length
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int SparseHeatMap::parse(const uint8_t *payload, size_t len)
+{
+    m_noise = nullptr;
+    m_runs = nullptr;
+    m_lineStart.clear();
+
+    if (len < sizeof(MmwDemo_rdHeatMapSparseHdr))
+    {
+        return -1;
+    }
+    std::memcpy(&m_hdr, payload, sizeof(m_hdr));
+    const size_t noiseLen = (size_t)m_hdr.numRangeBins * sizeof(uint16_t);
+    if ((m_hdr.version != MMW_HEATMAP_SPARSE_VERSION) || (m_hdr.numDopplerBins == 0U) ||
+        (len < sizeof(m_hdr) + noiseLen))
+    {
+        return -1;
+    }
+
+    const uint8_t *runs = payload + sizeof(m_hdr) + noiseLen;
+    const size_t  runsLen = len - sizeof(m_hdr) - noiseLen;
+    size_t        off = 0;
+    uint32_t      nextLine = 0;
+    uint32_t      prevRange = 0;
+    uint32_t      nextDoppler = 0;
+
+    m_lineStart.resize((size_t)m_hdr.numRangeBins + 1U);
+    for (uint32_t r = 0; r < m_hdr.numRuns; r++)
+    {
+        MmwDemo_rdHeatMapSparseRun run;
+        if (runsLen - off < sizeof(run))
+        {
+            return -1;
+        }
+        std::memcpy(&run, runs + off, sizeof(run));
+        const size_t runLen = sizeof(run) + (size_t)run.count * sizeof(uint16_t);
+
+        /* Runs are sorted, non overlapping and inside their line */
+        if ((run.rangeIdx >= m_hdr.numRangeBins) || (run.rangeIdx < prevRange) ||
+            ((run.rangeIdx == prevRange) && (run.dopplerStart < nextDoppler)) ||
+            (run.count == 0U) || ((uint32_t)run.dopplerStart + run.count > m_hdr.numDopplerBins) ||
+            (runsLen - off < runLen))
+        {
+            return -1;
+        }
+        while (nextLine <= run.rangeIdx)
+        {
+            m_lineStart[nextLine++] = (uint32_t)off;
+        }
+        prevRange = run.rangeIdx;
+        nextDoppler = (uint32_t)run.dopplerStart + run.count;
+        off += runLen;
+    }
+    while (nextLine <= m_hdr.numRangeBins)
+    {
+        m_lineStart[nextLine++] = (uint32_t)off;
+    }
+
+    m_noise = payload + sizeof(m_hdr);
+    m_runs = runs;
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Noise estimate of a range line, the value of every cell that was
+ *      not transmitted.
+ */
+uint16_t SparseHeatMap::noise(uint32_t rangeIdx) const
+{
+    uint16_t v;
+    std::memcpy(&v, m_noise + (size_t)rangeIdx * sizeof(uint16_t), sizeof(v));
+    return v;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Looks up a single cell. Only walks the runs of its line.
+ *
+ *  @param[in]  rangeIdx
+ *      Range index, below numRangeBins()
+ *  @param[in]  dopplerIdx
+ *      Doppler index, below numDopplerBins()
+ *
+ *  @retval
+ *      Cell value
+ */
+uint16_t SparseHeatMap::cell(uint32_t rangeIdx, uint32_t dopplerIdx) const
+{
+    const uint8_t *p = m_runs + m_lineStart[rangeIdx];
+    const uint8_t *end = m_runs + m_lineStart[rangeIdx + 1U];
+
+    while (p < end)
+    {
+        MmwDemo_rdHeatMapSparseRun run;
+        std::memcpy(&run, p, sizeof(run));
+        if (dopplerIdx < run.dopplerStart)
+        {
+            break;
+        }
+        if (dopplerIdx < (uint32_t)run.dopplerStart + run.count)
+        {
+            uint16_t v;
+            std::memcpy(&v, p + sizeof(run) + (dopplerIdx - run.dopplerStart) * sizeof(uint16_t), sizeof(v));
+            return v;
+        }
+        p += sizeof(run) + (size_t)run.count * sizeof(uint16_t);
+    }
+    return noise(rangeIdx);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Reconstructs one dense range line.
+ *
+ *  @param[in]  rangeIdx
+ *      Range index
+ *  @param[out] out
+ *      numDopplerBins() values
+ *  @param[in]  outCount
+ *      Number of values out can hold
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int SparseHeatMap::line(uint32_t rangeIdx, uint16_t *out, size_t outCount) const
+{
+    if ((m_runs == nullptr) || (rangeIdx >= m_hdr.numRangeBins) || (outCount < m_hdr.numDopplerBins))
+    {
+        return -1;
+    }
+    std::fill(out, out + m_hdr.numDopplerBins, noise(rangeIdx));
+
+    const uint8_t *p = m_runs + m_lineStart[rangeIdx];
+    const uint8_t *end = m_runs + m_lineStart[rangeIdx + 1U];
+    while (p < end)
+    {
+        MmwDemo_rdHeatMapSparseRun run;
+        std::memcpy(&run, p, sizeof(run));
+        p += sizeof(run);
+        std::memcpy(out + run.dopplerStart, p, (size_t)run.count * sizeof(uint16_t));
+        p += (size_t)run.count * sizeof(uint16_t);
+    }
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Reconstructs the dense heat map, in the layout of the dense TLV.
+ *
+ *  @param[out] out
+ *      numCells() values
+ *  @param[in]  outCount
+ *      Number of values out can hold
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int SparseHeatMap::decode(uint16_t *out, size_t outCount) const
+{
+    if ((m_runs == nullptr) || (outCount < numCells()))
+    {
+        return -1;
+    }
+    for (uint32_t r = 0; r < m_hdr.numRangeBins; r++)
+    {
+        line(r, out + (size_t)r * m_hdr.numDopplerBins, m_hdr.numDopplerBins);
+    }
+    return 0;
+}
+
+} /* namespace mmw */
@@ -0,0 +1,84 @@
+/**
+ *   @file  rd_heatmap_sparse.h
+ *
+ *   @brief
+ *      Lazy decoder for the sparse range/Doppler heat map TLV
+ *      (MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_SPARSE).
+ */
+#ifndef RD_HEATMAP_SPARSE_H
+#define RD_HEATMAP_SPARSE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "mmw_heatmap_sparse.h"
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  Sparse range/Doppler heat map view
+ *
+ * @details
+ *  parse() only validates the payload and indexes the first run of every
+ *  range line; cells are looked up in place and a dense map is only built
+ *  for the lines or the cells that are asked for. The payload has to stay
+ *  valid while the view is used. The index is reused across frames, so a
+ *  view kept for a stream allocates only for its first frame.
+ */
+class SparseHeatMap
+{
+public:
+    int parse(const uint8_t *payload, size_t len);
+
+    uint16_t cell(uint32_t rangeIdx, uint32_t dopplerIdx) const;
+    int line(uint32_t rangeIdx, uint16_t *out, size_t outCount) const;
+    int decode(uint16_t *out, size_t outCount) const;
+
+    /**
+     *  @b Description
+     *  @n
+     *      Calls fn(rangeIdx, dopplerIdx, value) for every transmitted cell,
+     *      in range then Doppler order, without building a dense map.
+     */
+    template <typename Fn>
+    void forEachCell(Fn fn) const
+    {
+        const uint8_t *p = m_runs;
+        for (uint32_t r = 0; r < m_hdr.numRuns; r++)
+        {
+            MmwDemo_rdHeatMapSparseRun run;
+            std::memcpy(&run, p, sizeof(run));
+            p += sizeof(run);
+            for (uint32_t i = 0; i < run.count; i++, p += sizeof(uint16_t))
+            {
+                uint16_t v;
+                std::memcpy(&v, p, sizeof(v));
+                fn(run.rangeIdx, run.dopplerStart + i, v);
+            }
+        }
+    }
+
+    uint16_t numRangeBins() const   { return m_hdr.numRangeBins; }
+    uint16_t numDopplerBins() const { return m_hdr.numDopplerBins; }
+    uint16_t numRuns() const        { return m_hdr.numRuns; }
+    uint16_t margin() const         { return m_hdr.margin; }
+    bool     truncated() const      { return (m_hdr.flags & MMW_HEATMAP_SPARSE_FLAG_TRUNCATED) != 0; }
+    size_t   numCells() const       { return (size_t)m_hdr.numRangeBins * m_hdr.numDopplerBins; }
+    uint16_t noise(uint32_t rangeIdx) const;
+
+private:
+    const uint8_t               *m_noise = nullptr;
+    const uint8_t               *m_runs = nullptr;
+    MmwDemo_rdHeatMapSparseHdr  m_hdr = {};
+
+    /* Byte offset into m_runs of the first run of every line, plus the end */
+    std::vector<uint32_t>       m_lineStart;
+};
+
+} /* namespace mmw */
+
+#endif /* RD_HEATMAP_SPARSE_H */
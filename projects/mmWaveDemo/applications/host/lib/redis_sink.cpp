@@ -0,0 +1,568 @@
+/**
+ *   @file  redis_sink.cpp
+ *
+ *   @brief
+ *      Redis Streams sink, see redis_sink.h.
+ */
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "azimuth_heatmap.h"
+#include "host_clock.h"
+#include "redis_sink.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+/* Reply framing error, the connection is dropped */
+const size_t RESP_BAD = (size_t)-1;
+
+void appendBulk(std::string &out, const void *p, size_t n)
+{
+    out += '$';
+    out += std::to_string(n);
+    out += "\r\n";
+    out.append((const char *)p, n);
+    out += "\r\n";
+}
+
+void appendBulk(std::string &out, const std::string &s)
+{
+    appendBulk(out, s.data(), s.size());
+}
+
+void appendField(std::string &out, const char *name, uint64_t value)
+{
+    appendBulk(out, name, std::strlen(name));
+    appendBulk(out, std::to_string(value));
+}
+
+/* XADD <key> [MAXLEN ~ <maxLen>] * followed by numFields field/value pairs */
+void beginXadd(std::string &out, const std::string &key, uint32_t maxLen, uint32_t numFields)
+{
+    const uint32_t argc = 3U + ((maxLen != 0U) ? 3U : 0U) + 2U * numFields;
+    out += '*';
+    out += std::to_string(argc);
+    out += "\r\n";
+    appendBulk(out, "XADD", 4);
+    appendBulk(out, key);
+    if (maxLen != 0U)
+    {
+        appendBulk(out, "MAXLEN", 6);
+        appendBulk(out, "~", 1);
+        appendBulk(out, std::to_string(maxLen));
+    }
+    appendBulk(out, "*", 1);
+}
+
+/* Length of the RESP reply at p, 0 while incomplete */
+size_t respLength(const char *p, size_t n)
+{
+    const void *cr = (n > 1U) ? std::memchr(p + 1, '\r', n - 1U) : nullptr;
+    if (cr == nullptr)
+    {
+        return 0;
+    }
+    const size_t lineEnd = (size_t)((const char *)cr - p);
+    if (lineEnd + 2U > n)
+    {
+        return 0;
+    }
+    const size_t next = lineEnd + 2U;
+    switch (p[0])
+    {
+    case '+':
+    case '-':
+    case ':':
+        return next;
+    case '$':
+    {
+        const long len = std::strtol(p + 1, nullptr, 10);
+        if (len < 0)
+        {
+            return next;
+        }
+        return (next + (size_t)len + 2U <= n) ? next + (size_t)len + 2U : 0U;
+    }
+    case '*':
+    {
+        const long count = std::strtol(p + 1, nullptr, 10);
+        size_t pos = next;
+        for (long i = 0; i < count; i++)
+        {
+            const size_t k = respLength(p + pos, n - pos);
+            if ((k == 0U) || (k == RESP_BAD))
+            {
+                return k;
+            }
+            pos += k;
+        }
+        return pos;
+    }
+    default:
+        return RESP_BAD;
+    }
+}
+
+/* Non blocking socket connected to the server, -1 on failure */
+int connectSocket(const RedisSinkConfig &cfg)
+{
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *res = nullptr;
+    if (getaddrinfo(cfg.host.c_str(), std::to_string(cfg.port).c_str(), &hints, &res) != 0)
+    {
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo *ai = res; (ai != nullptr) && (fd < 0); ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC | SOCK_NONBLOCK, ai->ai_protocol);
+        if (fd < 0)
+        {
+            continue;
+        }
+        int err = 0;
+        if (::connect(fd, ai->ai_addr, ai->ai_addrlen) != 0)
+        {
+            err = errno;
+            if (err == EINPROGRESS)
+            {
+                struct pollfd pfd = { fd, POLLOUT, 0 };
+                socklen_t errLen = sizeof(err);
+                if ((poll(&pfd, 1, (int)cfg.connectTimeoutMs) != 1) ||
+                    (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errLen) != 0))
+                {
+                    err = ETIMEDOUT;
+                }
+            }
+        }
+        if (err != 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(res);
+    if (fd >= 0)
+    {
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+} /* anonymous namespace */
+
+RedisSink::~RedisSink()
+{
+    stop();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Starts the I/O thread. The connection is made there, so this
+ *      succeeds with the server away; frames queue up until it comes.
+ *
+ *  @param[in]  cfg
+ *      Sink configuration
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, bad configuration or already started
+ */
+int RedisSink::start(const RedisSinkConfig &cfg)
+{
+    if (m_thread.joinable() || (cfg.maxInflight < 2U) || cfg.prefix.empty())
+    {
+        return -1;
+    }
+    if ((cfg.heatmapEvery != 0U) &&
+        ((cfg.numVirtualAnt == 0U) || (cfg.rangeDecimation == 0U) ||
+         (cfg.numAngleBins < MMW_AZIMUTH_HEATMAP_MIN_BINS) || (cfg.numAngleBins > 0xFFFFU) ||
+         ((cfg.numAngleBins & (cfg.numAngleBins - 1U)) != 0U)))
+    {
+        return -1;
+    }
+    m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_wakeFd < 0)
+    {
+        return -1;
+    }
+    m_cfg = cfg;
+    m_frameCount = 0;
+    m_stats = RedisSinkStats();
+    m_stop.store(false);
+    m_thread = std::thread(&RedisSink::ioLoop, this);
+    return 0;
+}
+
+int RedisSink::encodeHeatMap(const FrameView &frame, uint64_t hostNs, std::string &out)
+{
+    /* The device's magnitude TLV if it sent a linear one, else computed
+     * from IQ */
+    AzimuthHeatMap map;
+    const TlvRef *magTlv = frame.find(TLV_AZIMUTH_HEAT_MAP_MAGNITUDE);
+    if ((magTlv == nullptr) || (map.parse(magTlv->payload, magTlv->length) < 0) ||
+        (map.format() != MMW_AZIMUTH_HEATMAP_FORMAT_U16))
+    {
+        const size_t antBytes = (size_t)m_cfg.numVirtualAnt * sizeof(Cmplx16ImRe);
+        const size_t iqLen = frame.azimuthStatic.sizeBytes();
+        if ((iqLen == 0U) || ((iqLen % antBytes) != 0U) || (iqLen / antBytes > 0xFFFFU))
+        {
+            return -1;
+        }
+        const uint32_t numRangeBins = (uint32_t)(iqLen / antBytes);
+        m_magnitude.resize(azimuthHeatMapSize(numRangeBins, m_cfg.numAngleBins, MMW_AZIMUTH_HEATMAP_FORMAT_U16));
+        if ((computeAzimuthHeatMap(frame.azimuthStatic.bytes(), numRangeBins, m_cfg.numVirtualAnt,
+                                   m_cfg.numAngleBins, MMW_AZIMUTH_HEATMAP_FORMAT_U16,
+                                   m_magnitude.data(), m_magnitude.size()) < 0) ||
+            (map.parse(m_magnitude.data(), m_magnitude.size()) < 0))
+        {
+            return -1;
+        }
+    }
+
+    /* Max pooling keeps a strong target visible in a coarser map */
+    const uint32_t cols = map.numAngleBins();
+    const uint32_t rows = (map.numRangeBins() + m_cfg.rangeDecimation - 1U) / m_cfg.rangeDecimation;
+    m_rows.assign((size_t)rows * cols, 0);
+    for (uint32_t r = 0; r < map.numRangeBins(); r++)
+    {
+        uint16_t *row = &m_rows[(size_t)(r / m_cfg.rangeDecimation) * cols];
+        for (uint32_t a = 0; a < cols; a++)
+        {
+            const uint16_t v = map.value(r, a);
+            row[a] = (v > row[a]) ? v : row[a];
+        }
+    }
+
+    beginXadd(out, m_cfg.prefix + ":heatmap", m_cfg.heatmapMaxLen, 5);
+    appendField(out, "frame", frame.header.frameNumber);
+    appendField(out, "host", hostNs);
+    appendField(out, "rows", rows);
+    appendField(out, "cols", cols);
+    appendBulk(out, "data", 4);
+    appendBulk(out, m_rows.data(), m_rows.size() * sizeof(uint16_t));
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Queues the objects of a frame and, every heatmapEvery frames, its
+ *      downsampled heat map. Never waits: with the backlog full either the
+ *      oldest queued frames or this one are dropped.
+ *
+ *  @param[in]  frame
+ *      Parsed packet
+ *  @param[in]  hostNs
+ *      CLOCK_MONOTONIC when the packet came in
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, not started or the frame was dropped
+ */
+int RedisSink::push(const FrameView &frame, uint64_t hostNs)
+{
+    if (!m_thread.joinable())
+    {
+        return -1;
+    }
+    Entry e;
+    e.pushNs = monotonicNs();
+    e.numCmds = 1;
+    beginXadd(e.cmds, m_cfg.prefix + ":objects", m_cfg.objectsMaxLen, 5);
+    appendField(e.cmds, "frame", frame.header.frameNumber);
+    appendField(e.cmds, "cycles", frame.header.timeCpuCycles);
+    appendField(e.cmds, "host", hostNs);
+    appendField(e.cmds, "q", frame.objDescr.xyzQFormat);
+    appendBulk(e.cmds, "obj", 3);
+    appendBulk(e.cmds, frame.objects.bytes(), frame.objects.sizeBytes());
+
+    if ((m_cfg.heatmapEvery != 0U) && ((m_frameCount % m_cfg.heatmapEvery) == 0U))
+    {
+        const size_t at = e.cmds.size();
+        if (encodeHeatMap(frame, hostNs, e.cmds) == 0)
+        {
+            e.numCmds++;
+        }
+        else
+        {
+            e.cmds.resize(at);
+        }
+    }
+    m_frameCount++;
+
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_stats.frames++;
+    if (m_cfg.dropPolicy == REDIS_DROP_OLDEST)
+    {
+        while (!m_queue.empty() && (m_stats.backlogBytes + e.cmds.size() > m_cfg.maxBacklogBytes))
+        {
+            m_stats.backlogBytes -= m_queue.front().cmds.size();
+            m_queue.pop_front();
+            m_stats.dropped++;
+        }
+    }
+    if (m_stats.backlogBytes + e.cmds.size() > m_cfg.maxBacklogBytes)
+    {
+        m_stats.dropped++;
+        return -1;
+    }
+    m_stats.backlogBytes += e.cmds.size();
+    m_queue.push_back(std::move(e));
+    guard.unlock();
+
+    const uint64_t one = 1;
+    (void)write(m_wakeFd, &one, sizeof(one));
+    return 0;
+}
+
+void RedisSink::disconnect()
+{
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_out.clear();
+    m_outSent = 0;
+    m_in.clear();
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_stats.failed += m_pending.size();
+    m_pending.clear();
+    m_stats.inflight = 0;
+    m_stats.connected = false;
+    m_cv.notify_all();
+}
+
+void RedisSink::ioLoop()
+{
+    const uint64_t reconnectNs = (uint64_t)m_cfg.reconnectMs * 1000000ULL;
+    uint64_t lastAttemptNs = 0;
+    bool attempted = false;
+    char buf[16384];
+
+    while (!m_stop.load())
+    {
+        if (m_fd < 0)
+        {
+            const uint64_t now = monotonicNs();
+            if (!attempted || (now - lastAttemptNs >= reconnectNs))
+            {
+                attempted = true;
+                lastAttemptNs = now;
+                m_fd = connectSocket(m_cfg);
+                if (m_fd >= 0)
+                {
+                    std::lock_guard<std::mutex> guard(m_lock);
+                    m_stats.connects++;
+                    m_stats.connected = true;
+                }
+            }
+            if (m_fd < 0)
+            {
+                struct pollfd pfd = { m_wakeFd, POLLIN, 0 };
+                poll(&pfd, 1, (int)m_cfg.reconnectMs);
+                uint64_t v;
+                (void)read(m_wakeFd, &v, sizeof(v));
+                continue;
+            }
+        }
+
+        /* Everything queued that fits in flight goes out in one write */
+        if (m_out.empty())
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            const bool batchDue = (m_stats.inflight == 0U) || (m_stats.backlogBytes >= m_cfg.batchBytes);
+            while (batchDue && !m_queue.empty() &&
+                   (m_stats.inflight + m_queue.front().numCmds <= m_cfg.maxInflight))
+            {
+                Entry &e = m_queue.front();
+                m_out += e.cmds;
+                m_pending.push_back(Pending{ e.numCmds, e.pushNs });
+                m_stats.inflight += e.numCmds;
+                m_stats.commands += e.numCmds;
+                m_stats.backlogBytes -= e.cmds.size();
+                m_queue.pop_front();
+            }
+        }
+
+        struct pollfd fds[2] = {
+            { m_fd, (short)(POLLIN | (m_out.empty() ? 0 : POLLOUT)), 0 },
+            { m_wakeFd, POLLIN, 0 }
+        };
+        const int r = poll(fds, 2, 100);
+        if (r <= 0)
+        {
+            continue;
+        }
+        if ((fds[1].revents & POLLIN) != 0)
+        {
+            uint64_t v;
+            (void)read(m_wakeFd, &v, sizeof(v));
+        }
+        if ((fds[0].revents & (POLLERR | POLLHUP)) != 0)
+        {
+            disconnect();
+            continue;
+        }
+
+        if ((fds[0].revents & POLLOUT) != 0)
+        {
+            const ssize_t n = send(m_fd, m_out.data() + m_outSent, m_out.size() - m_outSent,
+                                   MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n < 0)
+            {
+                if ((errno != EAGAIN) && (errno != EINTR))
+                {
+                    disconnect();
+                    continue;
+                }
+            }
+            else
+            {
+                m_outSent += (size_t)n;
+                if (m_outSent == m_out.size())
+                {
+                    m_out.clear();
+                    m_outSent = 0;
+                    std::lock_guard<std::mutex> guard(m_lock);
+                    m_stats.writes++;
+                }
+            }
+        }
+
+        if ((fds[0].revents & POLLIN) != 0)
+        {
+            const ssize_t n = recv(m_fd, buf, sizeof(buf), MSG_DONTWAIT);
+            if ((n == 0) || ((n < 0) && (errno != EAGAIN) && (errno != EINTR)))
+            {
+                disconnect();
+                continue;
+            }
+            if (n > 0)
+            {
+                m_in.append(buf, (size_t)n);
+            }
+
+            /* One reply per command, in order */
+            const uint64_t now = monotonicNs();
+            size_t pos = 0;
+            bool bad = false;
+            std::unique_lock<std::mutex> guard(m_lock);
+            while (pos < m_in.size())
+            {
+                const size_t k = respLength(m_in.data() + pos, m_in.size() - pos);
+                if (k == 0U)
+                {
+                    break;
+                }
+                if ((k == RESP_BAD) || m_pending.empty())
+                {
+                    bad = true;
+                    break;
+                }
+                m_stats.replies++;
+                if (m_in[pos] == '-')
+                {
+                    m_stats.errors++;
+                }
+                m_stats.inflight--;
+                if (--m_pending.front().remaining == 0U)
+                {
+                    m_stats.latency.add(now - m_pending.front().pushNs);
+                    m_pending.pop_front();
+                }
+                pos += k;
+            }
+            m_cv.notify_all();
+            guard.unlock();
+            m_in.erase(0, pos);
+            if (bad)
+            {
+                disconnect();
+            }
+        }
+    }
+    disconnect();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Waits until everything queued is written and answered.
+ *
+ *  @param[in]  timeoutMs
+ *      Longest wait
+ *
+ *  @retval
+ *      True if nothing is left queued or in flight
+ */
+bool RedisSink::flush(int timeoutMs)
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+    return m_cv.wait_for(guard, std::chrono::milliseconds(timeoutMs),
+                         [this] { return m_queue.empty() && (m_stats.inflight == 0U); });
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Stops the I/O thread and closes the connection. Frames still queued
+ *      are discarded, those in flight count as failed.
+ */
+void RedisSink::stop()
+{
+    if (!m_thread.joinable())
+    {
+        return;
+    }
+    m_stop.store(true);
+    const uint64_t one = 1;
+    (void)write(m_wakeFd, &one, sizeof(one));
+    m_thread.join();
+    ::close(m_wakeFd);
+    m_wakeFd = -1;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_queue.clear();
+    m_stats.backlogBytes = 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Snapshot of the counters.
+ */
+RedisSinkStats RedisSink::stats() const
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    RedisSinkStats st = m_stats;
+    st.backlogFrames = (uint32_t)m_queue.size();
+    return st;
+}
+
+} /* namespace mmw */
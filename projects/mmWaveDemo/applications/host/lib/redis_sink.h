@@ -0,0 +1,195 @@
+/**
+ *   @file  redis_sink.h
+ *
+ *   @brief
+ *      Writes detected objects and downsampled range/azimuth heat maps
+ *      into Redis Streams with pipelined XADD.
+ */
+#ifndef REDIS_SINK_H
+#define REDIS_SINK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lag_histogram.h"
+#include "tlv_parser.h"
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  What to drop when the backlog is full
+ */
+enum RedisDropPolicy : uint8_t
+{
+    REDIS_DROP_OLDEST   = 0,    /*!< Make room by dropping the oldest frames */
+    REDIS_DROP_NEWEST   = 1     /*!< Keep the backlog, drop the new frame */
+};
+
+/**
+ * @brief
+ *  Sink configuration
+ */
+struct RedisSinkConfig
+{
+    std::string     host = "127.0.0.1";
+    uint16_t        port = 6379;
+
+    /*! @brief   Streams are <prefix>:objects and <prefix>:heatmap */
+    std::string     prefix = "radar";
+
+    /*! @brief   MAXLEN ~ of the streams, 0 does not trim */
+    uint32_t        objectsMaxLen = 100000;
+    uint32_t        heatmapMaxLen = 1000;
+
+    /*! @brief   Heat map of every n-th frame, 0 for none */
+    uint32_t        heatmapEvery = 0;
+    uint32_t        numVirtualAnt = 8;
+    uint32_t        numAngleBins = 16;
+
+    /*! @brief   Range bins max pooled into one heat map row */
+    uint32_t        rangeDecimation = 4;
+
+    /*! @brief   Encoded frames not written yet; beyond this frames are
+     *           dropped by dropPolicy */
+    size_t          maxBacklogBytes = 8U << 20;
+    RedisDropPolicy dropPolicy = REDIS_DROP_OLDEST;
+
+    /*! @brief   Commands written but not answered, the pipeline depth */
+    uint32_t        maxInflight = 1024;
+
+    /*! @brief   While commands are unanswered, new frames wait until this
+     *           much is queued and then go out in one write */
+    size_t          batchBytes = 64U * 1024U;
+
+    uint32_t        connectTimeoutMs = 1000;
+    uint32_t        reconnectMs = 1000;
+};
+
+/**
+ * @brief
+ *  Sink counters. Frames count whole frames, commands single XADDs.
+ */
+struct RedisSinkStats
+{
+    uint64_t        frames = 0;
+
+    /*! @brief   Dropped by the backlog policy */
+    uint64_t        dropped = 0;
+
+    /*! @brief   Taken for writing, lost with the connection before every
+     *           reply came */
+    uint64_t        failed = 0;
+
+    uint64_t        commands = 0;
+
+    /*! @brief   Socket writes, commands / writes is the pipelining */
+    uint64_t        writes = 0;
+
+    uint64_t        replies = 0;
+
+    /*! @brief   Error replies, e.g. a key of the wrong type */
+    uint64_t        errors = 0;
+
+    uint64_t        connects = 0;
+    bool            connected = false;
+
+    /*! @brief   Frames and bytes waiting to be written */
+    uint32_t        backlogFrames = 0;
+    size_t          backlogBytes = 0;
+
+    /*! @brief   Commands written and not answered */
+    uint32_t        inflight = 0;
+
+    /*! @brief   push() to the reply of the last command of the frame */
+    LagHistogram    latency;
+};
+
+/**
+ * @brief
+ *  Redis Streams sink
+ *
+ * @details
+ *  push() encodes the XADD commands of a frame and queues them; a thread
+ *  of the sink writes them and reads the replies as they come, with up to
+ *  maxInflight commands unanswered. A frame goes out at once when the
+ *  server has answered everything before it; otherwise frames collect
+ *  until the replies are in or batchBytes are queued and go out in one
+ *  write, so a slow server gets bigger batches instead of more writes.
+ *  The sink connects by itself and reconnects every reconnectMs. While the
+ *  server is slow or away the queue is bounded by maxBacklogBytes and
+ *  frames are dropped by dropPolicy; push() never waits.
+ *
+ *  Objects go to <prefix>:objects with the fields frame, cycles (DSS
+ *  timeCpuCycles), host (CLOCK_MONOTONIC ns), q (xyzQFormat) and obj, the
+ *  DetObj array as on the wire. Heat maps go to <prefix>:heatmap with
+ *  frame, host, rows, cols and data, rows x cols uint16 little endian.
+ */
+class RedisSink
+{
+public:
+    RedisSink() = default;
+    ~RedisSink();
+
+    RedisSink(const RedisSink &) = delete;
+    RedisSink &operator=(const RedisSink &) = delete;
+
+    int start(const RedisSinkConfig &cfg);
+    int push(const FrameView &frame, uint64_t hostNs);
+    bool flush(int timeoutMs);
+    void stop();
+
+    RedisSinkStats stats() const;
+
+private:
+    struct Entry
+    {
+        std::string     cmds;
+        uint32_t        numCmds;
+        uint64_t        pushNs;
+    };
+
+    struct Pending
+    {
+        uint32_t        remaining;
+        uint64_t        pushNs;
+    };
+
+    int encodeHeatMap(const FrameView &frame, uint64_t hostNs, std::string &out);
+    void disconnect();
+    void ioLoop();
+
+    RedisSinkConfig         m_cfg;
+    std::thread             m_thread;
+    std::atomic<bool>       m_stop{false};
+    int                     m_wakeFd = -1;
+
+    /* push() side */
+    uint64_t                m_frameCount = 0;
+    std::vector<uint8_t>    m_magnitude;
+    std::vector<uint16_t>   m_rows;
+
+    /* I/O thread side */
+    int                     m_fd = -1;
+    std::string             m_out;
+    size_t                  m_outSent = 0;
+    std::deque<Pending>     m_pending;
+    std::string             m_in;
+
+    mutable std::mutex      m_lock;
+    std::condition_variable m_cv;
+    std::deque<Entry>       m_queue;
+    RedisSinkStats          m_stats;
+};
+
+} /* namespace mmw */
+
+#endif /* REDIS_SINK_H */
@@ -0,0 +1,493 @@
+/**
+ *   @file  replay.cpp
+ *
+ *   @brief
+ *      Capture replay engine, see replay.h.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <ctime>
+#include <sstream>
+
+#include "host_clock.h"
+#include "replay.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+void sleepUntilNs(uint64_t ns)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+    {
+    }
+}
+
+/* Longest single sleep, so stop() and seek() are seen quickly */
+const uint64_t SLEEP_SLICE_NS = 50000000ULL;
+
+} /* anonymous namespace */
+
+Replayer::~Replayer()
+{
+    stop();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      frameCfg periodicity of a .cfg, in us.
+ *
+ *  @retval
+ *      Period, 0 if there is no frameCfg
+ */
+uint32_t Replayer::cfgFramePeriodUs(const std::string &cfgText)
+{
+    std::istringstream in(cfgText);
+    std::string line;
+
+    while (std::getline(in, line))
+    {
+        std::istringstream words(line);
+        std::string cmd;
+        words >> cmd;
+        if (cmd != "frameCfg")
+        {
+            continue;
+        }
+        /* frameCfg <chirpStart> <chirpEnd> <numLoops> <numFrames> <periodicity ms> ... */
+        std::string arg;
+        for (int i = 0; (i < 5) && (words >> arg); i++)
+        {
+        }
+        if (!words.fail())
+        {
+            return (uint32_t)(std::strtod(arg.c_str(), nullptr) * 1000.0);
+        }
+    }
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Sets up the replay of a capture, which must stay open meanwhile.
+ *
+ *  @param[in]  capture
+ *      Opened capture file
+ *  @param[in]  cfg
+ *      Replay configuration
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, empty range, or REPLAY_CLOCK_FRAME without a period
+ */
+int Replayer::open(const CaptureFile &capture, const ReplayConfig &cfg)
+{
+    if (m_thread.joinable() || (cfg.speed < 0.0) || (cfg.queueDepth == 0U) || (cfg.cpuClockHz == 0U))
+    {
+        return -1;
+    }
+    m_capture = &capture;
+    m_cfg = cfg;
+    m_end = std::min(cfg.end, capture.numFrames());
+    if (m_cfg.first >= m_end)
+    {
+        return -1;
+    }
+    if ((m_cfg.clock == REPLAY_CLOCK_FRAME) && (m_cfg.framePeriodUs == 0U))
+    {
+        m_cfg.framePeriodUs = cfgFramePeriodUs(capture.cfgText());
+        if (m_cfg.framePeriodUs == 0U)
+        {
+            return -1;
+        }
+    }
+    m_speed = m_cfg.speed;
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Adds a consumer; it gets every frame on a thread of its own. Only
+ *      before start().
+ */
+void Replayer::addConsumer(const std::string &name, FrameFn fn)
+{
+    if (!m_thread.joinable())
+    {
+        std::unique_ptr<Consumer> c(new Consumer());
+        c->name = name;
+        c->st.name = name;
+        c->fn = std::move(fn);
+        m_consumers.push_back(std::move(c));
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Starts the consumer and pacing threads.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int Replayer::start()
+{
+    if ((m_capture == nullptr) || m_thread.joinable())
+    {
+        return -1;
+    }
+    m_stop.store(false);
+    m_running.store(true);
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stats = ReplayStats();
+        m_stats.position = m_cfg.first;
+    }
+    for (std::unique_ptr<Consumer> &c : m_consumers)
+    {
+        c->done = false;
+        c->queue.clear();
+        c->st = ReplayConsumerStats();
+        c->st.name = c->name;
+        c->thread = std::thread(&Replayer::consumerLoop, this, c.get());
+    }
+    m_thread = std::thread(&Replayer::pacingLoop, this);
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Stops the replay; frames still queued are discarded.
+ */
+void Replayer::stop()
+{
+    m_stop.store(true);
+    for (std::unique_ptr<Consumer> &c : m_consumers)
+    {
+        std::lock_guard<std::mutex> guard(c->lock);
+        c->cv.notify_all();
+    }
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Waits for the replay to finish its passes and the consumers to
+ *      drain their queues.
+ *
+ *  @param[in]  timeoutMs
+ *      Longest wait, <0 for no limit
+ *
+ *  @retval
+ *      true once the replay is over
+ */
+bool Replayer::wait(int timeoutMs)
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+    if (timeoutMs < 0)
+    {
+        m_doneCv.wait(guard, [this] { return !m_running.load(); });
+        return true;
+    }
+    return m_doneCv.wait_for(guard, std::chrono::milliseconds(timeoutMs), [this] { return !m_running.load(); });
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Continues the replay at a frame, right away; the schedule restarts
+ *      from there.
+ *
+ *  @param[in]  index
+ *      Frame index, e.g. from CaptureFile::seekFrame()
+ */
+void Replayer::seek(size_t index)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_seekTo = std::min(std::max(index, m_cfg.first), m_end);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Changes the speed from the next frame on; 0 is as fast as possible.
+ */
+void Replayer::setSpeed(double speed)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_speed = std::max(speed, 0.0);
+    m_reanchor = true;
+}
+
+/* Recorded time between two frames, ns */
+uint64_t Replayer::mediaDeltaNs(size_t prev, size_t cur) const
+{
+    const CaptureIndexEntry &a = m_capture->entry(prev);
+    const CaptureIndexEntry &b = m_capture->entry(cur);
+    uint64_t ns;
+
+    switch (m_cfg.clock)
+    {
+    case REPLAY_CLOCK_DEVICE:
+        /* A 32 bit counter: the difference is right across one wrap */
+        ns = (uint64_t)(uint32_t)(b.timeCpuCycles - a.timeCpuCycles) * 1000000000ULL / m_cfg.cpuClockHz;
+        break;
+    case REPLAY_CLOCK_FRAME:
+        ns = (uint64_t)(uint32_t)(b.frameNumber - a.frameNumber) * m_cfg.framePeriodUs * 1000ULL;
+        break;
+    default:
+        ns = (b.hostNs > a.hostNs) ? b.hostNs - a.hostNs : 0U;
+        break;
+    }
+    return std::min<uint64_t>(ns, (uint64_t)m_cfg.maxGapMs * 1000000ULL);
+}
+
+/* false when the replay was stopped while waiting for room */
+bool Replayer::dispatch(Consumer &c, const ReplayFrame &frame)
+{
+    std::unique_lock<std::mutex> guard(c.lock);
+    if (c.queue.size() >= m_cfg.queueDepth)
+    {
+        if (m_cfg.dropWhenFull)
+        {
+            c.st.dropped++;
+            return true;
+        }
+        c.cv.wait(guard, [&] { return (c.queue.size() < m_cfg.queueDepth) || m_stop.load(); });
+        if (m_stop.load())
+        {
+            return false;
+        }
+    }
+    c.queue.push_back(frame);
+    c.st.maxQueued = std::max(c.st.maxQueued, c.queue.size());
+    c.cv.notify_all();
+    return true;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Pacing thread. Frame i is due at anchorWall + (media(i) - anchorMedia)
+ *      / speed, media being the recorded time; seeking, looping and speed
+ *      changes move the anchor.
+ */
+void Replayer::pacingLoop()
+{
+    size_t      i = m_cfg.first;
+    size_t      prev = SIZE_MAX;
+    uint32_t    loop = 0;
+    uint64_t    media = 0;
+    uint64_t    anchorMedia = 0;
+    uint64_t    anchorWall = monotonicNs();
+    uint64_t    lastDue = anchorWall;
+    double      speed = m_cfg.speed;
+
+    /* Spacing from the end of one pass to the start of the next */
+    const uint64_t loopGapNs = (m_end - m_cfg.first > 1U) ?
+        [this]
+        {
+            uint64_t sum = 0;
+            for (size_t k = m_cfg.first + 1U; k < m_end; k++)
+            {
+                sum += mediaDeltaNs(k - 1U, k);
+            }
+            return sum / (m_end - m_cfg.first - 1U);
+        }() : 0U;
+
+    while (!m_stop.load())
+    {
+        bool restart = false;
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (m_seekTo != SIZE_MAX)
+            {
+                i = m_seekTo;
+                m_seekTo = SIZE_MAX;
+                prev = SIZE_MAX;
+                restart = true;
+            }
+            if (m_reanchor)
+            {
+                m_reanchor = false;
+                anchorWall = lastDue;
+                anchorMedia = media;
+            }
+            speed = m_speed;
+        }
+
+        uint64_t frameMedia = 0;
+        if (i >= m_end)
+        {
+            loop++;
+            if ((m_cfg.loops != 0U) && (loop >= m_cfg.loops))
+            {
+                break;
+            }
+            i = m_cfg.first;
+            prev = SIZE_MAX;
+            anchorWall = lastDue + ((speed > 0.0) ? (uint64_t)((double)loopGapNs / speed) : 0U);
+            media = 0;
+            anchorMedia = 0;
+        }
+        else if (prev == SIZE_MAX)
+        {
+            if (restart)
+            {
+                anchorWall = monotonicNs();
+            }
+            media = 0;
+            anchorMedia = 0;
+        }
+        else
+        {
+            frameMedia = media + mediaDeltaNs(prev, i);
+        }
+
+        uint64_t due;
+        if (speed > 0.0)
+        {
+            due = anchorWall + (uint64_t)((double)(frameMedia - anchorMedia) / speed);
+            uint64_t now = monotonicNs();
+            while ((now < due) && !m_stop.load())
+            {
+                sleepUntilNs(std::min(due, now + SLEEP_SLICE_NS));
+                now = monotonicNs();
+                std::lock_guard<std::mutex> guard(m_lock);
+                if ((m_seekTo != SIZE_MAX) || m_reanchor)
+                {
+                    break;
+                }
+            }
+            if (now < due)
+            {
+                /* Seek or speed change while waiting: schedule again */
+                continue;
+            }
+        }
+        else
+        {
+            due = monotonicNs();
+        }
+
+        ReplayFrame frame;
+        frame.data = m_capture->packet(i);
+        frame.len = m_capture->entry(i).len;
+        frame.index = i;
+        frame.entry = &m_capture->entry(i);
+        frame.dueNs = due;
+        frame.loop = loop;
+
+        const uint64_t late = monotonicNs() - due;
+        bool delivered = true;
+        for (std::unique_ptr<Consumer> &c : m_consumers)
+        {
+            delivered = dispatch(*c, frame) && delivered;
+        }
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_stats.frames++;
+            m_stats.loop = loop;
+            m_stats.position = i + 1U;
+            m_stats.lateNs = late;
+            m_stats.maxLateNs = std::max(m_stats.maxLateNs, late);
+        }
+        if (!delivered)
+        {
+            break;
+        }
+        lastDue = due;
+        media = frameMedia;
+        prev = i;
+        i++;
+    }
+
+    for (std::unique_ptr<Consumer> &c : m_consumers)
+    {
+        {
+            std::lock_guard<std::mutex> guard(c->lock);
+            c->done = true;
+            c->cv.notify_all();
+        }
+        c->thread.join();
+    }
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_running.store(false);
+    m_doneCv.notify_all();
+}
+
+/* Consumer thread: runs the callback on its frames in order */
+void Replayer::consumerLoop(Consumer *c)
+{
+    std::unique_lock<std::mutex> guard(c->lock);
+
+    while (true)
+    {
+        c->cv.wait(guard, [&] { return !c->queue.empty() || c->done || m_stop.load(); });
+        if (m_stop.load() || (c->queue.empty() && c->done))
+        {
+            break;
+        }
+        const ReplayFrame frame = c->queue.front();
+        c->queue.pop_front();
+        c->cv.notify_all();
+        guard.unlock();
+
+        const uint64_t t0 = monotonicNs();
+        c->fn(frame);
+        const uint64_t t1 = monotonicNs();
+
+        guard.lock();
+        c->st.frames++;
+        c->st.lag.add((t0 > frame.dueNs) ? t0 - frame.dueNs : 0U);
+        c->st.busy.add(t1 - t0);
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Snapshot of the replay counters, safe from any thread.
+ */
+ReplayStats Replayer::stats() const
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_stats;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Snapshot of the consumer counters, safe from any thread.
+ */
+std::vector<ReplayConsumerStats> Replayer::consumerStats() const
+{
+    std::vector<ReplayConsumerStats> out;
+
+    for (const std::unique_ptr<Consumer> &c : m_consumers)
+    {
+        std::lock_guard<std::mutex> guard(c->lock);
+        out.push_back(c->st);
+        out.back().queued = c->queue.size();
+    }
+    return out;
+}
+
+} /* namespace mmw */
@@ -0,0 +1,215 @@
+/**
+ *   @file  replay.h
+ *
+ *   @brief
+ *      Replay of a capture file to consumers at the recorded cadence, at a
+ *      multiple of it or as fast as they take the frames.
+ */
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "capture_file.h"
+#include "lag_histogram.h"
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  Where the spacing of the frames comes from
+ */
+enum ReplayClock
+{
+    /*! @brief   timeCpuCycles of the header, DSS cycle counter */
+    REPLAY_CLOCK_DEVICE = 0,
+
+    /*! @brief   frameNumber times the frame period */
+    REPLAY_CLOCK_FRAME,
+
+    /*! @brief   Host receive time of the index */
+    REPLAY_CLOCK_HOST
+};
+
+/**
+ * @brief
+ *  Replay configuration
+ */
+struct ReplayConfig
+{
+    /*! @brief   1 is the recorded cadence, 4 four times as fast; 0 as fast
+     *           as the consumers take the frames */
+    double      speed = 1.0;
+
+    ReplayClock clock = REPLAY_CLOCK_DEVICE;
+
+    /*! @brief   Rate of timeCpuCycles: the 600 MHz C674x of the xWR16xx */
+    uint32_t    cpuClockHz = 600000000U;
+
+    /*! @brief   Frame period for REPLAY_CLOCK_FRAME; 0 takes it from the
+     *           frameCfg of the recorded .cfg */
+    uint32_t    framePeriodUs = 0;
+
+    /*! @brief   Longer gaps between frames (a paused recording, a clock
+     *           glitch) are cut to this */
+    uint32_t    maxGapMs = 2000;
+
+    /*! @brief   Frames [first, end) of the capture, by index */
+    size_t      first = 0;
+    size_t      end = SIZE_MAX;
+
+    /*! @brief   Passes over the range; 0 loops until stop() */
+    uint32_t    loops = 1;
+
+    /*! @brief   Frames queued per consumer */
+    size_t      queueDepth = 16;
+
+    /*! @brief   A consumer with a full queue loses the frame; otherwise the
+     *           replay waits for it and falls behind the schedule */
+    bool        dropWhenFull = false;
+};
+
+/**
+ * @brief
+ *  Frame handed to the consumers
+ */
+struct ReplayFrame
+{
+    /*! @brief   The packet, in the mapping of the capture */
+    const uint8_t           *data;
+    uint32_t                len;
+
+    /*! @brief   Index in the capture and its index entry */
+    size_t                  index;
+    const CaptureIndexEntry *entry;
+
+    /*! @brief   CLOCK_MONOTONIC ns the frame is due at */
+    uint64_t                dueNs;
+
+    /*! @brief   Pass over the capture, from 0 */
+    uint32_t                loop;
+};
+
+/**
+ * @brief
+ *  Consumer counters
+ */
+struct ReplayConsumerStats
+{
+    std::string     name;
+    uint64_t        frames = 0;
+    uint64_t        dropped = 0;
+    size_t          queued = 0;
+    size_t          maxQueued = 0;
+
+    /*! @brief   Due time to the start of the callback */
+    LagHistogram    lag;
+
+    /*! @brief   Time spent in the callback */
+    LagHistogram    busy;
+};
+
+/**
+ * @brief
+ *  Replay counters
+ */
+struct ReplayStats
+{
+    uint64_t    frames = 0;
+    uint32_t    loop = 0;
+
+    /*! @brief   Index of the next frame */
+    size_t      position = 0;
+
+    /*! @brief   How late the last frame was dispatched; grows when a
+     *           consumer holds the replay up */
+    uint64_t    lateNs = 0;
+    uint64_t    maxLateNs = 0;
+};
+
+/**
+ * @brief
+ *  Capture replay engine
+ *
+ * @details
+ *  A pacing thread dispatches the frames of a CaptureFile at their due
+ *  time into a bounded queue per consumer; every consumer runs on its own
+ *  thread, so a slow one only delays itself, unless the queue fills and
+ *  dropWhenFull is off. Frames point into the mapping of the capture,
+ *  nothing is copied. seek() and setSpeed() take effect at the next frame
+ *  and restart the schedule from there.
+ */
+class Replayer
+{
+public:
+    using FrameFn = std::function<void(const ReplayFrame &frame)>;
+
+    Replayer() = default;
+    ~Replayer();
+
+    Replayer(const Replayer &) = delete;
+    Replayer &operator=(const Replayer &) = delete;
+
+    int open(const CaptureFile &capture, const ReplayConfig &cfg);
+    void addConsumer(const std::string &name, FrameFn fn);
+    int start();
+    void stop();
+    bool wait(int timeoutMs);
+
+    void seek(size_t index);
+    void setSpeed(double speed);
+
+    bool running() const { return m_running.load(); }
+    ReplayStats stats() const;
+    std::vector<ReplayConsumerStats> consumerStats() const;
+
+    static uint32_t cfgFramePeriodUs(const std::string &cfgText);
+
+private:
+    struct Consumer
+    {
+        std::string             name;
+        FrameFn                 fn;
+        std::thread             thread;
+        mutable std::mutex      lock;
+        std::condition_variable cv;
+        std::deque<ReplayFrame> queue;
+        bool                    done = false;
+        ReplayConsumerStats     st;
+    };
+
+    uint64_t mediaDeltaNs(size_t prev, size_t cur) const;
+    bool dispatch(Consumer &c, const ReplayFrame &frame);
+    void pacingLoop();
+    void consumerLoop(Consumer *c);
+
+    const CaptureFile       *m_capture = nullptr;
+    ReplayConfig            m_cfg;
+    size_t                  m_end = 0;
+    std::vector<std::unique_ptr<Consumer>> m_consumers;
+    std::thread             m_thread;
+    std::atomic<bool>       m_running{false};
+    std::atomic<bool>       m_stop{false};
+
+    mutable std::mutex      m_lock;
+    std::condition_variable m_doneCv;
+    size_t                  m_seekTo = SIZE_MAX;
+    double                  m_speed = 1.0;
+    bool                    m_reanchor = false;
+    ReplayStats             m_stats;
+};
+
+} /* namespace mmw */
+
+#endif /* REPLAY_H */
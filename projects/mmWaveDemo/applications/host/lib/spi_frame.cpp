@@ -0,0 +1,126 @@
+/**
+ *   @file  spi_frame.cpp
+ *
+ *   @brief
+ *      SPI frame reassembly, see board/common/mmw_spi_frame.h for the format.
+ */
+#include <utility>
+
+#include "mmw_wire.h"
+#include "spi_frame.h"
+
+namespace mmw
+{
+
+SpiDeframer::SpiDeframer(PacketFn fn)
+    : m_fn(std::move(fn))
+{
+    m_packet.reserve(64 * 1024);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Forgets the packet in progress and the sequence, e.g. after the link
+ *      was reopened. The counters are kept.
+ */
+void SpiDeframer::reset()
+{
+    m_packet.clear();
+    m_inPacket = false;
+    m_haveSeq = false;
+}
+
+void SpiDeframer::drop()
+{
+    if (m_inPacket)
+    {
+        m_stats.droppedPackets++;
+    }
+    m_packet.clear();
+    m_inPacket = false;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Checks a frame and adds it to the packet in progress.
+ *
+ *  @param[in]  frame
+ *      MMW_SPI_FRAME_SIZE bytes
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   MMW_SPI_FRAME_ESYNC, MMW_SPI_FRAME_ELENGTH or MMW_SPI_FRAME_ECRC
+ */
+int SpiDeframer::push(const uint8_t *frame)
+{
+    MmwDemo_spiFrameHdr hdr;
+    const int32_t err = MmwDemo_spiFrameCheck(frame, &hdr);
+
+    if (err != 0)
+    {
+        switch (err)
+        {
+        case MMW_SPI_FRAME_ESYNC:   m_stats.syncErrors++; break;
+        case MMW_SPI_FRAME_ELENGTH: m_stats.lengthErrors++; break;
+        default:                    m_stats.crcErrors++; break;
+        }
+        /* The sequence number of a bad frame can't be trusted, but it
+         * still took one slot: the master clocks one frame per ready */
+        if (m_haveSeq)
+        {
+            m_nextSeq++;
+        }
+        drop();
+        return err;
+    }
+
+    if (m_haveSeq && (hdr.seq != m_nextSeq))
+    {
+        /* A step back means the MSS restarted, not a loss; either way the
+         * packet in progress can't be completed */
+        const uint32_t gap = hdr.seq - m_nextSeq;
+        if (gap < 0x80000000U)
+        {
+            m_stats.lostFrames += gap;
+        }
+        drop();
+    }
+    m_haveSeq = true;
+    m_nextSeq = hdr.seq + 1U;
+    m_stats.frames++;
+    m_stats.payloadBytes += hdr.length;
+
+    if (hdr.flags & MMW_SPI_FRAME_FLAG_START)
+    {
+        drop();
+        m_inPacket = true;
+    }
+    if (!m_inPacket)
+    {
+        /* Tail of a packet whose start was lost */
+        return 0;
+    }
+
+    m_packet.insert(m_packet.end(), frame + sizeof(hdr), frame + sizeof(hdr) + hdr.length);
+    if (hdr.flags & MMW_SPI_FRAME_FLAG_END)
+    {
+        if ((m_packet.size() < sizeof(MsgHeader)) ||
+            (load<MsgHeader>(m_packet.data()).totalPacketLen != m_packet.size()))
+        {
+            m_stats.badPackets++;
+        }
+        else
+        {
+            m_stats.packets++;
+            m_fn(m_packet.data(), m_packet.size());
+        }
+        m_packet.clear();
+        m_inPacket = false;
+    }
+    return 0;
+}
+
+} /* namespace mmw */
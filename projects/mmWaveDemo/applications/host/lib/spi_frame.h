@@ -0,0 +1,91 @@
+/**
+ *   @file  spi_frame.h
+ *
+ *   @brief
+ *      Reassembly of the output packets sent in SPI frames by the MSS
+ *      (see board/common/mmw_spi_frame.h).
+ */
+#ifndef SPI_FRAME_H
+#define SPI_FRAME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "mmw_spi_frame.h"
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  SPI link counters
+ */
+struct SpiLinkStats
+{
+    /*! @brief   Frames which passed the checks */
+    uint64_t    frames = 0;
+
+    /*! @brief   Payload bytes of those frames */
+    uint64_t    payloadBytes = 0;
+
+    /*! @brief   Output packets delivered */
+    uint64_t    packets = 0;
+
+    /*! @brief   Frames without the sync word */
+    uint64_t    syncErrors = 0;
+
+    /*! @brief   Frames with an impossible length */
+    uint64_t    lengthErrors = 0;
+
+    /*! @brief   Frames failing the CRC */
+    uint64_t    crcErrors = 0;
+
+    /*! @brief   Frames missing from the sequence, i.e. never clocked */
+    uint64_t    lostFrames = 0;
+
+    /*! @brief   Packets dropped because a frame was bad or missing */
+    uint64_t    droppedPackets = 0;
+
+    /*! @brief   Reassembled packets whose header disagrees with their length */
+    uint64_t    badPackets = 0;
+};
+
+/**
+ * @brief
+ *  Output packet reassembly from SPI frames
+ *
+ * @details
+ *  Frames are pushed one at a time, exactly as clocked from the slave.
+ *  Complete packets are passed to the callback with the bytes the UART
+ *  path would have sent (header, TLVs, padding); the buffer is only valid
+ *  during the call. A packet with a bad or missing frame is dropped as a
+ *  whole and reassembly restarts at the next MMW_SPI_FRAME_FLAG_START.
+ */
+class SpiDeframer
+{
+public:
+    using PacketFn = std::function<void(const uint8_t *packet, size_t len)>;
+
+    explicit SpiDeframer(PacketFn fn);
+
+    int push(const uint8_t *frame);
+    void reset();
+
+    const SpiLinkStats &stats() const { return m_stats; }
+
+private:
+    void drop();
+
+    PacketFn                m_fn;
+    std::vector<uint8_t>    m_packet;
+    bool                    m_inPacket = false;
+    bool                    m_haveSeq = false;
+    uint32_t                m_nextSeq = 0;
+    SpiLinkStats            m_stats;
+};
+
+} /* namespace mmw */
+
+#endif /* SPI_FRAME_H */
@@ -0,0 +1,352 @@
+/**
+ *   @file  spi_reader.cpp
+ *
+ *   @brief
+ *      FT232H SPI reader, see spi_reader.h.
+ */
+#include <chrono>
+#include <cstring>
+#include <mutex>
+
+#include "libMPSSE_spi.h"
+#include "spi_reader.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+/* MMW_SPI_FRAME_SYNC as it appears on the wire */
+const uint8_t SYNC_BYTES[4] = { 0x6D, 0x6D, 0x57, 0x46 };
+
+std::once_flag gMpsseInit;
+
+} /* anonymous namespace */
+
+SpiReader::~SpiReader()
+{
+    close();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Opens and configures the channel and allocates the ring.
+ *
+ *  @param[in]  cfg
+ *      Reader configuration
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int SpiReader::open(const SpiReaderConfig &cfg)
+{
+    if ((m_handle != nullptr) || (cfg.spiMode > 3U) || (cfg.chunkSize == 0U))
+    {
+        return -1;
+    }
+    m_cfg = cfg;
+    if (m_cfg.readyMask != 0U)
+    {
+        m_cfg.chunkSize = MMW_SPI_FRAME_SIZE;
+    }
+    if ((m_ring.capacity() == 0U) && (m_ring.create(m_cfg.ringSize) < 0))
+    {
+        return -1;
+    }
+    if (m_ring.capacity() < 2U * (m_cfg.chunkSize + MMW_SPI_FRAME_SIZE))
+    {
+        return -1;
+    }
+
+    std::call_once(gMpsseInit, [] { Init_libMPSSE(); });
+
+    uint32 numChannels = 0;
+    if ((SPI_GetNumChannels(&numChannels) != FT_OK) || (m_cfg.channel >= numChannels))
+    {
+        return -1;
+    }
+
+    FT_HANDLE handle = nullptr;
+    if (SPI_OpenChannel(m_cfg.channel, &handle) != FT_OK)
+    {
+        return -1;
+    }
+
+    ChannelConfig chanCfg;
+    std::memset(&chanCfg, 0, sizeof(chanCfg));
+    chanCfg.ClockRate = m_cfg.clockHz;
+    chanCfg.LatencyTimer = m_cfg.latencyTimer;
+    chanCfg.configOptions = m_cfg.spiMode | SPI_CONFIG_OPTION_CS_DBUS3 | SPI_CONFIG_OPTION_CS_ACTIVELOW;
+    chanCfg.Pin = 0;
+    if (SPI_InitChannel(handle, &chanCfg) != FT_OK)
+    {
+        SPI_CloseChannel(handle);
+        return -1;
+    }
+    m_handle = handle;
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Starts the I/O thread. Anything left in the ring from an earlier run
+ *      is dropped, so no frame may be held.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int SpiReader::start()
+{
+    if ((m_handle == nullptr) || m_thread.joinable() || (m_held != 0U))
+    {
+        return -1;
+    }
+    m_ring.reopen();
+    m_scanPos = m_ring.written();
+    m_haveSeq = false;
+    m_run.store(true);
+    m_thread = std::thread(&SpiReader::ioLoop, this);
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Stops the I/O thread after the transfer in progress. Frames already
+ *      in the ring can still be taken with next().
+ */
+void SpiReader::stop()
+{
+    m_run.store(false);
+    m_ring.close();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Stops the reader and closes the channel.
+ */
+void SpiReader::close()
+{
+    stop();
+    if (m_handle != nullptr)
+    {
+        SPI_CloseChannel(m_handle);
+        m_handle = nullptr;
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Waits for the ready GPIO.
+ *
+ *  @retval
+ *      true once ready is high, false if the reader is stopping
+ */
+bool SpiReader::waitReady()
+{
+    while (m_run.load(std::memory_order_relaxed))
+    {
+        uint8 value = 0;
+        if (FT_ReadGPIO(m_handle, &value) != FT_OK)
+        {
+            m_ioErrors.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        if ((value & m_cfg.readyMask) != 0U)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      I/O thread: clocks chunks straight into the ring. Each transfer is
+ *      framed by chip select, the MSS slave does not care where transfers
+ *      start as long as the master keeps clocking.
+ */
+void SpiReader::ioLoop()
+{
+    const uint32 options = SPI_TRANSFER_OPTIONS_SIZE_IN_BYTES | SPI_TRANSFER_OPTIONS_CHIPSELECT_ENABLE |
+                           SPI_TRANSFER_OPTIONS_CHIPSELECT_DISABLE;
+    const size_t chunk = m_cfg.chunkSize;
+
+    while (m_run.load(std::memory_order_relaxed))
+    {
+        size_t space;
+        m_ring.writePtr(space);
+        if (space < chunk)
+        {
+            m_ringFullWaits.fetch_add(1, std::memory_order_relaxed);
+            if (!m_ring.waitWritable(chunk))
+            {
+                break;
+            }
+        }
+        if ((m_cfg.readyMask != 0U) && !waitReady())
+        {
+            break;
+        }
+
+        uint8_t *dst = m_ring.writePtr(space);
+        uint32 transferred = 0;
+        const FT_STATUS status = SPI_Read(m_handle, dst, (uint32)chunk, &transferred, options);
+        m_transfers.fetch_add(1, std::memory_order_relaxed);
+        if (transferred > 0U)
+        {
+            m_ring.commit(transferred);
+            m_bytesRead.fetch_add(transferred, std::memory_order_relaxed);
+        }
+        if (status != FT_OK)
+        {
+            m_ioErrors.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Returns the next valid frame. Bytes in front of the sync word are
+ *      skipped; a sync word whose frame fails the checks is skipped by one
+ *      byte, so a false sync inside a payload costs nothing but a search.
+ *
+ *  @param[out] frame
+ *      The frame, valid until release()
+ *  @param[in]  timeoutMs
+ *      Longest wait for data
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, no frame before the timeout or the reader stopped
+ */
+int SpiReader::next(SpiFrameRef &frame, int timeoutMs)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    auto skip = [this](size_t n)
+    {
+        m_scanPos += n;
+        m_skippedBytes.fetch_add(n, std::memory_order_relaxed);
+        if (m_held == 0U)
+        {
+            m_ring.consumeTo(m_scanPos);
+        }
+    };
+
+    while (true)
+    {
+        const size_t avail = (size_t)(m_ring.written() - m_scanPos);
+        if (avail >= MMW_SPI_FRAME_SIZE)
+        {
+            /* Only look where a whole frame would already be in the ring;
+             * the mirror keeps the search range contiguous */
+            const uint8_t *p = m_ring.at(m_scanPos);
+            const size_t span = avail - MMW_SPI_FRAME_SIZE + sizeof(SYNC_BYTES);
+            const uint8_t *hit = (const uint8_t *)memmem(p, span, SYNC_BYTES, sizeof(SYNC_BYTES));
+            if (hit == nullptr)
+            {
+                skip(span - (sizeof(SYNC_BYTES) - 1U));
+                continue;
+            }
+            if (hit != p)
+            {
+                skip((size_t)(hit - p));
+            }
+
+            MmwDemo_spiFrameHdr hdr;
+            if (MmwDemo_spiFrameCheck(hit, &hdr) != 0)
+            {
+                m_crcErrors.fetch_add(1, std::memory_order_relaxed);
+                skip(1);
+                continue;
+            }
+
+            if (m_haveSeq && (hdr.seq != m_nextSeq))
+            {
+                /* A step back means the MSS restarted, not a loss */
+                const uint32_t gap = hdr.seq - m_nextSeq;
+                if (gap < 0x80000000U)
+                {
+                    m_lostFrames.fetch_add(gap, std::memory_order_relaxed);
+                }
+            }
+            m_haveSeq = true;
+            m_nextSeq = hdr.seq + 1U;
+
+            frame.data = hit;
+            frame.hdr = hdr;
+            frame.pos = m_scanPos;
+            m_scanPos += MMW_SPI_FRAME_SIZE;
+            m_held++;
+            m_frames.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if ((left <= 0) || (m_ring.closed() && (m_ring.written() - m_scanPos < MMW_SPI_FRAME_SIZE)))
+        {
+            return -1;
+        }
+        m_ring.waitReadable(m_scanPos, MMW_SPI_FRAME_SIZE, (int)left);
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Gives a frame back to the I/O thread.
+ *
+ *  @param[in]  frame
+ *      The oldest frame still held
+ */
+void SpiReader::release(const SpiFrameRef &frame)
+{
+    if (m_held == 0U)
+    {
+        return;
+    }
+    m_held--;
+    m_ring.consumeTo((m_held == 0U) ? m_scanPos : frame.pos + MMW_SPI_FRAME_SIZE);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Snapshot of the counters, safe from any thread.
+ */
+SpiReaderStats SpiReader::stats() const
+{
+    SpiReaderStats st;
+
+    st.bytesRead = m_bytesRead.load(std::memory_order_relaxed);
+    st.transfers = m_transfers.load(std::memory_order_relaxed);
+    st.frames = m_frames.load(std::memory_order_relaxed);
+    st.skippedBytes = m_skippedBytes.load(std::memory_order_relaxed);
+    st.crcErrors = m_crcErrors.load(std::memory_order_relaxed);
+    st.lostFrames = m_lostFrames.load(std::memory_order_relaxed);
+    st.ioErrors = m_ioErrors.load(std::memory_order_relaxed);
+    st.ringFullWaits = m_ringFullWaits.load(std::memory_order_relaxed);
+    return st;
+}
+
+} /* namespace mmw */
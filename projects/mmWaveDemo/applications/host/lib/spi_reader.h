@@ -0,0 +1,163 @@
+/**
+ *   @file  spi_reader.h
+ *
+ *   @brief
+ *      SPI master for the MSS output stream on an FT232H through libMPSSE
+ *      (../ftdi_driver/SPI/libMPSSE_spi.h).
+ */
+#ifndef SPI_READER_H
+#define SPI_READER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "byte_ring.h"
+#include "mmw_spi_frame.h"
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  Reader configuration
+ */
+struct SpiReaderConfig
+{
+    /*! @brief   libMPSSE channel index */
+    uint32_t    channel = 0;
+
+    /*! @brief   SPI clock, the FT232H tops out at 30 MHz */
+    uint32_t    clockHz = 20000000;
+
+    /*! @brief   FTDI latency timer in ms */
+    uint8_t     latencyTimer = 1;
+
+    /*! @brief   SPI mode, the MSS slave runs CPOL 0, CPHA 1 */
+    uint32_t    spiMode = 1;
+
+    /*! @brief   Bytes clocked per SPI_Read. Larger transfers keep the USB
+     *           bulk pipe full; a multiple of the 510 byte USB payload
+     *           avoids waiting for the latency timer on a short last
+     *           packet. Ignored with readyMask */
+    uint32_t    chunkSize = 128U * 510U;
+
+    /*! @brief   Ring buffer size, a power of two */
+    size_t      ringSize = 8U * 1024U * 1024U;
+
+    /*! @brief   ACBUS bit(s) wired to the MSS ready GPIO. 0 clocks
+     *           continuously and relies on resynchronization, otherwise one
+     *           frame is clocked per ready level */
+    uint8_t     readyMask = 0;
+};
+
+/**
+ * @brief
+ *  Reader counters
+ */
+struct SpiReaderStats
+{
+    /*! @brief   Bytes clocked in */
+    uint64_t    bytesRead = 0;
+
+    /*! @brief   SPI_Read calls */
+    uint64_t    transfers = 0;
+
+    /*! @brief   Valid frames handed out */
+    uint64_t    frames = 0;
+
+    /*! @brief   Bytes outside valid frames: idle clocks and garbage */
+    uint64_t    skippedBytes = 0;
+
+    /*! @brief   Sync words whose frame failed the length or CRC check */
+    uint64_t    crcErrors = 0;
+
+    /*! @brief   Gaps in the frame sequence */
+    uint64_t    lostFrames = 0;
+
+    /*! @brief   Failed libMPSSE calls */
+    uint64_t    ioErrors = 0;
+
+    /*! @brief   Times the I/O thread had to wait for the consumer */
+    uint64_t    ringFullWaits = 0;
+};
+
+/**
+ * @brief
+ *  Frame handed out by SpiReader::next
+ */
+struct SpiFrameRef
+{
+    /*! @brief   MMW_SPI_FRAME_SIZE bytes inside the ring */
+    const uint8_t       *data = nullptr;
+
+    /*! @brief   Checked header */
+    MmwDemo_spiFrameHdr hdr;
+
+    /*! @brief   Stream position of the frame */
+    uint64_t            pos = 0;
+};
+
+/**
+ * @brief
+ *  FT232H SPI reader
+ *
+ * @details
+ *  An I/O thread clocks large transfers straight into a mirrored ring
+ *  buffer allocated once at open(). The consumer calls next(), which finds
+ *  the sync word, checks the frame and returns a pointer into the ring, so
+ *  a frame is never copied. The frame stays valid until it is released;
+ *  frames have to be released in the order they were returned, and the
+ *  I/O thread stalls once the consumer holds the whole ring.
+ *
+ *  next() and release() are called from one consumer thread.
+ */
+class SpiReader
+{
+public:
+    SpiReader() = default;
+    ~SpiReader();
+
+    SpiReader(const SpiReader &) = delete;
+    SpiReader &operator=(const SpiReader &) = delete;
+
+    int open(const SpiReaderConfig &cfg);
+    int start();
+    void stop();
+    void close();
+
+    int next(SpiFrameRef &frame, int timeoutMs);
+    void release(const SpiFrameRef &frame);
+
+    SpiReaderStats stats() const;
+
+private:
+    void ioLoop();
+    bool waitReady();
+
+    SpiReaderConfig         m_cfg;
+    void                    *m_handle = nullptr;
+    ByteRing                m_ring;
+    std::thread             m_thread;
+    std::atomic<bool>       m_run{false};
+
+    /* Consumer side */
+    uint64_t                m_scanPos = 0;
+    uint32_t                m_held = 0;
+    bool                    m_haveSeq = false;
+    uint32_t                m_nextSeq = 0;
+
+    std::atomic<uint64_t>   m_bytesRead{0};
+    std::atomic<uint64_t>   m_transfers{0};
+    std::atomic<uint64_t>   m_frames{0};
+    std::atomic<uint64_t>   m_skippedBytes{0};
+    std::atomic<uint64_t>   m_crcErrors{0};
+    std::atomic<uint64_t>   m_lostFrames{0};
+    std::atomic<uint64_t>   m_ioErrors{0};
+    std::atomic<uint64_t>   m_ringFullWaits{0};
+};
+
+} /* namespace mmw */
+
+#endif /* SPI_READER_H */
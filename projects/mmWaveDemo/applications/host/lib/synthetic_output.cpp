@@ -0,0 +1,397 @@
+/**
+ *   @file  synthetic_output.cpp
+ *
+ *   @brief
+ *      Synthetic mmw demo output packets.
+ */
+#include <cstring>
+#include <random>
+
+#include "crc32c.h"
+#include "synthetic_output.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+const uint8_t PADDING[MSG_SEGMENT_LEN] = { 0 };
+
+/* Output scheduler items, in the priorities of MmwDemo_dssOutputSchedule */
+struct SchedSlot
+{
+    uint32_t    type;
+    bool        isMandatory;
+    uint8_t     priority;
+};
+
+const SchedSlot SCHED_SLOTS[] =
+{
+    { TLV_DETECTED_POINTS,          true,  0 },
+    { TLV_STATS,                    true,  0 },
+    { TLV_DSS_STATS,                true,  0 },
+    { TLV_OUTPUT_SHED,              true,  0 },
+    { TLV_QUIET,                    true,  0 },
+    { TLV_RANGE_PROFILE,            false, 0 },
+    { TLV_AZIMUTH_STATIC_HEAT_MAP,  false, 5 },
+    { TLV_RANGE_DOPPLER_HEAT_MAP,   false, 6 },
+};
+
+const uint32_t NUM_SCHED_SLOTS = sizeof(SCHED_SLOTS) / sizeof(SCHED_SLOTS[0]);
+
+/*! @brief   TLV slots of the DSS message, MMWDEMO_OUTPUT_MSG_MAX */
+const uint32_t MSG_MAX_TLVS = 7;
+
+/*! @brief   Range profile change counted as new by the emulated quiet
+ *           mode; the still profile moves by less */
+const uint16_t QUIET_THRESHOLD = 64;
+
+} /* anonymous namespace */
+
+SyntheticOutput::SyntheticOutput(const SyntheticOutputConfig &cfg)
+    : m_cfg(cfg)
+{
+    std::memset(&m_hdr, 0, sizeof(m_hdr));
+    std::memset(&m_dss, 0, sizeof(m_dss));
+    std::memset(&m_mss, 0, sizeof(m_mss));
+    std::memset(&m_shed, 0, sizeof(m_shed));
+    std::memset(&m_quietReport, 0, sizeof(m_quietReport));
+    MmwDemo_outputSchedInit(&m_sched);
+    m_sched.budgetBytes = cfg.budgetBytes;
+    MmwDemo_quietModeInit(&m_quiet, cfg.quietMode ? 1U : 0U, QUIET_THRESHOLD, cfg.quietKeepAliveFrames);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Objects of a frame, the first draw of its generator. In quiet mode
+ *      only a quietActivity share of the frames has any.
+ */
+uint32_t SyntheticOutput::numObjects(std::mt19937 &rng) const
+{
+    if (m_cfg.maxObjects == 0U)
+    {
+        return 0U;
+    }
+    const uint32_t draw = (uint32_t)rng();
+    if (!m_cfg.quietMode)
+    {
+        return draw % m_cfg.maxObjects;
+    }
+    const bool active = (double)(draw % 1000U) < m_cfg.quietActivity * 1000.0;
+    return active ? 1U + ((draw / 1000U) % m_cfg.maxObjects) : 0U;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Runs a frame through the emulated quiet mode. The range profile
+ *      is a fixed shape with noise below the threshold, so only the
+ *      objects and the keep-alive make frames go out.
+ *
+ *  @retval
+ *      MMW_QUIET_MODE_xxx
+ */
+uint32_t SyntheticOutput::quietDecision(uint32_t frameNumber, uint32_t numObj)
+{
+    std::mt19937 noise(frameNumber ^ 0x5A5A5A5AU);
+    m_rangeProfile.resize(m_cfg.numRangeBins);
+    for (uint32_t i = 0; i < m_cfg.numRangeBins; i++)
+    {
+        m_rangeProfile[i] = (uint16_t)(4096U + ((i * 2654435761U) >> 22) + (noise() % (QUIET_THRESHOLD / 2U)));
+    }
+    return MmwDemo_quietModeDecide(&m_quiet, numObj, m_rangeProfile.data(), 1U, m_cfg.numRangeBins);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Leaves out of m_tl what the DSS output scheduler would shed under
+ *      the configured budget, and adds the shed report.
+ */
+void SyntheticOutput::schedule()
+{
+    MmwDemo_outputSchedItem items[NUM_SCHED_SLOTS];
+    MmwDemo_outputSchedResult result;
+
+    /* The CRC the MSS appends to every packet */
+    uint32_t extraLen = m_cfg.packetCrc ? (uint32_t)(sizeof(TlvHeader) + sizeof(PacketCrc)) : 0U;
+
+    std::memset(items, 0, sizeof(items));
+    for (uint32_t i = 0; i < NUM_SCHED_SLOTS; i++)
+    {
+        items[i].type = SCHED_SLOTS[i].type;
+        items[i].isMandatory = SCHED_SLOTS[i].isMandatory ? 1U : 0U;
+        items[i].priority = SCHED_SLOTS[i].priority;
+        if (items[i].type == TLV_OUTPUT_SHED)
+        {
+            /* Room for the report is kept whenever there is a budget */
+            items[i].length = sizeof(OutputShed);
+        }
+    }
+    for (const TlvHeader &tl : m_tl)
+    {
+        if (tl.type == TLV_MSS_STATS)
+        {
+            extraLen += sizeof(TlvHeader) + tl.length;
+        }
+        for (uint32_t i = 0; i < NUM_SCHED_SLOTS; i++)
+        {
+            if (tl.type == items[i].type)
+            {
+                items[i].length = tl.length;
+            }
+        }
+    }
+
+    MmwDemo_outputSchedRun(&m_sched, items, NUM_SCHED_SLOTS, MSG_MAX_TLVS, extraLen, &result);
+
+    std::vector<TlvHeader> kept;
+    bool shedPending = (result.shedMask != 0U);
+    for (const TlvHeader &tl : m_tl)
+    {
+        bool send = (tl.type == TLV_MSS_STATS);
+        for (uint32_t i = 0; i < NUM_SCHED_SLOTS; i++)
+        {
+            send = send || ((tl.type == items[i].type) && ((result.sendMask & (1UL << i)) != 0U));
+        }
+        if (shedPending && ((tl.type == TLV_QUIET) || (tl.type == TLV_MSS_STATS)))
+        {
+            /* The report goes before the quiet report and the counters
+             * the MSS appends */
+            kept.push_back({ TLV_OUTPUT_SHED, sizeof(OutputShed) });
+            shedPending = false;
+        }
+        if (send)
+        {
+            kept.push_back(tl);
+        }
+    }
+    if (shedPending)
+    {
+        kept.push_back({ TLV_OUTPUT_SHED, sizeof(OutputShed) });
+    }
+    m_tl.swap(kept);
+
+    m_shed.shedMask = result.shedMask;
+    m_shed.budgetBytes = m_sched.budgetBytes;
+    m_shed.packetLen = result.packetLen;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Builds the packet of a frame: detected points, range profile, the
+ *      optional heat maps and stats, all filled with pseudo random bytes
+ *      seeded by the frame number, then padded as the DSS pads. The device
+ *      counters, when due, are the real counts of the emulation. With a
+ *      budget, the TLVs go through the output scheduler as on the DSS. In
+ *      quiet mode the frame may be suppressed or sent as a heartbeat. The
+ *      packet CRC goes last, as the MSS appends it.
+ *
+ *  @param[in]  frameNumber
+ *      Frame number of the header and seed of the content
+ *
+ *  @retval
+ *      true when there is a packet to send, false when the quiet mode
+ *      suppressed the frame
+ */
+bool SyntheticOutput::build(uint32_t frameNumber)
+{
+    std::mt19937 rng(frameNumber);
+    const uint32_t numObj = numObjects(rng);
+
+    m_tl.clear();
+    m_payload.clear();
+    m_segs.clear();
+    m_dss.frameStartIntCounter = frameNumber;
+    m_dss.chirpIntCounter = frameNumber * 128U;
+
+    const uint32_t decision = quietDecision(frameNumber, numObj);
+    if (decision == MMW_QUIET_MODE_SUPPRESS)
+    {
+        m_hdr.totalPacketLen = 0;
+        return false;
+    }
+    const bool heartbeat = (decision == MMW_QUIET_MODE_SEND_HEARTBEAT);
+
+    if (heartbeat)
+    {
+        /* Nothing but the quiet report and the counters */
+    }
+    else if (numObj > 0U)
+    {
+        /* Left out of frames without objects, as on the device */
+        m_tl.push_back({ TLV_DETECTED_POINTS, (uint32_t)(sizeof(DetObjDescr) + numObj * sizeof(DetObj)) });
+    }
+    if (!heartbeat)
+    {
+        m_tl.push_back({ TLV_RANGE_PROFILE, (uint32_t)(m_cfg.numRangeBins * sizeof(uint16_t)) });
+        if (m_cfg.heatMap)
+        {
+            m_tl.push_back({ TLV_RANGE_DOPPLER_HEAT_MAP,
+                             (uint32_t)(m_cfg.numRangeBins * m_cfg.numDopplerBins * sizeof(uint16_t)) });
+        }
+        if (m_cfg.numVirtualAnt > 0U)
+        {
+            m_tl.push_back({ TLV_AZIMUTH_STATIC_HEAT_MAP,
+                             (uint32_t)(m_cfg.numRangeBins * m_cfg.numVirtualAnt * sizeof(Cmplx16ImRe)) });
+        }
+        m_tl.push_back({ TLV_STATS, sizeof(Stats) });
+    }
+
+    /* Same schedule as MmwDemo_dssSendProcessOutputToMSS */
+    const bool deviceStats = (m_cfg.deviceStatsPeriod > 0U) &&
+                             (frameNumber - m_deviceStatsFrame >= m_cfg.deviceStatsPeriod);
+    if (deviceStats)
+    {
+        m_tl.push_back({ TLV_DSS_STATS, sizeof(DssStats) });
+    }
+    if (m_cfg.quietMode)
+    {
+        m_tl.push_back({ TLV_QUIET, sizeof(QuietReport) });
+        MmwDemo_quietModeReport(&m_quiet, decision, &m_quietReport);
+    }
+    if (deviceStats)
+    {
+        m_tl.push_back({ TLV_MSS_STATS, sizeof(MssStats) });
+        m_deviceStatsFrame = frameNumber;
+    }
+    if (m_sched.budgetBytes > 0U)
+    {
+        schedule();
+    }
+    if (m_cfg.packetCrc)
+    {
+        m_tl.push_back({ TLV_PACKET_CRC, sizeof(PacketCrc) });
+    }
+
+    uint32_t totalPacketLen = sizeof(MsgHeader);
+    for (const TlvHeader &tl : m_tl)
+    {
+        std::vector<uint8_t> data(tl.length);
+        for (uint8_t &b : data)
+        {
+            b = (uint8_t)rng();
+        }
+        if (tl.type == TLV_DETECTED_POINTS)
+        {
+            /* A real descriptor, the parsers check it against the length */
+            const DetObjDescr descr = { (uint16_t)numObj, 7 };
+            std::memcpy(data.data(), &descr, sizeof(descr));
+        }
+        else if (tl.type == TLV_DSS_STATS)
+        {
+            std::memcpy(data.data(), &m_dss, sizeof(m_dss));
+        }
+        else if (tl.type == TLV_MSS_STATS)
+        {
+            std::memcpy(data.data(), &m_mss, sizeof(m_mss));
+        }
+        else if (tl.type == TLV_OUTPUT_SHED)
+        {
+            std::memcpy(data.data(), &m_shed, sizeof(m_shed));
+        }
+        else if (tl.type == TLV_QUIET)
+        {
+            std::memcpy(data.data(), &m_quietReport, sizeof(m_quietReport));
+        }
+        else if (tl.type == TLV_PACKET_CRC)
+        {
+            /* Filled in once the header is final */
+            std::memset(data.data(), 0, sizeof(PacketCrc));
+        }
+        else if ((tl.type == TLV_RANGE_PROFILE) && m_cfg.quietMode)
+        {
+            /* The profile the quiet mode compared */
+            std::memcpy(data.data(), m_rangeProfile.data(), tl.length);
+        }
+        m_payload.push_back(std::move(data));
+        totalPacketLen += sizeof(TlvHeader) + tl.length;
+    }
+    const uint32_t numPadding = (MSG_SEGMENT_LEN - (totalPacketLen % MSG_SEGMENT_LEN)) % MSG_SEGMENT_LEN;
+
+    std::memcpy(m_hdr.magicWord, MAGIC_WORD, sizeof(MAGIC_WORD));
+    m_hdr.version = 0x01000000;
+    m_hdr.totalPacketLen = totalPacketLen + numPadding;
+    m_hdr.platform = 0xA1642;
+    m_hdr.frameNumber = frameNumber;
+    m_hdr.timeCpuCycles = 0;
+    m_hdr.numDetectedObj = numObj;
+    m_hdr.numTLVs = (uint32_t)m_tl.size();
+
+    /* Same pieces as MmwDemo_spiOutputSegments */
+    m_segs.push_back({ (const uint8_t *)&m_hdr, sizeof(m_hdr) });
+    for (size_t i = 0; i < m_tl.size(); i++)
+    {
+        m_segs.push_back({ (const uint8_t *)&m_tl[i], sizeof(TlvHeader) });
+        m_segs.push_back({ m_payload[i].data(), (uint32_t)m_payload[i].size() });
+    }
+    if (numPadding > 0)
+    {
+        m_segs.push_back({ PADDING, numPadding });
+    }
+    if (m_cfg.packetCrc)
+    {
+        /* Header and every TLV before the CRC TLV, the last one */
+        PacketCrc crc;
+        crc.crc = crc32c(MMW_CRC32C_INIT, (const uint8_t *)&m_hdr, sizeof(m_hdr));
+        for (size_t i = 0; i + 1U < m_tl.size(); i++)
+        {
+            crc.crc = crc32c(crc.crc, (const uint8_t *)&m_tl[i], sizeof(TlvHeader));
+            crc.crc = crc32c(crc.crc, m_payload[i].data(), m_payload[i].size());
+        }
+        std::memcpy(m_payload.back().data(), &crc, sizeof(crc));
+    }
+
+    /* The MSS counts a packet once it is sent */
+    m_mss.packetsSent++;
+    MmwDemo_quietModeSent(&m_quiet, decision, frameNumber, m_rangeProfile.data(), 1U, m_cfg.numRangeBins);
+    return true;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Counts a frame the emulated DSS did not send because the MSS was
+ *      still busy (detObjLoggingSkip). Its frame number is not built. In
+ *      quiet mode a frame the quiet mode suppresses is not a skip.
+ *
+ *  @param[in]  frameNumber
+ *      Frame number of the skipped frame
+ *
+ *  @retval
+ *      true when the frame counts as skipped, false when the quiet mode
+ *      suppressed it anyway
+ */
+bool SyntheticOutput::skip(uint32_t frameNumber)
+{
+    std::mt19937 rng(frameNumber);
+    const uint32_t numObj = numObjects(rng);
+
+    if (quietDecision(frameNumber, numObj) == MMW_QUIET_MODE_SUPPRESS)
+    {
+        return false;
+    }
+    m_dss.detObjLoggingSkip++;
+    return true;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      The packet as one buffer, as the UART would carry it.
+ */
+std::vector<uint8_t> SyntheticOutput::bytes() const
+{
+    std::vector<uint8_t> out;
+    out.reserve(m_hdr.totalPacketLen);
+    for (const MmwDemo_spiSegment &s : m_segs)
+    {
+        out.insert(out.end(), s.addr, s.addr + s.len);
+    }
+    return out;
+}
+
+} /* namespace mmw */
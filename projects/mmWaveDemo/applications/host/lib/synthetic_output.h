@@ -0,0 +1,124 @@
+/**
+ *   @file  synthetic_output.h
+ *
+ *   @brief
+ *      Synthetic mmw demo output packets for the link stand-ins, laid out
+ *      as the MSS holds them: header, TLV headers and payloads in separate
+ *      buffers, ready for the SPI framer.
+ */
+#ifndef SYNTHETIC_OUTPUT_H
+#define SYNTHETIC_OUTPUT_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "mmw_output_sched.h"
+#include "mmw_quiet_mode.h"
+#include "mmw_spi_frame.h"
+#include "mmw_wire.h"
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  Shape of the synthetic packets
+ */
+struct SyntheticOutputConfig
+{
+    /*! @brief   Detected objects are drawn from [0, maxObjects) */
+    uint32_t    maxObjects = 40;
+
+    /*! @brief   Range bins of the range profile and heat map */
+    uint32_t    numRangeBins = 256;
+
+    /*! @brief   Doppler bins of the heat map */
+    uint32_t    numDopplerBins = 32;
+
+    /*! @brief   Add a dense range/Doppler heat map TLV */
+    bool        heatMap = false;
+
+    /*! @brief   Virtual antennas of a static azimuth heat map TLV, 0 for
+     *           none */
+    uint32_t    numVirtualAnt = 0;
+
+    /*! @brief   Add the DSS and MSS counters every this many frames, as
+     *           statsInfo bit 1 does on the device; 0 for never */
+    uint32_t    deviceStatsPeriod = 0;
+
+    /*! @brief   Packet budget of the emulated output scheduler in bytes,
+     *           see MmwDemo_outputSchedBudget; 0 for none */
+    uint32_t    budgetBytes = 0;
+
+    /*! @brief   Run the frames through the quiet mode of the DSS
+     *           (mmw_quiet_mode.h): frames without objects get a still
+     *           range profile and are suppressed or sent as heartbeats */
+    bool        quietMode = false;
+
+    /*! @brief   Heartbeat interval of the quiet mode, 0 for none */
+    uint16_t    quietKeepAliveFrames = 0;
+
+    /*! @brief   Share of the frames with objects in quiet mode */
+    double      quietActivity = 0.1;
+
+    /*! @brief   End the packets with the CRC TLV, as the MSS does; false
+     *           for packets of firmware without it */
+    bool        packetCrc = true;
+};
+
+/**
+ * @brief
+ *  Synthetic output packet
+ *
+ * @details
+ *  build() gives the same bytes for the same frame number, so a receiver
+ *  can rebuild what it should have got. The segments point into the
+ *  object, which therefore can't be copied. In quiet mode the bytes also
+ *  depend on the frames before, through the quiet report.
+ */
+class SyntheticOutput
+{
+public:
+    explicit SyntheticOutput(const SyntheticOutputConfig &cfg = SyntheticOutputConfig());
+
+    SyntheticOutput(const SyntheticOutput &) = delete;
+    SyntheticOutput &operator=(const SyntheticOutput &) = delete;
+
+    bool build(uint32_t frameNumber);
+    bool skip(uint32_t frameNumber);
+
+    const MmwDemo_spiSegment *segments() const  { return m_segs.data(); }
+    uint32_t numSegments() const                { return (uint32_t)m_segs.size(); }
+    uint32_t size() const                       { return m_hdr.totalPacketLen; }
+    std::vector<uint8_t> bytes() const;
+
+private:
+    SyntheticOutputConfig               m_cfg;
+    MsgHeader                           m_hdr;
+    std::vector<TlvHeader>              m_tl;
+    std::vector<std::vector<uint8_t>>   m_payload;
+    std::vector<MmwDemo_spiSegment>     m_segs;
+
+    /* Emulated device counters */
+    DssStats                            m_dss;
+    MssStats                            m_mss;
+    uint32_t                            m_deviceStatsFrame = 0;
+
+    /* Emulated output scheduler */
+    MmwDemo_outputSched                 m_sched;
+    OutputShed                          m_shed;
+
+    /* Emulated quiet mode */
+    MmwDemo_quietMode                   m_quiet;
+    QuietReport                         m_quietReport;
+    std::vector<uint16_t>               m_rangeProfile;
+
+    void schedule();
+    uint32_t quietDecision(uint32_t frameNumber, uint32_t numObj);
+    uint32_t numObjects(std::mt19937 &rng) const;
+};
+
+} /* namespace mmw */
+
+#endif /* SYNTHETIC_OUTPUT_H */
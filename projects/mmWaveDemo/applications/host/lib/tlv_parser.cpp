@@ -0,0 +1,520 @@
+/**
+ *   @file  tlv_parser.cpp
+ *
+ *   @brief
+ *      Output packet parser, see tlv_parser.h.
+ */
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "crc32c.h"
+#include "tlv_parser.h"
+
+namespace mmw
+{
+
+namespace
+{
+
+/*
+ * The vector loops look for the first two magic bytes (02 01) at every
+ * offset of a block and confirm the candidates with a full compare; in
+ * anything but a stream of 0x02 bytes a candidate is rare.
+ */
+inline const uint8_t *confirm(const uint8_t *p, uint32_t mask)
+{
+    while (mask != 0U)
+    {
+        const uint32_t k = (uint32_t)__builtin_ctz(mask);
+        if (std::memcmp(p + k, MAGIC_WORD, sizeof(MAGIC_WORD)) == 0)
+        {
+            return p + k;
+        }
+        mask &= mask - 1U;
+    }
+    return nullptr;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+const uint8_t *findMagicSse2(const uint8_t *p, size_t n)
+{
+    const __m128i b0 = _mm_set1_epi8((char)MAGIC_WORD[0]);
+    const __m128i b1 = _mm_set1_epi8((char)MAGIC_WORD[1]);
+    size_t i = 0;
+
+    for (; i + 16U + sizeof(MAGIC_WORD) <= n; i += 16U)
+    {
+        const __m128i a = _mm_loadu_si128((const __m128i *)(p + i));
+        const __m128i b = _mm_loadu_si128((const __m128i *)(p + i + 1));
+        const uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, b0),
+                                                                        _mm_cmpeq_epi8(b, b1)));
+        const uint8_t *hit = confirm(p + i, mask);
+        if (hit != nullptr)
+        {
+            return hit;
+        }
+    }
+    return findMagicScalar(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+const uint8_t *findMagicAvx2(const uint8_t *p, size_t n)
+{
+    const __m256i b0 = _mm256_set1_epi8((char)MAGIC_WORD[0]);
+    const __m256i b1 = _mm256_set1_epi8((char)MAGIC_WORD[1]);
+    size_t i = 0;
+
+    for (; i + 32U + sizeof(MAGIC_WORD) <= n; i += 32U)
+    {
+        const __m256i a = _mm256_loadu_si256((const __m256i *)(p + i));
+        const __m256i b = _mm256_loadu_si256((const __m256i *)(p + i + 1));
+        const uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, b0),
+                                                                              _mm256_cmpeq_epi8(b, b1)));
+        const uint8_t *hit = confirm(p + i, mask);
+        if (hit != nullptr)
+        {
+            return hit;
+        }
+    }
+    return findMagicSse2(p + i, n - i);
+}
+
+using FindFn = const uint8_t *(*)(const uint8_t *, size_t);
+
+FindFn selectFind()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? findMagicAvx2 : findMagicSse2;
+}
+
+const FindFn gFind = selectFind();
+
+#elif defined(__aarch64__)
+
+const uint8_t *findMagicNeon(const uint8_t *p, size_t n)
+{
+    const uint8x16_t b0 = vdupq_n_u8(MAGIC_WORD[0]);
+    const uint8x16_t b1 = vdupq_n_u8(MAGIC_WORD[1]);
+    size_t i = 0;
+
+    for (; i + 16U + sizeof(MAGIC_WORD) <= n; i += 16U)
+    {
+        const uint8x16_t eq = vandq_u8(vceqq_u8(vld1q_u8(p + i), b0), vceqq_u8(vld1q_u8(p + i + 1), b1));
+
+        /* One nibble per byte */
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        while (mask != 0U)
+        {
+            const uint32_t k = (uint32_t)__builtin_ctzll(mask) / 4U;
+            if (std::memcmp(p + i + k, MAGIC_WORD, sizeof(MAGIC_WORD)) == 0)
+            {
+                return p + i + k;
+            }
+            mask &= ~(0xFULL << (k * 4U));
+        }
+    }
+    return findMagicScalar(p + i, n - i);
+}
+
+#endif
+
+inline uint32_t maskBit(uint32_t type)
+{
+    if (type < 16U)
+    {
+        return 1U << type;
+    }
+    if ((type >= MMWDEMO_OUTPUT_EXT_MSG_BASE) && (type < MMWDEMO_OUTPUT_EXT_MSG_BASE + 16U))
+    {
+        return 1U << (16U + type - MMWDEMO_OUTPUT_EXT_MSG_BASE);
+    }
+    return 0U;
+}
+
+} /* anonymous namespace */
+
+/**
+ *  @b Description
+ *  @n
+ *      Portable magic word search, the reference for the vector versions.
+ *
+ *  @retval
+ *      First magic word wholly inside [p, p + n), or nullptr
+ */
+const uint8_t *findMagicScalar(const uint8_t *p, size_t n)
+{
+    const uint8_t *end = p + n;
+
+    while ((size_t)(end - p) >= sizeof(MAGIC_WORD))
+    {
+        const uint8_t *c = (const uint8_t *)memchr(p, MAGIC_WORD[0], (size_t)(end - p) - (sizeof(MAGIC_WORD) - 1U));
+        if (c == nullptr)
+        {
+            return nullptr;
+        }
+        if (std::memcmp(c, MAGIC_WORD, sizeof(MAGIC_WORD)) == 0)
+        {
+            return c;
+        }
+        p = c + 1;
+    }
+    return nullptr;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Magic word search with the widest vectors the CPU has: AVX2 or SSE2
+ *      on x86, NEON on ARMv8, chosen once at load time.
+ *
+ *  @retval
+ *      First magic word wholly inside [p, p + n), or nullptr
+ */
+const uint8_t *findMagic(const uint8_t *p, size_t n)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return gFind(p, n);
+#elif defined(__aarch64__)
+    return findMagicNeon(p, n);
+#else
+    return findMagicScalar(p, n);
+#endif
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Looks up a TLV by type.
+ *
+ *  @retval
+ *      The first TLV of that type, or nullptr
+ */
+const TlvRef *FrameView::find(uint32_t type) const
+{
+    for (uint32_t i = 0; i < numTlvs; i++)
+    {
+        if (tlvs[i].type == type)
+        {
+            return &tlvs[i];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Parses and validates the packet at p: magic word, SDK major version,
+ *      totalPacketLen, numTLVs, TLVs inside the packet with nothing but
+ *      padding behind them, the TLV lengths against the layouts of
+ *      mmw_tlv_schema.json (tlvValid) and the packet CRC as cfg.crc says.
+ *
+ *  @param[in]  p
+ *      Start of the packet
+ *  @param[in]  n
+ *      Bytes available from p
+ *  @param[in]  cfg
+ *      Limits
+ *  @param[out] frame
+ *      The packet, views into p
+ *
+ *  @retval
+ *      Success -   PARSE_OK
+ *  @retval
+ *      Error   -   ParseError; PARSE_TRUNCATED if the header checks out
+ *                  but n is short of totalPacketLen
+ */
+int parseFrame(const uint8_t *p, size_t n, const TlvParserConfig &cfg, FrameView &frame)
+{
+    if (n < sizeof(MsgHeader))
+    {
+        return ((n >= sizeof(MAGIC_WORD)) && (std::memcmp(p, MAGIC_WORD, sizeof(MAGIC_WORD)) != 0)) ?
+               PARSE_MAGIC : PARSE_TRUNCATED;
+    }
+    if (std::memcmp(p, MAGIC_WORD, sizeof(MAGIC_WORD)) != 0)
+    {
+        return PARSE_MAGIC;
+    }
+    const MsgHeader hdr = load<MsgHeader>(p);
+    if ((cfg.sdkMajor != 0U) && ((hdr.version >> 24) != cfg.sdkMajor))
+    {
+        return PARSE_VERSION;
+    }
+    if ((hdr.totalPacketLen < sizeof(MsgHeader)) || (hdr.totalPacketLen > cfg.maxPacketLen))
+    {
+        return PARSE_LENGTH;
+    }
+    if (hdr.numTLVs > FrameView::MAX_TLVS)
+    {
+        return PARSE_NUM_TLVS;
+    }
+    if (n < hdr.totalPacketLen)
+    {
+        return PARSE_TRUNCATED;
+    }
+
+    frame.header = hdr;
+    frame.data = p;
+    frame.len = hdr.totalPacketLen;
+    frame.tlvMask = 0;
+    frame.objDescr = { 0, 0 };
+    frame.objects = WireSpan<DetObj>();
+    frame.rangeProfile = WireSpan<uint16_t>();
+    frame.noiseProfile = WireSpan<uint16_t>();
+    frame.azimuthStatic = WireSpan<Cmplx16ImRe>();
+    frame.rangeDopplerHeatMap = WireSpan<uint16_t>();
+    frame.haveStats = false;
+    frame.crcChecked = false;
+    frame.numTlvs = 0;
+
+    const uint32_t len = hdr.totalPacketLen;
+    uint32_t pos = sizeof(MsgHeader);
+    for (uint32_t t = 0; t < hdr.numTLVs; t++)
+    {
+        if (len - pos < sizeof(TlvHeader))
+        {
+            return PARSE_TLV_BOUNDS;
+        }
+        const TlvHeader tl = load<TlvHeader>(p + pos);
+        pos += sizeof(TlvHeader);
+        if (tl.length > len - pos)
+        {
+            return PARSE_TLV_BOUNDS;
+        }
+        const uint8_t *v = p + pos;
+
+        if (!tlvValid(tl.type, v, tl.length))
+        {
+            return PARSE_TLV_SIZE;
+        }
+
+        switch (tl.type)
+        {
+        case TLV_DETECTED_POINTS:
+            frame.objDescr = tlvFixed<TLV_DETECTED_POINTS>(v);
+            frame.objects = tlvElems<TLV_DETECTED_POINTS>(v, tl.length);
+            break;
+        case TLV_RANGE_PROFILE:
+            frame.rangeProfile = tlvElems<TLV_RANGE_PROFILE>(v, tl.length);
+            break;
+        case TLV_NOISE_PROFILE:
+            frame.noiseProfile = tlvElems<TLV_NOISE_PROFILE>(v, tl.length);
+            break;
+        case TLV_RANGE_DOPPLER_HEAT_MAP:
+            frame.rangeDopplerHeatMap = tlvElems<TLV_RANGE_DOPPLER_HEAT_MAP>(v, tl.length);
+            break;
+        case TLV_AZIMUTH_STATIC_HEAT_MAP:
+            frame.azimuthStatic = tlvElems<TLV_AZIMUTH_STATIC_HEAT_MAP>(v, tl.length);
+            break;
+        case TLV_STATS:
+            frame.stats = tlvFixed<TLV_STATS>(v);
+            frame.haveStats = true;
+            break;
+        case TLV_PACKET_CRC:
+            if (cfg.crc != CRC_OFF)
+            {
+                /* Everything before the CRC TLV header */
+                const size_t covered = (size_t)(v - p) - sizeof(TlvHeader);
+                if (crc32c(MMW_CRC32C_INIT, p, covered) != tlvFixed<TLV_PACKET_CRC>(v).crc)
+                {
+                    return PARSE_CRC;
+                }
+                frame.crcChecked = true;
+            }
+            break;
+        default:
+            /* The other types are only listed */
+            break;
+        }
+
+        frame.tlvs[frame.numTlvs++] = { tl.type, tl.length, v };
+        frame.tlvMask |= maskBit(tl.type);
+        pos += tl.length;
+    }
+
+    /* Only the segment padding may follow the last TLV */
+    if (len - pos >= MSG_SEGMENT_LEN)
+    {
+        return PARSE_TLV_BOUNDS;
+    }
+    if ((cfg.crc == CRC_REQUIRED) && !frame.crcChecked)
+    {
+        return PARSE_CRC;
+    }
+    return PARSE_OK;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Finds the first valid packet from p on: the first magic word whose
+ *      packet passes parseFrame. Keeps no counts, see TlvParser::next for
+ *      that.
+ *
+ *  @param[in,out] p
+ *      Start of the search; moved onto the packet, or to where the search
+ *      goes on once more bytes are there: the magic word of an incomplete
+ *      packet, or the last bytes that could start a magic word
+ *  @param[in]  end
+ *      End of the data
+ *  @param[in]  cfg
+ *      Limits
+ *  @param[out] frame
+ *      The packet
+ *
+ *  @retval
+ *      Success -   PARSE_OK
+ *  @retval
+ *      Error   -   PARSE_TRUNCATED, more data is needed
+ */
+int findPacket(const uint8_t *&p, const uint8_t *end, const TlvParserConfig &cfg, FrameView &frame)
+{
+    while (true)
+    {
+        const uint8_t *hit = findMagic(p, (size_t)(end - p));
+        if (hit == nullptr)
+        {
+            const size_t keep = sizeof(MAGIC_WORD) - 1U;
+            p = ((size_t)(end - p) > keep) ? end - keep : p;
+            return PARSE_TRUNCATED;
+        }
+        p = hit;
+        const int err = parseFrame(p, (size_t)(end - p), cfg, frame);
+        if ((err == PARSE_OK) || (err == PARSE_TRUNCATED))
+        {
+            return err;
+        }
+        p++;
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Recomputes the packet CRC after the packet was edited, e.g. a
+ *      timestamp written into the header by a link emulator. Packets
+ *      without a CRC TLV are left alone.
+ *
+ *  @param[in,out] p
+ *      The packet
+ *  @param[in]  n
+ *      Bytes of the packet
+ *
+ *  @retval
+ *      true when the packet carries a CRC, which is valid now
+ */
+bool sealPacketCrc(uint8_t *p, size_t n)
+{
+    TlvParserConfig cfg;
+    FrameView frame;
+
+    cfg.sdkMajor = 0;
+    cfg.maxPacketLen = (n > 0xFFFFFFFFU) ? 0xFFFFFFFFU : (uint32_t)n;
+    cfg.crc = CRC_OFF;
+    if (parseFrame(p, n, cfg, frame) != PARSE_OK)
+    {
+        return false;
+    }
+    const TlvRef *tlv = frame.find(TLV_PACKET_CRC);
+    if (tlv == nullptr)
+    {
+        return false;
+    }
+    PacketCrc crc;
+    crc.crc = crc32c(MMW_CRC32C_INIT, p, (size_t)(tlv->payload - p) - sizeof(TlvHeader));
+    std::memcpy(p + (tlv->payload - p), &crc, sizeof(crc));
+    return true;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Finds and parses the next packet. A packet with a matching CRC
+ *      makes the CRC required from then on (TlvParserConfig::crc).
+ *
+ *  @param[in,out] cursor
+ *      Read position; moved past the packet, or onto the magic word of an
+ *      incomplete one, or to the last bytes that could start a magic word
+ *  @param[in]  end
+ *      End of the data
+ *  @param[out] frame
+ *      The packet
+ *
+ *  @retval
+ *      Success -   PARSE_OK
+ *  @retval
+ *      Error   -   PARSE_TRUNCATED, more data is needed
+ */
+int TlvParser::next(const uint8_t *&cursor, const uint8_t *end, FrameView &frame)
+{
+    while (true)
+    {
+        const uint8_t *hit = findMagic(cursor, (size_t)(end - cursor));
+        if (hit == nullptr)
+        {
+            const size_t keep = sizeof(MAGIC_WORD) - 1U;
+            const uint8_t *to = ((size_t)(end - cursor) > keep) ? end - keep : cursor;
+            m_stats.skippedBytes += (uint64_t)(to - cursor);
+            cursor = to;
+            m_probeFrom = nullptr;
+            return PARSE_TRUNCATED;
+        }
+        if (hit != cursor)
+        {
+            m_probeFrom = nullptr;
+        }
+        m_stats.skippedBytes += (uint64_t)(hit - cursor);
+        cursor = hit;
+
+        const int err = parseFrame(cursor, (size_t)(end - cursor), m_cfg, frame);
+        if (err == PARSE_OK)
+        {
+            if (frame.crcChecked && (m_cfg.crc == CRC_IF_PRESENT))
+            {
+                m_cfg.crc = CRC_REQUIRED;
+            }
+            cursor += frame.len;
+            m_probeFrom = nullptr;
+            m_stats.frames++;
+            return PARSE_OK;
+        }
+        if (err == PARSE_TRUNCATED)
+        {
+            /* A damaged totalPacketLen would hold the stream for up to
+             * maxPacketLen bytes; a valid packet inside it ends the wait.
+             * The search resumes where the last call on this packet left
+             * it, but never past the bytes there are now */
+            if ((m_probeFrom != cursor) || (m_probed >= (size_t)(end - cursor)))
+            {
+                m_probeFrom = cursor;
+                m_probed = 1;
+            }
+            const uint8_t *probe = cursor + m_probed;
+            const int found = findPacket(probe, end, m_cfg, frame);
+            m_probed = (size_t)(probe - cursor);
+            if (found != PARSE_OK)
+            {
+                return PARSE_TRUNCATED;
+            }
+            m_probeFrom = nullptr;
+            m_stats.badFrames++;
+            m_stats.resyncs++;
+            m_stats.skippedBytes += (uint64_t)(probe - cursor);
+            cursor = probe;
+            continue;
+        }
+        m_stats.badFrames++;
+        m_stats.crcErrors += (err == PARSE_CRC) ? 1U : 0U;
+        m_stats.skippedBytes++;
+        cursor++;
+        m_probeFrom = nullptr;
+    }
+}
+
+} /* namespace mmw */
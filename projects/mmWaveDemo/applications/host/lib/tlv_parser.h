@@ -0,0 +1,247 @@
+/**
+ *   @file  tlv_parser.h
+ *
+ *   @brief
+ *      Output packet parser: vectorized magic word search, header and TLV
+ *      validation, packet CRC check, and typed views into the packet bytes.
+ *      Nothing is copied and nothing is allocated.
+ */
+#ifndef TLV_PARSER_H
+#define TLV_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "mmw_wire.h"
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  Read only view of an array of wire structs
+ *
+ * @details
+ *  The packet can sit at any byte offset (a UART ring, a file), so elements
+ *  are loaded with memcpy instead of dereferencing a possibly misaligned
+ *  pointer; compilers turn that into a plain load.
+ */
+template <typename T>
+class WireSpan
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = T;
+
+        explicit iterator(const uint8_t *p) : m_p(p) {}
+        T operator*() const                         { return load<T>(m_p); }
+        iterator &operator++()                      { m_p += sizeof(T); return *this; }
+        iterator operator++(int)                    { iterator i(*this); m_p += sizeof(T); return i; }
+        bool operator==(const iterator &o) const    { return m_p == o.m_p; }
+        bool operator!=(const iterator &o) const    { return m_p != o.m_p; }
+
+    private:
+        const uint8_t *m_p;
+    };
+
+    WireSpan() = default;
+    WireSpan(const uint8_t *p, size_t n) : m_p(p), m_n(n) {}
+
+    T operator[](size_t i) const    { return load<T>(m_p + i * sizeof(T)); }
+    size_t size() const             { return m_n; }
+    bool empty() const              { return m_n == 0; }
+    const uint8_t *bytes() const    { return m_p; }
+    size_t sizeBytes() const        { return m_n * sizeof(T); }
+    iterator begin() const          { return iterator(m_p); }
+    iterator end() const            { return iterator(m_p + m_n * sizeof(T)); }
+
+    /*! @brief   Typed pointer, only when the data happens to be aligned */
+    const T *aligned() const
+    {
+        return ((reinterpret_cast<uintptr_t>(m_p) % alignof(T)) == 0) ? reinterpret_cast<const T *>(m_p) : nullptr;
+    }
+
+private:
+    const uint8_t   *m_p = nullptr;
+    size_t          m_n = 0;
+};
+
+/**
+ *  @b Description
+ *  @n
+ *      Elements of a TLV of type Type, at the fixed offset of its layout;
+ *      the length must have passed tlvValid.
+ */
+template <uint32_t Type>
+inline WireSpan<typename TlvLayout<Type>::Elem> tlvElems(const uint8_t *v, uint32_t length)
+{
+    using Layout = TlvLayout<Type>;
+    return WireSpan<typename Layout::Elem>(v + Layout::elemOffset, Layout::elems(v, length));
+}
+
+/**
+ * @brief
+ *  One TLV of a packet
+ */
+struct TlvRef
+{
+    uint32_t        type;
+    uint32_t        length;
+    const uint8_t   *payload;
+};
+
+/**
+ * @brief
+ *  Parsed output packet. Views point into the packet bytes.
+ */
+struct FrameView
+{
+    /*! @brief   Most TLVs a packet may carry */
+    static const uint32_t MAX_TLVS = 16;
+
+    MsgHeader               header;
+    const uint8_t           *data = nullptr;
+    uint32_t                len = 0;
+
+    /*! @brief   Bit n set for TLV type n (1..15), bit 16 + n for extended
+     *           type 0x100 + n */
+    uint32_t                tlvMask = 0;
+
+    DetObjDescr             objDescr = { 0, 0 };
+    WireSpan<DetObj>        objects;
+    WireSpan<uint16_t>      rangeProfile;
+    WireSpan<uint16_t>      noiseProfile;
+    WireSpan<Cmplx16ImRe>   azimuthStatic;
+    WireSpan<uint16_t>      rangeDopplerHeatMap;
+    bool                    haveStats = false;
+    Stats                   stats;
+
+    /*! @brief   The packet carried a CRC and it matched */
+    bool                    crcChecked = false;
+
+    /*! @brief   Every TLV in packet order, extended types included */
+    TlvRef                  tlvs[MAX_TLVS];
+    uint32_t                numTlvs = 0;
+
+    const TlvRef *find(uint32_t type) const;
+};
+
+/**
+ * @brief
+ *  Parser errors
+ */
+enum ParseError : int
+{
+    PARSE_OK            = 0,
+    PARSE_TRUNCATED     = -1,   /*!< Packet not complete yet */
+    PARSE_MAGIC         = -2,   /*!< No magic word at the start */
+    PARSE_VERSION       = -3,   /*!< SDK major version mismatch */
+    PARSE_LENGTH        = -4,   /*!< totalPacketLen out of range */
+    PARSE_NUM_TLVS      = -5,   /*!< numTLVs out of range */
+    PARSE_TLV_BOUNDS    = -6,   /*!< TLVs overrun the packet, or leave more than padding */
+    PARSE_TLV_SIZE      = -7,   /*!< TLV length impossible for its type */
+    PARSE_CRC           = -8    /*!< Packet CRC mismatch, or missing when required */
+};
+
+/**
+ * @brief
+ *  Packet CRC check (MMWDEMO_OUTPUT_MSG_PACKET_CRC)
+ */
+enum CrcCheck : uint8_t
+{
+    CRC_IF_PRESENT  = 0,    /*!< Check packets carrying a CRC, pass the others */
+    CRC_REQUIRED    = 1,    /*!< Reject packets without a CRC */
+    CRC_OFF         = 2     /*!< Never check */
+};
+
+/**
+ * @brief
+ *  Parser limits
+ */
+struct TlvParserConfig
+{
+    /*! @brief   Required SDK major version (top byte of version), 0 for any */
+    uint8_t     sdkMajor = 1;
+
+    /*! @brief   Longest packet accepted */
+    uint32_t    maxPacketLen = 512U * 1024U;
+
+    /*! @brief   Packet CRC check. A TlvParser which got a packet with a
+     *           matching CRC turns CRC_IF_PRESENT into CRC_REQUIRED, so a
+     *           glitch can't pass a packet off as one from firmware
+     *           without CRCs */
+    CrcCheck    crc = CRC_IF_PRESENT;
+};
+
+/**
+ * @brief
+ *  Stream parser counters
+ */
+struct TlvParserStats
+{
+    uint64_t    frames = 0;
+    uint64_t    skippedBytes = 0;
+    uint64_t    badFrames = 0;
+
+    /*! @brief   Packets failing their CRC, counted in badFrames too */
+    uint64_t    crcErrors = 0;
+
+    /*! @brief   Packets given up while incomplete because a valid packet
+     *           started inside them, counted in badFrames too */
+    uint64_t    resyncs = 0;
+};
+
+const uint8_t *findMagic(const uint8_t *p, size_t n);
+const uint8_t *findMagicScalar(const uint8_t *p, size_t n);
+int parseFrame(const uint8_t *p, size_t n, const TlvParserConfig &cfg, FrameView &frame);
+int findPacket(const uint8_t *&p, const uint8_t *end, const TlvParserConfig &cfg, FrameView &frame);
+bool sealPacketCrc(uint8_t *p, size_t n);
+
+/**
+ * @brief
+ *  Packet parser over a byte stream
+ *
+ * @details
+ *  next() walks a contiguous buffer: it skips to the magic word, parses and
+ *  validates the packet there and advances past it. A magic word whose
+ *  packet fails the checks, the CRC included, is skipped by one byte, so
+ *  the search goes on at the next magic word rather than where the
+ *  damaged totalPacketLen points. When the buffer ends inside a packet,
+ *  next() returns PARSE_TRUNCATED with the cursor on its magic word, so
+ *  the caller can come back with more bytes; unless a valid packet starts
+ *  inside the claimed length, which gives the length away as damaged: the
+ *  parser then goes on there, one packet after the glitch. That search
+ *  resumes where the last call left it while the cursor stays on the same
+ *  incomplete packet, so each byte is probed once; any other outcome
+ *  (a packet parsed, bytes skipped) starts it over, and it never resumes
+ *  past the end of the bytes given. Between two PARSE_TRUNCATED calls the
+ *  caller may append bytes but must not change the ones it already gave.
+ */
+class TlvParser
+{
+public:
+    explicit TlvParser(const TlvParserConfig &cfg = TlvParserConfig()) : m_cfg(cfg) {}
+
+    int next(const uint8_t *&cursor, const uint8_t *end, FrameView &frame);
+
+    const TlvParserStats &stats() const { return m_stats; }
+
+private:
+    TlvParserConfig m_cfg;
+    TlvParserStats  m_stats;
+
+    /* Incomplete packet searched for a valid one, and how far */
+    const uint8_t   *m_probeFrom = nullptr;
+    size_t          m_probed = 0;
+};
+
+} /* namespace mmw */
+
+#endif /* TLV_PARSER_H */
@@ -0,0 +1,420 @@
+/**
+ *   @file  uart_reader.cpp
+ *
+ *   @brief
+ *      UART output packet reader, see uart_reader.h.
+ */
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <utility>
+
+#include <asm/termbits.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "host_clock.h"
+#include "mmw_wire.h"
+#include "tlv_parser.h"
+#include "uart_reader.h"
+
+namespace mmw
+{
+
+UartReader::~UartReader()
+{
+    close();
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Raw 8N1 at the configured rate. termios2 with BOTHER takes any rate,
+ *      not only the Bxxx constants, so 921600 and the custom rates above it
+ *      go the same way.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int UartReader::configurePort()
+{
+    struct termios2 tio;
+
+    if (!isatty(m_fd))
+    {
+        /* A FIFO fed by a test tool */
+        return 0;
+    }
+    if (ioctl(m_fd, TCGETS2, &tio) < 0)
+    {
+        return -1;
+    }
+    tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF);
+    tio.c_oflag &= ~OPOST;
+    tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+    tio.c_cflag &= ~(CSIZE | PARENB | CSTOPB | CRTSCTS | CBAUD | (CBAUD << IBSHIFT));
+    tio.c_cflag |= CS8 | CLOCAL | CREAD | BOTHER | (BOTHER << IBSHIFT);
+    tio.c_ispeed = m_cfg.baudRate;
+    tio.c_ospeed = m_cfg.baudRate;
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    if (ioctl(m_fd, TCSETS2, &tio) < 0)
+    {
+        return -1;
+    }
+    /* Stale bytes from before the open would only cost a resync */
+    ioctl(m_fd, TCFLSH, TCIFLUSH);
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Opens and configures the port and allocates the ring.
+ *
+ *  @param[in]  cfg
+ *      Reader configuration
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int UartReader::open(const UartReaderConfig &cfg)
+{
+    if ((m_fd >= 0) || (cfg.maxPacketLen < sizeof(MsgHeader)) || (cfg.maxPacketLen >= cfg.ringSize))
+    {
+        return -1;
+    }
+    m_cfg = cfg;
+    m_parserCfg.sdkMajor = 0;
+    m_parserCfg.maxPacketLen = cfg.maxPacketLen;
+    m_parserCfg.crc = cfg.crc;
+    if ((m_ring.capacity() == 0U) && (m_ring.create(m_cfg.ringSize) < 0))
+    {
+        return -1;
+    }
+
+    m_fd = ::open(m_cfg.device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if ((m_fd < 0) && (errno == EACCES))
+    {
+        m_fd = ::open(m_cfg.device.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    }
+    if (m_fd < 0)
+    {
+        return -1;
+    }
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_stopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ((configurePort() < 0) || (m_epollFd < 0) || (m_stopFd < 0))
+    {
+        close();
+        return -1;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = m_fd;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_fd, &ev) < 0)
+    {
+        close();
+        return -1;
+    }
+    ev.events = EPOLLIN;
+    ev.data.fd = m_stopFd;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_stopFd, &ev) < 0)
+    {
+        close();
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Adds a packet callback. Only before start().
+ */
+void UartReader::addCallback(FrameFn fn)
+{
+    if (!m_thread.joinable())
+    {
+        m_callbacks.push_back(std::move(fn));
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Starts the reader thread.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+int UartReader::start()
+{
+    if ((m_fd < 0) || m_thread.joinable())
+    {
+        return -1;
+    }
+    m_ring.reopen();
+    m_scanPos = m_ring.written();
+    m_packetLen = 0;
+    m_inSync = false;
+    m_running.store(true);
+    m_thread = std::thread(&UartReader::ioLoop, this);
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Stops the reader thread; no callback runs once this returns.
+ */
+void UartReader::stop()
+{
+    if (m_thread.joinable())
+    {
+        const uint64_t one = 1;
+        if (write(m_stopFd, &one, sizeof(one)) < 0)
+        {
+            /* The counter can't overflow with a single write */
+        }
+        m_thread.join();
+        uint64_t value;
+        if (read(m_stopFd, &value, sizeof(value)) < 0)
+        {
+            /* Already drained */
+        }
+    }
+    m_running.store(false);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Stops the reader and closes the port.
+ */
+void UartReader::close()
+{
+    stop();
+    for (int *fd : { &m_fd, &m_epollFd, &m_stopFd })
+    {
+        if (*fd >= 0)
+        {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void UartReader::skip(size_t n)
+{
+    if (m_inSync)
+    {
+        m_resyncs.fetch_add(1, std::memory_order_relaxed);
+        m_inSync = false;
+    }
+    m_scanPos += n;
+    m_skippedBytes.fetch_add(n, std::memory_order_relaxed);
+    m_ring.consumeTo(m_scanPos);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Cuts the packets out of what was read so far.
+ *
+ *  @param[in]  ts
+ *      Time of the read that brought the new bytes
+ */
+void UartReader::parse(uint64_t ts)
+{
+    while (true)
+    {
+        const size_t avail = (size_t)(m_ring.written() - m_scanPos);
+
+        if (m_packetLen == 0U)
+        {
+            if (avail < sizeof(MsgHeader))
+            {
+                return;
+            }
+            /* Magic word anywhere a whole header fits behind it */
+            const uint8_t *p = m_ring.at(m_scanPos);
+            const size_t span = avail - sizeof(MsgHeader) + sizeof(MAGIC_WORD);
+            const uint8_t *hit = findMagic(p, span);
+            if (hit == nullptr)
+            {
+                skip(span - (sizeof(MAGIC_WORD) - 1U));
+                continue;
+            }
+            if (hit != p)
+            {
+                skip((size_t)(hit - p));
+            }
+            const uint32_t len = load<MsgHeader>(hit).totalPacketLen;
+            if ((len < sizeof(MsgHeader)) || (len > m_cfg.maxPacketLen))
+            {
+                m_badLengths.fetch_add(1, std::memory_order_relaxed);
+                skip(1);
+                continue;
+            }
+            m_packetLen = len;
+            m_firstByteNs = ts;
+            m_probePos = m_scanPos + 1U;
+            continue;
+        }
+
+        if (avail < m_packetLen)
+        {
+            /* A damaged length would hold the reader for up to
+             * maxPacketLen bytes: look for a valid packet behind the
+             * header, resuming where the last read left the search */
+            const uint8_t *from = m_ring.at(m_probePos);
+            const uint8_t *probe = from;
+            const int err = findPacket(probe, m_ring.at(m_scanPos) + avail, m_parserCfg, m_view);
+            m_probePos += (uint64_t)(probe - from);
+            if (err != PARSE_OK)
+            {
+                return;
+            }
+            m_badLengths.fetch_add(1, std::memory_order_relaxed);
+            m_packetLen = 0;
+            skip((size_t)(m_probePos - m_scanPos));
+            continue;
+        }
+
+        const int err = parseFrame(m_ring.at(m_scanPos), m_packetLen, m_parserCfg, m_view);
+        if (err != PARSE_OK)
+        {
+            m_badPackets.fetch_add(1, std::memory_order_relaxed);
+            if (err == PARSE_CRC)
+            {
+                m_crcErrors.fetch_add(1, std::memory_order_relaxed);
+            }
+            m_packetLen = 0;
+            skip(1);
+            continue;
+        }
+        if (m_view.crcChecked && (m_parserCfg.crc == CRC_IF_PRESENT))
+        {
+            m_parserCfg.crc = CRC_REQUIRED;
+        }
+
+        UartFrame frame;
+        frame.data = m_ring.at(m_scanPos);
+        frame.len = m_packetLen;
+        frame.firstByteNs = m_firstByteNs;
+        frame.lastByteNs = ts;
+        for (const FrameFn &fn : m_callbacks)
+        {
+            fn(frame);
+        }
+        m_frames.fetch_add(1, std::memory_order_relaxed);
+        m_inSync = true;
+        m_scanPos += m_packetLen;
+        m_ring.consumeTo(m_scanPos);
+        m_packetLen = 0;
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Reader thread: drains the port on every wakeup, then parses. Ends on
+ *      stop() or when the port goes away (hang up, device unplugged).
+ */
+void UartReader::ioLoop()
+{
+    struct epoll_event events[2];
+    bool run = true;
+
+    while (run)
+    {
+        const int n = epoll_wait(m_epollFd, events, 2, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            m_readErrors.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+
+        bool readable = false;
+        for (int i = 0; i < n; i++)
+        {
+            if (events[i].data.fd == m_stopFd)
+            {
+                run = false;
+            }
+            else
+            {
+                readable = true;
+            }
+        }
+        if (!readable)
+        {
+            continue;
+        }
+
+        while (true)
+        {
+            size_t space;
+            uint8_t *dst = m_ring.writePtr(space);
+            const ssize_t got = read(m_fd, dst, space);
+            if (got > 0)
+            {
+                m_ring.commit((size_t)got);
+                m_bytesRead.fetch_add((uint64_t)got, std::memory_order_relaxed);
+                m_reads.fetch_add(1, std::memory_order_relaxed);
+                parse(monotonicNs());
+                continue;
+            }
+            if ((got < 0) && ((errno == EAGAIN) || (errno == EINTR)))
+            {
+                break;
+            }
+            /* End of file, hang up or a dead device */
+            if (got < 0)
+            {
+                m_readErrors.fetch_add(1, std::memory_order_relaxed);
+            }
+            run = false;
+            break;
+        }
+    }
+    m_running.store(false);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Snapshot of the counters, safe from any thread.
+ */
+UartReaderStats UartReader::stats() const
+{
+    UartReaderStats st;
+
+    st.bytesRead = m_bytesRead.load(std::memory_order_relaxed);
+    st.reads = m_reads.load(std::memory_order_relaxed);
+    st.frames = m_frames.load(std::memory_order_relaxed);
+    st.skippedBytes = m_skippedBytes.load(std::memory_order_relaxed);
+    st.badLengths = m_badLengths.load(std::memory_order_relaxed);
+    st.badPackets = m_badPackets.load(std::memory_order_relaxed);
+    st.crcErrors = m_crcErrors.load(std::memory_order_relaxed);
+    st.resyncs = m_resyncs.load(std::memory_order_relaxed);
+    st.readErrors = m_readErrors.load(std::memory_order_relaxed);
+    return st;
+}
+
+} /* namespace mmw */
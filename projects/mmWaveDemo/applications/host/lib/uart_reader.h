@@ -0,0 +1,179 @@
+/**
+ *   @file  uart_reader.h
+ *
+ *   @brief
+ *      Reader of the mmw demo output packets on the UART data port.
+ */
+#ifndef UART_READER_H
+#define UART_READER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "byte_ring.h"
+#include "tlv_parser.h"
+
+namespace mmw
+{
+
+/**
+ * @brief
+ *  Reader configuration
+ */
+struct UartReaderConfig
+{
+    /*! @brief   Data port, e.g. /dev/ttyACM1 */
+    std::string device;
+
+    /*! @brief   Baud rate; any rate the driver accepts, set through termios2 */
+    uint32_t    baudRate = 921600;
+
+    /*! @brief   Ring buffer size, a power of two */
+    size_t      ringSize = 2U * 1024U * 1024U;
+
+    /*! @brief   Longest packet accepted, less than ringSize. Longer lengths
+     *           are taken as a false magic word */
+    uint32_t    maxPacketLen = 512U * 1024U;
+
+    /*! @brief   Packet CRC check, see TlvParserConfig::crc */
+    CrcCheck    crc = CRC_IF_PRESENT;
+};
+
+/**
+ * @brief
+ *  Output packet handed to the callbacks
+ */
+struct UartFrame
+{
+    /*! @brief   The packet, header to padding; valid during the callback */
+    const uint8_t   *data;
+
+    /*! @brief   totalPacketLen */
+    uint32_t        len;
+
+    /*! @brief   CLOCK_MONOTONIC of the read that brought the header */
+    uint64_t        firstByteNs;
+
+    /*! @brief   CLOCK_MONOTONIC of the read that completed the packet */
+    uint64_t        lastByteNs;
+};
+
+/**
+ * @brief
+ *  Reader counters
+ */
+struct UartReaderStats
+{
+    /*! @brief   Bytes read from the port */
+    uint64_t    bytesRead = 0;
+
+    /*! @brief   read() calls returning data */
+    uint64_t    reads = 0;
+
+    /*! @brief   Packets delivered */
+    uint64_t    frames = 0;
+
+    /*! @brief   Bytes outside packets */
+    uint64_t    skippedBytes = 0;
+
+    /*! @brief   Magic words followed by an impossible length, or by one
+     *           which a valid packet starting inside it gave away */
+    uint64_t    badLengths = 0;
+
+    /*! @brief   Complete packets failing the checks of parseFrame, the CRC
+     *           included */
+    uint64_t    badPackets = 0;
+
+    /*! @brief   Of badPackets, those failing their CRC */
+    uint64_t    crcErrors = 0;
+
+    /*! @brief   Bytes had to be skipped right after a packet, i.e. the
+     *           reader lost the packet boundary and searched for the next
+     *           magic word */
+    uint64_t    resyncs = 0;
+
+    /*! @brief   Failed reads */
+    uint64_t    readErrors = 0;
+};
+
+/**
+ * @brief
+ *  UART output packet reader
+ *
+ * @details
+ *  One thread waits in epoll on the non-blocking port, drains it into a
+ *  mirrored ring and cuts packets in place: the magic word is searched
+ *  once, totalPacketLen of MmwDemo_output_message_header then says where
+ *  the packet ends. A complete packet goes through parseFrame, CRC
+ *  included, before it is delivered; one that fails is skipped by one
+ *  byte only, so the search goes on at the next magic word instead of
+ *  where a damaged length points. While a packet is incomplete, the bytes
+ *  behind its header are searched for a valid packet, which gives a
+ *  damaged length away: a glitch costs the packets it hit and nothing
+ *  more. Each packet is passed to every callback, in the order they were
+ *  added, on the reader thread; callbacks should hand the work off rather
+ *  than block.
+ */
+class UartReader
+{
+public:
+    using FrameFn = std::function<void(const UartFrame &frame)>;
+
+    UartReader() = default;
+    ~UartReader();
+
+    UartReader(const UartReader &) = delete;
+    UartReader &operator=(const UartReader &) = delete;
+
+    int open(const UartReaderConfig &cfg);
+    void addCallback(FrameFn fn);
+    int start();
+    void stop();
+    void close();
+
+    bool running() const { return m_running.load(); }
+    UartReaderStats stats() const;
+
+private:
+    int configurePort();
+    void ioLoop();
+    void parse(uint64_t ts);
+    void skip(size_t n);
+
+    UartReaderConfig        m_cfg;
+    int                     m_fd = -1;
+    int                     m_epollFd = -1;
+    int                     m_stopFd = -1;
+    ByteRing                m_ring;
+    std::vector<FrameFn>    m_callbacks;
+    std::thread             m_thread;
+    std::atomic<bool>       m_running{false};
+
+    /* Reader thread */
+    uint64_t                m_scanPos = 0;
+    uint32_t                m_packetLen = 0;
+    uint64_t                m_firstByteNs = 0;
+    uint64_t                m_probePos = 0;
+    bool                    m_inSync = false;
+    TlvParserConfig         m_parserCfg;
+    FrameView               m_view;
+
+    std::atomic<uint64_t>   m_bytesRead{0};
+    std::atomic<uint64_t>   m_reads{0};
+    std::atomic<uint64_t>   m_frames{0};
+    std::atomic<uint64_t>   m_skippedBytes{0};
+    std::atomic<uint64_t>   m_badLengths{0};
+    std::atomic<uint64_t>   m_badPackets{0};
+    std::atomic<uint64_t>   m_crcErrors{0};
+    std::atomic<uint64_t>   m_resyncs{0};
+    std::atomic<uint64_t>   m_readErrors{0};
+};
+
+} /* namespace mmw */
+
+#endif /* UART_READER_H */
@@ -0,0 +1,515 @@
+/**
+ *   @file  mpsse_mock.cpp
+ *
+ *   @brief
+ *      Stand-in for libMPSSE with an MSS SPI slave behind it, built as
+ *      build/libMPSSE.so so the SPI tools run and can be measured without
+ *      an FT232H.
+ *
+ *      The slave clocks out what MmwDemo_spiTask sends: output packets cut
+ *      into frames by the firmware framer. The packets are synthetic, or
+ *      come from a recording of the UART data port (raw output packets back
+ *      to back, played in a loop). The library reads its settings from the
+ *      environment when the first channel is opened:
+ *
+ *          MPSSE_MOCK_CHANNELS     channels reported, default 1
+ *          MPSSE_MOCK_STREAM       recording to play instead of synthetic data
+ *          MPSSE_MOCK_HEATMAP      synthetic packets carry a heat map, default 1
+ *          MPSSE_MOCK_IDLE         probability of idle bytes after a frame,
+ *                                  default 0.125
+ *          MPSSE_MOCK_PACE         0 disables all timing, default 1
+ *          MPSSE_MOCK_USB_US       USB round trip per transfer in us, default 250
+ *          MPSSE_MOCK_BER          bit error rate on MISO, default 0
+ *          MPSSE_MOCK_SEED         seed of the idle runs and bit errors
+ *          MPSSE_MOCK_DEVICE_STATS synthetic packets carry the DSS and MSS
+ *                                  counters every that many frames, default 0
+ *          MPSSE_MOCK_SKIP         probability of the emulated DSS skipping a
+ *                                  frame (detObjLoggingSkip), default 0
+ *
+ *      Timing follows the FT232H: the SPI clock is 30 MHz / (1 + divisor),
+ *      the requested ClockRate rounded down to the next such rate. Every
+ *      transfer costs the USB round trip plus the bits at that clock, and
+ *      when its length is not a multiple of the 510 byte USB payload the
+ *      chip holds the short tail for LatencyTimer ms before sending it.
+ *
+ *      The slave only shifts while chip select is asserted; reads without
+ *      it return 0xFF and lose nothing.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "libMPSSE_spi.h"
+#include "mmw_spi_frame.h"
+#include "raw_capture.h"
+#include "synthetic_output.h"
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+const uint32_t  MAX_CHANNELS = 8;
+const uint32_t  FT232H_BASE_CLOCK = 30000000;
+const uint32_t  USB_PACKET_PAYLOAD = 510;
+
+struct MockConfig
+{
+    uint32_t                numChannels = 1;
+    bool                    heatMap = true;
+    double                  idleProbability = 0.125;
+    bool                    pace = true;
+    double                  usbRoundTripUs = 250.0;
+    double                  bitErrorRate = 0.0;
+    uint32_t                seed = 1;
+    uint32_t                deviceStatsPeriod = 0;
+    double                  skipProbability = 0.0;
+
+    /* Recorded output packets, one segment each */
+    mmw::RawCapture         capture;
+    std::vector<MmwDemo_spiSegment> packets;
+};
+
+MockConfig      gConfig;
+std::once_flag  gConfigOnce;
+
+double envDouble(const char *name, double dflt)
+{
+    const char *v = getenv(name);
+    return (v != nullptr) ? atof(v) : dflt;
+}
+
+void loadConfig()
+{
+    MockConfig &cfg = gConfig;
+
+    cfg.numChannels = (uint32_t)envDouble("MPSSE_MOCK_CHANNELS", 1.0);
+    if ((cfg.numChannels == 0U) || (cfg.numChannels > MAX_CHANNELS))
+    {
+        cfg.numChannels = 1;
+    }
+    cfg.heatMap = envDouble("MPSSE_MOCK_HEATMAP", 1.0) != 0.0;
+    cfg.idleProbability = envDouble("MPSSE_MOCK_IDLE", 0.125);
+    cfg.pace = envDouble("MPSSE_MOCK_PACE", 1.0) != 0.0;
+    cfg.usbRoundTripUs = envDouble("MPSSE_MOCK_USB_US", 250.0);
+    cfg.bitErrorRate = envDouble("MPSSE_MOCK_BER", 0.0);
+    cfg.seed = (uint32_t)envDouble("MPSSE_MOCK_SEED", 1.0);
+    cfg.deviceStatsPeriod = (uint32_t)envDouble("MPSSE_MOCK_DEVICE_STATS", 0.0);
+    cfg.skipProbability = envDouble("MPSSE_MOCK_SKIP", 0.0);
+
+    const char *path = getenv("MPSSE_MOCK_STREAM");
+    if (path != nullptr)
+    {
+        if (cfg.capture.load(path) < 0)
+        {
+            fprintf(stderr, "mpsse mock: no output packets in %s, using synthetic data\n", path);
+            return;
+        }
+        for (size_t i = 0; i < cfg.capture.packets().size(); i++)
+        {
+            cfg.packets.push_back({ cfg.capture.packet(i), cfg.capture.packets()[i].len });
+        }
+    }
+}
+
+mmw::SyntheticOutputConfig packetConfig()
+{
+    mmw::SyntheticOutputConfig cfg;
+    cfg.heatMap = gConfig.heatMap;
+    cfg.deviceStatsPeriod = gConfig.deviceStatsPeriod;
+    return cfg;
+}
+
+struct MockChannel
+{
+    MockChannel()
+        : rng(1)
+    {
+        MmwDemo_spiFramerInit(&framer);
+    }
+
+    void reset(uint32_t index);
+    void nextFrame();
+    void clockOut(uint8_t *buffer, uint32_t size);
+    void corrupt(uint8_t *buffer, uint32_t size);
+    void pace(uint32_t size);
+    FT_STATUS transfer(uint8_t *in, uint32_t size, uint32_t *transferred, uint32_t options);
+
+    std::mutex          lock;
+    bool                isOpen = false;
+    bool                isInit = false;
+    bool                csAsserted = false;
+    ChannelConfig       config;
+    uint32_t            sckHz = FT232H_BASE_CLOCK;
+    Clock::time_point   busyUntil;
+
+    /* Slave side */
+    std::unique_ptr<mmw::SyntheticOutput> packet;
+    MmwDemo_spiFramer   framer;
+    uint32_t            packetIdx = 0;
+    uint8_t             frame[MMW_SPI_FRAME_SIZE];
+    uint32_t            frameOffset = MMW_SPI_FRAME_SIZE;
+    uint32_t            idle = 0;
+    std::mt19937        rng;
+};
+
+MockChannel gChannels[MAX_CHANNELS];
+
+void MockChannel::reset(uint32_t index)
+{
+    if (packet == nullptr)
+    {
+        packet.reset(new mmw::SyntheticOutput(packetConfig()));
+    }
+    MmwDemo_spiFramerInit(&framer);
+    packetIdx = 0;
+    frameOffset = MMW_SPI_FRAME_SIZE;
+    idle = 0;
+    rng.seed(gConfig.seed + index);
+    csAsserted = false;
+    busyUntil = Clock::now();
+}
+
+/* Loads the next frame, starting the next packet when needed */
+void MockChannel::nextFrame()
+{
+    if (MmwDemo_spiFramerNext(&framer, frame) > 0U)
+    {
+        return;
+    }
+    if (gConfig.packets.empty())
+    {
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        while ((gConfig.skipProbability > 0.0) && (uniform(rng) < gConfig.skipProbability))
+        {
+            packet->skip(packetIdx++);
+        }
+        packet->build(packetIdx++);
+        MmwDemo_spiFramerStart(&framer, packet->segments(), packet->numSegments());
+    }
+    else
+    {
+        MmwDemo_spiFramerStart(&framer, &gConfig.packets[packetIdx++ % gConfig.packets.size()], 1);
+    }
+    MmwDemo_spiFramerNext(&framer, frame);
+}
+
+/* Clocks out the frames, each one optionally followed by idle bytes */
+void MockChannel::clockOut(uint8_t *buffer, uint32_t size)
+{
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    while (size > 0U)
+    {
+        if ((frameOffset == MMW_SPI_FRAME_SIZE) && (idle > 0U))
+        {
+            const uint32_t n = (idle < size) ? idle : size;
+            if (buffer != nullptr)
+            {
+                std::memset(buffer, 0, n);
+                buffer += n;
+            }
+            size -= n;
+            idle -= n;
+            continue;
+        }
+        if (frameOffset == MMW_SPI_FRAME_SIZE)
+        {
+            nextFrame();
+            frameOffset = 0;
+            idle = (uniform(rng) < gConfig.idleProbability) ? (uint32_t)(rng() % 64U) : 0U;
+        }
+        const uint32_t left = MMW_SPI_FRAME_SIZE - frameOffset;
+        const uint32_t n = (left < size) ? left : size;
+        if (buffer != nullptr)
+        {
+            std::memcpy(buffer, frame + frameOffset, n);
+            buffer += n;
+        }
+        size -= n;
+        frameOffset += n;
+    }
+}
+
+void MockChannel::corrupt(uint8_t *buffer, uint32_t size)
+{
+    if (gConfig.bitErrorRate <= 0.0)
+    {
+        return;
+    }
+    std::poisson_distribution<uint32_t> flips(gConfig.bitErrorRate * size * 8.0);
+    for (uint32_t n = flips(rng); n > 0U; n--)
+    {
+        const uint32_t b = (uint32_t)(rng() % (size * 8U));
+        buffer[b / 8U] ^= (uint8_t)(0x80U >> (b % 8U));
+    }
+}
+
+/* Blocks for as long as the transfer takes on a real FT232H */
+void MockChannel::pace(uint32_t size)
+{
+    if (!gConfig.pace)
+    {
+        return;
+    }
+    double us = gConfig.usbRoundTripUs + (size * 8.0 * 1e6) / sckHz;
+    if ((size % USB_PACKET_PAYLOAD) != 0U)
+    {
+        us += config.LatencyTimer * 1000.0;
+    }
+    const Clock::time_point now = Clock::now();
+    if (busyUntil < now)
+    {
+        busyUntil = now;
+    }
+    busyUntil += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::micro>(us));
+    std::this_thread::sleep_until(busyUntil);
+}
+
+/* MISO into in (may be null), MOSI is not looked at */
+FT_STATUS MockChannel::transfer(uint8_t *in, uint32_t size, uint32_t *transferred, uint32_t options)
+{
+    const uint32_t requested = size;
+
+    if (!isInit)
+    {
+        return FT_DEVICE_NOT_OPENED;
+    }
+    if (options & SPI_TRANSFER_OPTIONS_SIZE_IN_BITS)
+    {
+        size = (size + 7U) / 8U;
+    }
+    if (options & SPI_TRANSFER_OPTIONS_CHIPSELECT_ENABLE)
+    {
+        csAsserted = true;
+    }
+    if (csAsserted)
+    {
+        clockOut(in, size);
+        if (in != nullptr)
+        {
+            corrupt(in, size);
+        }
+    }
+    else if (in != nullptr)
+    {
+        std::memset(in, 0xFF, size);
+    }
+    if (options & SPI_TRANSFER_OPTIONS_CHIPSELECT_DISABLE)
+    {
+        csAsserted = false;
+    }
+    pace(size);
+    *transferred = requested;
+    return FT_OK;
+}
+
+MockChannel *channel(FT_HANDLE handle)
+{
+    for (uint32_t i = 0; i < gConfig.numChannels; i++)
+    {
+        if (handle == (FT_HANDLE)&gChannels[i])
+        {
+            return &gChannels[i];
+        }
+    }
+    return nullptr;
+}
+
+} /* anonymous namespace */
+
+FTDI_API void Init_libMPSSE(void)
+{
+    std::call_once(gConfigOnce, loadConfig);
+}
+
+FTDI_API void Cleanup_libMPSSE(void)
+{
+}
+
+FTDI_API FT_STATUS SPI_GetNumChannels(uint32 *numChannels)
+{
+    std::call_once(gConfigOnce, loadConfig);
+    if (numChannels == nullptr)
+    {
+        return FT_INVALID_PARAMETER;
+    }
+    *numChannels = gConfig.numChannels;
+    return FT_OK;
+}
+
+FTDI_API FT_STATUS SPI_GetChannelInfo(uint32 index, FT_DEVICE_LIST_INFO_NODE *chanInfo)
+{
+    std::call_once(gConfigOnce, loadConfig);
+    if ((index >= gConfig.numChannels) || (chanInfo == nullptr))
+    {
+        return FT_INVALID_PARAMETER;
+    }
+    std::memset(chanInfo, 0, sizeof(*chanInfo));
+    chanInfo->Flags = FT_FLAGS_HISPEED | (gChannels[index].isOpen ? (ULONG)FT_FLAGS_OPENED : 0U);
+    chanInfo->Type = FT_DEVICE_232H;
+    chanInfo->ID = 0x04036014;
+    chanInfo->LocId = index + 1U;
+    snprintf(chanInfo->SerialNumber, sizeof(chanInfo->SerialNumber), "MOCK%04u", index);
+    snprintf(chanInfo->Description, sizeof(chanInfo->Description), "mmw mock FT232H");
+    chanInfo->ftHandle = gChannels[index].isOpen ? (FT_HANDLE)&gChannels[index] : nullptr;
+    return FT_OK;
+}
+
+FTDI_API FT_STATUS SPI_OpenChannel(uint32 index, FT_HANDLE *handle)
+{
+    std::call_once(gConfigOnce, loadConfig);
+    if ((index >= gConfig.numChannels) || (handle == nullptr))
+    {
+        return FT_INVALID_PARAMETER;
+    }
+    MockChannel &ch = gChannels[index];
+    std::lock_guard<std::mutex> guard(ch.lock);
+    if (ch.isOpen)
+    {
+        return FT_DEVICE_NOT_OPENED;
+    }
+    ch.reset(index);
+    ch.isOpen = true;
+    ch.isInit = false;
+    *handle = (FT_HANDLE)&ch;
+    return FT_OK;
+}
+
+FTDI_API FT_STATUS SPI_InitChannel(FT_HANDLE handle, ChannelConfig *config)
+{
+    MockChannel *ch = channel(handle);
+    if ((ch == nullptr) || (config == nullptr))
+    {
+        return FT_INVALID_HANDLE;
+    }
+    std::lock_guard<std::mutex> guard(ch->lock);
+    if (!ch->isOpen || (config->ClockRate == 0U) || (config->ClockRate > FT232H_BASE_CLOCK))
+    {
+        return FT_INVALID_PARAMETER;
+    }
+    ch->config = *config;
+    ch->sckHz = FT232H_BASE_CLOCK / ((FT232H_BASE_CLOCK + config->ClockRate - 1U) / config->ClockRate);
+    ch->isInit = true;
+    return FT_OK;
+}
+
+FTDI_API FT_STATUS SPI_CloseChannel(FT_HANDLE handle)
+{
+    MockChannel *ch = channel(handle);
+    if (ch == nullptr)
+    {
+        return FT_INVALID_HANDLE;
+    }
+    std::lock_guard<std::mutex> guard(ch->lock);
+    ch->isOpen = false;
+    ch->isInit = false;
+    return FT_OK;
+}
+
+FTDI_API FT_STATUS SPI_Read(FT_HANDLE handle, uint8 *buffer, uint32 sizeToTransfer,
+                            uint32 *sizeTransfered, uint32 options)
+{
+    MockChannel *ch = channel(handle);
+    if ((ch == nullptr) || (buffer == nullptr) || (sizeTransfered == nullptr))
+    {
+        return FT_INVALID_HANDLE;
+    }
+    *sizeTransfered = 0;
+    std::lock_guard<std::mutex> guard(ch->lock);
+    return ch->transfer(buffer, sizeToTransfer, sizeTransfered, options);
+}
+
+FTDI_API FT_STATUS SPI_Write(FT_HANDLE handle, uint8 *buffer, uint32 sizeToTransfer,
+                             uint32 *sizeTransfered, uint32 options)
+{
+    MockChannel *ch = channel(handle);
+    if ((ch == nullptr) || (buffer == nullptr) || (sizeTransfered == nullptr))
+    {
+        return FT_INVALID_HANDLE;
+    }
+    *sizeTransfered = 0;
+    std::lock_guard<std::mutex> guard(ch->lock);
+    return ch->transfer(nullptr, sizeToTransfer, sizeTransfered, options);
+}
+
+FTDI_API FT_STATUS SPI_ReadWrite(FT_HANDLE handle, uint8 *inBuffer, uint8 *outBuffer,
+                                 uint32 sizeToTransfer, uint32 *sizeTransferred, uint32 transferOptions)
+{
+    MockChannel *ch = channel(handle);
+    if ((ch == nullptr) || (inBuffer == nullptr) || (outBuffer == nullptr) || (sizeTransferred == nullptr))
+    {
+        return FT_INVALID_HANDLE;
+    }
+    *sizeTransferred = 0;
+    std::lock_guard<std::mutex> guard(ch->lock);
+    return ch->transfer(inBuffer, sizeToTransfer, sizeTransferred, transferOptions);
+}
+
+FTDI_API FT_STATUS SPI_IsBusy(FT_HANDLE handle, bool *state)
+{
+    MockChannel *ch = channel(handle);
+    if ((ch == nullptr) || (state == nullptr))
+    {
+        return FT_INVALID_HANDLE;
+    }
+    /* MISO level between transfers: the slave drives low while idle */
+    *state = false;
+    return FT_OK;
+}
+
+FTDI_API FT_STATUS SPI_ToggleCS(FT_HANDLE handle, bool state)
+{
+    MockChannel *ch = channel(handle);
+    if (ch == nullptr)
+    {
+        return FT_INVALID_HANDLE;
+    }
+    std::lock_guard<std::mutex> guard(ch->lock);
+    if (!ch->isInit)
+    {
+        return FT_DEVICE_NOT_OPENED;
+    }
+    ch->csAsserted = state;
+    return FT_OK;
+}
+
+FTDI_API FT_STATUS SPI_ChangeCS(FT_HANDLE handle, uint32 configOptions)
+{
+    MockChannel *ch = channel(handle);
+    if (ch == nullptr)
+    {
+        return FT_INVALID_HANDLE;
+    }
+    std::lock_guard<std::mutex> guard(ch->lock);
+    ch->config.configOptions = configOptions;
+    return FT_OK;
+}
+
+FTDI_API FT_STATUS FT_WriteGPIO(FT_HANDLE handle, uint8 dir, uint8 value)
+{
+    (void)dir;
+    (void)value;
+    return (channel(handle) != nullptr) ? FT_OK : FT_INVALID_HANDLE;
+}
+
+FTDI_API FT_STATUS FT_ReadGPIO(FT_HANDLE handle, uint8 *value)
+{
+    MockChannel *ch = channel(handle);
+    if ((ch == nullptr) || (value == nullptr))
+    {
+        return FT_INVALID_HANDLE;
+    }
+    std::lock_guard<std::mutex> guard(ch->lock);
+    ch->pace(0);
+
+    /* The slave always has the next frame armed */
+    *value = 0xFF;
+    return FT_OK;
+}
@@ -0,0 +1,1443 @@
+/**
+ *   @file  mmwave.cpp
+ *
+ *   @brief
+ *      Python module over the packet parser and the UART reader.
+ *
+ *      mmwave.Reader(device, baud=921600, queue=64, sdk_major=1)
+ *          UART reader; read(timeout=None) returns the next Frame, None on
+ *          timeout or once the port is gone; iterable
+ *      mmwave.BusReader(bus="mmw_frames", name="python", from_oldest=False, sdk_major=1)
+ *          consumer of a frame bus published by frame_bus_pub, the same
+ *          interface as Reader; None once the publisher is gone
+ *      mmwave.frames(buffer, sdk_major=1)
+ *          iterator over the packets of any bytes-like object (bytes, mmap
+ *          of a raw capture, ...), frames are views into it
+ *      mmwave.parse(buffer, sdk_major=1)
+ *          the packet at the start of buffer, ValueError if it is not one
+ *      mmwave.PolarResampler(num_range_bins=256, num_angle_bins=64,
+ *                            range_resolution=0.047392004, width=100, height=100,
+ *                            x=(-5, 5), y=(0, 5), interp="nearest", mirror=True, threads=0)
+ *          range/azimuth heat map to Cartesian image, the mapping built
+ *          once; resample(values, out=None) takes float32 magnitudes, rows
+ *          of range, and returns or fills height x width float32
+ *
+ *      The arrays of a Frame (objects, range_profile, noise_profile,
+ *      azimuth_static, range_doppler_heatmap, tlv(type), raw) are exported
+ *      through the buffer protocol with their element format, so
+ *      numpy.asarray() wraps them without a copy:
+ *
+ *          objects                 record array, rangeIdx dopplerIdx peakVal x y z
+ *          azimuth_static          record array, imag real (int16)
+ *          azimuth_complex64()     the same as complex64, converted once
+ *          profiles and heat map   uint16, 1-D; reshape as configured
+ *
+ *      Packets from a Reader are copied once out of its ring, on the
+ *      reader thread, and from a BusReader once out of the shared memory;
+ *      the GIL is released while waiting for them and while searching a
+ *      buffer for packets.
+ */
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <new>
+
+#include "frame_bus.h"
+#include "polar_resampler.h"
+#include "tlv_parser.h"
+#include "uart_reader.h"
+
+namespace
+{
+
+/* Native byte order: every platform the tools are built for is little endian */
+const char FORMAT_BYTES[] = "B";
+const char FORMAT_UINT16[] = "H";
+const char FORMAT_FLOAT[] = "f";
+const char FORMAT_COMPLEX64[] = "Zf";
+const char FORMAT_DET_OBJ[] = "T{H:rangeIdx:h:dopplerIdx:H:peakVal:h:x:h:y:h:z:}";
+const char FORMAT_CMPLX16[] = "T{h:imag:h:real:}";
+
+const char *parseErrorName(int err)
+{
+    switch (err)
+    {
+    case mmw::PARSE_TRUNCATED:  return "truncated packet";
+    case mmw::PARSE_MAGIC:      return "no magic word";
+    case mmw::PARSE_VERSION:    return "SDK version mismatch";
+    case mmw::PARSE_LENGTH:     return "bad totalPacketLen";
+    case mmw::PARSE_NUM_TLVS:   return "bad numTLVs";
+    case mmw::PARSE_TLV_BOUNDS: return "TLVs overrun the packet";
+    case mmw::PARSE_TLV_SIZE:   return "bad TLV length";
+    case mmw::PARSE_CRC:        return "packet CRC mismatch";
+    default:                    return "parse error";
+    }
+}
+
+/*
+ * View: a read only 1-D array in the memory of its owner
+ */
+struct View
+{
+    PyObject_HEAD
+    PyObject        *owner;
+    void            *own;
+    const uint8_t   *data;
+    Py_ssize_t      shape[1];
+    Py_ssize_t      strides[1];
+    const char      *format;
+};
+
+PyTypeObject *gViewType;
+PyTypeObject *gFrameType;
+PyTypeObject *gFrameIterType;
+PyTypeObject *gReaderType;
+PyTypeObject *gBusReaderType;
+PyTypeObject *gResamplerType;
+
+/* Instances of heap types hold a reference to their type */
+void freeObject(PyObject *self)
+{
+    PyTypeObject *type = Py_TYPE(self);
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+void viewDealloc(View *self)
+{
+    Py_XDECREF(self->owner);
+    std::free(self->own);
+    freeObject((PyObject *)self);
+}
+
+int viewGetBuffer(View *self, Py_buffer *view, int flags)
+{
+    if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE)
+    {
+        PyErr_SetString(PyExc_BufferError, "mmwave views are read only");
+        view->obj = nullptr;
+        return -1;
+    }
+    view->obj = (PyObject *)self;
+    Py_INCREF(self);
+    view->buf = (void *)self->data;
+    view->len = self->shape[0] * self->strides[0];
+    view->readonly = 1;
+    view->itemsize = self->strides[0];
+    view->format = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT) ? (char *)self->format : nullptr;
+    view->ndim = 1;
+    view->shape = ((flags & PyBUF_ND) == PyBUF_ND) ? self->shape : nullptr;
+    view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->strides : nullptr;
+    view->suboffsets = nullptr;
+    view->internal = nullptr;
+    return 0;
+}
+
+Py_ssize_t viewLength(View *self)
+{
+    return self->shape[0];
+}
+
+PyObject *viewRepr(View *self)
+{
+    return PyUnicode_FromFormat("<mmwave.View %zd x '%s'>", self->shape[0], self->format);
+}
+
+PyObject *makeView(PyObject *owner, void *own, const uint8_t *data, size_t count, size_t itemsize,
+                   const char *format)
+{
+    View *v = PyObject_New(View, gViewType);
+    if (v == nullptr)
+    {
+        std::free(own);
+        return nullptr;
+    }
+    Py_XINCREF(owner);
+    v->owner = owner;
+    v->own = own;
+    v->data = data;
+    v->shape[0] = (Py_ssize_t)count;
+    v->strides[0] = (Py_ssize_t)itemsize;
+    v->format = format;
+    return (PyObject *)v;
+}
+
+/*
+ * Frame: one parsed packet. The bytes belong to owner (a FrameIter holding
+ * the source buffer), to src (parse()) or to own (copied out of a Reader).
+ */
+struct Frame
+{
+    PyObject_HEAD
+    PyObject        *owner;
+    Py_buffer       src;
+    int             haveSrc;
+    uint8_t         *own;
+    mmw::FrameView  view;
+    uint64_t        firstByteNs;
+    uint64_t        lastByteNs;
+};
+
+Frame *newFrame()
+{
+    Frame *f = PyObject_New(Frame, gFrameType);
+    if (f != nullptr)
+    {
+        f->owner = nullptr;
+        f->haveSrc = 0;
+        f->own = nullptr;
+        new (&f->view) mmw::FrameView();
+        f->firstByteNs = 0;
+        f->lastByteNs = 0;
+    }
+    return f;
+}
+
+void frameDealloc(Frame *self)
+{
+    Py_XDECREF(self->owner);
+    if (self->haveSrc)
+    {
+        PyBuffer_Release(&self->src);
+    }
+    std::free(self->own);
+    freeObject((PyObject *)self);
+}
+
+template <typename T>
+PyObject *spanView(Frame *self, const mmw::WireSpan<T> &span, const char *format)
+{
+    if (span.bytes() == nullptr)
+    {
+        Py_RETURN_NONE;
+    }
+    return makeView((PyObject *)self, nullptr, span.bytes(), span.size(), sizeof(T), format);
+}
+
+PyObject *frameObjects(Frame *self, void *)
+{
+    return spanView(self, self->view.objects, FORMAT_DET_OBJ);
+}
+
+PyObject *frameRangeProfile(Frame *self, void *)
+{
+    return spanView(self, self->view.rangeProfile, FORMAT_UINT16);
+}
+
+PyObject *frameNoiseProfile(Frame *self, void *)
+{
+    return spanView(self, self->view.noiseProfile, FORMAT_UINT16);
+}
+
+PyObject *frameAzimuthStatic(Frame *self, void *)
+{
+    return spanView(self, self->view.azimuthStatic, FORMAT_CMPLX16);
+}
+
+PyObject *frameRangeDoppler(Frame *self, void *)
+{
+    return spanView(self, self->view.rangeDopplerHeatMap, FORMAT_UINT16);
+}
+
+PyObject *frameRaw(Frame *self, void *)
+{
+    return makeView((PyObject *)self, nullptr, self->view.data, self->view.len, 1, FORMAT_BYTES);
+}
+
+PyObject *frameStats(Frame *self, void *)
+{
+    if (!self->view.haveStats)
+    {
+        Py_RETURN_NONE;
+    }
+    const mmw::Stats &s = self->view.stats;
+    return Py_BuildValue("{sksksksksksk}",
+                         "interFrameProcessingTime", (unsigned long)s.interFrameProcessingTime,
+                         "transmitOutputTime", (unsigned long)s.transmitOutputTime,
+                         "interFrameProcessingMargin", (unsigned long)s.interFrameProcessingMargin,
+                         "interChirpProcessingMargin", (unsigned long)s.interChirpProcessingMargin,
+                         "activeFrameCPULoad", (unsigned long)s.activeFrameCPULoad,
+                         "interFrameCPULoad", (unsigned long)s.interFrameCPULoad);
+}
+
+PyObject *frameTlvs(Frame *self, void *)
+{
+    PyObject *list = PyList_New(self->view.numTlvs);
+    if (list == nullptr)
+    {
+        return nullptr;
+    }
+    for (uint32_t i = 0; i < self->view.numTlvs; i++)
+    {
+        const mmw::TlvRef &t = self->view.tlvs[i];
+        PyObject *v = makeView((PyObject *)self, nullptr, t.payload, t.length, 1, FORMAT_BYTES);
+        PyObject *item = (v != nullptr) ? Py_BuildValue("(kN)", (unsigned long)t.type, v) : nullptr;
+        if (item == nullptr)
+        {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+    return list;
+}
+
+#define FRAME_INT(name, expr)                                   \
+    PyObject *name(Frame *self, void *)                         \
+    {                                                           \
+        return PyLong_FromUnsignedLongLong((expr));             \
+    }
+
+FRAME_INT(frameNumber, self->view.header.frameNumber)
+FRAME_INT(frameTime, self->view.header.timeCpuCycles)
+FRAME_INT(frameVersion, self->view.header.version)
+FRAME_INT(framePlatform, self->view.header.platform)
+FRAME_INT(frameNumDetectedObj, self->view.header.numDetectedObj)
+FRAME_INT(frameNumTlvs, self->view.numTlvs)
+FRAME_INT(frameTlvMask, self->view.tlvMask)
+FRAME_INT(frameXyzQFormat, self->view.objDescr.xyzQFormat)
+FRAME_INT(frameFirstByteNs, self->firstByteNs)
+FRAME_INT(frameLastByteNs, self->lastByteNs)
+
+#undef FRAME_INT
+
+PyObject *frameCrcChecked(Frame *self, void *)
+{
+    return PyBool_FromLong(self->view.crcChecked ? 1 : 0);
+}
+
+PyObject *frameTlv(Frame *self, PyObject *arg)
+{
+    const unsigned long type = PyLong_AsUnsignedLong(arg);
+    if (PyErr_Occurred())
+    {
+        return nullptr;
+    }
+    const mmw::TlvRef *t = self->view.find((uint32_t)type);
+    if (t == nullptr)
+    {
+        Py_RETURN_NONE;
+    }
+    return makeView((PyObject *)self, nullptr, t->payload, t->length, 1, FORMAT_BYTES);
+}
+
+PyObject *frameAzimuthComplex64(Frame *self, PyObject *)
+{
+    const mmw::WireSpan<mmw::Cmplx16ImRe> &az = self->view.azimuthStatic;
+    if (az.bytes() == nullptr)
+    {
+        Py_RETURN_NONE;
+    }
+    float *out = (float *)std::malloc(az.size() * 2U * sizeof(float) + 1U);
+    if (out == nullptr)
+    {
+        return PyErr_NoMemory();
+    }
+    Py_BEGIN_ALLOW_THREADS
+    for (size_t i = 0; i < az.size(); i++)
+    {
+        const mmw::Cmplx16ImRe c = az[i];
+        out[2U * i] = (float)c.real;
+        out[2U * i + 1U] = (float)c.imag;
+    }
+    Py_END_ALLOW_THREADS
+    return makeView(nullptr, out, (const uint8_t *)out, az.size(), 2U * sizeof(float), FORMAT_COMPLEX64);
+}
+
+PyObject *frameRepr(Frame *self)
+{
+    return PyUnicode_FromFormat("<mmwave.Frame %u: %u objects, %u TLVs, %u bytes>",
+                                self->view.header.frameNumber, self->view.header.numDetectedObj,
+                                self->view.numTlvs, self->view.len);
+}
+
+PyGetSetDef gFrameGetSet[] =
+{
+    { "frame_number", (getter)frameNumber, nullptr, "frameNumber of the header", nullptr },
+    { "time_cpu_cycles", (getter)frameTime, nullptr, "timeCpuCycles of the header", nullptr },
+    { "version", (getter)frameVersion, nullptr, "SDK version of the header", nullptr },
+    { "platform", (getter)framePlatform, nullptr, "platform of the header", nullptr },
+    { "num_detected_obj", (getter)frameNumDetectedObj, nullptr, "numDetectedObj of the header", nullptr },
+    { "num_tlvs", (getter)frameNumTlvs, nullptr, "number of TLVs", nullptr },
+    { "tlv_mask", (getter)frameTlvMask, nullptr, "bit n for TLV type n, bit 16 + n for type 0x100 + n", nullptr },
+    { "xyz_q_format", (getter)frameXyzQFormat, nullptr, "Q format of the object coordinates", nullptr },
+    { "crc_checked", (getter)frameCrcChecked, nullptr, "True when the packet carried a CRC and it matched", nullptr },
+    { "first_byte_ns", (getter)frameFirstByteNs, nullptr, "CLOCK_MONOTONIC of the first read, Reader only", nullptr },
+    { "last_byte_ns", (getter)frameLastByteNs, nullptr, "CLOCK_MONOTONIC of the last read, Reader and BusReader", nullptr },
+    { "objects", (getter)frameObjects, nullptr, "detected objects, records", nullptr },
+    { "range_profile", (getter)frameRangeProfile, nullptr, "range profile, uint16", nullptr },
+    { "noise_profile", (getter)frameNoiseProfile, nullptr, "noise profile, uint16", nullptr },
+    { "azimuth_static", (getter)frameAzimuthStatic, nullptr, "static azimuth heat map, int16 imag/real records", nullptr },
+    { "range_doppler_heatmap", (getter)frameRangeDoppler, nullptr, "range/Doppler heat map, uint16", nullptr },
+    { "stats", (getter)frameStats, nullptr, "timing statistics, dict", nullptr },
+    { "tlvs", (getter)frameTlvs, nullptr, "[(type, bytes view)] in packet order", nullptr },
+    { "raw", (getter)frameRaw, nullptr, "the whole packet, bytes view", nullptr },
+    { nullptr, nullptr, nullptr, nullptr, nullptr }
+};
+
+PyMethodDef gFrameMethods[] =
+{
+    { "tlv", (PyCFunction)frameTlv, METH_O, "tlv(type): payload of the first TLV of that type, or None" },
+    { "azimuth_complex64", (PyCFunction)frameAzimuthComplex64, METH_NOARGS,
+      "static azimuth heat map converted to complex64 (a copy), or None" },
+    { nullptr, nullptr, 0, nullptr }
+};
+
+/*
+ * FrameIter: packets of a buffer
+ */
+struct FrameIter
+{
+    PyObject_HEAD
+    Py_buffer       src;
+    const uint8_t   *cursor;
+    mmw::TlvParser  parser;
+};
+
+void iterDealloc(FrameIter *self)
+{
+    PyBuffer_Release(&self->src);
+    freeObject((PyObject *)self);
+}
+
+PyObject *iterNext(FrameIter *self)
+{
+    const uint8_t *end = (const uint8_t *)self->src.buf + self->src.len;
+    mmw::FrameView view;
+    int err;
+
+    Py_BEGIN_ALLOW_THREADS
+    err = self->parser.next(self->cursor, end, view);
+    Py_END_ALLOW_THREADS
+
+    if (err != mmw::PARSE_OK)
+    {
+        return nullptr;
+    }
+    Frame *f = newFrame();
+    if (f == nullptr)
+    {
+        return nullptr;
+    }
+    Py_INCREF(self);
+    f->owner = (PyObject *)self;
+    f->view = view;
+    return (PyObject *)f;
+}
+
+PyObject *iterStats(FrameIter *self, void *)
+{
+    const mmw::TlvParserStats &st = self->parser.stats();
+    return Py_BuildValue("{sKsKsKsKsK}", "frames", (unsigned long long)st.frames,
+                         "skipped_bytes", (unsigned long long)st.skippedBytes,
+                         "bad_frames", (unsigned long long)st.badFrames,
+                         "crc_errors", (unsigned long long)st.crcErrors,
+                         "resyncs", (unsigned long long)st.resyncs);
+}
+
+PyGetSetDef gIterGetSet[] =
+{
+    { "stats", (getter)iterStats, nullptr, "parser counters", nullptr },
+    { nullptr, nullptr, nullptr, nullptr, nullptr }
+};
+
+/*
+ * Reader: UartReader feeding a bounded queue of parsed packets
+ */
+struct Packet
+{
+    uint8_t         *data;
+    mmw::FrameView  view;
+    uint64_t        firstByteNs;
+    uint64_t        lastByteNs;
+};
+
+struct ReaderState
+{
+    mmw::UartReader         uart;
+    mmw::TlvParserConfig    parserCfg;
+    size_t                  maxQueue = 64;
+
+    std::mutex              lock;
+    std::condition_variable ready;
+    std::deque<Packet>      queue;
+    uint64_t                dropped = 0;
+    uint64_t                badFrames = 0;
+
+    /* Reader thread: the ring is reused, so the packet is copied once */
+    void onFrame(const mmw::UartFrame &frame)
+    {
+        Packet p;
+        p.data = (uint8_t *)std::malloc(frame.len);
+        if (p.data == nullptr)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            dropped++;
+            return;
+        }
+        std::memcpy(p.data, frame.data, frame.len);
+        const int err = mmw::parseFrame(p.data, frame.len, parserCfg, p.view);
+        p.firstByteNs = frame.firstByteNs;
+        p.lastByteNs = frame.lastByteNs;
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (err != mmw::PARSE_OK)
+        {
+            badFrames++;
+            std::free(p.data);
+            return;
+        }
+        if (queue.size() >= maxQueue)
+        {
+            /* The consumer is behind: the oldest frame goes */
+            std::free(queue.front().data);
+            queue.pop_front();
+            dropped++;
+        }
+        queue.push_back(p);
+        ready.notify_one();
+    }
+
+    ~ReaderState()
+    {
+        uart.close();
+        for (Packet &p : queue)
+        {
+            std::free(p.data);
+        }
+    }
+};
+
+struct Reader
+{
+    PyObject_HEAD
+    ReaderState     *st;
+};
+
+void readerClose(Reader *self)
+{
+    ReaderState *st = self->st;
+    self->st = nullptr;
+    if (st != nullptr)
+    {
+        /* Joins the reader thread, which never needs the GIL */
+        Py_BEGIN_ALLOW_THREADS
+        delete st;
+        Py_END_ALLOW_THREADS
+    }
+}
+
+void readerDealloc(Reader *self)
+{
+    readerClose(self);
+    freeObject((PyObject *)self);
+}
+
+int readerInit(Reader *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *kwlist[] = { "device", "baud", "queue", "sdk_major", nullptr };
+    const char      *device;
+    unsigned int    baud = 921600;
+    Py_ssize_t      queue = 64;
+    unsigned char   sdkMajor = 1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|InB", (char **)kwlist, &device, &baud, &queue, &sdkMajor))
+    {
+        return -1;
+    }
+    if (queue < 1)
+    {
+        PyErr_SetString(PyExc_ValueError, "queue must be at least 1");
+        return -1;
+    }
+    readerClose(self);
+
+    ReaderState *st = new (std::nothrow) ReaderState();
+    if (st == nullptr)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+    st->maxQueue = (size_t)queue;
+    st->parserCfg.sdkMajor = sdkMajor;
+
+    mmw::UartReaderConfig cfg;
+    cfg.device = device;
+    cfg.baudRate = baud;
+    cfg.maxPacketLen = st->parserCfg.maxPacketLen;
+    if (st->uart.open(cfg) < 0)
+    {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, device);
+        delete st;
+        return -1;
+    }
+    st->uart.addCallback([st](const mmw::UartFrame &frame) { st->onFrame(frame); });
+    if (st->uart.start() < 0)
+    {
+        PyErr_SetString(PyExc_OSError, "cannot start the reader thread");
+        delete st;
+        return -1;
+    }
+    self->st = st;
+    return 0;
+}
+
+/*
+ * Waits in slices so Ctrl-C gets through and the end of the port is seen;
+ * returns a new Frame, Py_None (timeout, end) with a reference, or nullptr
+ * with an exception set.
+ */
+PyObject *readerWait(Reader *self, double timeout)
+{
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point deadline = Clock::now() +
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>((timeout < 0.0) ? 0.0 : timeout));
+    ReaderState *st = self->st;
+    bool havePacket = false;
+    Packet p{};
+
+    if (st == nullptr)
+    {
+        PyErr_SetString(PyExc_ValueError, "reader is closed");
+        return nullptr;
+    }
+    while (true)
+    {
+        bool ended = false;
+        bool expired = false;
+
+        Py_BEGIN_ALLOW_THREADS
+        std::unique_lock<std::mutex> guard(st->lock);
+        Clock::time_point until = Clock::now() + std::chrono::milliseconds(100);
+        if ((timeout >= 0.0) && (deadline < until))
+        {
+            until = deadline;
+        }
+        st->ready.wait_until(guard, until, [st] { return !st->queue.empty(); });
+        if (!st->queue.empty())
+        {
+            p = st->queue.front();
+            st->queue.pop_front();
+            havePacket = true;
+        }
+        else
+        {
+            ended = !st->uart.running();
+            expired = (timeout >= 0.0) && (Clock::now() >= deadline);
+        }
+        Py_END_ALLOW_THREADS
+
+        if (havePacket || ended || expired)
+        {
+            break;
+        }
+        if (PyErr_CheckSignals() < 0)
+        {
+            return nullptr;
+        }
+    }
+    if (!havePacket)
+    {
+        Py_RETURN_NONE;
+    }
+
+    Frame *f = newFrame();
+    if (f == nullptr)
+    {
+        std::free(p.data);
+        return nullptr;
+    }
+    f->own = p.data;
+    f->view = p.view;
+    f->firstByteNs = p.firstByteNs;
+    f->lastByteNs = p.lastByteNs;
+    return (PyObject *)f;
+}
+
+PyObject *readerRead(Reader *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *kwlist[] = { "timeout", nullptr };
+    PyObject *timeoutObj = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", (char **)kwlist, &timeoutObj))
+    {
+        return nullptr;
+    }
+    double timeout = -1.0;
+    if (timeoutObj != Py_None)
+    {
+        timeout = PyFloat_AsDouble(timeoutObj);
+        if (PyErr_Occurred())
+        {
+            return nullptr;
+        }
+    }
+    return readerWait(self, timeout);
+}
+
+PyObject *readerNext(Reader *self)
+{
+    PyObject *f = readerWait(self, -1.0);
+    if (f == Py_None)
+    {
+        /* End of the port: StopIteration */
+        Py_DECREF(f);
+        return nullptr;
+    }
+    return f;
+}
+
+PyObject *readerCloseMethod(Reader *self, PyObject *)
+{
+    readerClose(self);
+    Py_RETURN_NONE;
+}
+
+PyObject *readerEnter(Reader *self, PyObject *)
+{
+    Py_INCREF(self);
+    return (PyObject *)self;
+}
+
+PyObject *readerExit(Reader *self, PyObject *)
+{
+    readerClose(self);
+    Py_RETURN_FALSE;
+}
+
+PyObject *readerStats(Reader *self, PyObject *)
+{
+    ReaderState *st = self->st;
+    if (st == nullptr)
+    {
+        PyErr_SetString(PyExc_ValueError, "reader is closed");
+        return nullptr;
+    }
+    const mmw::UartReaderStats us = st->uart.stats();
+    uint64_t dropped;
+    uint64_t badFrames;
+    size_t queued;
+    {
+        std::lock_guard<std::mutex> guard(st->lock);
+        dropped = st->dropped;
+        badFrames = st->badFrames;
+        queued = st->queue.size();
+    }
+    return Py_BuildValue("{sKsKsKsKsKsKsKsKsKsKsKsn}",
+                         "bytes_read", (unsigned long long)us.bytesRead,
+                         "reads", (unsigned long long)us.reads,
+                         "frames", (unsigned long long)us.frames,
+                         "skipped_bytes", (unsigned long long)us.skippedBytes,
+                         "bad_lengths", (unsigned long long)us.badLengths,
+                         "bad_packets", (unsigned long long)us.badPackets,
+                         "crc_errors", (unsigned long long)us.crcErrors,
+                         "resyncs", (unsigned long long)us.resyncs,
+                         "read_errors", (unsigned long long)us.readErrors,
+                         "bad_frames", (unsigned long long)badFrames,
+                         "dropped", (unsigned long long)dropped,
+                         "queued", (Py_ssize_t)queued);
+}
+
+PyObject *readerRunning(Reader *self, void *)
+{
+    return PyBool_FromLong((self->st != nullptr) && self->st->uart.running());
+}
+
+PyMethodDef gReaderMethods[] =
+{
+    { "read", (PyCFunction)(void (*)(void))readerRead, METH_VARARGS | METH_KEYWORDS,
+      "read(timeout=None): next Frame, None on timeout or once the port is gone" },
+    { "stats", (PyCFunction)readerStats, METH_NOARGS, "reader counters" },
+    { "close", (PyCFunction)readerCloseMethod, METH_NOARGS, "stops the reader and closes the port" },
+    { "__enter__", (PyCFunction)readerEnter, METH_NOARGS, nullptr },
+    { "__exit__", (PyCFunction)readerExit, METH_VARARGS, nullptr },
+    { nullptr, nullptr, 0, nullptr }
+};
+
+PyGetSetDef gReaderGetSet[] =
+{
+    { "running", (getter)readerRunning, nullptr, "False once the port is gone", nullptr },
+    { nullptr, nullptr, nullptr, nullptr, nullptr }
+};
+
+/*
+ * BusReader: consumer of a shared memory frame bus
+ */
+struct BusState
+{
+    mmw::FrameBusConsumer   bus;
+    mmw::TlvParserConfig    parserCfg;
+
+    /* The consumer is not thread safe; read() runs without the GIL */
+    std::mutex              lock;
+    uint64_t                frames = 0;
+    uint64_t                badFrames = 0;
+};
+
+struct BusReader
+{
+    PyObject_HEAD
+    BusState        *st;
+};
+
+void busReaderClose(BusReader *self)
+{
+    BusState *st = self->st;
+    self->st = nullptr;
+    if (st != nullptr)
+    {
+        /* Waits for a read() of another thread */
+        Py_BEGIN_ALLOW_THREADS
+        {
+            std::lock_guard<std::mutex> guard(st->lock);
+        }
+        delete st;
+        Py_END_ALLOW_THREADS
+    }
+}
+
+void busReaderDealloc(BusReader *self)
+{
+    busReaderClose(self);
+    freeObject((PyObject *)self);
+}
+
+int busReaderInit(BusReader *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *kwlist[] = { "bus", "name", "from_oldest", "sdk_major", nullptr };
+    const char      *busName = "mmw_frames";
+    const char      *name = "python";
+    int             fromOldest = 0;
+    unsigned char   sdkMajor = 1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|sspB", (char **)kwlist, &busName, &name, &fromOldest,
+                                     &sdkMajor))
+    {
+        return -1;
+    }
+    busReaderClose(self);
+
+    BusState *st = new (std::nothrow) BusState();
+    if (st == nullptr)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+    st->parserCfg.sdkMajor = sdkMajor;
+    if (st->bus.open(busName, name, fromOldest != 0) < 0)
+    {
+        PyErr_Format(PyExc_OSError, "no frame bus %s", busName);
+        delete st;
+        return -1;
+    }
+    self->st = st;
+    return 0;
+}
+
+/* As readerWait(): a new Frame, Py_None or nullptr with an exception set */
+PyObject *busReaderWait(BusReader *self, double timeout)
+{
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point deadline = Clock::now() +
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>((timeout < 0.0) ? 0.0 : timeout));
+    BusState *st = self->st;
+    bool havePacket = false;
+    Packet p{};
+
+    if (st == nullptr)
+    {
+        PyErr_SetString(PyExc_ValueError, "reader is closed");
+        return nullptr;
+    }
+    while (true)
+    {
+        bool ended = false;
+        bool expired = false;
+
+        Py_BEGIN_ALLOW_THREADS
+        std::lock_guard<std::mutex> guard(st->lock);
+        int sliceMs = 100;
+        if (timeout >= 0.0)
+        {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+            sliceMs = (int)std::max<long long>(0, std::min<long long>(sliceMs, left.count()));
+        }
+        mmw::FrameBusFrame frame;
+        while (!havePacket && (st->bus.next(frame, sliceMs) == 0))
+        {
+            /* Copied first, the slot may be reused under us */
+            p.data = (uint8_t *)std::malloc(frame.len);
+            if (p.data == nullptr)
+            {
+                break;
+            }
+            if (st->bus.copy(frame, p.data, frame.len) < 0)
+            {
+                std::free(p.data);
+                p.data = nullptr;
+                continue;
+            }
+            if (mmw::parseFrame(p.data, frame.len, st->parserCfg, p.view) != mmw::PARSE_OK)
+            {
+                st->badFrames++;
+                std::free(p.data);
+                p.data = nullptr;
+                continue;
+            }
+            p.lastByteNs = frame.hostNs;
+            st->frames++;
+            havePacket = true;
+        }
+        if (!havePacket)
+        {
+            ended = !st->bus.producerAlive();
+            expired = (timeout >= 0.0) && (Clock::now() >= deadline);
+        }
+        Py_END_ALLOW_THREADS
+
+        if (havePacket || ended || expired)
+        {
+            break;
+        }
+        if (PyErr_CheckSignals() < 0)
+        {
+            return nullptr;
+        }
+    }
+    if (!havePacket)
+    {
+        Py_RETURN_NONE;
+    }
+
+    Frame *f = newFrame();
+    if (f == nullptr)
+    {
+        std::free(p.data);
+        return nullptr;
+    }
+    f->own = p.data;
+    f->view = p.view;
+    f->lastByteNs = p.lastByteNs;
+    return (PyObject *)f;
+}
+
+PyObject *busReaderRead(BusReader *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *kwlist[] = { "timeout", nullptr };
+    PyObject *timeoutObj = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", (char **)kwlist, &timeoutObj))
+    {
+        return nullptr;
+    }
+    double timeout = -1.0;
+    if (timeoutObj != Py_None)
+    {
+        timeout = PyFloat_AsDouble(timeoutObj);
+        if (PyErr_Occurred())
+        {
+            return nullptr;
+        }
+    }
+    return busReaderWait(self, timeout);
+}
+
+PyObject *busReaderNext(BusReader *self)
+{
+    PyObject *f = busReaderWait(self, -1.0);
+    if (f == Py_None)
+    {
+        /* Publisher gone: StopIteration */
+        Py_DECREF(f);
+        return nullptr;
+    }
+    return f;
+}
+
+PyObject *busReaderCloseMethod(BusReader *self, PyObject *)
+{
+    busReaderClose(self);
+    Py_RETURN_NONE;
+}
+
+PyObject *busReaderEnter(BusReader *self, PyObject *)
+{
+    Py_INCREF(self);
+    return (PyObject *)self;
+}
+
+PyObject *busReaderExit(BusReader *self, PyObject *)
+{
+    busReaderClose(self);
+    Py_RETURN_FALSE;
+}
+
+PyObject *busReaderStats(BusReader *self, PyObject *)
+{
+    BusState *st = self->st;
+    if (st == nullptr)
+    {
+        PyErr_SetString(PyExc_ValueError, "reader is closed");
+        return nullptr;
+    }
+    uint64_t frames;
+    uint64_t badFrames;
+    uint64_t lost;
+    uint64_t cursor;
+    {
+        std::lock_guard<std::mutex> guard(st->lock);
+        frames = st->frames;
+        badFrames = st->badFrames;
+        lost = st->bus.lost();
+        cursor = st->bus.cursor();
+    }
+    const uint64_t w = st->bus.header()->writeSeq.load();
+    return Py_BuildValue("{sKsKsKsK}",
+                         "frames", (unsigned long long)frames,
+                         "bad_frames", (unsigned long long)badFrames,
+                         "lost", (unsigned long long)lost,
+                         "behind", (unsigned long long)((w > cursor) ? w - cursor : 0U));
+}
+
+PyObject *busReaderRunning(BusReader *self, void *)
+{
+    return PyBool_FromLong((self->st != nullptr) && self->st->bus.producerAlive());
+}
+
+PyMethodDef gBusReaderMethods[] =
+{
+    { "read", (PyCFunction)(void (*)(void))busReaderRead, METH_VARARGS | METH_KEYWORDS,
+      "read(timeout=None): next Frame, None on timeout or once the publisher is gone" },
+    { "stats", (PyCFunction)busReaderStats, METH_NOARGS, "consumer counters" },
+    { "close", (PyCFunction)busReaderCloseMethod, METH_NOARGS, "detaches from the bus" },
+    { "__enter__", (PyCFunction)busReaderEnter, METH_NOARGS, nullptr },
+    { "__exit__", (PyCFunction)busReaderExit, METH_VARARGS, nullptr },
+    { nullptr, nullptr, 0, nullptr }
+};
+
+PyGetSetDef gBusReaderGetSet[] =
+{
+    { "running", (getter)busReaderRunning, nullptr, "False once the publisher is gone", nullptr },
+    { nullptr, nullptr, nullptr, nullptr, nullptr }
+};
+
+/*
+ * PolarResampler: heat map to Cartesian image
+ */
+struct ResamplerState
+{
+    mmw::PolarResampler     resampler;
+
+    /* resample() runs without the GIL and takes one caller at a time */
+    std::mutex              lock;
+};
+
+struct Resampler
+{
+    PyObject_HEAD
+    ResamplerState  *st;
+};
+
+void resamplerDealloc(Resampler *self)
+{
+    /* Joins the workers, which never need the GIL */
+    Py_BEGIN_ALLOW_THREADS
+    delete self->st;
+    Py_END_ALLOW_THREADS
+    freeObject((PyObject *)self);
+}
+
+int resamplerInit(Resampler *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *kwlist[] = { "num_range_bins", "num_angle_bins", "range_resolution", "width", "height",
+                                    "x", "y", "interp", "mirror", "threads", nullptr };
+    mmw::PolarResamplerConfig cfg;
+    const char  *interp = "nearest";
+    int         mirror = 1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|IIfII(ff)(ff)spI", (char **)kwlist, &cfg.numRangeBins,
+                                     &cfg.numAngleBins, &cfg.rangeIdxToMeters, &cfg.width, &cfg.height,
+                                     &cfg.xMin, &cfg.xMax, &cfg.yMin, &cfg.yMax, &interp, &mirror,
+                                     &cfg.numThreads))
+    {
+        return -1;
+    }
+    if (std::strcmp(interp, "nearest") == 0)
+    {
+        cfg.interp = mmw::PolarInterp::NEAREST;
+    }
+    else if (std::strcmp(interp, "bilinear") == 0)
+    {
+        cfg.interp = mmw::PolarInterp::BILINEAR;
+    }
+    else
+    {
+        PyErr_SetString(PyExc_ValueError, "interp is \"nearest\" or \"bilinear\"");
+        return -1;
+    }
+    cfg.mirrorX = (mirror != 0);
+
+    ResamplerState *st = new (std::nothrow) ResamplerState();
+    if (st == nullptr)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+    int err;
+    Py_BEGIN_ALLOW_THREADS
+    err = st->resampler.configure(cfg);
+    Py_END_ALLOW_THREADS
+    if (err < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "bad geometry: at least 2 range and 4 angle bins, an image of some pixels");
+        delete st;
+        return -1;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    delete self->st;
+    Py_END_ALLOW_THREADS
+    self->st = st;
+    return 0;
+}
+
+/* A C contiguous float32 buffer of at least count values */
+bool floatBuffer(PyObject *obj, Py_buffer &buf, size_t count, bool writable, const char *what)
+{
+    if (PyObject_GetBuffer(obj, &buf, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0)) < 0)
+    {
+        return false;
+    }
+    const char *fmt = (buf.format != nullptr) ? buf.format : "B";
+    if ((*fmt == '<') || (*fmt == '=') || (*fmt == '@'))
+    {
+        fmt++;
+    }
+    if ((std::strcmp(fmt, FORMAT_FLOAT) != 0) || ((size_t)buf.len < count * sizeof(float)))
+    {
+        PyErr_Format(PyExc_ValueError, "%s has to be %zu float32 values", what, count);
+        PyBuffer_Release(&buf);
+        return false;
+    }
+    return true;
+}
+
+PyObject *resamplerResample(Resampler *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *kwlist[] = { "values", "out", nullptr };
+    PyObject *valuesObj;
+    PyObject *outObj = Py_None;
+    ResamplerState *st = self->st;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", (char **)kwlist, &valuesObj, &outObj))
+    {
+        return nullptr;
+    }
+    if (st == nullptr)
+    {
+        PyErr_SetString(PyExc_ValueError, "resampler is not configured");
+        return nullptr;
+    }
+    const size_t cells = st->resampler.numCells();
+    const size_t pixels = st->resampler.numPixels();
+
+    Py_buffer in;
+    if (!floatBuffer(valuesObj, in, cells, false, "values"))
+    {
+        return nullptr;
+    }
+    Py_buffer out;
+    float *own = nullptr;
+    float *image;
+    if (outObj != Py_None)
+    {
+        if (!floatBuffer(outObj, out, pixels, true, "out"))
+        {
+            PyBuffer_Release(&in);
+            return nullptr;
+        }
+        image = (float *)out.buf;
+    }
+    else
+    {
+        own = (float *)std::malloc(pixels * sizeof(float));
+        if (own == nullptr)
+        {
+            PyBuffer_Release(&in);
+            return PyErr_NoMemory();
+        }
+        image = own;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    std::lock_guard<std::mutex> guard(st->lock);
+    st->resampler.resample((const float *)in.buf, cells, image, pixels);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&in);
+
+    if (own == nullptr)
+    {
+        PyBuffer_Release(&out);
+        Py_INCREF(outObj);
+        return outObj;
+    }
+    return makeView(nullptr, own, (const uint8_t *)own, pixels, sizeof(float), FORMAT_FLOAT);
+}
+
+PyObject *resamplerShape(Resampler *self, void *)
+{
+    if (self->st == nullptr)
+    {
+        Py_RETURN_NONE;
+    }
+    const mmw::PolarResamplerConfig &cfg = self->st->resampler.config();
+    return Py_BuildValue("(II)", cfg.height, cfg.width);
+}
+
+PyObject *resamplerThreads(Resampler *self, void *)
+{
+    return PyLong_FromUnsignedLong((self->st != nullptr) ? self->st->resampler.numThreads() : 0U);
+}
+
+PyMethodDef gResamplerMethods[] =
+{
+    { "resample", (PyCFunction)(void (*)(void))resamplerResample, METH_VARARGS | METH_KEYWORDS,
+      "resample(values, out=None): image of a heat map; into out, or a new float32 View" },
+    { nullptr, nullptr, 0, nullptr }
+};
+
+PyGetSetDef gResamplerGetSet[] =
+{
+    { "shape", (getter)resamplerShape, nullptr, "(height, width) of the image", nullptr },
+    { "threads", (getter)resamplerThreads, nullptr, "threads per image", nullptr },
+    { nullptr, nullptr, nullptr, nullptr, nullptr }
+};
+
+/*
+ * Module functions
+ */
+bool parseBufferArgs(PyObject *args, PyObject *kwargs, Py_buffer &src, mmw::TlvParserConfig &cfg)
+{
+    static const char *kwlist[] = { "buffer", "sdk_major", nullptr };
+    unsigned char sdkMajor = 1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|B", (char **)kwlist, &src, &sdkMajor))
+    {
+        return false;
+    }
+    cfg.sdkMajor = sdkMajor;
+    return true;
+}
+
+PyObject *moduleFrames(PyObject *, PyObject *args, PyObject *kwargs)
+{
+    Py_buffer src;
+    mmw::TlvParserConfig cfg;
+
+    if (!parseBufferArgs(args, kwargs, src, cfg))
+    {
+        return nullptr;
+    }
+    FrameIter *it = PyObject_New(FrameIter, gFrameIterType);
+    if (it == nullptr)
+    {
+        PyBuffer_Release(&src);
+        return nullptr;
+    }
+    it->src = src;
+    it->cursor = (const uint8_t *)src.buf;
+    new (&it->parser) mmw::TlvParser(cfg);
+    return (PyObject *)it;
+}
+
+PyObject *moduleParse(PyObject *, PyObject *args, PyObject *kwargs)
+{
+    Py_buffer src;
+    mmw::TlvParserConfig cfg;
+
+    if (!parseBufferArgs(args, kwargs, src, cfg))
+    {
+        return nullptr;
+    }
+    Frame *f = newFrame();
+    if (f == nullptr)
+    {
+        PyBuffer_Release(&src);
+        return nullptr;
+    }
+    f->src = src;
+    f->haveSrc = 1;
+    const int err = mmw::parseFrame((const uint8_t *)src.buf, (size_t)src.len, cfg, f->view);
+    if (err != mmw::PARSE_OK)
+    {
+        Py_DECREF(f);
+        PyErr_SetString(PyExc_ValueError, parseErrorName(err));
+        return nullptr;
+    }
+    return (PyObject *)f;
+}
+
+PyObject *moduleFindMagic(PyObject *, PyObject *args)
+{
+    Py_buffer src;
+    Py_ssize_t start = 0;
+    const uint8_t *hit;
+
+    if (!PyArg_ParseTuple(args, "y*|n", &src, &start))
+    {
+        return nullptr;
+    }
+    if ((start < 0) || (start > src.len))
+    {
+        start = (start < 0) ? 0 : src.len;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    hit = mmw::findMagic((const uint8_t *)src.buf + start, (size_t)(src.len - start));
+    Py_END_ALLOW_THREADS
+    const Py_ssize_t pos = (hit != nullptr) ? (Py_ssize_t)(hit - (const uint8_t *)src.buf) : -1;
+    PyBuffer_Release(&src);
+    return PyLong_FromSsize_t(pos);
+}
+
+PyMethodDef gModuleMethods[] =
+{
+    { "frames", (PyCFunction)(void (*)(void))moduleFrames, METH_VARARGS | METH_KEYWORDS,
+      "frames(buffer, sdk_major=1): iterator over the packets of a bytes-like object" },
+    { "parse", (PyCFunction)(void (*)(void))moduleParse, METH_VARARGS | METH_KEYWORDS,
+      "parse(buffer, sdk_major=1): the packet at the start of buffer" },
+    { "find_magic", moduleFindMagic, METH_VARARGS,
+      "find_magic(buffer, start=0): offset of the next magic word, or -1" },
+    { nullptr, nullptr, 0, nullptr }
+};
+
+PyModuleDef gModule =
+{
+    PyModuleDef_HEAD_INIT, "mmwave", "mmw demo output packets as zero copy arrays", -1, gModuleMethods,
+    nullptr, nullptr, nullptr, nullptr
+};
+
+PyType_Slot gViewSlots[] =
+{
+    { Py_tp_doc, (void *)"Read only array in a frame, exported through the buffer protocol" },
+    { Py_tp_dealloc, (void *)viewDealloc },
+    { Py_tp_repr, (void *)viewRepr },
+    { Py_sq_length, (void *)viewLength },
+    { Py_bf_getbuffer, (void *)viewGetBuffer },
+    { 0, nullptr }
+};
+
+PyType_Slot gFrameSlots[] =
+{
+    { Py_tp_doc, (void *)"Parsed output packet" },
+    { Py_tp_dealloc, (void *)frameDealloc },
+    { Py_tp_repr, (void *)frameRepr },
+    { Py_tp_getset, (void *)gFrameGetSet },
+    { Py_tp_methods, (void *)gFrameMethods },
+    { 0, nullptr }
+};
+
+PyType_Slot gFrameIterSlots[] =
+{
+    { Py_tp_doc, (void *)"Packets of a buffer" },
+    { Py_tp_dealloc, (void *)iterDealloc },
+    { Py_tp_iter, (void *)PyObject_SelfIter },
+    { Py_tp_iternext, (void *)iterNext },
+    { Py_tp_getset, (void *)gIterGetSet },
+    { 0, nullptr }
+};
+
+PyType_Slot gReaderSlots[] =
+{
+    { Py_tp_doc, (void *)"Reader(device, baud=921600, queue=64, sdk_major=1): output packets of the UART data port" },
+    { Py_tp_new, (void *)PyType_GenericNew },
+    { Py_tp_init, (void *)readerInit },
+    { Py_tp_dealloc, (void *)readerDealloc },
+    { Py_tp_iter, (void *)PyObject_SelfIter },
+    { Py_tp_iternext, (void *)readerNext },
+    { Py_tp_methods, (void *)gReaderMethods },
+    { Py_tp_getset, (void *)gReaderGetSet },
+    { 0, nullptr }
+};
+
+PyType_Slot gBusReaderSlots[] =
+{
+    { Py_tp_doc, (void *)"BusReader(bus=\"mmw_frames\", name=\"python\", from_oldest=False, sdk_major=1):"
+                         " output packets of a frame bus" },
+    { Py_tp_new, (void *)PyType_GenericNew },
+    { Py_tp_init, (void *)busReaderInit },
+    { Py_tp_dealloc, (void *)busReaderDealloc },
+    { Py_tp_iter, (void *)PyObject_SelfIter },
+    { Py_tp_iternext, (void *)busReaderNext },
+    { Py_tp_methods, (void *)gBusReaderMethods },
+    { Py_tp_getset, (void *)gBusReaderGetSet },
+    { 0, nullptr }
+};
+
+PyType_Slot gResamplerSlots[] =
+{
+    { Py_tp_doc, (void *)"PolarResampler(num_range_bins=256, num_angle_bins=64, range_resolution=0.047392004,"
+                         " width=100, height=100, x=(-5, 5), y=(0, 5), interp=\"nearest\", mirror=True,"
+                         " threads=0): range/azimuth heat map to Cartesian image" },
+    { Py_tp_new, (void *)PyType_GenericNew },
+    { Py_tp_init, (void *)resamplerInit },
+    { Py_tp_dealloc, (void *)resamplerDealloc },
+    { Py_tp_methods, (void *)gResamplerMethods },
+    { Py_tp_getset, (void *)gResamplerGetSet },
+    { 0, nullptr }
+};
+
+PyType_Spec gViewSpec = { "mmwave.View", sizeof(View), 0, Py_TPFLAGS_DEFAULT, gViewSlots };
+PyType_Spec gFrameSpec = { "mmwave.Frame", sizeof(Frame), 0, Py_TPFLAGS_DEFAULT, gFrameSlots };
+PyType_Spec gFrameIterSpec = { "mmwave.FrameIter", sizeof(FrameIter), 0, Py_TPFLAGS_DEFAULT, gFrameIterSlots };
+PyType_Spec gReaderSpec = { "mmwave.Reader", sizeof(Reader), 0, Py_TPFLAGS_DEFAULT, gReaderSlots };
+PyType_Spec gBusReaderSpec = { "mmwave.BusReader", sizeof(BusReader), 0, Py_TPFLAGS_DEFAULT, gBusReaderSlots };
+PyType_Spec gResamplerSpec = { "mmwave.PolarResampler", sizeof(Resampler), 0, Py_TPFLAGS_DEFAULT, gResamplerSlots };
+
+bool addType(PyObject *m, PyType_Spec *spec, PyTypeObject *&type)
+{
+    type = (PyTypeObject *)PyType_FromSpec(spec);
+    return (type != nullptr) && (PyModule_AddType(m, type) == 0);
+}
+
+} /* anonymous namespace */
+
+PyMODINIT_FUNC PyInit_mmwave(void)
+{
+    PyObject *m = PyModule_Create(&gModule);
+    if (m == nullptr)
+    {
+        return nullptr;
+    }
+    if (!addType(m, &gViewSpec, gViewType) || !addType(m, &gFrameSpec, gFrameType) ||
+        !addType(m, &gFrameIterSpec, gFrameIterType) || !addType(m, &gReaderSpec, gReaderType) ||
+        !addType(m, &gBusReaderSpec, gBusReaderType) || !addType(m, &gResamplerSpec, gResamplerType))
+    {
+        Py_DECREF(m);
+        return nullptr;
+    }
+    PyModule_AddObject(m, "MAGIC_WORD", PyBytes_FromStringAndSize((const char *)mmw::MAGIC_WORD,
+                                                                  sizeof(mmw::MAGIC_WORD)));
+    PyModule_AddIntConstant(m, "TLV_DETECTED_POINTS", mmw::TLV_DETECTED_POINTS);
+    PyModule_AddIntConstant(m, "TLV_RANGE_PROFILE", mmw::TLV_RANGE_PROFILE);
+    PyModule_AddIntConstant(m, "TLV_NOISE_PROFILE", mmw::TLV_NOISE_PROFILE);
+    PyModule_AddIntConstant(m, "TLV_AZIMUTH_STATIC_HEAT_MAP", mmw::TLV_AZIMUTH_STATIC_HEAT_MAP);
+    PyModule_AddIntConstant(m, "TLV_RANGE_DOPPLER_HEAT_MAP", mmw::TLV_RANGE_DOPPLER_HEAT_MAP);
+    PyModule_AddIntConstant(m, "TLV_STATS", mmw::TLV_STATS);
+    PyModule_AddIntConstant(m, "TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED", mmw::TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED);
+    PyModule_AddIntConstant(m, "TLV_RANGE_DOPPLER_HEAT_MAP_SPARSE", mmw::TLV_RANGE_DOPPLER_HEAT_MAP_SPARSE);
+    PyModule_AddIntConstant(m, "TLV_AZIMUTH_HEAT_MAP_MAGNITUDE", mmw::TLV_AZIMUTH_HEAT_MAP_MAGNITUDE);
+    PyModule_AddIntConstant(m, "TLV_DSS_STATS", mmw::TLV_DSS_STATS);
+    PyModule_AddIntConstant(m, "TLV_MSS_STATS", mmw::TLV_MSS_STATS);
+    PyModule_AddIntConstant(m, "TLV_OUTPUT_SHED", mmw::TLV_OUTPUT_SHED);
+    PyModule_AddIntConstant(m, "TLV_QUIET", mmw::TLV_QUIET);
+    PyModule_AddIntConstant(m, "TLV_RANGE_PROFILE_DELTA", mmw::TLV_RANGE_PROFILE_DELTA);
+    PyModule_AddIntConstant(m, "TLV_NOISE_PROFILE_DELTA", mmw::TLV_NOISE_PROFILE_DELTA);
+    PyModule_AddIntConstant(m, "TLV_PACKET_CRC", mmw::TLV_PACKET_CRC);
+    return m;
+}
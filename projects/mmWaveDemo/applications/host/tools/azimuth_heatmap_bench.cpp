@@ -0,0 +1,228 @@
+/**
+ *   @file  azimuth_heatmap_bench.cpp
+ *
+ *   @brief
+ *      Link bytes and host cost of the range/azimuth magnitude heat map
+ *      against the raw azimuth heat map the visualizer transforms itself.
+ *
+ *      Run: build/azimuth_heatmap_bench [-r numRangeBins] [-a numVirtualAnt] [-n frames]
+ *
+ *      Frames are synthesized: complex noise on every antenna plus a few
+ *      point targets at known angles. The raw path is timed as the 64 point
+ *      angle FFT rangeAzim.py runs per range bin, the device path as parsing
+ *      and decoding the TLV.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <unistd.h>
+
+#include "azimuth_heatmap.h"
+#include "mmw_wire.h"
+
+namespace
+{
+
+struct Target
+{
+    uint32_t    rangeIdx;
+    float       sinTheta;
+    float       amplitude;
+};
+
+const Target TARGETS[] =
+{
+    {  30U, -0.50f, 3000.0f },
+    {  80U,  0.00f, 1500.0f },
+    { 150U,  0.25f,  800.0f },
+    { 200U,  0.75f,  400.0f },
+};
+
+/* numRangeBins x numVirtualAnt cmplx16ImRe_t, as in the raw TLV */
+void synthesize(uint32_t numRangeBins, uint32_t numVirtualAnt, std::mt19937 &rng, std::vector<uint8_t> &out)
+{
+    std::normal_distribution<float> noise(0.0f, 20.0f);
+    std::vector<float> re((size_t)numRangeBins * numVirtualAnt);
+    std::vector<float> im(re.size());
+
+    for (size_t i = 0; i < re.size(); i++)
+    {
+        re[i] = noise(rng);
+        im[i] = noise(rng);
+    }
+    for (const Target &t : TARGETS)
+    {
+        if (t.rangeIdx >= numRangeBins)
+        {
+            continue;
+        }
+        /* Half wavelength spacing, the phase advances by pi sin(theta) per antenna */
+        for (uint32_t n = 0; n < numVirtualAnt; n++)
+        {
+            const float phi = (float)M_PI * t.sinTheta * (float)n;
+            re[(size_t)t.rangeIdx * numVirtualAnt + n] += t.amplitude * std::cos(phi);
+            im[(size_t)t.rangeIdx * numVirtualAnt + n] += t.amplitude * std::sin(phi);
+        }
+    }
+
+    out.resize(re.size() * 2U * sizeof(int16_t));
+    for (size_t i = 0; i < re.size(); i++)
+    {
+        const int16_t s[2] = { (int16_t)std::lround(im[i]), (int16_t)std::lround(re[i]) };
+        std::memcpy(&out[i * sizeof(s)], s, sizeof(s));
+    }
+}
+
+double seconds(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    uint32_t    numRangeBins = 256;
+    uint32_t    numVirtualAnt = 8;
+    uint32_t    numFrames = 50;
+    int         opt;
+
+    while ((opt = getopt(argc, argv, "r:a:n:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'r': numRangeBins = (uint32_t)atoi(optarg); break;
+        case 'a': numVirtualAnt = (uint32_t)atoi(optarg); break;
+        case 'n': numFrames = (uint32_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-r range] [-a antennas] [-n frames]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((numRangeBins == 0) || (numVirtualAnt < 2) || (numVirtualAnt > 16) || (numFrames == 0))
+    {
+        fprintf(stderr, "invalid configuration\n");
+        return 1;
+    }
+
+    std::mt19937 rng(1);
+    std::vector<std::vector<uint8_t>> raw(numFrames);
+    for (uint32_t f = 0; f < numFrames; f++)
+    {
+        synthesize(numRangeBins, numVirtualAnt, rng, raw[f]);
+    }
+    const size_t rawLen = raw[0].size();
+    printf("synthetic: %u frames, %u range bins, %u virtual antennas\n", numFrames, numRangeBins, numVirtualAnt);
+    printf("raw (type 4)            %8zu bytes/frame\n", rawLen);
+
+    /* Host side of the raw path: what the visualizer computes per frame */
+    std::vector<uint8_t> hostMap(mmw::azimuthHeatMapSize(numRangeBins, 64, MMW_AZIMUTH_HEATMAP_FORMAT_U16));
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t f = 0; f < numFrames; f++)
+    {
+        if (mmw::computeAzimuthHeatMap(raw[f].data(), numRangeBins, numVirtualAnt, 64,
+                                       MMW_AZIMUTH_HEATMAP_FORMAT_U16, hostMap.data(), hostMap.size()) < 0)
+        {
+            fprintf(stderr, "host angle FFT failed\n");
+            return 1;
+        }
+    }
+    printf("  host 64 bin FFT       %8.1f us/frame\n", seconds(t0) / numFrames * 1e6);
+
+    static const uint32_t BINS[] = { 8, 16, 32, 64 };
+    static const uint8_t  FORMATS[] = { MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG, MMW_AZIMUTH_HEATMAP_FORMAT_U16 };
+
+    printf("magnitude (type 0x%x)\n", (unsigned)mmw::TLV_AZIMUTH_HEAT_MAP_MAGNITUDE);
+    printf("  bins format    bytes/frame  vs raw  decode us/frame  peak ok  max dB err\n");
+    for (uint32_t bins : BINS)
+    {
+        if (bins < numVirtualAnt)
+        {
+            continue;
+        }
+        for (uint8_t format : FORMATS)
+        {
+            const size_t len = mmw::azimuthHeatMapSize(numRangeBins, bins, format);
+            std::vector<std::vector<uint8_t>> tlv(numFrames, std::vector<uint8_t>(len));
+            std::vector<uint8_t> ref(mmw::azimuthHeatMapSize(numRangeBins, bins, MMW_AZIMUTH_HEATMAP_FORMAT_U16));
+            std::vector<float> decoded((size_t)numRangeBins * bins);
+            mmw::AzimuthHeatMap view;
+            mmw::AzimuthHeatMap refView;
+
+            /* Stand-in for the DSS */
+            for (uint32_t f = 0; f < numFrames; f++)
+            {
+                if (mmw::computeAzimuthHeatMap(raw[f].data(), numRangeBins, numVirtualAnt, bins,
+                                               format, tlv[f].data(), len) != (int)len)
+                {
+                    fprintf(stderr, "%u bins: computing the heat map failed\n", bins);
+                    return 1;
+                }
+            }
+
+            t0 = std::chrono::steady_clock::now();
+            for (uint32_t f = 0; f < numFrames; f++)
+            {
+                if ((view.parse(tlv[f].data(), len) < 0) || (view.decode(decoded.data(), decoded.size()) < 0))
+                {
+                    fprintf(stderr, "%u bins: decoding failed\n", bins);
+                    return 1;
+                }
+            }
+            const double decodeTime = seconds(t0);
+
+            /* Targets have to peak in the bin nearest to their angle and the
+             * log format has to stay within its quantization of the linear map */
+            uint32_t peaksOk = 0;
+            uint32_t numPeaks = 0;
+            double   maxDbErr = 0.0;
+            for (uint32_t f = 0; f < numFrames; f++)
+            {
+                view.parse(tlv[f].data(), len);
+                view.decode(decoded.data(), decoded.size());
+                mmw::computeAzimuthHeatMap(raw[f].data(), numRangeBins, numVirtualAnt, bins,
+                                           MMW_AZIMUTH_HEATMAP_FORMAT_U16, ref.data(), ref.size());
+                refView.parse(ref.data(), ref.size());
+
+                for (const Target &t : TARGETS)
+                {
+                    if (t.rangeIdx >= numRangeBins)
+                    {
+                        continue;
+                    }
+                    const float *line = &decoded[(size_t)t.rangeIdx * bins];
+                    uint32_t best = 0;
+                    for (uint32_t k = 1; k < bins; k++)
+                    {
+                        best = (line[k] > line[best]) ? k : best;
+                    }
+                    const float expected = std::round(t.sinTheta * (float)bins / 2.0f) + (float)(bins / 2U);
+                    /* Neighbours of the peak can quantize to the same log value */
+                    peaksOk += (line[(uint32_t)expected] >= line[best]) ? 1U : 0U;
+                    numPeaks++;
+
+                    for (uint32_t k = 0; k < bins; k++)
+                    {
+                        const float r = refView.magnitude(t.rangeIdx, k);
+                        if (r >= 8.0f)
+                        {
+                            const double err = std::fabs(20.0 * std::log10((double)line[k] / (double)r));
+                            maxDbErr = (err > maxDbErr) ? err : maxDbErr;
+                        }
+                    }
+                }
+            }
+
+            printf("  %4u %-6s  %11zu  %6.2f  %15.2f  %3u/%-3u  %10.2f\n", bins,
+                   (format == MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG) ? "u8 log" : "u16",
+                   len, (double)rawLen / (double)len, decodeTime / numFrames * 1e6,
+                   peaksOk, numPeaks, maxDbErr);
+        }
+    }
+    return 0;
+}
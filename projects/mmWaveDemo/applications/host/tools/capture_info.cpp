@@ -0,0 +1,162 @@
+/**
+ *   @file  capture_info.cpp
+ *
+ *   @brief
+ *      Prints what an indexed capture file holds.
+ *
+ *      Run: build/capture_info [-c] [-f frameNumber] [-s seconds] [-V] capture.mmwcap
+ *
+ *      Header, frame count, duration, frame number gaps and how often each
+ *      TLV type occurs. -c prints the recorded .cfg, -f and -s seek to a
+ *      frame number or to seconds after the first frame, -V parses every
+ *      packet and times random seeks.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+
+#include <unistd.h>
+
+#include "capture_file.h"
+#include "tlv_parser.h"
+
+namespace
+{
+
+void printEntry(const mmw::CaptureFile &cap, size_t i)
+{
+    if (i >= cap.numFrames())
+    {
+        printf("  past the end\n");
+        return;
+    }
+    const mmw::CaptureIndexEntry &e = cap.entry(i);
+    printf("  #%zu: frame %u at %+.3f s, timeCpuCycles %u, %u bytes at offset %llu, TLV mask 0x%x\n", i,
+           e.frameNumber, (double)(e.hostNs - cap.entry(0).hostNs) / 1e9, e.timeCpuCycles, e.len,
+           (unsigned long long)e.offset, e.tlvMask);
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    bool        printCfg = false;
+    bool        verify = false;
+    long long   frameNumber = -1;
+    double      seconds = -1.0;
+    int         c;
+
+    while ((c = getopt(argc, argv, "cf:s:V")) != -1)
+    {
+        switch (c)
+        {
+        case 'c': printCfg = true; break;
+        case 'f': frameNumber = atoll(optarg); break;
+        case 's': seconds = atof(optarg); break;
+        case 'V': verify = true; break;
+        default:
+            fprintf(stderr, "usage: %s [-c] [-f frameNumber] [-s seconds] [-V] capture.mmwcap\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc)
+    {
+        fprintf(stderr, "no capture file\n");
+        return 1;
+    }
+
+    mmw::CaptureFile cap;
+    if (cap.open(argv[optind]) < 0)
+    {
+        fprintf(stderr, "%s: not a capture file\n", argv[optind]);
+        return 1;
+    }
+    const mmw::CaptureFileHeader &hdr = cap.header();
+    const time_t created = (time_t)(hdr.createdRealtimeNs / 1000000000ULL);
+    char when[64];
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&created));
+    printf("%s: version %u, created %s, %u bytes of cfg%s\n", argv[optind], hdr.version, when, hdr.cfgLen,
+           cap.recovered() ? ", index rebuilt from the segments" : "");
+
+    const size_t n = cap.numFrames();
+    if (n > 0U)
+    {
+        uint64_t bytes = 0;
+        uint64_t gaps = 0;
+        uint64_t typeCount[32] = { 0 };
+        for (size_t i = 0; i < n; i++)
+        {
+            const mmw::CaptureIndexEntry &e = cap.entry(i);
+            bytes += e.len;
+            if ((i > 0U) && (e.frameNumber != cap.entry(i - 1U).frameNumber + 1U))
+            {
+                gaps++;
+            }
+            for (uint32_t b = 0; b < 32U; b++)
+            {
+                typeCount[b] += (e.tlvMask >> b) & 1U;
+            }
+        }
+        const double span = (double)(cap.entry(n - 1U).hostNs - cap.entry(0).hostNs) / 1e9;
+        printf("%zu frames %u..%u, %.1f MB, %.3f s, %.2f fps, %llu frame number gaps\n", n,
+               cap.entry(0).frameNumber, cap.entry(n - 1U).frameNumber, bytes / 1e6, span,
+               (span > 0.0) ? (n - 1U) / span : 0.0, (unsigned long long)gaps);
+        printf("TLVs:");
+        for (uint32_t b = 0; b < 32U; b++)
+        {
+            if (typeCount[b] != 0U)
+            {
+                printf(" 0x%x:%llu", (b < 16U) ? b : MMWDEMO_OUTPUT_EXT_MSG_BASE + b - 16U,
+                       (unsigned long long)typeCount[b]);
+            }
+        }
+        printf("\n");
+    }
+    if (printCfg)
+    {
+        printf("--- cfg ---\n%s", cap.cfgText().c_str());
+        printf("--- end ---\n");
+    }
+    if ((frameNumber >= 0) && (n > 0U))
+    {
+        printf("frame %lld:\n", frameNumber);
+        printEntry(cap, cap.seekFrame((uint32_t)frameNumber));
+    }
+    if ((seconds >= 0.0) && (n > 0U))
+    {
+        printf("%.3f s:\n", seconds);
+        printEntry(cap, cap.seekTime(cap.entry(0).hostNs + (uint64_t)(seconds * 1e9)));
+    }
+
+    if (verify && (n > 0U))
+    {
+        mmw::TlvParserConfig parserCfg;
+        parserCfg.sdkMajor = 0;
+        mmw::FrameView view;
+        uint64_t bad = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            if (mmw::parseFrame(cap.packet(i), cap.entry(i).len, parserCfg, view) != mmw::PARSE_OK)
+            {
+                bad++;
+            }
+        }
+        printf("%llu of %zu packets fail to parse\n", (unsigned long long)bad, n);
+
+        std::mt19937 rng(1);
+        const uint32_t first = cap.entry(0).frameNumber;
+        const uint32_t range = cap.entry(n - 1U).frameNumber - first + 1U;
+        const uint32_t numSeeks = 1000000;
+        size_t sink = 0;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < numSeeks; i++)
+        {
+            sink += cap.seekFrame(first + rng() % range);
+        }
+        const double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        printf("seekFrame: %.0f ns per seek (%zu)\n", dt / numSeeks * 1e9, sink % 10U);
+    }
+    return 0;
+}
@@ -0,0 +1,149 @@
+/**
+ *   @file  capture_record.cpp
+ *
+ *   @brief
+ *      Records the output packets into an indexed capture file.
+ *
+ *      Run: build/capture_record -o out.mmwcap [-c profile.cfg]
+ *                                (-d device [-b baud] [-t seconds] | -i raw.bin [-p periodMs])
+ *                                [-S segmentKB] [-D]
+ *
+ *      From the UART data port (-d), or converted from a raw dump of it
+ *      (-i, one packet every -p ms of made up host time, 100 by default).
+ *      -c stores the .cfg the sensor was started with, -D writes with
+ *      O_DIRECT. Ends on ^C, after -t seconds or when the port goes away.
+ */
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <unistd.h>
+
+#include "capture_file.h"
+#include "raw_capture.h"
+#include "uart_reader.h"
+
+namespace
+{
+
+volatile std::sig_atomic_t gStop = 0;
+
+void onSignal(int)
+{
+    gStop = 1;
+}
+
+void printStats(const mmw::CaptureWriterStats &st)
+{
+    printf("%llu frames, %.1f MB, %llu segments written, %llu dropped, %llu write errors\n",
+           (unsigned long long)st.frames, st.bytes / 1e6, (unsigned long long)st.segments,
+           (unsigned long long)st.dropped, (unsigned long long)st.writeErrors);
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    mmw::CaptureWriterConfig wcfg;
+    mmw::UartReaderConfig    rcfg;
+    const char  *cfgPath = nullptr;
+    const char  *rawPath = nullptr;
+    double      duration = 0.0;
+    double      periodMs = 100.0;
+    int         c;
+
+    while ((c = getopt(argc, argv, "o:c:d:b:t:i:p:S:D")) != -1)
+    {
+        switch (c)
+        {
+        case 'o': wcfg.path = optarg; break;
+        case 'c': cfgPath = optarg; break;
+        case 'd': rcfg.device = optarg; break;
+        case 'b': rcfg.baudRate = (uint32_t)atoi(optarg); break;
+        case 't': duration = atof(optarg); break;
+        case 'i': rawPath = optarg; break;
+        case 'p': periodMs = atof(optarg); break;
+        case 'S': wcfg.segmentSize = (size_t)atoi(optarg) * 1024U; break;
+        case 'D': wcfg.direct = true; break;
+        default:
+            fprintf(stderr, "usage: %s -o out.mmwcap [-c profile.cfg] (-d device [-b baud] [-t seconds] |"
+                    " -i raw.bin [-p periodMs]) [-S segmentKB] [-D]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (wcfg.path.empty() || (rcfg.device.empty() == (rawPath == nullptr)))
+    {
+        fprintf(stderr, "need -o and one of -d, -i\n");
+        return 1;
+    }
+    if (cfgPath != nullptr)
+    {
+        std::ifstream in(cfgPath);
+        if (!in)
+        {
+            fprintf(stderr, "cannot read %s\n", cfgPath);
+            return 1;
+        }
+        std::ostringstream text;
+        text << in.rdbuf();
+        wcfg.cfgText = text.str();
+    }
+
+    mmw::CaptureWriter writer;
+    if (writer.open(wcfg) < 0)
+    {
+        perror(wcfg.path.c_str());
+        return 1;
+    }
+
+    if (rawPath != nullptr)
+    {
+        mmw::RawCapture raw;
+        if (raw.load(rawPath) < 0)
+        {
+            fprintf(stderr, "no output packets in %s\n", rawPath);
+            return 1;
+        }
+        const uint64_t periodNs = (uint64_t)(periodMs * 1e6);
+        for (size_t i = 0; i < raw.packets().size(); i++)
+        {
+            writer.append(raw.packet(i), raw.packets()[i].len, (i + 1U) * periodNs);
+        }
+        const int err = writer.close();
+        printStats(writer.stats());
+        return (err < 0) ? 1 : 0;
+    }
+
+    mmw::UartReader reader;
+    if (reader.open(rcfg) < 0)
+    {
+        perror(rcfg.device.c_str());
+        return 1;
+    }
+    reader.addCallback([&writer](const mmw::UartFrame &frame)
+    {
+        writer.append(frame.data, frame.len, frame.lastByteNs);
+    });
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    reader.start();
+
+    const auto t0 = std::chrono::steady_clock::now();
+    while (!gStop && reader.running())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if ((duration > 0.0) &&
+            (std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() >= duration))
+        {
+            break;
+        }
+    }
+    reader.close();
+    const int err = writer.close();
+    printStats(writer.stats());
+    return (err < 0) ? 1 : 0;
+}
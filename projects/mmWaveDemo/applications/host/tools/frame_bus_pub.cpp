@@ -0,0 +1,183 @@
+/**
+ *   @file  frame_bus_pub.cpp
+ *
+ *   @brief
+ *      The one process on the data port: publishes the output packets on
+ *      a shared memory frame bus for any number of consumers.
+ *
+ *      Run: build/frame_bus_pub [-n bus] [-N slots] [-S slotKB]
+ *                               (-d device [-b baud] |
+ *                                -x capture.mmwcap [-s speed] [-C device|frame|host] [-l loops])
+ *
+ *      From the UART data port (-d) or replayed from a capture file (-x,
+ *      -s the speed, 1 the recorded cadence, 0 as fast as possible; -C
+ *      what the cadence is taken from; -l the passes, 0 loops forever). The bus is /dev/shm/<bus>, mmw_frames by
+ *      default, keeping the last -N packets (64) of up to -S KB (128).
+ *      Once a second the publish rate and, per consumer on the bus, how far
+ *      behind it is and how many packets it lost are printed. The bus stays
+ *      in /dev/shm on exit so a restarted publisher picks up its consumers.
+ */
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include <unistd.h>
+
+#include "capture_file.h"
+#include "frame_bus.h"
+#include "host_clock.h"
+#include "replay.h"
+#include "uart_reader.h"
+
+namespace
+{
+
+volatile std::sig_atomic_t gStop = 0;
+
+void onSignal(int)
+{
+    gStop = 1;
+}
+
+void printConsumers(const mmw::FrameBusHeader &hdr)
+{
+    const uint64_t w = hdr.writeSeq.load();
+    for (uint32_t i = 0; i < mmw::FRAME_BUS_MAX_CONSUMERS; i++)
+    {
+        const mmw::FrameBusConsumerInfo &info = hdr.consumers[i];
+        const int32_t pid = info.pid.load();
+        if (pid == 0)
+        {
+            continue;
+        }
+        const uint64_t cursor = info.cursor.load(std::memory_order_relaxed);
+        printf("    %-16.16s pid %6d  behind %6llu  lost %8llu\n", info.name, (int)pid,
+               (unsigned long long)((w > cursor) ? w - cursor : 0U),
+               (unsigned long long)info.lost.load(std::memory_order_relaxed));
+    }
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    mmw::FrameBusConfig     bcfg;
+    mmw::UartReaderConfig   rcfg;
+    mmw::ReplayConfig       pcfg;
+    const char  *capPath = nullptr;
+    int         c;
+
+    while ((c = getopt(argc, argv, "n:N:S:d:b:x:s:C:l:")) != -1)
+    {
+        switch (c)
+        {
+        case 'n': bcfg.name = optarg; break;
+        case 'N': bcfg.slotCount = (uint32_t)atoi(optarg); break;
+        case 'S': bcfg.slotSize = (uint32_t)atoi(optarg) * 1024U; break;
+        case 'd': rcfg.device = optarg; break;
+        case 'b': rcfg.baudRate = (uint32_t)atoi(optarg); break;
+        case 'x': capPath = optarg; break;
+        case 's': pcfg.speed = atof(optarg); break;
+        case 'C':
+            pcfg.clock = (strcmp(optarg, "host") == 0) ? mmw::REPLAY_CLOCK_HOST :
+                         (strcmp(optarg, "frame") == 0) ? mmw::REPLAY_CLOCK_FRAME : mmw::REPLAY_CLOCK_DEVICE;
+            break;
+        case 'l': pcfg.loops = (uint32_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-n bus] [-N slots] [-S slotKB] (-d device [-b baud] |"
+                    " -x capture.mmwcap [-s speed] [-C device|frame|host] [-l loops])\n", argv[0]);
+            return 1;
+        }
+    }
+    if (rcfg.device.empty() == (capPath == nullptr))
+    {
+        fprintf(stderr, "need one of -d, -x\n");
+        return 1;
+    }
+
+    mmw::FrameBusProducer bus;
+    if (bus.open(bcfg) < 0)
+    {
+        fprintf(stderr, "cannot open bus %s (slots not a power of two, or another publisher on it)\n",
+                bcfg.name.c_str());
+        return 1;
+    }
+
+    std::atomic<uint64_t> published{0};
+    std::atomic<uint64_t> rejected{0};
+    auto publish = [&](const uint8_t *data, uint32_t len, uint64_t hostNs)
+    {
+        if (bus.publish(data, len, hostNs) == 0)
+        {
+            published.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    mmw::UartReader reader;
+    mmw::CaptureFile cap;
+    mmw::Replayer replayer;
+    if (capPath != nullptr)
+    {
+        if ((cap.open(capPath) < 0) || (cap.numFrames() == 0U))
+        {
+            fprintf(stderr, "%s: not a capture file or no frames\n", capPath);
+            return 1;
+        }
+        pcfg.queueDepth = 4;
+        if (replayer.open(cap, pcfg) < 0)
+        {
+            fprintf(stderr, "nothing to replay\n");
+            return 1;
+        }
+        /* Publish with the time it is due, as if it had just come in */
+        replayer.addConsumer("bus", [&publish](const mmw::ReplayFrame &frame)
+        {
+            publish(frame.data, frame.len, mmw::monotonicNs());
+        });
+    }
+    else
+    {
+        if (reader.open(rcfg) < 0)
+        {
+            perror(rcfg.device.c_str());
+            return 1;
+        }
+        reader.addCallback([&publish](const mmw::UartFrame &frame)
+        {
+            publish(frame.data, frame.len, frame.lastByteNs);
+        });
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    if (((capPath != nullptr) ? replayer.start() : reader.start()) < 0)
+    {
+        fprintf(stderr, "cannot start\n");
+        return 1;
+    }
+    printf("publishing on /dev/shm/%s, %u slots of %u KB\n", bcfg.name.c_str(),
+           bus.header()->slotCount, bus.header()->slotSize / 1024U);
+
+    uint64_t last = 0;
+    while (!gStop && ((capPath != nullptr) ? replayer.running() : reader.running()))
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        const uint64_t n = published.load();
+        printf("%llu fps, %llu published, %llu rejected\n", (unsigned long long)(n - last),
+               (unsigned long long)n, (unsigned long long)rejected.load());
+        printConsumers(*bus.header());
+        last = n;
+    }
+    replayer.stop();
+    reader.close();
+    bus.close();
+    return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ *   @file  frame_bus_sub.cpp
+ *
+ *   @brief
+ *      Reads the output packets from a shared memory frame bus, in place.
+ *
+ *      Run: build/frame_bus_sub [-n bus] [-c name] [-w ms] [-o] [-t seconds]
+ *
+ *      Parses every packet straight in the shared memory. -w spends that
+ *      many ms of CPU per packet, a stand in for a slow consumer: it falls
+ *      behind and loses packets without holding up the publisher or the
+ *      other consumers. -o starts with the oldest packet on the bus instead
+ *      of the next one. Once a second the packet rate, the packets lost,
+ *      how far behind the publisher this consumer is and the age of the
+ *      packets from their arrival on the host are printed.
+ */
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <unistd.h>
+
+#include "frame_bus.h"
+#include "host_clock.h"
+#include "tlv_parser.h"
+#include "uart_reader.h"
+
+namespace
+{
+
+volatile std::sig_atomic_t gStop = 0;
+
+void onSignal(int)
+{
+    gStop = 1;
+}
+
+void spin(double ms)
+{
+    const auto until = std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(ms);
+    while (std::chrono::steady_clock::now() < until)
+    {
+    }
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    std::string busName = "mmw_frames";
+    std::string name = "frame_bus_sub";
+    double      workMs = 0.0;
+    bool        fromOldest = false;
+    double      duration = 0.0;
+    int         c;
+
+    while ((c = getopt(argc, argv, "n:c:w:ot:")) != -1)
+    {
+        switch (c)
+        {
+        case 'n': busName = optarg; break;
+        case 'c': name = optarg; break;
+        case 'w': workMs = atof(optarg); break;
+        case 'o': fromOldest = true; break;
+        case 't': duration = atof(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-n bus] [-c name] [-w ms] [-o] [-t seconds]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    mmw::FrameBusConsumer bus;
+    if (bus.open(busName, name, fromOldest) < 0)
+    {
+        fprintf(stderr, "no frame bus %s, start frame_bus_pub first\n", busName.c_str());
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    mmw::TlvParserConfig parserCfg;
+    parserCfg.sdkMajor = 0;
+    uint64_t frames = 0;
+    uint64_t badParse = 0;
+    uint64_t lastFrames = 0;
+    uint64_t lastLost = 0;
+    uint64_t maxAgeNs = 0;
+    uint64_t sumAgeNs = 0;
+    uint64_t ageCount = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    auto lastReport = t0;
+
+    while (!gStop)
+    {
+        mmw::FrameBusFrame frame;
+        if (bus.next(frame, 200) == 0)
+        {
+            mmw::FrameView view;
+            const int err = mmw::parseFrame(frame.data, frame.len, parserCfg, view);
+            if (workMs > 0.0)
+            {
+                spin(workMs);
+            }
+            /* Whatever was read only counts if the slot was not reused */
+            if (bus.valid(frame))
+            {
+                frames++;
+                if (err != mmw::PARSE_OK)
+                {
+                    badParse++;
+                }
+                const uint64_t age = mmw::monotonicNs() - frame.hostNs;
+                maxAgeNs = std::max(maxAgeNs, age);
+                sumAgeNs += age;
+                ageCount++;
+            }
+        }
+        else if (!bus.producerAlive())
+        {
+            printf("publisher gone\n");
+            break;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastReport >= std::chrono::seconds(1))
+        {
+            const uint64_t w = bus.header()->writeSeq.load();
+            printf("%llu fps, %llu lost, %llu behind, age avg %.3f max %.3f ms, %llu fail to parse\n",
+                   (unsigned long long)(frames - lastFrames), (unsigned long long)(bus.lost() - lastLost),
+                   (unsigned long long)((w > bus.cursor()) ? w - bus.cursor() : 0U),
+                   (ageCount != 0U) ? sumAgeNs / 1e6 / (double)ageCount : 0.0, maxAgeNs / 1e6,
+                   (unsigned long long)badParse);
+            lastFrames = frames;
+            lastLost = bus.lost();
+            maxAgeNs = 0;
+            sumAgeNs = 0;
+            ageCount = 0;
+            lastReport = now;
+        }
+        if ((duration > 0.0) && (std::chrono::duration<double>(now - t0).count() >= duration))
+        {
+            break;
+        }
+    }
+    printf("%llu frames, %llu lost\n", (unsigned long long)frames, (unsigned long long)bus.lost());
+    bus.close();
+    return 0;
+}
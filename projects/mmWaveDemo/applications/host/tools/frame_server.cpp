@@ -0,0 +1,176 @@
+/**
+ *   @file  frame_server.cpp
+ *
+ *   @brief
+ *      Serves the output packets to any number of viewers over TCP.
+ *
+ *      Run: build/frame_server [-a address] [-p port] [-C maxClients] [-q frames] [-Q queueKB]
+ *                              [-n bus | -d device [-b baud]]
+ *
+ *      Frames come from the frame bus (-n, mmw_frames by default, see
+ *      frame_bus_pub) or straight from the data port (-d). Clients connect
+ *      to -a:-p (127.0.0.1:7410) and read each packet behind a 24 byte
+ *      header, see lib/frame_server.h. -q and -Q bound what is queued for
+ *      one client; a client behind that loses its oldest packets. Once a
+ *      second the clients, packets and deliveries, what was dropped, the
+ *      writes and the latency to the last byte written are printed.
+ */
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "frame_bus.h"
+#include "frame_server.h"
+#include "host_clock.h"
+#include "mmw_wire.h"
+#include "uart_reader.h"
+
+namespace
+{
+
+volatile std::sig_atomic_t gStop = 0;
+
+void onSignal(int)
+{
+    gStop = 1;
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    mmw::FrameServerConfig  scfg;
+    mmw::UartReaderConfig   rcfg;
+    std::string busName = "mmw_frames";
+    int         c;
+
+    while ((c = getopt(argc, argv, "a:p:C:q:Q:n:d:b:")) != -1)
+    {
+        switch (c)
+        {
+        case 'a': scfg.bindAddress = optarg; break;
+        case 'p': scfg.port = (uint16_t)atoi(optarg); break;
+        case 'C': scfg.maxClients = (uint32_t)atoi(optarg); break;
+        case 'q': scfg.maxQueueFrames = (uint32_t)atoi(optarg); break;
+        case 'Q': scfg.maxQueueBytes = (size_t)atoi(optarg) * 1024U; break;
+        case 'n': busName = optarg; break;
+        case 'd': rcfg.device = optarg; break;
+        case 'b': rcfg.baudRate = (uint32_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-a address] [-p port] [-C maxClients] [-q frames] [-Q queueKB]"
+                    " [-n bus | -d device [-b baud]]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    mmw::FrameServer server;
+    if (server.start(scfg) < 0)
+    {
+        fprintf(stderr, "cannot listen on %s:%u (-q at least 2, -C at least 1)\n", scfg.bindAddress.c_str(),
+                (unsigned)scfg.port);
+        return 1;
+    }
+
+    uint64_t rejected = 0;
+    mmw::FrameBusConsumer bus;
+    mmw::UartReader reader;
+    if (!rcfg.device.empty())
+    {
+        if (reader.open(rcfg) < 0)
+        {
+            perror(rcfg.device.c_str());
+            return 1;
+        }
+        /* publish() never waits, so it runs on the reader thread */
+        reader.addCallback([&](const mmw::UartFrame &frame)
+        {
+            uint32_t frameNumber;
+            std::memcpy(&frameNumber, frame.data + offsetof(mmw::MsgHeader, frameNumber), sizeof(frameNumber));
+            if (server.publish(frame.data, frame.len, frameNumber, frame.lastByteNs) < 0)
+            {
+                rejected++;
+            }
+        });
+        reader.start();
+    }
+    else if (bus.open(busName, "frame_server") < 0)
+    {
+        fprintf(stderr, "no frame bus %s, start frame_bus_pub first\n", busName.c_str());
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    printf("serving on %s:%u\n", scfg.bindAddress.c_str(), (unsigned)server.port());
+
+    std::vector<uint8_t> packet;
+    mmw::FrameServerStats last;
+    uint64_t lastReportNs = mmw::monotonicNs();
+
+    while (!gStop)
+    {
+        if (!rcfg.device.empty())
+        {
+            if (!reader.running())
+            {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        else
+        {
+            mmw::FrameBusFrame frame;
+            if (bus.next(frame, 100) == 0)
+            {
+                packet.resize(frame.len);
+                if ((bus.copy(frame, packet.data(), packet.size()) < 0) ||
+                    (server.publish(packet.data(), frame.len, frame.frameNumber, frame.hostNs) < 0))
+                {
+                    rejected++;
+                }
+            }
+            else if (!bus.producerAlive())
+            {
+                printf("publisher of the frame bus gone\n");
+                break;
+            }
+        }
+
+        const uint64_t now = mmw::monotonicNs();
+        if (now - lastReportNs >= 1000000000ULL)
+        {
+            const mmw::FrameServerStats st = server.stats();
+            const mmw::LagHistogram lat = st.latency.since(last.latency);
+            printf("%u clients, %llu frames/s, %llu deliveries/s, %.1f MB/s in %llu writes, %llu dropped"
+                   " (%u clients), max queue %u, latency p50 %.3f p99 %.3f ms, cpu %.1f%%\n",
+                   st.clients, (unsigned long long)(st.frames - last.frames),
+                   (unsigned long long)(st.delivered - last.delivered), (st.bytesSent - last.bytesSent) / 1e6,
+                   (unsigned long long)(st.writes - last.writes), (unsigned long long)(st.dropped - last.dropped),
+                   st.clientsDropping, st.maxQueued,
+                   (lat.count != 0U) ? lat.percentile(0.5) / 1e6 : 0.0,
+                   (lat.count != 0U) ? lat.percentile(0.99) / 1e6 : 0.0,
+                   100.0 * (double)(st.ioCpuNs - last.ioCpuNs) / (double)(now - lastReportNs));
+            fflush(stdout);
+            last = st;
+            lastReportNs = now;
+        }
+    }
+
+    reader.close();
+    server.stop();
+    const mmw::FrameServerStats st = server.stats();
+    printf("%llu frames, %llu deliveries, %llu dropped, %llu overruns, %llu rejected, %llu accepted,"
+           " %llu refused, %llu writes, %.1f MB\n",
+           (unsigned long long)st.frames, (unsigned long long)st.delivered, (unsigned long long)st.dropped,
+           (unsigned long long)st.overruns, (unsigned long long)rejected, (unsigned long long)st.accepted,
+           (unsigned long long)st.refused, (unsigned long long)st.writes, st.bytesSent / 1e6);
+    bus.close();
+    return 0;
+}
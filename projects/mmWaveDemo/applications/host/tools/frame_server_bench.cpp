@@ -0,0 +1,396 @@
+/**
+ *   @file  frame_server_bench.cpp
+ *
+ *   @brief
+ *      Fan-out of the frame server to hundreds of local clients.
+ *
+ *      Run: build/frame_server_bench [-c clients] [-s slowClients] [-r fps] [-t seconds]
+ *                                    [-H] [-T threads] [-q frames] [-k slowKBps] [-b sendKB]
+ *
+ *      Starts a frame server on a free loopback port, connects -c clients
+ *      and publishes synthetic packets (-H with a heat map) at -r packets
+ *      per second for -t seconds. The fast clients read everything on -T
+ *      epoll threads and check every message: the header, the packet's
+ *      magic word and length and the sequence. -s of the clients have a
+ *      small receive buffer and read only -k KB/s. The server's socket
+ *      send buffers are -b KB, so the kernel doesn't absorb what the slow
+ *      clients leave unread: their queues of -q packets fill up and they
+ *      lose the oldest ones. Printed are the server's deliveries, writes
+ *      and CPU time, what the fast clients got with the latency from
+ *      publish to their read, and what the slow ones got and lost. Fails
+ *      if a fast client missed a packet, a slow one had none dropped or any
+ *      client saw a damaged message.
+ */
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "frame_server.h"
+#include "host_clock.h"
+#include "synthetic_output.h"
+
+namespace
+{
+
+struct BenchClient
+{
+    int                     fd = -1;
+    std::vector<uint8_t>    buf;
+    size_t                  have = 0;
+    uint64_t                received = 0;
+    uint64_t                missed = 0;
+    uint64_t                damaged = 0;
+    uint32_t                nextSeq = 0;
+};
+
+int connectClient(uint16_t port, int rcvBuf)
+{
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (rcvBuf > 0)
+    {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf));
+    }
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (const struct sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Takes the complete messages out of the client's buffer */
+void consume(BenchClient &c, mmw::LagHistogram *latency)
+{
+    const uint64_t now = mmw::monotonicNs();
+    size_t pos = 0;
+    while (c.have - pos >= sizeof(mmw::FrameServerMsgHeader))
+    {
+        mmw::FrameServerMsgHeader hdr;
+        std::memcpy(&hdr, &c.buf[pos], sizeof(hdr));
+        if ((hdr.magic != mmw::FRAME_SERVER_MAGIC) || (hdr.len < sizeof(mmw::MsgHeader)) ||
+            (sizeof(hdr) + hdr.len > c.buf.size()))
+        {
+            /* Lost the framing, nothing after this can be trusted */
+            c.damaged++;
+            c.have = 0;
+            return;
+        }
+        if (c.have - pos < sizeof(hdr) + hdr.len)
+        {
+            break;
+        }
+        mmw::MsgHeader pkt;
+        std::memcpy(&pkt, &c.buf[pos + sizeof(hdr)], sizeof(pkt));
+        if ((std::memcmp(pkt.magicWord, mmw::MAGIC_WORD, sizeof(pkt.magicWord)) != 0) ||
+            (pkt.totalPacketLen != hdr.len) || (pkt.frameNumber != hdr.frameNumber))
+        {
+            c.damaged++;
+        }
+        if ((c.received != 0U) && (hdr.seq != c.nextSeq))
+        {
+            c.missed += (uint32_t)(hdr.seq - c.nextSeq);
+        }
+        c.nextSeq = hdr.seq + 1U;
+        c.received++;
+        if (latency != nullptr)
+        {
+            latency->add(now - hdr.hostNs);
+        }
+        pos += sizeof(hdr) + hdr.len;
+    }
+    if (pos != 0U)
+    {
+        std::memmove(c.buf.data(), &c.buf[pos], c.have - pos);
+        c.have -= pos;
+    }
+}
+
+/* Reads whatever a fast client has, until the socket is empty */
+void readAll(BenchClient &c, mmw::LagHistogram &latency)
+{
+    while (true)
+    {
+        const ssize_t n = recv(c.fd, &c.buf[c.have], c.buf.size() - c.have, MSG_DONTWAIT);
+        if (n <= 0)
+        {
+            return;
+        }
+        c.have += (size_t)n;
+        consume(c, &latency);
+    }
+}
+
+void fastReader(std::vector<BenchClient *> clients, const std::atomic<bool> &stop, mmw::LagHistogram &latency)
+{
+    const int ep = epoll_create1(EPOLL_CLOEXEC);
+    for (BenchClient *c : clients)
+    {
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = c;
+        epoll_ctl(ep, EPOLL_CTL_ADD, c->fd, &ev);
+    }
+    struct epoll_event events[64];
+    while (!stop.load())
+    {
+        const int n = epoll_wait(ep, events, 64, 20);
+        for (int i = 0; i < n; i++)
+        {
+            readAll(*(BenchClient *)events[i].data.ptr, latency);
+        }
+    }
+    close(ep);
+}
+
+/* Every 10 ms each slow client reads its share of kbps */
+void slowReader(std::vector<BenchClient *> clients, const std::atomic<bool> &stop, uint32_t kbps)
+{
+    const size_t share = std::max<size_t>((size_t)kbps * 1024U / 100U, 1U);
+    while (!stop.load())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        for (BenchClient *c : clients)
+        {
+            const size_t room = std::min(share, c->buf.size() - c->have);
+            const ssize_t n = recv(c->fd, &c->buf[c->have], room, MSG_DONTWAIT);
+            if (n > 0)
+            {
+                c->have += (size_t)n;
+                consume(*c, nullptr);
+            }
+        }
+    }
+}
+
+void merge(mmw::LagHistogram &into, const mmw::LagHistogram &h)
+{
+    into.count += h.count;
+    into.sumNs += h.sumNs;
+    into.maxNs = std::max(into.maxNs, h.maxNs);
+    for (uint32_t b = 0; b < mmw::LagHistogram::NUM_BUCKETS; b++)
+    {
+        into.buckets[b] += h.buckets[b];
+    }
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    uint32_t    numClients = 256;
+    uint32_t    numSlow = 16;
+    double      fps = 500.0;
+    double      seconds = 3.0;
+    uint32_t    numThreads = 4;
+    uint32_t    slowKbps = 64;
+    uint32_t    sendKb = 64;
+    mmw::SyntheticOutputConfig ocfg;
+    mmw::FrameServerConfig scfg;
+    int         opt;
+
+    scfg.port = 0;
+    while ((opt = getopt(argc, argv, "c:s:r:t:HT:q:k:b:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c': numClients = (uint32_t)atoi(optarg); break;
+        case 's': numSlow = (uint32_t)atoi(optarg); break;
+        case 'r': fps = atof(optarg); break;
+        case 't': seconds = atof(optarg); break;
+        case 'H': ocfg.heatMap = true; break;
+        case 'T': numThreads = (uint32_t)atoi(optarg); break;
+        case 'q': scfg.maxQueueFrames = (uint32_t)atoi(optarg); break;
+        case 'k': slowKbps = (uint32_t)atoi(optarg); break;
+        case 'b': sendKb = (uint32_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-c clients] [-s slowClients] [-r fps] [-t seconds] [-H] [-T threads]"
+                    " [-q frames] [-k slowKBps] [-b sendKB]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((numClients == 0U) || (numSlow >= numClients) || (numThreads == 0U) || (fps <= 0.0))
+    {
+        fprintf(stderr, "need slow clients < clients, at least one thread and a rate\n");
+        return 1;
+    }
+
+    /* Two descriptors per client in this one process */
+    struct rlimit lim;
+    if (getrlimit(RLIMIT_NOFILE, &lim) == 0)
+    {
+        lim.rlim_cur = lim.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &lim);
+    }
+
+    scfg.maxClients = numClients;
+    scfg.sendBufferBytes = (int)(sendKb * 1024U);
+    mmw::FrameServer server;
+    if (server.start(scfg) < 0)
+    {
+        fprintf(stderr, "cannot start the server\n");
+        return 1;
+    }
+
+    std::vector<BenchClient> clients(numClients);
+    for (uint32_t i = 0; i < numClients; i++)
+    {
+        BenchClient &c = clients[i];
+        c.fd = connectClient(server.port(), (i < numSlow) ? 16 * 1024 : 0);
+        if (c.fd < 0)
+        {
+            fprintf(stderr, "client %u: %s\n", i, strerror(errno));
+            return 1;
+        }
+        c.buf.resize(scfg.maxPacketLen + sizeof(mmw::FrameServerMsgHeader));
+    }
+    for (int i = 0; (i < 1000) && (server.stats().clients < numClients); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<std::vector<BenchClient *>> groups(numThreads);
+    std::vector<BenchClient *> slow;
+    for (uint32_t i = 0; i < numClients; i++)
+    {
+        if (i < numSlow)
+        {
+            slow.push_back(&clients[i]);
+        }
+        else
+        {
+            groups[i % numThreads].push_back(&clients[i]);
+        }
+    }
+    std::vector<mmw::LagHistogram> latencies(numThreads);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < numThreads; t++)
+    {
+        threads.emplace_back(fastReader, groups[t], std::cref(stop), std::ref(latencies[t]));
+    }
+    threads.emplace_back(slowReader, slow, std::cref(stop), slowKbps);
+
+    /* Packets built ahead, so the publisher only publishes */
+    mmw::SyntheticOutput synthetic(ocfg);
+    std::vector<std::vector<uint8_t>> packets(64);
+    for (uint32_t n = 0; n < packets.size(); n++)
+    {
+        synthetic.build(n);
+        packets[n] = synthetic.bytes();
+    }
+
+    const mmw::FrameServerStats before = server.stats();
+    const uint64_t periodNs = (uint64_t)(1e9 / fps);
+    const uint64_t t0 = mmw::monotonicNs();
+    const uint64_t numFrames = (uint64_t)(seconds * fps);
+    size_t packetBytes = 0;
+    for (uint64_t n = 0; n < numFrames; n++)
+    {
+        while (mmw::monotonicNs() < t0 + n * periodNs)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        std::vector<uint8_t> &p = packets[n % packets.size()];
+        const uint32_t frameNumber = (uint32_t)n;
+        std::memcpy(&p[offsetof(mmw::MsgHeader, frameNumber)], &frameNumber, sizeof(frameNumber));
+        server.publish(p.data(), (uint32_t)p.size(), frameNumber, mmw::monotonicNs());
+        packetBytes += p.size();
+    }
+    const uint64_t elapsedNs = mmw::monotonicNs() - t0;
+
+    /* Let the fast clients catch up */
+    for (int i = 0; i < 200; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const mmw::FrameServerStats st = server.stats();
+        uint64_t fastReceived = 0;
+        for (uint32_t c = numSlow; c < numClients; c++)
+        {
+            fastReceived += clients[c].received;
+        }
+        if ((st.maxQueued == 0U) || (fastReceived == numFrames * (numClients - numSlow)))
+        {
+            break;
+        }
+    }
+    const mmw::FrameServerStats st = server.stats();
+    stop.store(true);
+    for (std::thread &t : threads)
+    {
+        t.join();
+    }
+    server.stop();
+
+    mmw::LagHistogram latency;
+    for (const mmw::LagHistogram &h : latencies)
+    {
+        merge(latency, h);
+    }
+    uint64_t fastMin = UINT64_MAX, fastMissed = 0, slowReceived = 0, slowMissed = 0, damaged = 0;
+    for (uint32_t i = 0; i < numClients; i++)
+    {
+        const BenchClient &c = clients[i];
+        damaged += c.damaged;
+        if (i < numSlow)
+        {
+            slowReceived += c.received;
+            slowMissed += c.missed;
+        }
+        else
+        {
+            fastMin = std::min(fastMin, c.received);
+            fastMissed += c.missed;
+        }
+        close(c.fd);
+    }
+
+    const double secs = (double)elapsedNs / 1e9;
+    const uint64_t delivered = st.delivered - before.delivered;
+    const uint64_t writes = st.writes - before.writes;
+    printf("%u clients (%u slow at %u KB/s), %llu packets of %.1f KB at %.0f/s, %u reader threads\n",
+           numClients, numSlow, slowKbps, (unsigned long long)numFrames,
+           (double)packetBytes / (double)numFrames / 1e3, (double)numFrames / secs, numThreads);
+    printf("server: %llu deliveries, %.0f MB/s in %llu writes (%.1f per write), %llu dropped, %llu overruns,"
+           " cpu %.1f%% (%.2f ms per GB)\n",
+           (unsigned long long)delivered, (double)(st.bytesSent - before.bytesSent) / secs / 1e6,
+           (unsigned long long)writes, (writes != 0U) ? (double)delivered / (double)writes : 0.0,
+           (unsigned long long)(st.dropped - before.dropped), (unsigned long long)st.overruns,
+           100.0 * (double)(st.ioCpuNs - before.ioCpuNs) / (double)elapsedNs,
+           (st.bytesSent > before.bytesSent) ?
+               (double)(st.ioCpuNs - before.ioCpuNs) / 1e6 / ((double)(st.bytesSent - before.bytesSent) / 1e9) : 0.0);
+    printf("fast:   every client >= %llu of %llu packets, %llu missed, latency p50 %.3f p99 %.3f max %.3f ms\n",
+           (unsigned long long)fastMin, (unsigned long long)numFrames, (unsigned long long)fastMissed,
+           latency.percentile(0.5) / 1e6, latency.percentile(0.99) / 1e6, latency.maxNs / 1e6);
+    if (numSlow != 0U)
+    {
+        /* A slow client only sees the gaps it read up to, the server knows them all */
+        printf("slow:   %.1f packets read and %.1f seen missing each, %u of them had packets dropped\n",
+               (double)slowReceived / numSlow, (double)slowMissed / numSlow, st.clientsDropping);
+    }
+    printf("damaged messages: %llu\n", (unsigned long long)damaged);
+    return ((fastMin == numFrames) && (fastMissed == 0U) && (st.clientsDropping >= numSlow) && (damaged == 0U)) ?
+               0 : 1;
+}
@@ -0,0 +1,350 @@
+/**
+ *   @file  heatmap_codec_bench.cpp
+ *
+ *   @brief
+ *      Compression ratio, speed and reconstruction error of the compressed
+ *      and the sparse range/Doppler heat map encodings.
+ *
+ *      Run: build/heatmap_codec_bench [-r numRangeBins] [-d numDopplerBins]
+ *                                     [-n frames] [-m sparseMargin] [capture.bin]
+ *
+ *      capture.bin is a raw dump of the UART data port with the dense heat
+ *      map enabled (guiMonitor x x x x 1 x). Without a capture the frames are
+ *      synthesized: a range dependent noise floor with a handful of moving
+ *      targets.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <unistd.h>
+
+#include "mmw_heatmap_codec.h"
+#include "mmw_heatmap_sparse.h"
+#include "mmw_wire.h"
+#include "rd_heatmap.h"
+#include "rd_heatmap_sparse.h"
+#include "tlv_parser.h"
+
+namespace
+{
+
+struct Frames
+{
+    uint32_t                numRangeBins = 256;
+    uint32_t                numDopplerBins = 32;
+    std::vector<uint16_t>   cells;
+
+    size_t frameCells() const { return (size_t)numRangeBins * numDopplerBins; }
+    size_t count() const      { return cells.size() / frameCells(); }
+};
+
+/* Pulls every dense heat map TLV out of a raw output stream */
+int loadCapture(const char *path, Frames &frames)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == nullptr)
+    {
+        perror(path);
+        return -1;
+    }
+    std::vector<uint8_t> buf;
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+    {
+        buf.insert(buf.end(), chunk, chunk + n);
+    }
+    fclose(f);
+
+    mmw::TlvParser parser;
+    mmw::FrameView frame;
+    const uint8_t *cursor = buf.data();
+    while (parser.next(cursor, buf.data() + buf.size(), frame) == mmw::PARSE_OK)
+    {
+        const mmw::WireSpan<uint16_t> &hm = frame.rangeDopplerHeatMap;
+        if (hm.size() == frames.frameCells())
+        {
+            const size_t at = frames.cells.size();
+            frames.cells.resize(at + frames.frameCells());
+            std::memcpy(&frames.cells[at], hm.bytes(), hm.sizeBytes());
+        }
+    }
+    return 0;
+}
+
+/*
+ * detMatrix is the sum over the virtual antennas of log2|x| in Q8, so the
+ * noise sits around a few ten thousand with a spread of a few hundred and a
+ * strong target adds roughly 10 bits per antenna.
+ */
+void synthesize(uint32_t numFrames, Frames &frames)
+{
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 600.0f);
+    const uint32_t R = frames.numRangeBins;
+    const uint32_t D = frames.numDopplerBins;
+
+    frames.cells.resize((size_t)numFrames * frames.frameCells());
+    for (uint32_t f = 0; f < numFrames; f++)
+    {
+        uint16_t *m = &frames.cells[(size_t)f * frames.frameCells()];
+        for (uint32_t r = 0; r < R; r++)
+        {
+            const float floor = 22000.0f + 6000.0f * std::exp(-(float)r / 20.0f);
+            for (uint32_t d = 0; d < D; d++)
+            {
+                m[r * D + d] = (uint16_t)(floor + noise(rng));
+            }
+            /* Static clutter at zero Doppler */
+            m[r * D] = (uint16_t)(m[r * D] + 4000);
+        }
+        for (uint32_t t = 0; t < 6; t++)
+        {
+            const uint32_t r = (20U + 37U * t + f / 4U) % R;
+            const uint32_t d = (3U + 5U * t) % D;
+            for (int dr = -1; dr <= 1; dr++)
+            {
+                for (int dd = -1; dd <= 1; dd++)
+                {
+                    const uint32_t rr = (r + R + dr) % R;
+                    const uint32_t cc = (d + D + dd) % D;
+                    const uint32_t v = m[rr * D + cc] + ((dr == 0 && dd == 0) ? 20000U : 9000U);
+                    m[rr * D + cc] = (uint16_t)((v > 0xFFFFU) ? 0xFFFFU : v);
+                }
+            }
+        }
+    }
+}
+
+double seconds(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    Frames      frames;
+    uint32_t    numFrames = 200;
+    uint16_t    margin = MMW_HEATMAP_SPARSE_DEFAULT_MARGIN;
+    int         opt;
+
+    while ((opt = getopt(argc, argv, "r:d:n:m:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'r': frames.numRangeBins = (uint32_t)atoi(optarg); break;
+        case 'd': frames.numDopplerBins = (uint32_t)atoi(optarg); break;
+        case 'n': numFrames = (uint32_t)atoi(optarg); break;
+        case 'm': margin = (uint16_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-r range] [-d doppler] [-n frames] [-m margin] [capture.bin]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((frames.numRangeBins == 0) || (frames.numDopplerBins == 0))
+    {
+        fprintf(stderr, "invalid heat map size\n");
+        return 1;
+    }
+
+    if (optind < argc)
+    {
+        if (loadCapture(argv[optind], frames) < 0)
+        {
+            return 1;
+        }
+        printf("%s: %zu heat maps of %ux%u\n", argv[optind], frames.count(),
+               frames.numRangeBins, frames.numDopplerBins);
+    }
+    else
+    {
+        synthesize(numFrames, frames);
+        printf("synthetic: %zu heat maps of %ux%u\n", frames.count(),
+               frames.numRangeBins, frames.numDopplerBins);
+    }
+    if (frames.count() == 0)
+    {
+        fprintf(stderr, "no heat maps found\n");
+        return 1;
+    }
+
+    const size_t cellsPerFrame = frames.frameCells();
+    const size_t maxPayload = MMW_HEATMAP_CODEC_MAX_SIZE(frames.numRangeBins, frames.numDopplerBins);
+    std::vector<uint8_t>    payloads(frames.count() * maxPayload);
+    std::vector<int32_t>    payloadLen(frames.count());
+    std::vector<uint16_t>   decoded(cellsPerFrame);
+    MmwDemo_rdHeatMapEncoder enc;
+
+    /* Encode, line by line as the DSS does */
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t f = 0; f < frames.count(); f++)
+    {
+        const uint16_t *m = &frames.cells[f * cellsPerFrame];
+        if (f == 0)
+        {
+            MmwDemo_rdHeatMapEncoderConfig(&enc, &payloads[0], (uint32_t)maxPayload,
+                                           (uint16_t)frames.numDopplerBins);
+        }
+        enc.outBuf = &payloads[f * maxPayload];
+        MmwDemo_rdHeatMapEncodeStart(&enc);
+        for (uint32_t r = 0; r < frames.numRangeBins; r++)
+        {
+            MmwDemo_rdHeatMapEncodeLine(&enc, &m[r * frames.numDopplerBins]);
+        }
+        payloadLen[f] = MmwDemo_rdHeatMapEncodeFinish(&enc);
+        if (payloadLen[f] < 0)
+        {
+            fprintf(stderr, "frame %zu: encoding failed\n", f);
+            return 1;
+        }
+    }
+    const double encodeTime = seconds(t0);
+
+    /* Decode */
+    mmw::RdHeatMapDecoder dec;
+    t0 = std::chrono::steady_clock::now();
+    for (size_t f = 0; f < frames.count(); f++)
+    {
+        if ((dec.parse(&payloads[f * maxPayload], (size_t)payloadLen[f]) < 0) ||
+            (dec.decode(decoded.data(), decoded.size()) < 0))
+        {
+            fprintf(stderr, "frame %zu: decoding failed\n", f);
+            return 1;
+        }
+    }
+    const double decodeTime = seconds(t0);
+
+    /* Reconstruction error, apart from the cells below the noise floor,
+     * which are clipped to it */
+    uint64_t    denseBytes = 0;
+    uint64_t    codedBytes = 0;
+    uint32_t    maxErr = 0;
+    uint32_t    maxStep = 0;
+    double      sumErr = 0.0;
+    uint64_t    numAbove = 0;
+    uint32_t    maxClipErr = 0;
+    double      sumClipErr = 0.0;
+    uint64_t    numClipped = 0;
+    for (size_t f = 0; f < frames.count(); f++)
+    {
+        const uint16_t *m = &frames.cells[f * cellsPerFrame];
+        dec.parse(&payloads[f * maxPayload], (size_t)payloadLen[f]);
+        dec.decode(decoded.data(), decoded.size());
+
+        std::vector<uint8_t> shift(frames.numRangeBins);
+        std::vector<uint8_t> q(cellsPerFrame);
+        dec.decodeQuantized(q.data(), shift.data(), q.size());
+        for (uint32_t r = 0; r < frames.numRangeBins; r++)
+        {
+            maxStep = ((1U << shift[r]) > maxStep) ? (1U << shift[r]) : maxStep;
+        }
+
+        for (size_t i = 0; i < cellsPerFrame; i++)
+        {
+            const uint32_t err = (uint32_t)std::abs((int)m[i] - (int)decoded[i]);
+            if (m[i] < dec.noiseFloor())
+            {
+                maxClipErr = (err > maxClipErr) ? err : maxClipErr;
+                sumClipErr += err;
+                numClipped++;
+                continue;
+            }
+            maxErr = (err > maxErr) ? err : maxErr;
+            sumErr += err;
+            numAbove++;
+        }
+        denseBytes += cellsPerFrame * sizeof(uint16_t);
+        codedBytes += (uint64_t)payloadLen[f];
+    }
+
+    printf("dense          %10.1f bytes/frame\n", (double)denseBytes / frames.count());
+    printf("compressed     %10.1f bytes/frame\n", (double)codedBytes / frames.count());
+    printf("  ratio        %10.2f\n", (double)denseBytes / (double)codedBytes);
+    printf("  encode       %10.1f MB/s\n", denseBytes / encodeTime / 1e6);
+    printf("  decode       %10.1f MB/s\n", denseBytes / decodeTime / 1e6);
+    printf("  max error    %10u (largest step %u)\n", maxErr, maxStep);
+    printf("  mean error   %10.1f\n", numAbove ? sumErr / (double)numAbove : 0.0);
+    printf("  clipped      %10.1f %% of cells, below the noise floor\n",
+           100.0 * (double)numClipped / (double)(numClipped + numAbove));
+    printf("    max error  %10u\n", maxClipErr);
+    printf("    mean error %10.1f\n", numClipped ? sumClipErr / (double)numClipped : 0.0);
+    printf("  all cells    %10.1f mean error\n", (sumErr + sumClipErr) / (double)(numClipped + numAbove));
+
+    /* Sparse, margin over the line mean */
+    const size_t sparseMax = MMW_HEATMAP_SPARSE_MAX_SIZE(frames.numRangeBins, frames.numDopplerBins);
+    std::vector<uint8_t> sparse(frames.count() * sparseMax);
+    std::vector<int32_t> sparseLen(frames.count());
+    MmwDemo_rdHeatMapSparseEncoder senc;
+    uint32_t numTruncated = 0;
+
+    t0 = std::chrono::steady_clock::now();
+    for (size_t f = 0; f < frames.count(); f++)
+    {
+        const uint16_t *m = &frames.cells[f * cellsPerFrame];
+        MmwDemo_rdHeatMapSparseConfig(&senc, &sparse[f * sparseMax], (uint32_t)sparseMax,
+                                      (uint16_t)frames.numRangeBins, (uint16_t)frames.numDopplerBins);
+        MmwDemo_rdHeatMapSparseStart(&senc, margin);
+        for (uint32_t r = 0; r < frames.numRangeBins; r++)
+        {
+            MmwDemo_rdHeatMapSparseEncodeLine(&senc, &m[r * frames.numDopplerBins]);
+        }
+        sparseLen[f] = MmwDemo_rdHeatMapSparseFinish(&senc);
+        if (sparseLen[f] < 0)
+        {
+            fprintf(stderr, "frame %zu: sparse encoding failed\n", f);
+            return 1;
+        }
+    }
+    const double sparseEncodeTime = seconds(t0);
+
+    mmw::SparseHeatMap view;
+    uint64_t sparseBytes = 0;
+    uint64_t numSent = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (size_t f = 0; f < frames.count(); f++)
+    {
+        if ((view.parse(&sparse[f * sparseMax], (size_t)sparseLen[f]) < 0) ||
+            (view.decode(decoded.data(), decoded.size()) < 0))
+        {
+            fprintf(stderr, "frame %zu: sparse decoding failed\n", f);
+            return 1;
+        }
+    }
+    const double sparseDecodeTime = seconds(t0);
+
+    /* Every transmitted cell has to come back exactly, through both access paths */
+    for (size_t f = 0; f < frames.count(); f++)
+    {
+        const uint16_t *m = &frames.cells[f * cellsPerFrame];
+        view.parse(&sparse[f * sparseMax], (size_t)sparseLen[f]);
+        bool ok = true;
+        view.forEachCell([&](uint32_t r, uint32_t d, uint16_t v)
+                         {
+                             const uint16_t ref = m[r * frames.numDopplerBins + d];
+                             ok = ok && (v == ref) && (view.cell(r, d) == ref);
+                             numSent++;
+                         });
+        if (!ok)
+        {
+            fprintf(stderr, "frame %zu: sparse cell mismatch\n", f);
+            return 1;
+        }
+        numTruncated += view.truncated() ? 1U : 0U;
+        sparseBytes += (uint64_t)sparseLen[f];
+    }
+
+    printf("sparse         %10.1f bytes/frame (margin %u)\n", (double)sparseBytes / frames.count(), margin);
+    printf("  ratio        %10.2f\n", (double)denseBytes / (double)sparseBytes);
+    printf("  cells sent   %10.2f %%\n", 100.0 * numSent / (double)(frames.count() * cellsPerFrame));
+    printf("  truncated    %10u frames\n", numTruncated);
+    printf("  encode       %10.1f MB/s\n", denseBytes / sparseEncodeTime / 1e6);
+    printf("  decode       %10.1f MB/s\n", denseBytes / sparseDecodeTime / 1e6);
+    return 0;
+}
@@ -0,0 +1,240 @@
+/**
+ *   @file  latency_report.cpp
+ *
+ *   @brief
+ *      Reports how old the frames are when they reach a consumer, stage by
+ *      stage, with the DSS clock mapped to host time.
+ *
+ *      Run: build/latency_report [-i seconds] [-w ms] [-W seconds] (-d device [-b baud] | -n bus)
+ *
+ *      Frames come straight from the data port (-d), where the first and
+ *      last byte of each packet are timed, or from the frame bus (-n, see
+ *      frame_bus_pub), which only keeps the last. -w spends that many ms
+ *      per frame as the consumer's work, -W is the clock sync window (60).
+ *      Every -i seconds (5) the clock estimate (drift, offset, delay of the
+ *      last packet over the envelope) and p50 / p99 / max of each stage of
+ *      that interval are printed: processing and transmit as the device
+ *      reports them in the stats TLV, link from the header's timeCpuCycles
+ *      to the first byte, wire, host queue and work, and the age from the
+ *      end of the chirps to done.
+ */
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "frame_bus.h"
+#include "host_clock.h"
+#include "latency_trace.h"
+#include "tlv_parser.h"
+#include "uart_reader.h"
+
+namespace
+{
+
+volatile std::sig_atomic_t gStop = 0;
+
+void onSignal(int)
+{
+    gStop = 1;
+}
+
+void spin(double ms)
+{
+    const auto until = std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(ms);
+    while (std::chrono::steady_clock::now() < until)
+    {
+    }
+}
+
+struct Snapshot
+{
+    mmw::LagHistogram   stages[mmw::LATENCY_NUM_STAGES];
+};
+
+void report(const mmw::LatencyTracer &tracer, Snapshot &last, uint64_t frames, uint64_t skipped)
+{
+    const mmw::ClockSync &clock = tracer.clock();
+    printf("%llu frames, %llu skipped, clock %s: drift %+.2f ppm, offset %.6f s, last delay %.3f ms,"
+           " %llu samples, %llu restarts\n",
+           (unsigned long long)frames, (unsigned long long)skipped, clock.synced() ? "synced" : "syncing",
+           clock.driftPpm(), clock.offsetNs() / 1e9, clock.lastDelayNs() / 1e6,
+           (unsigned long long)clock.samples(), (unsigned long long)clock.restarts());
+    printf("    %-12s %10s %10s %10s %10s\n", "stage ms", "mean", "p50", "p99", "max");
+    for (uint32_t s = 0; s < mmw::LATENCY_NUM_STAGES; s++)
+    {
+        const mmw::LagHistogram &now = tracer.stage((mmw::LatencyStage)s);
+        const mmw::LagHistogram h = now.since(last.stages[s]);
+        if (h.count != 0U)
+        {
+            printf("    %-12s %10.3f %10.3f %10.3f %10.3f\n", mmw::LatencyTracer::stageName((mmw::LatencyStage)s),
+                   h.sumNs / 1e6 / (double)h.count, h.percentile(0.5) / 1e6, h.percentile(0.99) / 1e6,
+                   h.maxNs / 1e6);
+        }
+        last.stages[s] = now;
+    }
+    fflush(stdout);
+}
+
+/* Whole run histogram of one stage, one line per non-empty log2 bucket */
+void printBuckets(const mmw::LagHistogram &h, const char *name)
+{
+    if (h.count == 0U)
+    {
+        return;
+    }
+    printf("%s, %llu frames:\n", name, (unsigned long long)h.count);
+    for (uint32_t b = 0; b < mmw::LagHistogram::NUM_BUCKETS; b++)
+    {
+        if (h.buckets[b] != 0U)
+        {
+            printf("    >= %10.3f ms %10llu %5.1f%%\n", mmw::LagHistogram::lower(b) / 1e6,
+                   (unsigned long long)h.buckets[b], 100.0 * (double)h.buckets[b] / (double)h.count);
+        }
+    }
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    mmw::UartReaderConfig   rcfg;
+    mmw::ClockSyncConfig    ccfg;
+    std::string busName;
+    double      intervalS = 5.0;
+    double      workMs = 0.0;
+    int         c;
+
+    while ((c = getopt(argc, argv, "i:w:W:d:b:n:")) != -1)
+    {
+        switch (c)
+        {
+        case 'i': intervalS = atof(optarg); break;
+        case 'w': workMs = atof(optarg); break;
+        case 'W': ccfg.windowNs = (uint64_t)(atof(optarg) * 1e9); break;
+        case 'd': rcfg.device = optarg; break;
+        case 'b': rcfg.baudRate = (uint32_t)atoi(optarg); break;
+        case 'n': busName = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-i seconds] [-w ms] [-W seconds] (-d device [-b baud] | -n bus)\n", argv[0]);
+            return 1;
+        }
+    }
+    if (rcfg.device.empty() == busName.empty())
+    {
+        fprintf(stderr, "need one of -d, -n\n");
+        return 1;
+    }
+
+    mmw::TlvParserConfig parserCfg;
+    parserCfg.sdkMajor = 0;
+    mmw::LatencyTracer tracer(ccfg);
+    std::mutex lock;
+    uint64_t frames = 0;
+    uint64_t skipped = 0;
+
+    /* Parses the packet, does the work and traces it */
+    auto consume = [&](const uint8_t *data, size_t len, mmw::FrameTimes times)
+    {
+        times.receivedNs = mmw::monotonicNs();
+        mmw::FrameView view;
+        const bool ok = (mmw::parseFrame(data, len, parserCfg, view) == mmw::PARSE_OK);
+        if (workMs > 0.0)
+        {
+            spin(workMs);
+        }
+        times.doneNs = mmw::monotonicNs();
+        std::lock_guard<std::mutex> guard(lock);
+        if (ok)
+        {
+            tracer.add(view, times);
+            frames++;
+        }
+        else
+        {
+            skipped++;
+        }
+    };
+
+    mmw::UartReader reader;
+    mmw::FrameBusConsumer bus;
+    if (!rcfg.device.empty())
+    {
+        if (reader.open(rcfg) < 0)
+        {
+            perror(rcfg.device.c_str());
+            return 1;
+        }
+        reader.addCallback([&](const mmw::UartFrame &frame)
+        {
+            mmw::FrameTimes times;
+            times.firstByteNs = frame.firstByteNs;
+            times.lastByteNs = frame.lastByteNs;
+            consume(frame.data, frame.len, times);
+        });
+        reader.start();
+    }
+    else if (bus.open(busName, "latency_report") < 0)
+    {
+        fprintf(stderr, "no frame bus %s, start frame_bus_pub first\n", busName.c_str());
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    std::vector<uint8_t> packet;
+    Snapshot last;
+    uint64_t lastReportNs = mmw::monotonicNs();
+    while (!gStop)
+    {
+        if (!rcfg.device.empty())
+        {
+            if (!reader.running())
+            {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        else
+        {
+            mmw::FrameBusFrame frame;
+            if (bus.next(frame, 50) == 0)
+            {
+                packet.resize(frame.len);
+                if (bus.copy(frame, packet.data(), packet.size()) >= 0)
+                {
+                    mmw::FrameTimes times;
+                    times.lastByteNs = frame.hostNs;
+                    consume(packet.data(), packet.size(), times);
+                }
+            }
+            else if (!bus.producerAlive())
+            {
+                printf("publisher of the frame bus gone\n");
+                break;
+            }
+        }
+
+        const uint64_t now = mmw::monotonicNs();
+        if ((double)(now - lastReportNs) >= intervalS * 1e9)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            report(tracer, last, frames, skipped);
+            lastReportNs = now;
+        }
+    }
+
+    reader.close();
+    bus.close();
+    std::lock_guard<std::mutex> guard(lock);
+    report(tracer, last, frames, skipped);
+    printBuckets(tracer.stage(mmw::LATENCY_LINK), "link");
+    printBuckets(tracer.stage(mmw::LATENCY_AGE), "age");
+    return 0;
+}
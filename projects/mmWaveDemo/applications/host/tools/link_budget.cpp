@@ -0,0 +1,134 @@
+/**
+ *   @file  link_budget.cpp
+ *
+ *   @brief
+ *      Output link budget of a .cfg.
+ *
+ *      Run: build/link_budget [-u baud | -s clockHz] [-o objects] [-f fill] [-r fps] profile.cfg
+ *
+ *      Prints the bytes of every TLV the device sends with the .cfg, the
+ *      padded packet length, the time it takes on the UART (-u, 921600
+ *      baud by default) or the SPI link (-s) and the highest frame rate
+ *      the link sustains, next to the frameCfg period. Frames carrying the
+ *      device counters (statsInfo bit 1) are the longest and set the rate.
+ *
+ *      The detected points are counted with -o objects (100, the most the
+ *      DSS sends), the compressed and sparse heat maps with -f times their
+ *      worst case size (1).
+ *
+ *      -r fps runs the other way: the guiMonitor lines whose packets fit
+ *      the link at that frame rate, with the geometry of the .cfg. Only the
+ *      largest selections are listed; any selection with fewer TLVs fits
+ *      as well.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "link_budget.h"
+#include "mmw_spi_frame.h"
+#include "mmw_wire.h"
+
+namespace
+{
+
+void printLink(const mmw::OutputLink &link)
+{
+    if (link.uart)
+    {
+        printf("link: UART %u baud, %.0f bytes/s\n", link.baudRate, link.bytesPerSec());
+    }
+    else
+    {
+        printf("link: SPI %u Hz, %.0f bytes/s in %u byte frames\n", link.clockHz, link.bytesPerSec(),
+               (unsigned)MMW_SPI_FRAME_SIZE);
+    }
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    mmw::OutputLink             link;
+    mmw::LinkBudgetAssumptions  assume;
+    double  fps = 0.0;
+    int     c;
+
+    while ((c = getopt(argc, argv, "u:s:o:f:r:")) != -1)
+    {
+        switch (c)
+        {
+        case 'u': link.uart = true; link.baudRate = (uint32_t)atoi(optarg); break;
+        case 's': link.uart = false; link.clockHz = (uint32_t)atof(optarg); break;
+        case 'o': assume.numObjects = (uint32_t)atoi(optarg); break;
+        case 'f': assume.heatMapFill = atof(optarg); break;
+        case 'r': fps = atof(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-u baud | -s clockHz] [-o objects] [-f fill] [-r fps] profile.cfg\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((optind != argc - 1) || (link.bytesPerSec() <= 0.0))
+    {
+        fprintf(stderr, "need one .cfg and a link rate\n");
+        return 1;
+    }
+
+    std::ifstream in(argv[optind]);
+    std::stringstream text;
+    text << in.rdbuf();
+    mmw::OutputProfile profile;
+    if (!in || (profile.fromCfg(text.str()) < 0))
+    {
+        fprintf(stderr, "%s: no usable channelCfg, profileCfg, chirpCfg and frameCfg\n", argv[optind]);
+        return 1;
+    }
+
+    printf("profile: %u range bins, %u Doppler bins, %u azimuth virtual antennas, frame period %.3f ms\n",
+           profile.numRangeBins, profile.numDopplerBins, profile.numVirtualAntAzim, profile.framePeriodUs / 1000.0);
+    printLink(link);
+
+    if (fps > 0.0)
+    {
+        std::vector<mmw::FittingSelection> fitting;
+        mmw::fittingSelections(profile, assume, link, (uint32_t)(1e6 / fps), fitting);
+        printf("guiMonitor selections fitting %.2f fps (%.3f ms):\n", fps, 1000.0 / fps);
+        for (const mmw::FittingSelection &f : fitting)
+        {
+            printf("    guiMonitor %u %u %u %u %u %u    %7u bytes  %5.1f%%\n",
+                   f.gui.detectedObjects, f.gui.logMagRange, f.gui.noiseProfile, f.gui.rangeAzimuthHeatMap,
+                   f.gui.rangeDopplerHeatMap, f.gui.statsInfo, f.packetLen, 100.0 * f.load);
+        }
+        if (fitting.empty())
+        {
+            printf("    none, not even the detected points alone\n");
+        }
+        return 0;
+    }
+
+    mmw::PacketBudget packet;
+    mmw::packetBudget(profile, assume, true, packet);
+    printf("%-26s %8s\n", "TLV", "bytes");
+    for (const mmw::TlvBudget &t : packet.tlvs)
+    {
+        printf("%-26s %8u%s%s\n", mmw::tlvName(t.type), (unsigned)(sizeof(mmw::TlvHeader) + t.length),
+               t.estimate ? "  (estimate)" : "", t.noSlot ? "  not sent, no TLV slot left" : "");
+    }
+    const double seconds = link.packetSeconds(packet.packetLen);
+    printf("%-26s %8u  %.3f ms on the link, %llu bytes\n", "packet, header and padding", packet.packetLen,
+           seconds * 1000.0, (unsigned long long)link.wireBytes(packet.packetLen));
+    printf("max frame rate %.2f fps", 1.0 / seconds);
+    if (profile.framePeriodUs > 0U)
+    {
+        const double load = seconds / (profile.framePeriodUs * 1e-6);
+        printf(", frameCfg %.2f fps uses %.1f%% of the link%s", 1e6 / profile.framePeriodUs, 100.0 * load,
+               (load > 1.0) ? ": frames will be skipped" : "");
+    }
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,196 @@
+/**
+ *   @file  loss_report.cpp
+ *
+ *   @brief
+ *      Breaks the frames lost between the sensor and the host down by
+ *      where they were lost.
+ *
+ *      Run: build/loss_report [-i seconds] (-d device [-b baud] | -s channel [-c clockHz])
+ *
+ *      Packets come from the UART data port (-d) or the FT232H SPI reader
+ *      (-s, see spi_reader). Gaps in frameNumber are matched against the
+ *      device counters (guiMonitor statsInfo bit 1, see mmw_output_ext.h)
+ *      and the errors of the host reader, and every -i seconds (60) one
+ *      line gives the frames received and missing, and how many of those
+ *      the DSS skipped (MSS busy), failed to log, the MSS failed to send,
+ *      the host rejected, and what remains unexplained. Frames the quiet
+ *      mode suppressed are not missing; they are counted as quiet, with the
+ *      heartbeats received. Skipped chirps,
+ *      packets with TLVs shed by the output scheduler, CRC errors and
+ *      resyncs are listed alongside. The totals are printed
+ *      at exit.
+ */
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+#include "loss_accountant.h"
+#include "spi_frame.h"
+#include "spi_reader.h"
+#include "tlv_parser.h"
+#include "uart_reader.h"
+
+namespace
+{
+
+volatile std::sig_atomic_t gStop = 0;
+
+void onSignal(int)
+{
+    gStop = 1;
+}
+
+void report(const char *tag, const mmw::LossBreakdown &b)
+{
+    const uint64_t expected = b.received + b.missing + b.quiet;
+    printf("%-6s received %llu, missing %llu (%.3f%%): dss skipped %llu, dss errors %llu, mss errors %llu,"
+           " host rejected %llu, unexplained %llu | quiet %llu, heartbeats %llu, chirps skipped %llu, shed %llu,"
+           " crc %llu, resyncs %llu, duplicates %llu, reports %llu, restarts %llu\n",
+           tag, (unsigned long long)b.received, (unsigned long long)b.missing,
+           (expected > 0U) ? 100.0 * (double)b.missing / (double)expected : 0.0,
+           (unsigned long long)b.deviceSkipped, (unsigned long long)b.deviceErrors,
+           (unsigned long long)b.linkErrors, (unsigned long long)b.hostBad,
+           (unsigned long long)b.unexplained, (unsigned long long)b.quiet,
+           (unsigned long long)b.heartbeats, (unsigned long long)b.chirpsSkipped,
+           (unsigned long long)b.shed,
+           (unsigned long long)b.crcErrors, (unsigned long long)b.resyncs,
+           (unsigned long long)b.duplicates, (unsigned long long)b.deviceReports,
+           (unsigned long long)b.restarts);
+    fflush(stdout);
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    mmw::UartReaderConfig   ucfg;
+    mmw::SpiReaderConfig    scfg;
+    bool    useSpi = false;
+    double  intervalS = 60.0;
+    int     c;
+
+    while ((c = getopt(argc, argv, "i:d:b:s:c:")) != -1)
+    {
+        switch (c)
+        {
+        case 'i': intervalS = atof(optarg); break;
+        case 'd': ucfg.device = optarg; break;
+        case 'b': ucfg.baudRate = (uint32_t)atoi(optarg); break;
+        case 's': useSpi = true; scfg.channel = (uint32_t)atoi(optarg); break;
+        case 'c': scfg.clockHz = (uint32_t)atof(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-i seconds] (-d device [-b baud] | -s channel [-c clockHz])\n", argv[0]);
+            return 1;
+        }
+    }
+    if (ucfg.device.empty() == !useSpi)
+    {
+        fprintf(stderr, "need one of -d, -s\n");
+        return 1;
+    }
+
+    mmw::TlvParserConfig parserCfg;
+    parserCfg.sdkMajor = 0;
+    mmw::LossAccountant accountant;
+    std::mutex lock;
+    uint64_t rejected = 0;
+
+    /* Parses the packet and accounts it with the reader's counters so far */
+    auto consume = [&](const uint8_t *data, size_t len, mmw::HostLinkCounters link)
+    {
+        mmw::FrameView view;
+        std::lock_guard<std::mutex> guard(lock);
+        if (mmw::parseFrame(data, len, parserCfg, view) != mmw::PARSE_OK)
+        {
+            rejected++;
+            return;
+        }
+        link.badPackets += rejected;
+        accountant.add(view, link);
+    };
+
+    mmw::UartReader uart;
+    mmw::SpiReader spi;
+    if (!useSpi)
+    {
+        if (uart.open(ucfg) < 0)
+        {
+            perror(ucfg.device.c_str());
+            return 1;
+        }
+        uart.addCallback([&](const mmw::UartFrame &frame)
+        {
+            /* Bytes skipped between packets are a packet the host lost */
+            const mmw::UartReaderStats st = uart.stats();
+            mmw::HostLinkCounters link;
+            link.resyncs = st.resyncs;
+            link.badPackets = st.resyncs;
+            link.crcErrors = st.crcErrors;
+            consume(frame.data, frame.len, link);
+        });
+        uart.start();
+    }
+    else if ((spi.open(scfg) < 0) || (spi.start() < 0))
+    {
+        fprintf(stderr, "cannot open SPI channel %u\n", scfg.channel);
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    mmw::SpiDeframer deframer([&](const uint8_t *packet, size_t len)
+    {
+        mmw::HostLinkCounters link;
+        link.badPackets = deframer.stats().droppedPackets;
+        link.crcErrors = spi.stats().crcErrors;
+        link.resyncs = deframer.stats().lostFrames;
+        consume(packet, len, link);
+    });
+    mmw::LossBreakdown interval;
+    using Clock = std::chrono::steady_clock;
+    auto tLast = Clock::now();
+    while (!gStop)
+    {
+        if (!useSpi)
+        {
+            if (!uart.running())
+            {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        else
+        {
+            mmw::SpiFrameRef frame;
+            if (spi.next(frame, 50) == 0)
+            {
+                deframer.push(frame.data);
+                spi.release(frame);
+            }
+        }
+
+        const auto now = Clock::now();
+        if (std::chrono::duration<double>(now - tLast).count() >= intervalS)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            accountant.roll(interval);
+            report("loss", interval);
+            tLast = now;
+        }
+    }
+
+    uart.close();
+    spi.stop();
+    spi.close();
+    std::lock_guard<std::mutex> guard(lock);
+    accountant.roll(interval);
+    report("loss", interval);
+    report("total", accountant.total());
+    return 0;
+}
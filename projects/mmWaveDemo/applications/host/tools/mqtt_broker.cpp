@@ -0,0 +1,513 @@
+/**
+ *   @file  mqtt_broker.cpp
+ *
+ *   @brief
+ *      Local MQTT 3.1.1 broker stand-in, to run the publisher without a
+ *      real broker.
+ *
+ *      Run: build/mqtt_broker [-p port] [-d ackDelayMs] [-q]
+ *
+ *      Accepts any CONNECT, acknowledges QoS 1 and 2 publishes (after -d
+ *      ms, a stand in for a broker across a network), keeps retained
+ *      messages and forwards every publish at QoS 0 to the subscribers of
+ *      a matching filter (+ and # wildcards). A subscriber that does not
+ *      keep up loses messages once 16 MB are queued for it. Once a second
+ *      the messages and bytes received and forwarded are printed, -q only
+ *      prints the totals on exit. No sessions, no will, no persistence.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "host_clock.h"
+
+namespace
+{
+
+volatile std::sig_atomic_t gStop = 0;
+
+void onSignal(int)
+{
+    gStop = 1;
+}
+
+/* Output queued for one client before forwarded messages are dropped */
+const size_t MAX_QUEUED = 16U * 1024U * 1024U;
+
+struct DelayedAck
+{
+    uint64_t    dueNs;
+    uint8_t     bytes[4];
+};
+
+struct Client
+{
+    int                         fd = -1;
+    std::vector<uint8_t>        in;
+    std::vector<uint8_t>        out;
+    size_t                      outPos = 0;
+    std::deque<DelayedAck>      acks;
+    std::vector<std::string>    filters;
+    bool                        closing = false;
+};
+
+struct Counters
+{
+    uint64_t    received = 0;
+    uint64_t    receivedBytes = 0;
+    uint64_t    qos[3] = { 0, 0, 0 };
+    uint64_t    forwarded = 0;
+    uint64_t    dropped = 0;
+};
+
+bool topicMatches(const std::string &filter, const std::string &topic)
+{
+    size_t f = 0;
+    size_t t = 0;
+    while (f < filter.size())
+    {
+        if (filter[f] == '#')
+        {
+            return true;
+        }
+        if (filter[f] == '+')
+        {
+            while ((t < topic.size()) && (topic[t] != '/'))
+            {
+                t++;
+            }
+            f++;
+            continue;
+        }
+        if ((t >= topic.size()) || (filter[f] != topic[t]))
+        {
+            /* "a/#" also matches "a" */
+            return (t == topic.size()) && (filter.compare(f, std::string::npos, "/#") == 0);
+        }
+        f++;
+        t++;
+    }
+    return t == topic.size();
+}
+
+void queueBytes(Client &c, const uint8_t *p, size_t n)
+{
+    c.out.insert(c.out.end(), p, p + n);
+}
+
+void putRemainingLength(std::vector<uint8_t> &out, size_t n)
+{
+    do
+    {
+        uint8_t b = (uint8_t)(n & 0x7FU);
+        n >>= 7;
+        if (n != 0U)
+        {
+            b |= 0x80U;
+        }
+        out.push_back(b);
+    } while (n != 0U);
+}
+
+/* QoS 0 copy of a publish for a subscriber */
+bool forward(Client &c, const std::string &topic, const uint8_t *payload, size_t len, bool retain)
+{
+    if (c.out.size() - c.outPos + len > MAX_QUEUED)
+    {
+        return false;
+    }
+    std::vector<uint8_t> hdr;
+    hdr.push_back((uint8_t)(0x30U | (retain ? 1U : 0U)));
+    putRemainingLength(hdr, 2U + topic.size() + len);
+    hdr.push_back((uint8_t)(topic.size() >> 8));
+    hdr.push_back((uint8_t)topic.size());
+    hdr.insert(hdr.end(), topic.begin(), topic.end());
+    queueBytes(c, hdr.data(), hdr.size());
+    queueBytes(c, payload, len);
+    return true;
+}
+
+class Broker
+{
+public:
+    explicit Broker(uint32_t ackDelayMs) : m_ackDelayNs((uint64_t)ackDelayMs * 1000000ULL) {}
+
+    void add(int fd)
+    {
+        std::unique_ptr<Client> c(new Client());
+        c->fd = fd;
+        m_clients.push_back(std::move(c));
+    }
+
+    std::vector<std::unique_ptr<Client>> &clients() { return m_clients; }
+    const Counters &counters() const { return m_counters; }
+
+    /* Handles every complete packet in the input of c */
+    void process(Client &c)
+    {
+        size_t pos = 0;
+        while (!c.closing && (c.in.size() - pos >= 2U))
+        {
+            size_t remaining = 0;
+            size_t i = 1;
+            uint32_t shift = 0;
+            bool whole = false;
+            while ((pos + i < c.in.size()) && (i <= 4U))
+            {
+                const uint8_t b = c.in[pos + i++];
+                remaining |= (size_t)(b & 0x7FU) << shift;
+                shift += 7U;
+                if ((b & 0x80U) == 0U)
+                {
+                    whole = true;
+                    break;
+                }
+            }
+            if (!whole)
+            {
+                c.closing = (i > 4U);
+                break;
+            }
+            if (c.in.size() - pos - i < remaining)
+            {
+                break;
+            }
+            packet(c, c.in[pos], &c.in[pos + i], remaining);
+            pos += i + remaining;
+        }
+        c.in.erase(c.in.begin(), c.in.begin() + (std::ptrdiff_t)pos);
+    }
+
+    /* Acknowledgements that are due, and the ms until the next one */
+    int sendDueAcks()
+    {
+        const uint64_t now = mmw::monotonicNs();
+        uint64_t next = UINT64_MAX;
+        for (auto &c : m_clients)
+        {
+            while (!c->acks.empty() && (c->acks.front().dueNs <= now))
+            {
+                queueBytes(*c, c->acks.front().bytes, 4U);
+                c->acks.pop_front();
+            }
+            if (!c->acks.empty())
+            {
+                next = std::min(next, c->acks.front().dueNs);
+            }
+        }
+        return (next == UINT64_MAX) ? 200 : (int)((next - now) / 1000000ULL) + 1;
+    }
+
+private:
+    void ack(Client &c, uint8_t type, uint16_t packetId)
+    {
+        DelayedAck a;
+        a.dueNs = mmw::monotonicNs() + m_ackDelayNs;
+        a.bytes[0] = type;
+        a.bytes[1] = 2;
+        a.bytes[2] = (uint8_t)(packetId >> 8);
+        a.bytes[3] = (uint8_t)packetId;
+        if (m_ackDelayNs == 0U)
+        {
+            queueBytes(c, a.bytes, 4U);
+        }
+        else
+        {
+            c.acks.push_back(a);
+        }
+    }
+
+    void packet(Client &c, uint8_t type, const uint8_t *p, size_t len)
+    {
+        switch (type >> 4)
+        {
+        case 1: /* CONNECT */
+        {
+            const uint8_t connack[4] = { 0x20, 2, 0, 0 };
+            queueBytes(c, connack, sizeof(connack));
+            break;
+        }
+        case 3: /* PUBLISH */
+        {
+            const uint8_t qos = (uint8_t)((type >> 1) & 3U);
+            const bool retain = (type & 1U) != 0U;
+            if ((len < 2U) || (qos > 2U))
+            {
+                c.closing = true;
+                return;
+            }
+            const size_t topicLen = ((size_t)p[0] << 8) | p[1];
+            const size_t head = 2U + topicLen + ((qos > 0U) ? 2U : 0U);
+            if (len < head)
+            {
+                c.closing = true;
+                return;
+            }
+            const std::string topic((const char *)p + 2, topicLen);
+            const uint8_t *payload = p + head;
+            const size_t payloadLen = len - head;
+            m_counters.received++;
+            m_counters.receivedBytes += payloadLen;
+            m_counters.qos[qos]++;
+            if (qos > 0U)
+            {
+                const uint16_t packetId = (uint16_t)((p[2U + topicLen] << 8) | p[3U + topicLen]);
+                ack(c, (qos == 1U) ? 0x40U : 0x50U, packetId);
+            }
+            if (retain)
+            {
+                if (payloadLen == 0U)
+                {
+                    m_retained.erase(topic);
+                }
+                else
+                {
+                    m_retained[topic].assign(payload, payload + payloadLen);
+                }
+            }
+            for (auto &s : m_clients)
+            {
+                for (const std::string &f : s->filters)
+                {
+                    if (topicMatches(f, topic))
+                    {
+                        if (forward(*s, topic, payload, payloadLen, false))
+                        {
+                            m_counters.forwarded++;
+                        }
+                        else
+                        {
+                            m_counters.dropped++;
+                        }
+                        break;
+                    }
+                }
+            }
+            break;
+        }
+        case 6: /* PUBREL */
+            if (len >= 2U)
+            {
+                ack(c, 0x70U, (uint16_t)((p[0] << 8) | p[1]));
+            }
+            break;
+        case 8: /* SUBSCRIBE */
+        {
+            if (len < 2U)
+            {
+                c.closing = true;
+                return;
+            }
+            std::vector<uint8_t> suback = { 0x90 };
+            std::vector<uint8_t> codes;
+            size_t i = 2;
+            while (i + 2U <= len)
+            {
+                const size_t n = ((size_t)p[i] << 8) | p[i + 1U];
+                if (i + 2U + n + 1U > len)
+                {
+                    break;
+                }
+                c.filters.emplace_back((const char *)p + i + 2U, n);
+                codes.push_back(0);
+                i += 2U + n + 1U;
+            }
+            putRemainingLength(suback, 2U + codes.size());
+            suback.push_back(p[0]);
+            suback.push_back(p[1]);
+            suback.insert(suback.end(), codes.begin(), codes.end());
+            queueBytes(c, suback.data(), suback.size());
+            for (const auto &r : m_retained)
+            {
+                for (size_t f = c.filters.size() - codes.size(); f < c.filters.size(); f++)
+                {
+                    if (topicMatches(c.filters[f], r.first))
+                    {
+                        forward(c, r.first, r.second.data(), r.second.size(), true);
+                        break;
+                    }
+                }
+            }
+            break;
+        }
+        case 12: /* PINGREQ */
+        {
+            const uint8_t pong[2] = { 0xD0, 0 };
+            queueBytes(c, pong, sizeof(pong));
+            break;
+        }
+        case 14: /* DISCONNECT */
+            c.closing = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    uint64_t                                m_ackDelayNs;
+    std::vector<std::unique_ptr<Client>>    m_clients;
+    std::map<std::string, std::vector<uint8_t>> m_retained;
+    Counters                                m_counters;
+};
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    uint16_t    port = 1883;
+    uint32_t    ackDelayMs = 0;
+    bool        quiet = false;
+    int         c;
+
+    while ((c = getopt(argc, argv, "p:d:q")) != -1)
+    {
+        switch (c)
+        {
+        case 'p': port = (uint16_t)atoi(optarg); break;
+        case 'd': ackDelayMs = (uint32_t)atoi(optarg); break;
+        case 'q': quiet = true; break;
+        default:
+            fprintf(stderr, "usage: %s [-p port] [-d ackDelayMs] [-q]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const int lfd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    const int one = 1;
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if ((lfd < 0) || (bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) != 0) || (listen(lfd, 16) != 0))
+    {
+        perror("listen");
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    printf("listening on port %u\n", (unsigned)port);
+    fflush(stdout);
+
+    Broker broker(ackDelayMs);
+    Counters last;
+    uint64_t lastReport = mmw::monotonicNs();
+    std::vector<struct pollfd> pfds;
+    uint8_t buf[65536];
+
+    while (!gStop)
+    {
+        const int timeoutMs = broker.sendDueAcks();
+        auto &clients = broker.clients();
+        pfds.clear();
+        pfds.push_back({ lfd, POLLIN, 0 });
+        for (auto &cl : clients)
+        {
+            pfds.push_back({ cl->fd, (short)(POLLIN | ((cl->out.size() > cl->outPos) ? POLLOUT : 0)), 0 });
+        }
+        if ((poll(pfds.data(), pfds.size(), std::min(timeoutMs, 200)) < 0) && (errno != EINTR))
+        {
+            break;
+        }
+
+        for (size_t i = 0; i < clients.size(); i++)
+        {
+            Client &cl = *clients[i];
+            const short re = pfds[i + 1U].revents;
+            if ((re & (POLLIN | POLLHUP | POLLERR)) != 0)
+            {
+                const ssize_t n = recv(cl.fd, buf, sizeof(buf), 0);
+                if (n > 0)
+                {
+                    cl.in.insert(cl.in.end(), buf, buf + n);
+                    broker.process(cl);
+                }
+                else if ((n == 0) || ((errno != EAGAIN) && (errno != EINTR)))
+                {
+                    cl.closing = true;
+                }
+            }
+        }
+        broker.sendDueAcks();
+        for (auto &cl : clients)
+        {
+            while (!cl->closing && (cl->out.size() > cl->outPos))
+            {
+                const ssize_t n = send(cl->fd, cl->out.data() + cl->outPos, cl->out.size() - cl->outPos,
+                                       MSG_NOSIGNAL);
+                if (n <= 0)
+                {
+                    cl->closing = (n < 0) && (errno != EAGAIN) && (errno != EINTR);
+                    break;
+                }
+                cl->outPos += (size_t)n;
+            }
+            if (cl->outPos == cl->out.size())
+            {
+                cl->out.clear();
+                cl->outPos = 0;
+            }
+        }
+        clients.erase(std::remove_if(clients.begin(), clients.end(), [](const std::unique_ptr<Client> &cl)
+        {
+            if (cl->closing)
+            {
+                close(cl->fd);
+            }
+            return cl->closing;
+        }), clients.end());
+
+        if ((pfds[0].revents & POLLIN) != 0)
+        {
+            const int fd = accept4(lfd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (fd >= 0)
+            {
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                broker.add(fd);
+            }
+        }
+
+        const uint64_t now = mmw::monotonicNs();
+        if (!quiet && (now - lastReport >= 1000000000ULL))
+        {
+            const Counters &n = broker.counters();
+            printf("%zu clients, %llu msg/s in (%.2f MB/s), %llu forwarded, %llu dropped\n",
+                   broker.clients().size(), (unsigned long long)(n.received - last.received),
+                   (n.receivedBytes - last.receivedBytes) / 1e6,
+                   (unsigned long long)(n.forwarded - last.forwarded), (unsigned long long)(n.dropped - last.dropped));
+            fflush(stdout);
+            last = n;
+            lastReport = now;
+        }
+    }
+
+    const Counters &n = broker.counters();
+    printf("%llu messages (QoS 0/1/2 %llu/%llu/%llu), %.1f MB, %llu forwarded, %llu dropped\n",
+           (unsigned long long)n.received, (unsigned long long)n.qos[0], (unsigned long long)n.qos[1],
+           (unsigned long long)n.qos[2], n.receivedBytes / 1e6, (unsigned long long)n.forwarded,
+           (unsigned long long)n.dropped);
+    for (auto &cl : broker.clients())
+    {
+        close(cl->fd);
+    }
+    close(lfd);
+    return 0;
+}
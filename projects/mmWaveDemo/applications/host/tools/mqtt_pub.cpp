@@ -0,0 +1,330 @@
+/**
+ *   @file  mqtt_pub.cpp
+ *
+ *   @brief
+ *      Publishes the azimuth heat maps to an MQTT broker in the binary
+ *      format of mqtt_payload.h.
+ *
+ *      Run: build/mqtt_pub [-H host] [-P port] [-t topic] [-q qos] [-m iq|mag]
+ *                          [-A angleBins] [-F u16|log] [-V virtualAnt] [-c profile.cfg]
+ *                          [-B frames] [-T ms] [-I inflight] [-u user] [-w password]
+ *                          [-i clientId] [-n bus | -d device [-b baud]]
+ *
+ *      Frames come from the frame bus (-n, mmw_frames by default, see
+ *      frame_bus_pub) or straight from the data port (-d). -m iq sends the
+ *      int16 samples as received, -m mag the magnitude of the angle
+ *      spectrum with -A bins (16) as 16 bit (-F u16) or log2 8 bit
+ *      (-F log). -c takes the geometry and frame period from the .cfg and
+ *      publishes the .cfg retained on <topic>/cfg; without it -V virtual
+ *      antennas (8) are assumed. -B puts that many frames in a message,
+ *      -T sends a partial batch once its first frame is that old. Once a
+ *      second frames, messages, throughput and the publish latency (to
+ *      PUBACK or PUBCOMP at QoS 1 and 2) are printed. Reconnects once a
+ *      second while the broker is away.
+ */
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "frame_bus.h"
+#include "host_clock.h"
+#include "mqtt_client.h"
+#include "mqtt_payload.h"
+#include "tlv_parser.h"
+#include "uart_reader.h"
+
+namespace
+{
+
+volatile std::sig_atomic_t gStop = 0;
+
+void onSignal(int)
+{
+    gStop = 1;
+}
+
+/* Packets of the data port, the reader thread must not wait for the broker */
+struct PortQueue
+{
+    static const size_t MAX_PACKETS = 64;
+
+    std::mutex                              lock;
+    std::deque<std::vector<uint8_t>>        packets;
+    std::deque<uint64_t>                    times;
+    uint64_t                                dropped = 0;
+
+    void push(const mmw::UartFrame &frame)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (packets.size() >= MAX_PACKETS)
+        {
+            packets.pop_front();
+            times.pop_front();
+            dropped++;
+        }
+        packets.emplace_back(frame.data, frame.data + frame.len);
+        times.push_back(frame.lastByteNs);
+    }
+
+    bool pop(std::vector<uint8_t> &packet, uint64_t &hostNs)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (packets.empty())
+        {
+            return false;
+        }
+        packet.swap(packets.front());
+        hostNs = times.front();
+        packets.pop_front();
+        times.pop_front();
+        return true;
+    }
+};
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    mmw::MqttClientConfig   ccfg;
+    mmw::MqttPayloadConfig  pcfg;
+    mmw::UartReaderConfig   rcfg;
+    std::string topic = "radar";
+    std::string busName = "mmw_frames";
+    const char  *cfgPath = nullptr;
+    uint8_t     qos = 0;
+    uint32_t    batch = 1;
+    uint32_t    batchMs = 0;
+    int         c;
+
+    while ((c = getopt(argc, argv, "H:P:t:q:m:A:F:V:c:B:T:I:u:w:i:n:d:b:")) != -1)
+    {
+        switch (c)
+        {
+        case 'H': ccfg.host = optarg; break;
+        case 'P': ccfg.port = (uint16_t)atoi(optarg); break;
+        case 't': topic = optarg; break;
+        case 'q': qos = (uint8_t)atoi(optarg); break;
+        case 'm':
+            pcfg.kind = (strcmp(optarg, "mag") == 0) ? mmw::MQTT_PAYLOAD_AZIMUTH_MAGNITUDE : mmw::MQTT_PAYLOAD_AZIMUTH_IQ;
+            break;
+        case 'A': pcfg.numAngleBins = (uint32_t)atoi(optarg); break;
+        case 'F':
+            pcfg.format = (strcmp(optarg, "log") == 0) ? MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG : MMW_AZIMUTH_HEATMAP_FORMAT_U16;
+            break;
+        case 'V': pcfg.numVirtualAnt = (uint32_t)atoi(optarg); break;
+        case 'c': cfgPath = optarg; break;
+        case 'B': batch = (uint32_t)atoi(optarg); break;
+        case 'T': batchMs = (uint32_t)atoi(optarg); break;
+        case 'I': ccfg.maxInflight = (uint32_t)atoi(optarg); break;
+        case 'u': ccfg.username = optarg; break;
+        case 'w': ccfg.password = optarg; break;
+        case 'i': ccfg.clientId = optarg; break;
+        case 'n': busName = optarg; break;
+        case 'd': rcfg.device = optarg; break;
+        case 'b': rcfg.baudRate = (uint32_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-H host] [-P port] [-t topic] [-q qos] [-m iq|mag] [-A angleBins] [-F u16|log]"
+                    " [-V virtualAnt] [-c profile.cfg] [-B frames] [-T ms] [-I inflight] [-u user] [-w password]"
+                    " [-i clientId] [-n bus | -d device [-b baud]]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((qos > 2U) || (batch == 0U) || (batch > 0xFFFFU))
+    {
+        fprintf(stderr, "QoS is 0, 1 or 2, -B 1..65535\n");
+        return 1;
+    }
+
+    std::string cfgText;
+    if (cfgPath != nullptr)
+    {
+        std::ifstream in(cfgPath);
+        if (!in)
+        {
+            fprintf(stderr, "cannot read %s\n", cfgPath);
+            return 1;
+        }
+        std::ostringstream text;
+        text << in.rdbuf();
+        cfgText = text.str();
+        if (pcfg.fromCfg(cfgText) < 0)
+        {
+            fprintf(stderr, "%s: no channelCfg or profileCfg\n", cfgPath);
+            return 1;
+        }
+    }
+    mmw::MqttPayloadEncoder encoder;
+    if (encoder.init(pcfg) < 0)
+    {
+        fprintf(stderr, "bad payload configuration (angle bins a power of two, at least %u)\n",
+                MMW_AZIMUTH_HEATMAP_MIN_BINS);
+        return 1;
+    }
+
+    mmw::FrameBusConsumer bus;
+    mmw::UartReader reader;
+    PortQueue port;
+    if (!rcfg.device.empty())
+    {
+        if (reader.open(rcfg) < 0)
+        {
+            perror(rcfg.device.c_str());
+            return 1;
+        }
+        reader.addCallback([&port](const mmw::UartFrame &frame) { port.push(frame); });
+        reader.start();
+    }
+    else if (bus.open(busName, "mqtt_pub") < 0)
+    {
+        fprintf(stderr, "no frame bus %s, start frame_bus_pub first\n", busName.c_str());
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    mmw::MqttClient client;
+    auto connect = [&]() -> bool
+    {
+        client.close();
+        if (client.connect(ccfg) < 0)
+        {
+            return false;
+        }
+        if (!cfgText.empty())
+        {
+            client.publish(topic + "/cfg", (const uint8_t *)cfgText.data(), cfgText.size(), 1, true);
+        }
+        printf("connected to %s:%u\n", ccfg.host.c_str(), (unsigned)ccfg.port);
+        return true;
+    };
+    if (!connect())
+    {
+        fprintf(stderr, "cannot connect to %s:%u, retrying\n", ccfg.host.c_str(), (unsigned)ccfg.port);
+    }
+
+    mmw::TlvParserConfig parserCfg;
+    parserCfg.sdkMajor = 0;
+    std::vector<uint8_t> packet;
+    uint64_t frames = 0;
+    uint64_t skipped = 0;
+    uint64_t unsent = 0;
+    uint64_t batchStartNs = 0;
+    uint64_t lastFrames = 0;
+    mmw::MqttClientStats last;
+    auto lastReport = std::chrono::steady_clock::now();
+    auto lastConnect = lastReport;
+
+    while (!gStop)
+    {
+        uint64_t hostNs = 0;
+        bool havePacket = false;
+        if (!rcfg.device.empty())
+        {
+            havePacket = port.pop(packet, hostNs);
+            if (!havePacket)
+            {
+                if (!reader.running())
+                {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        }
+        else
+        {
+            mmw::FrameBusFrame frame;
+            if (bus.next(frame, 100) == 0)
+            {
+                packet.resize(frame.len);
+                havePacket = (bus.copy(frame, packet.data(), packet.size()) >= 0);
+                hostNs = frame.hostNs;
+            }
+            else if (!bus.producerAlive())
+            {
+                printf("publisher of the frame bus gone\n");
+                break;
+            }
+        }
+
+        if (havePacket)
+        {
+            mmw::FrameView view;
+            if ((mmw::parseFrame(packet.data(), packet.size(), parserCfg, view) == mmw::PARSE_OK) &&
+                (encoder.add(view, hostNs) == 0))
+            {
+                frames++;
+                if (encoder.numFrames() == 1U)
+                {
+                    batchStartNs = mmw::monotonicNs();
+                }
+            }
+            else
+            {
+                skipped++;
+            }
+        }
+
+        const bool due = (encoder.numFrames() >= batch) ||
+            ((encoder.numFrames() != 0U) && (batchMs != 0U) &&
+             (mmw::monotonicNs() - batchStartNs >= (uint64_t)batchMs * 1000000ULL));
+        if (due)
+        {
+            if (!client.connected() || (client.publish(topic, encoder.data(), encoder.size(), qos) < 0))
+            {
+                unsent += encoder.numFrames();
+            }
+            encoder.reset();
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (!client.connected() && (now - lastConnect >= std::chrono::seconds(1)))
+        {
+            connect();
+            lastConnect = now;
+        }
+        if (now - lastReport >= std::chrono::seconds(1))
+        {
+            const mmw::MqttClientStats st = client.stats();
+            const mmw::LagHistogram lat = st.latency.since(last.latency);
+            const uint64_t msgs = st.published - last.published;
+            printf("%llu frames/s, %llu msg/s, %.1f KB/s, %.1f KB/frame, latency p50 %.3f p99 %.3f ms,"
+                   " inflight %u, %llu unsent, %llu failed, %llu skipped\n",
+                   (unsigned long long)(frames - lastFrames), (unsigned long long)msgs,
+                   (st.bytes - last.bytes) / 1e3,
+                   (frames != lastFrames) ? (st.bytes - last.bytes) / 1e3 / (double)(frames - lastFrames) : 0.0,
+                   (lat.count != 0U) ? lat.percentile(0.5) / 1e6 : 0.0,
+                   (lat.count != 0U) ? lat.percentile(0.99) / 1e6 : 0.0, st.inflight,
+                   (unsigned long long)unsent, (unsigned long long)st.failed, (unsigned long long)skipped);
+            fflush(stdout);
+            last = st;
+            lastFrames = frames;
+            lastReport = now;
+        }
+    }
+
+    if ((encoder.numFrames() != 0U) && client.connected())
+    {
+        client.publish(topic, encoder.data(), encoder.size(), qos);
+    }
+    client.flush(2000);
+    const mmw::MqttClientStats st = client.stats();
+    printf("%llu frames in %llu messages, %.1f MB, %llu acknowledged, %llu failed, %llu unsent,"
+           " latency p50 %.3f p99 %.3f ms\n",
+           (unsigned long long)frames, (unsigned long long)st.published, st.bytes / 1e6,
+           (unsigned long long)st.completed, (unsigned long long)st.failed, (unsigned long long)unsent,
+           st.latency.percentile(0.5) / 1e6, st.latency.percentile(0.99) / 1e6);
+    client.close();
+    reader.close();
+    bus.close();
+    return 0;
+}
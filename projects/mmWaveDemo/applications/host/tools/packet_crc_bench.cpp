@@ -0,0 +1,232 @@
+/**
+ *   @file  packet_crc_bench.cpp
+ *
+ *   @brief
+ *      Speed of the packet CRC check and recovery of the parser from
+ *      damaged packets.
+ *
+ *      Run: build/packet_crc_bench [-n packets] [-g glitches] [-H] [-s seconds]
+ *
+ *      First the CRC-32C versions are checked against each other and
+ *      against the standard check value, then timed on buffers from 64
+ *      bytes to 1 MB. Then a stream of synthetic packets (-H with a heat
+ *      map) gets -g glitches, each a random byte changed, of which every
+ *      second one hits totalPacketLen; the stream is parsed with the CRC
+ *      checked and without, and the packets lost per glitch are counted.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <unistd.h>
+
+#include "crc32c.h"
+#include "synthetic_output.h"
+#include "tlv_parser.h"
+
+namespace
+{
+
+/* CRC-32C of "123456789" */
+const uint32_t CHECK_VALUE = 0xE3069283U;
+
+int checkImplementations()
+{
+    const char *check = "123456789";
+    if ((mmw::crc32c(MMW_CRC32C_INIT, (const uint8_t *)check, 9) != CHECK_VALUE) ||
+        (mmw::crc32cTable(MMW_CRC32C_INIT, (const uint8_t *)check, 9) != CHECK_VALUE))
+    {
+        fprintf(stderr, "check value mismatch\n");
+        return -1;
+    }
+
+    /* Every length up to a few lanes, at every alignment, and chaining */
+    std::mt19937 rng(1);
+    std::vector<uint8_t> buf(4096 + 8);
+    for (uint8_t &b : buf)
+    {
+        b = (uint8_t)rng();
+    }
+    for (size_t off = 0; off < 8; off++)
+    {
+        for (size_t len = 0; len + off <= buf.size(); len += (len < 64) ? 1 : 37)
+        {
+            const uint32_t ref = mmw::crc32cTable(MMW_CRC32C_INIT, &buf[off], len);
+            const size_t half = len / 3;
+            if ((mmw::crc32c(MMW_CRC32C_INIT, &buf[off], len) != ref) ||
+                (mmw::crc32c(mmw::crc32c(MMW_CRC32C_INIT, &buf[off], half), &buf[off + half], len - half) != ref))
+            {
+                fprintf(stderr, "%s differs from the table at offset %zu, length %zu\n", mmw::crc32cImpl(), off, len);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+template <typename Fn>
+double gbPerSecond(Fn fn, const std::vector<uint8_t> &buf, size_t len, double seconds)
+{
+    using Clock = std::chrono::steady_clock;
+    uint32_t sink = 0;
+    uint64_t bytes = 0;
+    const auto t0 = Clock::now();
+    double elapsed = 0.0;
+    while (elapsed < seconds)
+    {
+        for (size_t off = 0; off + len <= buf.size(); off += len)
+        {
+            sink ^= fn(MMW_CRC32C_INIT, &buf[off], len);
+            bytes += len;
+        }
+        elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+    if (sink == 0x12345678U)
+    {
+        printf(" ");
+    }
+    return (double)bytes / elapsed / 1e9;
+}
+
+struct Recovery
+{
+    uint64_t    parsed = 0;
+    uint64_t    lost = 0;
+    uint64_t    damagedDelivered = 0;
+    uint64_t    crcErrors = 0;
+    uint64_t    resyncs = 0;
+};
+
+/* Feeds the stream in pieces, as a reader would, and compares what comes
+ * out with the packets sent */
+Recovery parseStream(const std::vector<uint8_t> &stream, const std::set<uint32_t> &damaged,
+                     uint32_t numPackets, mmw::CrcCheck crc)
+{
+    mmw::TlvParserConfig cfg;
+    cfg.crc = crc;
+    mmw::TlvParser parser(cfg);
+    mmw::FrameView frame;
+    Recovery out;
+    std::set<uint32_t> seen;
+
+    const size_t piece = 4096;
+    const uint8_t *cursor = stream.data();
+    for (size_t have = 0; have < stream.size();)
+    {
+        have = (stream.size() - have > piece) ? have + piece : stream.size();
+        while (parser.next(cursor, stream.data() + have, frame) == mmw::PARSE_OK)
+        {
+            out.parsed++;
+            seen.insert(frame.header.frameNumber);
+            if (damaged.count(frame.header.frameNumber) != 0U)
+            {
+                out.damagedDelivered++;
+            }
+        }
+    }
+    out.lost = numPackets - seen.size();
+    out.crcErrors = parser.stats().crcErrors;
+    out.resyncs = parser.stats().resyncs;
+    return out;
+}
+
+void printRecovery(const char *name, const Recovery &r, uint32_t glitches)
+{
+    printf("%-12s %6llu parsed, %5llu lost (%.2f per glitch), %4llu damaged delivered,"
+           " %4llu CRC errors, %4llu resyncs\n", name,
+           (unsigned long long)r.parsed, (unsigned long long)r.lost, (double)r.lost / glitches,
+           (unsigned long long)r.damagedDelivered, (unsigned long long)r.crcErrors,
+           (unsigned long long)r.resyncs);
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    uint32_t    numPackets = 20000;
+    uint32_t    glitches = 200;
+    double      seconds = 0.3;
+    mmw::SyntheticOutputConfig scfg;
+    int         opt;
+
+    while ((opt = getopt(argc, argv, "n:g:Hs:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': numPackets = (uint32_t)atoi(optarg); break;
+        case 'g': glitches = (uint32_t)atoi(optarg); break;
+        case 'H': scfg.heatMap = true; break;
+        case 's': seconds = atof(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-n packets] [-g glitches] [-H] [-s seconds]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((numPackets == 0U) || (glitches == 0U) || (glitches > numPackets))
+    {
+        fprintf(stderr, "need 0 < glitches <= packets\n");
+        return 1;
+    }
+
+    if (checkImplementations() < 0)
+    {
+        return 1;
+    }
+    printf("crc32c: %s, matches the table code\n", mmw::crc32cImpl());
+
+    std::vector<uint8_t> buf(4U * 1024U * 1024U);
+    std::mt19937 rng(2);
+    for (uint8_t &b : buf)
+    {
+        b = (uint8_t)rng();
+    }
+    printf("%10s %12s %12s\n", "bytes", mmw::crc32cImpl(), "table");
+    for (size_t len : { (size_t)64, (size_t)1024, (size_t)4096, (size_t)65536, (size_t)1048576 })
+    {
+        printf("%10zu %9.2f GB/s %7.2f GB/s\n", len, gbPerSecond(mmw::crc32c, buf, len, seconds),
+               gbPerSecond(mmw::crc32cTable, buf, len, seconds));
+    }
+
+    /* The stream, and the glitches spread over it */
+    mmw::SyntheticOutput synthetic(scfg);
+    std::vector<uint8_t> stream;
+    std::vector<size_t> starts;
+    for (uint32_t n = 0; n < numPackets; n++)
+    {
+        synthetic.build(n);
+        starts.push_back(stream.size());
+        const std::vector<uint8_t> packet = synthetic.bytes();
+        stream.insert(stream.end(), packet.begin(), packet.end());
+    }
+    std::set<uint32_t> damaged;
+    for (uint32_t g = 0; g < glitches; g++)
+    {
+        uint32_t n;
+        do
+        {
+            n = (uint32_t)(rng() % numPackets);
+        } while (damaged.count(n) != 0U);
+        damaged.insert(n);
+
+        const size_t len = ((n + 1U < numPackets) ? starts[n + 1U] : stream.size()) - starts[n];
+        size_t at = starts[n] + offsetof(mmw::MsgHeader, totalPacketLen) + (rng() % 3U);
+        if ((g & 1U) != 0U)
+        {
+            /* Anywhere in header and TLVs, the padding is not covered */
+            at = starts[n] + sizeof(mmw::MsgHeader) + rng() % (len - sizeof(mmw::MsgHeader) - mmw::MSG_SEGMENT_LEN);
+        }
+        stream[at] ^= (uint8_t)(1U + rng() % 255U);
+    }
+    printf("%u packets, %zu bytes, %u glitches, half of them in totalPacketLen\n", numPackets,
+           stream.size(), glitches);
+
+    const Recovery withCrc = parseStream(stream, damaged, numPackets, mmw::CRC_IF_PRESENT);
+    const Recovery withoutCrc = parseStream(stream, damaged, numPackets, mmw::CRC_OFF);
+    printRecovery("CRC checked", withCrc, glitches);
+    printRecovery("CRC ignored", withoutCrc, glitches);
+    return (withCrc.damagedDelivered == 0U) && (withCrc.lost <= glitches) ? 0 : 1;
+}
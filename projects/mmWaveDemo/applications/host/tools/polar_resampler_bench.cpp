@@ -0,0 +1,239 @@
+/**
+ *   @file  polar_resampler_bench.cpp
+ *
+ *   @brief
+ *      Checks the polar to Cartesian resampler and measures its frame rate.
+ *
+ *      Run: build/polar_resampler_bench [-W width] [-H height] [-x halfWidth] [-y depth]
+ *                                       [-r numRangeBins] [-a numAngleBins] [-n frames] [-T threads]
+ *
+ *      The nearest image is compared with a brute force search of every bin
+ *      in the plane, what griddata 'nearest' does; a pixel counts as wrong
+ *      only if a closer bin exists. The bilinear image is compared with the
+ *      interpolation done in double per pixel, to float rounding. Large
+ *      images are checked at every few pixels. The images made on -T
+ *      threads (one per core by default) have to equal those of one. Then
+ *      -n random heat maps are resampled in both modes on one and on -T
+ *      threads, and the table build time and frames per second printed.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <unistd.h>
+
+#include "azimuth_heatmap.h"
+#include "polar_resampler.h"
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+double pixelX(const mmw::PolarResamplerConfig &cfg, uint32_t col)
+{
+    return (cfg.width > 1U) ? cfg.xMin + (cfg.xMax - cfg.xMin) * (double)col / (cfg.width - 1U) : cfg.xMin;
+}
+
+double pixelY(const mmw::PolarResamplerConfig &cfg, uint32_t row)
+{
+    return (cfg.height > 1U) ? cfg.yMin + (cfg.yMax - cfg.yMin) * (double)row / (cfg.height - 1U) : cfg.yMin;
+}
+
+double binSin(const mmw::PolarResamplerConfig &cfg, uint32_t a)
+{
+    return (cfg.mirrorX ? -1.0 : 1.0) * mmw::AzimuthHeatMap::sinAngle(a, cfg.numAngleBins);
+}
+
+double distance2(const mmw::PolarResamplerConfig &cfg, double x, double y, uint32_t r, uint32_t a)
+{
+    const double s = binSin(cfg, a);
+    const double dx = x - r * cfg.rangeIdxToMeters * s;
+    const double dy = y - r * cfg.rangeIdxToMeters * std::sqrt(1.0 - s * s);
+    return dx * dx + dy * dy;
+}
+
+/* Pixels checked; the brute force search costs a pass over the map each */
+const size_t MAX_CHECKED = 20000;
+
+/* Pixels for which a bin closer than the one taken exists */
+size_t checkNearest(const mmw::PolarResamplerConfig &cfg, const std::vector<float> &in,
+                    const std::vector<float> &image)
+{
+    const size_t step = image.size() / MAX_CHECKED + 1U;
+    size_t wrong = 0;
+
+    for (size_t p = 0; p < image.size(); p += step)
+    {
+        const uint32_t row = (uint32_t)(p / cfg.width);
+        const uint32_t col = (uint32_t)(p % cfg.width);
+        const double x = pixelX(cfg, col);
+        const double y = pixelY(cfg, row);
+        double best = INFINITY;
+        double taken = INFINITY;
+        for (uint32_t r = 0; r < cfg.numRangeBins; r++)
+        {
+            for (uint32_t a = 1; a < cfg.numAngleBins; a++)
+            {
+                const double d = distance2(cfg, x, y, r, a);
+                best = std::min(best, d);
+                if (in[(size_t)r * cfg.numAngleBins + a] == image[p])
+                {
+                    taken = std::min(taken, d);
+                }
+            }
+        }
+        if (taken > best * (1.0 + 1e-9))
+        {
+            wrong++;
+        }
+    }
+    return wrong;
+}
+
+/* Largest difference to the interpolation in double */
+double checkBilinear(const mmw::PolarResamplerConfig &cfg, const std::vector<float> &in,
+                     const std::vector<float> &image)
+{
+    const size_t step = image.size() / MAX_CHECKED + 1U;
+    const int numRange = (int)cfg.numRangeBins;
+    const int numAngle = (int)cfg.numAngleBins;
+    double worst = 0.0;
+
+    for (size_t p = 0; p < image.size(); p += step)
+    {
+        const uint32_t row = (uint32_t)(p / cfg.width);
+        const uint32_t col = (uint32_t)(p % cfg.width);
+        const double x = pixelX(cfg, col);
+        const double y = pixelY(cfg, row);
+        const double r = std::hypot(x, y);
+        const double s = (r > 0.0) ? (cfg.mirrorX ? -x : x) / r : 0.0;
+        const double fr = std::min(r / cfg.rangeIdxToMeters, numRange - 1.0);
+        const double fa = std::min(std::max(s * numAngle / 2 + numAngle / 2, 1.0), numAngle - 1.0);
+        const int r0 = std::min((int)fr, numRange - 2);
+        const int a0 = std::min((int)fa, numAngle - 2);
+        const double tr = fr - r0;
+        const double ta = fa - a0;
+        const float *cell = &in[(size_t)r0 * numAngle + a0];
+        const double v = (1 - tr) * ((1 - ta) * cell[0] + ta * cell[1]) +
+                         tr * ((1 - ta) * cell[numAngle] + ta * cell[numAngle + 1]);
+        worst = std::max(worst, std::fabs(v - image[p]));
+    }
+    return worst;
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    mmw::PolarResamplerConfig cfg;
+    uint32_t    numFrames = 2000;
+    uint32_t    numThreads = 0;
+    int         c;
+
+    while ((c = getopt(argc, argv, "W:H:x:y:r:a:n:T:")) != -1)
+    {
+        switch (c)
+        {
+        case 'W': cfg.width = (uint32_t)atoi(optarg); break;
+        case 'H': cfg.height = (uint32_t)atoi(optarg); break;
+        case 'x': cfg.xMax = (float)atof(optarg); cfg.xMin = -cfg.xMax; break;
+        case 'y': cfg.yMax = (float)atof(optarg); break;
+        case 'r': cfg.numRangeBins = (uint32_t)atoi(optarg); break;
+        case 'a': cfg.numAngleBins = (uint32_t)atoi(optarg); break;
+        case 'n': numFrames = (uint32_t)atoi(optarg); break;
+        case 'T': numThreads = (uint32_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-W width] [-H height] [-x halfWidth] [-y depth] [-r numRangeBins]"
+                    " [-a numAngleBins] [-n frames] [-T threads]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    /* Distinct values, so the brute force check can tell bins apart */
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> mag(0.0f, 1000.0f);
+    std::vector<std::vector<float>> maps(16);
+    for (std::vector<float> &m : maps)
+    {
+        m.resize((size_t)cfg.numRangeBins * cfg.numAngleBins);
+        for (float &v : m)
+        {
+            v = mag(rng);
+        }
+    }
+    std::vector<float> image((size_t)cfg.width * cfg.height);
+    std::vector<float> single(image.size());
+
+    printf("%u x %u heat map to %u x %u pixels over x [%.1f, %.1f] y [%.1f, %.1f] m\n", cfg.numRangeBins,
+           cfg.numAngleBins, cfg.width, cfg.height, cfg.xMin, cfg.xMax, cfg.yMin, cfg.yMax);
+
+    bool ok = true;
+    const mmw::PolarInterp modes[] = { mmw::PolarInterp::NEAREST, mmw::PolarInterp::BILINEAR };
+    for (mmw::PolarInterp mode : modes)
+    {
+        const char *name = (mode == mmw::PolarInterp::NEAREST) ? "nearest" : "bilinear";
+        const uint32_t threads[] = { 1U, numThreads };
+        for (uint32_t t : threads)
+        {
+            mmw::PolarResampler resampler;
+            cfg.interp = mode;
+            cfg.numThreads = t;
+            const Clock::time_point t0 = Clock::now();
+            if (resampler.configure(cfg) < 0)
+            {
+                fprintf(stderr, "bad geometry\n");
+                return 1;
+            }
+            const double buildMs = secondsSince(t0) * 1e3;
+
+            resampler.resample(maps[0].data(), maps[0].size(), image.data(), image.size());
+            if (t != 1U)
+            {
+                if (image != single)
+                {
+                    printf("%-8s  %u threads differ from one\n", name, resampler.numThreads());
+                    ok = false;
+                }
+            }
+            else
+            {
+                single = image;
+                if (mode == mmw::PolarInterp::NEAREST)
+                {
+                    const size_t wrong = checkNearest(cfg, maps[0], image);
+                    printf("%-8s  %zu pixels with a closer bin\n", name, wrong);
+                    ok = ok && (wrong == 0U);
+                }
+                else
+                {
+                    const double worst = checkBilinear(cfg, maps[0], image);
+                    printf("%-8s  max error %.2g\n", name, worst);
+                    /* float rounding, the maps go up to 1000 */
+                    ok = ok && (worst < 0.01);
+                }
+            }
+
+            const Clock::time_point t1 = Clock::now();
+            for (uint32_t n = 0; n < numFrames; n++)
+            {
+                const std::vector<float> &m = maps[n % maps.size()];
+                resampler.resample(m.data(), m.size(), image.data(), image.size());
+            }
+            const double secs = secondsSince(t1);
+            printf("%-8s  %2u threads: table %.2f ms, %.0f frames/s, %.1f Mpixel/s\n", name,
+                   resampler.numThreads(), buildMs, numFrames / secs,
+                   (double)numFrames * image.size() / secs / 1e6);
+        }
+    }
+    return ok ? 0 : 1;
+}
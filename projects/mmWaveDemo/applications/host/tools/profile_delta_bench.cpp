@@ -0,0 +1,246 @@
+/**
+ *   @file  profile_delta_bench.cpp
+ *
+ *   @brief
+ *      Size and reconstruction error of the delta coded range profile.
+ *
+ *      Run: build/profile_delta_bench [-r numRangeBins] [-n frames] [-s sigma]
+ *                                     [-k keyframeInterval] [-t tolerance]
+ *                                     [-l lossRate] [capture.bin]
+ *
+ *      capture.bin is a raw dump of the UART data port with the plain range
+ *      profile enabled (guiMonitor x 1 x x x x). Without a capture the
+ *      profiles are synthesized: a still scene whose bins jitter from frame
+ *      to frame with a standard deviation of sigma detMatrix units, and
+ *      one target walking across the range bins. Every profile is encoded
+ *      as the DSS does, losslessly and with the tolerance, and decoded
+ *      after dropping a lossRate share of the packets.
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <unistd.h>
+
+#include "mmw_profile_delta.h"
+#include "profile_delta.h"
+#include "tlv_parser.h"
+
+namespace
+{
+
+struct Profiles
+{
+    uint32_t                numRangeBins = 256;
+    std::vector<uint16_t>   values;
+
+    size_t count() const { return values.size() / numRangeBins; }
+};
+
+/* Pulls every range profile TLV of the configured size out of a raw output stream */
+int loadCapture(const char *path, Profiles &profiles)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == nullptr)
+    {
+        perror(path);
+        return -1;
+    }
+    std::vector<uint8_t> buf;
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+    {
+        buf.insert(buf.end(), chunk, chunk + n);
+    }
+    fclose(f);
+
+    mmw::TlvParser parser;
+    mmw::FrameView frame;
+    const uint8_t *cursor = buf.data();
+    while (parser.next(cursor, buf.data() + buf.size(), frame) == mmw::PARSE_OK)
+    {
+        const mmw::WireSpan<uint16_t> &rp = frame.rangeProfile;
+        if (rp.size() == profiles.numRangeBins)
+        {
+            const size_t at = profiles.values.size();
+            profiles.values.resize(at + profiles.numRangeBins);
+            std::memcpy(&profiles.values[at], rp.bytes(), rp.sizeBytes());
+        }
+    }
+    return 0;
+}
+
+/* Same scale as the heat map bench: clutter over a range dependent floor */
+void synthesize(uint32_t numFrames, float sigma, Profiles &profiles)
+{
+    std::mt19937 rng(1);
+    std::normal_distribution<float> jitter(0.0f, sigma);
+    const uint32_t R = profiles.numRangeBins;
+
+    profiles.values.resize((size_t)numFrames * R);
+    for (uint32_t f = 0; f < numFrames; f++)
+    {
+        uint16_t *p = &profiles.values[(size_t)f * R];
+        for (uint32_t r = 0; r < R; r++)
+        {
+            const float shape = 26000.0f + 6000.0f * std::exp(-(float)r / 20.0f) +
+                                (float)((r * 2654435761U) >> 20);
+            p[r] = (uint16_t)(shape + jitter(rng));
+        }
+        const uint32_t target = (10U + f / 8U) % R;
+        p[target] = (uint16_t)(p[target] + 12000U);
+    }
+}
+
+struct Result
+{
+    uint64_t    bytes = 0;
+    uint64_t    keyframes = 0;
+    uint64_t    decoded = 0;
+    uint64_t    noReference = 0;
+    uint32_t    maxErr = 0;
+};
+
+/* Encodes every profile, commits it as sent and decodes what got through */
+int run(const Profiles &profiles, uint16_t keyframeInterval, uint16_t tolerance, double lossRate, Result &out)
+{
+    const uint32_t R = profiles.numRangeBins;
+    const size_t maxPayload = MMW_PROFILE_DELTA_MAX_SIZE(R);
+    std::vector<uint8_t>  payload(maxPayload);
+    std::vector<uint16_t> refs(2U * R);
+    MmwDemo_profileDeltaEncoder enc;
+    mmw::ProfileDeltaDecoder dec;
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<double> loss(0.0, 1.0);
+
+    MmwDemo_profileDeltaConfig(&enc, payload.data(), (uint32_t)maxPayload, &refs[0], &refs[R], (uint16_t)R);
+    for (size_t f = 0; f < profiles.count(); f++)
+    {
+        const uint16_t *p = &profiles.values[f * R];
+        MmwDemo_profileDeltaStart(&enc, keyframeInterval, tolerance);
+        for (uint32_t r = 0; r < R; r++)
+        {
+            MmwDemo_profileDeltaEncode(&enc, p[r]);
+        }
+        const int32_t len = MmwDemo_profileDeltaFinish(&enc);
+        if (len < 0)
+        {
+            fprintf(stderr, "frame %zu: encoding failed\n", f);
+            return -1;
+        }
+        out.bytes += (uint64_t)len;
+        out.keyframes += enc.isKeyframe ? 1U : 0U;
+        MmwDemo_profileDeltaCommit(&enc);
+
+        if (loss(rng) < lossRate)
+        {
+            continue;
+        }
+        const int rc = dec.decode(payload.data(), (size_t)len);
+        if (rc == mmw::PROFILE_DELTA_NO_REFERENCE)
+        {
+            out.noReference++;
+            continue;
+        }
+        if (rc < 0)
+        {
+            fprintf(stderr, "frame %zu: decoding failed\n", f);
+            return -1;
+        }
+        for (uint32_t r = 0; r < R; r++)
+        {
+            const uint32_t err = (uint32_t)std::abs((int)p[r] - (int)dec.profile()[r]);
+            out.maxErr = (err > out.maxErr) ? err : out.maxErr;
+        }
+        out.decoded++;
+    }
+    return 0;
+}
+
+void print(const char *name, const Profiles &profiles, const Result &res, double lossRate)
+{
+    const double plain = (double)profiles.numRangeBins * sizeof(uint16_t);
+    const double coded = (double)res.bytes / (double)profiles.count();
+    printf("%-14s %10.1f bytes/frame\n", name, coded);
+    printf("  ratio        %10.2f\n", plain / coded);
+    printf("  keyframes    %10llu\n", (unsigned long long)res.keyframes);
+    printf("  max error    %10u\n", res.maxErr);
+    if (lossRate > 0.0)
+    {
+        printf("  decoded      %10llu, %llu waiting for a keyframe\n",
+               (unsigned long long)res.decoded, (unsigned long long)res.noReference);
+    }
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    Profiles    profiles;
+    uint32_t    numFrames = 1000;
+    float       sigma = 100.0f;
+    uint16_t    keyframeInterval = MMW_PROFILE_DELTA_DEFAULT_INTERVAL;
+    uint16_t    tolerance = 256;
+    double      lossRate = 0.0;
+    int         opt;
+
+    while ((opt = getopt(argc, argv, "r:n:s:k:t:l:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'r': profiles.numRangeBins = (uint32_t)atoi(optarg); break;
+        case 'n': numFrames = (uint32_t)atoi(optarg); break;
+        case 's': sigma = (float)atof(optarg); break;
+        case 'k': keyframeInterval = (uint16_t)atoi(optarg); break;
+        case 't': tolerance = (uint16_t)atoi(optarg); break;
+        case 'l': lossRate = atof(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-r range] [-n frames] [-s sigma] [-k keyframeInterval] [-t tolerance]"
+                    " [-l lossRate] [capture.bin]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((profiles.numRangeBins == 0) || (profiles.numRangeBins > 0xFFFFU) || (keyframeInterval == 0))
+    {
+        fprintf(stderr, "invalid profile size or keyframe interval\n");
+        return 1;
+    }
+
+    if (optind < argc)
+    {
+        if (loadCapture(argv[optind], profiles) < 0)
+        {
+            return 1;
+        }
+        printf("%s: %zu range profiles of %u bins\n", argv[optind], profiles.count(), profiles.numRangeBins);
+    }
+    else
+    {
+        synthesize(numFrames, sigma, profiles);
+        printf("synthetic: %zu range profiles of %u bins, jitter %.0f\n", profiles.count(),
+               profiles.numRangeBins, sigma);
+    }
+    if (profiles.count() == 0)
+    {
+        fprintf(stderr, "no range profiles found\n");
+        return 1;
+    }
+
+    printf("plain          %10.1f bytes/frame\n", (double)profiles.numRangeBins * sizeof(uint16_t));
+    Result lossless;
+    Result lossy;
+    if ((run(profiles, keyframeInterval, 0, lossRate, lossless) < 0) ||
+        (run(profiles, keyframeInterval, tolerance, lossRate, lossy) < 0))
+    {
+        return 1;
+    }
+    print("lossless", profiles, lossless, lossRate);
+    char name[32];
+    snprintf(name, sizeof(name), "tolerance %u", tolerance);
+    print(name, profiles, lossy, lossRate);
+    return (lossless.maxErr == 0U) && (lossy.maxErr <= tolerance) ? 0 : 1;
+}
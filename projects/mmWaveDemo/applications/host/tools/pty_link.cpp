@@ -0,0 +1,413 @@
+/**
+ *   @file  pty_link.cpp
+ *
+ *   @brief
+ *      Emulates the UART data port on a pseudo terminal, so the readers can
+ *      be run against realistic pacing on a machine without serial
+ *      hardware.
+ *
+ *      Run: build/pty_link [-i capture [-L]] [-H] [-A virtualAnt] [-n packets] [-b baud]
+ *                          [-p periodMs] [-j jitterMs] [-d dropRate]
+ *                          [-c burstProbability] [-C burstLen] [-g bytes]
+ *                          [-l link] [-s startDelay] [-T | -S ppm] [-D period] [-k skipRate]
+ *                          [-B budgetPercent] [-Q keepAliveFrames [-q activity]]
+ *
+ *      The packets come from a raw capture of the data port (-i, -L to loop
+ *      it) or are synthetic (-H adds a heat map, -A a static azimuth heat
+ *      map of that many virtual antennas), one every -p ms or back to
+ *      back. They go out at exactly baud / 10 bytes per second (8N1: start,
+ *      8 data and stop bit), in -g byte pieces like the USB packets of the
+ *      XDS110. What the reader doesn't take in time is lost, as on a real
+ *      UART. Impairments:
+ *
+ *          -j  uniform random delay of every packet start, up to jitterMs
+ *          -d  probability of a byte being dropped
+ *          -c  probability of a packet getting a burst of -C random bytes
+ *
+ *      -T writes the CLOCK_MONOTONIC time in us (low 32 bits) at which the
+ *      last byte of the packet is due into timeCpuCycles of its header;
+ *      uart_reader -T turns that into the end to end latency.
+ *
+ *      -S emulates the DSS instead: timeCpuCycles is a 600 MHz counter
+ *      running ppm fast from a random start, read when the packet is due
+ *      (before jitter and a busy line), and the stats TLV gets a processing
+ *      time of 2 to 4 ms and the transmit time of the previous packet.
+ *      latency_report estimates the drift back.
+ *
+ *      -D adds the DSS and MSS counters to every period-th synthetic packet,
+ *      and -k is the probability of the emulated DSS skipping a frame
+ *      because the MSS is busy: the frame number is never sent and
+ *      detObjLoggingSkip counts it. loss_report accounts both.
+ *
+ *      -B runs the synthetic packets through the output scheduler of the
+ *      DSS (mmw_output_sched.h), as outputBudgetCfg <baud / 10> <percent>
+ *      would with a frame period of -p ms: heat maps which do not fit take
+ *      turns and the packets report what was shed.
+ *
+ *      -Q runs the synthetic frames through the quiet mode of the DSS
+ *      (mmw_quiet_mode.h), as quietModeCfg 1 <threshold> <keepAliveFrames>
+ *      would: only a -q share (0.1) of the frames has objects, the others
+ *      have a still range profile and are not sent, except for a heartbeat
+ *      after keepAliveFrames frames without a packet. Their slots on the
+ *      line stay empty.
+ *
+ *      The slave side is printed and optionally symlinked with -l.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "mmw_wire.h"
+#include "raw_capture.h"
+#include "synthetic_output.h"
+#include "tlv_parser.h"
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+volatile std::sig_atomic_t gStop = 0;
+
+void onSignal(int)
+{
+    gStop = 1;
+}
+
+struct Options
+{
+    const char  *capture = nullptr;
+    bool        loop = false;
+    bool        heatMap = false;
+    uint32_t    numVirtualAnt = 0;
+    uint32_t    numPackets = 0;
+    uint32_t    baudRate = 921600;
+    double      periodMs = -1.0;
+    double      jitterMs = 0.0;
+    double      dropRate = 0.0;
+    double      burstProbability = 0.0;
+    uint32_t    burstLen = 16;
+    uint32_t    granularity = 64;
+    const char  *link = nullptr;
+    double      startDelay = 1.0;
+    bool        stamp = false;
+    bool        dssClock = false;
+    double      dssDriftPpm = 0.0;
+    uint32_t    deviceStatsPeriod = 0;
+    double      skipRate = 0.0;
+    uint32_t    budgetPercent = 0;
+    bool        quietMode = false;
+    uint16_t    quietKeepAliveFrames = 0;
+    double      quietActivity = 0.1;
+};
+
+struct LinkStats
+{
+    uint64_t    packets = 0;
+    uint64_t    skipped = 0;
+    uint64_t    quiet = 0;
+    uint64_t    bytes = 0;
+    uint64_t    droppedBytes = 0;
+    uint64_t    bursts = 0;
+    uint64_t    overrunBytes = 0;
+};
+
+/* Offset of timeCpuCycles in MmwDemo_output_message_header */
+const size_t TIME_OFFSET = offsetof(mmw::MsgHeader, timeCpuCycles);
+
+/* DSS clock of the xWR16xx */
+const double DSS_CLOCK_HZ = 600e6;
+
+/* Writes the device timing of the stats TLV, if the packet has one */
+void writeStats(std::vector<uint8_t> &packet, uint32_t processingUs, uint32_t transmitUs)
+{
+    mmw::TlvParserConfig cfg;
+    cfg.sdkMajor = 0;
+    mmw::FrameView view;
+    const mmw::TlvRef *tlv = nullptr;
+    if ((mmw::parseFrame(packet.data(), packet.size(), cfg, view) != mmw::PARSE_OK) ||
+        ((tlv = view.find(mmw::TLV_STATS)) == nullptr) || (tlv->length < sizeof(mmw::Stats)))
+    {
+        return;
+    }
+    uint8_t *p = packet.data() + (tlv->payload - packet.data());
+    std::memcpy(p + offsetof(mmw::Stats, interFrameProcessingTime), &processingUs, sizeof(processingUs));
+    std::memcpy(p + offsetof(mmw::Stats, transmitOutputTime), &transmitUs, sizeof(transmitUs));
+}
+
+int openPty(std::string &slaveName, int &slaveFd)
+{
+    const int master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if ((master < 0) || (grantpt(master) < 0) || (unlockpt(master) < 0))
+    {
+        return -1;
+    }
+    slaveName = ptsname(master);
+
+    /* Held open so the pair survives readers coming and going */
+    slaveFd = open(slaveName.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (slaveFd < 0)
+    {
+        close(master);
+        return -1;
+    }
+    struct termios tio;
+    tcgetattr(slaveFd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slaveFd, TCSANOW, &tio);
+
+    const int flags = fcntl(master, F_GETFL);
+    fcntl(master, F_SETFL, flags | O_NONBLOCK);
+    return master;
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    Options opt;
+    int     c;
+
+    while ((c = getopt(argc, argv, "i:LHA:n:b:p:j:d:c:C:g:l:s:TS:D:k:B:Q:q:")) != -1)
+    {
+        switch (c)
+        {
+        case 'i': opt.capture = optarg; break;
+        case 'L': opt.loop = true; break;
+        case 'H': opt.heatMap = true; break;
+        case 'A': opt.numVirtualAnt = (uint32_t)atoi(optarg); break;
+        case 'n': opt.numPackets = (uint32_t)atoi(optarg); break;
+        case 'b': opt.baudRate = (uint32_t)atoi(optarg); break;
+        case 'p': opt.periodMs = atof(optarg); break;
+        case 'j': opt.jitterMs = atof(optarg); break;
+        case 'd': opt.dropRate = atof(optarg); break;
+        case 'c': opt.burstProbability = atof(optarg); break;
+        case 'C': opt.burstLen = (uint32_t)atoi(optarg); break;
+        case 'g': opt.granularity = (uint32_t)atoi(optarg); break;
+        case 'l': opt.link = optarg; break;
+        case 's': opt.startDelay = atof(optarg); break;
+        case 'T': opt.stamp = true; break;
+        case 'S': opt.dssClock = true; opt.dssDriftPpm = atof(optarg); break;
+        case 'D': opt.deviceStatsPeriod = (uint32_t)atoi(optarg); break;
+        case 'k': opt.skipRate = atof(optarg); break;
+        case 'B': opt.budgetPercent = (uint32_t)atoi(optarg); break;
+        case 'Q': opt.quietMode = true; opt.quietKeepAliveFrames = (uint16_t)atoi(optarg); break;
+        case 'q': opt.quietActivity = atof(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-i capture [-L]] [-H] [-A virtualAnt] [-n packets] [-b baud] [-p periodMs]"
+                    " [-j jitterMs] [-d dropRate] [-c burstProbability] [-C burstLen] [-g bytes]"
+                    " [-l link] [-s startDelay] [-T | -S ppm] [-D period] [-k skipRate] [-B budgetPercent]"
+                    " [-Q keepAliveFrames [-q activity]]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((opt.baudRate == 0U) || (opt.granularity == 0U))
+    {
+        fprintf(stderr, "baud rate and granularity must not be 0\n");
+        return 1;
+    }
+    if (opt.stamp && opt.dssClock)
+    {
+        fprintf(stderr, "-T and -S both write timeCpuCycles\n");
+        return 1;
+    }
+
+    mmw::RawCapture capture;
+    if ((opt.capture != nullptr) && (capture.load(opt.capture) < 0))
+    {
+        fprintf(stderr, "no output packets in %s\n", opt.capture);
+        return 1;
+    }
+    if (opt.periodMs < 0.0)
+    {
+        /* A capture has no timing, synthetic packets come at 10 fps */
+        opt.periodMs = (opt.capture != nullptr) ? 0.0 : 100.0;
+    }
+
+    std::string slaveName;
+    int slaveFd = -1;
+    const int master = openPty(slaveName, slaveFd);
+    if (master < 0)
+    {
+        fprintf(stderr, "cannot create a pty: %s\n", strerror(errno));
+        return 1;
+    }
+    if (opt.link != nullptr)
+    {
+        unlink(opt.link);
+        if (symlink(slaveName.c_str(), opt.link) < 0)
+        {
+            fprintf(stderr, "cannot link %s: %s\n", opt.link, strerror(errno));
+        }
+    }
+    printf("%s\n", (opt.link != nullptr) ? opt.link : slaveName.c_str());
+    fflush(stdout);
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    mmw::SyntheticOutputConfig synCfg;
+    synCfg.heatMap = opt.heatMap;
+    synCfg.numVirtualAnt = opt.numVirtualAnt;
+    synCfg.deviceStatsPeriod = opt.deviceStatsPeriod;
+    synCfg.quietMode = opt.quietMode;
+    synCfg.quietKeepAliveFrames = opt.quietKeepAliveFrames;
+    synCfg.quietActivity = opt.quietActivity;
+    if (opt.budgetPercent > 0U)
+    {
+        synCfg.budgetBytes = MmwDemo_outputSchedBudget(opt.baudRate / 10U,
+                                                       (uint32_t)(opt.periodMs * 1000.0),
+                                                       opt.budgetPercent);
+        printf("output budget %u bytes per packet\n", synCfg.budgetBytes);
+    }
+    mmw::SyntheticOutput synthetic(synCfg);
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const double byteTime = 10.0 / opt.baudRate;
+    auto at = [](Clock::time_point t, double s)
+    {
+        return t + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(s));
+    };
+
+    LinkStats st;
+    std::vector<uint8_t> packet;
+    std::vector<uint8_t> chunk;
+    const Clock::time_point t0 = at(Clock::now(), opt.startDelay);
+    Clock::time_point lineFree = t0;
+    const uint32_t dssStart = (uint32_t)rng();
+    const double dssHz = DSS_CLOCK_HZ * (1.0 + opt.dssDriftPpm * 1e-6);
+    uint32_t lastTransmitUs = 0;
+
+    for (uint32_t n = 0; !gStop && ((opt.numPackets == 0U) || (n < opt.numPackets)); n++)
+    {
+        if ((opt.skipRate > 0.0) && (uniform(rng) < opt.skipRate))
+        {
+            /* The frame's slot on the line stays empty */
+            if (synthetic.skip(n))
+            {
+                st.skipped++;
+            }
+            else
+            {
+                st.quiet++;
+            }
+            continue;
+        }
+        if (opt.capture != nullptr)
+        {
+            const size_t numPackets = capture.packets().size();
+            if (!opt.loop && (n >= numPackets))
+            {
+                break;
+            }
+            const uint8_t *p = capture.packet(n % numPackets);
+            packet.assign(p, p + capture.packets()[n % numPackets].len);
+        }
+        else
+        {
+            if (!synthetic.build(n))
+            {
+                st.quiet++;
+                continue;
+            }
+            packet = synthetic.bytes();
+        }
+
+        const Clock::time_point due = std::max((opt.periodMs > 0.0) ? t0 : lineFree,
+                                               at(t0, n * opt.periodMs / 1000.0));
+        Clock::time_point start = std::max(lineFree, due);
+        if (opt.jitterMs > 0.0)
+        {
+            start = at(start, uniform(rng) * opt.jitterMs / 1000.0);
+        }
+        const Clock::time_point end = at(start, packet.size() * byteTime);
+        lineFree = end;
+
+        if (opt.dssClock)
+        {
+            const double s = std::chrono::duration<double>(due - t0).count();
+            const uint32_t cycles = dssStart + (uint32_t)(uint64_t)std::llround(s * dssHz);
+            std::memcpy(&packet[TIME_OFFSET], &cycles, sizeof(cycles));
+            writeStats(packet, 2000U + (uint32_t)(rng() % 2001U), lastTransmitUs);
+            lastTransmitUs = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(end - due).count();
+        }
+
+        if (opt.stamp)
+        {
+            const uint32_t us = (uint32_t)(std::chrono::duration_cast<std::chrono::microseconds>(
+                                               end.time_since_epoch()).count());
+            std::memcpy(&packet[TIME_OFFSET], &us, sizeof(us));
+        }
+        if (opt.dssClock || opt.stamp)
+        {
+            /* The MSS takes the CRC of the packet as sent */
+            mmw::sealPacketCrc(packet.data(), packet.size());
+        }
+        if ((opt.burstProbability > 0.0) && (uniform(rng) < opt.burstProbability))
+        {
+            const size_t len = std::min<size_t>(opt.burstLen, packet.size());
+            const size_t off = rng() % (packet.size() - len + 1U);
+            for (size_t i = 0; i < len; i++)
+            {
+                packet[off + i] = (uint8_t)rng();
+            }
+            st.bursts++;
+        }
+
+        for (size_t off = 0; (off < packet.size()) && !gStop; off += opt.granularity)
+        {
+            const size_t len = std::min<size_t>(opt.granularity, packet.size() - off);
+
+            /* The piece goes out once its last byte left the line */
+            std::this_thread::sleep_until(at(start, (off + len) * byteTime));
+
+            chunk.clear();
+            for (size_t i = 0; i < len; i++)
+            {
+                if ((opt.dropRate > 0.0) && (uniform(rng) < opt.dropRate))
+                {
+                    st.droppedBytes++;
+                    continue;
+                }
+                chunk.push_back(packet[off + i]);
+            }
+            const ssize_t written = chunk.empty() ? 0 : write(master, chunk.data(), chunk.size());
+            const size_t done = (written > 0) ? (size_t)written : 0U;
+            st.bytes += done;
+            st.overrunBytes += chunk.size() - done;
+        }
+        st.packets++;
+    }
+
+    /* Let the reader drain what is still in the pty */
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    printf("%llu packets, %llu skipped, %llu quiet, %llu bytes at %u baud, %llu dropped, %llu bursts,"
+           " %llu lost to overrun\n",
+           (unsigned long long)st.packets, (unsigned long long)st.skipped, (unsigned long long)st.quiet,
+           (unsigned long long)st.bytes, opt.baudRate,
+           (unsigned long long)st.droppedBytes, (unsigned long long)st.bursts,
+           (unsigned long long)st.overrunBytes);
+    if (opt.link != nullptr)
+    {
+        unlink(opt.link);
+    }
+    close(slaveFd);
+    close(master);
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ *   @file  quiet_timeline.cpp
+ *
+ *   @brief
+ *      Rebuilds the continuous frame timeline from the packets of the
+ *      quiet mode.
+ *
+ *      Run: build/quiet_timeline [-v] -d device [-b baud]
+ *
+ *      Reads the UART data port and hands every packet to a QuietTimeline.
+ *      One line per run of frames in the same state: full frames with
+ *      their objects, heartbeats, quiet frames with the full frame standing
+ *      for them, frames the DSS skipped and frames lost. -v prints every
+ *      frame instead. The counts per state are printed at exit.
+ */
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#include <unistd.h>
+
+#include "quiet_timeline.h"
+#include "tlv_parser.h"
+#include "uart_reader.h"
+
+namespace
+{
+
+volatile std::sig_atomic_t gStop = 0;
+
+void onSignal(int)
+{
+    gStop = 1;
+}
+
+const char *STATE_NAMES[mmw::TIMELINE_NUM_STATES] =
+{
+    "full", "heartbeat", "quiet", "skipped", "quiet or skipped", "lost"
+};
+
+/* Run of frames in one state, printed when the state changes */
+struct Run
+{
+    bool                active = false;
+    uint32_t            first = 0;
+    uint32_t            last = 0;
+    mmw::TimelineState  state = mmw::TIMELINE_FULL;
+    bool                haveRef = false;
+    uint32_t            ref = 0;
+};
+
+void printRun(const Run &run)
+{
+    if (!run.active)
+    {
+        return;
+    }
+    printf("frames %u-%u %s", run.first, run.last, STATE_NAMES[run.state]);
+    if ((run.state != mmw::TIMELINE_FULL) && run.haveRef)
+    {
+        printf(", as frame %u", run.ref);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    mmw::UartReaderConfig   ucfg;
+    bool    verbose = false;
+    int     c;
+
+    while ((c = getopt(argc, argv, "vd:b:")) != -1)
+    {
+        switch (c)
+        {
+        case 'v': verbose = true; break;
+        case 'd': ucfg.device = optarg; break;
+        case 'b': ucfg.baudRate = (uint32_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-v] -d device [-b baud]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (ucfg.device.empty())
+    {
+        fprintf(stderr, "need -d device\n");
+        return 1;
+    }
+
+    std::mutex lock;
+    Run run;
+    mmw::QuietTimeline timeline([&](const mmw::TimelineFrame &f)
+    {
+        const bool haveRef = (f.frame != nullptr);
+        const uint32_t ref = haveRef ? f.frame->header.frameNumber : 0U;
+        if (verbose)
+        {
+            printf("frame %u %s", f.frameNumber, STATE_NAMES[f.state]);
+            if (f.state == mmw::TIMELINE_FULL)
+            {
+                printf(", %u objects", f.frame->header.numDetectedObj);
+            }
+            else if (haveRef)
+            {
+                printf(", as frame %u", ref);
+            }
+            printf("\n");
+            return;
+        }
+        /* Full frames run together, the others as long as they stand for
+         * the same full frame */
+        if (run.active && (f.state == run.state) && (f.frameNumber == run.last + 1U) &&
+            ((f.state == mmw::TIMELINE_FULL) || ((haveRef == run.haveRef) && (ref == run.ref))))
+        {
+            run.last = f.frameNumber;
+            return;
+        }
+        printRun(run);
+        run.active = true;
+        run.first = f.frameNumber;
+        run.last = f.frameNumber;
+        run.state = f.state;
+        run.haveRef = haveRef;
+        run.ref = ref;
+    });
+
+    mmw::TlvParserConfig parserCfg;
+    parserCfg.sdkMajor = 0;
+    uint64_t rejected = 0;
+
+    mmw::UartReader uart;
+    if (uart.open(ucfg) < 0)
+    {
+        perror(ucfg.device.c_str());
+        return 1;
+    }
+    uart.addCallback([&](const mmw::UartFrame &frame)
+    {
+        mmw::FrameView view;
+        std::lock_guard<std::mutex> guard(lock);
+        if (mmw::parseFrame(frame.data, frame.len, parserCfg, view) != mmw::PARSE_OK)
+        {
+            rejected++;
+            return;
+        }
+        timeline.add(view);
+    });
+    uart.start();
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    while (!gStop && uart.running())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    uart.close();
+
+    std::lock_guard<std::mutex> guard(lock);
+    printRun(run);
+    for (uint32_t s = 0; s < mmw::TIMELINE_NUM_STATES; s++)
+    {
+        printf("%s %llu, ", STATE_NAMES[s], (unsigned long long)timeline.count((mmw::TimelineState)s));
+    }
+    printf("duplicates %llu, rejected %llu\n", (unsigned long long)timeline.duplicates(),
+           (unsigned long long)rejected);
+    return 0;
+}
@@ -0,0 +1,201 @@
+/**
+ *   @file  redis_sink.cpp
+ *
+ *   @brief
+ *      Writes the detected objects, and optionally downsampled range/azimuth
+ *      heat maps, into Redis Streams.
+ *
+ *      Run: build/redis_sink [-H host] [-P port] [-k prefix] [-M maxLen] [-e every]
+ *                            [-D decimation] [-m heatMapMaxLen] [-V virtualAnt] [-A angleBins]
+ *                            [-Q backlogKB] [-p oldest|newest] [-I inflight]
+ *                            [-n bus | -d device [-b baud]]
+ *
+ *      Frames come from the frame bus (-n, mmw_frames by default, see
+ *      frame_bus_pub) or straight from the data port (-d). Objects go to
+ *      <prefix>:objects trimmed to about -M entries, every -e-th frame's
+ *      heat map with -D range bins pooled per row to <prefix>:heatmap
+ *      trimmed to about -m entries. -Q bounds the frames waiting for the
+ *      server, -p picks what is dropped beyond it, -I is the pipeline depth.
+ *      Once a second frames, commands and writes, the backlog, what was
+ *      dropped or lost and the latency to the server's reply are printed.
+ */
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "azimuth_heatmap.h"
+#include "frame_bus.h"
+#include "host_clock.h"
+#include "redis_sink.h"
+#include "tlv_parser.h"
+#include "uart_reader.h"
+
+namespace
+{
+
+volatile std::sig_atomic_t gStop = 0;
+
+void onSignal(int)
+{
+    gStop = 1;
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    mmw::RedisSinkConfig    scfg;
+    mmw::UartReaderConfig   rcfg;
+    std::string busName = "mmw_frames";
+    int         c;
+
+    while ((c = getopt(argc, argv, "H:P:k:M:e:D:m:V:A:Q:p:I:n:d:b:")) != -1)
+    {
+        switch (c)
+        {
+        case 'H': scfg.host = optarg; break;
+        case 'P': scfg.port = (uint16_t)atoi(optarg); break;
+        case 'k': scfg.prefix = optarg; break;
+        case 'M': scfg.objectsMaxLen = (uint32_t)atoi(optarg); break;
+        case 'e': scfg.heatmapEvery = (uint32_t)atoi(optarg); break;
+        case 'D': scfg.rangeDecimation = (uint32_t)atoi(optarg); break;
+        case 'm': scfg.heatmapMaxLen = (uint32_t)atoi(optarg); break;
+        case 'V': scfg.numVirtualAnt = (uint32_t)atoi(optarg); break;
+        case 'A': scfg.numAngleBins = (uint32_t)atoi(optarg); break;
+        case 'Q': scfg.maxBacklogBytes = (size_t)atoi(optarg) * 1024U; break;
+        case 'p':
+            scfg.dropPolicy = (strcmp(optarg, "newest") == 0) ? mmw::REDIS_DROP_NEWEST : mmw::REDIS_DROP_OLDEST;
+            break;
+        case 'I': scfg.maxInflight = (uint32_t)atoi(optarg); break;
+        case 'n': busName = optarg; break;
+        case 'd': rcfg.device = optarg; break;
+        case 'b': rcfg.baudRate = (uint32_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-H host] [-P port] [-k prefix] [-M maxLen] [-e every] [-D decimation]"
+                    " [-m heatMapMaxLen] [-V virtualAnt] [-A angleBins] [-Q backlogKB] [-p oldest|newest]"
+                    " [-I inflight] [-n bus | -d device [-b baud]]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    mmw::RedisSink sink;
+    if (sink.start(scfg) < 0)
+    {
+        fprintf(stderr, "bad sink configuration (-I at least 2, angle bins a power of two, at least %u)\n",
+                MMW_AZIMUTH_HEATMAP_MIN_BINS);
+        return 1;
+    }
+
+    mmw::TlvParserConfig parserCfg;
+    parserCfg.sdkMajor = 0;
+    uint64_t skipped = 0;
+    mmw::FrameBusConsumer bus;
+    mmw::UartReader reader;
+    if (!rcfg.device.empty())
+    {
+        if (reader.open(rcfg) < 0)
+        {
+            perror(rcfg.device.c_str());
+            return 1;
+        }
+        /* push() never waits, so it runs on the reader thread */
+        reader.addCallback([&](const mmw::UartFrame &frame)
+        {
+            mmw::FrameView view;
+            if (mmw::parseFrame(frame.data, frame.len, parserCfg, view) == mmw::PARSE_OK)
+            {
+                sink.push(view, frame.lastByteNs);
+            }
+            else
+            {
+                skipped++;
+            }
+        });
+        reader.start();
+    }
+    else if (bus.open(busName, "redis_sink") < 0)
+    {
+        fprintf(stderr, "no frame bus %s, start frame_bus_pub first\n", busName.c_str());
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    std::vector<uint8_t> packet;
+    mmw::RedisSinkStats last;
+    uint64_t lastReportNs = mmw::monotonicNs();
+
+    while (!gStop)
+    {
+        if (!rcfg.device.empty())
+        {
+            if (!reader.running())
+            {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        else
+        {
+            mmw::FrameBusFrame frame;
+            if (bus.next(frame, 100) == 0)
+            {
+                mmw::FrameView view;
+                packet.resize(frame.len);
+                if ((bus.copy(frame, packet.data(), packet.size()) >= 0) &&
+                    (mmw::parseFrame(packet.data(), packet.size(), parserCfg, view) == mmw::PARSE_OK))
+                {
+                    sink.push(view, frame.hostNs);
+                }
+                else
+                {
+                    skipped++;
+                }
+            }
+            else if (!bus.producerAlive())
+            {
+                printf("publisher of the frame bus gone\n");
+                break;
+            }
+        }
+
+        const uint64_t now = mmw::monotonicNs();
+        if (now - lastReportNs >= 1000000000ULL)
+        {
+            const mmw::RedisSinkStats st = sink.stats();
+            const mmw::LagHistogram lat = st.latency.since(last.latency);
+            const uint64_t writes = st.writes - last.writes;
+            printf("%s%llu frames/s, %llu cmd/s in %llu writes, backlog %u frames %.1f KB, inflight %u,"
+                   " latency p50 %.3f p99 %.3f ms, %llu dropped, %llu failed, %llu errors\n",
+                   st.connected ? "" : "[disconnected] ",
+                   (unsigned long long)(st.frames - last.frames), (unsigned long long)(st.commands - last.commands),
+                   (unsigned long long)writes, st.backlogFrames, st.backlogBytes / 1e3, st.inflight,
+                   (lat.count != 0U) ? lat.percentile(0.5) / 1e6 : 0.0,
+                   (lat.count != 0U) ? lat.percentile(0.99) / 1e6 : 0.0,
+                   (unsigned long long)st.dropped, (unsigned long long)st.failed, (unsigned long long)st.errors);
+            fflush(stdout);
+            last = st;
+            lastReportNs = now;
+        }
+    }
+
+    reader.close();
+    sink.flush(2000);
+    sink.stop();
+    const mmw::RedisSinkStats st = sink.stats();
+    printf("%llu frames, %llu commands in %llu writes, %llu replies, %llu dropped, %llu failed, %llu errors,"
+           " %llu skipped, %llu connects, latency p50 %.3f p99 %.3f ms\n",
+           (unsigned long long)st.frames, (unsigned long long)st.commands, (unsigned long long)st.writes,
+           (unsigned long long)st.replies, (unsigned long long)st.dropped, (unsigned long long)st.failed,
+           (unsigned long long)st.errors, (unsigned long long)skipped, (unsigned long long)st.connects,
+           st.latency.percentile(0.5) / 1e6, st.latency.percentile(0.99) / 1e6);
+    bus.close();
+    return 0;
+}
@@ -0,0 +1,490 @@
+/**
+ *   @file  redis_stub.cpp
+ *
+ *   @brief
+ *      Local Redis stand-in with the stream commands the sink uses, to run
+ *      redis_sink without a real server.
+ *
+ *      Run: build/redis_stub [-p port] [-d delayMs] [-q]
+ *
+ *      Speaks RESP and knows PING, XADD (* IDs, MAXLEN [~|=] n), XLEN,
+ *      XREVRANGE key + - [COUNT n] and DEL; anything else gets an error
+ *      reply. -d sleeps that long before handling each read of a client, a
+ *      stand in for a busy or distant server: commands pile up in the
+ *      socket and arrive in bigger pipelines. MAXLEN ~ trims in steps of
+ *      100 entries like the radix tree nodes of Redis. Once a second the
+ *      commands, reads and stream lengths are printed, -q only prints the
+ *      totals on exit. Nothing is persisted.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "host_clock.h"
+
+namespace
+{
+
+volatile std::sig_atomic_t gStop = 0;
+
+void onSignal(int)
+{
+    gStop = 1;
+}
+
+/* Entries MAXLEN ~ may leave beyond the limit */
+const size_t APPROX_TRIM_STEP = 100;
+
+uint64_t wallMs()
+{
+    return mmw::clockNs(CLOCK_REALTIME) / 1000000ULL;
+}
+
+struct StreamEntry
+{
+    uint64_t                    ms;
+    uint64_t                    seq;
+    std::vector<std::string>    fields;
+};
+
+struct Stream
+{
+    std::deque<StreamEntry>     entries;
+    uint64_t                    lastMs = 0;
+    uint64_t                    lastSeq = 0;
+};
+
+struct Client
+{
+    int                         fd = -1;
+    std::string                 in;
+    std::string                 out;
+    size_t                      outPos = 0;
+    bool                        closing = false;
+};
+
+struct Counters
+{
+    uint64_t    commands = 0;
+    uint64_t    reads = 0;
+    uint64_t    bytes = 0;
+    uint64_t    errors = 0;
+};
+
+void replyBulk(std::string &out, const std::string &s)
+{
+    out += '$';
+    out += std::to_string(s.size());
+    out += "\r\n";
+    out += s;
+    out += "\r\n";
+}
+
+void replyError(std::string &out, const char *msg)
+{
+    out += "-ERR ";
+    out += msg;
+    out += "\r\n";
+}
+
+std::string entryId(const StreamEntry &e)
+{
+    return std::to_string(e.ms) + "-" + std::to_string(e.seq);
+}
+
+/* One RESP array of bulk strings at in[pos], 0 while incomplete, <0 bad */
+long parseCommand(const std::string &in, size_t pos, std::vector<std::string> &args)
+{
+    args.clear();
+    if (in[pos] != '*')
+    {
+        return -1;
+    }
+    size_t eol = in.find("\r\n", pos);
+    if (eol == std::string::npos)
+    {
+        return 0;
+    }
+    const long count = std::strtol(in.c_str() + pos + 1, nullptr, 10);
+    size_t p = eol + 2U;
+    for (long i = 0; i < count; i++)
+    {
+        if (p >= in.size())
+        {
+            return 0;
+        }
+        if (in[p] != '$')
+        {
+            return -1;
+        }
+        eol = in.find("\r\n", p);
+        if (eol == std::string::npos)
+        {
+            return 0;
+        }
+        const long len = std::strtol(in.c_str() + p + 1, nullptr, 10);
+        if (len < 0)
+        {
+            return -1;
+        }
+        if (eol + 2U + (size_t)len + 2U > in.size())
+        {
+            return 0;
+        }
+        args.emplace_back(in, eol + 2U, (size_t)len);
+        p = eol + 2U + (size_t)len + 2U;
+    }
+    return (long)(p - pos);
+}
+
+std::string upper(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char ch) { return (char)toupper(ch); });
+    return s;
+}
+
+class Server
+{
+public:
+    std::vector<std::unique_ptr<Client>> &clients() { return m_clients; }
+    const Counters &counters() const { return m_counters; }
+    const std::map<std::string, Stream> &streams() const { return m_streams; }
+    void countRead() { m_counters.reads++; }
+
+    void add(int fd)
+    {
+        std::unique_ptr<Client> c(new Client());
+        c->fd = fd;
+        m_clients.push_back(std::move(c));
+    }
+
+    /* Handles every complete command in the input of c */
+    void process(Client &c)
+    {
+        std::vector<std::string> args;
+        size_t pos = 0;
+        while (!c.closing && (pos < c.in.size()))
+        {
+            const long n = parseCommand(c.in, pos, args);
+            if (n == 0)
+            {
+                break;
+            }
+            if (n < 0)
+            {
+                replyError(c.out, "Protocol error");
+                c.closing = true;
+                break;
+            }
+            pos += (size_t)n;
+            m_counters.commands++;
+            command(c.out, args);
+        }
+        c.in.erase(0, pos);
+    }
+
+private:
+    void command(std::string &out, const std::vector<std::string> &args)
+    {
+        const std::string cmd = args.empty() ? std::string() : upper(args[0]);
+        if (cmd == "PING")
+        {
+            out += "+PONG\r\n";
+        }
+        else if (cmd == "XADD")
+        {
+            xadd(out, args);
+        }
+        else if ((cmd == "XLEN") && (args.size() == 2U))
+        {
+            auto it = m_streams.find(args[1]);
+            out += ':';
+            out += std::to_string((it == m_streams.end()) ? 0U : it->second.entries.size());
+            out += "\r\n";
+        }
+        else if ((cmd == "XREVRANGE") && (args.size() >= 4U))
+        {
+            xrevrange(out, args);
+        }
+        else if ((cmd == "DEL") && (args.size() >= 2U))
+        {
+            size_t n = 0;
+            for (size_t i = 1; i < args.size(); i++)
+            {
+                n += m_streams.erase(args[i]);
+            }
+            out += ':';
+            out += std::to_string(n);
+            out += "\r\n";
+        }
+        else
+        {
+            m_counters.errors++;
+            replyError(out, "unknown command or wrong number of arguments");
+        }
+    }
+
+    /* XADD key [MAXLEN [~|=] n] * field value [field value ...] */
+    void xadd(std::string &out, const std::vector<std::string> &args)
+    {
+        size_t i = 2;
+        size_t maxLen = 0;
+        bool trim = false;
+        bool approx = false;
+        if ((args.size() > i) && (upper(args[i]) == "MAXLEN"))
+        {
+            trim = true;
+            i++;
+            if ((args.size() > i) && ((args[i] == "~") || (args[i] == "=")))
+            {
+                approx = (args[i] == "~");
+                i++;
+            }
+            if (args.size() <= i)
+            {
+                m_counters.errors++;
+                replyError(out, "syntax error");
+                return;
+            }
+            maxLen = (size_t)std::strtoull(args[i].c_str(), nullptr, 10);
+            i++;
+        }
+        if ((args.size() <= i) || (args[i] != "*") || (((args.size() - i - 1U) % 2U) != 0U) ||
+            (args.size() - i - 1U == 0U))
+        {
+            m_counters.errors++;
+            replyError(out, "only * IDs and field value pairs are supported");
+            return;
+        }
+
+        Stream &s = m_streams[args[1]];
+        StreamEntry e;
+        e.ms = std::max(wallMs(), s.lastMs);
+        e.seq = (e.ms == s.lastMs) ? s.lastSeq + 1U : 0U;
+        e.fields.assign(args.begin() + (std::ptrdiff_t)i + 1, args.end());
+        for (const std::string &f : e.fields)
+        {
+            m_counters.bytes += f.size();
+        }
+        s.lastMs = e.ms;
+        s.lastSeq = e.seq;
+        s.entries.push_back(std::move(e));
+        if (trim)
+        {
+            if (!approx)
+            {
+                while (s.entries.size() > maxLen)
+                {
+                    s.entries.pop_front();
+                }
+            }
+            else if (s.entries.size() >= maxLen + APPROX_TRIM_STEP)
+            {
+                const size_t drop = ((s.entries.size() - maxLen) / APPROX_TRIM_STEP) * APPROX_TRIM_STEP;
+                s.entries.erase(s.entries.begin(), s.entries.begin() + (std::ptrdiff_t)drop);
+            }
+        }
+        replyBulk(out, entryId(s.entries.back()));
+    }
+
+    /* XREVRANGE key + - [COUNT n], only the full range */
+    void xrevrange(std::string &out, const std::vector<std::string> &args)
+    {
+        size_t count = SIZE_MAX;
+        if ((args.size() == 6U) && (upper(args[4]) == "COUNT"))
+        {
+            count = (size_t)std::strtoull(args[5].c_str(), nullptr, 10);
+        }
+        auto it = m_streams.find(args[1]);
+        const size_t have = (it == m_streams.end()) ? 0U : it->second.entries.size();
+        const size_t n = std::min(count, have);
+        out += '*';
+        out += std::to_string(n);
+        out += "\r\n";
+        for (size_t k = 0; k < n; k++)
+        {
+            const StreamEntry &e = it->second.entries[have - 1U - k];
+            out += "*2\r\n";
+            replyBulk(out, entryId(e));
+            out += '*';
+            out += std::to_string(e.fields.size());
+            out += "\r\n";
+            for (const std::string &f : e.fields)
+            {
+                replyBulk(out, f);
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Client>>    m_clients;
+    std::map<std::string, Stream>           m_streams;
+    Counters                                m_counters;
+};
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    uint16_t    port = 6379;
+    uint32_t    delayMs = 0;
+    bool        quiet = false;
+    int         c;
+
+    while ((c = getopt(argc, argv, "p:d:q")) != -1)
+    {
+        switch (c)
+        {
+        case 'p': port = (uint16_t)atoi(optarg); break;
+        case 'd': delayMs = (uint32_t)atoi(optarg); break;
+        case 'q': quiet = true; break;
+        default:
+            fprintf(stderr, "usage: %s [-p port] [-d delayMs] [-q]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const int lfd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    const int one = 1;
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if ((lfd < 0) || (bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) != 0) || (listen(lfd, 16) != 0))
+    {
+        perror("listen");
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    printf("listening on port %u\n", (unsigned)port);
+    fflush(stdout);
+
+    Server server;
+    Counters last;
+    uint64_t lastReport = mmw::monotonicNs();
+    std::vector<struct pollfd> pfds;
+    static char buf[1 << 20];
+
+    while (!gStop)
+    {
+        auto &clients = server.clients();
+        pfds.clear();
+        pfds.push_back({ lfd, POLLIN, 0 });
+        for (auto &cl : clients)
+        {
+            pfds.push_back({ cl->fd, (short)(POLLIN | ((cl->out.size() > cl->outPos) ? POLLOUT : 0)), 0 });
+        }
+        if ((poll(pfds.data(), pfds.size(), 200) < 0) && (errno != EINTR))
+        {
+            break;
+        }
+
+        for (size_t i = 0; i < clients.size(); i++)
+        {
+            Client &cl = *clients[i];
+            if ((pfds[i + 1U].revents & (POLLIN | POLLHUP | POLLERR)) == 0)
+            {
+                continue;
+            }
+            if (delayMs != 0U)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+            }
+            const ssize_t n = recv(cl.fd, buf, sizeof(buf), 0);
+            if (n > 0)
+            {
+                server.countRead();
+                cl.in.append(buf, (size_t)n);
+                server.process(cl);
+            }
+            else if ((n == 0) || ((errno != EAGAIN) && (errno != EINTR)))
+            {
+                cl.closing = true;
+            }
+        }
+        for (auto &cl : clients)
+        {
+            while (cl->out.size() > cl->outPos)
+            {
+                const ssize_t n = send(cl->fd, cl->out.data() + cl->outPos, cl->out.size() - cl->outPos,
+                                       MSG_NOSIGNAL);
+                if (n <= 0)
+                {
+                    cl->closing = cl->closing || ((n < 0) && (errno != EAGAIN) && (errno != EINTR));
+                    break;
+                }
+                cl->outPos += (size_t)n;
+            }
+            if (cl->outPos == cl->out.size())
+            {
+                cl->out.clear();
+                cl->outPos = 0;
+            }
+        }
+        clients.erase(std::remove_if(clients.begin(), clients.end(), [](const std::unique_ptr<Client> &cl)
+        {
+            if (cl->closing)
+            {
+                close(cl->fd);
+            }
+            return cl->closing;
+        }), clients.end());
+
+        if ((pfds[0].revents & POLLIN) != 0)
+        {
+            const int fd = accept4(lfd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (fd >= 0)
+            {
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                server.add(fd);
+            }
+        }
+
+        const uint64_t now = mmw::monotonicNs();
+        if (!quiet && (now - lastReport >= 1000000000ULL))
+        {
+            const Counters &n = server.counters();
+            printf("%zu clients, %llu cmd/s in %llu reads, %.2f MB/s",
+                   server.clients().size(), (unsigned long long)(n.commands - last.commands),
+                   (unsigned long long)(n.reads - last.reads), (n.bytes - last.bytes) / 1e6);
+            for (const auto &s : server.streams())
+            {
+                printf(", %s %zu", s.first.c_str(), s.second.entries.size());
+            }
+            printf("\n");
+            fflush(stdout);
+            last = n;
+            lastReport = now;
+        }
+    }
+
+    const Counters &n = server.counters();
+    printf("%llu commands in %llu reads, %.1f MB, %llu errors\n", (unsigned long long)n.commands,
+           (unsigned long long)n.reads, n.bytes / 1e6, (unsigned long long)n.errors);
+    for (auto &cl : server.clients())
+    {
+        close(cl->fd);
+    }
+    close(lfd);
+    return 0;
+}
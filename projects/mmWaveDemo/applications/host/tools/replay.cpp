@@ -0,0 +1,214 @@
+/**
+ *   @file  replay.cpp
+ *
+ *   @brief
+ *      Replays a capture file to consumers and reports how they keep up.
+ *
+ *      Run: build/replay [-x speed] [-C device|frame|host] [-f frameNumber]
+ *                        [-s seconds] [-n frames] [-l loops] [-q depth] [-D]
+ *                        [-w ms] [-O path] capture.mmwcap
+ *
+ *      -x is the speed (1 the recorded cadence, 0 as fast as possible), -C
+ *      what the cadence is taken from (timeCpuCycles by default), -f / -s
+ *      where to start, -n how many frames, -l how many passes (0 loops
+ *      forever). Consumers:
+ *
+ *          parse   validates every packet with the TLV parser
+ *          work    with -w, spends that many ms of CPU per frame, a stand
+ *                  in for a renderer or tracker
+ *          out     with -O, writes the packets to a file or FIFO, e.g. for
+ *                  uart_reader -d fifo
+ *
+ *      Each consumer has its own thread and a queue of -q frames; when it
+ *      is full the replay waits (falling behind the schedule), or with -D
+ *      the consumer loses the frame. Once a second the frame rate, how late
+ *      the replay runs and per consumer the lag from the due time, the time
+ *      per frame and the queue are printed.
+ */
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "replay.h"
+#include "tlv_parser.h"
+
+namespace
+{
+
+volatile std::sig_atomic_t gStop = 0;
+
+void onSignal(int)
+{
+    gStop = 1;
+}
+
+void spin(double ms)
+{
+    const auto until = std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(ms);
+    while (std::chrono::steady_clock::now() < until)
+    {
+    }
+}
+
+void printConsumers(const std::vector<mmw::ReplayConsumerStats> &now,
+                    const std::vector<mmw::ReplayConsumerStats> &before, size_t depth)
+{
+    for (size_t i = 0; i < now.size(); i++)
+    {
+        const mmw::ReplayConsumerStats &c = now[i];
+        const uint64_t dropped = c.dropped - ((i < before.size()) ? before[i].dropped : 0U);
+        const bool behind = (dropped > 0U) || (c.queued >= depth);
+        printf("    %-6s %8llu frames, lag p50 %8.3f p99 %8.3f max %8.3f ms, %6.3f ms/frame, queue %zu/%zu"
+               ", %llu dropped%s\n", c.name.c_str(), (unsigned long long)c.frames, c.lag.percentile(0.5) / 1e6,
+               c.lag.percentile(0.99) / 1e6, c.lag.maxNs / 1e6,
+               (c.busy.count > 0U) ? (double)c.busy.sumNs / c.busy.count / 1e6 : 0.0, c.queued, depth,
+               (unsigned long long)c.dropped, behind ? "  << cannot keep up" : "");
+    }
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    mmw::ReplayConfig cfg;
+    long long   startFrame = -1;
+    double      startSeconds = -1.0;
+    long long   numFrames = -1;
+    double      workMs = 0.0;
+    const char  *outPath = nullptr;
+    int         c;
+
+    while ((c = getopt(argc, argv, "x:C:f:s:n:l:q:Dw:O:")) != -1)
+    {
+        switch (c)
+        {
+        case 'x': cfg.speed = atof(optarg); break;
+        case 'C':
+            cfg.clock = (strcmp(optarg, "host") == 0) ? mmw::REPLAY_CLOCK_HOST :
+                        (strcmp(optarg, "frame") == 0) ? mmw::REPLAY_CLOCK_FRAME : mmw::REPLAY_CLOCK_DEVICE;
+            break;
+        case 'f': startFrame = atoll(optarg); break;
+        case 's': startSeconds = atof(optarg); break;
+        case 'n': numFrames = atoll(optarg); break;
+        case 'l': cfg.loops = (uint32_t)atoi(optarg); break;
+        case 'q': cfg.queueDepth = (size_t)atoi(optarg); break;
+        case 'D': cfg.dropWhenFull = true; break;
+        case 'w': workMs = atof(optarg); break;
+        case 'O': outPath = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-x speed] [-C device|frame|host] [-f frameNumber] [-s seconds] [-n frames]"
+                    " [-l loops] [-q depth] [-D] [-w ms] [-O path] capture.mmwcap\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc)
+    {
+        fprintf(stderr, "no capture file\n");
+        return 1;
+    }
+
+    mmw::CaptureFile cap;
+    if ((cap.open(argv[optind]) < 0) || (cap.numFrames() == 0U))
+    {
+        fprintf(stderr, "%s: not a capture file or no frames\n", argv[optind]);
+        return 1;
+    }
+    if (startFrame >= 0)
+    {
+        cfg.first = cap.seekFrame((uint32_t)startFrame);
+    }
+    else if (startSeconds >= 0.0)
+    {
+        cfg.first = cap.seekTime(cap.entry(0).hostNs + (uint64_t)(startSeconds * 1e9));
+    }
+    if (numFrames >= 0)
+    {
+        cfg.end = cfg.first + (size_t)numFrames;
+    }
+
+    mmw::Replayer replayer;
+    if (replayer.open(cap, cfg) < 0)
+    {
+        fprintf(stderr, "nothing to replay (empty range, or -C frame without frameCfg in the capture)\n");
+        return 1;
+    }
+
+    uint64_t badPackets = 0;
+    replayer.addConsumer("parse", [&badPackets](const mmw::ReplayFrame &frame)
+    {
+        mmw::TlvParserConfig parserCfg;
+        parserCfg.sdkMajor = 0;
+        mmw::FrameView view;
+        if (mmw::parseFrame(frame.data, frame.len, parserCfg, view) != mmw::PARSE_OK)
+        {
+            badPackets++;
+        }
+    });
+    if (workMs > 0.0)
+    {
+        replayer.addConsumer("work", [workMs](const mmw::ReplayFrame &) { spin(workMs); });
+    }
+    int outFd = -1;
+    if (outPath != nullptr)
+    {
+        outFd = open(outPath, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (outFd < 0)
+        {
+            perror(outPath);
+            return 1;
+        }
+        replayer.addConsumer("out", [outFd](const mmw::ReplayFrame &frame)
+        {
+            size_t off = 0;
+            while (off < frame.len)
+            {
+                const ssize_t n = write(outFd, frame.data + off, frame.len - off);
+                if (n <= 0)
+                {
+                    break;
+                }
+                off += (size_t)n;
+            }
+        });
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("replaying frames %zu..%zu of %zu at %s\n", cfg.first, std::min(cfg.end, cap.numFrames()) - 1U,
+           cap.numFrames(), (cfg.speed > 0.0) ? (std::to_string(cfg.speed) + "x").c_str() : "max speed");
+    const auto t0 = std::chrono::steady_clock::now();
+    replayer.start();
+
+    mmw::ReplayStats last;
+    std::vector<mmw::ReplayConsumerStats> lastConsumers = replayer.consumerStats();
+    while (!gStop && !replayer.wait(1000))
+    {
+        const mmw::ReplayStats st = replayer.stats();
+        const std::vector<mmw::ReplayConsumerStats> consumers = replayer.consumerStats();
+        printf("frame %zu, pass %u: %llu fps, %.3f ms late (max %.3f)\n", st.position, st.loop,
+               (unsigned long long)(st.frames - last.frames), st.lateNs / 1e6, st.maxLateNs / 1e6);
+        printConsumers(consumers, lastConsumers, cfg.queueDepth);
+        last = st;
+        lastConsumers = consumers;
+    }
+    replayer.stop();
+
+    const double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    const mmw::ReplayStats st = replayer.stats();
+    printf("%llu frames in %.3f s, %.1f fps, replay at most %.3f ms late, %llu packets fail to parse\n",
+           (unsigned long long)st.frames, dt, st.frames / dt, st.maxLateNs / 1e6, (unsigned long long)badPackets);
+    printConsumers(replayer.consumerStats(), lastConsumers, cfg.queueDepth);
+    if (outFd >= 0)
+    {
+        close(outFd);
+    }
+    return 0;
+}
@@ -0,0 +1,203 @@
+/**
+ *   @file  spi_loopback.cpp
+ *
+ *   @brief
+ *      Stand-in for the MSS SPI slave and the host master, so the framing
+ *      and the link throughput can be checked without a board.
+ *
+ *      Run: build/spi_loopback [-c clockHz] [-n packets] [-e bitErrorRate] [-H]
+ *
+ *      The slave thread does what MmwDemo_spiTask does: it cuts synthetic
+ *      output packets into frames with the firmware framer, arms one frame
+ *      at a time behind a ready flag and builds the next one meanwhile. The
+ *      master thread waits for ready, clocks the frame at the SPI clock
+ *      (-c 0 for as fast as possible), optionally flips bits, and feeds the
+ *      reassembler. Every reassembled packet is compared with the original.
+ */
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "mmw_spi_frame.h"
+#include "mmw_wire.h"
+#include "spi_frame.h"
+#include "synthetic_output.h"
+
+namespace
+{
+
+/* The ready GPIO and the end of transfer callback */
+struct Link
+{
+    std::mutex              lock;
+    std::condition_variable cv;
+    const uint8_t           *armed = nullptr;
+    bool                    done = false;
+    bool                    finished = false;
+};
+
+struct Options
+{
+    double      clockHz = 20e6;
+    uint32_t    numPackets = 2000;
+    double      bitErrorRate = 0.0;
+    bool        heatMap = false;
+};
+
+void slave(const Options &opt, Link &link)
+{
+    alignas(32) static uint8_t frames[2][MMW_SPI_FRAME_SIZE];
+    MmwDemo_spiFramer framer;
+    mmw::SyntheticOutputConfig cfg;
+    cfg.heatMap = opt.heatMap;
+    mmw::SyntheticOutput packet(cfg);
+
+    MmwDemo_spiFramerInit(&framer);
+    for (uint32_t n = 0; n < opt.numPackets; n++)
+    {
+        packet.build(n);
+        MmwDemo_spiFramerStart(&framer, packet.segments(), packet.numSegments());
+
+        uint32_t frameIdx = 0;
+        uint32_t payloadLen = MmwDemo_spiFramerNext(&framer, frames[frameIdx]);
+        while (payloadLen > 0)
+        {
+            {
+                std::lock_guard<std::mutex> guard(link.lock);
+                link.armed = frames[frameIdx];
+                link.done = false;
+            }
+            link.cv.notify_all();
+
+            frameIdx ^= 1U;
+            payloadLen = MmwDemo_spiFramerNext(&framer, frames[frameIdx]);
+
+            std::unique_lock<std::mutex> guard(link.lock);
+            link.cv.wait(guard, [&] { return link.done; });
+        }
+    }
+    {
+        std::lock_guard<std::mutex> guard(link.lock);
+        link.finished = true;
+    }
+    link.cv.notify_all();
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    Options opt;
+    int     c;
+
+    while ((c = getopt(argc, argv, "c:n:e:H")) != -1)
+    {
+        switch (c)
+        {
+        case 'c': opt.clockHz = atof(optarg); break;
+        case 'n': opt.numPackets = (uint32_t)atoi(optarg); break;
+        case 'e': opt.bitErrorRate = atof(optarg); break;
+        case 'H': opt.heatMap = true; break;
+        default:
+            fprintf(stderr, "usage: %s [-c clockHz] [-n packets] [-e bitErrorRate] [-H]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    uint64_t    numMismatch = 0;
+    uint64_t    wireBytes = 0;
+    mmw::SyntheticOutputConfig cfg;
+    cfg.heatMap = opt.heatMap;
+    mmw::SyntheticOutput expected(cfg);
+    mmw::SpiDeframer deframer([&](const uint8_t *pkt, size_t len)
+                              {
+                                  expected.build(mmw::load<mmw::MsgHeader>(pkt).frameNumber);
+                                  const std::vector<uint8_t> ref = expected.bytes();
+                                  if ((ref.size() != len) || (std::memcmp(ref.data(), pkt, len) != 0))
+                                  {
+                                      numMismatch++;
+                                  }
+                              });
+
+    Link link;
+    std::vector<uint8_t> rx(MMW_SPI_FRAME_SIZE);
+    std::mt19937 rng(7);
+    std::poisson_distribution<int> flips(opt.bitErrorRate * MMW_SPI_FRAME_SIZE * 8.0);
+    std::uniform_int_distribution<uint32_t> bit(0, MMW_SPI_FRAME_SIZE * 8U - 1U);
+
+    std::thread slaveThread(slave, std::cref(opt), std::ref(link));
+    const auto t0 = std::chrono::steady_clock::now();
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> guard(link.lock);
+            link.cv.wait(guard, [&] { return (link.armed != nullptr) || link.finished; });
+            if (link.armed == nullptr)
+            {
+                break;
+            }
+            std::memcpy(rx.data(), link.armed, MMW_SPI_FRAME_SIZE);
+            link.armed = nullptr;
+        }
+        wireBytes += MMW_SPI_FRAME_SIZE;
+
+        /* The frame takes 8 clocks per byte on the wire */
+        if (opt.clockHz > 0.0)
+        {
+            std::this_thread::sleep_until(t0 + std::chrono::duration<double>(wireBytes * 8.0 / opt.clockHz));
+        }
+        {
+            std::lock_guard<std::mutex> guard(link.lock);
+            link.done = true;
+        }
+        link.cv.notify_all();
+
+        if (opt.bitErrorRate > 0.0)
+        {
+            for (int n = flips(rng); n > 0; n--)
+            {
+                const uint32_t b = bit(rng);
+                rx[b / 8U] ^= (uint8_t)(1U << (b % 8U));
+            }
+        }
+        deframer.push(rx.data());
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    slaveThread.join();
+
+    const mmw::SpiLinkStats &st = deframer.stats();
+    printf("frame size       %8u bytes, %u payload\n", MMW_SPI_FRAME_SIZE, (unsigned)MMW_SPI_FRAME_PAYLOAD_SIZE);
+    if (opt.clockHz > 0.0)
+    {
+        printf("clock            %8.1f MHz, %.2f MB/s on the wire\n", opt.clockHz / 1e6, opt.clockHz / 8e6);
+    }
+    else
+    {
+        printf("clock            unpaced\n");
+    }
+    printf("wire             %8.2f MB/s\n", wireBytes / elapsed / 1e6);
+    printf("payload          %8.2f MB/s (%.1f %% of the wire)\n", st.payloadBytes / elapsed / 1e6,
+           wireBytes ? 100.0 * st.payloadBytes / (double)wireBytes : 0.0);
+    printf("frames           %8llu ok, %llu sync, %llu length, %llu crc errors, %llu lost\n",
+           (unsigned long long)st.frames, (unsigned long long)st.syncErrors,
+           (unsigned long long)st.lengthErrors, (unsigned long long)st.crcErrors,
+           (unsigned long long)st.lostFrames);
+    printf("packets          %8llu of %u delivered, %llu dropped, %llu bad, %llu mismatched\n",
+           (unsigned long long)st.packets, opt.numPackets, (unsigned long long)st.droppedPackets,
+           (unsigned long long)st.badPackets, (unsigned long long)numMismatch);
+
+    /* Without injected errors every packet has to arrive intact */
+    if ((opt.bitErrorRate == 0.0) && ((st.packets != opt.numPackets) || (numMismatch != 0)))
+    {
+        return 1;
+    }
+    return (numMismatch != 0) ? 1 : 0;
+}
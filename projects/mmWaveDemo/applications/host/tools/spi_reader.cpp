@@ -0,0 +1,124 @@
+/**
+ *   @file  spi_reader.cpp
+ *
+ *   @brief
+ *      Reads the MSS output stream from an FT232H and reports the link.
+ *
+ *      Run: build/spi_reader [-d channel] [-c clockHz] [-l latencyMs]
+ *                            [-s chunkBytes] [-r readyMask] [-t seconds]
+ *
+ *      The tool links against libMPSSE.so: the build puts the mock next to
+ *      it, LD_LIBRARY_PATH=../ftdi_driver/SPI picks the real library (and
+ *      libftd2xx) instead. Frames come out of mmw::SpiReader without a copy
+ *      and go straight into the packet reassembler; once a second the wire
+ *      rate, payload rate and loss counters are printed.
+ */
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+
+#include <unistd.h>
+
+#include "spi_frame.h"
+#include "spi_reader.h"
+
+namespace
+{
+
+volatile std::sig_atomic_t gStop = 0;
+
+void onSignal(int)
+{
+    gStop = 1;
+}
+
+void report(const char *tag, const mmw::SpiReaderStats &st, const mmw::SpiLinkStats &link,
+            double seconds, uint64_t bytes, uint64_t payload)
+{
+    printf("%-6s %7.2f MB/s wire, %7.2f MB/s payload | frames %llu, lost %llu, crc %llu, skipped %llu B"
+           " | packets %llu, dropped %llu | ring full %llu, io errors %llu\n",
+           tag, bytes / seconds / 1e6, payload / seconds / 1e6,
+           (unsigned long long)st.frames, (unsigned long long)st.lostFrames,
+           (unsigned long long)st.crcErrors, (unsigned long long)st.skippedBytes,
+           (unsigned long long)link.packets, (unsigned long long)link.droppedPackets,
+           (unsigned long long)st.ringFullWaits, (unsigned long long)st.ioErrors);
+    fflush(stdout);
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    mmw::SpiReaderConfig cfg;
+    double  duration = 0.0;
+    int     c;
+
+    while ((c = getopt(argc, argv, "d:c:l:s:r:t:")) != -1)
+    {
+        switch (c)
+        {
+        case 'd': cfg.channel = (uint32_t)atoi(optarg); break;
+        case 'c': cfg.clockHz = (uint32_t)atof(optarg); break;
+        case 'l': cfg.latencyTimer = (uint8_t)atoi(optarg); break;
+        case 's': cfg.chunkSize = (uint32_t)atoi(optarg); break;
+        case 'r': cfg.readyMask = (uint8_t)strtoul(optarg, nullptr, 0); break;
+        case 't': duration = atof(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-d channel] [-c clockHz] [-l latencyMs] [-s chunkBytes]"
+                    " [-r readyMask] [-t seconds]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    mmw::SpiReader reader;
+    if (reader.open(cfg) < 0)
+    {
+        fprintf(stderr, "cannot open SPI channel %u\n", cfg.channel);
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    mmw::SpiDeframer deframer([](const uint8_t *, size_t) {});
+    reader.start();
+
+    using Clock = std::chrono::steady_clock;
+    const auto t0 = Clock::now();
+    auto tLast = t0;
+    mmw::SpiReaderStats last;
+    uint64_t lastPayload = 0;
+
+    while (!gStop)
+    {
+        mmw::SpiFrameRef frame;
+        if (reader.next(frame, 100) == 0)
+        {
+            deframer.push(frame.data);
+            reader.release(frame);
+        }
+
+        const auto now = Clock::now();
+        const double sinceLast = std::chrono::duration<double>(now - tLast).count();
+        if (sinceLast >= 1.0)
+        {
+            const mmw::SpiReaderStats st = reader.stats();
+            report("1s", st, deframer.stats(), sinceLast, st.bytesRead - last.bytesRead,
+                   deframer.stats().payloadBytes - lastPayload);
+            last = st;
+            lastPayload = deframer.stats().payloadBytes;
+            tLast = now;
+        }
+        if ((duration > 0.0) && (std::chrono::duration<double>(now - t0).count() >= duration))
+        {
+            break;
+        }
+    }
+    reader.stop();
+
+    const double elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+    const mmw::SpiReaderStats st = reader.stats();
+    report("total", st, deframer.stats(), elapsed, st.bytesRead, deframer.stats().payloadBytes);
+    reader.close();
+    return 0;
+}
@@ -0,0 +1,231 @@
+/**
+ *   @file  tlv_parser_bench.cpp
+ *
+ *   @brief
+ *      Throughput of the output packet parser.
+ *
+ *      Run: build/tlv_parser_bench [-m megabytes] [-n passes] [-H] [capture.bin ...]
+ *
+ *      The packets of the captures (raw dumps of the UART data port), or
+ *      synthetic ones (-H with a heat map), are repeated with a few bytes of
+ *      garbage in between until the stream has -m MB. The stream is then
+ *      walked -n times by:
+ *
+ *          bytewise    memcmp at every offset, as the old scanners did
+ *          scalar      findMagicScalar (memchr + memcmp)
+ *          simd        findMagic
+ *          parse       mmw::TlvParser, every packet validated and viewed
+ *
+ *      Heap allocations during the parse passes are counted as well; there
+ *      should be none.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <vector>
+
+#include <unistd.h>
+
+#include "raw_capture.h"
+#include "synthetic_output.h"
+#include "tlv_parser.h"
+
+namespace
+{
+
+std::atomic<uint64_t> gAllocations{0};
+
+} /* anonymous namespace */
+
+void *operator new(size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    void *p = malloc(size ? size : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+double seconds(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+size_t countBytewise(const uint8_t *p, size_t n)
+{
+    size_t count = 0;
+    size_t pos = 0;
+    while (pos + sizeof(mmw::MAGIC_WORD) <= n)
+    {
+        if (std::memcmp(p + pos, mmw::MAGIC_WORD, sizeof(mmw::MAGIC_WORD)) == 0)
+        {
+            count++;
+            pos += sizeof(mmw::MAGIC_WORD);
+            continue;
+        }
+        pos++;
+    }
+    return count;
+}
+
+template <typename Find>
+size_t countWith(Find find, const uint8_t *p, size_t n)
+{
+    size_t count = 0;
+    const uint8_t *end = p + n;
+    const uint8_t *hit;
+    while ((hit = find(p, (size_t)(end - p))) != nullptr)
+    {
+        count++;
+        p = hit + sizeof(mmw::MAGIC_WORD);
+    }
+    return count;
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    double      megabytes = 256.0;
+    uint32_t    passes = 5;
+    bool        heatMap = false;
+    int         opt;
+
+    while ((opt = getopt(argc, argv, "m:n:H")) != -1)
+    {
+        switch (opt)
+        {
+        case 'm': megabytes = atof(optarg); break;
+        case 'n': passes = (uint32_t)atoi(optarg); break;
+        case 'H': heatMap = true; break;
+        default:
+            fprintf(stderr, "usage: %s [-m megabytes] [-n passes] [-H] [capture.bin ...]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    /* Source packets */
+    std::vector<std::vector<uint8_t>> packets;
+    for (int i = optind; i < argc; i++)
+    {
+        mmw::RawCapture capture;
+        if (capture.load(argv[i]) < 0)
+        {
+            fprintf(stderr, "%s: no output packets\n", argv[i]);
+            return 1;
+        }
+        for (size_t k = 0; k < capture.packets().size(); k++)
+        {
+            packets.emplace_back(capture.packet(k), capture.packet(k) + capture.packets()[k].len);
+        }
+    }
+    if (packets.empty())
+    {
+        mmw::SyntheticOutputConfig cfg;
+        cfg.heatMap = heatMap;
+        mmw::SyntheticOutput synthetic(cfg);
+        for (uint32_t f = 0; f < 64; f++)
+        {
+            synthetic.build(f);
+            packets.push_back(synthetic.bytes());
+        }
+    }
+
+    /* The stream */
+    const size_t target = (size_t)(megabytes * 1e6);
+    std::vector<uint8_t> stream;
+    stream.reserve(target + 1024 * 1024);
+    std::mt19937 rng(1);
+    size_t numPackets = 0;
+    while (stream.size() < target)
+    {
+        for (uint32_t g = rng() % 16U; g > 0; g--)
+        {
+            stream.push_back((uint8_t)rng());
+        }
+        const std::vector<uint8_t> &p = packets[numPackets % packets.size()];
+        stream.insert(stream.end(), p.begin(), p.end());
+        numPackets++;
+    }
+    const double gb = stream.size() * (double)passes / 1e9;
+    printf("stream           %8.1f MB, %zu packets of %zu distinct, %u passes\n", stream.size() / 1e6,
+           numPackets, packets.size(), passes);
+
+    const uint8_t *data = stream.data();
+    const size_t n = stream.size();
+    size_t found = 0;
+
+    Clock::time_point t0 = Clock::now();
+    for (uint32_t i = 0; i < passes; i++)
+    {
+        found = countBytewise(data, n);
+    }
+    printf("bytewise         %8.2f GB/s, %zu magic words\n", gb / seconds(t0), found);
+
+    t0 = Clock::now();
+    for (uint32_t i = 0; i < passes; i++)
+    {
+        found = countWith(mmw::findMagicScalar, data, n);
+    }
+    printf("scalar           %8.2f GB/s, %zu magic words\n", gb / seconds(t0), found);
+
+    t0 = Clock::now();
+    for (uint32_t i = 0; i < passes; i++)
+    {
+        found = countWith(mmw::findMagic, data, n);
+    }
+    printf("simd             %8.2f GB/s, %zu magic words\n", gb / seconds(t0), found);
+
+    /* Full parse; the views are touched so nothing is optimized away */
+    mmw::FrameView frame;
+    uint64_t checksum = 0;
+    uint64_t frames = 0;
+    uint64_t skipped = 0;
+    const uint64_t allocBefore = gAllocations.load();
+    t0 = Clock::now();
+    for (uint32_t i = 0; i < passes; i++)
+    {
+        mmw::TlvParser parser;
+        const uint8_t *cursor = data;
+        while (parser.next(cursor, data + n, frame) == mmw::PARSE_OK)
+        {
+            checksum += frame.objects.size() + frame.numTlvs;
+            if (!frame.rangeProfile.empty())
+            {
+                checksum += frame.rangeProfile[0];
+            }
+        }
+        frames = parser.stats().frames;
+        skipped = parser.stats().skippedBytes;
+    }
+    const double parseTime = seconds(t0);
+    const uint64_t allocations = gAllocations.load() - allocBefore;
+    printf("parse            %8.2f GB/s, %.2f M packets/s, %llu packets, %llu skipped bytes per pass\n",
+           gb / parseTime, frames * (double)passes / parseTime / 1e6, (unsigned long long)frames,
+           (unsigned long long)skipped);
+    printf("allocations      %8llu during the parse passes (checksum %llu)\n", (unsigned long long)allocations,
+           (unsigned long long)checksum);
+
+    return ((frames == numPackets) && (allocations == 0)) ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+/**
+ *   @file  uart_reader.cpp
+ *
+ *   @brief
+ *      Reads the output packets from the UART data port and reports them.
+ *
+ *      Run: build/uart_reader -d device [-b baud] [-t seconds] [-v] [-T]
+ *
+ *      Once a second the packet rate, byte rate, resync counters and the
+ *      time a packet took to arrive (first to last read) are printed; -v
+ *      also prints every packet header. With -T, timeCpuCycles is taken as
+ *      the CLOCK_MONOTONIC us at which the last byte left the sender
+ *      (pty_link -T) and the end to end latency is printed as well. The
+ *      tool ends on ^C, after -t seconds or when the port goes away.
+ */
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "mmw_wire.h"
+#include "uart_reader.h"
+
+namespace
+{
+
+volatile std::sig_atomic_t gStop = 0;
+
+void onSignal(int)
+{
+    gStop = 1;
+}
+
+struct Window
+{
+    std::mutex  lock;
+    uint64_t    packets = 0;
+    uint64_t    arrivalNs = 0;
+    uint64_t    maxArrivalNs = 0;
+    uint32_t    lastFrameNumber = 0;
+    uint64_t    frameGaps = 0;
+    bool        haveFrame = false;
+    std::vector<uint32_t> latencyUs;
+};
+
+void printLatency(std::vector<uint32_t> &us)
+{
+    if (us.empty())
+    {
+        return;
+    }
+    std::sort(us.begin(), us.end());
+    printf("       latency us: min %u, p50 %u, p99 %u, max %u\n", us.front(), us[us.size() / 2],
+           us[(us.size() * 99) / 100], us.back());
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char *argv[])
+{
+    mmw::UartReaderConfig cfg;
+    double  duration = 0.0;
+    bool    verbose = false;
+    bool    stamped = false;
+    int     c;
+
+    while ((c = getopt(argc, argv, "d:b:t:vT")) != -1)
+    {
+        switch (c)
+        {
+        case 'd': cfg.device = optarg; break;
+        case 'b': cfg.baudRate = (uint32_t)atoi(optarg); break;
+        case 't': duration = atof(optarg); break;
+        case 'v': verbose = true; break;
+        case 'T': stamped = true; break;
+        default:
+            cfg.device.clear();
+            break;
+        }
+    }
+    if (cfg.device.empty())
+    {
+        fprintf(stderr, "usage: %s -d device [-b baud] [-t seconds] [-v] [-T]\n", argv[0]);
+        return 1;
+    }
+
+    mmw::UartReader reader;
+    if (reader.open(cfg) < 0)
+    {
+        fprintf(stderr, "cannot open %s at %u baud\n", cfg.device.c_str(), cfg.baudRate);
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    Window win;
+    reader.addCallback([&](const mmw::UartFrame &frame)
+                       {
+                           const mmw::MsgHeader hdr = mmw::load<mmw::MsgHeader>(frame.data);
+                           std::lock_guard<std::mutex> guard(win.lock);
+                           if (win.haveFrame && (hdr.frameNumber != win.lastFrameNumber + 1U))
+                           {
+                               win.frameGaps++;
+                           }
+                           win.haveFrame = true;
+                           win.lastFrameNumber = hdr.frameNumber;
+                           win.packets++;
+                           const uint64_t arrival = frame.lastByteNs - frame.firstByteNs;
+                           win.arrivalNs += arrival;
+                           if (arrival > win.maxArrivalNs)
+                           {
+                               win.maxArrivalNs = arrival;
+                           }
+                           if (stamped)
+                           {
+                               win.latencyUs.push_back((uint32_t)(frame.lastByteNs / 1000U) - hdr.timeCpuCycles);
+                           }
+                           if (verbose)
+                           {
+                               printf("frame %u: %u bytes, %u TLVs, %u objects\n", hdr.frameNumber,
+                                      frame.len, hdr.numTLVs, hdr.numDetectedObj);
+                           }
+                       });
+    reader.start();
+
+    using Clock = std::chrono::steady_clock;
+    const auto t0 = Clock::now();
+    auto tLast = t0;
+    mmw::UartReaderStats last;
+
+    while (!gStop && reader.running())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        const auto now = Clock::now();
+        const double sinceLast = std::chrono::duration<double>(now - tLast).count();
+        if (sinceLast >= 1.0)
+        {
+            const mmw::UartReaderStats st = reader.stats();
+            std::lock_guard<std::mutex> guard(win.lock);
+            printf("%6.1f packets/s, %7.3f MB/s, arrival avg %.2f ms max %.2f ms"
+                   " | frames %llu, gaps %llu, skipped %llu B, bad lengths %llu\n",
+                   win.packets / sinceLast, (st.bytesRead - last.bytesRead) / sinceLast / 1e6,
+                   win.packets ? win.arrivalNs / 1e6 / win.packets : 0.0, win.maxArrivalNs / 1e6,
+                   (unsigned long long)st.frames, (unsigned long long)win.frameGaps,
+                   (unsigned long long)st.skippedBytes, (unsigned long long)st.badLengths);
+            printLatency(win.latencyUs);
+            fflush(stdout);
+            win.latencyUs.clear();
+            win.packets = 0;
+            win.arrivalNs = 0;
+            win.maxArrivalNs = 0;
+            last = st;
+            tLast = now;
+        }
+        if ((duration > 0.0) && (std::chrono::duration<double>(now - t0).count() >= duration))
+        {
+            break;
+        }
+    }
+    reader.close();
+
+    const mmw::UartReaderStats st = reader.stats();
+    printf("total  %llu bytes in %llu reads, %llu packets, %llu frame number gaps, %llu skipped B,"
+           " %llu bad lengths, %llu bad packets (%llu CRC), %llu resyncs, %llu read errors\n",
+           (unsigned long long)st.bytesRead, (unsigned long long)st.reads, (unsigned long long)st.frames,
+           (unsigned long long)win.frameGaps, (unsigned long long)st.skippedBytes,
+           (unsigned long long)st.badLengths, (unsigned long long)st.badPackets,
+           (unsigned long long)st.crcErrors, (unsigned long long)st.resyncs,
+           (unsigned long long)st.readErrors);
+    return 0;
+}
@@ -1,9 +1,34 @@
-from ctypes import cdll
-serial = cdll.LoadLibrary('./serial.so')
+# Binding of the compiled reader, the mmwave module built by
+# `make` in ../host (build/mmwave*.so)
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'host', 'build'))
+
+import mmwave
+
 
 class serial(object):
-    def __init__(self):
-        self.obj = serial.initialize()
+    def __init__(self, device='/dev/ttyACM1', baud=921600):
+        self.obj = mmwave.Reader(device, baud=baud)
+
+    def read(self, timeout=None):
+        # mmwave.Frame; its arrays go to numpy without a copy, e.g.
+        # numpy.asarray(frame.objects), numpy.asarray(frame.azimuth_complex64())
+        return self.obj.read(timeout)
+
+    def close(self):
+        self.obj.close()
+
+
+class bus(object):
+    # Consumer of the frame bus published by build/frame_bus_pub, so any
+    # number of scripts can share the one process on the data port
+    def __init__(self, name='mmw_frames', consumer='python'):
+        self.obj = mmwave.BusReader(name, consumer)
+
+    def read(self, timeout=None):
+        return self.obj.read(timeout)
 
-    def read(self):
-        serial.read(self.obj)
\ No newline at end of file
+    def close(self):
+        self.obj.close()
@@ -146,23 +146,25 @@ global MAX_NUM_OBJECTS;
 global OBJ_STRUCT_SIZE_BYTES ;
 global TOTAL_PAYLOAD_SIZE_BYTES;
 
-MMWDEMO_UART_MSG_DETECTED_POINTS = 1;
-MMWDEMO_UART_MSG_RANGE_PROFILE   = 2;
-MMWDEMO_UART_MSG_NOISE_PROFILE   = 3;
-MMWDEMO_UART_MSG_AZIMUT_STATIC_HEAT_MAP = 4;
-MMWDEMO_UART_MSG_RANGE_DOPPLER_HEAT_MAP = 5;
-MMWDEMO_UART_MSG_STATS =6;
+% Packet layout generated from board/common/mmw_tlv_schema.json
+L = mmw_tlv_layout;
+MMWDEMO_UART_MSG_DETECTED_POINTS = L.TLV.DETECTED_POINTS;
+MMWDEMO_UART_MSG_RANGE_PROFILE   = L.TLV.RANGE_PROFILE;
+MMWDEMO_UART_MSG_NOISE_PROFILE   = L.TLV.NOISE_PROFILE;
+MMWDEMO_UART_MSG_AZIMUT_STATIC_HEAT_MAP = L.TLV.AZIMUTH_STATIC_HEAT_MAP;
+MMWDEMO_UART_MSG_RANGE_DOPPLER_HEAT_MAP = L.TLV.RANGE_DOPPLER_HEAT_MAP;
+MMWDEMO_UART_MSG_STATS = L.TLV.STATS;
 
 
 %display('version 0.6');
 
 % below defines correspond to the mmw demo code
 MAX_NUM_OBJECTS = 100;
-OBJ_STRUCT_SIZE_BYTES = 12;
+OBJ_STRUCT_SIZE_BYTES = L.DetObj.LEN;
 NUM_ANGLE_BINS = 64;
 
 global STATS_SIZE_BYTES
-STATS_SIZE_BYTES = 16;
+STATS_SIZE_BYTES = L.Stats.LEN;
 
 
 global bytevec_log;
@@ -557,7 +559,7 @@ while (~EXIT_KEY_PRESSED)
     
     bytevecStr = char(bytevec_cp);
     magicOk = 0;
-    startIdx = strfind(bytevecStr', char([2 1 4 3 6 5 8 7]));
+    startIdx = strfind(bytevecStr', char(L.MAGIC_WORD));
     if ~isempty(startIdx)
         if startIdx(1) > 1
             bytevec_cp(1: bytevec_cp_len-(startIdx(1)-1)) = bytevec_cp(startIdx(1):bytevec_cp_len);
@@ -568,7 +570,7 @@ while (~EXIT_KEY_PRESSED)
             bytevec_cp_len = 0;
         end
 
-        totalPacketLen = sum(bytevec_cp(8+4+[1:4]) .* [1 256 65536 16777216]');                
+        totalPacketLen = sum(bytevec_cp(L.MsgHeader.totalPacketLen+[1:4]) .* [1 256 65536 16777216]');                
         if bytevec_cp_len >= totalPacketLen
             magicOk = 1;
         else
@@ -588,6 +590,7 @@ while (~EXIT_KEY_PRESSED)
         detObj.numObj = 0;
         for tlvIdx = 1:Header.numTLVs
             [tlv, byteVecIdx] = getTlv(bytevec_cp, byteVecIdx);
+            tlvEnd = byteVecIdx + tlv.length;
             switch tlv.type
                 case MMWDEMO_UART_MSG_DETECTED_POINTS
                     if tlv.length >= OBJ_STRUCT_SIZE_BYTES
@@ -634,6 +637,8 @@ while (~EXIT_KEY_PRESSED)
                      end
                 otherwise
             end
+            % Types not shown here are skipped
+            byteVecIdx = tlvEnd;
         end
 
         byteVecIdx = Header.totalPacketLen;
@@ -1168,17 +1173,18 @@ global STATS_SIZE_BYTES
                                         (P.profileCfg.idleTime + P.profileCfg.rampEndTime) *...
                                         1e-6 * P.dataPath.numDopplerBins * P.dataPath.numTxAnt);
     %Calculate monitoring packet size
-    tlSize = 8 %TL size 8 bytes
-    TOTAL_PAYLOAD_SIZE_BYTES = 32; % size of header
+    L = mmw_tlv_layout;
+    tlSize = L.TlvHeader.LEN;
+    TOTAL_PAYLOAD_SIZE_BYTES = L.MsgHeader.LEN;
     P.guiMonitor.numFigures = 1; %One figure for numerical parameers
     if P.guiMonitor.detectedObjects == 1 && P.guiMonitor.rangeDopplerHeatMap == 1
         TOTAL_PAYLOAD_SIZE_BYTES = TOTAL_PAYLOAD_SIZE_BYTES +...
-            OBJ_STRUCT_SIZE_BYTES*MAX_NUM_OBJECTS + tlSize;
+            L.FIXED_LEN.DETECTED_POINTS + OBJ_STRUCT_SIZE_BYTES*MAX_NUM_OBJECTS + tlSize;
         P.guiMonitor.numFigures = P.guiMonitor.numFigures + 1; %1 plots: X/Y plot
     end
     if P.guiMonitor.detectedObjects == 1 && P.guiMonitor.rangeDopplerHeatMap ~= 1
         TOTAL_PAYLOAD_SIZE_BYTES = TOTAL_PAYLOAD_SIZE_BYTES +...
-            OBJ_STRUCT_SIZE_BYTES*MAX_NUM_OBJECTS + tlSize;
+            L.FIXED_LEN.DETECTED_POINTS + OBJ_STRUCT_SIZE_BYTES*MAX_NUM_OBJECTS + tlSize;
         P.guiMonitor.numFigures = P.guiMonitor.numFigures + 2; %2 plots: X/Y plot and Y/Doppler plot
     end
     if P.guiMonitor.logMagRange == 1
@@ -1205,7 +1211,7 @@ global STATS_SIZE_BYTES
             STATS_SIZE_BYTES + tlSize;
         P.guiMonitor.numFigures = P.guiMonitor.numFigures + 1;
     end
-    TOTAL_PAYLOAD_SIZE_BYTES = 32 * floor((TOTAL_PAYLOAD_SIZE_BYTES+31)/32);
+    TOTAL_PAYLOAD_SIZE_BYTES = L.SEGMENT_LEN * ceil(TOTAL_PAYLOAD_SIZE_BYTES/L.SEGMENT_LEN);
     P.guiMonitor.numFigRow = 2;
     P.guiMonitor.numFigCol = ceil(P.guiMonitor.numFigures/P.guiMonitor.numFigRow);
     if platformType == hex2dec('a1642')
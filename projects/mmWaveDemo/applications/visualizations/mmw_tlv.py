@@ -0,0 +1,228 @@
+# Generated by board/common/mmw_tlv_gen.py from mmw_tlv_schema.json, do not edit.
+"""Layout of the mmw demo output packet.
+
+numpy dtypes of the wire structs, the TLV types and tlvs(), which walks
+a packet and decodes every TLV by the schema:
+
+    hdr = mmw_tlv.header(packet)
+    for tlvType, fixed, elems, data in mmw_tlv.tlvs(packet):
+        ...
+"""
+import numpy as np
+
+MAGIC_WORD = b'\x02\x01\x04\x03\x06\x05\x08\x07'
+SEGMENT_LEN = 32
+
+MsgHeader = np.dtype([
+    ('magicWord', '<u2', (4,)),
+    ('version', '<u4'),
+    ('totalPacketLen', '<u4'),
+    ('platform', '<u4'),
+    ('frameNumber', '<u4'),
+    ('timeCpuCycles', '<u4'),
+    ('numDetectedObj', '<u4'),
+    ('numTLVs', '<u4'),
+])
+assert MsgHeader.itemsize == 36
+
+TlvHeader = np.dtype([
+    ('type', '<u4'),
+    ('length', '<u4'),
+])
+assert TlvHeader.itemsize == 8
+
+DetObjDescr = np.dtype([
+    ('numDetetedObj', '<u2'),
+    ('xyzQFormat', '<u2'),
+])
+assert DetObjDescr.itemsize == 4
+
+DetObj = np.dtype([
+    ('rangeIdx', '<u2'),
+    ('dopplerIdx', '<i2'),
+    ('peakVal', '<u2'),
+    ('x', '<i2'),
+    ('y', '<i2'),
+    ('z', '<i2'),
+])
+assert DetObj.itemsize == 12
+
+Cmplx16ImRe = np.dtype([
+    ('imag', '<i2'),
+    ('real', '<i2'),
+])
+assert Cmplx16ImRe.itemsize == 4
+
+Stats = np.dtype([
+    ('interFrameProcessingTime', '<u4'),
+    ('transmitOutputTime', '<u4'),
+    ('interFrameProcessingMargin', '<u4'),
+    ('interChirpProcessingMargin', '<u4'),
+    ('activeFrameCPULoad', '<u4'),
+    ('interFrameCPULoad', '<u4'),
+])
+assert Stats.itemsize == 24
+
+RdHeatMapCodecHdr = np.dtype([
+    ('numRangeBins', '<u2'),
+    ('numDopplerBins', '<u2'),
+    ('noiseFloor', '<u2'),
+    ('version', 'u1'),
+    ('reserved', 'u1'),
+])
+assert RdHeatMapCodecHdr.itemsize == 8
+
+RdHeatMapSparseHdr = np.dtype([
+    ('numRangeBins', '<u2'),
+    ('numDopplerBins', '<u2'),
+    ('numRuns', '<u2'),
+    ('margin', '<u2'),
+    ('version', 'u1'),
+    ('flags', 'u1'),
+    ('reserved', '<u2'),
+])
+assert RdHeatMapSparseHdr.itemsize == 12
+
+AzimuthHeatMapHdr = np.dtype([
+    ('numRangeBins', '<u2'),
+    ('numAngleBins', '<u2'),
+    ('format', 'u1'),
+    ('version', 'u1'),
+    ('numVirtualAnt', '<u2'),
+])
+assert AzimuthHeatMapHdr.itemsize == 8
+
+DssStats = np.dtype([
+    ('frameStartIntCounter', '<u4'),
+    ('frameIntSkipCounter', '<u4'),
+    ('chirpIntCounter', '<u4'),
+    ('chirpIntSkipCounter', '<u4'),
+    ('detObjLoggingSkip', '<u4'),
+    ('detObjLoggingErr', '<u4'),
+    ('numFailedTimingReports', '<u4'),
+    ('numCalibrationReports', '<u4'),
+])
+assert DssStats.itemsize == 32
+
+MssStats = np.dtype([
+    ('packetsSent', '<u4'),
+    ('framesSent', '<u4'),
+    ('transferErrors', '<u4'),
+    ('numFailedTimingReports', '<u4'),
+    ('numCalibrationReports', '<u4'),
+])
+assert MssStats.itemsize == 20
+
+OutputShed = np.dtype([
+    ('shedMask', '<u4'),
+    ('budgetBytes', '<u4'),
+    ('packetLen', '<u4'),
+])
+assert OutputShed.itemsize == 12
+
+QuietReport = np.dtype([
+    ('prevFrameNumber', '<u4'),
+    ('quietFrames', '<u4'),
+    ('maxRangeDelta', '<u2'),
+    ('flags', '<u2'),
+])
+assert QuietReport.itemsize == 12
+
+ProfileDeltaHdr = np.dtype([
+    ('numRangeBins', '<u2'),
+    ('seq', '<u2'),
+    ('refSeq', '<u2'),
+    ('tolerance', '<u2'),
+    ('version', 'u1'),
+    ('flags', 'u1'),
+    ('reserved', '<u2'),
+])
+assert ProfileDeltaHdr.itemsize == 12
+
+PacketCrc = np.dtype([
+    ('crc', '<u4'),
+])
+assert PacketCrc.itemsize == 4
+
+TLV_DETECTED_POINTS = 0x1
+TLV_RANGE_PROFILE = 0x2
+TLV_NOISE_PROFILE = 0x3
+TLV_AZIMUTH_STATIC_HEAT_MAP = 0x4
+TLV_RANGE_DOPPLER_HEAT_MAP = 0x5
+TLV_STATS = 0x6
+TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED = 0x101
+TLV_RANGE_DOPPLER_HEAT_MAP_SPARSE = 0x102
+TLV_AZIMUTH_HEAT_MAP_MAGNITUDE = 0x103
+TLV_DSS_STATS = 0x104
+TLV_MSS_STATS = 0x105
+TLV_OUTPUT_SHED = 0x106
+TLV_QUIET = 0x107
+TLV_RANGE_PROFILE_DELTA = 0x108
+TLV_NOISE_PROFILE_DELTA = 0x109
+TLV_PACKET_CRC = 0x10A
+
+# type: (layout, fixed dtype, element dtype, count field)
+LAYOUT = {
+    TLV_DETECTED_POINTS: ('counted', DetObjDescr, DetObj, 'numDetetedObj'),
+    TLV_RANGE_PROFILE: ('array', None, '<u2', None),
+    TLV_NOISE_PROFILE: ('array', None, '<u2', None),
+    TLV_AZIMUTH_STATIC_HEAT_MAP: ('array', None, Cmplx16ImRe, None),
+    TLV_RANGE_DOPPLER_HEAT_MAP: ('array', None, '<u2', None),
+    TLV_STATS: ('struct', Stats, None, None),
+    TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED: ('prefixed', RdHeatMapCodecHdr, None, None),
+    TLV_RANGE_DOPPLER_HEAT_MAP_SPARSE: ('prefixed', RdHeatMapSparseHdr, None, None),
+    TLV_AZIMUTH_HEAT_MAP_MAGNITUDE: ('prefixed', AzimuthHeatMapHdr, None, None),
+    TLV_DSS_STATS: ('struct', DssStats, None, None),
+    TLV_MSS_STATS: ('struct', MssStats, None, None),
+    TLV_OUTPUT_SHED: ('struct', OutputShed, None, None),
+    TLV_QUIET: ('struct', QuietReport, None, None),
+    TLV_RANGE_PROFILE_DELTA: ('prefixed', ProfileDeltaHdr, None, None),
+    TLV_NOISE_PROFILE_DELTA: ('prefixed', ProfileDeltaHdr, None, None),
+    TLV_PACKET_CRC: ('struct', PacketCrc, None, None),
+}
+
+
+def header(packet):
+    """The MsgHeader of a packet, starting at its magic word"""
+    return np.frombuffer(packet, MsgHeader, 1)[0]
+
+
+def tlvs(packet):
+    """Yields (type, fixed, elems, data) for every TLV of a packet: the
+    fixed struct (None without), the element array (None without) and
+    the payload bytes behind the fixed struct. Raises ValueError for a
+    TLV overrunning the packet or of a length impossible for its type."""
+    buf = memoryview(packet)
+    hdr = header(buf)
+    end = min(len(buf), int(hdr['totalPacketLen']))
+    pos = MsgHeader.itemsize
+    for _ in range(int(hdr['numTLVs'])):
+        if pos + TlvHeader.itemsize > end:
+            raise ValueError('TLV header beyond the packet')
+        tl = np.frombuffer(buf, TlvHeader, 1, pos)[0]
+        tlvType, length = int(tl['type']), int(tl['length'])
+        pos += TlvHeader.itemsize
+        if pos + length > end:
+            raise ValueError('TLV 0x%X beyond the packet' % tlvType)
+        payload = buf[pos:pos + length]
+        pos += length
+        layout, fixedType, elemType, countField = LAYOUT.get(tlvType, (None, None, None, None))
+        fixed = None
+        elems = None
+        data = payload
+        if fixedType is not None:
+            if length < fixedType.itemsize:
+                raise ValueError('TLV 0x%X too short' % tlvType)
+            fixed = np.frombuffer(payload, fixedType, 1)[0]
+            data = payload[fixedType.itemsize:]
+        if elemType is not None:
+            elemType = np.dtype(elemType)
+            n = len(data) // elemType.itemsize
+            if countField is not None:
+                n = int(fixed[countField])
+            if (layout == 'struct' and len(data) != 0) or n * elemType.itemsize != len(data):
+                raise ValueError('TLV 0x%X length %d' % (tlvType, length))
+            elems = np.frombuffer(data, elemType, n)
+        elif layout == 'struct' and len(data) != 0:
+            raise ValueError('TLV 0x%X length %d' % (tlvType, length))
+        yield tlvType, fixed, elems, data
@@ -0,0 +1,149 @@
+function L = mmw_tlv_layout()
+% Generated by board/common/mmw_tlv_gen.py from mmw_tlv_schema.json, do not edit.
+%
+%   L = mmw_tlv_layout returns the layout of the mmw demo output packet:
+%   L.<struct>.LEN and the byte offset of every field as L.<struct>.<field>,
+%   L.TLV.<name> the TLV types, L.FIXED_LEN.<name> and L.ELEM_LEN.<name>
+%   the payload struct and array element sizes (0 without).
+
+L.MAGIC_WORD = [2 1 4 3 6 5 8 7];
+L.SEGMENT_LEN = 32;
+
+L.MsgHeader.LEN = 36;
+L.MsgHeader.magicWord = 0;
+L.MsgHeader.version = 8;
+L.MsgHeader.totalPacketLen = 12;
+L.MsgHeader.platform = 16;
+L.MsgHeader.frameNumber = 20;
+L.MsgHeader.timeCpuCycles = 24;
+L.MsgHeader.numDetectedObj = 28;
+L.MsgHeader.numTLVs = 32;
+L.TlvHeader.LEN = 8;
+L.TlvHeader.type = 0;
+L.TlvHeader.length = 4;
+L.DetObjDescr.LEN = 4;
+L.DetObjDescr.numDetetedObj = 0;
+L.DetObjDescr.xyzQFormat = 2;
+L.DetObj.LEN = 12;
+L.DetObj.rangeIdx = 0;
+L.DetObj.dopplerIdx = 2;
+L.DetObj.peakVal = 4;
+L.DetObj.x = 6;
+L.DetObj.y = 8;
+L.DetObj.z = 10;
+L.Cmplx16ImRe.LEN = 4;
+L.Cmplx16ImRe.imag = 0;
+L.Cmplx16ImRe.real = 2;
+L.Stats.LEN = 24;
+L.Stats.interFrameProcessingTime = 0;
+L.Stats.transmitOutputTime = 4;
+L.Stats.interFrameProcessingMargin = 8;
+L.Stats.interChirpProcessingMargin = 12;
+L.Stats.activeFrameCPULoad = 16;
+L.Stats.interFrameCPULoad = 20;
+L.RdHeatMapCodecHdr.LEN = 8;
+L.RdHeatMapCodecHdr.numRangeBins = 0;
+L.RdHeatMapCodecHdr.numDopplerBins = 2;
+L.RdHeatMapCodecHdr.noiseFloor = 4;
+L.RdHeatMapCodecHdr.version = 6;
+L.RdHeatMapCodecHdr.reserved = 7;
+L.RdHeatMapSparseHdr.LEN = 12;
+L.RdHeatMapSparseHdr.numRangeBins = 0;
+L.RdHeatMapSparseHdr.numDopplerBins = 2;
+L.RdHeatMapSparseHdr.numRuns = 4;
+L.RdHeatMapSparseHdr.margin = 6;
+L.RdHeatMapSparseHdr.version = 8;
+L.RdHeatMapSparseHdr.flags = 9;
+L.RdHeatMapSparseHdr.reserved = 10;
+L.AzimuthHeatMapHdr.LEN = 8;
+L.AzimuthHeatMapHdr.numRangeBins = 0;
+L.AzimuthHeatMapHdr.numAngleBins = 2;
+L.AzimuthHeatMapHdr.format = 4;
+L.AzimuthHeatMapHdr.version = 5;
+L.AzimuthHeatMapHdr.numVirtualAnt = 6;
+L.DssStats.LEN = 32;
+L.DssStats.frameStartIntCounter = 0;
+L.DssStats.frameIntSkipCounter = 4;
+L.DssStats.chirpIntCounter = 8;
+L.DssStats.chirpIntSkipCounter = 12;
+L.DssStats.detObjLoggingSkip = 16;
+L.DssStats.detObjLoggingErr = 20;
+L.DssStats.numFailedTimingReports = 24;
+L.DssStats.numCalibrationReports = 28;
+L.MssStats.LEN = 20;
+L.MssStats.packetsSent = 0;
+L.MssStats.framesSent = 4;
+L.MssStats.transferErrors = 8;
+L.MssStats.numFailedTimingReports = 12;
+L.MssStats.numCalibrationReports = 16;
+L.OutputShed.LEN = 12;
+L.OutputShed.shedMask = 0;
+L.OutputShed.budgetBytes = 4;
+L.OutputShed.packetLen = 8;
+L.QuietReport.LEN = 12;
+L.QuietReport.prevFrameNumber = 0;
+L.QuietReport.quietFrames = 4;
+L.QuietReport.maxRangeDelta = 8;
+L.QuietReport.flags = 10;
+L.ProfileDeltaHdr.LEN = 12;
+L.ProfileDeltaHdr.numRangeBins = 0;
+L.ProfileDeltaHdr.seq = 2;
+L.ProfileDeltaHdr.refSeq = 4;
+L.ProfileDeltaHdr.tolerance = 6;
+L.ProfileDeltaHdr.version = 8;
+L.ProfileDeltaHdr.flags = 9;
+L.ProfileDeltaHdr.reserved = 10;
+L.PacketCrc.LEN = 4;
+L.PacketCrc.crc = 0;
+
+L.TLV.DETECTED_POINTS = 1;
+L.TLV.RANGE_PROFILE = 2;
+L.TLV.NOISE_PROFILE = 3;
+L.TLV.AZIMUTH_STATIC_HEAT_MAP = 4;
+L.TLV.RANGE_DOPPLER_HEAT_MAP = 5;
+L.TLV.STATS = 6;
+L.TLV.RANGE_DOPPLER_HEAT_MAP_COMPRESSED = 257;
+L.TLV.RANGE_DOPPLER_HEAT_MAP_SPARSE = 258;
+L.TLV.AZIMUTH_HEAT_MAP_MAGNITUDE = 259;
+L.TLV.DSS_STATS = 260;
+L.TLV.MSS_STATS = 261;
+L.TLV.OUTPUT_SHED = 262;
+L.TLV.QUIET = 263;
+L.TLV.RANGE_PROFILE_DELTA = 264;
+L.TLV.NOISE_PROFILE_DELTA = 265;
+L.TLV.PACKET_CRC = 266;
+
+L.FIXED_LEN.DETECTED_POINTS = 4;
+L.FIXED_LEN.RANGE_PROFILE = 0;
+L.FIXED_LEN.NOISE_PROFILE = 0;
+L.FIXED_LEN.AZIMUTH_STATIC_HEAT_MAP = 0;
+L.FIXED_LEN.RANGE_DOPPLER_HEAT_MAP = 0;
+L.FIXED_LEN.STATS = 24;
+L.FIXED_LEN.RANGE_DOPPLER_HEAT_MAP_COMPRESSED = 8;
+L.FIXED_LEN.RANGE_DOPPLER_HEAT_MAP_SPARSE = 12;
+L.FIXED_LEN.AZIMUTH_HEAT_MAP_MAGNITUDE = 8;
+L.FIXED_LEN.DSS_STATS = 32;
+L.FIXED_LEN.MSS_STATS = 20;
+L.FIXED_LEN.OUTPUT_SHED = 12;
+L.FIXED_LEN.QUIET = 12;
+L.FIXED_LEN.RANGE_PROFILE_DELTA = 12;
+L.FIXED_LEN.NOISE_PROFILE_DELTA = 12;
+L.FIXED_LEN.PACKET_CRC = 4;
+
+L.ELEM_LEN.DETECTED_POINTS = 12;
+L.ELEM_LEN.RANGE_PROFILE = 2;
+L.ELEM_LEN.NOISE_PROFILE = 2;
+L.ELEM_LEN.AZIMUTH_STATIC_HEAT_MAP = 4;
+L.ELEM_LEN.RANGE_DOPPLER_HEAT_MAP = 2;
+L.ELEM_LEN.STATS = 0;
+L.ELEM_LEN.RANGE_DOPPLER_HEAT_MAP_COMPRESSED = 0;
+L.ELEM_LEN.RANGE_DOPPLER_HEAT_MAP_SPARSE = 0;
+L.ELEM_LEN.AZIMUTH_HEAT_MAP_MAGNITUDE = 0;
+L.ELEM_LEN.DSS_STATS = 0;
+L.ELEM_LEN.MSS_STATS = 0;
+L.ELEM_LEN.OUTPUT_SHED = 0;
+L.ELEM_LEN.QUIET = 0;
+L.ELEM_LEN.RANGE_PROFILE_DELTA = 0;
+L.ELEM_LEN.NOISE_PROFILE_DELTA = 0;
+L.ELEM_LEN.PACKET_CRC = 0;
+return
@@ -8,8 +8,18 @@ from numpy import fliplr
 import time
 from multiprocessing import Queue
 import threading
+import struct
+import os
+import sys
 from MQTTPubSub import MQTTPubSub
 
+# The resampler of the host library (make in ../host), griddata without it
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'host', 'build'))
+try:
+    import mmwave
+except ImportError:
+    mmwave = None
+
 
 mqttQueue = Queue()
 
@@ -56,15 +66,52 @@ numCplxTerms = int(numTerms / 2)
 inPts = (posX.ravel(), posY.ravel())
 outPts = (X, Y)
 readBytes = 0
+resamplers = {}
 
 
+def toImage(Qq):
+    # Range rows x FFT shifted angle bins to the X, Y grid, the same image as
+    # griddata 'nearest' over inPts; the native mapping is worked out once
+    if mmwave is None:
+        qq = np.delete(Qq, 0, axis=1)
+        return griddata(inPts, fliplr(qq).ravel(), outPts, 'nearest')
+    if Qq.shape not in resamplers:
+        resamplers[Qq.shape] = mmwave.PolarResampler(num_range_bins=Qq.shape[0], num_angle_bins=Qq.shape[1],
+                                                     range_resolution=rangeIdxToMeters,
+                                                     width=len(xlin), height=len(ylin),
+                                                     x=(xlin[0], xlin[-1]), y=(ylin[0], ylin[-1]))
+    image = resamplers[Qq.shape].resample(np.ascontiguousarray(Qq, dtype=np.float32))
+    return np.reshape(np.asarray(image), X.shape)
+
+
+
+
+def decodePayload(payload):
+    # Binary payload of build/mqtt_pub, see host/lib/mqtt_payload.h
+    (magic, version, kind, headerLen, numFrames, numRange, numVirtualAnt, numAngle,
+     recordLen, cfgCrc, framePeriodUs, fmt) = struct.unpack_from('<4sBBHHHHHIIIB', payload)
+    frames = []
+    for k in range(numFrames):
+        start = headerLen + k * recordLen + 24  # after the MqttFrameRecord
+        data = payload[start:headerLen + (k + 1) * recordLen]
+        if kind == 1:
+            # int16 pairs, combined the way mqttsend.py used to
+            iq = np.frombuffer(data, dtype=np.int16).astype(np.float32)
+            frames.append(('iq', iq[0::2] + 1j * iq[1::2]))
+        else:
+            values = np.frombuffer(data, dtype=np.uint16 if fmt == 0 else np.uint8)
+            frames.append(('mag', np.reshape(values, (numRange, numAngle))))
+    return frames
 
 
 def onMessage(mqttc, obj, msg):
-
-
-
-    mqttQueue.put(np.fromstring(msg.payload,dtype=np.complex_))
+    if msg.topic.endswith('/cfg'):
+        return
+    if msg.payload[:4] == b'MMWQ':
+        for frame in decodePayload(msg.payload):
+            mqttQueue.put(frame)
+    else:
+        mqttQueue.put(('iq', np.fromstring(msg.payload, dtype=np.complex_)))
 
 
 params = {}
@@ -87,12 +134,18 @@ server_rc = server.run()
 while (True):
 
     while mqttQueue.empty() != True:
-        z = np.reshape(mqttQueue.get(), (numTxAzimAnt * numRxAnt, numRangeBins), order='F')
-        Z = fft(z, 64, axis=0)
-        QQ = fftshift(np.absolute(Z), 0)
-        Qq = np.transpose(QQ)
-        qq = np.delete(Qq, 0, axis=1)
-
-        gd = griddata(inPts, fliplr(qq).ravel(), outPts, 'nearest')
+        kind, values = mqttQueue.get()
+        if kind == 'iq':
+            z = np.reshape(values, (numTxAzimAnt * numRxAnt, numRangeBins), order='F')
+            Z = fft(z, 64, axis=0)
+            QQ = fftshift(np.absolute(Z), 0)
+            Qq = np.transpose(QQ)
+        elif values.shape[1] == 64:
+            # Magnitude map, already angle FFT shifted (mqtt_pub -m mag -A 64)
+            Qq = values.astype(np.float32)
+        else:
+            continue
+
+        gd = toImage(Qq)
         plt.contourf(X, Y, gd, antialiasing=True, extent=extent)
         plt.pause(0.01)
@@ -12,6 +12,15 @@ import sys
 import signal
 import zmq
 from multiprocessing import Process
+import os
+import mmw_tlv
+
+# The resampler of the host library (make in ../host), griddata without it
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'host', 'build'))
+try:
+    import mmwave
+except ImportError:
+    mmwave = None
 
 
 ser = serial.Serial('/dev/ttyACM1', 921600)
@@ -19,11 +28,7 @@ ser = serial.Serial('/dev/ttyACM1', 921600)
 
 serialQueue = Queue()
 
-header = bytearray(b'\x02\x01\x04\x03\x06\x05\x08\x07')
-word = [pow(256, i) for i in range(4)]
-bytevec = []
-bytes_array = []
-q = []
+header = mmw_tlv.MAGIC_WORD
 qq = []
 buff = []
 # plt.ion()
@@ -42,6 +47,38 @@ def pow2roundup(x):
     return y
 
 
+magGrid = {}
+
+
+def magnitudeGrid(numBins):
+    # Grid points of the on-device magnitude heat map (TLV 0x103), angle bins
+    # are FFT shifted with bin k at sin(theta) = 2 * (k - numBins/2) / numBins
+    if numBins not in magGrid:
+        th = np.reshape(np.arcsin(np.arange(1 - numBins / 2, numBins / 2) * 2.0 / numBins), (1, numBins - 1))
+        magGrid[numBins] = (np.matmul(np.reshape(rangeMap, (256, 1)), np.sin(th)).ravel(),
+                            np.matmul(np.reshape(rangeMap, (256, 1)), np.cos(th)).ravel())
+    return magGrid[numBins]
+
+
+resamplers = {}
+
+
+def toImage(Qq):
+    # Range rows x FFT shifted angle bins to the X, Y grid. The native
+    # resampler works the mapping out once per geometry and gives the same
+    # image as griddata 'nearest' over magnitudeGrid()
+    if mmwave is None:
+        qq = np.delete(Qq, 0, axis=1)
+        return griddata(magnitudeGrid(Qq.shape[1]), fliplr(qq).ravel(), outPts, 'nearest')
+    if Qq.shape not in resamplers:
+        resamplers[Qq.shape] = mmwave.PolarResampler(num_range_bins=Qq.shape[0], num_angle_bins=Qq.shape[1],
+                                                     range_resolution=rangeIdxToMeters,
+                                                     width=len(xlin), height=len(ylin),
+                                                     x=(xlin[0], xlin[-1]), y=(ylin[0], ylin[-1]))
+    image = resamplers[Qq.shape].resample(np.ascontiguousarray(Qq, dtype=np.float32))
+    return np.reshape(np.asarray(image), X.shape)
+
+
 numAngleBins = 64  # corresponding to the mmw code
 numTxAzimAnt = 2  # numTxAzimAnt=((txChannelEn >> 0) & 1) + ((txChannelEn >> 1) & 1)
 numRxAnt = 4  # numRxAnt=((rxChannelEn >> 0) & 1) + ((rxChannelEn >> 1) & 1) + ((rxChannelEn >> 2) & 1) + ((rxChannelEn >> 3) & 1)
@@ -57,15 +94,10 @@ xlin = np.linspace(-range_width, range_width, 50)
 ylin = np.linspace(0, range_depth, 50)
 
 X, Y = np.meshgrid(xlin, ylin)
-rangeAzBinLength = numTxAzimAnt * numRxAnt * numRangeBins * 4
-q2 = [0] * int(rangeAzBinLength / 2)
+numCplxTerms = numTxAzimAnt * numRxAnt * numRangeBins
 extent = [xlin[0], xlin[-1], ylin[0], ylin[-1]]
-q3 = np.zeros(int(rangeAzBinLength / 4), dtype=np.complex_)
 frameIndices = {}
 k = 0
-i = 0
-numTerms = int(rangeAzBinLength / 2)
-numCplxTerms = int(numTerms / 2)
 inPts = (posX.ravel(), posY.ravel())
 outPts = (X, Y)
 readBytes = 0
@@ -102,75 +134,33 @@ while (True):
                 for frame in range(0, len(frameIndices) - 1):
 
 
-                    line = bytearray(buff[frameIndices[frame]:frameIndices[frame + 1]])
-                    idx = 28  # After ignoring header, version, totalPacketLength, frameNumber, timeCpuCycles, platform
-
-                    numDetectedObj = np.dot(line[idx:idx + 4], word)
-                    idx = idx + 4
-
-                    numTLVs = np.dot(line[idx:idx + 4], word)
-                    idx = idx + 4
-
-                    for tlvIdx in range(0, numTLVs):
-                        TLVtype = 0
-                        TLVlength = 0
-                        TLVtype = np.dot(line[idx:idx + 4], word)
-                        idx += 4
-                        TLVlength = np.dot(line[idx:idx + 4], word)
-                        idx += 4
-
-                        # To refactor later
-                        if TLVtype == 1:
-                            if TLVlength >= 12:
-                                numObj = line[idx] + line[idx + 1] * 256
-                                idx += 2
-                                exponent = line[idx] + line[idx + 1] * 256
-                                xyzQFormat = pow(2, exponent)
-                                idx += 2
-                                for i in range(0, numObj * 12):
-                                    bytes_array.append(line[idx + i])  # Temporary placeholder
-                                idx += numObj * 12
-                                detObjArray = np.reshape(bytes_array, (12, numObj))
-                                rangeIdx = detObjArray[0, :] + detObjArray[1, :] * 256
-                                bytes_array = []
-                        # End
-
-
-                        if TLVtype == 2:
-                            idx = idx + TLVlength
-                        if TLVtype == 3:
-                            idx = idx + TLVlength
-
-                        if TLVtype == 4:
-
-                            for i in range(0, rangeAzBinLength):
-                                q.append(line[idx + i])
-
-                            idx = idx + rangeAzBinLength
-                            q1 = bytearray(q)
-                            c = 0
-                            for i in range(0, numTerms):
-                                q2[i] = q1[c] + q1[c + 1] * 256
-                                c += 2
-                            for i in range(0, numTerms):
-                                if q2[i] > 32767:
-                                    q2[i] = q2[i] - 65536
-                            c = 0
-                            for i in range(0, numCplxTerms):
-                                q3[i] = q2[c] + 1j * q2[c + 1]
-                                c = c + 2
+                    line = bytes(buff[frameIndices[frame]:frameIndices[frame + 1]])
+                    numDetectedObj = int(mmw_tlv.header(line)['numDetectedObj'])
+
+                    # Offsets and sizes come from mmw_tlv, generated from the
+                    # schema in board/common; a damaged frame is dropped
+                    try:
+                        frameTlvs = list(mmw_tlv.tlvs(line))
+                    except ValueError as e:
+                        print(e)
+                        continue
+
+                    for TLVtype, fixed, elems, data in frameTlvs:
+                        if TLVtype == mmw_tlv.TLV_DETECTED_POINTS:
+                            xyzQFormat = pow(2, int(fixed['xyzQFormat']))
+                            rangeIdx = elems['rangeIdx']
+
+                        if TLVtype == mmw_tlv.TLV_AZIMUTH_STATIC_HEAT_MAP and len(elems) == numCplxTerms:
+                            # The first int16 of each pair is taken as the real part
+                            q3 = elems['imag'] + 1j * elems['real']
 
                             z = np.reshape(q3, (numTxAzimAnt * numRxAnt, numRangeBins), order='F')
                             Z = fft(z, 64, axis=0)
 
-                            q = []
-                            bytevec = []
-
                             QQ = fftshift(np.absolute(Z), 0)
                             Qq = np.transpose(QQ)
-                            qq = np.delete(Qq, 0, axis=1)
 
-                            gd = griddata(inPts, fliplr(qq).ravel(), outPts, 'nearest')
+                            gd = toImage(Qq)
 
                             ## Simple surface plot example
                             ## x, y values are not specified, so assumed to be 0:50
@@ -179,9 +169,19 @@ while (True):
                             plt.contourf(X, Y, gd)
                             plt.pause(0.01)
                             time.sleep(0.1)
-                            idx = 0
 
-                            i = 0
+                        # Magnitude heat map computed on the DSS, guiMonitor rangeAzimuthHeatMap bit 1
+                        if TLVtype == mmw_tlv.TLV_AZIMUTH_HEAT_MAP_MAGNITUDE:
+                            magRangeBins = int(fixed['numRangeBins'])
+                            magAngleBins = int(fixed['numAngleBins'])
+                            if int(fixed['format']) == 1:
+                                # log2 |X| in Q3
+                                mag = np.power(2.0, np.frombuffer(data, dtype=np.uint8) / 8.0)
+                            else:
+                                mag = np.frombuffer(data, dtype='<u2').astype(float)
+                            gd = toImage(np.reshape(mag, (magRangeBins, magAngleBins)))
+                            plt.contourf(X, Y, gd)
+                            plt.pause(0.01)
 
 
 
@@ -5,4 +5,7 @@ ser = cBind.serial()
 
 while True:
 
-    ser.read()
+    frame = ser.read()
+    if frame is None:
+        break
+    print(frame)
@@ -1,9 +1,20 @@
+# Reads the streams written by build/redis_sink in ../host, see
+# host/README.md. Needs redis-py (pip install redis).
+import struct
 import redis
 
-r = redis.StrictRedis(host = "localhost", port=6379,db=0)
-buf = ""
+r = redis.StrictRedis(host="localhost", port=6379, db=0)
+last = {b"radar:objects": "$", b"radar:heatmap": "$"}
 while True:
-
-    buf = r.lpop("radar")
-    print buf
-    a = 1
+    for stream, entries in r.xread(last, block=1000):
+        for entryId, fields in entries:
+            last[stream] = entryId
+            if stream == b"radar:objects":
+                # DetObj: rangeIdx, dopplerIdx, peakVal, x, y, z; x/y/z in Q(q)
+                scale = 1.0 / (1 << int(fields[b"q"]))
+                objs = [struct.unpack_from("<HhHhhh", fields[b"obj"], i) for i in range(0, len(fields[b"obj"]), 12)]
+                print(fields[b"frame"].decode(), [(o[3] * scale, o[4] * scale, o[5] * scale) for o in objs])
+            else:
+                rows, cols = int(fields[b"rows"]), int(fields[b"cols"])
+                values = struct.unpack("<%dH" % (rows * cols), fields[b"data"])
+                print(fields[b"frame"].decode(), "heat map %dx%d, max %d" % (rows, cols, max(values)))
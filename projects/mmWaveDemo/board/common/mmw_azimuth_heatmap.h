@@ -0,0 +1,73 @@
+/**
+ *   @file  mmw_azimuth_heatmap.h
+ *
+ *   @brief
+ *      Range/azimuth magnitude heat map computed on the DSS.
+ *
+ *      Instead of the zero Doppler samples of every virtual antenna
+ *      (MMWDEMO_OUTPUT_MSG_AZIMUT_STATIC_HEAT_MAP) the DSS runs the angle FFT
+ *      itself and sends the magnitude of the spectrum.
+ *
+ *      Payload layout (MMWDEMO_OUTPUT_MSG_AZIMUTH_HEAT_MAP_MAGNITUDE):
+ *
+ *          MmwDemo_azimuthHeatMapHdr
+ *          numRangeBins x numAngleBins values, uint8_t or uint16_t
+ *
+ *      Angle bins are FFT shifted: bin k is at sin(theta) = 2 * (k - numAngleBins/2) / numAngleBins.
+ *
+ *      MMW_AZIMUTH_HEATMAP_FORMAT_U16 values are |X| / numVirtualAntAzim,
+ *      with X the angle spectrum of the 16 bit zero Doppler samples.
+ *      MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG values are 4 * log2(1 + |X|^2),
+ *      i.e. log2 |X| in Q3 or about 0.75 dB per step.
+ */
+#ifndef MMW_AZIMUTH_HEATMAP_H
+#define MMW_AZIMUTH_HEATMAP_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! @brief   Version of the magnitude heat map payload */
+#define MMW_AZIMUTH_HEATMAP_VERSION         1U
+
+/*! @brief   Linear magnitude, 16 bit per bin */
+#define MMW_AZIMUTH_HEATMAP_FORMAT_U16      0U
+
+/*! @brief   Log2 magnitude in Q3, 8 bit per bin */
+#define MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG   1U
+
+/*! @brief   Smallest number of angle bins */
+#define MMW_AZIMUTH_HEATMAP_MIN_BINS        8U
+
+/*! @brief   Angle bins used until configured by azimuthHeatMapCfg */
+#define MMW_AZIMUTH_HEATMAP_DEFAULT_BINS    16U
+
+/**
+ * @brief
+ *  Range/azimuth magnitude heat map header
+ */
+typedef struct MmwDemo_azimuthHeatMapHdr_t
+{
+    /*! @brief   Number of range bins */
+    uint16_t    numRangeBins;
+
+    /*! @brief   Number of angle bins per range bin */
+    uint16_t    numAngleBins;
+
+    /*! @brief   MMW_AZIMUTH_HEATMAP_FORMAT_xxx */
+    uint8_t     format;
+
+    /*! @brief   Payload version, MMW_AZIMUTH_HEATMAP_VERSION */
+    uint8_t     version;
+
+    /*! @brief   Number of virtual antennas the spectrum was computed from */
+    uint16_t    numVirtualAnt;
+} MmwDemo_azimuthHeatMapHdr;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MMW_AZIMUTH_HEATMAP_H */
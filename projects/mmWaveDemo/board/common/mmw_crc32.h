@@ -0,0 +1,26 @@
+/**
+ *   @file  mmw_crc32.h
+ *
+ *   @brief
+ *      CRC-32 (IEEE 802.3, reflected, as zlib) shared by the MSS framing
+ *      code and the host tools.
+ */
+#ifndef MMW_CRC32_H
+#define MMW_CRC32_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! @brief   CRC of an empty buffer, the value to start a computation with */
+#define MMW_CRC32_INIT      0U
+
+extern uint32_t MmwDemo_crc32(uint32_t crc, const uint8_t *data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MMW_CRC32_H */
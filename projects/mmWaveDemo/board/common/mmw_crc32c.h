@@ -0,0 +1,28 @@
+/**
+ *   @file  mmw_crc32c.h
+ *
+ *   @brief
+ *      CRC-32C (Castagnoli, reflected, as iSCSI and SSE4.2) of the output
+ *      packets. The MSS appends it to every packet
+ *      (MMWDEMO_OUTPUT_MSG_PACKET_CRC); the host checks it with the CRC
+ *      instructions of its CPU, this table code is their reference.
+ */
+#ifndef MMW_CRC32C_H
+#define MMW_CRC32C_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! @brief   CRC of an empty buffer, the value to start a computation with */
+#define MMW_CRC32C_INIT     0U
+
+extern uint32_t MmwDemo_crc32c(uint32_t crc, const uint8_t *data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MMW_CRC32C_H */
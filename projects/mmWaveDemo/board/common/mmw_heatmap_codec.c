@@ -0,0 +1,289 @@
+/**
+ *   @file  mmw_heatmap_codec.c
+ *
+ *   @brief
+ *      Range/Doppler heat map encoder, see mmw_heatmap_codec.h for the format.
+ */
+
+/**************************************************************************
+ *************************** Include Files ********************************
+ **************************************************************************/
+#include <stdint.h>
+#include <string.h>
+
+#include "mmw_heatmap_codec.h"
+
+/**************************************************************************
+ *************************** Local Definitions ****************************
+ **************************************************************************/
+
+/*! @brief   Largest line length supported by the encoder */
+#define MMW_HEATMAP_CODEC_MAX_DOPPLER   256U
+
+/**
+ * @brief
+ *  LSB first bit writer
+ */
+typedef struct MmwDemo_bitWriter_t
+{
+    uint8_t     *ptr;
+    uint32_t    acc;
+    uint32_t    numBits;
+} MmwDemo_bitWriter;
+
+/**************************************************************************
+ *************************** Local Functions ******************************
+ **************************************************************************/
+
+static void MmwDemo_bitWrite(MmwDemo_bitWriter *bw, uint32_t value, uint32_t numBits)
+{
+    bw->acc |= value << bw->numBits;
+    bw->numBits += numBits;
+    while (bw->numBits >= 8U)
+    {
+        *bw->ptr++ = (uint8_t) bw->acc;
+        bw->acc >>= 8;
+        bw->numBits -= 8U;
+    }
+}
+
+static void MmwDemo_bitFlush(MmwDemo_bitWriter *bw)
+{
+    if (bw->numBits > 0U)
+    {
+        *bw->ptr++ = (uint8_t) bw->acc;
+    }
+    bw->acc = 0;
+    bw->numBits = 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Number of bits needed to Rice code a line with parameter k.
+ */
+static uint32_t MmwDemo_riceCost(const uint8_t *q, uint32_t n, uint32_t k)
+{
+    uint32_t i, u;
+    uint32_t bits = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        u = (uint32_t) q[i] >> k;
+        bits += (u < MMW_HEATMAP_CODEC_ESC) ? (u + 1U + k) : (MMW_HEATMAP_CODEC_ESC + 8U);
+    }
+    return bits;
+}
+
+/**************************************************************************
+ *************************** Codec Functions ******************************
+ **************************************************************************/
+
+/**
+ *  @b Description
+ *  @n
+ *      Configures the encoder. Needs to be called whenever the frame
+ *      configuration changes.
+ *
+ *  @param[in]  enc
+ *      Encoder state
+ *  @param[in]  outBuf
+ *      Output buffer, at least MMW_HEATMAP_CODEC_MAX_SIZE bytes to never overflow
+ *  @param[in]  outBufSize
+ *      Size of the output buffer
+ *  @param[in]  numDopplerBins
+ *      Number of Doppler bins in each line
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_rdHeatMapEncoderConfig(MmwDemo_rdHeatMapEncoder *enc,
+                                    uint8_t *outBuf,
+                                    uint32_t outBufSize,
+                                    uint16_t numDopplerBins)
+{
+    memset((void *)enc, 0, sizeof(MmwDemo_rdHeatMapEncoder));
+    enc->outBuf = outBuf;
+    enc->outBufSize = outBufSize;
+    enc->numDopplerBins = numDopplerBins;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Starts encoding of a new frame. The noise floor is the mean of the
+ *      noise bins of the previous frame and the minimum shift is chosen so
+ *      the peak of the previous frame fits into 8 bits, which keeps the
+ *      quantization step constant across lines without a target.
+ *
+ *  @param[in]  enc
+ *      Encoder state
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_rdHeatMapEncodeStart(MmwDemo_rdHeatMapEncoder *enc)
+{
+    uint32_t shift = 0;
+
+    if (enc->numLines > 0U)
+    {
+        enc->noiseFloor = (uint16_t) (enc->noiseSum / enc->numLines);
+        if (enc->maxVal > enc->noiseFloor)
+        {
+            while (((enc->maxVal - enc->noiseFloor) >> shift) > 255U)
+            {
+                shift++;
+            }
+        }
+        enc->minShift = (uint8_t) shift;
+    }
+
+    enc->outLen = sizeof(MmwDemo_rdHeatMapCodecHdr);
+    enc->numLines = 0;
+    enc->noiseSum = 0;
+    enc->maxVal = 0;
+    enc->overflow = (enc->outBufSize < sizeof(MmwDemo_rdHeatMapCodecHdr)) ||
+                    (enc->numDopplerBins > MMW_HEATMAP_CODEC_MAX_DOPPLER) ||
+                    (enc->numDopplerBins < 2U);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Encodes one range line of the detection matrix.
+ *
+ *  @param[in]  enc
+ *      Encoder state
+ *  @param[in]  line
+ *      numDopplerBins log2 magnitude values of the range line
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, the output buffer is too small
+ */
+int32_t MmwDemo_rdHeatMapEncodeLine(MmwDemo_rdHeatMapEncoder *enc, const uint16_t *line)
+{
+    uint8_t             q[MMW_HEATMAP_CODEC_MAX_DOPPLER];
+    MmwDemo_bitWriter   bw;
+    uint32_t            n = enc->numDopplerBins;
+    uint32_t            noiseFloor = enc->noiseFloor;
+    uint32_t            maxVal = 0;
+    uint32_t            shift = enc->minShift;
+    uint32_t            sum = 0;
+    uint32_t            k = 0;
+    uint32_t            bits;
+    uint32_t            i, d, u;
+
+    if (enc->overflow)
+    {
+        return -1;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        maxVal = (line[i] > maxVal) ? line[i] : maxVal;
+    }
+    enc->maxVal = (maxVal > enc->maxVal) ? maxVal : enc->maxVal;
+    if (maxVal > noiseFloor)
+    {
+        while (((maxVal - noiseFloor) >> shift) > 255U)
+        {
+            shift++;
+        }
+    }
+
+    /* Quantize against the noise floor, rounding to the nearest step */
+    for (i = 0; i < n; i++)
+    {
+        d = (line[i] > noiseFloor) ? (line[i] - noiseFloor) : 0U;
+        d = (d + ((1U << shift) >> 1)) >> shift;
+        q[i] = (uint8_t) ((d > 255U) ? 255U : d);
+        sum += q[i];
+    }
+
+    /* Rice parameter from the line mean */
+    while ((k < MMW_HEATMAP_CODEC_MAX_K) && ((n << (k + 1U)) <= sum))
+    {
+        k++;
+    }
+    bits = MmwDemo_riceCost(q, n, k);
+    if (bits >= 8U * n)
+    {
+        k = MMW_HEATMAP_CODEC_RAW_LINE;
+        bits = 8U * n;
+    }
+
+    if (enc->outLen + 1U + ((bits + 7U) >> 3) > enc->outBufSize)
+    {
+        enc->overflow = 1;
+        return -1;
+    }
+
+    enc->outBuf[enc->outLen] = (uint8_t) ((shift << 4) | k);
+    if (k == MMW_HEATMAP_CODEC_RAW_LINE)
+    {
+        memcpy(&enc->outBuf[enc->outLen + 1U], q, n);
+    }
+    else
+    {
+        bw.ptr = &enc->outBuf[enc->outLen + 1U];
+        bw.acc = 0;
+        bw.numBits = 0;
+        for (i = 0; i < n; i++)
+        {
+            u = (uint32_t) q[i] >> k;
+            if (u < MMW_HEATMAP_CODEC_ESC)
+            {
+                /* u ones, a terminating zero, then k low bits */
+                MmwDemo_bitWrite(&bw, (1U << u) - 1U, u + 1U);
+                MmwDemo_bitWrite(&bw, q[i] & ((1U << k) - 1U), k);
+            }
+            else
+            {
+                MmwDemo_bitWrite(&bw, (1U << MMW_HEATMAP_CODEC_ESC) - 1U, MMW_HEATMAP_CODEC_ESC);
+                MmwDemo_bitWrite(&bw, q[i], 8U);
+            }
+        }
+        MmwDemo_bitFlush(&bw);
+    }
+    enc->outLen += 1U + ((bits + 7U) >> 3);
+    enc->numLines++;
+
+    /* Noise bin as used by the noise profile output */
+    enc->noiseSum += line[n/2U - 1U];
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Completes the frame by writing the codec header.
+ *
+ *  @param[in]  enc
+ *      Encoder state
+ *
+ *  @retval
+ *      Success -   Payload length in bytes
+ *  @retval
+ *      Error   -   <0, a line did not fit into the output buffer
+ */
+int32_t MmwDemo_rdHeatMapEncodeFinish(MmwDemo_rdHeatMapEncoder *enc)
+{
+    MmwDemo_rdHeatMapCodecHdr hdr;
+
+    if (enc->overflow)
+    {
+        return -1;
+    }
+
+    hdr.numRangeBins = enc->numLines;
+    hdr.numDopplerBins = enc->numDopplerBins;
+    hdr.noiseFloor = enc->noiseFloor;
+    hdr.version = MMW_HEATMAP_CODEC_VERSION;
+    hdr.reserved = 0;
+    memcpy(enc->outBuf, &hdr, sizeof(hdr));
+
+    return (int32_t) enc->outLen;
+}
@@ -0,0 +1,134 @@
+/**
+ *   @file  mmw_heatmap_codec.h
+ *
+ *   @brief
+ *      Compact encoding of the range/Doppler detection matrix.
+ *
+ *      Every cell of detMatrix is quantized to 8 bits relative to a per frame
+ *      noise floor and then Rice coded, one range line at a time, so the DSS
+ *      can encode each line while it is being written out to L3 by EDMA.
+ *
+ *      Payload layout (MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED):
+ *
+ *          MmwDemo_rdHeatMapCodecHdr
+ *          numRangeBins x { uint8_t param; coded line, byte aligned }
+ *
+ *      param[3:0] is the Rice parameter k (0..7) or MMW_HEATMAP_CODEC_RAW_LINE
+ *      when the line is stored as numDopplerBins plain 8 bit values,
+ *      param[7:4] is the quantization shift of the line. A quantized value q
+ *      reconstructs to noiseFloor + (q << shift), so a cell above the floor
+ *      comes back within half a step. The encoding is clamped at the floor:
+ *      a cell below it quantizes to 0 and comes back as noiseFloor, off by
+ *      however far it was below.
+ *
+ *      Bits are packed LSB first. A value q is coded as (q >> k) one bits and
+ *      a zero bit followed by the k low bits of q; when (q >> k) reaches
+ *      MMW_HEATMAP_CODEC_ESC the escape of MMW_HEATMAP_CODEC_ESC one bits is
+ *      followed by q as a plain 8 bit value.
+ *
+ *      The encoder is plain C so the same file builds for the DSS and for the
+ *      host tools.
+ */
+#ifndef MMW_HEATMAP_CODEC_H
+#define MMW_HEATMAP_CODEC_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! @brief   Version of the compressed heat map payload */
+#define MMW_HEATMAP_CODEC_VERSION       1U
+
+/*! @brief   Line parameter marking a line stored without Rice coding */
+#define MMW_HEATMAP_CODEC_RAW_LINE      0xFU
+
+/*! @brief   Largest Rice parameter tried by the encoder */
+#define MMW_HEATMAP_CODEC_MAX_K         7U
+
+/*! @brief   Unary length at which a value is escaped to 8 plain bits */
+#define MMW_HEATMAP_CODEC_ESC           8U
+
+/*! @brief   Worst case payload size in bytes for a given matrix size */
+#define MMW_HEATMAP_CODEC_MAX_SIZE(numRangeBins, numDopplerBins) \
+    (sizeof(MmwDemo_rdHeatMapCodecHdr) + (numRangeBins) * ((numDopplerBins) + 1U))
+
+/**
+ * @brief
+ *  Compressed range/Doppler heat map header
+ */
+typedef struct MmwDemo_rdHeatMapCodecHdr_t
+{
+    /*! @brief   Number of range bins (lines) */
+    uint16_t    numRangeBins;
+
+    /*! @brief   Number of Doppler bins per line */
+    uint16_t    numDopplerBins;
+
+    /*! @brief   Noise floor subtracted before quantization */
+    uint16_t    noiseFloor;
+
+    /*! @brief   Payload version, MMW_HEATMAP_CODEC_VERSION */
+    uint8_t     version;
+
+    /*! @brief   Reserved, set to zero */
+    uint8_t     reserved;
+} MmwDemo_rdHeatMapCodecHdr;
+
+/**
+ * @brief
+ *  Line by line heat map encoder state
+ *
+ * @details
+ *  The noise floor and the minimum quantization shift of a frame are taken
+ *  from the statistics of the previous frame, so lines can be encoded as
+ *  soon as they are produced.
+ */
+typedef struct MmwDemo_rdHeatMapEncoder_t
+{
+    /*! @brief   Output buffer, starts with the codec header */
+    uint8_t     *outBuf;
+
+    /*! @brief   Size of the output buffer in bytes */
+    uint32_t    outBufSize;
+
+    /*! @brief   Number of bytes written so far */
+    uint32_t    outLen;
+
+    /*! @brief   Number of Doppler bins per line */
+    uint16_t    numDopplerBins;
+
+    /*! @brief   Number of lines encoded so far */
+    uint16_t    numLines;
+
+    /*! @brief   Noise floor used for the current frame */
+    uint16_t    noiseFloor;
+
+    /*! @brief   Smallest quantization shift used for the current frame */
+    uint8_t     minShift;
+
+    /*! @brief   Set when the output buffer overflowed */
+    uint8_t     overflow;
+
+    /*! @brief   Sum of the noise bins of the encoded lines */
+    uint32_t    noiseSum;
+
+    /*! @brief   Largest value of the encoded lines */
+    uint32_t    maxVal;
+} MmwDemo_rdHeatMapEncoder;
+
+extern void MmwDemo_rdHeatMapEncoderConfig(MmwDemo_rdHeatMapEncoder *enc,
+                                           uint8_t *outBuf,
+                                           uint32_t outBufSize,
+                                           uint16_t numDopplerBins);
+extern void MmwDemo_rdHeatMapEncodeStart(MmwDemo_rdHeatMapEncoder *enc);
+extern int32_t MmwDemo_rdHeatMapEncodeLine(MmwDemo_rdHeatMapEncoder *enc,
+                                           const uint16_t *line);
+extern int32_t MmwDemo_rdHeatMapEncodeFinish(MmwDemo_rdHeatMapEncoder *enc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MMW_HEATMAP_CODEC_H */
@@ -0,0 +1,239 @@
+/**
+ *   @file  mmw_heatmap_sparse.c
+ *
+ *   @brief
+ *      Sparse range/Doppler heat map encoder, see mmw_heatmap_sparse.h for
+ *      the format.
+ */
+
+/**************************************************************************
+ *************************** Include Files ********************************
+ **************************************************************************/
+#include <stdint.h>
+#include <string.h>
+
+#include "mmw_heatmap_sparse.h"
+
+/**************************************************************************
+ *************************** Local Definitions ****************************
+ **************************************************************************/
+
+/*! @brief   Largest line length supported by the encoder, dopplerStart is 8 bits */
+#define MMW_HEATMAP_SPARSE_MAX_DOPPLER  256U
+
+/*! @brief   Longest run, count is 8 bits */
+#define MMW_HEATMAP_SPARSE_MAX_RUN      255U
+
+/**************************************************************************
+ *************************** Local Functions ******************************
+ **************************************************************************/
+
+/**
+ *  @b Description
+ *  @n
+ *      Appends a run to the output buffer.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, the run does not fit
+ */
+static int32_t MmwDemo_rdHeatMapSparsePutRun(MmwDemo_rdHeatMapSparseEncoder *enc,
+                                             const uint16_t *line,
+                                             uint32_t start,
+                                             uint32_t count)
+{
+    MmwDemo_rdHeatMapSparseRun run;
+    uint32_t len = sizeof(MmwDemo_rdHeatMapSparseRun) + count * sizeof(uint16_t);
+
+    if ((enc->outLen + len > enc->outBufSize) || (enc->numRuns == 0xFFFFU))
+    {
+        enc->flags |= MMW_HEATMAP_SPARSE_FLAG_TRUNCATED;
+        return -1;
+    }
+
+    run.rangeIdx = enc->numLines;
+    run.dopplerStart = (uint8_t) start;
+    run.count = (uint8_t) count;
+    memcpy(&enc->outBuf[enc->outLen], &run, sizeof(run));
+    memcpy(&enc->outBuf[enc->outLen + sizeof(run)], &line[start], count * sizeof(uint16_t));
+    enc->outLen += len;
+    enc->numRuns++;
+    return 0;
+}
+
+/**************************************************************************
+ *************************** Codec Functions ******************************
+ **************************************************************************/
+
+/**
+ *  @b Description
+ *  @n
+ *      Configures the encoder. Needs to be called whenever the frame
+ *      configuration changes.
+ *
+ *  @param[in]  enc
+ *      Encoder state
+ *  @param[in]  outBuf
+ *      Output buffer, 16 bit aligned
+ *  @param[in]  outBufSize
+ *      Size of the output buffer, usually MMW_HEATMAP_SPARSE_MAX_SIZE
+ *  @param[in]  numRangeBins
+ *      Number of lines per frame
+ *  @param[in]  numDopplerBins
+ *      Number of Doppler bins in each line
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_rdHeatMapSparseConfig(MmwDemo_rdHeatMapSparseEncoder *enc,
+                                   uint8_t *outBuf,
+                                   uint32_t outBufSize,
+                                   uint16_t numRangeBins,
+                                   uint16_t numDopplerBins)
+{
+    memset((void *)enc, 0, sizeof(MmwDemo_rdHeatMapSparseEncoder));
+    enc->outBuf = outBuf;
+    enc->outBufSize = outBufSize;
+    enc->numRangeBins = numRangeBins;
+    enc->numDopplerBins = numDopplerBins;
+    enc->invalid = (numDopplerBins == 0U) ||
+                   (numDopplerBins > MMW_HEATMAP_SPARSE_MAX_DOPPLER) ||
+                   (outBufSize < sizeof(MmwDemo_rdHeatMapSparseHdr) + numRangeBins * sizeof(uint16_t));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Starts encoding of a new frame.
+ *
+ *  @param[in]  enc
+ *      Encoder state
+ *  @param[in]  margin
+ *      Margin over the line noise estimate, in detMatrix units
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_rdHeatMapSparseStart(MmwDemo_rdHeatMapSparseEncoder *enc, uint16_t margin)
+{
+    /* Runs start after the header and the noise estimates */
+    enc->outLen = sizeof(MmwDemo_rdHeatMapSparseHdr) + enc->numRangeBins * sizeof(uint16_t);
+    enc->numLines = 0;
+    enc->numRuns = 0;
+    enc->margin = margin;
+    enc->flags = 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Encodes one range line of the detection matrix. The noise estimate
+ *      of the line is its mean, which a few strong cells only move slightly
+ *      for the Doppler sizes used by the demo.
+ *
+ *  @param[in]  enc
+ *      Encoder state
+ *  @param[in]  line
+ *      numDopplerBins log2 magnitude values of the range line
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, all lines were encoded already or runs were dropped
+ */
+int32_t MmwDemo_rdHeatMapSparseEncodeLine(MmwDemo_rdHeatMapSparseEncoder *enc,
+                                          const uint16_t *line)
+{
+    uint32_t    n = enc->numDopplerBins;
+    uint32_t    sum = 0;
+    uint32_t    threshold;
+    uint32_t    start = 0;
+    uint32_t    count = 0;
+    uint32_t    i;
+    uint16_t    noise;
+    int32_t     retVal = 0;
+
+    if (enc->invalid || (enc->numLines >= enc->numRangeBins))
+    {
+        return -1;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        sum += line[i];
+    }
+    noise = (uint16_t) (sum / n);
+    memcpy(&enc->outBuf[sizeof(MmwDemo_rdHeatMapSparseHdr) + enc->numLines * sizeof(uint16_t)],
+           &noise, sizeof(uint16_t));
+    threshold = (uint32_t) noise + enc->margin;
+
+    for (i = 0; i < n; i++)
+    {
+        if (line[i] > threshold)
+        {
+            if (count == 0U)
+            {
+                start = i;
+            }
+            count++;
+            if (count < MMW_HEATMAP_SPARSE_MAX_RUN)
+            {
+                continue;
+            }
+        }
+        if (count > 0U)
+        {
+            if (MmwDemo_rdHeatMapSparsePutRun(enc, line, start, count) < 0)
+            {
+                retVal = -1;
+            }
+            count = 0;
+        }
+    }
+    if (count > 0U)
+    {
+        if (MmwDemo_rdHeatMapSparsePutRun(enc, line, start, count) < 0)
+        {
+            retVal = -1;
+        }
+    }
+
+    enc->numLines++;
+    return retVal;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Completes the frame by writing the header. A truncated frame is still
+ *      valid; the dropped runs read as noise on the host.
+ *
+ *  @param[in]  enc
+ *      Encoder state
+ *
+ *  @retval
+ *      Success -   Payload length in bytes
+ *  @retval
+ *      Error   -   <0, the encoder is not configured for the frame
+ */
+int32_t MmwDemo_rdHeatMapSparseFinish(MmwDemo_rdHeatMapSparseEncoder *enc)
+{
+    MmwDemo_rdHeatMapSparseHdr hdr;
+
+    if (enc->invalid || (enc->numLines != enc->numRangeBins))
+    {
+        return -1;
+    }
+
+    hdr.numRangeBins = enc->numRangeBins;
+    hdr.numDopplerBins = enc->numDopplerBins;
+    hdr.numRuns = enc->numRuns;
+    hdr.margin = enc->margin;
+    hdr.version = MMW_HEATMAP_SPARSE_VERSION;
+    hdr.flags = enc->flags;
+    hdr.reserved = 0;
+    memcpy(enc->outBuf, &hdr, sizeof(hdr));
+
+    return (int32_t) enc->outLen;
+}
@@ -0,0 +1,141 @@
+/**
+ *   @file  mmw_heatmap_sparse.h
+ *
+ *   @brief
+ *      Sparse encoding of the range/Doppler detection matrix.
+ *
+ *      Only cells exceeding the noise estimate of their range line by a
+ *      configurable margin are sent, as runs of consecutive Doppler bins.
+ *
+ *      Payload layout (MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_SPARSE):
+ *
+ *          MmwDemo_rdHeatMapSparseHdr
+ *          uint16_t noise[numRangeBins]
+ *          numRuns x { MmwDemo_rdHeatMapSparseRun; uint16_t value[count] }
+ *
+ *      Runs are ordered by range and Doppler index and never wrap around the
+ *      end of a line. Cells outside any run are reconstructed as the noise
+ *      estimate of their line. Everything is 16 bit aligned.
+ */
+#ifndef MMW_HEATMAP_SPARSE_H
+#define MMW_HEATMAP_SPARSE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! @brief   Version of the sparse heat map payload */
+#define MMW_HEATMAP_SPARSE_VERSION          1U
+
+/*! @brief   Header flag: the output buffer filled up and runs were dropped */
+#define MMW_HEATMAP_SPARSE_FLAG_TRUNCATED   0x1U
+
+/*! @brief   Margin used until configured by rdHeatMapSparseCfg, in
+ *           detMatrix units */
+#define MMW_HEATMAP_SPARSE_DEFAULT_MARGIN   2048U
+
+/*! @brief   Output buffer size at which the sparse map is never larger than
+ *           the dense one; runs beyond it are dropped */
+#define MMW_HEATMAP_SPARSE_MAX_SIZE(numRangeBins, numDopplerBins) \
+    (sizeof(MmwDemo_rdHeatMapSparseHdr) + (numRangeBins) * sizeof(uint16_t) + \
+     (numRangeBins) * (numDopplerBins) * sizeof(uint16_t))
+
+/**
+ * @brief
+ *  Sparse range/Doppler heat map header
+ */
+typedef struct MmwDemo_rdHeatMapSparseHdr_t
+{
+    /*! @brief   Number of range bins (lines) */
+    uint16_t    numRangeBins;
+
+    /*! @brief   Number of Doppler bins per line */
+    uint16_t    numDopplerBins;
+
+    /*! @brief   Number of runs following the noise estimates */
+    uint16_t    numRuns;
+
+    /*! @brief   Margin over the noise estimate a cell has to exceed */
+    uint16_t    margin;
+
+    /*! @brief   Payload version, MMW_HEATMAP_SPARSE_VERSION */
+    uint8_t     version;
+
+    /*! @brief   MMW_HEATMAP_SPARSE_FLAG_xxx */
+    uint8_t     flags;
+
+    /*! @brief   Reserved, set to zero */
+    uint16_t    reserved;
+} MmwDemo_rdHeatMapSparseHdr;
+
+/**
+ * @brief
+ *  Run of above threshold cells of one range line
+ */
+typedef struct MmwDemo_rdHeatMapSparseRun_t
+{
+    /*! @brief   Range index of the run */
+    uint16_t    rangeIdx;
+
+    /*! @brief   Doppler index of the first cell */
+    uint8_t     dopplerStart;
+
+    /*! @brief   Number of cells, 1..255 */
+    uint8_t     count;
+} MmwDemo_rdHeatMapSparseRun;
+
+/**
+ * @brief
+ *  Line by line sparse heat map encoder state
+ */
+typedef struct MmwDemo_rdHeatMapSparseEncoder_t
+{
+    /*! @brief   Output buffer, starts with the header */
+    uint8_t     *outBuf;
+
+    /*! @brief   Size of the output buffer in bytes */
+    uint32_t    outBufSize;
+
+    /*! @brief   Number of bytes written so far */
+    uint32_t    outLen;
+
+    /*! @brief   Number of range bins per frame */
+    uint16_t    numRangeBins;
+
+    /*! @brief   Number of Doppler bins per line */
+    uint16_t    numDopplerBins;
+
+    /*! @brief   Number of lines encoded so far */
+    uint16_t    numLines;
+
+    /*! @brief   Number of runs written so far */
+    uint16_t    numRuns;
+
+    /*! @brief   Margin of the current frame */
+    uint16_t    margin;
+
+    /*! @brief   MMW_HEATMAP_SPARSE_FLAG_xxx of the current frame */
+    uint8_t     flags;
+
+    /*! @brief   Set when the configuration can not be encoded */
+    uint8_t     invalid;
+} MmwDemo_rdHeatMapSparseEncoder;
+
+extern void MmwDemo_rdHeatMapSparseConfig(MmwDemo_rdHeatMapSparseEncoder *enc,
+                                          uint8_t *outBuf,
+                                          uint32_t outBufSize,
+                                          uint16_t numRangeBins,
+                                          uint16_t numDopplerBins);
+extern void MmwDemo_rdHeatMapSparseStart(MmwDemo_rdHeatMapSparseEncoder *enc,
+                                         uint16_t margin);
+extern int32_t MmwDemo_rdHeatMapSparseEncodeLine(MmwDemo_rdHeatMapSparseEncoder *enc,
+                                                 const uint16_t *line);
+extern int32_t MmwDemo_rdHeatMapSparseFinish(MmwDemo_rdHeatMapSparseEncoder *enc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MMW_HEATMAP_SPARSE_H */
@@ -0,0 +1,136 @@
+/**
+ *   @file  mmw_messages_ext.h
+ *
+ *   @brief
+ *      Extensions to the MSS/DSS mailbox messages (ti/demo/xwr16xx/mmw/common/mmw_messages.h).
+ *
+ *      Extended messages reuse MmwDemo_message: the type is one of the values
+ *      below and the body starts with the matching configuration structure,
+ *      copied in with memcpy. Every structure has to fit into the body union
+ *      of the SDK message.
+ */
+#ifndef MMW_MESSAGES_EXT_H
+#define MMW_MESSAGES_EXT_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! @brief   First message type used by the extended messages. Kept well
+ *           clear of the SDK MmwDemo_message_type values. */
+#define MMWDEMO_MSS2DSS_EXT_MSG_BASE                0x100U
+
+/*! @brief   Sparse range/Doppler heat map configuration, MmwDemo_RdHeatMapSparseCfg */
+#define MMWDEMO_MSS2DSS_RD_HEATMAP_SPARSE_CFG       (MMWDEMO_MSS2DSS_EXT_MSG_BASE + 1U)
+
+/*! @brief   Range/azimuth magnitude heat map configuration, MmwDemo_AzimuthHeatMapCfg */
+#define MMWDEMO_MSS2DSS_AZIMUTH_HEATMAP_CFG         (MMWDEMO_MSS2DSS_EXT_MSG_BASE + 2U)
+
+/*! @brief   Output link budget, MmwDemo_OutputBudgetCfg */
+#define MMWDEMO_MSS2DSS_OUTPUT_BUDGET_CFG           (MMWDEMO_MSS2DSS_EXT_MSG_BASE + 3U)
+
+/*! @brief   Quiet mode, MmwDemo_QuietModeCfg */
+#define MMWDEMO_MSS2DSS_QUIET_MODE_CFG              (MMWDEMO_MSS2DSS_EXT_MSG_BASE + 4U)
+
+/*! @brief   Delta coded profiles, MmwDemo_ProfileDeltaCfg */
+#define MMWDEMO_MSS2DSS_PROFILE_DELTA_CFG           (MMWDEMO_MSS2DSS_EXT_MSG_BASE + 5U)
+
+/**
+ * @brief
+ *  Sparse range/Doppler heat map configuration
+ */
+typedef struct MmwDemo_RdHeatMapSparseCfg_t
+{
+    /*! @brief   Margin over the noise estimate of a range line a cell has to
+     *           exceed to be sent, in detMatrix units */
+    uint16_t    margin;
+
+    /*! @brief   Reserved, set to zero */
+    uint16_t    reserved;
+} MmwDemo_RdHeatMapSparseCfg;
+
+/**
+ * @brief
+ *  Range/azimuth magnitude heat map configuration
+ */
+typedef struct MmwDemo_AzimuthHeatMapCfg_t
+{
+    /*! @brief   Number of angle bins, a power of two from 8 up to the
+     *           azimuth FFT size of the data path */
+    uint16_t    numAngleBins;
+
+    /*! @brief   MMW_AZIMUTH_HEATMAP_FORMAT_xxx */
+    uint8_t     format;
+
+    /*! @brief   Reserved, set to zero */
+    uint8_t     reserved;
+} MmwDemo_AzimuthHeatMapCfg;
+
+/**
+ * @brief
+ *  Output link budget
+ */
+typedef struct MmwDemo_OutputBudgetCfg_t
+{
+    /*! @brief   Payload rate of the output link in bytes per second, 0
+     *           turns the output scheduler off */
+    uint32_t    linkBytesPerSec;
+
+    /*! @brief   Share of the frame period a packet may take, 1..100 */
+    uint8_t     budgetPercent;
+
+    /*! @brief   Reserved, set to zero */
+    uint8_t     reserved0;
+    uint16_t    reserved1;
+} MmwDemo_OutputBudgetCfg;
+
+/**
+ * @brief
+ *  Quiet mode configuration
+ */
+typedef struct MmwDemo_QuietModeCfg_t
+{
+    /*! @brief   Range profile change, in detMatrix units, above which a
+     *           frame without objects is still sent */
+    uint16_t    rangeThreshold;
+
+    /*! @brief   Longest run of frames without a packet before a heartbeat
+     *           goes out, 0 for no heartbeats */
+    uint16_t    keepAliveFrames;
+
+    /*! @brief   1 turns the quiet mode on */
+    uint8_t     enabled;
+
+    /*! @brief   Reserved, set to zero */
+    uint8_t     reserved0;
+    uint16_t    reserved1;
+} MmwDemo_QuietModeCfg;
+
+/**
+ * @brief
+ *  Delta coded range and noise profile configuration
+ */
+typedef struct MmwDemo_ProfileDeltaCfg_t
+{
+    /*! @brief   Profiles sent from one keyframe to the next, 1 for
+     *           keyframes only */
+    uint16_t    keyframeInterval;
+
+    /*! @brief   Range profile change, in detMatrix units, sent as unchanged;
+     *           0 for lossless */
+    uint16_t    rangeTolerance;
+
+    /*! @brief   Noise profile change sent as unchanged, as rangeTolerance */
+    uint16_t    noiseTolerance;
+
+    /*! @brief   Reserved, set to zero */
+    uint16_t    reserved;
+} MmwDemo_ProfileDeltaCfg;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MMW_MESSAGES_EXT_H */
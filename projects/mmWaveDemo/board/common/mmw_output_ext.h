@@ -0,0 +1,253 @@
+/**
+ *   @file  mmw_output_ext.h
+ *
+ *   @brief
+ *      Extensions to the mmw demo output format (ti/demo/io_interface/mmw_output.h).
+ *      This header is shared by the MSS, the DSS and the host tools, so it
+ *      only depends on the standard integer types.
+ */
+#ifndef MMW_OUTPUT_EXT_H
+#define MMW_OUTPUT_EXT_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! @brief   First TLV type used by the extended output messages. Kept well
+ *           clear of the SDK MmwDemo_output_message_type values. */
+#define MMWDEMO_OUTPUT_EXT_MSG_BASE                         0x100U
+
+/*! @brief   Range/Doppler heat map, quantized and entropy coded
+ *           (see mmw_heatmap_codec.h) */
+#define MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED (MMWDEMO_OUTPUT_EXT_MSG_BASE + 1U)
+
+/*! @brief   Range/Doppler heat map, above threshold cells only
+ *           (see mmw_heatmap_sparse.h) */
+#define MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_SPARSE    (MMWDEMO_OUTPUT_EXT_MSG_BASE + 2U)
+
+/*! @brief   Range/azimuth heat map as angle spectrum magnitude
+ *           (see mmw_azimuth_heatmap.h) */
+#define MMWDEMO_OUTPUT_MSG_AZIMUTH_HEAT_MAP_MAGNITUDE       (MMWDEMO_OUTPUT_EXT_MSG_BASE + 3U)
+
+/*! @brief   DSS counters, MmwDemo_output_message_dssStats */
+#define MMWDEMO_OUTPUT_MSG_DSS_STATS                        (MMWDEMO_OUTPUT_EXT_MSG_BASE + 4U)
+
+/*! @brief   MSS counters, MmwDemo_output_message_mssStats. The MSS appends
+ *           it to every packet carrying the DSS counters. */
+#define MMWDEMO_OUTPUT_MSG_MSS_STATS                        (MMWDEMO_OUTPUT_EXT_MSG_BASE + 5U)
+
+/*! @brief   TLVs the output scheduler left out of this packet,
+ *           MmwDemo_output_message_outputShed (see mmw_output_sched.h) */
+#define MMWDEMO_OUTPUT_MSG_OUTPUT_SHED                      (MMWDEMO_OUTPUT_EXT_MSG_BASE + 6U)
+
+/*! @brief   Quiet mode report, MmwDemo_output_message_quiet
+ *           (see mmw_quiet_mode.h) */
+#define MMWDEMO_OUTPUT_MSG_QUIET                            (MMWDEMO_OUTPUT_EXT_MSG_BASE + 7U)
+
+/*! @brief   Range profile, delta coded against the previous one
+ *           (see mmw_profile_delta.h) */
+#define MMWDEMO_OUTPUT_MSG_RANGE_PROFILE_DELTA              (MMWDEMO_OUTPUT_EXT_MSG_BASE + 8U)
+
+/*! @brief   Noise profile, delta coded against the previous one
+ *           (see mmw_profile_delta.h) */
+#define MMWDEMO_OUTPUT_MSG_NOISE_PROFILE_DELTA              (MMWDEMO_OUTPUT_EXT_MSG_BASE + 9U)
+
+/*! @brief   CRC-32C of the packet, MmwDemo_output_message_packetCrc
+ *           (see mmw_crc32c.h). The MSS appends it to every packet as the
+ *           last TLV. */
+#define MMWDEMO_OUTPUT_MSG_PACKET_CRC                       (MMWDEMO_OUTPUT_EXT_MSG_BASE + 10U)
+
+/*! @brief   Frames between two packets carrying the device counters */
+#define MMWDEMO_OUTPUT_DEVICE_STATS_PERIOD                  10U
+
+/**
+ * @brief
+ *  Bits of the guiMonitor logMagRange and noiseProfile selections
+ *
+ * @details
+ *  Bit 0 keeps the SDK meaning (the plain profile), bit 1 adds the delta
+ *  coded profile, so 2 sends the delta coded profile only.
+ */
+#define MMWDEMO_GUIMON_PROFILE_OFF                          0U
+#define MMWDEMO_GUIMON_PROFILE_PLAIN                        0x1U
+#define MMWDEMO_GUIMON_PROFILE_DELTA                        0x2U
+
+/**
+ * @brief
+ *  Bits of the guiMonitor rangeDopplerHeatMap selection
+ *
+ * @details
+ *  The SDK treats the selection as a flag, which stays the dense heat map.
+ *  The other bits add alternative encodings of the same heat map, so e.g.
+ *  5 sends the dense and the sparse heat map in the same frame.
+ */
+#define MMWDEMO_GUIMON_RD_HEATMAP_OFF                       0U
+#define MMWDEMO_GUIMON_RD_HEATMAP_DENSE                     0x1U
+#define MMWDEMO_GUIMON_RD_HEATMAP_COMPRESSED                0x2U
+#define MMWDEMO_GUIMON_RD_HEATMAP_SPARSE                    0x4U
+
+/**
+ * @brief
+ *  Bits of the guiMonitor rangeAzimuthHeatMap selection
+ *
+ * @details
+ *  As for rangeDopplerHeatMap, bit 0 keeps the SDK meaning (zero Doppler
+ *  antenna samples) and the other bits select alternative outputs.
+ */
+#define MMWDEMO_GUIMON_RA_HEATMAP_OFF                       0U
+#define MMWDEMO_GUIMON_RA_HEATMAP_SAMPLES                   0x1U
+#define MMWDEMO_GUIMON_RA_HEATMAP_MAGNITUDE                 0x2U
+
+/**
+ * @brief
+ *  Bits of the guiMonitor statsInfo selection
+ *
+ * @details
+ *  Bit 0 keeps the SDK meaning (timing and CPU load every frame), bit 1
+ *  adds the device counters every MMWDEMO_OUTPUT_DEVICE_STATS_PERIOD
+ *  frames.
+ */
+#define MMWDEMO_GUIMON_STATS_OFF                            0U
+#define MMWDEMO_GUIMON_STATS_TIMING                         0x1U
+#define MMWDEMO_GUIMON_STATS_DEVICE                         0x2U
+
+/**
+ * @brief
+ *  DSS counters, copied from MmwDemo_DSS_STATS
+ *
+ * @details
+ *  The counters run freely from the DSS boot and wrap; a receiver takes
+ *  the difference between two reports. frameNumber of the packet header is
+ *  frameStartIntCounter, so a frame missing on the host is either skipped
+ *  here (detObjLoggingSkip, detObjLoggingErr) or lost after the DSS.
+ */
+typedef struct MmwDemo_output_message_dssStats_t
+{
+    /*! @brief   Frame start interrupts handled */
+    uint32_t    frameStartIntCounter;
+
+    /*! @brief   Frame start interrupts ignored while the sensor was stopped */
+    uint32_t    frameIntSkipCounter;
+
+    /*! @brief   Chirp interrupts handled */
+    uint32_t    chirpIntCounter;
+
+    /*! @brief   Chirp interrupts ignored, the sensor was stopped or the inter
+     *           frame processing of the previous frame had not finished */
+    uint32_t    chirpIntSkipCounter;
+
+    /*! @brief   Frames not sent because the MSS had not shipped the previous
+     *           packet yet */
+    uint32_t    detObjLoggingSkip;
+
+    /*! @brief   Frames not sent because the packet did not fit or the
+     *           mailbox write failed */
+    uint32_t    detObjLoggingErr;
+
+    /*! @brief   Failed timing reports from the BSS */
+    uint32_t    numFailedTimingReports;
+
+    /*! @brief   Calibration reports from the BSS */
+    uint32_t    numCalibrationReports;
+} MmwDemo_output_message_dssStats;
+
+/**
+ * @brief
+ *  MSS counters, copied from MmwDemo_MSS_STATS
+ *
+ * @details
+ *  Counted up to the packet before the one carrying them.
+ */
+typedef struct MmwDemo_output_message_mssStats_t
+{
+    /*! @brief   Packets sent completely */
+    uint32_t    packetsSent;
+
+    /*! @brief   Link frames sent (SPI frames) */
+    uint32_t    framesSent;
+
+    /*! @brief   Packets cut short by a transfer error */
+    uint32_t    transferErrors;
+
+    /*! @brief   Failed timing reports from the BSS */
+    uint32_t    numFailedTimingReports;
+
+    /*! @brief   Calibration reports from the BSS */
+    uint32_t    numCalibrationReports;
+} MmwDemo_output_message_mssStats;
+
+/**
+ * @brief
+ *  TLVs shed to keep the packet within the link budget
+ *
+ * @details
+ *  Sent only in packets which left a selected TLV out. A shed bit is set
+ *  for type n (1..15) as bit n and for type 0x100 + n as bit 16 + n.
+ */
+typedef struct MmwDemo_output_message_outputShed_t
+{
+    /*! @brief   Selected TLVs left out of this packet */
+    uint32_t    shedMask;
+
+    /*! @brief   Packet budget in bytes, see outputBudgetCfg */
+    uint32_t    budgetBytes;
+
+    /*! @brief   Length of this packet as planned, padding included */
+    uint32_t    packetLen;
+} MmwDemo_output_message_outputShed;
+
+/*! @brief   Flags of MmwDemo_output_message_quiet */
+#define MMWDEMO_OUTPUT_QUIET_FLAG_HEARTBEAT                 0x1U
+#define MMWDEMO_OUTPUT_QUIET_FLAG_PREV                      0x2U
+
+/**
+ * @brief
+ *  Quiet mode report
+ *
+ * @details
+ *  Carried by every packet while the quiet mode is on. The frames between
+ *  prevFrameNumber and this packet were not sent by the DSS: quietFrames
+ *  of them were suppressed, the others skipped (detObjLoggingSkip,
+ *  detObjLoggingErr). A heartbeat carries no data of its own frame, which
+ *  was quiet as well.
+ */
+typedef struct MmwDemo_output_message_quiet_t
+{
+    /*! @brief   Frame number of the previous packet the DSS sent, valid
+     *           with MMWDEMO_OUTPUT_QUIET_FLAG_PREV */
+    uint32_t    prevFrameNumber;
+
+    /*! @brief   Frames suppressed since prevFrameNumber */
+    uint32_t    quietFrames;
+
+    /*! @brief   Largest change of the range profile from the last full
+     *           frame, in detMatrix units; 0xFFFF without one */
+    uint16_t    maxRangeDelta;
+
+    /*! @brief   MMWDEMO_OUTPUT_QUIET_FLAG_xxx */
+    uint16_t    flags;
+} MmwDemo_output_message_quiet;
+
+/**
+ * @brief
+ *  Packet CRC
+ *
+ * @details
+ *  The CRC covers the packet from the magic word up to the header of this
+ *  TLV, i.e. the header as sent (numTLVs and totalPacketLen included) and
+ *  every TLV before; the padding is not covered. A receiver which found
+ *  the CRC to match can trust totalPacketLen to lead to the next packet.
+ */
+typedef struct MmwDemo_output_message_packetCrc_t
+{
+    /*! @brief   CRC-32C, MmwDemo_crc32c from MMW_CRC32C_INIT */
+    uint32_t    crc;
+} MmwDemo_output_message_packetCrc;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MMW_OUTPUT_EXT_H */
@@ -0,0 +1,214 @@
+/**
+ *   @file  mmw_output_sched.c
+ *
+ *   @brief
+ *      Output scheduler, see mmw_output_sched.h.
+ */
+
+/**************************************************************************
+ *************************** Include Files ********************************
+ **************************************************************************/
+#include <stdint.h>
+#include <string.h>
+
+#include "mmw_output_sched.h"
+
+/**************************************************************************
+ *************************** Local Definitions ****************************
+ **************************************************************************/
+
+/*! @brief   Packets are padded to multiples of this, MMWDEMO_OUTPUT_MSG_SEGMENT_LEN */
+#define MMW_OUTPUT_SCHED_SEGMENT_LEN    32U
+
+/*! @brief   Packet header, MmwDemo_output_message_header */
+#define MMW_OUTPUT_SCHED_HEADER_LEN     36U
+
+/*! @brief   Credit an item waits at most, keeps the counter from wrapping */
+#define MMW_OUTPUT_SCHED_MAX_CREDIT     0xFFFFU
+
+/**************************************************************************
+ *************************** Local Functions ******************************
+ **************************************************************************/
+
+/**
+ *  @b Description
+ *  @n
+ *      Tells whether optional item a is tried before item b: the one waiting
+ *      longer, then the lower priority value, then the lower index.
+ *
+ *  @retval
+ *      1 when a goes first, 0 otherwise
+ */
+static uint32_t MmwDemo_outputSchedBefore(const MmwDemo_outputSched *sched,
+                                          const MmwDemo_outputSchedItem *items,
+                                          uint32_t a,
+                                          uint32_t b)
+{
+    if (sched->credit[a] != sched->credit[b])
+    {
+        return (sched->credit[a] > sched->credit[b]) ? 1U : 0U;
+    }
+    if (items[a].priority != items[b].priority)
+    {
+        return (items[a].priority < items[b].priority) ? 1U : 0U;
+    }
+    return (a < b) ? 1U : 0U;
+}
+
+/**************************************************************************
+ *************************** Scheduler Functions **************************
+ **************************************************************************/
+
+/**
+ *  @b Description
+ *  @n
+ *      Resets the scheduler: no budget, no credits.
+ *
+ *  @param[in]  sched
+ *      Scheduler state
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_outputSchedInit(MmwDemo_outputSched *sched)
+{
+    memset((void *)sched, 0, sizeof(MmwDemo_outputSched));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Bytes the link moves in a share of the frame period.
+ *
+ *  @param[in]  linkBytesPerSec
+ *      Payload rate of the link, 0 for unknown
+ *  @param[in]  framePeriodUs
+ *      Frame period in microseconds
+ *  @param[in]  budgetPercent
+ *      Share of the frame period the packet may take, 1..100
+ *
+ *  @retval
+ *      Budget in bytes, 0 for no limit
+ */
+uint32_t MmwDemo_outputSchedBudget(uint32_t linkBytesPerSec, uint32_t framePeriodUs,
+                                   uint32_t budgetPercent)
+{
+    uint64_t bytes;
+
+    if ((linkBytesPerSec == 0U) || (framePeriodUs == 0U))
+    {
+        return 0U;
+    }
+    if ((budgetPercent == 0U) || (budgetPercent > 100U))
+    {
+        budgetPercent = 100U;
+    }
+    bytes = ((uint64_t) linkBytesPerSec * framePeriodUs * budgetPercent) / 100000000ULL;
+
+    /* A budget below the fixed part would read as no limit */
+    if (bytes <= MMW_OUTPUT_SCHED_FIXED_LEN)
+    {
+        bytes = MMW_OUTPUT_SCHED_FIXED_LEN + 1U;
+    }
+    return (bytes > 0xFFFFFFFFULL) ? 0xFFFFFFFFU : (uint32_t) bytes;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Picks the TLVs of a frame. Mandatory items with data are always
+ *      sent. Optional items are tried in the order of
+ *      MmwDemo_outputSchedBefore and sent when they fit the budget and a
+ *      TLV slot is left; the others are shed and their credit goes up.
+ *      Items without data keep no credit.
+ *
+ *  @param[in]  sched
+ *      Scheduler state
+ *  @param[in]  items
+ *      TLVs of the frame, always listed in the same order
+ *  @param[in]  numItems
+ *      Number of items, at most MMW_OUTPUT_SCHED_MAX_ITEMS
+ *  @param[in]  maxTlvs
+ *      TLV slots of the message
+ *  @param[in]  extraLen
+ *      Bytes added to the packet besides the items and the fixed part,
+ *      e.g. the MSS counters
+ *  @param[out] result
+ *      Selection
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_outputSchedRun(MmwDemo_outputSched *sched, const MmwDemo_outputSchedItem *items,
+                            uint32_t numItems, uint32_t maxTlvs, uint32_t extraLen,
+                            MmwDemo_outputSchedResult *result)
+{
+    uint32_t    used = extraLen;
+    uint32_t    numTlvs = 0;
+    uint32_t    pending = 0;
+    uint32_t    cost;
+    uint32_t    best;
+    uint32_t    i;
+
+    if (numItems > MMW_OUTPUT_SCHED_MAX_ITEMS)
+    {
+        numItems = MMW_OUTPUT_SCHED_MAX_ITEMS;
+    }
+    result->sendMask = 0;
+    result->shedMask = 0;
+
+    for (i = 0; i < numItems; i++)
+    {
+        if (items[i].length == 0U)
+        {
+            sched->credit[i] = 0;
+        }
+        else if (items[i].isMandatory)
+        {
+            result->sendMask |= 1UL << i;
+            used += MMW_OUTPUT_SCHED_TL_LEN + items[i].length;
+            numTlvs++;
+        }
+        else
+        {
+            pending |= 1UL << i;
+        }
+    }
+
+    while (pending != 0U)
+    {
+        best = numItems;
+        for (i = 0; i < numItems; i++)
+        {
+            if (((pending & (1UL << i)) != 0U) &&
+                ((best == numItems) || MmwDemo_outputSchedBefore(sched, items, i, best)))
+            {
+                best = i;
+            }
+        }
+        pending &= ~(1UL << best);
+
+        cost = MMW_OUTPUT_SCHED_TL_LEN + items[best].length;
+        if ((numTlvs < maxTlvs) &&
+            ((sched->budgetBytes == 0U) ||
+             (MMW_OUTPUT_SCHED_FIXED_LEN + used + cost <= sched->budgetBytes)))
+        {
+            result->sendMask |= 1UL << best;
+            used += cost;
+            numTlvs++;
+            sched->credit[best] = 0;
+        }
+        else
+        {
+            result->shedMask |= MMW_OUTPUT_SCHED_TLV_BIT(items[best].type);
+            if (sched->credit[best] < MMW_OUTPUT_SCHED_MAX_CREDIT)
+            {
+                sched->credit[best]++;
+            }
+        }
+    }
+
+    used += MMW_OUTPUT_SCHED_HEADER_LEN;
+    result->packetLen = MMW_OUTPUT_SCHED_SEGMENT_LEN *
+                        ((used + MMW_OUTPUT_SCHED_SEGMENT_LEN - 1U) / MMW_OUTPUT_SCHED_SEGMENT_LEN);
+}
@@ -0,0 +1,114 @@
+/**
+ *   @file  mmw_output_sched.h
+ *
+ *   @brief
+ *      Output scheduler: picks the TLVs of a frame so the packet fits the
+ *      link budget of one frame period.
+ *
+ *      The DSS waits for the MSS to ship a packet before it can send the
+ *      next one, so a packet which takes longer than the frame period makes
+ *      the next frame skipped (detObjLoggingSkip). The budget is therefore
+ *      per packet: link rate x frame period x budget percentage. Mandatory
+ *      TLVs (detected objects, stats) always go; the others are added while
+ *      they fit. Optional TLVs which did not fit earn a credit per frame and
+ *      the ones waiting longest are tried first, so TLVs which cannot go
+ *      together take turns, i.e. each is decimated in time. A TLV larger
+ *      than the budget left after the mandatory ones is never sent.
+ *
+ *      Shared by the DSS and the host tools; no dependencies beyond the
+ *      standard integer types.
+ */
+#ifndef MMW_OUTPUT_SCHED_H
+#define MMW_OUTPUT_SCHED_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! @brief   Most TLVs a frame can be scheduled for */
+#define MMW_OUTPUT_SCHED_MAX_ITEMS          16U
+
+/*! @brief   Bytes of a TLV header, MmwDemo_output_message_tl */
+#define MMW_OUTPUT_SCHED_TL_LEN             8U
+
+/*! @brief   Bytes every packet has besides its TLVs: the header and the
+ *           worst case padding to MMWDEMO_OUTPUT_MSG_SEGMENT_LEN */
+#define MMW_OUTPUT_SCHED_FIXED_LEN          (36U + 31U)
+
+/**
+ *  @b Description
+ *  @n
+ *      Bit of a TLV type in the shed masks: bit n for SDK type n (1..15),
+ *      bit 16 + n for extended type 0x100 + n; 0 for other types.
+ */
+#define MMW_OUTPUT_SCHED_TLV_BIT(type)                                                  \
+    (((type) < 16U) ? (1UL << (type)) :                                                 \
+     (((type) >= 0x100U) && ((type) < 0x110U)) ? (1UL << (16U + (type) - 0x100U)) : 0UL)
+
+/**
+ * @brief
+ *  A TLV the frame could carry
+ */
+typedef struct MmwDemo_outputSchedItem_t
+{
+    /*! @brief   TLV type */
+    uint32_t    type;
+
+    /*! @brief   Payload length, 0 when the TLV is not selected or has no
+     *           data this frame */
+    uint32_t    length;
+
+    /*! @brief   Sent regardless of the budget */
+    uint8_t     isMandatory;
+
+    /*! @brief   Order among optional TLVs of equal credit, lower first */
+    uint8_t     priority;
+
+    /*! @brief   Reserved, set to zero */
+    uint16_t    reserved;
+} MmwDemo_outputSchedItem;
+
+/**
+ * @brief
+ *  Scheduler state, kept across frames
+ */
+typedef struct MmwDemo_outputSched_t
+{
+    /*! @brief   Packet budget in bytes, 0 for no limit */
+    uint32_t    budgetBytes;
+
+    /*! @brief   Frames each item (by index) has waited */
+    uint16_t    credit[MMW_OUTPUT_SCHED_MAX_ITEMS];
+} MmwDemo_outputSched;
+
+/**
+ * @brief
+ *  Outcome of one frame
+ */
+typedef struct MmwDemo_outputSchedResult_t
+{
+    /*! @brief   Items to send, bit i for items[i] */
+    uint32_t    sendMask;
+
+    /*! @brief   TLVs wanted but left out, MMW_OUTPUT_SCHED_TLV_BIT of their
+     *           type */
+    uint32_t    shedMask;
+
+    /*! @brief   Packet length of the selection, padding included */
+    uint32_t    packetLen;
+} MmwDemo_outputSchedResult;
+
+extern void MmwDemo_outputSchedInit(MmwDemo_outputSched *sched);
+extern uint32_t MmwDemo_outputSchedBudget(uint32_t linkBytesPerSec, uint32_t framePeriodUs,
+                                          uint32_t budgetPercent);
+extern void MmwDemo_outputSchedRun(MmwDemo_outputSched *sched, const MmwDemo_outputSchedItem *items,
+                                   uint32_t numItems, uint32_t maxTlvs, uint32_t extraLen,
+                                   MmwDemo_outputSchedResult *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MMW_OUTPUT_SCHED_H */
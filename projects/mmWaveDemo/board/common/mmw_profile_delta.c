@@ -0,0 +1,259 @@
+/**
+ *   @file  mmw_profile_delta.c
+ *
+ *   @brief
+ *      Delta profile encoder, see mmw_profile_delta.h for the format.
+ */
+
+/**************************************************************************
+ *************************** Include Files ********************************
+ **************************************************************************/
+#include <stdint.h>
+#include <string.h>
+
+#include "mmw_profile_delta.h"
+
+/**************************************************************************
+ *************************** Local Functions ******************************
+ **************************************************************************/
+
+/**
+ *  @b Description
+ *  @n
+ *      Appends a token to the output buffer.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, the token does not fit
+ */
+static int32_t MmwDemo_profileDeltaPutToken(MmwDemo_profileDeltaEncoder *enc, uint32_t token)
+{
+    do
+    {
+        if (enc->outLen >= enc->outBufSize)
+        {
+            enc->overflow = 1U;
+            return -1;
+        }
+        enc->outBuf[enc->outLen++] = (uint8_t) ((token & 0x7FU) | ((token > 0x7FU) ? 0x80U : 0U));
+        token >>= 7;
+    } while (token != 0U);
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Writes the pending run of unchanged range bins.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, the token does not fit
+ */
+static int32_t MmwDemo_profileDeltaFlushRun(MmwDemo_profileDeltaEncoder *enc)
+{
+    int32_t retVal = 0;
+
+    if (enc->zeroRun > 0U)
+    {
+        retVal = MmwDemo_profileDeltaPutToken(enc, (((uint32_t) enc->zeroRun - 1U) << 1) | 1U);
+        enc->zeroRun = 0;
+    }
+    return retVal;
+}
+
+/**************************************************************************
+ *************************** Codec Functions ******************************
+ **************************************************************************/
+
+/**
+ *  @b Description
+ *  @n
+ *      Configures the encoder and drops the reference, so the next profile
+ *      is a keyframe. Needs to be called whenever the frame configuration
+ *      changes.
+ *
+ *  @param[in]  enc
+ *      Encoder state
+ *  @param[in]  outBuf
+ *      Output buffer, 16 bit aligned
+ *  @param[in]  outBufSize
+ *      Size of the output buffer, usually MMW_PROFILE_DELTA_MAX_SIZE
+ *  @param[in]  ref
+ *      numRangeBins values, the reference
+ *  @param[in]  cur
+ *      numRangeBins values, the next reference; ref and cur swap on commit
+ *  @param[in]  numRangeBins
+ *      Number of range bins per frame
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_profileDeltaConfig(MmwDemo_profileDeltaEncoder *enc,
+                                uint8_t *outBuf,
+                                uint32_t outBufSize,
+                                uint16_t *ref,
+                                uint16_t *cur,
+                                uint16_t numRangeBins)
+{
+    memset((void *)enc, 0, sizeof(MmwDemo_profileDeltaEncoder));
+    enc->outBuf = outBuf;
+    enc->outBufSize = outBufSize;
+    enc->ref = ref;
+    enc->cur = cur;
+    enc->numRangeBins = numRangeBins;
+    enc->invalid = (numRangeBins == 0U) ||
+                   (outBufSize < sizeof(MmwDemo_profileDeltaHdr) + numRangeBins * sizeof(uint16_t));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Starts encoding of a new frame. The frame is a keyframe when there
+ *      is no reference yet or keyframeInterval profiles went out since the
+ *      last keyframe.
+ *
+ *  @param[in]  enc
+ *      Encoder state
+ *  @param[in]  keyframeInterval
+ *      Profiles sent from one keyframe to the next, 1 for keyframes only
+ *  @param[in]  tolerance
+ *      Largest difference sent as unchanged, 0 for lossless
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_profileDeltaStart(MmwDemo_profileDeltaEncoder *enc, uint16_t keyframeInterval,
+                               uint16_t tolerance)
+{
+    enc->outLen = sizeof(MmwDemo_profileDeltaHdr);
+    enc->numValues = 0;
+    enc->zeroRun = 0;
+    enc->overflow = 0;
+    enc->tolerance = tolerance;
+    enc->isKeyframe = (!enc->hasReference) || (enc->sinceKeyframe >= keyframeInterval);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Encodes the value of the next range bin.
+ *
+ *  @param[in]  enc
+ *      Encoder state
+ *  @param[in]  value
+ *      Profile value of the range bin
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0, all values were encoded already or the output
+ *                  buffer is full
+ */
+int32_t MmwDemo_profileDeltaEncode(MmwDemo_profileDeltaEncoder *enc, uint16_t value)
+{
+    uint32_t    idx = enc->numValues;
+    int32_t     delta;
+    int32_t     retVal = 0;
+
+    if (enc->invalid || (idx >= enc->numRangeBins))
+    {
+        return -1;
+    }
+    enc->numValues++;
+
+    if (enc->isKeyframe)
+    {
+        /* Sized by MmwDemo_profileDeltaConfig */
+        memcpy(&enc->outBuf[enc->outLen], &value, sizeof(uint16_t));
+        enc->outLen += sizeof(uint16_t);
+        enc->cur[idx] = value;
+        return 0;
+    }
+
+    delta = (int32_t) value - (int32_t) enc->ref[idx];
+    if ((delta <= (int32_t) enc->tolerance) && (delta >= -(int32_t) enc->tolerance))
+    {
+        enc->cur[idx] = enc->ref[idx];
+        enc->zeroRun++;
+        return 0;
+    }
+
+    enc->cur[idx] = value;
+    if (MmwDemo_profileDeltaFlushRun(enc) < 0)
+    {
+        retVal = -1;
+    }
+    if (MmwDemo_profileDeltaPutToken(enc, ((delta >= 0) ? ((uint32_t) delta << 1) :
+                                           (((uint32_t) (-delta) << 1) - 1U)) << 1) < 0)
+    {
+        retVal = -1;
+    }
+    return retVal;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Completes the frame by writing the header.
+ *
+ *  @param[in]  enc
+ *      Encoder state
+ *
+ *  @retval
+ *      Success -   Payload length in bytes
+ *  @retval
+ *      Error   -   <0, the encoder is not configured for the frame or the
+ *                  output buffer overflowed
+ */
+int32_t MmwDemo_profileDeltaFinish(MmwDemo_profileDeltaEncoder *enc)
+{
+    MmwDemo_profileDeltaHdr hdr;
+
+    if (enc->invalid || (enc->numValues != enc->numRangeBins))
+    {
+        return -1;
+    }
+    MmwDemo_profileDeltaFlushRun(enc);
+    if (enc->overflow)
+    {
+        return -1;
+    }
+
+    hdr.numRangeBins = enc->numRangeBins;
+    hdr.seq = (uint16_t) (enc->refSeq + 1U);
+    hdr.refSeq = enc->isKeyframe ? hdr.seq : enc->refSeq;
+    hdr.tolerance = enc->isKeyframe ? 0U : enc->tolerance;
+    hdr.version = MMW_PROFILE_DELTA_VERSION;
+    hdr.flags = enc->isKeyframe ? MMW_PROFILE_DELTA_FLAG_KEYFRAME : 0U;
+    hdr.reserved = 0;
+    memcpy(enc->outBuf, &hdr, sizeof(hdr));
+
+    return (int32_t) enc->outLen;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Records that the profile of the frame went out: it becomes the
+ *      reference of the next frame. Only to be called after a successful
+ *      MmwDemo_profileDeltaFinish.
+ *
+ *  @param[in]  enc
+ *      Encoder state
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_profileDeltaCommit(MmwDemo_profileDeltaEncoder *enc)
+{
+    uint16_t *prev = enc->ref;
+
+    enc->ref = enc->cur;
+    enc->cur = prev;
+    enc->refSeq++;
+    enc->hasReference = 1U;
+    enc->sinceKeyframe = enc->isKeyframe ? 1U : (uint16_t) (enc->sinceKeyframe + 1U);
+}
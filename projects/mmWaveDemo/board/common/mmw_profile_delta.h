@@ -0,0 +1,158 @@
+/**
+ *   @file  mmw_profile_delta.h
+ *
+ *   @brief
+ *      Temporal delta encoding of the range and noise profiles.
+ *
+ *      A profile (one uint16_t per range bin) is sent either as a keyframe,
+ *      the plain values, or as the difference to the last profile the host
+ *      received, which in a static scene is mostly zero. The encoder takes
+ *      one value per range line while the detection matrix is built.
+ *
+ *      Payload layout (MMWDEMO_OUTPUT_MSG_RANGE_PROFILE_DELTA,
+ *      MMWDEMO_OUTPUT_MSG_NOISE_PROFILE_DELTA):
+ *
+ *          MmwDemo_profileDeltaHdr
+ *          keyframe: uint16_t value[numRangeBins]
+ *          delta:    tokens up to the end of the payload
+ *
+ *      A token is an unsigned LEB128 varint u (7 bits per byte, low group
+ *      first, bit 7 set on all but the last byte). An odd u stands for
+ *      (u >> 1) + 1 range bins unchanged from the reference, an even u for
+ *      one range bin changed by the zigzag coded difference u >> 1
+ *      (0, -1, 1, -2, ... coded as 0, 1, 2, 3, ...). The tokens cover
+ *      exactly numRangeBins range bins.
+ *
+ *      The reference is the profile with sequence number refSeq. The DSS
+ *      only moves its reference on when a packet carrying the profile went
+ *      to the MSS (MmwDemo_profileDeltaCommit), so a host which missed that
+ *      packet sees refSeq differ from the last sequence number it decoded
+ *      and waits for the next keyframe. A keyframe goes out every
+ *      keyframeInterval profiles sent.
+ *
+ *      With a tolerance, differences up to it are sent as unchanged; the
+ *      reference is what the host reconstructs, so the host never drifts
+ *      more than the tolerance from the DSS. Tolerance 0 is lossless.
+ */
+#ifndef MMW_PROFILE_DELTA_H
+#define MMW_PROFILE_DELTA_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! @brief   Version of the delta profile payload */
+#define MMW_PROFILE_DELTA_VERSION               1U
+
+/*! @brief   Header flag: the payload is a keyframe */
+#define MMW_PROFILE_DELTA_FLAG_KEYFRAME         0x1U
+
+/*! @brief   Keyframe interval until configured by profileDeltaCfg, in
+ *           profiles sent */
+#define MMW_PROFILE_DELTA_DEFAULT_INTERVAL      50U
+
+/*! @brief   Worst case payload size in bytes, a token is at most 3 bytes */
+#define MMW_PROFILE_DELTA_MAX_SIZE(numRangeBins) \
+    (sizeof(MmwDemo_profileDeltaHdr) + (numRangeBins) * 3U)
+
+/**
+ * @brief
+ *  Delta profile header
+ */
+typedef struct MmwDemo_profileDeltaHdr_t
+{
+    /*! @brief   Number of range bins */
+    uint16_t    numRangeBins;
+
+    /*! @brief   Sequence number of this profile, counts profiles sent */
+    uint16_t    seq;
+
+    /*! @brief   Sequence number of the reference, seq for a keyframe */
+    uint16_t    refSeq;
+
+    /*! @brief   Differences up to this were sent as unchanged */
+    uint16_t    tolerance;
+
+    /*! @brief   Payload version, MMW_PROFILE_DELTA_VERSION */
+    uint8_t     version;
+
+    /*! @brief   MMW_PROFILE_DELTA_FLAG_xxx */
+    uint8_t     flags;
+
+    /*! @brief   Reserved, set to zero */
+    uint16_t    reserved;
+} MmwDemo_profileDeltaHdr;
+
+/**
+ * @brief
+ *  Value by value delta profile encoder state
+ */
+typedef struct MmwDemo_profileDeltaEncoder_t
+{
+    /*! @brief   Output buffer, starts with the header */
+    uint8_t     *outBuf;
+
+    /*! @brief   Size of the output buffer in bytes */
+    uint32_t    outBufSize;
+
+    /*! @brief   Number of bytes written so far */
+    uint32_t    outLen;
+
+    /*! @brief   Profile the host holds, numRangeBins values */
+    uint16_t    *ref;
+
+    /*! @brief   Profile the host holds once this frame is sent */
+    uint16_t    *cur;
+
+    /*! @brief   Number of range bins per frame */
+    uint16_t    numRangeBins;
+
+    /*! @brief   Number of values encoded so far */
+    uint16_t    numValues;
+
+    /*! @brief   Unchanged range bins not written yet */
+    uint16_t    zeroRun;
+
+    /*! @brief   Sequence number of ref */
+    uint16_t    refSeq;
+
+    /*! @brief   Profiles sent since the last keyframe, including it */
+    uint16_t    sinceKeyframe;
+
+    /*! @brief   Tolerance of the current frame */
+    uint16_t    tolerance;
+
+    /*! @brief   Set once ref holds a profile the host got */
+    uint8_t     hasReference;
+
+    /*! @brief   The current frame is a keyframe */
+    uint8_t     isKeyframe;
+
+    /*! @brief   Set when the output buffer overflowed this frame */
+    uint8_t     overflow;
+
+    /*! @brief   Set when the configuration can not be encoded */
+    uint8_t     invalid;
+} MmwDemo_profileDeltaEncoder;
+
+extern void MmwDemo_profileDeltaConfig(MmwDemo_profileDeltaEncoder *enc,
+                                       uint8_t *outBuf,
+                                       uint32_t outBufSize,
+                                       uint16_t *ref,
+                                       uint16_t *cur,
+                                       uint16_t numRangeBins);
+extern void MmwDemo_profileDeltaStart(MmwDemo_profileDeltaEncoder *enc,
+                                      uint16_t keyframeInterval,
+                                      uint16_t tolerance);
+extern int32_t MmwDemo_profileDeltaEncode(MmwDemo_profileDeltaEncoder *enc,
+                                          uint16_t value);
+extern int32_t MmwDemo_profileDeltaFinish(MmwDemo_profileDeltaEncoder *enc);
+extern void MmwDemo_profileDeltaCommit(MmwDemo_profileDeltaEncoder *enc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MMW_PROFILE_DELTA_H */
@@ -0,0 +1,207 @@
+/**
+ *   @file  mmw_quiet_mode.c
+ *
+ *   @brief
+ *      Quiet mode, see mmw_quiet_mode.h.
+ */
+
+/**************************************************************************
+ *************************** Include Files ********************************
+ **************************************************************************/
+#include <stdint.h>
+#include <string.h>
+
+#include "mmw_quiet_mode.h"
+
+/**************************************************************************
+ *************************** Local Definitions ****************************
+ **************************************************************************/
+
+/*! @brief   maxDelta without a reference to compare against */
+#define MMW_QUIET_MODE_NO_REFERENCE     0xFFFFU
+
+/**************************************************************************
+ *************************** Quiet Mode Functions *************************
+ **************************************************************************/
+
+/**
+ *  @b Description
+ *  @n
+ *      Resets the quiet mode: no reference, no packet sent yet.
+ *
+ *  @param[in]  quiet
+ *      Quiet mode state
+ *  @param[in]  isEnabled
+ *      Quiet mode on
+ *  @param[in]  threshold
+ *      Range profile change in detMatrix units above which a frame is sent
+ *  @param[in]  keepAliveFrames
+ *      Longest run of frames without a packet, 0 for no heartbeats
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_quietModeInit(MmwDemo_quietMode *quiet, uint8_t isEnabled, uint16_t threshold,
+                           uint16_t keepAliveFrames)
+{
+    memset((void *)quiet, 0, sizeof(MmwDemo_quietMode));
+    quiet->isEnabled = isEnabled;
+    quiet->threshold = threshold;
+    quiet->keepAliveFrames = keepAliveFrames;
+    quiet->maxDelta = MMW_QUIET_MODE_NO_REFERENCE;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Decides how a frame goes out. A frame with objects, or with a range
+ *      profile more than the threshold away from the reference, is sent in
+ *      full; so is the first one. Else a heartbeat is due once
+ *      keepAliveFrames frames passed without a packet, and the frame is
+ *      suppressed otherwise. A frame sent in full or as a heartbeat but
+ *      not shipped (MSS busy) leaves the state as is, so the next frame
+ *      tries again.
+ *
+ *  @param[in]  quiet
+ *      Quiet mode state
+ *  @param[in]  numDetObj
+ *      Detected objects of the frame
+ *  @param[in]  rangeProfile
+ *      Range profile of the frame, element i at rangeProfile[i * stride]
+ *  @param[in]  stride
+ *      Elements between two range bins
+ *  @param[in]  numRangeBins
+ *      Number of range bins
+ *
+ *  @retval
+ *      MMW_QUIET_MODE_SEND_FULL, MMW_QUIET_MODE_SEND_HEARTBEAT or
+ *      MMW_QUIET_MODE_SUPPRESS
+ */
+uint32_t MmwDemo_quietModeDecide(MmwDemo_quietMode *quiet, uint32_t numDetObj,
+                                 const uint16_t *rangeProfile, uint32_t stride,
+                                 uint32_t numRangeBins)
+{
+    uint32_t    maxDelta = 0;
+    uint32_t    numBins;
+    uint32_t    delta;
+    uint32_t    i;
+
+    if (!quiet->isEnabled)
+    {
+        return MMW_QUIET_MODE_SEND_FULL;
+    }
+    quiet->sinceSent++;
+
+    if (quiet->hasReference && (quiet->numReferenceBins == numRangeBins))
+    {
+        numBins = (numRangeBins < MMW_QUIET_MODE_MAX_RANGE_BINS) ? numRangeBins : MMW_QUIET_MODE_MAX_RANGE_BINS;
+        for (i = 0; i < numBins; i++)
+        {
+            delta = (rangeProfile[i * stride] > quiet->reference[i]) ?
+                    (uint32_t) (rangeProfile[i * stride] - quiet->reference[i]) :
+                    (uint32_t) (quiet->reference[i] - rangeProfile[i * stride]);
+            if (delta > maxDelta)
+            {
+                maxDelta = delta;
+            }
+        }
+        quiet->maxDelta = (maxDelta < MMW_QUIET_MODE_NO_REFERENCE) ? (uint16_t) maxDelta :
+                          (uint16_t) (MMW_QUIET_MODE_NO_REFERENCE - 1U);
+    }
+    else
+    {
+        quiet->maxDelta = MMW_QUIET_MODE_NO_REFERENCE;
+    }
+
+    if ((numDetObj > 0U) || (quiet->maxDelta > quiet->threshold))
+    {
+        return MMW_QUIET_MODE_SEND_FULL;
+    }
+    if ((quiet->keepAliveFrames != 0U) && (quiet->sinceSent >= quiet->keepAliveFrames))
+    {
+        return MMW_QUIET_MODE_SEND_HEARTBEAT;
+    }
+    quiet->quietFrames++;
+    return MMW_QUIET_MODE_SUPPRESS;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills the quiet report of a packet about to be sent.
+ *
+ *  @param[in]  quiet
+ *      Quiet mode state, after MmwDemo_quietModeDecide of the frame
+ *  @param[in]  decision
+ *      MMW_QUIET_MODE_SEND_FULL or MMW_QUIET_MODE_SEND_HEARTBEAT
+ *  @param[out] report
+ *      Quiet report TLV
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_quietModeReport(const MmwDemo_quietMode *quiet, uint32_t decision,
+                             MmwDemo_output_message_quiet *report)
+{
+    report->prevFrameNumber = quiet->prevFrameNumber;
+    report->quietFrames = quiet->quietFrames;
+    report->maxRangeDelta = quiet->maxDelta;
+    report->flags = 0;
+    if (decision == MMW_QUIET_MODE_SEND_HEARTBEAT)
+    {
+        report->flags |= MMWDEMO_OUTPUT_QUIET_FLAG_HEARTBEAT;
+    }
+    if (quiet->hasPrev)
+    {
+        report->flags |= MMWDEMO_OUTPUT_QUIET_FLAG_PREV;
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Records a packet handed on to the MSS. A full frame becomes the
+ *      reference of the range profile.
+ *
+ *  @param[in]  quiet
+ *      Quiet mode state
+ *  @param[in]  decision
+ *      MMW_QUIET_MODE_SEND_FULL or MMW_QUIET_MODE_SEND_HEARTBEAT
+ *  @param[in]  frameNumber
+ *      Frame number of the packet
+ *  @param[in]  rangeProfile
+ *      Range profile of the frame, element i at rangeProfile[i * stride]
+ *  @param[in]  stride
+ *      Elements between two range bins
+ *  @param[in]  numRangeBins
+ *      Number of range bins
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_quietModeSent(MmwDemo_quietMode *quiet, uint32_t decision, uint32_t frameNumber,
+                           const uint16_t *rangeProfile, uint32_t stride, uint32_t numRangeBins)
+{
+    uint32_t    numBins;
+    uint32_t    i;
+
+    if (!quiet->isEnabled)
+    {
+        return;
+    }
+    quiet->sinceSent = 0;
+    quiet->quietFrames = 0;
+    quiet->prevFrameNumber = frameNumber;
+    quiet->hasPrev = 1U;
+
+    if (decision == MMW_QUIET_MODE_SEND_FULL)
+    {
+        numBins = (numRangeBins < MMW_QUIET_MODE_MAX_RANGE_BINS) ? numRangeBins : MMW_QUIET_MODE_MAX_RANGE_BINS;
+        for (i = 0; i < numBins; i++)
+        {
+            quiet->reference[i] = rangeProfile[i * stride];
+        }
+        quiet->numReferenceBins = numRangeBins;
+        quiet->hasReference = 1U;
+    }
+}
@@ -0,0 +1,100 @@
+/**
+ *   @file  mmw_quiet_mode.h
+ *
+ *   @brief
+ *      Quiet mode: the DSS ships a frame only when something happens.
+ *
+ *      A frame goes out in full when it has detected objects or when its
+ *      range profile moved by more than a threshold from the one of the
+ *      last full frame. Otherwise it is suppressed, except that a packet
+ *      is sent at least every keepAliveFrames frames: a heartbeat with
+ *      the header and the quiet report only. Every packet of the quiet
+ *      mode carries the report (MMWDEMO_OUTPUT_MSG_QUIET), which names the
+ *      previous packet the DSS sent and counts the frames suppressed since,
+ *      so the host can tell quiet frames from lost ones and fill them in
+ *      with the last full frame.
+ *
+ *      Shared by the DSS and the host tools; no dependencies beyond the
+ *      standard integer types.
+ */
+#ifndef MMW_QUIET_MODE_H
+#define MMW_QUIET_MODE_H
+
+#include <stdint.h>
+
+#include "mmw_output_ext.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! @brief   Range bins of the reference profile; bins beyond are not
+ *           compared */
+#define MMW_QUIET_MODE_MAX_RANGE_BINS       1024U
+
+/*! @brief   Decisions of MmwDemo_quietModeDecide */
+#define MMW_QUIET_MODE_SEND_FULL            0U
+#define MMW_QUIET_MODE_SEND_HEARTBEAT       1U
+#define MMW_QUIET_MODE_SUPPRESS             2U
+
+/**
+ * @brief
+ *  Quiet mode state, kept across frames
+ */
+typedef struct MmwDemo_quietMode_t
+{
+    /*! @brief   Quiet mode on; off, every frame is sent in full */
+    uint8_t     isEnabled;
+
+    /*! @brief   reference holds the range profile of a full frame */
+    uint8_t     hasReference;
+
+    /*! @brief   prevFrameNumber is valid */
+    uint8_t     hasPrev;
+
+    /*! @brief   Reserved, set to zero */
+    uint8_t     reserved;
+
+    /*! @brief   Range profile change, in detMatrix units, above which a
+     *           frame is sent in full */
+    uint16_t    threshold;
+
+    /*! @brief   Longest run of frames without a packet, 0 for no heartbeats */
+    uint16_t    keepAliveFrames;
+
+    /*! @brief   Largest range profile change of the current frame,
+     *           0xFFFF without a reference */
+    uint16_t    maxDelta;
+
+    /*! @brief   Reserved, set to zero */
+    uint16_t    reserved1;
+
+    /*! @brief   Frames since the last packet sent, current one included */
+    uint32_t    sinceSent;
+
+    /*! @brief   Frames suppressed since the last packet sent */
+    uint32_t    quietFrames;
+
+    /*! @brief   Frame number of the last packet sent */
+    uint32_t    prevFrameNumber;
+
+    /*! @brief   Range profile of the last full frame */
+    uint32_t    numReferenceBins;
+    uint16_t    reference[MMW_QUIET_MODE_MAX_RANGE_BINS];
+} MmwDemo_quietMode;
+
+extern void MmwDemo_quietModeInit(MmwDemo_quietMode *quiet, uint8_t isEnabled, uint16_t threshold,
+                                  uint16_t keepAliveFrames);
+extern uint32_t MmwDemo_quietModeDecide(MmwDemo_quietMode *quiet, uint32_t numDetObj,
+                                        const uint16_t *rangeProfile, uint32_t stride,
+                                        uint32_t numRangeBins);
+extern void MmwDemo_quietModeReport(const MmwDemo_quietMode *quiet, uint32_t decision,
+                                    MmwDemo_output_message_quiet *report);
+extern void MmwDemo_quietModeSent(MmwDemo_quietMode *quiet, uint32_t decision, uint32_t frameNumber,
+                                  const uint16_t *rangeProfile, uint32_t stride, uint32_t numRangeBins);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MMW_QUIET_MODE_H */
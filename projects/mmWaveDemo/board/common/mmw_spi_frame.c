@@ -0,0 +1,201 @@
+/**
+ *   @file  mmw_spi_frame.c
+ *
+ *   @brief
+ *      SPI output framing, see mmw_spi_frame.h for the format.
+ */
+
+/**************************************************************************
+ *************************** Include Files ********************************
+ **************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mmw_crc32.h"
+#include "mmw_spi_frame.h"
+
+/**************************************************************************
+ *************************** Local Functions ******************************
+ **************************************************************************/
+
+/**
+ *  @b Description
+ *  @n
+ *      Skips empty segments, so segIdx == numSegs means the packet is done.
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void MmwDemo_spiFramerSkipEmpty(MmwDemo_spiFramer *framer)
+{
+    while ((framer->segIdx < framer->numSegs) &&
+           (framer->segOffset >= framer->segs[framer->segIdx].len))
+    {
+        framer->segIdx++;
+        framer->segOffset = 0;
+    }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      CRC of a frame: the header fields after the sync word, without the
+ *      CRC itself, then the valid payload bytes.
+ *
+ *  @retval
+ *      CRC-32
+ */
+static uint32_t MmwDemo_spiFrameCrc(const MmwDemo_spiFrameHdr *hdr, const uint8_t *payload)
+{
+    uint32_t crc;
+
+    crc = MmwDemo_crc32(MMW_CRC32_INIT, (const uint8_t *) &hdr->seq,
+                        (uint32_t) (offsetof(MmwDemo_spiFrameHdr, crc) - offsetof(MmwDemo_spiFrameHdr, seq)));
+    return MmwDemo_crc32(crc, payload, hdr->length);
+}
+
+/**************************************************************************
+ *************************** Exported Functions ***************************
+ **************************************************************************/
+
+/**
+ *  @b Description
+ *  @n
+ *      Initializes a framer, the sequence numbers start at zero.
+ *
+ *  @param[in]  framer
+ *      Framer
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_spiFramerInit(MmwDemo_spiFramer *framer)
+{
+    memset((void *) framer, 0, sizeof(MmwDemo_spiFramer));
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Starts framing an output packet. The segments are sent back to back,
+ *      they have to stay valid until MmwDemo_spiFramerNext returns 0.
+ *
+ *  @param[in]  framer
+ *      Framer
+ *  @param[in]  segs
+ *      Segments of the packet
+ *  @param[in]  numSegs
+ *      Number of segments
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_spiFramerStart(MmwDemo_spiFramer *framer, const MmwDemo_spiSegment *segs,
+                            uint32_t numSegs)
+{
+    framer->segs = segs;
+    framer->numSegs = numSegs;
+    framer->segIdx = 0;
+    framer->segOffset = 0;
+    framer->isFirst = 1U;
+    MmwDemo_spiFramerSkipEmpty(framer);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Builds the next frame of the packet.
+ *
+ *  @param[in]  framer
+ *      Framer
+ *  @param[out] frame
+ *      MMW_SPI_FRAME_SIZE bytes, 32 bit aligned
+ *
+ *  @retval
+ *      Payload bytes in the frame, 0 once the whole packet was framed
+ *      (frame is left untouched then)
+ */
+uint32_t MmwDemo_spiFramerNext(MmwDemo_spiFramer *framer, uint8_t *frame)
+{
+    MmwDemo_spiFrameHdr hdr;
+    uint8_t  *payload = frame + sizeof(MmwDemo_spiFrameHdr);
+    uint32_t fill = 0;
+    uint32_t chunk;
+    const MmwDemo_spiSegment *seg;
+
+    if (framer->segIdx >= framer->numSegs)
+    {
+        return 0;
+    }
+
+    while ((fill < MMW_SPI_FRAME_PAYLOAD_SIZE) && (framer->segIdx < framer->numSegs))
+    {
+        seg = &framer->segs[framer->segIdx];
+        chunk = seg->len - framer->segOffset;
+        if (chunk > MMW_SPI_FRAME_PAYLOAD_SIZE - fill)
+        {
+            chunk = MMW_SPI_FRAME_PAYLOAD_SIZE - fill;
+        }
+        memcpy((void *) &payload[fill], (const void *) &seg->addr[framer->segOffset], chunk);
+        fill += chunk;
+        framer->segOffset += chunk;
+        MmwDemo_spiFramerSkipEmpty(framer);
+    }
+    if (fill < MMW_SPI_FRAME_PAYLOAD_SIZE)
+    {
+        memset((void *) &payload[fill], 0, MMW_SPI_FRAME_PAYLOAD_SIZE - fill);
+    }
+
+    hdr.sync = MMW_SPI_FRAME_SYNC;
+    hdr.seq = framer->seq++;
+    hdr.length = (uint16_t) fill;
+    hdr.flags = 0;
+    if (framer->isFirst)
+    {
+        hdr.flags |= MMW_SPI_FRAME_FLAG_START;
+        framer->isFirst = 0;
+    }
+    if (framer->segIdx >= framer->numSegs)
+    {
+        hdr.flags |= MMW_SPI_FRAME_FLAG_END;
+    }
+    hdr.crc = MmwDemo_spiFrameCrc(&hdr, payload);
+    memcpy((void *) frame, (void *) &hdr, sizeof(hdr));
+
+    return fill;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Validates a received frame.
+ *
+ *  @param[in]  frame
+ *      MMW_SPI_FRAME_SIZE bytes
+ *  @param[out] hdr
+ *      Frame header, also filled in when the check fails
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   MMW_SPI_FRAME_ESYNC, MMW_SPI_FRAME_ELENGTH or MMW_SPI_FRAME_ECRC
+ */
+int32_t MmwDemo_spiFrameCheck(const uint8_t *frame, MmwDemo_spiFrameHdr *hdr)
+{
+    memcpy((void *) hdr, (const void *) frame, sizeof(MmwDemo_spiFrameHdr));
+
+    if (hdr->sync != MMW_SPI_FRAME_SYNC)
+    {
+        return MMW_SPI_FRAME_ESYNC;
+    }
+    if (hdr->length > MMW_SPI_FRAME_PAYLOAD_SIZE)
+    {
+        return MMW_SPI_FRAME_ELENGTH;
+    }
+    if (MmwDemo_spiFrameCrc(hdr, frame + sizeof(MmwDemo_spiFrameHdr)) != hdr->crc)
+    {
+        return MMW_SPI_FRAME_ECRC;
+    }
+    return 0;
+}
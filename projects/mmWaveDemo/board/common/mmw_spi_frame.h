@@ -0,0 +1,138 @@
+/**
+ *   @file  mmw_spi_frame.h
+ *
+ *   @brief
+ *      Framing of the mmw demo output stream for the MSS SPI slave.
+ *
+ *      The output packet (header, TLVs and padding, byte for byte what the
+ *      UART path sends) is cut into fixed size frames, so every transfer the
+ *      host master clocks has the same length and can be checked on its own:
+ *
+ *          MmwDemo_spiFrameHdr
+ *          payload, length bytes
+ *          zero fill up to MMW_SPI_FRAME_SIZE
+ *
+ *      The first frame of an output packet carries MMW_SPI_FRAME_FLAG_START,
+ *      the last one MMW_SPI_FRAME_FLAG_END. The sequence number counts every
+ *      frame sent since boot, so lost frames show up as gaps.
+ *
+ *      The MSS raises a ready GPIO once a frame is armed in the SPI DMA; the
+ *      master clocks exactly one frame per ready pulse.
+ */
+#ifndef MMW_SPI_FRAME_H
+#define MMW_SPI_FRAME_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! @brief   Frame sync word, "mmWF" on the wire */
+#define MMW_SPI_FRAME_SYNC              0x46576D6DU
+
+/*! @brief   Size of every frame on the wire, header included. A multiple
+ *           of 32 bytes, at 20 MHz one frame takes about 0.8 ms. Packets
+ *           are padded to whole frames, so smaller frames suit outputs
+ *           without heat maps; MSS and host have to be built with the same
+ *           value */
+#ifndef MMW_SPI_FRAME_SIZE
+#define MMW_SPI_FRAME_SIZE              2048U
+#endif
+
+/*! @brief   Payload bytes per frame */
+#define MMW_SPI_FRAME_PAYLOAD_SIZE      (MMW_SPI_FRAME_SIZE - sizeof(MmwDemo_spiFrameHdr))
+
+/*! @brief   Frame flag: first frame of an output packet */
+#define MMW_SPI_FRAME_FLAG_START        0x1U
+
+/*! @brief   Frame flag: last frame of an output packet */
+#define MMW_SPI_FRAME_FLAG_END          0x2U
+
+/*! @brief   Largest number of segments of an output packet */
+#define MMW_SPI_FRAME_MAX_SEGMENTS      24U
+
+/*! @brief   MmwDemo_spiFrameCheck error: no sync word */
+#define MMW_SPI_FRAME_ESYNC             (-1)
+
+/*! @brief   MmwDemo_spiFrameCheck error: length out of range */
+#define MMW_SPI_FRAME_ELENGTH           (-2)
+
+/*! @brief   MmwDemo_spiFrameCheck error: CRC mismatch */
+#define MMW_SPI_FRAME_ECRC              (-3)
+
+/**
+ * @brief
+ *  Frame header
+ */
+typedef struct MmwDemo_spiFrameHdr_t
+{
+    /*! @brief   MMW_SPI_FRAME_SYNC */
+    uint32_t    sync;
+
+    /*! @brief   Frame sequence number */
+    uint32_t    seq;
+
+    /*! @brief   Valid payload bytes */
+    uint16_t    length;
+
+    /*! @brief   MMW_SPI_FRAME_FLAG_xxx */
+    uint16_t    flags;
+
+    /*! @brief   CRC-32 of seq, length, flags and the valid payload bytes */
+    uint32_t    crc;
+} MmwDemo_spiFrameHdr;
+
+/**
+ * @brief
+ *  Contiguous piece of an output packet
+ */
+typedef struct MmwDemo_spiSegment_t
+{
+    /*! @brief   Start of the data */
+    const uint8_t   *addr;
+
+    /*! @brief   Length in bytes */
+    uint32_t        len;
+} MmwDemo_spiSegment;
+
+/**
+ * @brief
+ *  Framer state
+ *
+ * @details
+ *  The segments are only read while frames are built, so the source
+ *  buffers can be released as soon as MmwDemo_spiFramerNext returned 0.
+ */
+typedef struct MmwDemo_spiFramer_t
+{
+    /*! @brief   Segments of the packet being framed */
+    const MmwDemo_spiSegment    *segs;
+
+    /*! @brief   Number of segments */
+    uint32_t                    numSegs;
+
+    /*! @brief   Current segment */
+    uint32_t                    segIdx;
+
+    /*! @brief   Offset into the current segment */
+    uint32_t                    segOffset;
+
+    /*! @brief   Sequence number of the next frame */
+    uint32_t                    seq;
+
+    /*! @brief   No frame of the current packet was built yet */
+    uint32_t                    isFirst;
+} MmwDemo_spiFramer;
+
+extern void     MmwDemo_spiFramerInit(MmwDemo_spiFramer *framer);
+extern void     MmwDemo_spiFramerStart(MmwDemo_spiFramer *framer, const MmwDemo_spiSegment *segs,
+                                       uint32_t numSegs);
+extern uint32_t MmwDemo_spiFramerNext(MmwDemo_spiFramer *framer, uint8_t *frame);
+extern int32_t  MmwDemo_spiFrameCheck(const uint8_t *frame, MmwDemo_spiFrameHdr *hdr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MMW_SPI_FRAME_H */
@@ -0,0 +1,673 @@
+#!/usr/bin/env python3
+#
+#  Generates the output packet layout code from mmw_tlv_schema.json:
+#
+#    board/common/mmw_tlv_layout.h        sizes, offsets and length macros,
+#                                         layout checks of the board structs
+#    board/common/mmw_tlv_pack.h/.c       TLV packing of the DSS and MSS,
+#                                         layout checks of the SDK structs
+#    applications/host/lib/mmw_wire_layout.h
+#                                         TlvLayout<type> decoders of the
+#                                         host, static asserts on mmw_wire.h
+#    applications/visualizations/mmw_tlv.py
+#    applications/visualizations/mmw_tlv_layout.m
+#
+#  Run it after editing the schema (make layout in applications/host);
+#  --check only compares and fails when a generated file is stale.
+#
+import argparse
+import json
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.normpath(os.path.join(HERE, '..', '..'))
+SCHEMA = os.path.join(HERE, 'mmw_tlv_schema.json')
+
+BANNER = 'Generated by board/common/mmw_tlv_gen.py from mmw_tlv_schema.json, do not edit'
+
+# type: (bytes, C type, numpy type)
+PRIMITIVES = {
+    'u8': (1, 'uint8_t', 'u1'),
+    'u16': (2, 'uint16_t', '<u2'),
+    'i16': (2, 'int16_t', '<i2'),
+    'u32': (4, 'uint32_t', '<u4'),
+}
+
+LAYOUTS = ('struct', 'array', 'counted', 'prefixed')
+
+
+def snake(name):
+    """MsgHeader -> MSG_HEADER, totalPacketLen -> TOTAL_PACKET_LEN"""
+    return re.sub(r'(?<=[a-z0-9])(?=[A-Z])', '_', name).upper()
+
+
+def camel(name):
+    """DETECTED_POINTS -> DetectedPoints"""
+    return ''.join(w.capitalize() for w in name.split('_'))
+
+
+class Struct(object):
+    def __init__(self, desc):
+        self.name = desc['name']
+        self.c = desc['c']
+        self.cpp = desc.get('cpp', self.name)
+        self.header = desc.get('header')
+        self.fields = []
+        offset = 0
+        align = 1
+        for f in desc['fields']:
+            name, ftype = f[0], f[1]
+            count = f[2] if len(f) > 2 else 1
+            size = PRIMITIVES[ftype][0]
+            if offset % size != 0:
+                raise ValueError('%s.%s: at offset %d, wire structs carry no padding' % (self.name, name, offset))
+            self.fields.append((name, ftype, count, offset))
+            offset += size * count
+            align = max(align, size)
+        if offset % align != 0:
+            raise ValueError('%s: %d bytes, wire structs carry no tail padding' % (self.name, offset))
+        self.size = offset
+
+    def field(self, name):
+        for f in self.fields:
+            if f[0] == name:
+                return f
+        raise ValueError('%s has no field %s' % (self.name, name))
+
+
+class Tlv(object):
+    def __init__(self, desc, structs):
+        self.name = desc['name']
+        self.type = int(desc['type'], 0)
+        self.c = desc['c']
+        self.source = desc['source']
+        self.layout = desc['layout']
+        if self.layout not in LAYOUTS:
+            raise ValueError('%s: layout %s' % (self.name, self.layout))
+        if self.source not in ('dss', 'mss'):
+            raise ValueError('%s: source %s' % (self.name, self.source))
+        self.fixed = structs[desc['fixed']] if 'fixed' in desc else None
+        self.elem = desc.get('elem')
+        self.count = None
+        if self.elem is not None and self.elem not in PRIMITIVES:
+            self.elem = structs[self.elem]
+        need_fixed = self.layout != 'array'
+        need_elem = self.layout in ('array', 'counted')
+        if (self.fixed is not None) != need_fixed or (self.elem is not None) != need_elem:
+            raise ValueError('%s: fixed/elem do not match layout %s' % (self.name, self.layout))
+        if self.layout == 'counted':
+            self.count = self.fixed.field(desc['count'])
+
+    @property
+    def fixed_len(self):
+        return self.fixed.size if self.fixed is not None else 0
+
+    @property
+    def elem_len(self):
+        if self.elem is None:
+            return 0
+        return PRIMITIVES[self.elem][0] if isinstance(self.elem, str) else self.elem.size
+
+    def elem_c(self):
+        return PRIMITIVES[self.elem][1] if isinstance(self.elem, str) else self.elem.c
+
+    def elem_cpp(self):
+        return PRIMITIVES[self.elem][1] if isinstance(self.elem, str) else self.elem.cpp
+
+    def elem_np(self):
+        return repr(PRIMITIVES[self.elem][2]) if isinstance(self.elem, str) else self.elem.name
+
+
+class Schema(object):
+    def __init__(self, path):
+        with open(path) as f:
+            desc = json.load(f)
+        self.magic = bytes.fromhex(desc['magicWord'])
+        self.segment_len = desc['segmentLen']
+        self.structs = {}
+        self.struct_list = []
+        for s in desc['structs']:
+            st = Struct(s)
+            if st.name in self.structs:
+                raise ValueError('struct %s twice' % st.name)
+            self.structs[st.name] = st
+            self.struct_list.append(st)
+        self.header = self.structs[desc['header']]
+        self.tl = self.structs[desc['tl']]
+        self.tlvs = [Tlv(t, self.structs) for t in desc['tlvs']]
+        seen = set()
+        for t in self.tlvs:
+            if t.type in seen:
+                raise ValueError('TLV type 0x%X twice' % t.type)
+            seen.add(t.type)
+
+    def board_structs(self):
+        return [s for s in self.struct_list if s.header is not None]
+
+    def sdk_structs(self):
+        return [s for s in self.struct_list if s.header is None]
+
+
+def c_len_macros(schema):
+    out = []
+    for s in schema.struct_list:
+        out.append('#define MMWDEMO_WIRE_%-40s %dU' % (snake(s.name) + '_LEN', s.size))
+    out.append('')
+    for s in (schema.header, schema.tl):
+        for name, _, _, offset in s.fields:
+            out.append('#define MMWDEMO_WIRE_%-40s %dU' % (snake(s.name) + '_' + snake(name) + '_OFFSET', offset))
+        out.append('')
+    for t in schema.tlvs:
+        p = 'MMWDEMO_TLV_' + t.name
+        out.append('/*! @brief   %s, %s */' % (t.c, t.layout))
+        if t.layout == 'struct':
+            out.append('#define %-52s %dU' % (p + '_LEN', t.fixed_len))
+        elif t.layout == 'array':
+            out.append('#define %-52s %dU' % (p + '_ELEM_LEN', t.elem_len))
+            out.append('#define %-52s (%dU * (uint32_t) (n))' % (p + '_LEN(n)', t.elem_len))
+        elif t.layout == 'counted':
+            out.append('#define %-52s %dU' % (p + '_FIXED_LEN', t.fixed_len))
+            out.append('#define %-52s %dU' % (p + '_ELEM_LEN', t.elem_len))
+            out.append('#define %-52s %dU' % (p + '_COUNT_OFFSET', t.count[3]))
+            out.append('#define %-52s (%dU + %dU * (uint32_t) (n))' % (p + '_LEN(n)', t.fixed_len, t.elem_len))
+        else:
+            out.append('#define %-52s %dU' % (p + '_MIN_LEN', t.fixed_len))
+        out.append('')
+    return out
+
+
+def c_checks(structs, tlvs):
+    out = []
+    for s in structs:
+        out.append('MMW_TLV_LAYOUT_CHECK(%s_size, sizeof(%s) == %dU);' % (s.name, s.c, s.size))
+        for name, ftype, count, offset in s.fields:
+            out.append('MMW_TLV_LAYOUT_CHECK(%s_%s, (offsetof(%s, %s) == %dU) && (sizeof(((%s *) 0)->%s) == %dU));'
+                       % (s.name, name, s.c, name, offset, s.c, name, PRIMITIVES[ftype][0] * count))
+    for t in tlvs:
+        out.append('MMW_TLV_LAYOUT_CHECK(type_%s, %s == 0x%XU);' % (t.name, t.c, t.type))
+    return out
+
+
+def gen_layout_h(schema):
+    includes = []
+    for s in schema.board_structs():
+        if s.header not in includes:
+            includes.append(s.header)
+    ext = [t for t in schema.tlvs if t.type >= 0x100]
+    out = [
+        '/**',
+        ' *   @file  mmw_tlv_layout.h',
+        ' *',
+        ' *   @brief',
+        ' *      %s.' % BANNER,
+        ' *',
+        ' *      Sizes and offsets of the output packet and the TLV lengths as',
+        ' *      the schema gives them, for the MSS, the DSS and the host tools.',
+        ' *      The structs of board/common and the extended TLV types are',
+        ' *      checked against the schema here, the SDK ones in mmw_tlv_pack.c.',
+        ' */',
+        '#ifndef MMW_TLV_LAYOUT_H',
+        '#define MMW_TLV_LAYOUT_H',
+        '',
+        '#include <stddef.h>',
+        '#include <stdint.h>',
+        '',
+    ]
+    out += ['#include "%s"' % h for h in includes]
+    out += [
+        '',
+        '/*! @brief   Fails the build when cond is false */',
+        '#define MMW_TLV_LAYOUT_CHECK(name, cond) typedef char MmwDemo_tlvLayoutCheck_##name[(cond) ? 1 : -1]',
+        '',
+        '/*! @brief   Output packets are padded to a multiple of this length */',
+        '#define MMWDEMO_WIRE_SEGMENT_LEN %dU' % schema.segment_len,
+        '',
+    ]
+    out += c_len_macros(schema)
+    out += c_checks(schema.board_structs(), ext)
+    out += ['', '#endif /* MMW_TLV_LAYOUT_H */', '']
+    return '\n'.join(out)
+
+
+def pack_params(t):
+    if t.layout == 'struct':
+        return 'const %s *payload' % t.fixed.c, 'MMWDEMO_TLV_%s_LEN' % t.name
+    if t.layout == 'array':
+        return 'const %s *payload, uint32_t numElems' % t.elem_c(), 'MMWDEMO_TLV_%s_LEN(numElems)' % t.name
+    if t.layout == 'counted':
+        return ('const %s *payload, uint32_t %s' % (t.fixed.c, t.count[0]),
+                'MMWDEMO_TLV_%s_LEN(%s)' % (t.name, t.count[0]))
+    return 'const void *payload, uint32_t length', 'length'
+
+
+def pack_doc(t):
+    if t.layout == 'struct':
+        return ['payload', '%s, stays in place until the MSS sent it' % t.fixed.c]
+    if t.layout == 'array':
+        return ['payload', '%s elements' % t.elem_c(), 'numElems', 'Number of elements']
+    if t.layout == 'counted':
+        return ['payload', '%s, followed by the %s elements' % (t.fixed.c, t.elem_c()),
+                t.count[0], 'Number of elements, as in the %s' % t.fixed.c]
+    return ['payload', '%s and the encoded data' % t.fixed.c,
+            'length', 'Bytes from payload on, at least MMWDEMO_TLV_%s_MIN_LEN' % t.name]
+
+
+def gen_pack(schema):
+    dss = [t for t in schema.tlvs if t.source == 'dss']
+    mss = [t for t in schema.tlvs if t.source == 'mss']
+    h = [
+        '/**',
+        ' *   @file  mmw_tlv_pack.h',
+        ' *',
+        ' *   @brief',
+        ' *      %s.' % BANNER,
+        ' *',
+        ' *      TLV packing of the DSS (a mailbox TLV slot, MmwDemo_msgTlv)',
+        ' *      and of the TLVs the MSS appends (a wire TLV header), with the',
+        ' *      lengths of mmw_tlv_layout.h. Every routine returns the bytes the',
+        ' *      TLV adds to totalPacketLen.',
+        ' */',
+        '#ifndef MMW_TLV_PACK_H',
+        '#define MMW_TLV_PACK_H',
+        '',
+        '#include <ti/common/sys_common.h>',
+        '#include <ti/demo/io_interface/mmw_output.h>',
+        '#include <ti/demo/io_interface/detected_obj.h>',
+        '#include <ti/demo/xwr16xx/mmw/common/mmw_messages.h>',
+        '#include "mmw_tlv_layout.h"',
+        '',
+        '#ifdef __cplusplus',
+        'extern "C" {',
+        '#endif',
+        '',
+    ]
+    c = [
+        '/**',
+        ' *   @file  mmw_tlv_pack.c',
+        ' *',
+        ' *   @brief',
+        ' *      %s.' % BANNER,
+        ' *',
+        ' *      TLV packing, see mmw_tlv_pack.h, and the checks of the SDK',
+        ' *      structs and TLV types against the schema.',
+        ' */',
+        '#include "mmw_tlv_pack.h"',
+        '',
+    ]
+    c += c_checks(schema.sdk_structs(), [t for t in schema.tlvs if t.type < 0x100])
+    c.append('')
+    for t in dss:
+        params, length = pack_params(t)
+        fn = 'MmwDemo_tlvPack%s' % camel(t.name)
+        h.append('uint32_t %s(MmwDemo_msgTlv *tlv, %s);' % (fn, params))
+        doc = pack_doc(t)
+        c += [
+            '/**',
+            ' *  @b Description',
+            ' *  @n',
+            ' *      Fills a TLV slot with %s.' % t.c,
+            ' *',
+            ' *  @param[out] tlv',
+            ' *      TLV slot of the message',
+        ]
+        for i in range(0, len(doc), 2):
+            c += [' *  @param[in]  %s' % doc[i], ' *      %s' % doc[i + 1]]
+        c += [
+            ' *',
+            ' *  @retval',
+            ' *      Bytes added to the packet, TLV header included',
+            ' */',
+            'uint32_t %s(MmwDemo_msgTlv *tlv, %s)' % (fn, params),
+            '{',
+            '    tlv->type = %s;' % t.c,
+            '    tlv->length = %s;' % length,
+            '    tlv->address = (uint32_t) payload;',
+            '    return MMWDEMO_WIRE_TLV_HEADER_LEN + tlv->length;',
+            '}',
+            '',
+        ]
+    for t in mss:
+        fn = 'MmwDemo_tlvHeader%s' % camel(t.name)
+        h.append('uint32_t %s(MmwDemo_output_message_tl *tl);' % fn)
+        c += [
+            '/**',
+            ' *  @b Description',
+            ' *  @n',
+            ' *      Fills the wire TLV header of %s.' % t.c,
+            ' *',
+            ' *  @param[out] tl',
+            ' *      TLV header',
+            ' *',
+            ' *  @retval',
+            ' *      Bytes the TLV adds to the packet, header and payload',
+            ' */',
+            'uint32_t %s(MmwDemo_output_message_tl *tl)' % fn,
+            '{',
+            '    tl->type = %s;' % t.c,
+            '    tl->length = MMWDEMO_TLV_%s_LEN;' % t.name,
+            '    return MMWDEMO_WIRE_TLV_HEADER_LEN + tl->length;',
+            '}',
+            '',
+        ]
+    h += ['', '#ifdef __cplusplus', '}', '#endif', '', '#endif /* MMW_TLV_PACK_H */', '']
+    return '\n'.join(h), '\n'.join(c).rstrip('\n') + '\n'
+
+
+def gen_wire_layout(schema):
+    out = [
+        '/**',
+        ' *   @file  mmw_wire_layout.h',
+        ' *',
+        ' *   @brief',
+        ' *      %s.' % BANNER,
+        ' *',
+        ' *      Included at the end of mmw_wire.h: static asserts on the wire',
+        ' *      structs against the schema, and TlvLayout<type>, the decoder of',
+        ' *      each TLV type with its sizes and offsets as constants.',
+        ' */',
+        '#ifndef MMW_WIRE_LAYOUT_H',
+        '#define MMW_WIRE_LAYOUT_H',
+        '',
+        '#include <type_traits>',
+        '',
+        '#include "mmw_azimuth_heatmap.h"',
+        '#include "mmw_heatmap_codec.h"',
+        '#include "mmw_heatmap_sparse.h"',
+        '#include "mmw_profile_delta.h"',
+        '',
+        'namespace mmw',
+        '{',
+        '',
+    ]
+    for s in schema.struct_list:
+        out.append('static_assert(sizeof(%s) == %d, "%s: schema size");' % (s.cpp, s.size, s.cpp))
+        for name, ftype, count, offset in s.fields:
+            ctype = PRIMITIVES[ftype][1] + ('[%d]' % count if count > 1 else '')
+            out.append('static_assert((offsetof(%s, %s) == %d) && std::is_same<decltype(%s::%s), %s>::value, '
+                       '"%s::%s: schema layout");' % (s.cpp, name, offset, s.cpp, name, ctype, s.cpp, name))
+        out.append('')
+    for t in schema.tlvs:
+        out.append('static_assert(TLV_%s == 0x%X, "TLV_%s: schema type");' % (t.name, t.type, t.name))
+    out += [
+        '',
+        '/**',
+        ' * @brief',
+        ' *  Payload layouts of the schema',
+        ' */',
+        'enum TlvLayoutKind : uint8_t',
+        '{',
+        '    TLV_LAYOUT_STRUCT   = 0,    /*!< Exactly Fixed */',
+        '    TLV_LAYOUT_ARRAY    = 1,    /*!< Elements of Elem, no header */',
+        '    TLV_LAYOUT_COUNTED  = 2,    /*!< Fixed, then a counted array of Elem */',
+        '    TLV_LAYOUT_PREFIXED = 3     /*!< Fixed, then bytes its own decoder checks */',
+        '};',
+        '',
+        '/**',
+        ' * @brief',
+        ' *  Decoder of one TLV type: Fixed is the struct at the start of the',
+        ' *  payload (void without), Elem the array element (void without).',
+        ' *  valid() is the length check of parseFrame, elems() the number of',
+        ' *  elements at elemOffset.',
+        ' */',
+        'template <uint32_t Type>',
+        'struct TlvLayout;',
+        '',
+    ]
+    kinds = {'struct': 'TLV_LAYOUT_STRUCT', 'array': 'TLV_LAYOUT_ARRAY',
+             'counted': 'TLV_LAYOUT_COUNTED', 'prefixed': 'TLV_LAYOUT_PREFIXED'}
+    for t in schema.tlvs:
+        fixed = t.fixed.cpp if t.fixed is not None else 'void'
+        elem = t.elem_cpp() if t.elem is not None else 'void'
+        out += [
+            '/*! @brief   %s */' % t.c,
+            'template <>',
+            'struct TlvLayout<TLV_%s>' % t.name,
+            '{',
+            '    using Fixed = %s;' % fixed,
+            '    using Elem = %s;' % elem,
+            '    static constexpr TlvLayoutKind kind = %s;' % kinds[t.layout],
+            '    static constexpr uint32_t fixedLen = %d;' % t.fixed_len,
+            '    static constexpr uint32_t elemLen = %d;' % t.elem_len,
+            '    static constexpr uint32_t elemOffset = %d;' % t.fixed_len,
+        ]
+        if t.layout == 'counted':
+            out.append('    static constexpr uint32_t countOffset = %d;' % t.count[3])
+        out.append('')
+        if t.layout == 'struct':
+            out += [
+                '    static bool valid(const uint8_t *, uint32_t length)    { return length == fixedLen; }',
+                '    static uint32_t elems(const uint8_t *, uint32_t)       { return 0; }',
+            ]
+        elif t.layout == 'array':
+            out += [
+                '    static bool valid(const uint8_t *, uint32_t length)    { return (length % elemLen) == 0U; }',
+                '    static uint32_t elems(const uint8_t *, uint32_t length) { return length / elemLen; }',
+            ]
+        elif t.layout == 'counted':
+            ctype = PRIMITIVES[t.count[1]][1]
+            out += [
+                '    static uint32_t elems(const uint8_t *v, uint32_t)      { return load<%s>(v + countOffset); }' % ctype,
+                '    static bool valid(const uint8_t *v, uint32_t length)',
+                '    {',
+                '        return (length >= fixedLen) && (length == fixedLen + elems(v, length) * elemLen);',
+                '    }',
+            ]
+        else:
+            out += [
+                '    static bool valid(const uint8_t *, uint32_t length)    { return length >= fixedLen; }',
+                '    static uint32_t elems(const uint8_t *, uint32_t)       { return 0; }',
+            ]
+        out += ['};', '']
+    out += [
+        '/*! @brief   Fixed struct at the start of a payload */',
+        'template <uint32_t Type>',
+        'inline typename TlvLayout<Type>::Fixed tlvFixed(const uint8_t *v)',
+        '{',
+        '    return load<typename TlvLayout<Type>::Fixed>(v);',
+        '}',
+        '',
+        '/**',
+        ' *  @b Description',
+        ' *  @n',
+        ' *      Length check of a TLV against its layout; types the schema does',
+        ' *      not know pass.',
+        ' *',
+        ' *  @param[in]  type',
+        ' *      TLV type',
+        ' *  @param[in]  v',
+        ' *      Payload',
+        ' *  @param[in]  length',
+        ' *      Payload bytes',
+        ' *',
+        ' *  @retval',
+        ' *      false when the length is impossible for the type',
+        ' */',
+        'inline bool tlvValid(uint32_t type, const uint8_t *v, uint32_t length)',
+        '{',
+        '    switch (type)',
+        '    {',
+    ]
+    for t in schema.tlvs:
+        out.append('    case TLV_%s: return TlvLayout<TLV_%s>::valid(v, length);' % (t.name, t.name))
+    out += [
+        '    default: return true;',
+        '    }',
+        '}',
+        '',
+        '} /* namespace mmw */',
+        '',
+        '#endif /* MMW_WIRE_LAYOUT_H */',
+        '',
+    ]
+    return '\n'.join(out)
+
+
+def gen_python(schema):
+    out = [
+        '# %s.' % BANNER,
+        '"""Layout of the mmw demo output packet.',
+        '',
+        'numpy dtypes of the wire structs, the TLV types and tlvs(), which walks',
+        'a packet and decodes every TLV by the schema:',
+        '',
+        '    hdr = mmw_tlv.header(packet)',
+        '    for tlvType, fixed, elems, data in mmw_tlv.tlvs(packet):',
+        '        ...',
+        '"""',
+        'import numpy as np',
+        '',
+        'MAGIC_WORD = %r' % schema.magic,
+        'SEGMENT_LEN = %d' % schema.segment_len,
+        '',
+    ]
+    for s in schema.struct_list:
+        out.append('%s = np.dtype([' % s.name)
+        for name, ftype, count, _ in s.fields:
+            if count > 1:
+                out.append('    (%r, %r, (%d,)),' % (name, PRIMITIVES[ftype][2], count))
+            else:
+                out.append('    (%r, %r),' % (name, PRIMITIVES[ftype][2]))
+        out.append('])')
+        out.append('assert %s.itemsize == %d' % (s.name, s.size))
+        out.append('')
+    for t in schema.tlvs:
+        out.append('TLV_%s = 0x%X' % (t.name, t.type))
+    out += [
+        '',
+        '# type: (layout, fixed dtype, element dtype, count field)',
+        'LAYOUT = {',
+    ]
+    for t in schema.tlvs:
+        out.append('    TLV_%s: (%r, %s, %s, %r),' % (
+            t.name, t.layout, t.fixed.name if t.fixed else 'None',
+            t.elem_np() if t.elem is not None else 'None', t.count[0] if t.count else None))
+    out += [
+        '}',
+        '',
+        '',
+        'def header(packet):',
+        '    """The %s of a packet, starting at its magic word"""' % schema.header.name,
+        '    return np.frombuffer(packet, %s, 1)[0]' % schema.header.name,
+        '',
+        '',
+        'def tlvs(packet):',
+        '    """Yields (type, fixed, elems, data) for every TLV of a packet: the',
+        '    fixed struct (None without), the element array (None without) and',
+        '    the payload bytes behind the fixed struct. Raises ValueError for a',
+        '    TLV overrunning the packet or of a length impossible for its type."""',
+        '    buf = memoryview(packet)',
+        '    hdr = header(buf)',
+        '    end = min(len(buf), int(hdr[%r]))' % 'totalPacketLen',
+        '    pos = %s.itemsize' % schema.header.name,
+        '    for _ in range(int(hdr[%r])):' % 'numTLVs',
+        '        if pos + %s.itemsize > end:' % schema.tl.name,
+        '            raise ValueError(\'TLV header beyond the packet\')',
+        '        tl = np.frombuffer(buf, %s, 1, pos)[0]' % schema.tl.name,
+        '        tlvType, length = int(tl[\'type\']), int(tl[\'length\'])',
+        '        pos += %s.itemsize' % schema.tl.name,
+        '        if pos + length > end:',
+        '            raise ValueError(\'TLV 0x%X beyond the packet\' % tlvType)',
+        '        payload = buf[pos:pos + length]',
+        '        pos += length',
+        '        layout, fixedType, elemType, countField = LAYOUT.get(tlvType, (None, None, None, None))',
+        '        fixed = None',
+        '        elems = None',
+        '        data = payload',
+        '        if fixedType is not None:',
+        '            if length < fixedType.itemsize:',
+        '                raise ValueError(\'TLV 0x%X too short\' % tlvType)',
+        '            fixed = np.frombuffer(payload, fixedType, 1)[0]',
+        '            data = payload[fixedType.itemsize:]',
+        '        if elemType is not None:',
+        '            elemType = np.dtype(elemType)',
+        '            n = len(data) // elemType.itemsize',
+        '            if countField is not None:',
+        '                n = int(fixed[countField])',
+        '            if (layout == \'struct\' and len(data) != 0) or n * elemType.itemsize != len(data):',
+        '                raise ValueError(\'TLV 0x%X length %d\' % (tlvType, length))',
+        '            elems = np.frombuffer(data, elemType, n)',
+        '        elif layout == \'struct\' and len(data) != 0:',
+        '            raise ValueError(\'TLV 0x%X length %d\' % (tlvType, length))',
+        '        yield tlvType, fixed, elems, data',
+        '',
+    ]
+    return '\n'.join(out)
+
+
+def gen_matlab(schema):
+    out = [
+        'function L = mmw_tlv_layout()',
+        '%% %s.' % BANNER,
+        '%',
+        '%   L = mmw_tlv_layout returns the layout of the mmw demo output packet:',
+        '%   L.<struct>.LEN and the byte offset of every field as L.<struct>.<field>,',
+        '%   L.TLV.<name> the TLV types, L.FIXED_LEN.<name> and L.ELEM_LEN.<name>',
+        '%   the payload struct and array element sizes (0 without).',
+        '',
+        'L.MAGIC_WORD = [%s];' % ' '.join(str(b) for b in schema.magic),
+        'L.SEGMENT_LEN = %d;' % schema.segment_len,
+        '',
+    ]
+    for s in schema.struct_list:
+        out.append('L.%s.LEN = %d;' % (s.name, s.size))
+        for name, _, _, offset in s.fields:
+            out.append('L.%s.%s = %d;' % (s.name, name, offset))
+    out.append('')
+    for t in schema.tlvs:
+        out.append('L.TLV.%s = %d;' % (t.name, t.type))
+    out.append('')
+    for t in schema.tlvs:
+        out.append('L.FIXED_LEN.%s = %d;' % (t.name, t.fixed_len))
+    out.append('')
+    for t in schema.tlvs:
+        out.append('L.ELEM_LEN.%s = %d;' % (t.name, t.elem_len))
+    out += ['return', '']
+    return '\n'.join(out)
+
+
+def outputs(schema):
+    pack_h, pack_c = gen_pack(schema)
+    return [
+        ('board/common/mmw_tlv_layout.h', gen_layout_h(schema)),
+        ('board/common/mmw_tlv_pack.h', pack_h),
+        ('board/common/mmw_tlv_pack.c', pack_c),
+        ('applications/host/lib/mmw_wire_layout.h', gen_wire_layout(schema)),
+        ('applications/visualizations/mmw_tlv.py', gen_python(schema)),
+        ('applications/visualizations/mmw_tlv_layout.m', gen_matlab(schema)),
+    ]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generates the TLV layout code from mmw_tlv_schema.json')
+    parser.add_argument('--check', action='store_true', help='fail when a generated file is stale')
+    args = parser.parse_args()
+
+    try:
+        schema = Schema(SCHEMA)
+    except (KeyError, ValueError) as e:
+        sys.stderr.write('mmw_tlv_schema.json: %s\n' % e)
+        return 1
+
+    stale = 0
+    for rel, text in outputs(schema):
+        path = os.path.join(ROOT, rel)
+        old = None
+        if os.path.exists(path):
+            with open(path) as f:
+                old = f.read()
+        if old == text:
+            continue
+        if args.check:
+            sys.stderr.write('%s is stale, run make layout\n' % rel)
+            stale += 1
+        else:
+            with open(path, 'w') as f:
+                f.write(text)
+            print('wrote %s' % rel)
+    return 1 if stale else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
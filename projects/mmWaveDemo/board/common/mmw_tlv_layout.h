@@ -0,0 +1,178 @@
+/**
+ *   @file  mmw_tlv_layout.h
+ *
+ *   @brief
+ *      Generated by board/common/mmw_tlv_gen.py from mmw_tlv_schema.json, do not edit.
+ *
+ *      Sizes and offsets of the output packet and the TLV lengths as
+ *      the schema gives them, for the MSS, the DSS and the host tools.
+ *      The structs of board/common and the extended TLV types are
+ *      checked against the schema here, the SDK ones in mmw_tlv_pack.c.
+ */
+#ifndef MMW_TLV_LAYOUT_H
+#define MMW_TLV_LAYOUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mmw_heatmap_codec.h"
+#include "mmw_heatmap_sparse.h"
+#include "mmw_azimuth_heatmap.h"
+#include "mmw_output_ext.h"
+#include "mmw_profile_delta.h"
+
+/*! @brief   Fails the build when cond is false */
+#define MMW_TLV_LAYOUT_CHECK(name, cond) typedef char MmwDemo_tlvLayoutCheck_##name[(cond) ? 1 : -1]
+
+/*! @brief   Output packets are padded to a multiple of this length */
+#define MMWDEMO_WIRE_SEGMENT_LEN 32U
+
+#define MMWDEMO_WIRE_MSG_HEADER_LEN                           36U
+#define MMWDEMO_WIRE_TLV_HEADER_LEN                           8U
+#define MMWDEMO_WIRE_DET_OBJ_DESCR_LEN                        4U
+#define MMWDEMO_WIRE_DET_OBJ_LEN                              12U
+#define MMWDEMO_WIRE_CMPLX16_IM_RE_LEN                        4U
+#define MMWDEMO_WIRE_STATS_LEN                                24U
+#define MMWDEMO_WIRE_RD_HEAT_MAP_CODEC_HDR_LEN                8U
+#define MMWDEMO_WIRE_RD_HEAT_MAP_SPARSE_HDR_LEN               12U
+#define MMWDEMO_WIRE_AZIMUTH_HEAT_MAP_HDR_LEN                 8U
+#define MMWDEMO_WIRE_DSS_STATS_LEN                            32U
+#define MMWDEMO_WIRE_MSS_STATS_LEN                            20U
+#define MMWDEMO_WIRE_OUTPUT_SHED_LEN                          12U
+#define MMWDEMO_WIRE_QUIET_REPORT_LEN                         12U
+#define MMWDEMO_WIRE_PROFILE_DELTA_HDR_LEN                    12U
+#define MMWDEMO_WIRE_PACKET_CRC_LEN                           4U
+
+#define MMWDEMO_WIRE_MSG_HEADER_MAGIC_WORD_OFFSET             0U
+#define MMWDEMO_WIRE_MSG_HEADER_VERSION_OFFSET                8U
+#define MMWDEMO_WIRE_MSG_HEADER_TOTAL_PACKET_LEN_OFFSET       12U
+#define MMWDEMO_WIRE_MSG_HEADER_PLATFORM_OFFSET               16U
+#define MMWDEMO_WIRE_MSG_HEADER_FRAME_NUMBER_OFFSET           20U
+#define MMWDEMO_WIRE_MSG_HEADER_TIME_CPU_CYCLES_OFFSET        24U
+#define MMWDEMO_WIRE_MSG_HEADER_NUM_DETECTED_OBJ_OFFSET       28U
+#define MMWDEMO_WIRE_MSG_HEADER_NUM_TLVS_OFFSET               32U
+
+#define MMWDEMO_WIRE_TLV_HEADER_TYPE_OFFSET                   0U
+#define MMWDEMO_WIRE_TLV_HEADER_LENGTH_OFFSET                 4U
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_DETECTED_POINTS, counted */
+#define MMWDEMO_TLV_DETECTED_POINTS_FIXED_LEN                4U
+#define MMWDEMO_TLV_DETECTED_POINTS_ELEM_LEN                 12U
+#define MMWDEMO_TLV_DETECTED_POINTS_COUNT_OFFSET             0U
+#define MMWDEMO_TLV_DETECTED_POINTS_LEN(n)                   (4U + 12U * (uint32_t) (n))
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_RANGE_PROFILE, array */
+#define MMWDEMO_TLV_RANGE_PROFILE_ELEM_LEN                   2U
+#define MMWDEMO_TLV_RANGE_PROFILE_LEN(n)                     (2U * (uint32_t) (n))
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_NOISE_PROFILE, array */
+#define MMWDEMO_TLV_NOISE_PROFILE_ELEM_LEN                   2U
+#define MMWDEMO_TLV_NOISE_PROFILE_LEN(n)                     (2U * (uint32_t) (n))
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_AZIMUT_STATIC_HEAT_MAP, array */
+#define MMWDEMO_TLV_AZIMUTH_STATIC_HEAT_MAP_ELEM_LEN         4U
+#define MMWDEMO_TLV_AZIMUTH_STATIC_HEAT_MAP_LEN(n)           (4U * (uint32_t) (n))
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP, array */
+#define MMWDEMO_TLV_RANGE_DOPPLER_HEAT_MAP_ELEM_LEN          2U
+#define MMWDEMO_TLV_RANGE_DOPPLER_HEAT_MAP_LEN(n)            (2U * (uint32_t) (n))
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_STATS, struct */
+#define MMWDEMO_TLV_STATS_LEN                                24U
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED, prefixed */
+#define MMWDEMO_TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED_MIN_LEN 8U
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_SPARSE, prefixed */
+#define MMWDEMO_TLV_RANGE_DOPPLER_HEAT_MAP_SPARSE_MIN_LEN    12U
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_AZIMUTH_HEAT_MAP_MAGNITUDE, prefixed */
+#define MMWDEMO_TLV_AZIMUTH_HEAT_MAP_MAGNITUDE_MIN_LEN       8U
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_DSS_STATS, struct */
+#define MMWDEMO_TLV_DSS_STATS_LEN                            32U
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_MSS_STATS, struct */
+#define MMWDEMO_TLV_MSS_STATS_LEN                            20U
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_OUTPUT_SHED, struct */
+#define MMWDEMO_TLV_OUTPUT_SHED_LEN                          12U
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_QUIET, struct */
+#define MMWDEMO_TLV_QUIET_LEN                                12U
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_RANGE_PROFILE_DELTA, prefixed */
+#define MMWDEMO_TLV_RANGE_PROFILE_DELTA_MIN_LEN              12U
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_NOISE_PROFILE_DELTA, prefixed */
+#define MMWDEMO_TLV_NOISE_PROFILE_DELTA_MIN_LEN              12U
+
+/*! @brief   MMWDEMO_OUTPUT_MSG_PACKET_CRC, struct */
+#define MMWDEMO_TLV_PACKET_CRC_LEN                           4U
+
+MMW_TLV_LAYOUT_CHECK(RdHeatMapCodecHdr_size, sizeof(MmwDemo_rdHeatMapCodecHdr) == 8U);
+MMW_TLV_LAYOUT_CHECK(RdHeatMapCodecHdr_numRangeBins, (offsetof(MmwDemo_rdHeatMapCodecHdr, numRangeBins) == 0U) && (sizeof(((MmwDemo_rdHeatMapCodecHdr *) 0)->numRangeBins) == 2U));
+MMW_TLV_LAYOUT_CHECK(RdHeatMapCodecHdr_numDopplerBins, (offsetof(MmwDemo_rdHeatMapCodecHdr, numDopplerBins) == 2U) && (sizeof(((MmwDemo_rdHeatMapCodecHdr *) 0)->numDopplerBins) == 2U));
+MMW_TLV_LAYOUT_CHECK(RdHeatMapCodecHdr_noiseFloor, (offsetof(MmwDemo_rdHeatMapCodecHdr, noiseFloor) == 4U) && (sizeof(((MmwDemo_rdHeatMapCodecHdr *) 0)->noiseFloor) == 2U));
+MMW_TLV_LAYOUT_CHECK(RdHeatMapCodecHdr_version, (offsetof(MmwDemo_rdHeatMapCodecHdr, version) == 6U) && (sizeof(((MmwDemo_rdHeatMapCodecHdr *) 0)->version) == 1U));
+MMW_TLV_LAYOUT_CHECK(RdHeatMapCodecHdr_reserved, (offsetof(MmwDemo_rdHeatMapCodecHdr, reserved) == 7U) && (sizeof(((MmwDemo_rdHeatMapCodecHdr *) 0)->reserved) == 1U));
+MMW_TLV_LAYOUT_CHECK(RdHeatMapSparseHdr_size, sizeof(MmwDemo_rdHeatMapSparseHdr) == 12U);
+MMW_TLV_LAYOUT_CHECK(RdHeatMapSparseHdr_numRangeBins, (offsetof(MmwDemo_rdHeatMapSparseHdr, numRangeBins) == 0U) && (sizeof(((MmwDemo_rdHeatMapSparseHdr *) 0)->numRangeBins) == 2U));
+MMW_TLV_LAYOUT_CHECK(RdHeatMapSparseHdr_numDopplerBins, (offsetof(MmwDemo_rdHeatMapSparseHdr, numDopplerBins) == 2U) && (sizeof(((MmwDemo_rdHeatMapSparseHdr *) 0)->numDopplerBins) == 2U));
+MMW_TLV_LAYOUT_CHECK(RdHeatMapSparseHdr_numRuns, (offsetof(MmwDemo_rdHeatMapSparseHdr, numRuns) == 4U) && (sizeof(((MmwDemo_rdHeatMapSparseHdr *) 0)->numRuns) == 2U));
+MMW_TLV_LAYOUT_CHECK(RdHeatMapSparseHdr_margin, (offsetof(MmwDemo_rdHeatMapSparseHdr, margin) == 6U) && (sizeof(((MmwDemo_rdHeatMapSparseHdr *) 0)->margin) == 2U));
+MMW_TLV_LAYOUT_CHECK(RdHeatMapSparseHdr_version, (offsetof(MmwDemo_rdHeatMapSparseHdr, version) == 8U) && (sizeof(((MmwDemo_rdHeatMapSparseHdr *) 0)->version) == 1U));
+MMW_TLV_LAYOUT_CHECK(RdHeatMapSparseHdr_flags, (offsetof(MmwDemo_rdHeatMapSparseHdr, flags) == 9U) && (sizeof(((MmwDemo_rdHeatMapSparseHdr *) 0)->flags) == 1U));
+MMW_TLV_LAYOUT_CHECK(RdHeatMapSparseHdr_reserved, (offsetof(MmwDemo_rdHeatMapSparseHdr, reserved) == 10U) && (sizeof(((MmwDemo_rdHeatMapSparseHdr *) 0)->reserved) == 2U));
+MMW_TLV_LAYOUT_CHECK(AzimuthHeatMapHdr_size, sizeof(MmwDemo_azimuthHeatMapHdr) == 8U);
+MMW_TLV_LAYOUT_CHECK(AzimuthHeatMapHdr_numRangeBins, (offsetof(MmwDemo_azimuthHeatMapHdr, numRangeBins) == 0U) && (sizeof(((MmwDemo_azimuthHeatMapHdr *) 0)->numRangeBins) == 2U));
+MMW_TLV_LAYOUT_CHECK(AzimuthHeatMapHdr_numAngleBins, (offsetof(MmwDemo_azimuthHeatMapHdr, numAngleBins) == 2U) && (sizeof(((MmwDemo_azimuthHeatMapHdr *) 0)->numAngleBins) == 2U));
+MMW_TLV_LAYOUT_CHECK(AzimuthHeatMapHdr_format, (offsetof(MmwDemo_azimuthHeatMapHdr, format) == 4U) && (sizeof(((MmwDemo_azimuthHeatMapHdr *) 0)->format) == 1U));
+MMW_TLV_LAYOUT_CHECK(AzimuthHeatMapHdr_version, (offsetof(MmwDemo_azimuthHeatMapHdr, version) == 5U) && (sizeof(((MmwDemo_azimuthHeatMapHdr *) 0)->version) == 1U));
+MMW_TLV_LAYOUT_CHECK(AzimuthHeatMapHdr_numVirtualAnt, (offsetof(MmwDemo_azimuthHeatMapHdr, numVirtualAnt) == 6U) && (sizeof(((MmwDemo_azimuthHeatMapHdr *) 0)->numVirtualAnt) == 2U));
+MMW_TLV_LAYOUT_CHECK(DssStats_size, sizeof(MmwDemo_output_message_dssStats) == 32U);
+MMW_TLV_LAYOUT_CHECK(DssStats_frameStartIntCounter, (offsetof(MmwDemo_output_message_dssStats, frameStartIntCounter) == 0U) && (sizeof(((MmwDemo_output_message_dssStats *) 0)->frameStartIntCounter) == 4U));
+MMW_TLV_LAYOUT_CHECK(DssStats_frameIntSkipCounter, (offsetof(MmwDemo_output_message_dssStats, frameIntSkipCounter) == 4U) && (sizeof(((MmwDemo_output_message_dssStats *) 0)->frameIntSkipCounter) == 4U));
+MMW_TLV_LAYOUT_CHECK(DssStats_chirpIntCounter, (offsetof(MmwDemo_output_message_dssStats, chirpIntCounter) == 8U) && (sizeof(((MmwDemo_output_message_dssStats *) 0)->chirpIntCounter) == 4U));
+MMW_TLV_LAYOUT_CHECK(DssStats_chirpIntSkipCounter, (offsetof(MmwDemo_output_message_dssStats, chirpIntSkipCounter) == 12U) && (sizeof(((MmwDemo_output_message_dssStats *) 0)->chirpIntSkipCounter) == 4U));
+MMW_TLV_LAYOUT_CHECK(DssStats_detObjLoggingSkip, (offsetof(MmwDemo_output_message_dssStats, detObjLoggingSkip) == 16U) && (sizeof(((MmwDemo_output_message_dssStats *) 0)->detObjLoggingSkip) == 4U));
+MMW_TLV_LAYOUT_CHECK(DssStats_detObjLoggingErr, (offsetof(MmwDemo_output_message_dssStats, detObjLoggingErr) == 20U) && (sizeof(((MmwDemo_output_message_dssStats *) 0)->detObjLoggingErr) == 4U));
+MMW_TLV_LAYOUT_CHECK(DssStats_numFailedTimingReports, (offsetof(MmwDemo_output_message_dssStats, numFailedTimingReports) == 24U) && (sizeof(((MmwDemo_output_message_dssStats *) 0)->numFailedTimingReports) == 4U));
+MMW_TLV_LAYOUT_CHECK(DssStats_numCalibrationReports, (offsetof(MmwDemo_output_message_dssStats, numCalibrationReports) == 28U) && (sizeof(((MmwDemo_output_message_dssStats *) 0)->numCalibrationReports) == 4U));
+MMW_TLV_LAYOUT_CHECK(MssStats_size, sizeof(MmwDemo_output_message_mssStats) == 20U);
+MMW_TLV_LAYOUT_CHECK(MssStats_packetsSent, (offsetof(MmwDemo_output_message_mssStats, packetsSent) == 0U) && (sizeof(((MmwDemo_output_message_mssStats *) 0)->packetsSent) == 4U));
+MMW_TLV_LAYOUT_CHECK(MssStats_framesSent, (offsetof(MmwDemo_output_message_mssStats, framesSent) == 4U) && (sizeof(((MmwDemo_output_message_mssStats *) 0)->framesSent) == 4U));
+MMW_TLV_LAYOUT_CHECK(MssStats_transferErrors, (offsetof(MmwDemo_output_message_mssStats, transferErrors) == 8U) && (sizeof(((MmwDemo_output_message_mssStats *) 0)->transferErrors) == 4U));
+MMW_TLV_LAYOUT_CHECK(MssStats_numFailedTimingReports, (offsetof(MmwDemo_output_message_mssStats, numFailedTimingReports) == 12U) && (sizeof(((MmwDemo_output_message_mssStats *) 0)->numFailedTimingReports) == 4U));
+MMW_TLV_LAYOUT_CHECK(MssStats_numCalibrationReports, (offsetof(MmwDemo_output_message_mssStats, numCalibrationReports) == 16U) && (sizeof(((MmwDemo_output_message_mssStats *) 0)->numCalibrationReports) == 4U));
+MMW_TLV_LAYOUT_CHECK(OutputShed_size, sizeof(MmwDemo_output_message_outputShed) == 12U);
+MMW_TLV_LAYOUT_CHECK(OutputShed_shedMask, (offsetof(MmwDemo_output_message_outputShed, shedMask) == 0U) && (sizeof(((MmwDemo_output_message_outputShed *) 0)->shedMask) == 4U));
+MMW_TLV_LAYOUT_CHECK(OutputShed_budgetBytes, (offsetof(MmwDemo_output_message_outputShed, budgetBytes) == 4U) && (sizeof(((MmwDemo_output_message_outputShed *) 0)->budgetBytes) == 4U));
+MMW_TLV_LAYOUT_CHECK(OutputShed_packetLen, (offsetof(MmwDemo_output_message_outputShed, packetLen) == 8U) && (sizeof(((MmwDemo_output_message_outputShed *) 0)->packetLen) == 4U));
+MMW_TLV_LAYOUT_CHECK(QuietReport_size, sizeof(MmwDemo_output_message_quiet) == 12U);
+MMW_TLV_LAYOUT_CHECK(QuietReport_prevFrameNumber, (offsetof(MmwDemo_output_message_quiet, prevFrameNumber) == 0U) && (sizeof(((MmwDemo_output_message_quiet *) 0)->prevFrameNumber) == 4U));
+MMW_TLV_LAYOUT_CHECK(QuietReport_quietFrames, (offsetof(MmwDemo_output_message_quiet, quietFrames) == 4U) && (sizeof(((MmwDemo_output_message_quiet *) 0)->quietFrames) == 4U));
+MMW_TLV_LAYOUT_CHECK(QuietReport_maxRangeDelta, (offsetof(MmwDemo_output_message_quiet, maxRangeDelta) == 8U) && (sizeof(((MmwDemo_output_message_quiet *) 0)->maxRangeDelta) == 2U));
+MMW_TLV_LAYOUT_CHECK(QuietReport_flags, (offsetof(MmwDemo_output_message_quiet, flags) == 10U) && (sizeof(((MmwDemo_output_message_quiet *) 0)->flags) == 2U));
+MMW_TLV_LAYOUT_CHECK(ProfileDeltaHdr_size, sizeof(MmwDemo_profileDeltaHdr) == 12U);
+MMW_TLV_LAYOUT_CHECK(ProfileDeltaHdr_numRangeBins, (offsetof(MmwDemo_profileDeltaHdr, numRangeBins) == 0U) && (sizeof(((MmwDemo_profileDeltaHdr *) 0)->numRangeBins) == 2U));
+MMW_TLV_LAYOUT_CHECK(ProfileDeltaHdr_seq, (offsetof(MmwDemo_profileDeltaHdr, seq) == 2U) && (sizeof(((MmwDemo_profileDeltaHdr *) 0)->seq) == 2U));
+MMW_TLV_LAYOUT_CHECK(ProfileDeltaHdr_refSeq, (offsetof(MmwDemo_profileDeltaHdr, refSeq) == 4U) && (sizeof(((MmwDemo_profileDeltaHdr *) 0)->refSeq) == 2U));
+MMW_TLV_LAYOUT_CHECK(ProfileDeltaHdr_tolerance, (offsetof(MmwDemo_profileDeltaHdr, tolerance) == 6U) && (sizeof(((MmwDemo_profileDeltaHdr *) 0)->tolerance) == 2U));
+MMW_TLV_LAYOUT_CHECK(ProfileDeltaHdr_version, (offsetof(MmwDemo_profileDeltaHdr, version) == 8U) && (sizeof(((MmwDemo_profileDeltaHdr *) 0)->version) == 1U));
+MMW_TLV_LAYOUT_CHECK(ProfileDeltaHdr_flags, (offsetof(MmwDemo_profileDeltaHdr, flags) == 9U) && (sizeof(((MmwDemo_profileDeltaHdr *) 0)->flags) == 1U));
+MMW_TLV_LAYOUT_CHECK(ProfileDeltaHdr_reserved, (offsetof(MmwDemo_profileDeltaHdr, reserved) == 10U) && (sizeof(((MmwDemo_profileDeltaHdr *) 0)->reserved) == 2U));
+MMW_TLV_LAYOUT_CHECK(PacketCrc_size, sizeof(MmwDemo_output_message_packetCrc) == 4U);
+MMW_TLV_LAYOUT_CHECK(PacketCrc_crc, (offsetof(MmwDemo_output_message_packetCrc, crc) == 0U) && (sizeof(((MmwDemo_output_message_packetCrc *) 0)->crc) == 4U));
+MMW_TLV_LAYOUT_CHECK(type_RANGE_DOPPLER_HEAT_MAP_COMPRESSED, MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED == 0x101U);
+MMW_TLV_LAYOUT_CHECK(type_RANGE_DOPPLER_HEAT_MAP_SPARSE, MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_SPARSE == 0x102U);
+MMW_TLV_LAYOUT_CHECK(type_AZIMUTH_HEAT_MAP_MAGNITUDE, MMWDEMO_OUTPUT_MSG_AZIMUTH_HEAT_MAP_MAGNITUDE == 0x103U);
+MMW_TLV_LAYOUT_CHECK(type_DSS_STATS, MMWDEMO_OUTPUT_MSG_DSS_STATS == 0x104U);
+MMW_TLV_LAYOUT_CHECK(type_MSS_STATS, MMWDEMO_OUTPUT_MSG_MSS_STATS == 0x105U);
+MMW_TLV_LAYOUT_CHECK(type_OUTPUT_SHED, MMWDEMO_OUTPUT_MSG_OUTPUT_SHED == 0x106U);
+MMW_TLV_LAYOUT_CHECK(type_QUIET, MMWDEMO_OUTPUT_MSG_QUIET == 0x107U);
+MMW_TLV_LAYOUT_CHECK(type_RANGE_PROFILE_DELTA, MMWDEMO_OUTPUT_MSG_RANGE_PROFILE_DELTA == 0x108U);
+MMW_TLV_LAYOUT_CHECK(type_NOISE_PROFILE_DELTA, MMWDEMO_OUTPUT_MSG_NOISE_PROFILE_DELTA == 0x109U);
+MMW_TLV_LAYOUT_CHECK(type_PACKET_CRC, MMWDEMO_OUTPUT_MSG_PACKET_CRC == 0x10AU);
+
+#endif /* MMW_TLV_LAYOUT_H */
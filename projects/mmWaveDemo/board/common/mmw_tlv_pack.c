@@ -0,0 +1,399 @@
+/**
+ *   @file  mmw_tlv_pack.c
+ *
+ *   @brief
+ *      Generated by board/common/mmw_tlv_gen.py from mmw_tlv_schema.json, do not edit.
+ *
+ *      TLV packing, see mmw_tlv_pack.h, and the checks of the SDK
+ *      structs and TLV types against the schema.
+ */
+#include "mmw_tlv_pack.h"
+
+MMW_TLV_LAYOUT_CHECK(MsgHeader_size, sizeof(MmwDemo_output_message_header) == 36U);
+MMW_TLV_LAYOUT_CHECK(MsgHeader_magicWord, (offsetof(MmwDemo_output_message_header, magicWord) == 0U) && (sizeof(((MmwDemo_output_message_header *) 0)->magicWord) == 8U));
+MMW_TLV_LAYOUT_CHECK(MsgHeader_version, (offsetof(MmwDemo_output_message_header, version) == 8U) && (sizeof(((MmwDemo_output_message_header *) 0)->version) == 4U));
+MMW_TLV_LAYOUT_CHECK(MsgHeader_totalPacketLen, (offsetof(MmwDemo_output_message_header, totalPacketLen) == 12U) && (sizeof(((MmwDemo_output_message_header *) 0)->totalPacketLen) == 4U));
+MMW_TLV_LAYOUT_CHECK(MsgHeader_platform, (offsetof(MmwDemo_output_message_header, platform) == 16U) && (sizeof(((MmwDemo_output_message_header *) 0)->platform) == 4U));
+MMW_TLV_LAYOUT_CHECK(MsgHeader_frameNumber, (offsetof(MmwDemo_output_message_header, frameNumber) == 20U) && (sizeof(((MmwDemo_output_message_header *) 0)->frameNumber) == 4U));
+MMW_TLV_LAYOUT_CHECK(MsgHeader_timeCpuCycles, (offsetof(MmwDemo_output_message_header, timeCpuCycles) == 24U) && (sizeof(((MmwDemo_output_message_header *) 0)->timeCpuCycles) == 4U));
+MMW_TLV_LAYOUT_CHECK(MsgHeader_numDetectedObj, (offsetof(MmwDemo_output_message_header, numDetectedObj) == 28U) && (sizeof(((MmwDemo_output_message_header *) 0)->numDetectedObj) == 4U));
+MMW_TLV_LAYOUT_CHECK(MsgHeader_numTLVs, (offsetof(MmwDemo_output_message_header, numTLVs) == 32U) && (sizeof(((MmwDemo_output_message_header *) 0)->numTLVs) == 4U));
+MMW_TLV_LAYOUT_CHECK(TlvHeader_size, sizeof(MmwDemo_output_message_tl) == 8U);
+MMW_TLV_LAYOUT_CHECK(TlvHeader_type, (offsetof(MmwDemo_output_message_tl, type) == 0U) && (sizeof(((MmwDemo_output_message_tl *) 0)->type) == 4U));
+MMW_TLV_LAYOUT_CHECK(TlvHeader_length, (offsetof(MmwDemo_output_message_tl, length) == 4U) && (sizeof(((MmwDemo_output_message_tl *) 0)->length) == 4U));
+MMW_TLV_LAYOUT_CHECK(DetObjDescr_size, sizeof(MmwDemo_output_message_dataObjDescr) == 4U);
+MMW_TLV_LAYOUT_CHECK(DetObjDescr_numDetetedObj, (offsetof(MmwDemo_output_message_dataObjDescr, numDetetedObj) == 0U) && (sizeof(((MmwDemo_output_message_dataObjDescr *) 0)->numDetetedObj) == 2U));
+MMW_TLV_LAYOUT_CHECK(DetObjDescr_xyzQFormat, (offsetof(MmwDemo_output_message_dataObjDescr, xyzQFormat) == 2U) && (sizeof(((MmwDemo_output_message_dataObjDescr *) 0)->xyzQFormat) == 2U));
+MMW_TLV_LAYOUT_CHECK(DetObj_size, sizeof(MmwDemo_detectedObj) == 12U);
+MMW_TLV_LAYOUT_CHECK(DetObj_rangeIdx, (offsetof(MmwDemo_detectedObj, rangeIdx) == 0U) && (sizeof(((MmwDemo_detectedObj *) 0)->rangeIdx) == 2U));
+MMW_TLV_LAYOUT_CHECK(DetObj_dopplerIdx, (offsetof(MmwDemo_detectedObj, dopplerIdx) == 2U) && (sizeof(((MmwDemo_detectedObj *) 0)->dopplerIdx) == 2U));
+MMW_TLV_LAYOUT_CHECK(DetObj_peakVal, (offsetof(MmwDemo_detectedObj, peakVal) == 4U) && (sizeof(((MmwDemo_detectedObj *) 0)->peakVal) == 2U));
+MMW_TLV_LAYOUT_CHECK(DetObj_x, (offsetof(MmwDemo_detectedObj, x) == 6U) && (sizeof(((MmwDemo_detectedObj *) 0)->x) == 2U));
+MMW_TLV_LAYOUT_CHECK(DetObj_y, (offsetof(MmwDemo_detectedObj, y) == 8U) && (sizeof(((MmwDemo_detectedObj *) 0)->y) == 2U));
+MMW_TLV_LAYOUT_CHECK(DetObj_z, (offsetof(MmwDemo_detectedObj, z) == 10U) && (sizeof(((MmwDemo_detectedObj *) 0)->z) == 2U));
+MMW_TLV_LAYOUT_CHECK(Cmplx16ImRe_size, sizeof(cmplx16ImRe_t) == 4U);
+MMW_TLV_LAYOUT_CHECK(Cmplx16ImRe_imag, (offsetof(cmplx16ImRe_t, imag) == 0U) && (sizeof(((cmplx16ImRe_t *) 0)->imag) == 2U));
+MMW_TLV_LAYOUT_CHECK(Cmplx16ImRe_real, (offsetof(cmplx16ImRe_t, real) == 2U) && (sizeof(((cmplx16ImRe_t *) 0)->real) == 2U));
+MMW_TLV_LAYOUT_CHECK(Stats_size, sizeof(MmwDemo_output_message_stats) == 24U);
+MMW_TLV_LAYOUT_CHECK(Stats_interFrameProcessingTime, (offsetof(MmwDemo_output_message_stats, interFrameProcessingTime) == 0U) && (sizeof(((MmwDemo_output_message_stats *) 0)->interFrameProcessingTime) == 4U));
+MMW_TLV_LAYOUT_CHECK(Stats_transmitOutputTime, (offsetof(MmwDemo_output_message_stats, transmitOutputTime) == 4U) && (sizeof(((MmwDemo_output_message_stats *) 0)->transmitOutputTime) == 4U));
+MMW_TLV_LAYOUT_CHECK(Stats_interFrameProcessingMargin, (offsetof(MmwDemo_output_message_stats, interFrameProcessingMargin) == 8U) && (sizeof(((MmwDemo_output_message_stats *) 0)->interFrameProcessingMargin) == 4U));
+MMW_TLV_LAYOUT_CHECK(Stats_interChirpProcessingMargin, (offsetof(MmwDemo_output_message_stats, interChirpProcessingMargin) == 12U) && (sizeof(((MmwDemo_output_message_stats *) 0)->interChirpProcessingMargin) == 4U));
+MMW_TLV_LAYOUT_CHECK(Stats_activeFrameCPULoad, (offsetof(MmwDemo_output_message_stats, activeFrameCPULoad) == 16U) && (sizeof(((MmwDemo_output_message_stats *) 0)->activeFrameCPULoad) == 4U));
+MMW_TLV_LAYOUT_CHECK(Stats_interFrameCPULoad, (offsetof(MmwDemo_output_message_stats, interFrameCPULoad) == 20U) && (sizeof(((MmwDemo_output_message_stats *) 0)->interFrameCPULoad) == 4U));
+MMW_TLV_LAYOUT_CHECK(type_DETECTED_POINTS, MMWDEMO_OUTPUT_MSG_DETECTED_POINTS == 0x1U);
+MMW_TLV_LAYOUT_CHECK(type_RANGE_PROFILE, MMWDEMO_OUTPUT_MSG_RANGE_PROFILE == 0x2U);
+MMW_TLV_LAYOUT_CHECK(type_NOISE_PROFILE, MMWDEMO_OUTPUT_MSG_NOISE_PROFILE == 0x3U);
+MMW_TLV_LAYOUT_CHECK(type_AZIMUTH_STATIC_HEAT_MAP, MMWDEMO_OUTPUT_MSG_AZIMUT_STATIC_HEAT_MAP == 0x4U);
+MMW_TLV_LAYOUT_CHECK(type_RANGE_DOPPLER_HEAT_MAP, MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP == 0x5U);
+MMW_TLV_LAYOUT_CHECK(type_STATS, MMWDEMO_OUTPUT_MSG_STATS == 0x6U);
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills a TLV slot with MMWDEMO_OUTPUT_MSG_DETECTED_POINTS.
+ *
+ *  @param[out] tlv
+ *      TLV slot of the message
+ *  @param[in]  payload
+ *      MmwDemo_output_message_dataObjDescr, followed by the MmwDemo_detectedObj elements
+ *  @param[in]  numDetetedObj
+ *      Number of elements, as in the MmwDemo_output_message_dataObjDescr
+ *
+ *  @retval
+ *      Bytes added to the packet, TLV header included
+ */
+uint32_t MmwDemo_tlvPackDetectedPoints(MmwDemo_msgTlv *tlv, const MmwDemo_output_message_dataObjDescr *payload, uint32_t numDetetedObj)
+{
+    tlv->type = MMWDEMO_OUTPUT_MSG_DETECTED_POINTS;
+    tlv->length = MMWDEMO_TLV_DETECTED_POINTS_LEN(numDetetedObj);
+    tlv->address = (uint32_t) payload;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tlv->length;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills a TLV slot with MMWDEMO_OUTPUT_MSG_RANGE_PROFILE.
+ *
+ *  @param[out] tlv
+ *      TLV slot of the message
+ *  @param[in]  payload
+ *      uint16_t elements
+ *  @param[in]  numElems
+ *      Number of elements
+ *
+ *  @retval
+ *      Bytes added to the packet, TLV header included
+ */
+uint32_t MmwDemo_tlvPackRangeProfile(MmwDemo_msgTlv *tlv, const uint16_t *payload, uint32_t numElems)
+{
+    tlv->type = MMWDEMO_OUTPUT_MSG_RANGE_PROFILE;
+    tlv->length = MMWDEMO_TLV_RANGE_PROFILE_LEN(numElems);
+    tlv->address = (uint32_t) payload;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tlv->length;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills a TLV slot with MMWDEMO_OUTPUT_MSG_NOISE_PROFILE.
+ *
+ *  @param[out] tlv
+ *      TLV slot of the message
+ *  @param[in]  payload
+ *      uint16_t elements
+ *  @param[in]  numElems
+ *      Number of elements
+ *
+ *  @retval
+ *      Bytes added to the packet, TLV header included
+ */
+uint32_t MmwDemo_tlvPackNoiseProfile(MmwDemo_msgTlv *tlv, const uint16_t *payload, uint32_t numElems)
+{
+    tlv->type = MMWDEMO_OUTPUT_MSG_NOISE_PROFILE;
+    tlv->length = MMWDEMO_TLV_NOISE_PROFILE_LEN(numElems);
+    tlv->address = (uint32_t) payload;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tlv->length;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills a TLV slot with MMWDEMO_OUTPUT_MSG_AZIMUT_STATIC_HEAT_MAP.
+ *
+ *  @param[out] tlv
+ *      TLV slot of the message
+ *  @param[in]  payload
+ *      cmplx16ImRe_t elements
+ *  @param[in]  numElems
+ *      Number of elements
+ *
+ *  @retval
+ *      Bytes added to the packet, TLV header included
+ */
+uint32_t MmwDemo_tlvPackAzimuthStaticHeatMap(MmwDemo_msgTlv *tlv, const cmplx16ImRe_t *payload, uint32_t numElems)
+{
+    tlv->type = MMWDEMO_OUTPUT_MSG_AZIMUT_STATIC_HEAT_MAP;
+    tlv->length = MMWDEMO_TLV_AZIMUTH_STATIC_HEAT_MAP_LEN(numElems);
+    tlv->address = (uint32_t) payload;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tlv->length;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills a TLV slot with MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP.
+ *
+ *  @param[out] tlv
+ *      TLV slot of the message
+ *  @param[in]  payload
+ *      uint16_t elements
+ *  @param[in]  numElems
+ *      Number of elements
+ *
+ *  @retval
+ *      Bytes added to the packet, TLV header included
+ */
+uint32_t MmwDemo_tlvPackRangeDopplerHeatMap(MmwDemo_msgTlv *tlv, const uint16_t *payload, uint32_t numElems)
+{
+    tlv->type = MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP;
+    tlv->length = MMWDEMO_TLV_RANGE_DOPPLER_HEAT_MAP_LEN(numElems);
+    tlv->address = (uint32_t) payload;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tlv->length;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills a TLV slot with MMWDEMO_OUTPUT_MSG_STATS.
+ *
+ *  @param[out] tlv
+ *      TLV slot of the message
+ *  @param[in]  payload
+ *      MmwDemo_output_message_stats, stays in place until the MSS sent it
+ *
+ *  @retval
+ *      Bytes added to the packet, TLV header included
+ */
+uint32_t MmwDemo_tlvPackStats(MmwDemo_msgTlv *tlv, const MmwDemo_output_message_stats *payload)
+{
+    tlv->type = MMWDEMO_OUTPUT_MSG_STATS;
+    tlv->length = MMWDEMO_TLV_STATS_LEN;
+    tlv->address = (uint32_t) payload;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tlv->length;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills a TLV slot with MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED.
+ *
+ *  @param[out] tlv
+ *      TLV slot of the message
+ *  @param[in]  payload
+ *      MmwDemo_rdHeatMapCodecHdr and the encoded data
+ *  @param[in]  length
+ *      Bytes from payload on, at least MMWDEMO_TLV_RANGE_DOPPLER_HEAT_MAP_COMPRESSED_MIN_LEN
+ *
+ *  @retval
+ *      Bytes added to the packet, TLV header included
+ */
+uint32_t MmwDemo_tlvPackRangeDopplerHeatMapCompressed(MmwDemo_msgTlv *tlv, const void *payload, uint32_t length)
+{
+    tlv->type = MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED;
+    tlv->length = length;
+    tlv->address = (uint32_t) payload;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tlv->length;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills a TLV slot with MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_SPARSE.
+ *
+ *  @param[out] tlv
+ *      TLV slot of the message
+ *  @param[in]  payload
+ *      MmwDemo_rdHeatMapSparseHdr and the encoded data
+ *  @param[in]  length
+ *      Bytes from payload on, at least MMWDEMO_TLV_RANGE_DOPPLER_HEAT_MAP_SPARSE_MIN_LEN
+ *
+ *  @retval
+ *      Bytes added to the packet, TLV header included
+ */
+uint32_t MmwDemo_tlvPackRangeDopplerHeatMapSparse(MmwDemo_msgTlv *tlv, const void *payload, uint32_t length)
+{
+    tlv->type = MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_SPARSE;
+    tlv->length = length;
+    tlv->address = (uint32_t) payload;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tlv->length;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills a TLV slot with MMWDEMO_OUTPUT_MSG_AZIMUTH_HEAT_MAP_MAGNITUDE.
+ *
+ *  @param[out] tlv
+ *      TLV slot of the message
+ *  @param[in]  payload
+ *      MmwDemo_azimuthHeatMapHdr and the encoded data
+ *  @param[in]  length
+ *      Bytes from payload on, at least MMWDEMO_TLV_AZIMUTH_HEAT_MAP_MAGNITUDE_MIN_LEN
+ *
+ *  @retval
+ *      Bytes added to the packet, TLV header included
+ */
+uint32_t MmwDemo_tlvPackAzimuthHeatMapMagnitude(MmwDemo_msgTlv *tlv, const void *payload, uint32_t length)
+{
+    tlv->type = MMWDEMO_OUTPUT_MSG_AZIMUTH_HEAT_MAP_MAGNITUDE;
+    tlv->length = length;
+    tlv->address = (uint32_t) payload;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tlv->length;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills a TLV slot with MMWDEMO_OUTPUT_MSG_DSS_STATS.
+ *
+ *  @param[out] tlv
+ *      TLV slot of the message
+ *  @param[in]  payload
+ *      MmwDemo_output_message_dssStats, stays in place until the MSS sent it
+ *
+ *  @retval
+ *      Bytes added to the packet, TLV header included
+ */
+uint32_t MmwDemo_tlvPackDssStats(MmwDemo_msgTlv *tlv, const MmwDemo_output_message_dssStats *payload)
+{
+    tlv->type = MMWDEMO_OUTPUT_MSG_DSS_STATS;
+    tlv->length = MMWDEMO_TLV_DSS_STATS_LEN;
+    tlv->address = (uint32_t) payload;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tlv->length;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills a TLV slot with MMWDEMO_OUTPUT_MSG_OUTPUT_SHED.
+ *
+ *  @param[out] tlv
+ *      TLV slot of the message
+ *  @param[in]  payload
+ *      MmwDemo_output_message_outputShed, stays in place until the MSS sent it
+ *
+ *  @retval
+ *      Bytes added to the packet, TLV header included
+ */
+uint32_t MmwDemo_tlvPackOutputShed(MmwDemo_msgTlv *tlv, const MmwDemo_output_message_outputShed *payload)
+{
+    tlv->type = MMWDEMO_OUTPUT_MSG_OUTPUT_SHED;
+    tlv->length = MMWDEMO_TLV_OUTPUT_SHED_LEN;
+    tlv->address = (uint32_t) payload;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tlv->length;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills a TLV slot with MMWDEMO_OUTPUT_MSG_QUIET.
+ *
+ *  @param[out] tlv
+ *      TLV slot of the message
+ *  @param[in]  payload
+ *      MmwDemo_output_message_quiet, stays in place until the MSS sent it
+ *
+ *  @retval
+ *      Bytes added to the packet, TLV header included
+ */
+uint32_t MmwDemo_tlvPackQuiet(MmwDemo_msgTlv *tlv, const MmwDemo_output_message_quiet *payload)
+{
+    tlv->type = MMWDEMO_OUTPUT_MSG_QUIET;
+    tlv->length = MMWDEMO_TLV_QUIET_LEN;
+    tlv->address = (uint32_t) payload;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tlv->length;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills a TLV slot with MMWDEMO_OUTPUT_MSG_RANGE_PROFILE_DELTA.
+ *
+ *  @param[out] tlv
+ *      TLV slot of the message
+ *  @param[in]  payload
+ *      MmwDemo_profileDeltaHdr and the encoded data
+ *  @param[in]  length
+ *      Bytes from payload on, at least MMWDEMO_TLV_RANGE_PROFILE_DELTA_MIN_LEN
+ *
+ *  @retval
+ *      Bytes added to the packet, TLV header included
+ */
+uint32_t MmwDemo_tlvPackRangeProfileDelta(MmwDemo_msgTlv *tlv, const void *payload, uint32_t length)
+{
+    tlv->type = MMWDEMO_OUTPUT_MSG_RANGE_PROFILE_DELTA;
+    tlv->length = length;
+    tlv->address = (uint32_t) payload;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tlv->length;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills a TLV slot with MMWDEMO_OUTPUT_MSG_NOISE_PROFILE_DELTA.
+ *
+ *  @param[out] tlv
+ *      TLV slot of the message
+ *  @param[in]  payload
+ *      MmwDemo_profileDeltaHdr and the encoded data
+ *  @param[in]  length
+ *      Bytes from payload on, at least MMWDEMO_TLV_NOISE_PROFILE_DELTA_MIN_LEN
+ *
+ *  @retval
+ *      Bytes added to the packet, TLV header included
+ */
+uint32_t MmwDemo_tlvPackNoiseProfileDelta(MmwDemo_msgTlv *tlv, const void *payload, uint32_t length)
+{
+    tlv->type = MMWDEMO_OUTPUT_MSG_NOISE_PROFILE_DELTA;
+    tlv->length = length;
+    tlv->address = (uint32_t) payload;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tlv->length;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills the wire TLV header of MMWDEMO_OUTPUT_MSG_MSS_STATS.
+ *
+ *  @param[out] tl
+ *      TLV header
+ *
+ *  @retval
+ *      Bytes the TLV adds to the packet, header and payload
+ */
+uint32_t MmwDemo_tlvHeaderMssStats(MmwDemo_output_message_tl *tl)
+{
+    tl->type = MMWDEMO_OUTPUT_MSG_MSS_STATS;
+    tl->length = MMWDEMO_TLV_MSS_STATS_LEN;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tl->length;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Fills the wire TLV header of MMWDEMO_OUTPUT_MSG_PACKET_CRC.
+ *
+ *  @param[out] tl
+ *      TLV header
+ *
+ *  @retval
+ *      Bytes the TLV adds to the packet, header and payload
+ */
+uint32_t MmwDemo_tlvHeaderPacketCrc(MmwDemo_output_message_tl *tl)
+{
+    tl->type = MMWDEMO_OUTPUT_MSG_PACKET_CRC;
+    tl->length = MMWDEMO_TLV_PACKET_CRC_LEN;
+    return MMWDEMO_WIRE_TLV_HEADER_LEN + tl->length;
+}
@@ -0,0 +1,46 @@
+/**
+ *   @file  mmw_tlv_pack.h
+ *
+ *   @brief
+ *      Generated by board/common/mmw_tlv_gen.py from mmw_tlv_schema.json, do not edit.
+ *
+ *      TLV packing of the DSS (a mailbox TLV slot, MmwDemo_msgTlv)
+ *      and of the TLVs the MSS appends (a wire TLV header), with the
+ *      lengths of mmw_tlv_layout.h. Every routine returns the bytes the
+ *      TLV adds to totalPacketLen.
+ */
+#ifndef MMW_TLV_PACK_H
+#define MMW_TLV_PACK_H
+
+#include <ti/common/sys_common.h>
+#include <ti/demo/io_interface/mmw_output.h>
+#include <ti/demo/io_interface/detected_obj.h>
+#include <ti/demo/xwr16xx/mmw/common/mmw_messages.h>
+#include "mmw_tlv_layout.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t MmwDemo_tlvPackDetectedPoints(MmwDemo_msgTlv *tlv, const MmwDemo_output_message_dataObjDescr *payload, uint32_t numDetetedObj);
+uint32_t MmwDemo_tlvPackRangeProfile(MmwDemo_msgTlv *tlv, const uint16_t *payload, uint32_t numElems);
+uint32_t MmwDemo_tlvPackNoiseProfile(MmwDemo_msgTlv *tlv, const uint16_t *payload, uint32_t numElems);
+uint32_t MmwDemo_tlvPackAzimuthStaticHeatMap(MmwDemo_msgTlv *tlv, const cmplx16ImRe_t *payload, uint32_t numElems);
+uint32_t MmwDemo_tlvPackRangeDopplerHeatMap(MmwDemo_msgTlv *tlv, const uint16_t *payload, uint32_t numElems);
+uint32_t MmwDemo_tlvPackStats(MmwDemo_msgTlv *tlv, const MmwDemo_output_message_stats *payload);
+uint32_t MmwDemo_tlvPackRangeDopplerHeatMapCompressed(MmwDemo_msgTlv *tlv, const void *payload, uint32_t length);
+uint32_t MmwDemo_tlvPackRangeDopplerHeatMapSparse(MmwDemo_msgTlv *tlv, const void *payload, uint32_t length);
+uint32_t MmwDemo_tlvPackAzimuthHeatMapMagnitude(MmwDemo_msgTlv *tlv, const void *payload, uint32_t length);
+uint32_t MmwDemo_tlvPackDssStats(MmwDemo_msgTlv *tlv, const MmwDemo_output_message_dssStats *payload);
+uint32_t MmwDemo_tlvPackOutputShed(MmwDemo_msgTlv *tlv, const MmwDemo_output_message_outputShed *payload);
+uint32_t MmwDemo_tlvPackQuiet(MmwDemo_msgTlv *tlv, const MmwDemo_output_message_quiet *payload);
+uint32_t MmwDemo_tlvPackRangeProfileDelta(MmwDemo_msgTlv *tlv, const void *payload, uint32_t length);
+uint32_t MmwDemo_tlvPackNoiseProfileDelta(MmwDemo_msgTlv *tlv, const void *payload, uint32_t length);
+uint32_t MmwDemo_tlvHeaderMssStats(MmwDemo_output_message_tl *tl);
+uint32_t MmwDemo_tlvHeaderPacketCrc(MmwDemo_output_message_tl *tl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MMW_TLV_PACK_H */
@@ -72,8 +72,10 @@
 #include <ti/utils/cli/cli.h>
 
 /* Demo Include Files */
-#include "ti/demo/xwr16xx/mmw/mss/mss_mmw.h"
+#include "mss_mmw.h"
 #include "ti/demo/xwr16xx/mmw/common/mmw_messages.h"
+#include "../common/mmw_messages_ext.h"
+#include "../common/mmw_azimuth_heatmap.h"
 
 /**************************************************************************
  *************************** Local Definitions ****************************
@@ -88,6 +90,11 @@ static int32_t MmwDemo_CLISensorStart (int32_t argc, char* argv[]);
 static int32_t MmwDemo_CLISensorStop (int32_t argc, char* argv[]);
 static int32_t MmwDemo_CLIGuiMonSel (int32_t argc, char* argv[]);
 static int32_t MmwDemo_CLISetDataLogger (int32_t argc, char* argv[]);
+static int32_t MmwDemo_CLIRdHeatMapSparseCfg (int32_t argc, char* argv[]);
+static int32_t MmwDemo_CLIAzimuthHeatMapCfg (int32_t argc, char* argv[]);
+static int32_t MmwDemo_CLIOutputBudgetCfg (int32_t argc, char* argv[]);
+static int32_t MmwDemo_CLIQuietModeCfg (int32_t argc, char* argv[]);
+static int32_t MmwDemo_CLIProfileDeltaCfg (int32_t argc, char* argv[]);
 
 /**************************************************************************
  *************************** Extern Definitions *******************************
@@ -527,6 +534,279 @@ static int32_t MmwDemo_CLISetDataLogger (int32_t argc, char* argv[])
         return -1;
 }
 
+/**
+ *  @b Description
+ *  @n
+ *      This is the CLI Handler for the sparse range/Doppler heat map configuration
+ *
+ *  @param[in] argc
+ *      Number of arguments
+ *  @param[in] argv
+ *      Arguments
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+static int32_t MmwDemo_CLIRdHeatMapSparseCfg (int32_t argc, char* argv[])
+{
+    MmwDemo_RdHeatMapSparseCfg  cfg;
+    MmwDemo_message             message;
+
+    /* Sanity Check: Minimum argument check */
+    if (argc != 2)
+    {
+        CLI_write ("Error: Invalid usage of the CLI command\n");
+        return -1;
+    }
+
+    /* Initialize configuration: */
+    memset ((void *)&cfg, 0, sizeof(MmwDemo_RdHeatMapSparseCfg));
+
+    /* Populate configuration: */
+    cfg.margin = (uint16_t) atoi (argv[1]);
+
+    /* Send configuration to DSS */
+    memset((void *)&message, 0, sizeof(MmwDemo_message));
+
+    message.type = (MmwDemo_message_type) MMWDEMO_MSS2DSS_RD_HEATMAP_SPARSE_CFG;
+    memcpy((void *)&message.body, (void *)&cfg, sizeof(MmwDemo_RdHeatMapSparseCfg));
+
+    if (MmwDemo_mboxWrite(&message) == 0)
+        return 0;
+    else
+        return -1;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      This is the CLI Handler for the range/azimuth magnitude heat map configuration
+ *
+ *  @param[in] argc
+ *      Number of arguments
+ *  @param[in] argv
+ *      Arguments
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+static int32_t MmwDemo_CLIAzimuthHeatMapCfg (int32_t argc, char* argv[])
+{
+    MmwDemo_AzimuthHeatMapCfg   cfg;
+    MmwDemo_message             message;
+
+    /* Sanity Check: Minimum argument check */
+    if (argc != 3)
+    {
+        CLI_write ("Error: Invalid usage of the CLI command\n");
+        return -1;
+    }
+
+    /* Initialize configuration: */
+    memset ((void *)&cfg, 0, sizeof(MmwDemo_AzimuthHeatMapCfg));
+
+    /* Populate configuration: */
+    cfg.numAngleBins = (uint16_t) atoi (argv[1]);
+    cfg.format       = (uint8_t) atoi (argv[2]);
+
+    /* The DSS checks the angle bins against its azimuth FFT size */
+    if ((cfg.numAngleBins < MMW_AZIMUTH_HEATMAP_MIN_BINS) ||
+        ((cfg.numAngleBins & (cfg.numAngleBins - 1U)) != 0U) ||
+        (cfg.format > MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG))
+    {
+        CLI_write ("Error: Invalid azimuth heat map configuration\n");
+        return -1;
+    }
+
+    /* Send configuration to DSS */
+    memset((void *)&message, 0, sizeof(MmwDemo_message));
+
+    message.type = (MmwDemo_message_type) MMWDEMO_MSS2DSS_AZIMUTH_HEATMAP_CFG;
+    memcpy((void *)&message.body, (void *)&cfg, sizeof(MmwDemo_AzimuthHeatMapCfg));
+
+    if (MmwDemo_mboxWrite(&message) == 0)
+        return 0;
+    else
+        return -1;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      This is the CLI Handler for the output link budget configuration
+ *
+ *  @param[in] argc
+ *      Number of arguments
+ *  @param[in] argv
+ *      Arguments
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+static int32_t MmwDemo_CLIOutputBudgetCfg (int32_t argc, char* argv[])
+{
+    MmwDemo_OutputBudgetCfg     cfg;
+    MmwDemo_message             message;
+    int32_t                     budgetPercent;
+
+    /* Sanity Check: Minimum argument check */
+    if (argc != 3)
+    {
+        CLI_write ("Error: Invalid usage of the CLI command\n");
+        return -1;
+    }
+
+    /* Initialize configuration: */
+    memset ((void *)&cfg, 0, sizeof(MmwDemo_OutputBudgetCfg));
+
+    /* Populate configuration: */
+    cfg.linkBytesPerSec = (uint32_t) strtoul (argv[1], NULL, 0);
+    budgetPercent       = atoi (argv[2]);
+    if ((budgetPercent < 1) || (budgetPercent > 100))
+    {
+        CLI_write ("Error: Invalid output budget configuration\n");
+        return -1;
+    }
+    cfg.budgetPercent = (uint8_t) budgetPercent;
+
+    /* Send configuration to DSS */
+    memset((void *)&message, 0, sizeof(MmwDemo_message));
+
+    message.type = (MmwDemo_message_type) MMWDEMO_MSS2DSS_OUTPUT_BUDGET_CFG;
+    memcpy((void *)&message.body, (void *)&cfg, sizeof(MmwDemo_OutputBudgetCfg));
+
+    if (MmwDemo_mboxWrite(&message) == 0)
+        return 0;
+    else
+        return -1;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      This is the CLI Handler for the quiet mode configuration
+ *
+ *  @param[in] argc
+ *      Number of arguments
+ *  @param[in] argv
+ *      Arguments
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+static int32_t MmwDemo_CLIQuietModeCfg (int32_t argc, char* argv[])
+{
+    MmwDemo_QuietModeCfg        cfg;
+    MmwDemo_message             message;
+    int32_t                     enabled;
+    int32_t                     rangeThreshold;
+    int32_t                     keepAliveFrames;
+
+    /* Sanity Check: Minimum argument check */
+    if (argc != 4)
+    {
+        CLI_write ("Error: Invalid usage of the CLI command\n");
+        return -1;
+    }
+
+    /* Initialize configuration: */
+    memset ((void *)&cfg, 0, sizeof(MmwDemo_QuietModeCfg));
+
+    /* Populate configuration: */
+    enabled         = atoi (argv[1]);
+    rangeThreshold  = atoi (argv[2]);
+    keepAliveFrames = atoi (argv[3]);
+    if ((enabled < 0) || (enabled > 1) ||
+        (rangeThreshold < 0) || (rangeThreshold > 0xFFFF) ||
+        (keepAliveFrames < 0) || (keepAliveFrames > 0xFFFF))
+    {
+        CLI_write ("Error: Invalid quiet mode configuration\n");
+        return -1;
+    }
+    cfg.enabled         = (uint8_t) enabled;
+    cfg.rangeThreshold  = (uint16_t) rangeThreshold;
+    cfg.keepAliveFrames = (uint16_t) keepAliveFrames;
+
+    /* Send configuration to DSS */
+    memset((void *)&message, 0, sizeof(MmwDemo_message));
+
+    message.type = (MmwDemo_message_type) MMWDEMO_MSS2DSS_QUIET_MODE_CFG;
+    memcpy((void *)&message.body, (void *)&cfg, sizeof(MmwDemo_QuietModeCfg));
+
+    if (MmwDemo_mboxWrite(&message) == 0)
+        return 0;
+    else
+        return -1;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      This is the CLI Handler for the delta coded profile configuration
+ *
+ *  @param[in] argc
+ *      Number of arguments
+ *  @param[in] argv
+ *      Arguments
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+static int32_t MmwDemo_CLIProfileDeltaCfg (int32_t argc, char* argv[])
+{
+    MmwDemo_ProfileDeltaCfg     cfg;
+    MmwDemo_message             message;
+    int32_t                     keyframeInterval;
+    int32_t                     rangeTolerance;
+    int32_t                     noiseTolerance;
+
+    /* Sanity Check: Minimum argument check */
+    if (argc != 4)
+    {
+        CLI_write ("Error: Invalid usage of the CLI command\n");
+        return -1;
+    }
+
+    /* Initialize configuration: */
+    memset ((void *)&cfg, 0, sizeof(MmwDemo_ProfileDeltaCfg));
+
+    /* Populate configuration: */
+    keyframeInterval = atoi (argv[1]);
+    rangeTolerance   = atoi (argv[2]);
+    noiseTolerance   = atoi (argv[3]);
+    if ((keyframeInterval < 1) || (keyframeInterval > 0xFFFF) ||
+        (rangeTolerance < 0) || (rangeTolerance > 0xFFFF) ||
+        (noiseTolerance < 0) || (noiseTolerance > 0xFFFF))
+    {
+        CLI_write ("Error: Invalid delta profile configuration\n");
+        return -1;
+    }
+    cfg.keyframeInterval = (uint16_t) keyframeInterval;
+    cfg.rangeTolerance   = (uint16_t) rangeTolerance;
+    cfg.noiseTolerance   = (uint16_t) noiseTolerance;
+
+    /* Send configuration to DSS */
+    memset((void *)&message, 0, sizeof(MmwDemo_message));
+
+    message.type = (MmwDemo_message_type) MMWDEMO_MSS2DSS_PROFILE_DELTA_CFG;
+    memcpy((void *)&message.body, (void *)&cfg, sizeof(MmwDemo_ProfileDeltaCfg));
+
+    if (MmwDemo_mboxWrite(&message) == 0)
+        return 0;
+    else
+        return -1;
+}
+
 /**
  *  @b Description
  *  @n
@@ -575,7 +855,7 @@ void MmwDemo_CLIInit (void)
     cnt++;
 
     cliCfg.tableEntry[cnt].cmd            = "guiMonitor";
-    cliCfg.tableEntry[cnt].helpString     = "<detectedObjects> <logMagRange> <noiseProfile> <rangeAzimuthHeatMap> <rangeDopplerHeatMap> <statsInfo>";
+    cliCfg.tableEntry[cnt].helpString     = "<detectedObjects> <logMagRange(bits 0:plain 1:delta)> <noiseProfile(bits 0:plain 1:delta)> <rangeAzimuthHeatMap(bits 0:samples 1:magnitude)> <rangeDopplerHeatMap(bits 0:dense 1:compressed 2:sparse)> <statsInfo(bits 0:timing 1:device counters)>";
     cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLIGuiMonSel;
     cnt++;
 
@@ -604,6 +884,31 @@ void MmwDemo_CLIInit (void)
     cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLICalibDcRangeSig;
     cnt++;
 
+    cliCfg.tableEntry[cnt].cmd            = "rdHeatMapSparseCfg";
+    cliCfg.tableEntry[cnt].helpString     = "<margin>";
+    cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLIRdHeatMapSparseCfg;
+    cnt++;
+
+    cliCfg.tableEntry[cnt].cmd            = "azimuthHeatMapCfg";
+    cliCfg.tableEntry[cnt].helpString     = "<numAngleBins> <format(0:uint16 1:uint8 log)>";
+    cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLIAzimuthHeatMapCfg;
+    cnt++;
+
+    cliCfg.tableEntry[cnt].cmd            = "outputBudgetCfg";
+    cliCfg.tableEntry[cnt].helpString     = "<linkBytesPerSec(0:off)> <budgetPercent>";
+    cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLIOutputBudgetCfg;
+    cnt++;
+
+    cliCfg.tableEntry[cnt].cmd            = "quietModeCfg";
+    cliCfg.tableEntry[cnt].helpString     = "<enabled> <rangeThreshold> <keepAliveFrames(0:none)>";
+    cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLIQuietModeCfg;
+    cnt++;
+
+    cliCfg.tableEntry[cnt].cmd            = "profileDeltaCfg";
+    cliCfg.tableEntry[cnt].helpString     = "<keyframeInterval> <rangeTolerance> <noiseTolerance>";
+    cliCfg.tableEntry[cnt].cmdHandlerFxn  = MmwDemo_CLIProfileDeltaCfg;
+    cnt++;
+
 
     /* Open the CLI: */
     if (CLI_open (&cliCfg) < 0)
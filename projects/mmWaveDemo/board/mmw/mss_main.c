@@ -333,7 +333,9 @@
  *      The structure of the output packet is illustrated in the following figure.
  *      Since the length of the packet depends on the number of detected objects
  *      it can vary from frame to frame. The end of the packet is padded so that
- *      the total packet length is always multiple of 32 Bytes.
+ *      the total packet length is always multiple of 32 Bytes. The last TLV
+ *      of every packet is the CRC-32C of the bytes before it
+ *      (MMWDEMO_OUTPUT_MSG_PACKET_CRC), added by the MSS.
  *
  *      @image html output_packet_uart.png "Output packet structure sent to UART"
  *
@@ -539,16 +541,18 @@ void MmwDemo_mssMmwaveEventCallbackFxn(uint16_t msgId, uint16_t sbId,
 void MmwDemo_mssInitTask(UArg arg0, UArg arg1);
 void MmwDemo_mmWaveCtrlTask(UArg arg0, UArg arg1);
 void MmwDemo_mssCtrlPathTask(UArg arg0, UArg arg1);
-void SPITask(UArg arg0, UArg arg1);
+void MmwDemo_spiTask(UArg arg0, UArg arg1);
+void MmwDemo_spiCallback(SPI_Handle handle, SPI_Transaction *transaction);
 
-SPI_Handle handle;
-bool SPIReadSemaphore = false;
-void spiCallback(SPI_Handle handle, SPI_Transaction *transaction);
-SPI_Transaction spiTransaction;
-Semaphore_Handle SPISem;
 DMA_Handle gDmaHandle = NULL;
-char msg[93] = "1abcdefghijklmnopqrstuvwxyzDONE2abcdefghijklmnopqrstuvwxyzDONE3abcdefghijklmnopqrstuvwxyzDONE";
-char rx[94] = {0};
+
+/*! @brief   SPI output frames, one is clocked out while the next is built */
+#pragma DATA_ALIGN(gMmwSpiFrame, 32);
+uint8_t gMmwSpiFrame[2][MMW_SPI_FRAME_SIZE];
+
+/*! @brief   Receives whatever the host master shifts in while clocking a frame */
+#pragma DATA_ALIGN(gMmwSpiRxFrame, 32);
+uint8_t gMmwSpiRxFrame[MMW_SPI_FRAME_SIZE];
 
 
 /**************************************************************************
@@ -763,28 +767,10 @@ int32_t MmwDemo_mboxWrite(MmwDemo_message * message)
  *  @retval
  *      Not Applicable.
  */
-
-void spiCallback(SPI_Handle handle, SPI_Transaction *transaction)
-{
-
-
-   if(transaction->status == SPI_TRANSFER_COMPLETED)
-   {
-       Semaphore_post(SPISem);
-
-   }
-
- return;
-}
-
 static void MmwDemo_mboxReadTask(UArg arg0, UArg arg1)
 {
     MmwDemo_message message;
     int32_t retVal = 0;
-    uint32_t totalPacketLen;
-    uint32_t numPaddingBytes;
-    uint32_t itemIdx;
-//    bool val = false;
 
     /* wait for new message and process all the messsages received from the peer */
     while (1)
@@ -795,99 +781,48 @@ static void MmwDemo_mboxReadTask(UArg arg0, UArg arg1)
          * from the peer mailbox because this is only being invoked from a single thread */
         retVal = Mailbox_read(gMmwMssMCB.peerMailbox, (uint8_t*) &message,
                               sizeof(MmwDemo_message));
-//        if (retVal < 0)
-//        {
-//            /* Error: Unable to read the message. Setup the error code and return values */
-//            System_printf("Error: Mailbox read failed [Error code %d]\n",
-//                          retVal);
-//        }
-//        else if (retVal == 0)
-//        {
-//            /* We are done: There are no messages available from the peer execution domain. */
-//            continue;
-//        }
-//        else
-//        {
-//
-//
-//
-//            /* Flush out the contents of the mailbox to indicate that we are done with the message. This will
-//             * allow us to receive another message in the mailbox while we process the received message. */
-//            Mailbox_readFlush(gMmwMssMCB.peerMailbox);
-//
-//            /* Process the received message: */
-//            switch (message.type)
-//            {
-//            case MMWDEMO_DSS2MSS_DETOBJ_READY:
-//                /* Got detetced objectes , shipped out through UART */
-//                /* Send header */
-//                totalPacketLen = sizeof(MmwDemo_output_message_header);
-//                UART_writePolling(gMmwMssMCB.loggingUartHandle,
-//                                  (uint8_t*) &message.body.detObj.header,
-//                                  sizeof(MmwDemo_output_message_header));
-//
-//
-//
-//
-//                /* Send TLVs */
-//                for (itemIdx = 0; itemIdx < message.body.detObj.header.numTLVs;
-//                        itemIdx++)
-//                {
-//                    UART_writePolling(
-//                            gMmwMssMCB.loggingUartHandle,
-//                            (uint8_t*) &message.body.detObj.tlv[itemIdx],
-//                            sizeof(MmwDemo_output_message_tl));
-//                    UART_writePolling(
-//                            gMmwMssMCB.loggingUartHandle,
-//                            (uint8_t*) SOC_translateAddress(
-//                                    message.body.detObj.tlv[itemIdx].address,
-//                                    SOC_TranslateAddr_Dir_FROM_OTHER_CPU, NULL),
-//                            message.body.detObj.tlv[itemIdx].length);
-//                    totalPacketLen += sizeof(MmwDemo_output_message_tl)
-//                            + message.body.detObj.tlv[itemIdx].length;
-//                }
-//
-//                /* Send padding to make total packet length multiple of MMWDEMO_OUTPUT_MSG_SEGMENT_LEN */
-//                numPaddingBytes =
-//                        MMWDEMO_OUTPUT_MSG_SEGMENT_LEN
-//                                - (totalPacketLen
-//                                        & (MMWDEMO_OUTPUT_MSG_SEGMENT_LEN - 1));
-//                if (numPaddingBytes < MMWDEMO_OUTPUT_MSG_SEGMENT_LEN)
-//                {
-//                    uint8_t padding[MMWDEMO_OUTPUT_MSG_SEGMENT_LEN];
-//                    /*DEBUG:*/memset(&padding, 0xf,
-//                                     MMWDEMO_OUTPUT_MSG_SEGMENT_LEN);
-//                    UART_writePolling(gMmwMssMCB.loggingUartHandle, padding,
-//                                      numPaddingBytes);
-//                }
-//
-//                /* Send a message to MSS to log the output data */
-//                memset((void *) &message, 0, sizeof(MmwDemo_message));
-//
-//                message.type = MMWDEMO_MSS2DSS_DETOBJ_SHIPPED;
-//
-//                if (MmwDemo_mboxWrite(&message) != 0)
-//                {
-//                    System_printf("Error: Mailbox send message id=%d failed \n",
-//                                  message.type);
-//                }
-//
-//                break;
-//            case MMWDEMO_DSS2MSS_STOPDONE:
-//                /* Post event that stop is done */
-//                Event_post(gMmwMssMCB.eventHandleNotify,
-//                           MMWDEMO_DSS_STOP_COMPLETED_EVT);
-//                break;
-//            default:
-//            {
-//                /* Message not support */
-//                System_printf("Error: unsupport Mailbox message id=%d\n",
-//                              message.type);
-//                break;
-//            }
-//            }
-//        }
+        if (retVal < 0)
+        {
+            /* Error: Unable to read the message. Setup the error code and return values */
+            System_printf("Error: Mailbox read failed [Error code %d]\n",
+                          retVal);
+        }
+        else if (retVal == 0)
+        {
+            /* We are done: There are no messages available from the peer execution domain. */
+            continue;
+        }
+        else
+        {
+            /* Flush out the contents of the mailbox to indicate that we are done with the message. This will
+             * allow us to receive another message in the mailbox while we process the received message. */
+            Mailbox_readFlush(gMmwMssMCB.peerMailbox);
 
+            /* Process the received message: */
+            switch (message.type)
+            {
+            case MMWDEMO_DSS2MSS_DETOBJ_READY:
+                /* Got detetced objectes, shipped out through SPI. The DSS waits for
+                 * MMWDEMO_MSS2DSS_DETOBJ_SHIPPED before the next frame, so the SPI
+                 * task is always idle here; it sends the acknowledge once the TLVs
+                 * are copied into frames. */
+                memcpy((void *) &gMmwMssMCB.spiOutMsg, (void *) &message, sizeof(MmwDemo_message));
+                Semaphore_post(gMmwMssMCB.spiOutSemHandle);
+                break;
+            case MMWDEMO_DSS2MSS_STOPDONE:
+                /* Post event that stop is done */
+                Event_post(gMmwMssMCB.eventHandleNotify,
+                           MMWDEMO_DSS_STOP_COMPLETED_EVT);
+                break;
+            default:
+            {
+                /* Message not support */
+                System_printf("Error: unsupport Mailbox message id=%d\n",
+                              message.type);
+                break;
+            }
+            }
+        }
     }
 }
 
@@ -1193,34 +1128,226 @@ static void MmwDemo_switchPressFxn(unsigned int index)
 /**
  *  @b Description
  *  @n
- *      The task is used to process data path events
- *      control task
+ *      SPI transfer callback, invoked from interrupt context once the host
+ *      master clocked out the armed frame.
+ *
+ *  @param[in]  handle
+ *      SPI handle
+ *  @param[in]  transaction
+ *      Completed transaction
  *
  *  @retval
- *      Not Applicable.
+ *      Not applicable
  */
+void MmwDemo_spiCallback(SPI_Handle handle, SPI_Transaction *transaction)
+{
+    /* Nothing armed until the next frame is started */
+    GPIO_write(MMWDEMO_SPI_READY_GPIO, 0U);
+    Semaphore_post(gMmwMssMCB.spiDoneSemHandle);
+}
 
-void SPITask(UArg arg0, UArg arg1)
+/**
+ *  @b Description
+ *  @n
+ *      Lists the pieces of an output packet in wire order: header, the TLVs
+ *      in HSRAM and the padding to MMWDEMO_OUTPUT_MSG_SEGMENT_LEN, i.e. the
+ *      bytes the UART path used to send. A packet carrying the DSS counters
+ *      gets the MSS counters appended, and every packet the CRC-32C of
+ *      header and TLVs as the last TLV; numTLVs and totalPacketLen of the
+ *      header are updated for them before the CRC is taken.
+ *
+ *  @param[in]  message
+ *      MMWDEMO_DSS2MSS_DETOBJ_READY message
+ *  @param[out] segs
+ *      MMW_SPI_FRAME_MAX_SEGMENTS segments
+ *
+ *  @retval
+ *      Number of segments
+ */
+static uint32_t MmwDemo_spiOutputSegments(MmwDemo_message *message, MmwDemo_spiSegment *segs)
 {
+    static const uint8_t padding[MMWDEMO_OUTPUT_MSG_SEGMENT_LEN] = { 0 };
+    uint32_t totalPacketLen = sizeof(MmwDemo_output_message_header);
+    uint32_t numPaddingBytes;
+    uint32_t numSegs = 0;
+    uint32_t itemIdx;
+    uint32_t crcSegIdx;
+    uint32_t segIdx;
+    uint32_t crc;
+    bool     isDeviceStats = false;
+
+    segs[numSegs].addr = (const uint8_t *) &message->body.detObj.header;
+    segs[numSegs++].len = sizeof(MmwDemo_output_message_header);
+
+    for (itemIdx = 0;
+         (itemIdx < message->body.detObj.header.numTLVs) && (itemIdx < MMWDEMO_OUTPUT_MSG_MAX);
+         itemIdx++)
+    {
+        segs[numSegs].addr = (const uint8_t *) &message->body.detObj.tlv[itemIdx];
+        segs[numSegs++].len = sizeof(MmwDemo_output_message_tl);
+        segs[numSegs].addr = (const uint8_t *) SOC_translateAddress(
+                                 message->body.detObj.tlv[itemIdx].address,
+                                 SOC_TranslateAddr_Dir_FROM_OTHER_CPU, NULL);
+        segs[numSegs++].len = message->body.detObj.tlv[itemIdx].length;
+        totalPacketLen += sizeof(MmwDemo_output_message_tl) + message->body.detObj.tlv[itemIdx].length;
+        if (message->body.detObj.tlv[itemIdx].type == MMWDEMO_OUTPUT_MSG_DSS_STATS)
+        {
+            isDeviceStats = true;
+        }
+    }
+
+    if (isDeviceStats)
+    {
+        /* Counted up to the previous packet; this one is still being sent */
+        gMmwMssMCB.spiMssStats.packetsSent = gMmwMssMCB.stats.spiPacketsSent;
+        gMmwMssMCB.spiMssStats.framesSent = gMmwMssMCB.stats.spiFramesSent;
+        gMmwMssMCB.spiMssStats.transferErrors = gMmwMssMCB.stats.spiTransferErrors;
+        gMmwMssMCB.spiMssStats.numFailedTimingReports = gMmwMssMCB.stats.numFailedTimingReports;
+        gMmwMssMCB.spiMssStats.numCalibrationReports = gMmwMssMCB.stats.numCalibrationReports;
+        totalPacketLen += MmwDemo_tlvHeaderMssStats(&gMmwMssMCB.spiMssStatsTl);
+
+        segs[numSegs].addr = (const uint8_t *) &gMmwMssMCB.spiMssStatsTl;
+        segs[numSegs++].len = MMWDEMO_WIRE_TLV_HEADER_LEN;
+        segs[numSegs].addr = (const uint8_t *) &gMmwMssMCB.spiMssStats;
+        segs[numSegs++].len = MMWDEMO_TLV_MSS_STATS_LEN;
+        message->body.detObj.header.numTLVs++;
+    }
 
+    crcSegIdx = numSegs;
+    totalPacketLen += MmwDemo_tlvHeaderPacketCrc(&gMmwMssMCB.spiCrcTl);
+    segs[numSegs].addr = (const uint8_t *) &gMmwMssMCB.spiCrcTl;
+    segs[numSegs++].len = MMWDEMO_WIRE_TLV_HEADER_LEN;
+    segs[numSegs].addr = (const uint8_t *) &gMmwMssMCB.spiCrc;
+    segs[numSegs++].len = MMWDEMO_TLV_PACKET_CRC_LEN;
+    message->body.detObj.header.numTLVs++;
+
+    numPaddingBytes = MMWDEMO_OUTPUT_MSG_SEGMENT_LEN -
+                      (totalPacketLen & (MMWDEMO_OUTPUT_MSG_SEGMENT_LEN - 1));
+    if (numPaddingBytes < MMWDEMO_OUTPUT_MSG_SEGMENT_LEN)
+    {
+        segs[numSegs].addr = padding;
+        segs[numSegs++].len = numPaddingBytes;
+        totalPacketLen += numPaddingBytes;
+    }
+    message->body.detObj.header.totalPacketLen = totalPacketLen;
 
-    System_printf("SPI Task Started \n");
+    /* The header is final: everything up to the CRC TLV is covered */
+    crc = MMW_CRC32C_INIT;
+    for (segIdx = 0; segIdx < crcSegIdx; segIdx++)
+    {
+        crc = MmwDemo_crc32c(crc, segs[segIdx].addr, segs[segIdx].len);
+    }
+    gMmwMssMCB.spiCrc.crc = crc;
+    return numSegs;
+}
 
-    spiTransaction.count = (size_t)20;
-    spiTransaction.txBuf = (void*) msg;
-    spiTransaction.rxBuf = (void*)rx;
-    spiTransaction.arg = NULL;
-    spiTransaction.slaveIndex = 0U;
+/**
+ *  @b Description
+ *  @n
+ *      Tells the DSS the output buffers of the last frame can be reused.
+ *
+ *  @retval
+ *      Not applicable
+ */
+static void MmwDemo_spiOutputShipped(void)
+{
+    MmwDemo_message message;
 
-    while(1){
-        Semaphore_pend(SPISem, BIOS_WAIT_FOREVER);
-        System_printf("Transfer now\n");
-        SPI_transfer(handle, &spiTransaction);
-        Semaphore_post(SPISem);
+    memset((void *) &message, 0, sizeof(MmwDemo_message));
+    message.type = MMWDEMO_MSS2DSS_DETOBJ_SHIPPED;
+    if (MmwDemo_mboxWrite(&message) != 0)
+    {
+        System_printf("Error: Mailbox send message id=%d failed \n",
+                      message.type);
     }
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      The task sends the output packets over the SPI slave. Every packet is
+ *      cut into MMW_SPI_FRAME_SIZE frames (see mmw_spi_frame.h); a frame is
+ *      armed in the DMA, announced on MMWDEMO_SPI_READY_GPIO, and the next
+ *      one is built while the host clocks it out.
+ *
+ *  @param[in]  arg0
+ *      arg0 of the Task. Not used
+ *  @param[in]  arg1
+ *      arg1 of the Task. Not used
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_spiTask(UArg arg0, UArg arg1)
+{
+    MmwDemo_spiSegment  segs[MMW_SPI_FRAME_MAX_SEGMENTS];
+    SPI_Transaction     transaction;
+    uint32_t            numSegs;
+    uint32_t            frameIdx;
+    uint32_t            payloadLen;
+    bool                isShipped;
+    bool                isError;
 
+    while (1)
+    {
+        Semaphore_pend(gMmwMssMCB.spiOutSemHandle, BIOS_WAIT_FOREVER);
+
+        numSegs = MmwDemo_spiOutputSegments(&gMmwMssMCB.spiOutMsg, segs);
+        MmwDemo_spiFramerStart(&gMmwMssMCB.spiFramer, segs, numSegs);
+
+        isShipped = false;
+        isError = false;
+        frameIdx = 0;
+        payloadLen = MmwDemo_spiFramerNext(&gMmwMssMCB.spiFramer, gMmwSpiFrame[frameIdx]);
+        while (payloadLen > 0U)
+        {
+            transaction.count = MMW_SPI_FRAME_SIZE;
+            transaction.txBuf = (void *) gMmwSpiFrame[frameIdx];
+            transaction.rxBuf = (void *) gMmwSpiRxFrame;
+            transaction.arg = NULL;
+            transaction.slaveIndex = 0U;
+            if (SPI_transfer(gMmwMssMCB.spiHandle, &transaction) == false)
+            {
+                isError = true;
+                break;
+            }
+
+            /* The frame is in the DMA: let the master clock it */
+            GPIO_write(MMWDEMO_SPI_READY_GPIO, 1U);
 
+            /* Build the next frame meanwhile */
+            frameIdx ^= 1U;
+            payloadLen = MmwDemo_spiFramerNext(&gMmwMssMCB.spiFramer, gMmwSpiFrame[frameIdx]);
+            if (payloadLen == 0U)
+            {
+                /* Everything is copied out of HSRAM, the DSS may go on */
+                MmwDemo_spiOutputShipped();
+                isShipped = true;
+            }
+
+            Semaphore_pend(gMmwMssMCB.spiDoneSemHandle, BIOS_WAIT_FOREVER);
+            if (transaction.status != SPI_TRANSFER_COMPLETED)
+            {
+                isError = true;
+                break;
+            }
+            gMmwMssMCB.stats.spiFramesSent++;
+        }
 
+        if (isError)
+        {
+            /* The rest of the packet is dropped, the host sees a sequence gap */
+            gMmwMssMCB.stats.spiTransferErrors++;
+        }
+        else
+        {
+            gMmwMssMCB.stats.spiPacketsSent++;
+        }
+        if (isShipped == false)
+        {
+            MmwDemo_spiOutputShipped();
+        }
+    }
 }
 
 
@@ -1395,7 +1522,6 @@ void MmwDemo_mssInitTask(UArg arg0, UArg arg1)
     MMWave_InitCfg initCfg;
     //UART_Params uartParams;
     Task_Params taskParams;
-    Task_Params spiTaskParams;
     Semaphore_Params semParams;
     Mailbox_Config mboxCfg;
     Error_Block eb;
@@ -1465,6 +1591,10 @@ void MmwDemo_mssInitTask(UArg arg0, UArg arg1)
      Pinmux_Set_OverrideCtrl(SOC_XWR16XX_PINC13_PADAG, PINMUX_OUTEN_RETAIN_HW_CTRL, PINMUX_INPEN_RETAIN_HW_CTRL);
      Pinmux_Set_FuncSel(SOC_XWR16XX_PINC13_PADAG, SOC_XWR16XX_PINC13_PADAG_SPIA_CSN);
 
+     /* SPI ready, GPIO output to the host master */
+     Pinmux_Set_OverrideCtrl(MMWDEMO_SPI_READY_PIN, PINMUX_OUTEN_RETAIN_HW_CTRL, PINMUX_INPEN_RETAIN_HW_CTRL);
+     Pinmux_Set_FuncSel(MMWDEMO_SPI_READY_PIN, MMWDEMO_SPI_READY_PIN_FUNC);
+
 
      DMA_init();
 
@@ -1531,6 +1661,8 @@ void MmwDemo_mssInitTask(UArg arg0, UArg arg1)
     }
 
 
+    /* The slave is clocked by the host master, 20 MHz and more work with
+     * DMA; every transfer is one MMW_SPI_FRAME_SIZE frame */
     SPI_Params_init(&params);
     params.mode = SPI_SLAVE;
 
@@ -1542,22 +1674,21 @@ void MmwDemo_mssInitTask(UArg arg0, UArg arg1)
     params.frameFormat = SPI_POL0_PHA1;
     params.shiftFormat = SPI_MSB_FIRST;
     params.pinMode = SPI_PINMODE_4PIN_CS;
-    params.transferMode = SPI_MODE_BLOCKING;
+    params.transferMode = SPI_MODE_CALLBACK;
+    params.transferCallbackFxn = MmwDemo_spiCallback;
     params.eccEnable = 1;
     params.csHold = 1;
-    //params.transferCallbackFxn = spiCallback;
 
-    handle = SPI_open(0, &params);
-    if (!handle)
+    gMmwMssMCB.spiHandle = SPI_open(0, &params);
+    if (gMmwMssMCB.spiHandle == NULL)
     {
-        System_printf("SPI did not open \n");
+        System_printf("Error: MMWDemoMSS Unable to open the SPI Instance\n");
+        return;
     }
 
-//        val = SPI_transfer(handle, &spiTransaction);
-//        if (val)
-//        {
-//            System_printf("Sent \n");
-//        }
+    GPIO_setConfig(MMWDEMO_SPI_READY_GPIO, GPIO_CFG_OUTPUT);
+    GPIO_write(MMWDEMO_SPI_READY_GPIO, 0U);
+    MmwDemo_spiFramerInit(&gMmwMssMCB.spiFramer);
 
 
     /*****************************************************************************
@@ -1570,9 +1701,14 @@ void MmwDemo_mssInitTask(UArg arg0, UArg arg1)
     gMmwMssMCB.mboxSemHandle = Semaphore_create(0, &semParams, NULL);
 
 
+    /* Semaphores of the SPI output task */
     Semaphore_Params_init(&semParams);
     semParams.mode = Semaphore_Mode_BINARY;
-    SPISem = Semaphore_create(0, &semParams, NULL);
+    gMmwMssMCB.spiOutSemHandle = Semaphore_create(0, &semParams, NULL);
+
+    Semaphore_Params_init(&semParams);
+    semParams.mode = Semaphore_Mode_BINARY;
+    gMmwMssMCB.spiDoneSemHandle = Semaphore_create(0, &semParams, NULL);
 
 
 
@@ -1698,12 +1834,13 @@ void MmwDemo_mssInitTask(UArg arg0, UArg arg1)
 //    taskParams.stackSize = 3 * 1024;
 //    Task_create(MmwDemo_mssCtrlPathTask, &taskParams, NULL);
 
-    Task_Params_init(&spiTaskParams);
-    spiTaskParams.priority = 4;
-    spiTaskParams.stackSize =  3*1024;
-    Task_create(SPITask,&spiTaskParams, NULL);
-
-    Semaphore_post(SPISem);
+    /*****************************************************************************
+     * Create the task sending the output packets over SPI
+     *****************************************************************************/
+    Task_Params_init(&taskParams);
+    taskParams.priority = 4;
+    taskParams.stackSize = 3 * 1024;
+    Task_create(MmwDemo_spiTask, &taskParams, NULL);
 
     /*****************************************************************************
      * At this point, MSS and DSS are both up and synced. Configuration is ready to be sent.
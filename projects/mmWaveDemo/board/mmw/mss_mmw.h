@@ -47,12 +47,18 @@
 #include <ti/drivers/esm/esm.h>
 #include <ti/drivers/soc/soc.h>
 #include <ti/drivers/mailbox/mailbox.h>
+#include <ti/drivers/spi/SPI.h>
 #include <ti/control/mmwave/mmwave.h>
 
 #include <ti/sysbios/knl/Semaphore.h>
 
 /* MMW Demo Include Files */
 #include <ti/demo/io_interface/mmw_config.h>
+#include "ti/demo/xwr16xx/mmw/common/mmw_messages.h"
+#include "../common/mmw_spi_frame.h"
+#include "../common/mmw_output_ext.h"
+#include "../common/mmw_crc32c.h"
+#include "../common/mmw_tlv_pack.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -91,6 +97,13 @@ extern "C" {
 
 
 
+/*! @brief   GPIO raised while an output frame is armed in the SPI DMA, the
+ *           host master clocks one frame per rising edge.
+ *           NOTE: change the pin according to the EVM used */
+#define MMWDEMO_SPI_READY_GPIO                          SOC_XWR16XX_GPIO_0
+#define MMWDEMO_SPI_READY_PIN                           SOC_XWR16XX_PINH13_PADAH
+#define MMWDEMO_SPI_READY_PIN_FUNC                      SOC_XWR16XX_PINH13_PADAH_GPIO_0
+
 /* All CLI events */
 #define MMWDEMO_CLI_EVENTS                              (MMWDEMO_CLI_SENSORSTART_EVT |    \
                                                          MMWDEMO_CLI_SENSORSTOP_EVT |     \
@@ -138,6 +151,16 @@ typedef struct MmwDemo_MSS_STATS_t
     /*! @brief   Counter which tracks the number of calibration reports received
      *           The event is triggered by an asynchronous event from the BSS */
     uint32_t     numCalibrationReports;
+
+    /*! @brief   Output packets sent over SPI */
+    uint32_t     spiPacketsSent;
+
+    /*! @brief   Output frames sent over SPI */
+    uint32_t     spiFramesSent;
+
+    /*! @brief   SPI transfers which failed to start or complete; the rest
+     *           of the packet is dropped */
+    uint32_t     spiTransferErrors;
 }MmwDemo_MSS_STATS;
 
 /**
@@ -172,6 +195,29 @@ typedef struct MmwDemo_MCB_t
     /*! @brief   Semaphore handle for the mailbox communication */
     Semaphore_Handle            mboxSemHandle;
 
+    /*! @brief   SPI slave carrying the output stream */
+    SPI_Handle                  spiHandle;
+
+    /*! @brief   Posted when an output packet is ready for the SPI task */
+    Semaphore_Handle            spiOutSemHandle;
+
+    /*! @brief   Posted by the SPI callback when a frame was clocked out */
+    Semaphore_Handle            spiDoneSemHandle;
+
+    /*! @brief   Detected objects message being sent over SPI */
+    MmwDemo_message             spiOutMsg;
+
+    /*! @brief   Frames the output packets for SPI */
+    MmwDemo_spiFramer           spiFramer;
+
+    /*! @brief   MSS counters TLV appended to the packet being sent */
+    MmwDemo_output_message_tl       spiMssStatsTl;
+    MmwDemo_output_message_mssStats spiMssStats;
+
+    /*! @brief   CRC TLV appended to the packet being sent */
+    MmwDemo_output_message_tl           spiCrcTl;
+    MmwDemo_output_message_packetCrc    spiCrc;
+
     /*! @brief   MSS system event handle */
     Event_Handle                eventHandle;
 
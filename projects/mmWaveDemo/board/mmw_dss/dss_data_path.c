@@ -91,6 +91,7 @@
 
 #include "dss_data_path.h"
 #include "dss_config_edma_util.h"
+#include "../common/mmw_output_ext.h"
 
 /* If the the following EDMA defines are commented out, the EDMA transfer completion is
    is implemented using polling apporach, Otherwise, if these defines are defined, the EDMA transfers 
@@ -1685,6 +1686,25 @@ void MmwDemo_interFrameProcessing(MmwDemo_DSS_DataPathObj *obj)
     /* initialize the  variable that keeps track of the number of objects detected */
     numDetObj1D = 0;
     MmwDemo_resetDopplerLines(&obj->detDopplerLines);
+
+    if (obj->rdHeatMapMode & MMWDEMO_GUIMON_RD_HEATMAP_COMPRESSED)
+    {
+        MmwDemo_rdHeatMapEncodeStart(&obj->rdHeatMapEnc);
+    }
+    if (obj->rdHeatMapMode & MMWDEMO_GUIMON_RD_HEATMAP_SPARSE)
+    {
+        MmwDemo_rdHeatMapSparseStart(&obj->rdHeatMapSparseEnc, obj->rdHeatMapSparseCfg.margin);
+    }
+    if (obj->rangeProfileMode & MMWDEMO_GUIMON_PROFILE_DELTA)
+    {
+        MmwDemo_profileDeltaStart(&obj->rangeProfileDeltaEnc, obj->profileDeltaCfg.keyframeInterval,
+                                  obj->profileDeltaCfg.rangeTolerance);
+    }
+    if (obj->noiseProfileMode & MMWDEMO_GUIMON_PROFILE_DELTA)
+    {
+        MmwDemo_profileDeltaStart(&obj->noiseProfileDeltaEnc, obj->profileDeltaCfg.keyframeInterval,
+                                  obj->profileDeltaCfg.noiseTolerance);
+    }
     for (rangeIdx = 0; rangeIdx < obj->numRangeBins; rangeIdx++)
     {
         /* 2nd Dimension FFT is done here */
@@ -1778,6 +1798,43 @@ void MmwDemo_interFrameProcessing(MmwDemo_DSS_DataPathObj *obj)
 
         /* populate the pre-detection matrix */
         EDMA_startDmaTransfer(obj->edmaHandle[EDMA_INSTANCE_A], MMW_EDMA_CH_DET_MATRIX);
+
+        /* encode the line from sumAbs while EDMA writes it out to detMatrix */
+        if (obj->rdHeatMapMode & MMWDEMO_GUIMON_RD_HEATMAP_COMPRESSED)
+        {
+            MmwDemo_rdHeatMapEncodeLine(&obj->rdHeatMapEnc, obj->sumAbs);
+        }
+        if (obj->rdHeatMapMode & MMWDEMO_GUIMON_RD_HEATMAP_SPARSE)
+        {
+            MmwDemo_rdHeatMapSparseEncodeLine(&obj->rdHeatMapSparseEnc, obj->sumAbs);
+        }
+
+        /* the profiles are the zero Doppler bin and the noise bin of the line */
+        if (obj->rangeProfileMode & MMWDEMO_GUIMON_PROFILE_DELTA)
+        {
+            MmwDemo_profileDeltaEncode(&obj->rangeProfileDeltaEnc, obj->sumAbs[0]);
+        }
+        if (obj->noiseProfileMode & MMWDEMO_GUIMON_PROFILE_DELTA)
+        {
+            MmwDemo_profileDeltaEncode(&obj->noiseProfileDeltaEnc, obj->sumAbs[obj->numDopplerBins/2 - 1]);
+        }
+    }
+
+    if (obj->rdHeatMapMode & MMWDEMO_GUIMON_RD_HEATMAP_COMPRESSED)
+    {
+        obj->rdHeatMapCompressedLen = MmwDemo_rdHeatMapEncodeFinish(&obj->rdHeatMapEnc);
+    }
+    if (obj->rdHeatMapMode & MMWDEMO_GUIMON_RD_HEATMAP_SPARSE)
+    {
+        obj->rdHeatMapSparseLen = MmwDemo_rdHeatMapSparseFinish(&obj->rdHeatMapSparseEnc);
+    }
+    if (obj->rangeProfileMode & MMWDEMO_GUIMON_PROFILE_DELTA)
+    {
+        obj->rangeProfileDeltaLen = MmwDemo_profileDeltaFinish(&obj->rangeProfileDeltaEnc);
+    }
+    if (obj->noiseProfileMode & MMWDEMO_GUIMON_PROFILE_DELTA)
+    {
+        obj->noiseProfileDeltaLen = MmwDemo_profileDeltaFinish(&obj->noiseProfileDeltaEnc);
     }
 
     startTimeWait = Cycleprofiler_getTimeStamp();
@@ -2027,11 +2084,113 @@ void MmwDemo_interFrameProcessing(MmwDemo_DSS_DataPathObj *obj)
             MmwDemo_Yestimation(obj, detIdx2);
         }
     }
+
+    /* Angle spectrum of the static scene, reuses the now idle azimuth FFT buffers */
+    if ((obj->raHeatMapMode & MMWDEMO_GUIMON_RA_HEATMAP_MAGNITUDE) && (obj->numVirtualAntAzim > 1))
+    {
+        MmwDemo_azimuthHeatMapMagnitude(obj);
+    }
     gCycleLog.interFrameProcessingTime += Cycleprofiler_getTimeStamp() - startTime - waitingTime;
     gCycleLog.interFrameWaitTime += waitingTime;
 
 }
 
+/**
+ *  @b Description
+ *  @n
+ *    Computes the range/azimuth magnitude heat map from the zero Doppler
+ *    antenna samples in azimuthStaticHeatMap, see mmw_azimuth_heatmap.h for
+ *    the output format. Fewer than 16 angle bins are taken from every other
+ *    bin of a 16 point FFT, since DSP_fft32x32 needs at least 16 points.
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_azimuthHeatMapMagnitude(MmwDemo_DSS_DataPathObj *obj)
+{
+    MmwDemo_azimuthHeatMapHdr hdr;
+    uint32_t numBins = obj->azimuthHeatMapCfg.numAngleBins;
+    uint32_t fftSize = (numBins < 16U) ? 16U : numBins;
+    uint32_t decim = fftSize / numBins;
+    uint32_t numAnt = obj->numVirtualAntAzim;
+    uint32_t antStride = obj->numRxAntennas * obj->numTxAntennas;
+    uint8_t  *outU8 = obj->azimuthHeatMapMag + sizeof(MmwDemo_azimuthHeatMapHdr);
+    uint16_t *outU16 = (uint16_t *) outU8;
+    cmplx16ImRe_t *samples;
+    float    invNumAnt;
+    float    val;
+    uint32_t rangeIdx, antIdx, k, src;
+
+    if ((numBins < MMW_AZIMUTH_HEATMAP_MIN_BINS) || (numBins > obj->numAngleBins) ||
+        ((numBins & (numBins - 1U)) != 0U) ||
+        (obj->azimuthHeatMapCfg.format > MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG))
+    {
+        obj->azimuthHeatMapMagLen = -1;
+        return;
+    }
+
+    /* Twiddles are generated here, not in the mailbox task, so a new
+     * configuration never races with the processing of a frame */
+    if (obj->azimuthHeatMapTwiddleSize != fftSize)
+    {
+        gen_twiddle_fft32x32((int32_t *)obj->azimuthHeatMapTwiddle32x32, fftSize, 2147483647.5);
+        obj->azimuthHeatMapTwiddleSize = fftSize;
+    }
+
+    invNumAnt = divsp(1.0f, (float) numAnt);
+    memset((void *) obj->azimuthIn, 0, fftSize * sizeof(cmplx32ReIm_t));
+    for (rangeIdx = 0; rangeIdx < obj->numRangeBins; rangeIdx++)
+    {
+        samples = &obj->azimuthStaticHeatMap[rangeIdx * antStride];
+        for (antIdx = 0; antIdx < numAnt; antIdx++)
+        {
+            obj->azimuthIn[antIdx].real = samples[antIdx].real;
+            obj->azimuthIn[antIdx].imag = samples[antIdx].imag;
+        }
+
+        DSP_fft32x32(
+            (int32_t *)obj->azimuthHeatMapTwiddle32x32,
+            fftSize,
+            (int32_t *) obj->azimuthIn,
+            (int32_t *) obj->azimuthOut);
+
+        MmwDemo_magnitudeSquared(
+            obj->azimuthOut,
+            obj->azimuthMagSqr,
+            fftSize);
+
+        /* FFT shift, negative angles first */
+        if (obj->azimuthHeatMapCfg.format == MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG)
+        {
+            for (k = 0; k < numBins; k++)
+            {
+                src = ((k + numBins/2U) & (numBins - 1U)) * decim;
+                val = 4.0f * log2sp(1.0f + obj->azimuthMagSqr[src]) + 0.5f;
+                *outU8++ = (uint8_t) ((val > 255.0f) ? 255.0f : val);
+            }
+        }
+        else
+        {
+            for (k = 0; k < numBins; k++)
+            {
+                src = ((k + numBins/2U) & (numBins - 1U)) * decim;
+                val = sqrtsp(obj->azimuthMagSqr[src]) * invNumAnt + 0.5f;
+                *outU16++ = (uint16_t) ((val > 65535.0f) ? 65535.0f : val);
+            }
+        }
+    }
+
+    hdr.numRangeBins = (uint16_t) obj->numRangeBins;
+    hdr.numAngleBins = (uint16_t) numBins;
+    hdr.format = obj->azimuthHeatMapCfg.format;
+    hdr.version = MMW_AZIMUTH_HEATMAP_VERSION;
+    hdr.numVirtualAnt = (uint16_t) numAnt;
+    memcpy((void *) obj->azimuthHeatMapMag, (void *) &hdr, sizeof(hdr));
+
+    obj->azimuthHeatMapMagLen = (int32_t) (sizeof(hdr) + obj->numRangeBins * numBins *
+        ((hdr.format == MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG) ? sizeof(uint8_t) : sizeof(uint16_t)));
+}
+
 
 /**
  *  @b Description
@@ -2480,10 +2639,15 @@ void MmwDemo_dataPathConfigBuffers(MmwDemo_DSS_DataPathObj *obj, uint32_t adcBuf
         azimuthModCoefs_end, MMWDEMO_MEMORY_ALLOC_DOUBLE_WORD_ALIGN,
         SOC_MAX_NUM_TX_ANTENNAS * SOC_MAX_NUM_RX_ANTENNAS * DC_RANGE_SIGNATURE_COMP_MAX_BIN_SIZE);
 
+    MMW_ALLOC_BUF(azimuthHeatMapTwiddle32x32, cmplx32ReIm_t,
+        dcRangeSigMean_end, MMWDEMO_MEMORY_ALLOC_DOUBLE_WORD_ALIGN,
+        obj->numAngleBins);
+    obj->azimuthHeatMapTwiddleSize = 0;
+
 #ifdef NO_OVERLAY
     heapUsed = prev_end - heapL2start;
 #else        
-    heapUsed = dcRangeSigMean_end - heapL2start;
+    heapUsed = azimuthHeatMapTwiddle32x32_end - heapL2start;
 #endif
     DebugP_assert(heapUsed <= MMW_L2_HEAP_SIZE);
     MmwDemo_printHeapStats("L2", heapUsed, MMW_L2_HEAP_SIZE);    
@@ -2492,7 +2656,12 @@ void MmwDemo_dataPathConfigBuffers(MmwDemo_DSS_DataPathObj *obj, uint32_t adcBuf
         ADCdataBuf (for unit test) +
         radarCube +
         azimuthStaticHeatMap +
-        detMatrix
+        detMatrix +
+        rdHeatMapCompressed +
+        rdHeatMapSparse +
+        azimuthHeatMapMag +
+        rangeProfileDelta + rangeProfileDeltaRef +
+        noiseProfileDelta + noiseProfileDeltaRef
     */
 #ifdef NO_OVERLAY
     prev_end = heapL3start;
@@ -2521,10 +2690,63 @@ void MmwDemo_dataPathConfigBuffers(MmwDemo_DSS_DataPathObj *obj, uint32_t adcBuf
         azimuthStaticHeatMap_end, sizeof(uint16_t), 
         obj->numRangeBins * obj->numDopplerBins);
 
+    obj->rdHeatMapCompressedSize = MMW_HEATMAP_CODEC_MAX_SIZE(obj->numRangeBins, obj->numDopplerBins);
+    MMW_ALLOC_BUF(rdHeatMapCompressed, uint8_t,
+        detMatrix_end, MMWDEMO_MEMORY_ALLOC_DOUBLE_WORD_ALIGN,
+        obj->rdHeatMapCompressedSize);
+    obj->rdHeatMapCompressedLen = -1;
+    MmwDemo_rdHeatMapEncoderConfig(&obj->rdHeatMapEnc,
+                                   obj->rdHeatMapCompressed,
+                                   obj->rdHeatMapCompressedSize,
+                                   (uint16_t) obj->numDopplerBins);
+
+    MMW_ALLOC_BUF(rdHeatMapSparse, uint8_t,
+        rdHeatMapCompressed_end, MMWDEMO_MEMORY_ALLOC_DOUBLE_WORD_ALIGN,
+        MMW_HEATMAP_SPARSE_MAX_SIZE(obj->numRangeBins, obj->numDopplerBins));
+    obj->rdHeatMapSparseLen = -1;
+    MmwDemo_rdHeatMapSparseConfig(&obj->rdHeatMapSparseEnc,
+                                  obj->rdHeatMapSparse,
+                                  MMW_HEATMAP_SPARSE_MAX_SIZE(obj->numRangeBins, obj->numDopplerBins),
+                                  (uint16_t) obj->numRangeBins,
+                                  (uint16_t) obj->numDopplerBins);
+
+    MMW_ALLOC_BUF(azimuthHeatMapMag, uint8_t,
+        rdHeatMapSparse_end, MMWDEMO_MEMORY_ALLOC_DOUBLE_WORD_ALIGN,
+        sizeof(MmwDemo_azimuthHeatMapHdr) + obj->numRangeBins * obj->numAngleBins * sizeof(uint16_t));
+    obj->azimuthHeatMapMagLen = -1;
+
+    MMW_ALLOC_BUF(rangeProfileDelta, uint8_t,
+        azimuthHeatMapMag_end, MMWDEMO_MEMORY_ALLOC_DOUBLE_WORD_ALIGN,
+        MMW_PROFILE_DELTA_MAX_SIZE(obj->numRangeBins));
+    MMW_ALLOC_BUF(rangeProfileDeltaRef, uint16_t,
+        rangeProfileDelta_end, MMWDEMO_MEMORY_ALLOC_DOUBLE_WORD_ALIGN,
+        2U * obj->numRangeBins);
+    obj->rangeProfileDeltaLen = -1;
+    MmwDemo_profileDeltaConfig(&obj->rangeProfileDeltaEnc,
+                               obj->rangeProfileDelta,
+                               MMW_PROFILE_DELTA_MAX_SIZE(obj->numRangeBins),
+                               obj->rangeProfileDeltaRef,
+                               &obj->rangeProfileDeltaRef[obj->numRangeBins],
+                               (uint16_t) obj->numRangeBins);
+
+    MMW_ALLOC_BUF(noiseProfileDelta, uint8_t,
+        rangeProfileDeltaRef_end, MMWDEMO_MEMORY_ALLOC_DOUBLE_WORD_ALIGN,
+        MMW_PROFILE_DELTA_MAX_SIZE(obj->numRangeBins));
+    MMW_ALLOC_BUF(noiseProfileDeltaRef, uint16_t,
+        noiseProfileDelta_end, MMWDEMO_MEMORY_ALLOC_DOUBLE_WORD_ALIGN,
+        2U * obj->numRangeBins);
+    obj->noiseProfileDeltaLen = -1;
+    MmwDemo_profileDeltaConfig(&obj->noiseProfileDeltaEnc,
+                               obj->noiseProfileDelta,
+                               MMW_PROFILE_DELTA_MAX_SIZE(obj->numRangeBins),
+                               obj->noiseProfileDeltaRef,
+                               &obj->noiseProfileDeltaRef[obj->numRangeBins],
+                               (uint16_t) obj->numRangeBins);
+
 #ifdef NO_OVERLAY
     heapUsed = prev_end - heapL3start;
 #else
-    heapUsed = detMatrix_end - heapL3start;
+    heapUsed = noiseProfileDeltaRef_end - heapL3start;
 #endif
     DebugP_assert(heapUsed <= SOC_XWR16XX_DSS_L3RAM_SIZE);
     MmwDemo_printHeapStats("L3", heapUsed, SOC_XWR16XX_DSS_L3RAM_SIZE);
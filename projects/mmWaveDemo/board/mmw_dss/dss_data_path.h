@@ -48,6 +48,12 @@
 #include <ti/drivers/edma/edma.h>
 #include <ti/demo/io_interface/detected_obj.h>
 
+#include "../common/mmw_heatmap_codec.h"
+#include "../common/mmw_heatmap_sparse.h"
+#include "../common/mmw_profile_delta.h"
+#include "../common/mmw_messages_ext.h"
+#include "../common/mmw_azimuth_heatmap.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -296,6 +302,91 @@ typedef struct MmwDemo_DSS_DataPathObj_t
      * for static azimuth heat map */
     cmplx16ImRe_t *azimuthStaticHeatMap;
 
+    /*! @brief Range/azimuth heat map output selection, MMWDEMO_GUIMON_RA_HEATMAP_xxx bits */
+    uint8_t raHeatMapMode;
+
+    /*! @brief Range/azimuth magnitude heat map configuration */
+    MmwDemo_AzimuthHeatMapCfg azimuthHeatMapCfg;
+
+    /*! @brief twiddle factors table for the magnitude heat map angle FFT */
+    cmplx32ReIm_t *azimuthHeatMapTwiddle32x32;
+
+    /*! @brief FFT size azimuthHeatMapTwiddle32x32 was generated for, 0 if none */
+    uint32_t azimuthHeatMapTwiddleSize;
+
+    /*! @brief Pointer to range/azimuth magnitude heat map in L3 RAM */
+    uint8_t *azimuthHeatMapMag;
+
+    /*! @brief Length of the magnitude heat map of the last frame, <0 if
+     *         the configuration is not supported */
+    int32_t azimuthHeatMapMagLen;
+
+    /*! @brief Range/Doppler heat map output selection, MMWDEMO_GUIMON_RD_HEATMAP_xxx bits */
+    uint8_t rdHeatMapMode;
+
+    /*! @brief Pointer to compressed range/Doppler heat map in L3 RAM */
+    uint8_t *rdHeatMapCompressed;
+
+    /*! @brief Size of the compressed heat map buffer in bytes */
+    uint32_t rdHeatMapCompressedSize;
+
+    /*! @brief Length of the compressed heat map of the last frame, <0 if
+     *         encoding failed */
+    int32_t rdHeatMapCompressedLen;
+
+    /*! @brief Heat map encoder state */
+    MmwDemo_rdHeatMapEncoder rdHeatMapEnc;
+
+    /*! @brief Pointer to sparse range/Doppler heat map in L3 RAM */
+    uint8_t *rdHeatMapSparse;
+
+    /*! @brief Length of the sparse heat map of the last frame, <0 if
+     *         encoding failed */
+    int32_t rdHeatMapSparseLen;
+
+    /*! @brief Sparse heat map configuration */
+    MmwDemo_RdHeatMapSparseCfg rdHeatMapSparseCfg;
+
+    /*! @brief Sparse heat map encoder state */
+    MmwDemo_rdHeatMapSparseEncoder rdHeatMapSparseEnc;
+
+    /*! @brief Range profile output selection, MMWDEMO_GUIMON_PROFILE_xxx bits */
+    uint8_t rangeProfileMode;
+
+    /*! @brief Noise profile output selection, MMWDEMO_GUIMON_PROFILE_xxx bits */
+    uint8_t noiseProfileMode;
+
+    /*! @brief Delta coded profile configuration */
+    MmwDemo_ProfileDeltaCfg profileDeltaCfg;
+
+    /*! @brief Pointer to delta coded range profile in L3 RAM */
+    uint8_t *rangeProfileDelta;
+
+    /*! @brief Length of the delta coded range profile of the last frame,
+     *         <0 if encoding failed */
+    int32_t rangeProfileDeltaLen;
+
+    /*! @brief Reference profiles of the range profile encoder in L3 RAM,
+     *         2 x numRangeBins */
+    uint16_t *rangeProfileDeltaRef;
+
+    /*! @brief Range profile encoder state */
+    MmwDemo_profileDeltaEncoder rangeProfileDeltaEnc;
+
+    /*! @brief Pointer to delta coded noise profile in L3 RAM */
+    uint8_t *noiseProfileDelta;
+
+    /*! @brief Length of the delta coded noise profile of the last frame,
+     *         <0 if encoding failed */
+    int32_t noiseProfileDeltaLen;
+
+    /*! @brief Reference profiles of the noise profile encoder in L3 RAM,
+     *         2 x numRangeBins */
+    uint16_t *noiseProfileDeltaRef;
+
+    /*! @brief Noise profile encoder state */
+    MmwDemo_profileDeltaEncoder noiseProfileDeltaEnc;
+
     /*! @brief noise energy */
     uint32_t noiseEnergy;
 
@@ -494,6 +585,17 @@ void MmwDemo_processChirp(MmwDemo_DSS_DataPathObj *obj);
  */
 void MmwDemo_interFrameProcessing(MmwDemo_DSS_DataPathObj *obj);
 
+/**
+ *  @b Description
+ *  @n
+ *    Computes the range/azimuth magnitude heat map from the zero Doppler
+ *    antenna samples of the last frame.
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void MmwDemo_azimuthHeatMapMagnitude(MmwDemo_DSS_DataPathObj *obj);
+
 /**
  *  @b Description
  *  @n
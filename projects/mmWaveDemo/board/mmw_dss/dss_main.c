@@ -77,9 +77,12 @@
 #include <ti/utils/cycleprofiler/cycle_profiler.h>
 
 /* MMWAVE Demo Include Files */
-#include <ti/demo/xwr16xx/mmw/dss/dss_mmw.h>
-#include <ti/demo/xwr16xx/mmw/dss/dss_data_path.h>
+#include "dss_mmw.h"
+#include "dss_data_path.h"
 #include <ti/demo/xwr16xx/mmw/common/mmw_messages.h>
+#include "../common/mmw_output_ext.h"
+#include "../common/mmw_messages_ext.h"
+#include "../common/mmw_tlv_pack.h"
 
 /* C674x mathlib */
 #include <ti/mathlib/mathlib.h>
@@ -114,6 +117,29 @@ void *gHSRam;
 
 #define MMWDEMO_SPEED_OF_LIGHT_IN_METERS_PER_SEC (3.0e8)
 
+/**
+ * @brief
+ *  TLVs of a packet as items of the output scheduler
+ */
+typedef enum MmwDemo_outputSchedIdx_e
+{
+    MMWDEMO_OUTPUT_SCHED_DETECTED_POINTS = 0,
+    MMWDEMO_OUTPUT_SCHED_RANGE_PROFILE,
+    MMWDEMO_OUTPUT_SCHED_NOISE_PROFILE,
+    MMWDEMO_OUTPUT_SCHED_RANGE_PROFILE_DELTA,
+    MMWDEMO_OUTPUT_SCHED_NOISE_PROFILE_DELTA,
+    MMWDEMO_OUTPUT_SCHED_AZIMUTH_STATIC,
+    MMWDEMO_OUTPUT_SCHED_RD_DENSE,
+    MMWDEMO_OUTPUT_SCHED_RD_COMPRESSED,
+    MMWDEMO_OUTPUT_SCHED_RD_SPARSE,
+    MMWDEMO_OUTPUT_SCHED_AZIMUTH_MAGNITUDE,
+    MMWDEMO_OUTPUT_SCHED_STATS,
+    MMWDEMO_OUTPUT_SCHED_DSS_STATS,
+    MMWDEMO_OUTPUT_SCHED_OUTPUT_SHED,
+    MMWDEMO_OUTPUT_SCHED_QUIET,
+    MMWDEMO_OUTPUT_SCHED_NUM_ITEMS
+} MmwDemo_outputSchedIdx;
+
 //#define DBG
 
 /**
@@ -162,7 +188,15 @@ static int32_t MmwDemo_dssSendProcessOutputToMSS
 (
     uint8_t           *ptrHsmBuffer,
     uint32_t           outputBufSize,
-    MmwDemo_DSS_DataPathObj   *obj
+    MmwDemo_DSS_DataPathObj   *obj,
+    uint32_t           quietDecision
+);
+static void MmwDemo_dssOutputSchedule
+(
+    MmwDemo_DSS_DataPathObj     *obj,
+    bool                        isDeviceStatsDue,
+    uint32_t                    quietDecision,
+    MmwDemo_outputSchedResult   *result
 );
 void MmwDemo_dssDataPathOutputLogging(    MmwDemo_DSS_DataPathObj   * dataPathObj);
 
@@ -514,6 +548,10 @@ static void MmwDemo_mboxReadTask(UArg arg0, UArg arg1)
                 {
                     /* Save guimon configuration */
                     memcpy((void *)&gMmwDssMCB.cfg.guiMonSel, (void *)&message.body.guiMonSel, sizeof(MmwDemo_GuiMonSel));
+                    gMmwDssMCB.dataPathObj.rdHeatMapMode = message.body.guiMonSel.rangeDopplerHeatMap;
+                    gMmwDssMCB.dataPathObj.raHeatMapMode = message.body.guiMonSel.rangeAzimuthHeatMap;
+                    gMmwDssMCB.dataPathObj.rangeProfileMode = message.body.guiMonSel.logMagRange;
+                    gMmwDssMCB.dataPathObj.noiseProfileMode = message.body.guiMonSel.noiseProfile;
                     break;
                 }
                 case MMWDEMO_MSS2DSS_CFAR_RANGE_CFG:
@@ -567,6 +605,44 @@ static void MmwDemo_mboxReadTask(UArg arg0, UArg arg1)
                     }
                     break;
                 }
+                case MMWDEMO_MSS2DSS_RD_HEATMAP_SPARSE_CFG:
+                {
+                    /* Save sparse heat map configuration, used from the next frame on */
+                    memcpy((void *)&gMmwDssMCB.dataPathObj.rdHeatMapSparseCfg,
+                           (void *)&message.body, sizeof(MmwDemo_RdHeatMapSparseCfg));
+                    break;
+                }
+                case MMWDEMO_MSS2DSS_AZIMUTH_HEATMAP_CFG:
+                {
+                    /* Save magnitude heat map configuration, used from the next frame on */
+                    memcpy((void *)&gMmwDssMCB.dataPathObj.azimuthHeatMapCfg,
+                           (void *)&message.body, sizeof(MmwDemo_AzimuthHeatMapCfg));
+                    break;
+                }
+                case MMWDEMO_MSS2DSS_OUTPUT_BUDGET_CFG:
+                {
+                    /* Save output link budget; the credits start over */
+                    memcpy((void *)&gMmwDssMCB.outputBudgetCfg,
+                           (void *)&message.body, sizeof(MmwDemo_OutputBudgetCfg));
+                    MmwDemo_outputSchedInit(&gMmwDssMCB.outputSched);
+                    break;
+                }
+                case MMWDEMO_MSS2DSS_QUIET_MODE_CFG:
+                {
+                    /* Start the quiet mode over: the next frame goes out in full */
+                    MmwDemo_QuietModeCfg quietCfg;
+                    memcpy((void *)&quietCfg, (void *)&message.body, sizeof(MmwDemo_QuietModeCfg));
+                    MmwDemo_quietModeInit(&gMmwDssMCB.quietMode, quietCfg.enabled,
+                                          quietCfg.rangeThreshold, quietCfg.keepAliveFrames);
+                    break;
+                }
+                case MMWDEMO_MSS2DSS_PROFILE_DELTA_CFG:
+                {
+                    /* Save delta profile configuration, used from the next frame */
+                    memcpy((void *)&gMmwDssMCB.dataPathObj.profileDeltaCfg,
+                           (void *)&message.body, sizeof(MmwDemo_ProfileDeltaCfg));
+                    break;
+                }
                 case MMWDEMO_MSS2DSS_SET_DATALOGGER:
                 {
                     gMmwDssMCB.cfg.dataLogger = message.body.dataLogger;
@@ -610,6 +686,174 @@ void MmwDemo_mboxCallback
 
 
 
+/**
+ *  @b Description
+ *  @n
+ *      Lists the TLVs selected for the frame and lets the output scheduler
+ *      pick those fitting the link budget (outputBudgetCfg) and the TLV
+ *      slots of the message. Without a budget only the slots limit.
+ *      A quiet mode heartbeat carries the quiet report and the device
+ *      counters only.
+ *
+ *  @param[in]  obj
+ *      Handle to the Data Path Object
+ *  @param[in]  isDeviceStatsDue
+ *      The packet carries the device counters
+ *  @param[in]  quietDecision
+ *      MMW_QUIET_MODE_SEND_FULL or MMW_QUIET_MODE_SEND_HEARTBEAT
+ *  @param[out] result
+ *      Selection, sendMask bit MMWDEMO_OUTPUT_SCHED_xxx for each TLV
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void MmwDemo_dssOutputSchedule
+(
+    MmwDemo_DSS_DataPathObj     *obj,
+    bool                        isDeviceStatsDue,
+    uint32_t                    quietDecision,
+    MmwDemo_outputSchedResult   *result
+)
+{
+    MmwDemo_outputSchedItem items[MMWDEMO_OUTPUT_SCHED_NUM_ITEMS];
+    MmwDemo_GuiMonSel       *pGuiMonSel = &gMmwDssMCB.cfg.guiMonSel;
+    MmwDemo_OutputBudgetCfg *budgetCfg = &gMmwDssMCB.outputBudgetCfg;
+    uint32_t                framePeriodUs;
+    uint32_t                extraLen;
+    uint32_t                i;
+
+    memset((void *)items, 0, sizeof(items));
+
+    /* The MSS appends the packet CRC to every packet, outside the slots */
+    extraLen = MMWDEMO_WIRE_TLV_HEADER_LEN + MMWDEMO_TLV_PACKET_CRC_LEN;
+
+    /* Mandatory: objects and stats */
+    items[MMWDEMO_OUTPUT_SCHED_DETECTED_POINTS].type = MMWDEMO_OUTPUT_MSG_DETECTED_POINTS;
+    items[MMWDEMO_OUTPUT_SCHED_DETECTED_POINTS].isMandatory = 1;
+    if ((pGuiMonSel->detectedObjects == 1) && (obj->numDetObj > 0))
+    {
+        items[MMWDEMO_OUTPUT_SCHED_DETECTED_POINTS].length = MMWDEMO_TLV_DETECTED_POINTS_LEN(obj->numDetObj);
+    }
+
+    items[MMWDEMO_OUTPUT_SCHED_STATS].type = MMWDEMO_OUTPUT_MSG_STATS;
+    items[MMWDEMO_OUTPUT_SCHED_STATS].isMandatory = 1;
+    if (pGuiMonSel->statsInfo & MMWDEMO_GUIMON_STATS_TIMING)
+    {
+        items[MMWDEMO_OUTPUT_SCHED_STATS].length = MMWDEMO_TLV_STATS_LEN;
+    }
+
+    items[MMWDEMO_OUTPUT_SCHED_DSS_STATS].type = MMWDEMO_OUTPUT_MSG_DSS_STATS;
+    items[MMWDEMO_OUTPUT_SCHED_DSS_STATS].isMandatory = 1;
+    if (isDeviceStatsDue)
+    {
+        items[MMWDEMO_OUTPUT_SCHED_DSS_STATS].length = MMWDEMO_TLV_DSS_STATS_LEN;
+
+        /* The MSS counters are appended by the MSS and take no slot here */
+        extraLen += MMWDEMO_WIRE_TLV_HEADER_LEN + MMWDEMO_TLV_MSS_STATS_LEN;
+    }
+
+    /* Optional, lower priority values go first: profiles, then the heat
+     * maps from the cheapest encoding to the raw ones */
+    items[MMWDEMO_OUTPUT_SCHED_RANGE_PROFILE].type = MMWDEMO_OUTPUT_MSG_RANGE_PROFILE;
+    items[MMWDEMO_OUTPUT_SCHED_RANGE_PROFILE].priority = 0;
+    if (pGuiMonSel->logMagRange & MMWDEMO_GUIMON_PROFILE_PLAIN)
+    {
+        items[MMWDEMO_OUTPUT_SCHED_RANGE_PROFILE].length = sizeof(uint16_t) * obj->numRangeBins;
+    }
+
+    items[MMWDEMO_OUTPUT_SCHED_RANGE_PROFILE_DELTA].type = MMWDEMO_OUTPUT_MSG_RANGE_PROFILE_DELTA;
+    items[MMWDEMO_OUTPUT_SCHED_RANGE_PROFILE_DELTA].priority = 0;
+    if ((pGuiMonSel->logMagRange & MMWDEMO_GUIMON_PROFILE_DELTA) && (obj->rangeProfileDeltaLen > 0))
+    {
+        items[MMWDEMO_OUTPUT_SCHED_RANGE_PROFILE_DELTA].length = (uint32_t) obj->rangeProfileDeltaLen;
+    }
+
+    items[MMWDEMO_OUTPUT_SCHED_NOISE_PROFILE].type = MMWDEMO_OUTPUT_MSG_NOISE_PROFILE;
+    items[MMWDEMO_OUTPUT_SCHED_NOISE_PROFILE].priority = 1;
+    if (pGuiMonSel->noiseProfile & MMWDEMO_GUIMON_PROFILE_PLAIN)
+    {
+        items[MMWDEMO_OUTPUT_SCHED_NOISE_PROFILE].length = sizeof(uint16_t) * obj->numRangeBins;
+    }
+
+    items[MMWDEMO_OUTPUT_SCHED_NOISE_PROFILE_DELTA].type = MMWDEMO_OUTPUT_MSG_NOISE_PROFILE_DELTA;
+    items[MMWDEMO_OUTPUT_SCHED_NOISE_PROFILE_DELTA].priority = 1;
+    if ((pGuiMonSel->noiseProfile & MMWDEMO_GUIMON_PROFILE_DELTA) && (obj->noiseProfileDeltaLen > 0))
+    {
+        items[MMWDEMO_OUTPUT_SCHED_NOISE_PROFILE_DELTA].length = (uint32_t) obj->noiseProfileDeltaLen;
+    }
+
+    items[MMWDEMO_OUTPUT_SCHED_RD_SPARSE].type = MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_SPARSE;
+    items[MMWDEMO_OUTPUT_SCHED_RD_SPARSE].priority = 2;
+    if ((pGuiMonSel->rangeDopplerHeatMap & MMWDEMO_GUIMON_RD_HEATMAP_SPARSE) && (obj->rdHeatMapSparseLen > 0))
+    {
+        items[MMWDEMO_OUTPUT_SCHED_RD_SPARSE].length = (uint32_t) obj->rdHeatMapSparseLen;
+    }
+
+    items[MMWDEMO_OUTPUT_SCHED_RD_COMPRESSED].type = MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP_COMPRESSED;
+    items[MMWDEMO_OUTPUT_SCHED_RD_COMPRESSED].priority = 3;
+    if ((pGuiMonSel->rangeDopplerHeatMap & MMWDEMO_GUIMON_RD_HEATMAP_COMPRESSED) && (obj->rdHeatMapCompressedLen > 0))
+    {
+        items[MMWDEMO_OUTPUT_SCHED_RD_COMPRESSED].length = (uint32_t) obj->rdHeatMapCompressedLen;
+    }
+
+    items[MMWDEMO_OUTPUT_SCHED_AZIMUTH_MAGNITUDE].type = MMWDEMO_OUTPUT_MSG_AZIMUTH_HEAT_MAP_MAGNITUDE;
+    items[MMWDEMO_OUTPUT_SCHED_AZIMUTH_MAGNITUDE].priority = 4;
+    if ((pGuiMonSel->rangeAzimuthHeatMap & MMWDEMO_GUIMON_RA_HEATMAP_MAGNITUDE) && (obj->azimuthHeatMapMagLen > 0))
+    {
+        items[MMWDEMO_OUTPUT_SCHED_AZIMUTH_MAGNITUDE].length = (uint32_t) obj->azimuthHeatMapMagLen;
+    }
+
+    items[MMWDEMO_OUTPUT_SCHED_AZIMUTH_STATIC].type = MMWDEMO_OUTPUT_MSG_AZIMUT_STATIC_HEAT_MAP;
+    items[MMWDEMO_OUTPUT_SCHED_AZIMUTH_STATIC].priority = 5;
+    if (pGuiMonSel->rangeAzimuthHeatMap & MMWDEMO_GUIMON_RA_HEATMAP_SAMPLES)
+    {
+        items[MMWDEMO_OUTPUT_SCHED_AZIMUTH_STATIC].length = obj->numRangeBins * obj->numVirtualAntAzim *
+                                                            sizeof(cmplx16ImRe_t);
+    }
+
+    items[MMWDEMO_OUTPUT_SCHED_RD_DENSE].type = MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP;
+    items[MMWDEMO_OUTPUT_SCHED_RD_DENSE].priority = 6;
+    if (pGuiMonSel->rangeDopplerHeatMap & MMWDEMO_GUIMON_RD_HEATMAP_DENSE)
+    {
+        items[MMWDEMO_OUTPUT_SCHED_RD_DENSE].length = obj->numRangeBins * obj->numDopplerBins * sizeof(uint16_t);
+    }
+
+    /* framePeriodicity is in 5 ns units */
+    framePeriodUs = gMmwDssMCB.cfg.ctrlCfg.u.fullControlCfg.u.chirpModeCfg.frameCfg.framePeriodicity / 200U;
+    gMmwDssMCB.outputSched.budgetBytes = MmwDemo_outputSchedBudget(budgetCfg->linkBytesPerSec,
+                                                                   framePeriodUs,
+                                                                   budgetCfg->budgetPercent);
+
+    /* Room for the shed report is kept whenever there is a budget */
+    items[MMWDEMO_OUTPUT_SCHED_OUTPUT_SHED].type = MMWDEMO_OUTPUT_MSG_OUTPUT_SHED;
+    items[MMWDEMO_OUTPUT_SCHED_OUTPUT_SHED].isMandatory = 1;
+    if (gMmwDssMCB.outputSched.budgetBytes != 0U)
+    {
+        items[MMWDEMO_OUTPUT_SCHED_OUTPUT_SHED].length = MMWDEMO_TLV_OUTPUT_SHED_LEN;
+    }
+
+    items[MMWDEMO_OUTPUT_SCHED_QUIET].type = MMWDEMO_OUTPUT_MSG_QUIET;
+    items[MMWDEMO_OUTPUT_SCHED_QUIET].isMandatory = 1;
+    if (gMmwDssMCB.quietMode.isEnabled)
+    {
+        items[MMWDEMO_OUTPUT_SCHED_QUIET].length = MMWDEMO_TLV_QUIET_LEN;
+    }
+
+    if (quietDecision == MMW_QUIET_MODE_SEND_HEARTBEAT)
+    {
+        for (i = 0; i < MMWDEMO_OUTPUT_SCHED_NUM_ITEMS; i++)
+        {
+            if ((i != MMWDEMO_OUTPUT_SCHED_DSS_STATS) && (i != MMWDEMO_OUTPUT_SCHED_QUIET))
+            {
+                items[i].length = 0;
+            }
+        }
+    }
+
+    MmwDemo_outputSchedRun(&gMmwDssMCB.outputSched, items, MMWDEMO_OUTPUT_SCHED_NUM_ITEMS,
+                           MMWDEMO_OUTPUT_MSG_MAX, extraLen, result);
+}
+
 /**
  *  @b Description
  *  @n
@@ -621,6 +865,9 @@ void MmwDemo_mboxCallback
  *      Size of the output buffer
  *  @param[in]  obj
  *      Handle to the Data Path Object
+ *  @param[in]  quietDecision
+ *      MMW_QUIET_MODE_SEND_FULL, or MMW_QUIET_MODE_SEND_HEARTBEAT for the
+ *      quiet report and the device counters only
  *
  *  @retval
  *      =0    Success
@@ -631,22 +878,31 @@ int32_t MmwDemo_dssSendProcessOutputToMSS
 (
     uint8_t           *ptrHsmBuffer,
     uint32_t           outputBufSize,
-    MmwDemo_DSS_DataPathObj   *obj
+    MmwDemo_DSS_DataPathObj   *obj,
+    uint32_t           quietDecision
 )
 {
     uint32_t            i;
     uint8_t             *ptrCurrBuffer;
     uint32_t            totalHsmSize = 0;
-    uint32_t            totalPacketLen = sizeof(MmwDemo_output_message_header);
+    uint32_t            totalPacketLen = MMWDEMO_WIRE_MSG_HEADER_LEN;
     uint32_t            itemPayloadLen;
     int32_t             retVal = 0;
     MmwDemo_message     message;
     MmwDemo_GuiMonSel   *pGuiMonSel;
     uint32_t            tlvIdx = 0;
+    bool                isDeviceStatsDue;
+    MmwDemo_outputSchedResult sched;
 
     /* Get Gui Monitor configuration */
     pGuiMonSel = &gMmwDssMCB.cfg.guiMonSel;
 
+    /* The device counters go out every MMWDEMO_OUTPUT_DEVICE_STATS_PERIOD frames */
+    isDeviceStatsDue = ((pGuiMonSel->statsInfo & MMWDEMO_GUIMON_STATS_DEVICE) != 0U) &&
+                       ((gMmwDssMCB.stats.frameStartIntCounter - gMmwDssMCB.deviceStatsFrame) >=
+                        MMWDEMO_OUTPUT_DEVICE_STATS_PERIOD);
+    MmwDemo_dssOutputSchedule(obj, isDeviceStatsDue, quietDecision, &sched);
+
     /* Validate input params */
     if(ptrHsmBuffer == NULL)
     {
@@ -674,13 +930,13 @@ int32_t MmwDemo_dssSendProcessOutputToMSS
     ptrCurrBuffer = ptrHsmBuffer;
 
     /* Put detected Objects in HSM buffer: sizeof(MmwDemo_objOut_t) * numDetObj  */
-    if ((pGuiMonSel->detectedObjects == 1) && (obj->numDetObj > 0))
+    if (sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_DETECTED_POINTS))
     {
         /* Add objects descriptor */
         MmwDemo_output_message_dataObjDescr descr;
         descr.numDetetedObj = obj->numDetObj;
         descr.xyzQFormat = obj->xyzOutputQFormat;
-        itemPayloadLen = sizeof(MmwDemo_output_message_dataObjDescr);
+        itemPayloadLen = MMWDEMO_TLV_DETECTED_POINTS_FIXED_LEN;
         totalHsmSize += itemPayloadLen;
         if(totalHsmSize > outputBufSize)
         {
@@ -690,29 +946,26 @@ int32_t MmwDemo_dssSendProcessOutputToMSS
         memcpy(ptrCurrBuffer, (void *)&descr, itemPayloadLen);
 
         /* Add array of objects */
-        itemPayloadLen = sizeof(MmwDemo_detectedObj) * obj->numDetObj;
+        itemPayloadLen = MMWDEMO_TLV_DETECTED_POINTS_LEN(obj->numDetObj) - MMWDEMO_TLV_DETECTED_POINTS_FIXED_LEN;
         totalHsmSize += itemPayloadLen;
         if(totalHsmSize > outputBufSize)
         {
             retVal = -1;
             goto Exit;
         }
-        memcpy(&ptrCurrBuffer[sizeof(MmwDemo_output_message_dataObjDescr)], (void *)obj->detObj2D, itemPayloadLen);
+        memcpy(&ptrCurrBuffer[MMWDEMO_TLV_DETECTED_POINTS_FIXED_LEN], (void *)obj->detObj2D, itemPayloadLen);
 
-        message.body.detObj.tlv[tlvIdx].length = itemPayloadLen + sizeof(MmwDemo_output_message_dataObjDescr);
-        message.body.detObj.tlv[tlvIdx].type = MMWDEMO_OUTPUT_MSG_DETECTED_POINTS;
-        message.body.detObj.tlv[tlvIdx].address = (uint32_t) ptrCurrBuffer;
-        tlvIdx++;
+        totalPacketLen += MmwDemo_tlvPackDetectedPoints(&message.body.detObj.tlv[tlvIdx++],
+                              (const MmwDemo_output_message_dataObjDescr *) ptrCurrBuffer, obj->numDetObj);
 
         /* Incrementing pointer to HSM buffer */
-        ptrCurrBuffer += itemPayloadLen + sizeof(MmwDemo_output_message_dataObjDescr);
-        totalPacketLen += sizeof(MmwDemo_output_message_tl) + itemPayloadLen + sizeof(MmwDemo_output_message_dataObjDescr);
+        ptrCurrBuffer += MMWDEMO_TLV_DETECTED_POINTS_LEN(obj->numDetObj);
     }
 
     /* Sending range profile:  2bytes * numRangeBins */
-    if (pGuiMonSel->logMagRange == 1)
+    if (sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_RANGE_PROFILE))
     {
-        itemPayloadLen = sizeof(uint16_t) * obj->numRangeBins;
+        itemPayloadLen = MMWDEMO_TLV_RANGE_PROFILE_LEN(obj->numRangeBins);
         totalHsmSize += itemPayloadLen;
         if(totalHsmSize > outputBufSize)
         {
@@ -726,21 +979,17 @@ int32_t MmwDemo_dssSendProcessOutputToMSS
             ptrMatrix[i] = obj->detMatrix[i*obj->numDopplerBins];
         }
 
-        message.body.detObj.tlv[tlvIdx].length = itemPayloadLen;
-        message.body.detObj.tlv[tlvIdx].type = MMWDEMO_OUTPUT_MSG_RANGE_PROFILE;
-        message.body.detObj.tlv[tlvIdx].address = (uint32_t) ptrCurrBuffer;
-        tlvIdx++;
+        totalPacketLen += MmwDemo_tlvPackRangeProfile(&message.body.detObj.tlv[tlvIdx++], ptrMatrix, obj->numRangeBins);
 
         /* Incrementing pointer to HSM buffer */
         ptrCurrBuffer = (uint8_t *)((uint32_t)ptrHsmBuffer + totalHsmSize);
-        totalPacketLen += sizeof(MmwDemo_output_message_tl) + itemPayloadLen;
    }
 
     /* Sending range profile:  2bytes * numRangeBins */
-    if (pGuiMonSel->noiseProfile == 1)
+    if (sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_NOISE_PROFILE))
     {
         uint32_t maxDopIdx = obj->numDopplerBins/2 -1;
-        itemPayloadLen = sizeof(uint16_t) * obj->numRangeBins;
+        itemPayloadLen = MMWDEMO_TLV_NOISE_PROFILE_LEN(obj->numRangeBins);
         totalHsmSize += itemPayloadLen;
         if(totalHsmSize > outputBufSize)
         {
@@ -754,46 +1003,69 @@ int32_t MmwDemo_dssSendProcessOutputToMSS
             ptrMatrix[i] = obj->detMatrix[i*obj->numDopplerBins + maxDopIdx];
         }
 
-        message.body.detObj.tlv[tlvIdx].length = itemPayloadLen;
-        message.body.detObj.tlv[tlvIdx].type = MMWDEMO_OUTPUT_MSG_NOISE_PROFILE;
-        message.body.detObj.tlv[tlvIdx].address = (uint32_t) ptrCurrBuffer;
-        tlvIdx++;
+        totalPacketLen += MmwDemo_tlvPackNoiseProfile(&message.body.detObj.tlv[tlvIdx++], ptrMatrix, obj->numRangeBins);
 
         /* Incrementing pointer to HSM buffer */
         ptrCurrBuffer = (uint8_t *)((uint32_t)ptrHsmBuffer + totalHsmSize);
-        totalPacketLen += sizeof(MmwDemo_output_message_tl) + itemPayloadLen;
    }
 
-    /* Sending range Azimuth Heat Map */
-    if (pGuiMonSel->rangeAzimuthHeatMap == 1)
+    /* Sending delta coded range profile, encoded during inter frame processing */
+    if (sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_RANGE_PROFILE_DELTA))
+    {
+        totalPacketLen += MmwDemo_tlvPackRangeProfileDelta(&message.body.detObj.tlv[tlvIdx++],
+                              obj->rangeProfileDelta, (uint32_t) obj->rangeProfileDeltaLen);
+    }
+
+    /* Sending delta coded noise profile, encoded during inter frame processing */
+    if (sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_NOISE_PROFILE_DELTA))
     {
-        itemPayloadLen = obj->numRangeBins * obj->numVirtualAntAzim * sizeof(cmplx16ImRe_t);
-        message.body.detObj.tlv[tlvIdx].length = itemPayloadLen;
-        message.body.detObj.tlv[tlvIdx].type = MMWDEMO_OUTPUT_MSG_AZIMUT_STATIC_HEAT_MAP;
-        message.body.detObj.tlv[tlvIdx].address = (uint32_t) obj->azimuthStaticHeatMap;
-        tlvIdx++;
+        totalPacketLen += MmwDemo_tlvPackNoiseProfileDelta(&message.body.detObj.tlv[tlvIdx++],
+                              obj->noiseProfileDelta, (uint32_t) obj->noiseProfileDeltaLen);
+    }
 
-        totalPacketLen += sizeof(MmwDemo_output_message_tl) + itemPayloadLen;
+    /* Sending range Azimuth Heat Map */
+    if (sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_AZIMUTH_STATIC))
+    {
+        totalPacketLen += MmwDemo_tlvPackAzimuthStaticHeatMap(&message.body.detObj.tlv[tlvIdx++],
+                              obj->azimuthStaticHeatMap, obj->numRangeBins * obj->numVirtualAntAzim);
     }
 
 
     /* Sending range Doppler Heat Map  */
-    if (pGuiMonSel->rangeDopplerHeatMap == 1)
+    if (sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_RD_DENSE))
     {
-        itemPayloadLen = obj->numRangeBins * obj->numDopplerBins * sizeof(uint16_t);
-        message.body.detObj.tlv[tlvIdx].length = itemPayloadLen;
-        message.body.detObj.tlv[tlvIdx].type = MMWDEMO_OUTPUT_MSG_RANGE_DOPPLER_HEAT_MAP;
-        message.body.detObj.tlv[tlvIdx].address = (uint32_t) obj->detMatrix;
-        tlvIdx++;
+        totalPacketLen += MmwDemo_tlvPackRangeDopplerHeatMap(&message.body.detObj.tlv[tlvIdx++],
+                              obj->detMatrix, obj->numRangeBins * obj->numDopplerBins);
+    }
 
-        totalPacketLen += sizeof(MmwDemo_output_message_tl) + itemPayloadLen;
+    /* Sending compressed range Doppler Heat Map, encoded during inter frame processing.
+     * Which TLVs fit the message slots and the link budget was settled by
+     * MmwDemo_dssOutputSchedule. */
+    if (sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_RD_COMPRESSED))
+    {
+        totalPacketLen += MmwDemo_tlvPackRangeDopplerHeatMapCompressed(&message.body.detObj.tlv[tlvIdx++],
+                              obj->rdHeatMapCompressed, (uint32_t) obj->rdHeatMapCompressedLen);
+    }
+
+    /* Sending sparse range Doppler Heat Map, encoded during inter frame processing */
+    if (sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_RD_SPARSE))
+    {
+        totalPacketLen += MmwDemo_tlvPackRangeDopplerHeatMapSparse(&message.body.detObj.tlv[tlvIdx++],
+                              obj->rdHeatMapSparse, (uint32_t) obj->rdHeatMapSparseLen);
+    }
+
+    /* Sending range Azimuth magnitude Heat Map, computed during inter frame processing */
+    if (sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_AZIMUTH_MAGNITUDE))
+    {
+        totalPacketLen += MmwDemo_tlvPackAzimuthHeatMapMagnitude(&message.body.detObj.tlv[tlvIdx++],
+                              obj->azimuthHeatMapMag, (uint32_t) obj->azimuthHeatMapMagLen);
     }
 
     /* Sending stats information  */
-    if (pGuiMonSel->statsInfo == 1)
+    if (sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_STATS))
     {
         MmwDemo_output_message_stats stats;
-        itemPayloadLen = sizeof(MmwDemo_output_message_stats);
+        itemPayloadLen = MMWDEMO_TLV_STATS_LEN;
         totalHsmSize += itemPayloadLen;
         if(totalHsmSize > outputBufSize)
         {
@@ -809,14 +1081,84 @@ int32_t MmwDemo_dssSendProcessOutputToMSS
         stats.interFrameCPULoad = obj->timingInfo.interFrameCPULoad;
         memcpy(ptrCurrBuffer, (void *)&stats, itemPayloadLen);
 
-        message.body.detObj.tlv[tlvIdx].length = itemPayloadLen;
-        message.body.detObj.tlv[tlvIdx].type = MMWDEMO_OUTPUT_MSG_STATS;
-        message.body.detObj.tlv[tlvIdx].address = (uint32_t) ptrCurrBuffer;;
-        tlvIdx++;
+        totalPacketLen += MmwDemo_tlvPackStats(&message.body.detObj.tlv[tlvIdx++],
+                              (const MmwDemo_output_message_stats *) ptrCurrBuffer);
 
         /* Incrementing pointer to HSM buffer */
         ptrCurrBuffer = (uint8_t *)((uint32_t)ptrHsmBuffer + totalHsmSize);
-        totalPacketLen += sizeof(MmwDemo_output_message_tl) + itemPayloadLen;
+    }
+
+    /* Sending the DSS counters; the MSS appends its own behind them */
+    if (sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_DSS_STATS))
+    {
+        MmwDemo_output_message_dssStats dssStats;
+        itemPayloadLen = MMWDEMO_TLV_DSS_STATS_LEN;
+        totalHsmSize += itemPayloadLen;
+        if(totalHsmSize > outputBufSize)
+        {
+            retVal = -1;
+            goto Exit;
+        }
+
+        dssStats.frameStartIntCounter = gMmwDssMCB.stats.frameStartIntCounter;
+        dssStats.frameIntSkipCounter = gMmwDssMCB.stats.frameIntSkipCounter;
+        dssStats.chirpIntCounter = gMmwDssMCB.stats.chirpIntCounter;
+        dssStats.chirpIntSkipCounter = gMmwDssMCB.stats.chirpIntSkipCounter;
+        dssStats.detObjLoggingSkip = gMmwDssMCB.stats.detObjLoggingSkip;
+        dssStats.detObjLoggingErr = gMmwDssMCB.stats.detObjLoggingErr;
+        dssStats.numFailedTimingReports = gMmwDssMCB.stats.numFailedTimingReports;
+        dssStats.numCalibrationReports = gMmwDssMCB.stats.numCalibrationReports;
+        memcpy(ptrCurrBuffer, (void *)&dssStats, itemPayloadLen);
+
+        totalPacketLen += MmwDemo_tlvPackDssStats(&message.body.detObj.tlv[tlvIdx++],
+                              (const MmwDemo_output_message_dssStats *) ptrCurrBuffer);
+
+        ptrCurrBuffer = (uint8_t *)((uint32_t)ptrHsmBuffer + totalHsmSize);
+        gMmwDssMCB.deviceStatsFrame = gMmwDssMCB.stats.frameStartIntCounter;
+    }
+
+    /* Telling the host what did not fit the link budget */
+    if ((sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_OUTPUT_SHED)) && (sched.shedMask != 0U))
+    {
+        MmwDemo_output_message_outputShed shed;
+        itemPayloadLen = MMWDEMO_TLV_OUTPUT_SHED_LEN;
+        totalHsmSize += itemPayloadLen;
+        if(totalHsmSize > outputBufSize)
+        {
+            retVal = -1;
+            goto Exit;
+        }
+
+        shed.shedMask = sched.shedMask;
+        shed.budgetBytes = gMmwDssMCB.outputSched.budgetBytes;
+        shed.packetLen = sched.packetLen;
+        memcpy(ptrCurrBuffer, (void *)&shed, itemPayloadLen);
+
+        totalPacketLen += MmwDemo_tlvPackOutputShed(&message.body.detObj.tlv[tlvIdx++],
+                              (const MmwDemo_output_message_outputShed *) ptrCurrBuffer);
+
+        ptrCurrBuffer = (uint8_t *)((uint32_t)ptrHsmBuffer + totalHsmSize);
+    }
+
+    /* Telling the host which frames the quiet mode suppressed before this one */
+    if (sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_QUIET))
+    {
+        MmwDemo_output_message_quiet quiet;
+        itemPayloadLen = MMWDEMO_TLV_QUIET_LEN;
+        totalHsmSize += itemPayloadLen;
+        if(totalHsmSize > outputBufSize)
+        {
+            retVal = -1;
+            goto Exit;
+        }
+
+        MmwDemo_quietModeReport(&gMmwDssMCB.quietMode, quietDecision, &quiet);
+        memcpy(ptrCurrBuffer, (void *)&quiet, itemPayloadLen);
+
+        totalPacketLen += MmwDemo_tlvPackQuiet(&message.body.detObj.tlv[tlvIdx++],
+                              (const MmwDemo_output_message_quiet *) ptrCurrBuffer);
+
+        ptrCurrBuffer = (uint8_t *)((uint32_t)ptrHsmBuffer + totalHsmSize);
     }
 
     if( retVal == 0)
@@ -831,6 +1173,18 @@ int32_t MmwDemo_dssSendProcessOutputToMSS
         {
             retVal = -1;
         }
+        else
+        {
+            /* The host decodes the next delta profiles against these */
+            if (sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_RANGE_PROFILE_DELTA))
+            {
+                MmwDemo_profileDeltaCommit(&obj->rangeProfileDeltaEnc);
+            }
+            if (sched.sendMask & (1UL << MMWDEMO_OUTPUT_SCHED_NOISE_PROFILE_DELTA))
+            {
+                MmwDemo_profileDeltaCommit(&obj->noiseProfileDeltaEnc);
+            }
+        }
     }
 Exit:
     return retVal;
@@ -846,6 +1200,18 @@ Exit:
  */
 void MmwDemo_dssDataPathOutputLogging(MmwDemo_DSS_DataPathObj   * dataPathObj)
 {
+        uint32_t quietDecision;
+
+        /* In quiet mode a frame with nothing new is not sent; the next
+         * packet counts it in its quiet report */
+        quietDecision = MmwDemo_quietModeDecide(&gMmwDssMCB.quietMode, dataPathObj->numDetObj,
+                                                dataPathObj->detMatrix, dataPathObj->numDopplerBins,
+                                                dataPathObj->numRangeBins);
+        if (quietDecision == MMW_QUIET_MODE_SUPPRESS)
+        {
+            return;
+        }
+
         /* Sending detected objects to logging buffer and shipped out from MSS UART */
         if (gMmwDssMCB.loggingBufferAvailable == 1)
         {
@@ -856,11 +1222,17 @@ void MmwDemo_dssDataPathOutputLogging(MmwDemo_DSS_DataPathObj   * dataPathObj)
                logging buffer is ready */
         if (MmwDemo_dssSendProcessOutputToMSS((uint8_t *)&gHSRam,
                                              (uint32_t)SOC_XWR16XX_DSS_HSRAM_SIZE,
-                                             dataPathObj) < 0)
+                                             dataPathObj, quietDecision) < 0)
             {
                 /* Increment logging error */
                 gMmwDssMCB.stats.detObjLoggingErr++;
         }
+            else
+            {
+                MmwDemo_quietModeSent(&gMmwDssMCB.quietMode, quietDecision,
+                                      gMmwDssMCB.stats.frameStartIntCounter, dataPathObj->detMatrix,
+                                      dataPathObj->numDopplerBins, dataPathObj->numRangeBins);
+            }
     }
         else
         {
@@ -1043,6 +1415,10 @@ int32_t MmwDemo_dssDataPathInit(void)
 
     /* Initialize entire data path object to a known state */
     memset((void *)obj, 0, sizeof(MmwDemo_DSS_DataPathObj));
+    obj->rdHeatMapSparseCfg.margin = MMW_HEATMAP_SPARSE_DEFAULT_MARGIN;
+    obj->azimuthHeatMapCfg.numAngleBins = MMW_AZIMUTH_HEATMAP_DEFAULT_BINS;
+    obj->azimuthHeatMapCfg.format = MMW_AZIMUTH_HEATMAP_FORMAT_U8_LOG;
+    obj->profileDeltaCfg.keyframeInterval = MMW_PROFILE_DELTA_DEFAULT_INTERVAL;
 
     MmwDemo_dataPathInit1Dstate(obj);
     retVal = MmwDemo_dataPathInitEdma(obj);
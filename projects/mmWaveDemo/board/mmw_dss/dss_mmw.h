@@ -54,7 +54,10 @@
 #include <ti/control/mmwave/mmwave.h>
 
 /* MMW Demo Include Files */
-#include <ti/demo/xwr16xx/mmw/dss/dss_data_path.h>
+#include "dss_data_path.h"
+#include "../common/mmw_messages_ext.h"
+#include "../common/mmw_output_sched.h"
+#include "../common/mmw_quiet_mode.h"
 #include <ti/demo/io_interface/mmw_config.h>
 
 #ifdef __cplusplus
@@ -250,6 +253,18 @@ typedef struct MmwDemo_DSS_MCB_t
     /*! @brief   mmw Demo statistics */
     MmwDemo_DSS_STATS           stats;
 
+    /*! @brief   Frame number of the last packet carrying the DSS counters */
+    uint32_t                    deviceStatsFrame;
+
+    /*! @brief   Output link budget, outputBudgetCfg */
+    MmwDemo_OutputBudgetCfg     outputBudgetCfg;
+
+    /*! @brief   Output scheduler, picks the TLVs fitting the budget */
+    MmwDemo_outputSched         outputSched;
+
+    /*! @brief   Quiet mode, quietModeCfg */
+    MmwDemo_quietMode           quietMode;
+
     /*! @brief   DSS frame clock handle */
     Clock_Handle                frameClkHandle;
 } MmwDemo_DSS_MCB;